@@ -0,0 +1,261 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+"""
+Codificación de downlinks de geocerca (puerto 10) para el backend
+
+Genera los mismos payloads que decodifica RadioManager::parseGeofenceCommand
+y divide los que no caben en un downlink en fragmentos reensamblables por
+el collar (FragmentAssembler).
+
+Uso:
+    from geofence_downlink import encode_downlinks
+    for payload in encode_downlinks(points, "grupo1", version=3):
+        enqueue_downlink(dev_eui, payload, fport=10)
+"""
+
+import binascii
+import math
+import struct
+
+# Tipos de comando (ver lorawan_config.h)
+GEOFENCE_CMD_CIRCLE = 0x00
+GEOFENCE_CMD_POLYGON = 0x01
+GEOFENCE_CMD_POLYGON_COMPRESSED = 0x02
+GEOFENCE_CMD_POLYGON_LARGE = 0x03
+GEOFENCE_CMD_POLYGON_VARINT = 0x04
+GEOFENCE_CMD_IDENTIFIED = 0x05
+GEOFENCE_CMD_FRAGMENT = 0x10
+GEOFENCE_CMD_DELTA = 0x20
+
+# Operaciones de GEOFENCE_CMD_DELTA (ver src/utils/GeofenceDelta.h)
+DELTA_OP_MOVE = 0x01
+DELTA_OP_INSERT = 0x02
+DELTA_OP_DELETE = 0x03
+DELTA_OP_RADIUS = 0x04
+DELTA_OP_NAME = 0x05
+DELTA_OP_CENTER = 0x06
+
+FRAGMENT_HEADER_SIZE = 8
+FRAGMENT_MAX_COUNT = 64
+FRAGMENT_MAX_PAYLOAD = 2304
+DOWNLINK_MAX_SIZE = 51  # AU915 DR0/DR8 sin FOpts
+GEOFENCE_MAX_VERTICES = 256
+
+
+def _group_id(group_id):
+    return group_id.encode("utf-8")[:15] if group_id else b""
+
+
+def encode_circle(lat, lng, radius, group_id=""):
+    """[tipo(1)][lat(4)][lng(4)][radio(2)][groupId(N)]"""
+    return struct.pack("<BffH", GEOFENCE_CMD_CIRCLE, lat, lng, int(radius)) + _group_id(group_id)
+
+
+def encode_polygon(points, group_id=""):
+    """[tipo(1)][n(1)][lat(4)][lng(4)]...[groupId(N)] - hasta 10 puntos, un solo downlink"""
+    if not 3 <= len(points) <= 10:
+        raise ValueError("El polígono simple admite entre 3 y 10 puntos")
+    payload = struct.pack("<BB", GEOFENCE_CMD_POLYGON, len(points))
+    for lat, lng in points:
+        payload += struct.pack("<ff", lat, lng)
+    return payload + _group_id(group_id)
+
+
+def encode_large_polygon(points, group_id=""):
+    """[tipo(1)][n(2)][lat(4)][lng(4)]...[groupId(N)] - requiere fragmentación"""
+    if not 3 <= len(points) <= GEOFENCE_MAX_VERTICES:
+        raise ValueError("El polígono grande admite entre 3 y %d puntos" % GEOFENCE_MAX_VERTICES)
+    payload = struct.pack("<BH", GEOFENCE_CMD_POLYGON_LARGE, len(points))
+    for lat, lng in points:
+        payload += struct.pack("<ff", lat, lng)
+    return payload + _group_id(group_id)
+
+
+def meters_per_degree_lat(lat):
+    """Metros por grado de latitud (WGS84), igual que PolygonCodec"""
+    phi = math.radians(lat)
+    return 111132.92 - 559.82 * math.cos(2 * phi) + 1.175 * math.cos(4 * phi) - 0.0023 * math.cos(6 * phi)
+
+
+def meters_per_degree_lng(lat):
+    """Metros por grado de longitud (WGS84), igual que PolygonCodec"""
+    phi = math.radians(lat)
+    return 111412.84 * math.cos(phi) - 93.5 * math.cos(3 * phi) + 0.118 * math.cos(5 * phi)
+
+
+def _varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        out.append(byte | (0x80 if value else 0))
+        if not value:
+            return bytes(out)
+
+
+def _zigzag(value):
+    return (value << 1) ^ (value >> 31) if value >= 0 else ((-value) << 1) - 1
+
+
+def _round(value):
+    # lround de C: mitades lejos de cero
+    return int(math.floor(value + 0.5)) if value >= 0 else -int(math.floor(-value + 0.5))
+
+
+def encode_varint_polygon(points, group_id="", resolution_cm=10, ref=None):
+    """
+    [tipo(1)][latRef(4)][lngRef(4)][res cm(1)][n varint][dN zz][dE zz]...[groupId(N)]
+
+    Referencia int32 en 1e-7 grados (por defecto el centroide) y vértices como
+    deltas en unidades de resolution_cm, convertidos con la escala de la
+    latitud de referencia. Ver src/utils/PolygonCodec.h.
+    """
+    if not 3 <= len(points) <= GEOFENCE_MAX_VERTICES:
+        raise ValueError("El polígono admite entre 3 y %d puntos" % GEOFENCE_MAX_VERTICES)
+    if not 1 <= resolution_cm <= 255:
+        raise ValueError("Resolución fuera de rango: %d cm" % resolution_cm)
+
+    if ref is None:
+        ref = (sum(p[0] for p in points) / len(points), sum(p[1] for p in points) / len(points))
+    ref_lat_e7 = _round(ref[0] * 1e7)
+    ref_lng_e7 = _round(ref[1] * 1e7)
+    lat0 = ref_lat_e7 / 1e7
+    lng0 = ref_lng_e7 / 1e7
+
+    resolution = resolution_cm / 100.0
+    units_lat = meters_per_degree_lat(lat0) / resolution
+    units_lng = meters_per_degree_lng(lat0) / resolution
+
+    payload = struct.pack("<BiiB", GEOFENCE_CMD_POLYGON_VARINT, ref_lat_e7, ref_lng_e7, resolution_cm)
+    payload += _varint(len(points))
+
+    # Posiciones absolutas cuantizadas: el error no se acumula con los deltas
+    prev_n, prev_e = 0, 0
+    for lat, lng in points:
+        north = _round((lat - lat0) * units_lat)
+        east = _round((lng - lng0) * units_lng)
+        payload += _varint(_zigzag(north - prev_n)) + _varint(_zigzag(east - prev_e))
+        prev_n, prev_e = north, east
+
+    return payload + _group_id(group_id)
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, igual que FragmentAssembler::crc16"""
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def fragment(payload, version, max_downlink=DOWNLINK_MAX_SIZE):
+    """
+    Divide un payload de geocerca en fragmentos:
+    [0x10][versión(1)][índice(1)][total(1)][offset(2)][crc16(2)][datos(N)]
+
+    Los fragmentos se pueden reenviar en cualquier orden; el collar ignora
+    los duplicados y aplica la geocerca solo cuando llegan todos.
+    """
+    if len(payload) > FRAGMENT_MAX_PAYLOAD:
+        raise ValueError("Payload demasiado grande: %d bytes" % len(payload))
+
+    chunk_size = max_downlink - FRAGMENT_HEADER_SIZE
+    count = (len(payload) + chunk_size - 1) // chunk_size
+    if count > FRAGMENT_MAX_COUNT:
+        raise ValueError("Demasiados fragmentos: %d" % count)
+
+    crc = crc16(payload)
+    fragments = []
+    for index in range(count):
+        offset = index * chunk_size
+        header = struct.pack("<BBBBHH", GEOFENCE_CMD_FRAGMENT, version & 0xFF, index, count, offset, crc)
+        fragments.append(header + payload[offset:offset + chunk_size])
+    return fragments
+
+
+def encode_identified(fence_id, version, payload):
+    """[0x05][fenceId(2)][versión(1)][comando completo] - habilita los deltas sobre esa geocerca"""
+    if payload[0] > GEOFENCE_CMD_POLYGON_VARINT:
+        raise ValueError("Solo se identifican geocercas completas")
+    return struct.pack("<BHB", GEOFENCE_CMD_IDENTIFIED, fence_id, version & 0xFF) + payload
+
+
+class GeofenceDelta(object):
+    """
+    Constructor de GEOFENCE_CMD_DELTA:
+    [0x20][fenceId(2)][versión base(1)][versión nueva(1)][res cm(1)][ops...]
+
+    Los offsets se calculan desde la posición que tiene el collar, que es la
+    decodificada (cuantizada), no la del mapa; el backend debe guardar esa.
+    """
+
+    def __init__(self, fence_id, base_version, resolution_cm=10):
+        if not 1 <= resolution_cm <= 255:
+            raise ValueError("Resolución fuera de rango: %d cm" % resolution_cm)
+        self.fence_id = fence_id
+        self.base_version = base_version & 0xFF
+        self.resolution_cm = resolution_cm
+        self.ops = b""
+
+    def _offset(self, origin, target):
+        resolution = self.resolution_cm / 100.0
+        north = _round((target[0] - origin[0]) * meters_per_degree_lat(origin[0]) / resolution)
+        east = _round((target[1] - origin[1]) * meters_per_degree_lng(origin[0]) / resolution)
+        return _varint(_zigzag(north)) + _varint(_zigzag(east))
+
+    def move(self, index, old, new):
+        """Mueve el vértice index de old a new"""
+        self.ops += bytes([DELTA_OP_MOVE]) + _varint(index) + self._offset(old, new)
+        return self
+
+    def insert(self, index, previous, new):
+        """Inserta new antes de index; previous es el vértice index-1 (el último si index=0)"""
+        self.ops += bytes([DELTA_OP_INSERT]) + _varint(index) + self._offset(previous, new)
+        return self
+
+    def delete(self, index):
+        self.ops += bytes([DELTA_OP_DELETE]) + _varint(index)
+        return self
+
+    def radius(self, meters):
+        self.ops += bytes([DELTA_OP_RADIUS]) + _varint(int(meters))
+        return self
+
+    def center(self, old, new):
+        self.ops += bytes([DELTA_OP_CENTER]) + self._offset(old, new)
+        return self
+
+    def name(self, name):
+        raw = name.encode("utf-8")[:31]
+        self.ops += bytes([DELTA_OP_NAME, len(raw)]) + raw
+        return self
+
+    def encode(self):
+        header = struct.pack("<BHBBB", GEOFENCE_CMD_DELTA, self.fence_id, self.base_version,
+                             (self.base_version + 1) & 0xFF, self.resolution_cm)
+        payload = header + self.ops
+        if len(payload) > FRAGMENT_MAX_PAYLOAD:
+            raise ValueError("Delta demasiado grande: %d bytes" % len(payload))
+        return payload
+
+
+def encode_downlinks(points, group_id="", version=0, resolution_cm=10):
+    """Lista de downlinks para un polígono: uno solo si cabe, fragmentos si no"""
+    payload = encode_varint_polygon(points, group_id, resolution_cm)
+    if len(payload) <= DOWNLINK_MAX_SIZE:
+        return [payload]
+    return fragment(payload, version)
+
+
+if __name__ == "__main__":
+    # Ejemplo: círculo de 200 vértices alrededor de Santiago
+    center = (-33.4489, -70.6693)
+    pts = [(center[0] + 0.005 * math.sin(2 * math.pi * i / 200),
+            center[1] + 0.006 * math.cos(2 * math.pi * i / 200)) for i in range(200)]
+    downlinks = encode_downlinks(pts, "grupo1", version=1)
+    print("%d vértices -> %d downlinks (float: %d bytes, varint: %d bytes)" % (
+        len(pts), len(downlinks), len(encode_large_polygon(pts)), len(encode_varint_polygon(pts))))
+    for d in downlinks[:3]:
+        print(binascii.hexlify(d).decode())
+
+    # Mover un vértice 5 m al norte en la versión 1 de la geocerca #7
+    moved = (pts[10][0] + 5 / meters_per_degree_lat(pts[10][0]), pts[10][1])
+    delta = GeofenceDelta(7, 1).move(10, pts[10], moved).encode()
+    print("Delta de un vértice: %d bytes -> %s" % (len(delta), binascii.hexlify(delta).decode()))
@@ -0,0 +1,293 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+"""
+Decodificador del log binario del collar (ENABLE_BINARY_LOG)
+
+Con el log binario el firmware no lleva los textos de los LOG_x: cada
+mensaje sale por serial como una trama con el hash FNV-1a del formato y los
+argumentos (ver src/system/BinaryLog.h). Este script arma el diccionario
+hash -> formato leyendo los LOG_x del código fuente y reconstruye las
+líneas con el mismo aspecto que el log de texto. Lo que no es trama (banner,
+estado por serial) se copia tal cual.
+
+Uso:
+    python scripts/log_decoder.py --port COM3
+    python scripts/log_decoder.py --file captura.bin
+    python scripts/log_decoder.py --list          # Diccionario y colisiones
+"""
+
+import argparse
+import codecs
+import os
+import re
+import struct
+import sys
+
+SYNC = 0xFE
+TRUNCATED = 0x80
+
+TAG_INT = 1
+TAG_UINT = 2
+TAG_FLOAT = 3
+TAG_DOUBLE = 4
+TAG_STRING = 5
+TAG_POINTER = 6
+
+LEVELS = {1: ("❌", "ERROR"), 2: ("⚠️", "WARN"), 3: ("ℹ️", "INFO"), 4: ("🔍", "DEBUG")}
+
+SRC_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src")
+
+# LOG_x( seguido de uno o más literales concatenados
+_LOG_CALL = re.compile(r'\bLOG_[EWID]\s*\(\s*((?:"(?:[^"\\]|\\.)*"\s*)+)')
+_LITERAL = re.compile(r'"((?:[^"\\]|\\.)*)"')
+_SPEC = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|z|j|t|L)?([diouxXcfFeEgGaAspn%])")
+
+
+# ============================================================================
+# DICCIONARIO
+# ============================================================================
+
+def format_id(data):
+    """FNV-1a de 32 bits, igual que BinaryLog::formatId()"""
+    value = 2166136261
+    for byte in data:
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def _unescape(literal):
+    """Bytes de un literal de C (el fuente está en UTF-8)"""
+    raw = literal.encode("utf-8")
+    out = bytearray()
+    i = 0
+    simple = {b"n": 10, b"t": 9, b"r": 13, b"0": 0, b"\\": 92, b'"': 34, b"'": 39, b"a": 7}
+    while i < len(raw):
+        if raw[i:i + 1] != b"\\":
+            out.append(raw[i])
+            i += 1
+            continue
+        nxt = raw[i + 1:i + 2]
+        if nxt == b"x":
+            match = re.match(rb"[0-9a-fA-F]+", raw[i + 2:])
+            out.append(int(match.group(0), 16) & 0xFF)
+            i += 2 + len(match.group(0))
+        elif nxt.isdigit():
+            match = re.match(rb"[0-7]{1,3}", raw[i + 1:])
+            out.append(int(match.group(0), 8) & 0xFF)
+            i += 1 + len(match.group(0))
+        else:
+            out.append(simple.get(nxt, nxt[0] if nxt else 92))
+            i += 2
+    return bytes(out)
+
+
+def build_dictionary(src_dir=SRC_DIR):
+    """{id: formato} de todos los LOG_x del código, más los ids repetidos"""
+    formats = {}
+    collisions = []
+    for root, _, files in os.walk(src_dir):
+        for name in sorted(files):
+            if not name.endswith((".cpp", ".h")):
+                continue
+            with open(os.path.join(root, name), encoding="utf-8") as source:
+                text = source.read()
+            for call in _LOG_CALL.finditer(text):
+                data = b"".join(_unescape(part) for part in _LITERAL.findall(call.group(1)))
+                key = format_id(data)
+                fmt = data.decode("utf-8", errors="replace")
+                if key in formats and formats[key] != fmt:
+                    collisions.append((key, formats[key], fmt))
+                formats[key] = fmt
+    return formats, collisions
+
+
+# ============================================================================
+# TRAMAS
+# ============================================================================
+
+def _varint(frame, index):
+    value = 0
+    shift = 0
+    while True:
+        byte = frame[index]
+        index += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, index
+
+
+def parse_frame(body):
+    """Cuerpo de la trama (desde el id) -> (id, nivel, millis, args, truncado)"""
+    key = struct.unpack_from("<I", body, 0)[0]
+    level = body[4]
+    timestamp, index = _varint(body, 5)
+    args = []
+    while index < len(body):
+        tag = body[index]
+        index += 1
+        if tag == TAG_INT:
+            value, index = _varint(body, index)
+            args.append((value >> 1) ^ -(value & 1))
+        elif tag in (TAG_UINT, TAG_POINTER):
+            value, index = _varint(body, index)
+            args.append(value)
+        elif tag == TAG_FLOAT:
+            args.append(struct.unpack_from("<f", body, index)[0])
+            index += 4
+        elif tag == TAG_DOUBLE:
+            args.append(struct.unpack_from("<d", body, index)[0])
+            index += 8
+        elif tag == TAG_STRING:
+            length = body[index]
+            args.append(body[index + 1:index + 1 + length].decode("utf-8", errors="replace"))
+            index += 1 + length
+        else:
+            raise ValueError("Tipo de argumento desconocido: %d" % tag)
+    return key, level & ~TRUNCATED, timestamp, args, bool(level & TRUNCATED)
+
+
+def render(fmt, args):
+    """printf de C con los argumentos decodificados"""
+    out = []
+    pending = list(args)
+    position = 0
+    for spec in _SPEC.finditer(fmt):
+        out.append(fmt[position:spec.start()])
+        position = spec.end()
+        flags, width, precision, _, conversion = spec.groups()
+        if conversion == "%":
+            out.append("%")
+            continue
+        if width == "*":
+            width = str(pending.pop(0)) if pending else ""
+        if precision == "*":
+            precision = str(pending.pop(0)) if pending else ""
+        if not pending:
+            break
+        value = pending.pop(0)
+        if conversion == "n":
+            continue
+        if conversion == "p":
+            conversion, flags, value = "x", (flags or "") + "#", int(value)
+        elif conversion in "uoxX" and isinstance(value, int) and value < 0:
+            value &= 0xFFFFFFFF
+        elif conversion == "c":
+            value = chr(value) if isinstance(value, int) else value
+        elif conversion in "aA":
+            conversion = "e" if conversion == "a" else "E"
+        python_spec = "%" + (flags or "") + (width or "")
+        if precision is not None:
+            python_spec += "." + precision
+        try:
+            out.append((python_spec + ("d" if conversion == "i" else conversion)) % value)
+        except (TypeError, ValueError):
+            out.append(str(value))
+    else:
+        out.append(fmt[position:])
+    return "".join(out)
+
+
+def format_line(formats, key, level, timestamp, args, truncated):
+    emoji, name = LEVELS.get(level, ("❓", "UNKNOWN"))
+    seconds = timestamp // 1000
+    fmt = formats.get(key)
+    text = render(fmt, args) if fmt is not None else "<formato 0x%08X desconocido> %r" % (key, args)
+    if truncated:
+        text += "~"
+    return "[%02d:%02d:%02d] %s [%s] %s" % (seconds // 3600, seconds // 60 % 60, seconds % 60, emoji, name, text)
+
+
+def decode_stream(chunks, formats, write):
+    """Separa tramas y texto de una secuencia de bloques de bytes"""
+    pending = bytearray()
+    text = codecs.getincrementaldecoder("utf-8")(errors="replace")  # Emojis partidos entre bloques
+    for chunk in chunks:
+        pending += chunk
+        while pending:
+            start = pending.find(bytes([SYNC]))
+            if start < 0:
+                write(text.decode(bytes(pending)))
+                pending.clear()
+                break
+            if start > 0:
+                write(text.decode(bytes(pending[:start])))
+                del pending[:start]
+            if len(pending) < 2 or len(pending) < 2 + pending[1] + 1:
+                break  # Trama incompleta: esperar más bytes
+            length = pending[1]
+            body = bytes(pending[2:2 + length])
+            checksum = 0
+            for byte in body:
+                checksum ^= byte
+            if length < 6 or checksum != pending[2 + length]:
+                del pending[:1]  # Sincronismo falso o trama dañada
+                continue
+            try:
+                write(format_line(formats, *parse_frame(body)) + "\n")
+            except (ValueError, IndexError, struct.error):
+                write("<trama inválida %s>\n" % body.hex())
+            del pending[:3 + length]
+
+
+# ============================================================================
+# MAIN
+# ============================================================================
+
+def _read_file(path):
+    with open(path, "rb") as capture:
+        while True:
+            chunk = capture.read(4096)
+            if not chunk:
+                return
+            yield chunk
+
+
+def _read_port(port, baud):
+    import serial  # pyserial
+
+    with serial.Serial(port, baud, timeout=0.1) as link:
+        while True:
+            chunk = link.read(256)
+            if chunk:
+                yield chunk
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decodifica el log binario del collar")
+    parser.add_argument("--port", help="Puerto serial (requiere pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--file", help="Captura binaria del puerto serial")
+    parser.add_argument("--src", default=SRC_DIR, help="Código fuente del firmware")
+    parser.add_argument("--list", action="store_true", help="Mostrar el diccionario de formatos")
+    options = parser.parse_args()
+
+    formats, collisions = build_dictionary(options.src)
+    for key, first, second in collisions:
+        sys.stderr.write("⚠️ Id 0x%08X repetido: %r / %r\n" % (key, first, second))
+
+    if options.list:
+        for key, fmt in sorted(formats.items()):
+            print("0x%08X  %s" % (key, fmt))
+        print("%d formatos" % len(formats))
+        return
+
+    if options.port:
+        chunks = _read_port(options.port, options.baud)
+    elif options.file:
+        chunks = _read_file(options.file)
+    else:
+        chunks = iter(lambda: sys.stdin.buffer.read(256), b"")
+
+    def write(text):
+        sys.stdout.write(text)
+        sys.stdout.flush()
+
+    try:
+        decode_stream(chunks, formats, write)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -35,6 +35,33 @@
 #define HEARTBEAT_INTERVAL 10000
 #define SERIAL_STATUS_INTERVAL 30000
 #define GEOFENCE_CHECK_INTERVAL 10000
+#define JOIN_RETRY_INTERVAL 30000
+#define BUTTON_DEBOUNCE_MS 50
+#define SCHEDULER_MAX_IDLE_MS 1000 // Tope de espera entre pasadas del scheduler
+
+// ============================================================================
+// TAREAS DE FREERTOS (núcleo 0: radio y GPS; núcleo 1: geocerca y UI)
+// ============================================================================
+#define TASK_GEOFENCE_CORE 1
+#define TASK_GEOFENCE_PRIORITY 4
+#define TASK_GEOFENCE_STACK 4096
+#define TASK_GPS_CORE 0
+#define TASK_GPS_PRIORITY 3
+#define TASK_GPS_STACK 4096
+#define TASK_RADIO_CORE 0
+#define TASK_RADIO_PRIORITY 2
+#define TASK_RADIO_STACK 8192 // RadioLib LoRaWAN usa bastante stack en join/sendReceive
+#define TASK_UI_CORE 1
+#define TASK_UI_PRIORITY 1
+#define TASK_UI_STACK 6144
+#define TASK_LOG_CORE 1
+#define TASK_LOG_PRIORITY 0 // Como la tarea idle: formatea cuando las demás esperan
+#define TASK_LOG_STACK 4096
+
+#define FIX_QUEUE_DEPTH 4
+#define RADIO_QUEUE_DEPTH 4
+#define UI_QUEUE_DEPTH 8
+#define GPS_POLL_INTERVAL 100 // Cada cuánto la tarea GPS drena el UART (ms)
 
 // ============================================================================
 // CONFIGURACIÓN DE GPS
@@ -49,6 +76,12 @@
 #define DISPLAY_WIDTH 128
 #define DISPLAY_HEIGHT 64
 #define DISPLAY_CONTRAST 255
+#define DISPLAY_MAX_REGIONS 16   // Rectángulos modificados por cuadro (FrameDiff)
+#define DISPLAY_I2C_CHUNK 32     // Bytes de datos por transacción I2C (buffer de Wire: 128)
+#define DISPLAY_I2C_CLOCK 700000 // Reloj del bus del OLED (el de SSD1306Wire)
+// Collar en el animal: OLED apagada salvo OLED_TIMEOUT_SLEEP (DisplayManager.h)
+// después de cada pulsación del botón PRG y del arranque
+#define DISPLAY_ON_DEMAND 1
 
 // ============================================================================
 // CONFIGURACIÓN DE BUZZER
@@ -58,25 +91,117 @@
 #define BUZZER_DEFAULT_VOLUME 128
 #define BUZZER_PWM_CHANNEL 0
 #define BUZZER_PWM_RESOLUTION 8
+#define TONE_QUEUE_DEPTH 8  // Melodías y tonos pendientes (ToneSequencer)
+#define TONE_NOTE_GAP_MS 50 // Silencio entre notas de una melodía
+#define TONE_TICK_MS 10     // Unidad de duración de las tablas de TonePatterns
+
+// Definiciones de volumen
+#define VOLUME_LOW 64
+#define VOLUME_MEDIUM 128
+#define VOLUME_HIGH 255
 
 // ============================================================================
 // CONFIGURACIÓN DE GEOCERCA (Distancias de alerta movidas a AlertManager.h)
 // ============================================================================
 #define GEOFENCE_MAX_NAME_LENGTH 32
+#define GEOFENCE_MAX_VERTICES 256  // Polígonos recibidos en fragmentos
 
 // Límites de geocerca
 #define MIN_GEOFENCE_RADIUS 10.0f
 #define MAX_GEOFENCE_RADIUS 10000.0f
 
+// Cambios de nivel de alerta (AlertFilter): el ruido del GPS junto a un umbral
+// no hace sonar y callar el buzzer en cada posición
+#define ALERT_HYSTERESIS_M 5.0f        // Para salir de un nivel hay que quedar este margen bajo su umbral
+#define ALERT_ESCALATE_DWELL_MS 5000   // Subir: la siguiente posición (GPS_UPDATE_INTERVAL) lo confirma
+#define ALERT_RELEASE_DWELL_MS 20000   // Bajar: la alerta sigue hasta estar 20 s bien adentro
+
+// Política de estímulos (StimulusPolicy): escalada CAUTION -> WARNING y tope diario
+#define STIMULUS_ADAPTIVE 1            // 0 = escalada a tiempo fijo
+#define STIMULUS_ESCALATE_MS 30000     // Sin respuesta en CAUTION (o mientras no aprendió)
+#define STIMULUS_DAILY_CAP 100         // Estímulos sonoros por día; 0 = sin tope
+#define STIMULUS_TURN_BACK_M 3.0f      // Alejarse esto del punto más externo cuenta como respuesta
+#define STIMULUS_MIN_SAMPLES 3         // Respuestas antes de usar lo aprendido
+#define STIMULUS_RESPONSE_FACTOR 2     // Escalada a este múltiplo del tiempo de respuesta habitual
+#define STIMULUS_MIN_ESCALATE_MS 10000
+#define STIMULUS_MAX_ESCALATE_MS 90000
+
+// Alerta anticipada (ApproachPredictor): velocidad filtrada contra el borde más cercano
+#define APPROACH_HORIZON_S 30.0f       // Cruce previsto antes de esto: CAUTION aunque esté lejos
+#define APPROACH_SMOOTHING 0.3f        // Peso de la última velocidad medida
+#define APPROACH_MIN_CLOSING 0.3f      // m/s hacia el borde; menos es pastoreo o ruido del GPS
+#define APPROACH_MAX_SPEED 8.0f        // m/s; más rápido es un salto del GPS
+#define APPROACH_MAX_GAP_MS 30000      // Sin posiciones en este tiempo se reinicia la velocidad
+
 // Límites de batería
 #define BATTERY_LOW 3.3f
 #define BATTERY_CRITICAL 3.1f
 
+// Estado de carga (BatteryEstimator): curva en reposo + carga contada con EnergyModel
+#define BATTERY_CAPACITY_MAH 2000.0f
+#define BATTERY_REST_SAMPLES 4           // Lecturas del ADC promediadas en reposo
+#define BATTERY_REST_NOISE_V 0.015f      // Incertidumbre de una lectura en reposo (ADC, relajación)
+#define BATTERY_MODEL_ERROR 0.2f         // Error relativo del consumo que estima EnergyModel
+#define BATTERY_CURRENT_SMOOTHING 0.05f  // Peso de cada intervalo en la corriente media (autonomía)
+
+// ============================================================================
+// ENERGÍA (light sleep automático entre tareas)
+// ============================================================================
+#define ENABLE_LIGHT_SLEEP 1
+#define LOW_POWER_CPU_MHZ 80       // Frecuencia máxima con trabajo en modo bajo consumo
+#define LOW_POWER_MIN_CPU_MHZ 40   // En reposo despierto (XTAL)
+#define GPS_UART_NUM 1             // Serial1
+#define GPS_UART_WAKE_THRESHOLD 3  // Flancos de RX para despertar (se pierden esos bytes)
+#define GPS_BURST_IDLE_MS 50       // Silencio que marca el fin de una ráfaga NMEA
+#define ENERGY_UPLINK_INTERVAL 21600000 // Consumo por subsistema (EnergyLedger) en LORAWAN_PORT_STATUS
+
+// Modo ciclo: deep sleep entre posiciones en potreros seguros (estado en RTC)
+#define ENABLE_DEEP_SLEEP_CYCLE 0
+#define DEEP_SLEEP_MIN_INSIDE_M 60.0f  // Distancia al borde necesaria para dormir
+#define DEEP_SLEEP_CAUTION_M 15.0f     // = -CAUTION_DISTANCE: no alcanzarla dormido
+#define DEEP_SLEEP_SAFE_FIXES 3        // Posiciones seguidas cumpliéndolo
+#define DEEP_SLEEP_ANIMAL_SPEED 1.0f   // m/s, caminata sostenida de una cabra
+#define DEEP_SLEEP_MIN_MS 30000
+#define DEEP_SLEEP_MAX_MS 600000
+#define DEEP_SLEEP_FIX_TIMEOUT 60000   // Sin fix al despertar: volver al modo normal
+#define DEEP_SLEEP_GPS_POWERED 0       // 1 = VEXT retenido durante el sueño (hot start, +25 mA)
+
 // ============================================================================
 // CONFIGURACIÓN DE SISTEMA
 // ============================================================================
 #define WATCHDOG_TIMEOUT 30000
 #define MIN_FREE_HEAP 10000
 #define PREF_NAMESPACE "collar"
+#define ENABLE_FAST_BOOT 1 // Reinicio en caliente: sin splash, melodía, esperas de VEXT ni sondeo del GPS
+
+// Log asíncrono: los LOG_x encolan formato y argumentos; la tarea de log escribe al UART
+#define ENABLE_ASYNC_LOG 1
+#define LOG_BUFFER_SLOTS 64 // Mensajes pendientes (potencia de dos)
+#define LOG_RECORD_ARGS 48  // Bytes de argumentos por mensaje; los %s se copian aquí
+
+// LOG_x por encima de este nivel no se compilan (1 = ERROR ... 4 = DEBUG)
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 4
+#endif
+
+// Log binario: id del formato y argumentos; se decodifica con scripts/log_decoder.py
+#ifndef ENABLE_BINARY_LOG
+#define ENABLE_BINARY_LOG 0
+#endif
+
+// Bitácora de eventos en RTC memory: sobrevive a watchdog, pánico y brownout
+#define TRACE_CAPACITY 256              // Eventos de 8 bytes (2 KB de RTC slow memory)
+#define TRACE_UPLOAD_INTERVAL 300000    // Entre trozos mientras hay una subida pendiente
+#define TRACE_CHUNK_SIZE 51             // Uplink máximo en DR0 (AU915): 5 eventos por trozo
+#define TRACE_CRASH_EVENTS 30           // Se suben solos tras un pánico, watchdog o brownout
+
+// ============================================================================
+// PERFILADO (solo para depuración; se puede activar con -DENABLE_PROFILER=1)
+// ============================================================================
+#ifndef ENABLE_PROFILER
+#define ENABLE_PROFILER 0
+#endif
+#define PROFILER_UPLINK_INTERVAL 3600000 // Uplink de depuración en LORAWAN_PORT_STATUS
+#define PROFILER_CHUNK_SIZE 51           // Uplink máximo en DR0 (AU915): 4 sitios por trozo
 
 #endif // CONSTANTS_H
@@ -10,6 +10,8 @@
 #ifndef LORAWAN_CONFIG_H
 #define LORAWAN_CONFIG_H
 
+#include "../core/Types.h"
+
 // ============================================================================
 // CONFIGURACIÓN DE REGIÓN
 // ============================================================================
@@ -35,6 +37,8 @@
 #define TX_INTERVAL_NORMAL 60000      // 1 minuto normal
 #define TX_INTERVAL_ALERT 30000       // 30 segundos en alerta
 #define TX_INTERVAL_EMERGENCY 15000   // 15 segundos en emergencia
+#define LINK_STATUS_INTERVAL 3600000  // 1 hora: uplink de calidad de enlace (LinkQuality)
+#define LORAWAN_UPLINK_RETRIES 1      // Reintentos ante timeout de TX (canal ocupado)
 
 // ============================================================================
 // CONFIGURACIÓN DE JOIN
@@ -42,21 +46,40 @@
 #define JOIN_RETRY_INTERVAL 30000     // 30 segundos entre intentos
 #define JOIN_MAX_RETRIES 10            // Máximo de reintentos
 
+// ============================================================================
+// PERSISTENCIA DE SESIÓN (NVS)
+// ============================================================================
+#define SESSION_FCNT_LOG_INTERVAL 16  // Uplinks entre escrituras del FCnt (= salto al restaurar)
+#define SESSION_FLUSH_INTERVAL 16     // Uplinks máximos con cambios de sesión solo en RAM
+
+// ============================================================================
+// DOWNLINKS DE GEOCERCA (PUERTO LORAWAN_PORT_CONFIG)
+// ============================================================================
+#define GEOFENCE_CMD_CIRCLE 0x00             // Círculo
+#define GEOFENCE_CMD_POLYGON 0x01            // Polígono float (≤10 puntos)
+#define GEOFENCE_CMD_POLYGON_COMPRESSED 0x02 // Polígono con offsets en metros
+#define GEOFENCE_CMD_POLYGON_LARGE 0x03      // Polígono float con uint16 puntos (fragmentado)
+#define GEOFENCE_CMD_POLYGON_VARINT 0x04     // Polígono int32 + deltas varint (utils/PolygonCodec.h)
+#define GEOFENCE_CMD_IDENTIFIED 0x05         // [0x05][fenceId(2)][versión(1)] + comando completo
+#define GEOFENCE_CMD_FRAGMENT 0x10           // Fragmento de cualquiera de los anteriores
+#define GEOFENCE_CMD_DELTA 0x20              // Edición incremental (utils/GeofenceDelta.h)
+
+#define GEOFENCE_FRAGMENT_TIMEOUT 7200000    // 2 h: un fragmento por uplink en clase A
+
 // ============================================================================
 // ESTRUCTURA DE ACTUALIZACIÓN DE GEOCERCA
 // ============================================================================
 struct GeofenceUpdate {
-    uint8_t type;           // 0=círculo, 1=polígono
+    uint8_t type;           // GEOFENCE_CMD_* del comando decodificado
     char name[32];          // Nombre de la geocerca
     char groupId[16];       // ID del grupo
     double centerLat;
     double centerLng;
     float radius;
-    uint8_t pointCount;     // Número de puntos del polígono
-    struct {
-        double lat;
-        double lng;
-    } points[10];           // Array de puntos (máximo 10)
+    uint16_t pointCount;    // Número de puntos del polígono
+    const GeoPoint *points; // Vértices decodificados (válidos durante el callback)
+    uint16_t fenceId;       // Identidad para deltas (0 si llegó sin GEOFENCE_CMD_IDENTIFIED)
+    uint8_t version;
 };
 
 #endif // LORAWAN_CONFIG_H
@@ -1,5 +1,8 @@
 #include "Logger.h"
 #include <stdarg.h>
+#include "../system/LogBuffer.h"
+#include "../system/Rtos.h"
+#include "../utils/StringUtils.h"
 
 // ============================================================================
 // VARIABLES ESTÁTICAS
@@ -7,6 +10,15 @@
 Logger::Level Logger::currentLevel = Logger::DEBUG;
 bool Logger::initialized = false;
 uint32_t Logger::bootTime = 0;
+bool Logger::asyncStarted = false;
+uint32_t Logger::reportedDrops = 0;
+
+#if ENABLE_ASYNC_LOG
+static LogBuffer logBuffer;
+static RtosQueue<uint8_t, 1> logSignal; // Despierta a la tarea de log
+static RtosTask logTaskHandle;
+static RtosMutex drainMutex;            // La tarea y flush() no intercalan líneas
+#endif
 
 // ============================================================================
 // IMPLEMENTACIÓN PÚBLICA
@@ -50,7 +62,7 @@ void Logger::error(const char *message, ...)
     {
         va_list args;
         va_start(args, message);
-        logWithLevel(ERROR, "ERROR", message, args);
+        logWithLevel(ERROR, message, args);
         va_end(args);
     }
 }
@@ -61,7 +73,7 @@ void Logger::warn(const char *message, ...)
     {
         va_list args;
         va_start(args, message);
-        logWithLevel(WARN, "WARN", message, args);
+        logWithLevel(WARN, message, args);
         va_end(args);
     }
 }
@@ -72,7 +84,7 @@ void Logger::info(const char *message, ...)
     {
         va_list args;
         va_start(args, message);
-        logWithLevel(INFO, "INFO", message, args);
+        logWithLevel(INFO, message, args);
         va_end(args);
     }
 }
@@ -83,7 +95,7 @@ void Logger::debug(const char *message, ...)
     {
         va_list args;
         va_start(args, message);
-        logWithLevel(DEBUG, "DEBUG", message, args);
+        logWithLevel(DEBUG, message, args);
         va_end(args);
     }
 }
@@ -91,16 +103,17 @@ void Logger::debug(const char *message, ...)
 // ============================================================================
 // MÉTODOS ESPECÍFICOS DEL SISTEMA
 // ============================================================================
+// Pasan por los LOG_x: respetan LOG_COMPILE_LEVEL y el log binario
 
 void Logger::logSystemInit(const char *component, bool success)
 {
     if (success)
     {
-        info("✅ %s inicializado correctamente", component);
+        LOG_I("✅ %s inicializado correctamente", component);
     }
     else
     {
-        error("❌ Error inicializando %s", component);
+        LOG_E("❌ Error inicializando %s", component);
     }
 }
 
@@ -111,8 +124,8 @@ void Logger::logGeofenceEvent(float distance, uint8_t alertLevel)
 
     if (alertLevel < 5)
     {
-        info("%s Geocerca - Distancia: %.1fm, Nivel: %s",
-             emojis[alertLevel], distance, levelNames[alertLevel]);
+        LOG_I("%s Geocerca - Distancia: %.1fm, Nivel: %s",
+              emojis[alertLevel], distance, levelNames[alertLevel]);
     }
 }
 
@@ -120,11 +133,11 @@ void Logger::logPacketSent(uint16_t sequenceNumber, bool success)
 {
     if (success)
     {
-        info("📡 Packet #%d enviado correctamente", sequenceNumber);
+        LOG_I("📡 Packet #%d enviado correctamente", sequenceNumber);
     }
     else
     {
-        warn("📡 Error enviando packet #%d", sequenceNumber);
+        LOG_W("📡 Error enviando packet #%d", sequenceNumber);
     }
 }
 
@@ -138,28 +151,28 @@ void Logger::logBatteryStatus(float voltage, uint8_t percentage)
     else
         emoji = "🔋";
 
-    info("%s Batería: %.2fV (%d%%)", emoji, voltage, percentage);
+    LOG_I("%s Batería: %.2fV (%d%%)", emoji, voltage, percentage);
 }
 
 void Logger::logGPSPosition(double lat, double lng, bool valid)
 {
     if (valid)
     {
-        info("📍 GPS: %.6f, %.6f", lat, lng);
+        LOG_I("📍 GPS: %.6f, %.6f", lat, lng);
     }
     else
     {
-        warn("📍 GPS sin fix válido");
+        LOG_W("📍 GPS sin fix válido");
     }
 }
 
 void Logger::logMemoryStatus(uint32_t freeHeap)
 {
-    debug("💾 Memoria libre: %lu bytes", freeHeap);
+    LOG_D("💾 Memoria libre: %lu bytes", freeHeap);
 
     if (freeHeap < 10000)
     {
-        warn("💾 Memoria baja: %lu bytes", freeHeap);
+        LOG_W("💾 Memoria baja: %lu bytes", freeHeap);
     }
 }
 
@@ -181,8 +194,10 @@ void Logger::printBanner()
     Serial.println("📡 Radio: SX1262 LoRaWAN");
     Serial.println("📺 Display: OLED 128x64 I2C");
     Serial.println("🎵 Audio: Buzzer PWM optimizado");
-    Serial.println("🎯 Firmware: " + String(FIRMWARE_VERSION));
-    Serial.println("🏭 Fabricante: " + String(MANUFACTURER));
+    Serial.print("🎯 Firmware: ");
+    Serial.println(FIRMWARE_VERSION);
+    Serial.print("🏭 Fabricante: ");
+    Serial.println(MANUFACTURER);
     Serial.println("🚀 ===============================================");
     Serial.println();
 }
@@ -245,22 +260,146 @@ void Logger::printSystemInfo()
 // MÉTODOS PRIVADOS
 // ============================================================================
 
-void Logger::logWithLevel(Level level, const char *prefix, const char *message, va_list args)
+void Logger::logWithLevel(Level level, const char *message, va_list args)
 {
     if (!initialized)
         return;
 
+#if ENABLE_ASYNC_LOG
+    if (asyncStarted)
+    {
+        // Sin formatear ni esperar al UART: la tarea de log lo hace después
+        if (logBuffer.push(level, millis(), message, args))
+        {
+            uint8_t signal = 0;
+            logSignal.send(signal, 0);
+        }
+        return;
+    }
+#endif
+
     char buffer[256];
     vsnprintf(buffer, sizeof(buffer), message, args);
+    writeLine(level, millis(), buffer);
+}
+
+void Logger::writeBinary(Level level, uint32_t formatId, const BinaryLog::Arg *args, size_t count)
+{
+    if (!initialized || currentLevel < level)
+        return;
 
-    uint32_t uptime = getUptime();
-    uint32_t hours = uptime / 3600;
-    uint32_t minutes = (uptime % 3600) / 60;
-    uint32_t seconds = uptime % 60;
+    // Tramas de pocos bytes: entran en el buffer del UART sin pasar por la
+    // tarea de log. Una sola escritura, así que no se intercalan entre tareas
+    uint8_t frame[BinaryLog::MAX_FRAME];
+    size_t length = BinaryLog::encode(frame, sizeof(frame), level, millis(), formatId, args, count);
+    Serial.write(frame, length);
+}
 
-    Serial.printf("[%02lu:%02lu:%02lu] %s [%s] %s\n",
-                  hours, minutes, seconds,
-                  getLevelEmoji(level), prefix, buffer);
+void Logger::writeLine(Level level, uint32_t timestamp, const char *text)
+{
+    unsigned long uptime = (timestamp - bootTime) / 1000;
+    unsigned long hours = uptime / 3600;
+    unsigned long minutes = (uptime % 3600) / 60;
+    unsigned long seconds = uptime % 60;
+
+    // Print::printf reserva heap para líneas de más de 64 bytes: se arma en el stack
+    char line[320];
+    size_t length = StringUtils::Writer(line, sizeof(line))
+                        .printf("[%02lu:%02lu:%02lu] %s [%s] ", hours, minutes, seconds,
+                                getLevelEmoji(level), getLevelString(level))
+                        .print(text)
+                        .print('\n')
+                        .length();
+    if (line[length - 1] != '\n')
+    {
+        line[length - 1] = '\n'; // Cortada: el salto de línea no se pierde
+    }
+    Serial.write((const uint8_t *)line, length);
+}
+
+// ============================================================================
+// LOG ASÍNCRONO
+// ============================================================================
+
+void Logger::startAsync()
+{
+#if ENABLE_ASYNC_LOG
+    if (!initialized || asyncStarted)
+        return;
+
+    if (!logTaskHandle.start("log", logTask, nullptr, TASK_LOG_STACK, TASK_LOG_PRIORITY, TASK_LOG_CORE))
+    {
+        warn("No se pudo crear la tarea de log: se mantiene el log síncrono");
+        return;
+    }
+    asyncStarted = true;
+#endif
+}
+
+void Logger::flush()
+{
+#if ENABLE_ASYNC_LOG
+    if (asyncStarted)
+    {
+        drain();
+    }
+#endif
+    Serial.flush();
+}
+
+uint32_t Logger::getDropped()
+{
+#if ENABLE_ASYNC_LOG
+    return logBuffer.getDropped();
+#else
+    return 0;
+#endif
+}
+
+uint32_t Logger::getHighWater()
+{
+#if ENABLE_ASYNC_LOG
+    return logBuffer.getHighWater();
+#else
+    return 0;
+#endif
+}
+
+void Logger::drain()
+{
+#if ENABLE_ASYNC_LOG
+    RtosLock lock(drainMutex);
+
+    LogBuffer::Record record;
+    char buffer[256];
+    while (logBuffer.pop(record))
+    {
+        LogBuffer::format(record, buffer, sizeof(buffer));
+        writeLine((Level)record.level, record.timestamp, buffer);
+    }
+
+    uint32_t dropped = logBuffer.getDropped();
+    if (dropped != reportedDrops)
+    {
+        snprintf(buffer, sizeof(buffer), "📝 %lu mensajes de log descartados (cola llena)",
+                 (unsigned long)(dropped - reportedDrops));
+        writeLine(WARN, millis(), buffer);
+        reportedDrops = dropped;
+    }
+#endif
+}
+
+void Logger::logTask(void *context)
+{
+#if ENABLE_ASYNC_LOG
+    uint8_t signal;
+    for (;;)
+    {
+        // Bloqueada mientras no haya mensajes: no impide el light sleep
+        logSignal.receive(signal, RTOS_WAIT_FOREVER);
+        drain();
+    }
+#endif
 }
 
 const char *Logger::getLevelString(Level level)
@@ -296,8 +435,3 @@ const char *Logger::getLevelEmoji(Level level)
         return "❓";
     }
 }
-
-uint32_t Logger::getUptime()
-{
-    return initialized ? (millis() - bootTime) / 1000 : 0;
-}
@@ -2,6 +2,7 @@
 #include <Arduino.h> 
 #include "../config/pins.h"
 #include "../config/constants.h"  
+#include "../system/BinaryLog.h"
 /*
  * ============================================================================
  * SISTEMA DE LOGGING AVANZADO - COLLAR GEOFENCING
@@ -32,32 +33,97 @@ public:
     // Banner y información del sistema
     static void printBanner();
     static void printSystemInfo();
+
+    // Log asíncrono (ENABLE_ASYNC_LOG): desde startAsync() los mensajes se
+    // encolan y la tarea de log los formatea y escribe. Antes, síncrono
+    static void startAsync();
+    static void flush();          // Escribe lo pendiente ya (antes de dormir o reiniciar)
+    static uint32_t getDropped(); // Mensajes descartados con la cola llena
+    static uint32_t getHighWater(); // Máximo de mensajes pendientes a la vez
+
+    // Log binario (ENABLE_BINARY_LOG): trama con el id del formato y los
+    // argumentos, sin formatear. Se usa a través de los LOG_x
+    template <typename... Args>
+    static void binary(Level level, uint32_t formatId, const Args&... args) {
+        const BinaryLog::Arg list[] = {BinaryLog::Arg(args)..., BinaryLog::Arg()};
+        writeBinary(level, formatId, list, sizeof...(Args));
+    }
     
 private:
     static Level currentLevel;
     static bool initialized;
     static uint32_t bootTime;
     
-    static void logWithLevel(Level level, const char* prefix, const char* message, va_list args);
+    static bool asyncStarted;
+    static uint32_t reportedDrops;
+    
+    static void logWithLevel(Level level, const char* message, va_list args);
+    static void writeLine(Level level, uint32_t timestamp, const char* text);
+    static void drain();
+    static void writeBinary(Level level, uint32_t formatId, const BinaryLog::Arg* args, size_t count);
+    static void logTask(void* context);
     static const char* getLevelString(Level level);
     static const char* getLevelEmoji(Level level);
-    static uint32_t getUptime();
 };
 
+// ============================================================================
+// NIVELES PARA EL PREPROCESADOR (iguales a Logger::Level)
+// ============================================================================
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
 // ============================================================================
 // MACROS DE CONVENIENCIA
 // ============================================================================
+// Los LOG_x por encima de LOG_COMPILE_LEVEL no generan código ni dejan el
+// formato en flash; los argumentos se siguen compilando (no se evalúan).
+// Con ENABLE_BINARY_LOG el formato se reemplaza por su id en compilación:
+// tiene que ser un literal
+#if ENABLE_BINARY_LOG
+#define LOG_EMIT_(level, format, ...) \
+    Logger::binary(level, std::integral_constant<uint32_t, BinaryLog::formatId(format)>::value, ##__VA_ARGS__)
+#define LOG_E(...) LOG_EMIT_(Logger::ERROR, __VA_ARGS__)
+#define LOG_W(...) LOG_EMIT_(Logger::WARN, __VA_ARGS__)
+#define LOG_I(...) LOG_EMIT_(Logger::INFO, __VA_ARGS__)
+#define LOG_D(...) LOG_EMIT_(Logger::DEBUG, __VA_ARGS__)
+#else
 #define LOG_E(...) Logger::error(__VA_ARGS__)
 #define LOG_W(...) Logger::warn(__VA_ARGS__)
 #define LOG_I(...) Logger::info(__VA_ARGS__)
 #define LOG_D(...) Logger::debug(__VA_ARGS__)
+#endif
+
+#define LOG_DISCARD_(...)                 \
+    do                                    \
+    {                                     \
+        if (false)                        \
+        {                                 \
+            Logger::debug(__VA_ARGS__);   \
+        }                                 \
+    } while (0)
+
+#if LOG_COMPILE_LEVEL < LOG_LEVEL_ERROR
+#undef LOG_E
+#define LOG_E(...) LOG_DISCARD_(__VA_ARGS__)
+#endif
+#if LOG_COMPILE_LEVEL < LOG_LEVEL_WARN
+#undef LOG_W
+#define LOG_W(...) LOG_DISCARD_(__VA_ARGS__)
+#endif
+#if LOG_COMPILE_LEVEL < LOG_LEVEL_INFO
+#undef LOG_I
+#define LOG_I(...) LOG_DISCARD_(__VA_ARGS__)
+#endif
+#if LOG_COMPILE_LEVEL < LOG_LEVEL_DEBUG
+#undef LOG_D
+#define LOG_D(...) LOG_DISCARD_(__VA_ARGS__)
+#endif
 
 #define LOG_INIT(component, success) Logger::logSystemInit(component, success)
 #define LOG_GEOFENCE(distance, level) Logger::logGeofenceEvent(distance, level)
 #define LOG_PACKET(seq, success) Logger::logPacketSent(seq, success)
 #define LOG_BATTERY(voltage, percentage) Logger::logBatteryStatus(voltage, percentage)
 #define LOG_GPS(lat, lng, valid) Logger::logGPSPosition(lat, lng, valid)
-
-// Niveles de logging
-#define LOG_LEVEL 5
-#define LOG_LEVEL_DEBUG 4
\ No newline at end of file
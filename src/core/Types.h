@@ -1,5 +1,10 @@
 #pragma once
+#ifdef ARDUINO
 #include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
 #include <string.h>
 
 // --- Enum de Resultado ---
@@ -53,6 +58,7 @@ struct BatteryStatus
     bool low = false;
     bool critical = false;
     uint32_t lastReading = 0;
+    uint16_t remainingHours = 0xFFFF; // Autonomía estimada (0xFFFF = sin estimación)
 };
 struct SystemStatus
 {
@@ -90,11 +96,21 @@ struct Geofence
     float radius;
     static const uint8_t MAX_POLYGON_POINTS = 10;
     GeoPoint points[MAX_POLYGON_POINTS];
-    uint8_t pointCount;
+    uint16_t pointCount;
+
+    // Polígonos grandes (> MAX_POLYGON_POINTS): vértices en memoria externa,
+    // propiedad de GeofenceManager. nullptr si se usan los puntos internos.
+    const GeoPoint *vertices;
+
+    // Identidad asignada por el backend para las actualizaciones incrementales
+    // (GEOFENCE_CMD_DELTA). 0/0 si la geocerca llegó sin identificar.
+    uint16_t fenceId;
+    uint8_t version;
 
     // Constructores
     Geofence() : type(GeofenceType::CIRCLE), active(false), isConfigured(false),
-                 centerLat(0.0), centerLng(0.0), radius(0.0), pointCount(0)
+                 centerLat(0.0), centerLng(0.0), radius(0.0), pointCount(0), vertices(nullptr),
+                 fenceId(0), version(0)
     {
         strcpy(name, "Default");
         strcpy(groupId, "none");
@@ -103,7 +119,8 @@ struct Geofence
     // Constructor para círculo
     Geofence(double lat, double lng, float r, const char *n, const char *gid)
         : type(GeofenceType::CIRCLE), active(true), isConfigured(true),
-          centerLat(lat), centerLng(lng), radius(r), pointCount(0)
+          centerLat(lat), centerLng(lng), radius(r), pointCount(0), vertices(nullptr),
+          fenceId(0), version(0)
     {
         strncpy(name, n, sizeof(name) - 1);
         name[sizeof(name) - 1] = '\0';
@@ -111,10 +128,12 @@ struct Geofence
         groupId[sizeof(groupId) - 1] = '\0';
     }
 
-    // Constructor para polígono
-    Geofence(const GeoPoint *pts, uint8_t count, const char *n, const char *gid)
+    // Constructor para polígono. Hasta MAX_POLYGON_POINTS se copian; más
+    // grandes referencian pts, que debe seguir vivo mientras se use la geocerca.
+    Geofence(const GeoPoint *pts, uint16_t count, const char *n, const char *gid)
         : type(GeofenceType::POLYGON), active(true), isConfigured(true),
-          centerLat(0.0), centerLng(0.0), radius(0.0), pointCount(count)
+          centerLat(0.0), centerLng(0.0), radius(0.0), pointCount(count), vertices(nullptr),
+          fenceId(0), version(0)
     {
         strncpy(name, n, sizeof(name) - 1);
         name[sizeof(name) - 1] = '\0';
@@ -122,12 +141,19 @@ struct Geofence
         groupId[sizeof(groupId) - 1] = '\0';
 
         // Copiar puntos y calcular centro
-        if (pts && count > 0 && count <= MAX_POLYGON_POINTS)
+        if (pts && count > 0)
         {
+            if (count > MAX_POLYGON_POINTS)
+            {
+                vertices = pts;
+            }
             double sumLat = 0, sumLng = 0;
-            for (uint8_t i = 0; i < count; i++)
+            for (uint16_t i = 0; i < count; i++)
             {
-                points[i] = pts[i];
+                if (count <= MAX_POLYGON_POINTS)
+                {
+                    points[i] = pts[i];
+                }
                 sumLat += pts[i].lat;
                 sumLng += pts[i].lng;
             }
@@ -135,21 +161,14 @@ struct Geofence
             centerLng = sumLng / count;
         }
     }
-};
-// GeofenceUpdate está definido en lorawan_config.h
-struct AlertConfig
-{
-    bool enabled;
-    uint16_t frequency;
-    uint16_t duration;
-    uint8_t volume;
-    uint16_t interval;
-    uint8_t repetitions;
 
-    // Constructor para inicializar fácilmente
-    AlertConfig(uint16_t freq = 0, uint16_t dur = 0, uint8_t vol = 0)
-        : enabled(true), frequency(freq), duration(dur), volume(vol), interval(1000), repetitions(0) {}
+    const GeoPoint *getPoints() const
+    {
+        return vertices ? vertices : points;
+    }
 };
+// GeofenceUpdate está definido en lorawan_config.h
+// Las cadencias de alerta por nivel son patrones de utils/TonePatterns.h
 
 // --- Funciones de ayuda ---
 inline const char *alertLevelToString(AlertLevel level)
@@ -1,30 +1,6 @@
 #include "BuzzerManager.h"
 #include "../core/Logger.h"
 
-// ============================================================================
-// MELODÍAS PREDEFINIDAS
-// ============================================================================
-const BuzzerManager::Note BuzzerManager::STARTUP_MELODY[] = {
-    {NOTE_C4, 200}, {NOTE_E4, 200}, {NOTE_G4, 200}, {NOTE_C5, 400}};
-
-const BuzzerManager::Note BuzzerManager::SHUTDOWN_MELODY[] = {
-    {NOTE_C5, 200}, {NOTE_G4, 200}, {NOTE_E4, 200}, {NOTE_C4, 400}};
-
-const BuzzerManager::Note BuzzerManager::SUCCESS_MELODY[] = {
-    {NOTE_G4, 150}, {NOTE_C5, 150}, {NOTE_E5, 300}};
-
-const BuzzerManager::Note BuzzerManager::ERROR_MELODY[] = {
-    {NOTE_A4, 100}, {0, 50}, {NOTE_A4, 100}, {0, 50}, {NOTE_A4, 200}};
-
-const BuzzerManager::Note BuzzerManager::WARNING_MELODY[] = {
-    {NOTE_F4, 200}, {NOTE_A4, 200}, {NOTE_F4, 200}};
-
-const size_t BuzzerManager::STARTUP_MELODY_SIZE = sizeof(STARTUP_MELODY) / sizeof(Note);
-const size_t BuzzerManager::SHUTDOWN_MELODY_SIZE = sizeof(SHUTDOWN_MELODY) / sizeof(Note);
-const size_t BuzzerManager::SUCCESS_MELODY_SIZE = sizeof(SUCCESS_MELODY) / sizeof(Note);
-const size_t BuzzerManager::ERROR_MELODY_SIZE = sizeof(ERROR_MELODY) / sizeof(Note);
-const size_t BuzzerManager::WARNING_MELODY_SIZE = sizeof(WARNING_MELODY) / sizeof(Note);
-
 // ============================================================================
 // CONSTRUCTOR E INICIALIZACIÓN
 // ============================================================================
@@ -33,15 +9,18 @@ BuzzerManager::BuzzerManager(uint8_t pin) : buzzerPin(pin),
                                             initialized(false),
                                             enabled(true),
                                             currentVolume(VOLUME_MEDIUM),
-                                            playing(false),
-                                            playStartTime(0),
-                                            playDuration(0),
-                                            continuousAlertActive(false),
+                                            timer(nullptr),
+                                            awakeLock(nullptr),
+                                            awake(false),
+                                            sounding(false),
+                                            toneSince(0),
+                                            toneTimeMs(0),
                                             currentAlertLevel(AlertLevel::SAFE),
-                                            lastAlertTime(0),
-                                            alertRepetitionCount(0)
+                                            alertPatterns{TonePatterns::PATTERN_NONE,
+                                                          TonePatterns::PATTERN_ALERT_CAUTION,
+                                                          TonePatterns::PATTERN_ALERT_WARNING}
 {
-    initializeAlertConfigs();
+    sequencer.setOutput(onOutput, this);
 }
 
 Result BuzzerManager::init()
@@ -51,6 +30,13 @@ Result BuzzerManager::init()
         return Result::SUCCESS;
     }
 
+    // Inicialización diferida desde dos tareas: una sola crea timer y candado
+    RtosLock lock(sequencerMutex);
+    if (initialized)
+    {
+        return Result::SUCCESS;
+    }
+
     LOG_I("🎵 Inicializando Buzzer Manager...");
 
     // Configurar pin
@@ -60,6 +46,22 @@ Result BuzzerManager::init()
     // Configurar PWM
     setupPWM();
 
+    // Timer de los bordes de nota. Corre en la tarea de esp_timer y no en la
+    // ISR: ledcWriteTone reconfigura el timer del LEDC y no es seguro en ISR
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = onTimer;
+    timerArgs.arg = this;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "buzzer";
+    if (esp_timer_create(&timerArgs, &timer) != ESP_OK)
+    {
+        LOG_E("❌ No se pudo crear el timer del buzzer");
+        return Result::ERROR_INIT;
+    }
+
+    // Sin CONFIG_PM_ENABLE falla y no hace falta: no hay light sleep
+    esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "buzzer", &awakeLock);
+
     initialized = true;
     LOG_INIT("Buzzer Manager", true);
 
@@ -80,72 +82,83 @@ void BuzzerManager::playTone(uint16_t frequency, uint16_t duration, uint8_t volu
     if (!initialized || !enabled)
         return;
 
-    playToneInternal(frequency, volume);
-    delay(duration);
-    stopToneInternal();
+    RtosLock lock(sequencerMutex);
+    if (!sequencer.enqueueTone(frequency, duration, volume))
+    {
+        LOG_W("⚠️ Cola del buzzer llena: tono descartado");
+        return;
+    }
+    service();
 }
 
-void BuzzerManager::playToneAsync(uint16_t frequency, uint16_t duration, uint8_t volume)
+void BuzzerManager::stopTone()
 {
-    if (!initialized || !enabled)
+    if (!initialized)
         return;
 
-    playToneInternal(frequency, volume);
-    playing = true;
-    playStartTime = millis();
-    playDuration = duration;
+    RtosLock lock(sequencerMutex);
+    currentAlertLevel = AlertLevel::SAFE;
+    sequencer.stop();
+    service();
 }
 
-void BuzzerManager::stopTone()
+bool BuzzerManager::isPlaying() const
 {
-    stopToneInternal();
-    playing = false;
+    RtosLock lock(sequencerMutex);
+    return sequencer.isPlaying();
 }
 
-bool BuzzerManager::isPlaying() const
+uint32_t BuzzerManager::getToneTimeMs() const
 {
-    return playing;
+    RtosLock lock(sequencerMutex);
+    return toneTimeMs + (sounding ? millis() - toneSince : 0);
 }
 
 // ============================================================================
 // MELODÍAS PREDEFINIDAS
 // ============================================================================
 
+bool BuzzerManager::playPattern(uint8_t id)
+{
+    const TonePatterns::Pattern *pattern = TonePatterns::find(id);
+    if (!initialized || !enabled || !pattern)
+        return false;
+
+    RtosLock lock(sequencerMutex);
+    if (!sequencer.enqueue(*pattern))
+    {
+        LOG_W("⚠️ Cola del buzzer llena: patrón %d descartado", id);
+        return false;
+    }
+    service();
+    return true;
+}
+
 void BuzzerManager::playStartupMelody()
 {
-    if (!initialized || !enabled)
-        return;
     LOG_D("🎵 Reproduciendo melodía de inicio");
-    playMelody(STARTUP_MELODY, STARTUP_MELODY_SIZE, VOLUME_MEDIUM);
+    playPattern(TonePatterns::PATTERN_STARTUP);
 }
 
 void BuzzerManager::playShutdownMelody()
 {
-    if (!initialized || !enabled)
-        return;
     LOG_D("🎵 Reproduciendo melodía de apagado");
-    playMelody(SHUTDOWN_MELODY, SHUTDOWN_MELODY_SIZE, VOLUME_MEDIUM);
+    playPattern(TonePatterns::PATTERN_SHUTDOWN);
 }
 
 void BuzzerManager::playSuccessTone()
 {
-    if (!initialized || !enabled)
-        return;
-    playMelody(SUCCESS_MELODY, SUCCESS_MELODY_SIZE, VOLUME_MEDIUM);
+    playPattern(TonePatterns::PATTERN_SUCCESS);
 }
 
 void BuzzerManager::playErrorTone()
 {
-    if (!initialized || !enabled)
-        return;
-    playMelody(ERROR_MELODY, ERROR_MELODY_SIZE, VOLUME_HIGH);
+    playPattern(TonePatterns::PATTERN_ERROR);
 }
 
 void BuzzerManager::playWarningTone()
 {
-    if (!initialized || !enabled)
-        return;
-    playMelody(WARNING_MELODY, WARNING_MELODY_SIZE, VOLUME_HIGH);
+    playPattern(TonePatterns::PATTERN_WARNING);
 }
 
 // ============================================================================
@@ -154,16 +167,11 @@ void BuzzerManager::playWarningTone()
 
 void BuzzerManager::playAlertLevel(AlertLevel level)
 {
-    if (!initialized || !enabled)
-        return;
-
-    const AlertConfig &config = alertConfigs[static_cast<uint8_t>(level)];
-
-    if (config.enabled)
+    // Una sola repetición de la cadencia del nivel
+    uint8_t id = getAlertPattern(level);
+    if (playPattern(id))
     {
-        playTone(config.frequency, config.duration, config.volume);
-        LOG_D("🔊 Alerta nivel %s: %dHz, %dms",
-              alertLevelToString(level), config.frequency, config.duration);
+        LOG_D("🔊 Alerta nivel %s: patrón %d", alertLevelToString(level), id);
     }
 }
 
@@ -172,38 +180,66 @@ void BuzzerManager::startContinuousAlert(AlertLevel level)
     if (!initialized || !enabled)
         return;
 
-    continuousAlertActive = true;
+    RtosLock lock(sequencerMutex);
     currentAlertLevel = level;
-    lastAlertTime = 0; // Forzar reproducción inmediata
-    alertRepetitionCount = 0;
+    loopAlertPattern();
+    service();
 
-    LOG_D("🚨 Iniciando alerta continua nivel %s", alertLevelToString(level));
+    LOG_D("🚨 Alerta continua nivel %s: patrón %d",
+          alertLevelToString(level), alertPatterns[static_cast<uint8_t>(level)]);
 }
 
 void BuzzerManager::stopContinuousAlert()
 {
-    continuousAlertActive = false;
-    stopTone();
+    if (!initialized)
+        return;
+
+    RtosLock lock(sequencerMutex);
+    currentAlertLevel = AlertLevel::SAFE;
+    sequencer.stopLoop();
+    service();
     LOG_D("🔇 Deteniendo alerta continua");
 }
 
-bool BuzzerManager::isContinousAlertActive()
+bool BuzzerManager::isContinousAlertActive() const
 {
-    return continuousAlertActive;
+    RtosLock lock(sequencerMutex);
+    return sequencer.isLooping();
 }
 
 // ============================================================================
 // CONFIGURACIÓN
 // ============================================================================
 
-void BuzzerManager::setAlertConfig(AlertLevel level, const AlertConfig &config)
+bool BuzzerManager::setAlertPattern(AlertLevel level, uint8_t id)
 {
-    alertConfigs[static_cast<uint8_t>(level)] = config;
+    uint8_t index = static_cast<uint8_t>(level);
+    if (index >= 3 || (id != TonePatterns::PATTERN_NONE && !TonePatterns::find(id)))
+    {
+        return false;
+    }
+
+    RtosLock lock(sequencerMutex);
+    alertPatterns[index] = id;
+    if (initialized && level != AlertLevel::SAFE && level == currentAlertLevel)
+    {
+        loopAlertPattern();
+        service();
+    }
+
+    LOG_I("🔊 Cadencia del nivel %s: patrón %d", alertLevelToString(level), id);
+    return true;
 }
 
-AlertConfig BuzzerManager::getAlertConfig(AlertLevel level) const
+uint8_t BuzzerManager::getAlertPattern(AlertLevel level) const
 {
-    return alertConfigs[static_cast<uint8_t>(level)];
+    uint8_t index = static_cast<uint8_t>(level);
+    if (index >= 3)
+    {
+        return TonePatterns::PATTERN_NONE;
+    }
+    RtosLock lock(sequencerMutex);
+    return alertPatterns[index];
 }
 
 void BuzzerManager::setVolume(uint8_t volume)
@@ -222,7 +258,6 @@ void BuzzerManager::setEnabled(bool enabled)
     if (!enabled)
     {
         stopTone();
-        stopContinuousAlert();
     }
 }
 
@@ -232,26 +267,44 @@ bool BuzzerManager::isEnabled() const
 }
 
 // ============================================================================
-// UPDATE LOOP
+// SECUENCIADOR
 // ============================================================================
 
-void BuzzerManager::update()
+void BuzzerManager::service()
 {
-    if (!initialized)
-        return;
+    uint32_t wait = sequencer.step(millis());
 
-    uint32_t currentTime = millis();
+    esp_timer_stop(timer); // Puede no estar corriendo
+    if (wait > 0)
+    {
+        esp_timer_start_once(timer, (uint64_t)wait * 1000);
+    }
 
-    // Manejar reproducción asíncrona
-    if (playing && (currentTime - playStartTime >= playDuration))
+    bool playing = sequencer.isPlaying();
+    if (playing != awake && awakeLock)
     {
-        stopTone();
+        playing ? esp_pm_lock_acquire(awakeLock) : esp_pm_lock_release(awakeLock);
     }
+    awake = playing;
+}
 
-    // Manejar alertas continuas
-    if (continuousAlertActive)
+void BuzzerManager::onTimer(void *arg)
+{
+    BuzzerManager *buzzer = static_cast<BuzzerManager *>(arg);
+    RtosLock lock(buzzer->sequencerMutex);
+    buzzer->service();
+}
+
+void BuzzerManager::onOutput(uint16_t frequency, uint8_t volume, void *context)
+{
+    BuzzerManager *buzzer = static_cast<BuzzerManager *>(context);
+    if (frequency > 0)
     {
-        updateContinuousAlert();
+        buzzer->playToneInternal(frequency, volume);
+    }
+    else
+    {
+        buzzer->stopToneInternal();
     }
 }
 
@@ -280,74 +333,37 @@ void BuzzerManager::playToneInternal(uint16_t frequency, uint8_t volume)
     // Configurar duty cycle basado en volumen
     uint32_t dutyCycle = volumeToDutyCycle(volume);
     ledcWrite(0, dutyCycle);
+
+    if (!sounding)
+    {
+        sounding = true;
+        toneSince = millis();
+    }
 }
 
 void BuzzerManager::stopToneInternal()
 {
     ledcWrite(0, 0);
-}
-
-uint32_t BuzzerManager::volumeToDutyCycle(uint8_t volume)
-{
-    // Convertir volumen (0-100%) a duty cycle (0-1023 para 10-bit)
-    return (volume * 1023) / (100 * 2); // Dividir por 2 para 50% duty cycle máximo
-}
-
-void BuzzerManager::updateContinuousAlert()
-{
-    const AlertConfig &config = alertConfigs[static_cast<uint8_t>(currentAlertLevel)];
-    uint32_t currentTime = millis();
 
-    if (!config.enabled)
+    if (sounding)
     {
-        LOG_D("updateContinuousAlert leyó config.enabled como false y ejecuta stopContinousAlert");
-        stopContinuousAlert();
-        return;
-    }
-
-    // Verificar si es tiempo de reproducir el siguiente tono
-    if (currentTime - lastAlertTime >= config.interval)
-    {
-        LOG_D("updateContinuousAlert leyó que es tiempo de reproducir el sgte tono");
-        // Verificar límite de repeticiones
-        if (config.repetitions > 0 && alertRepetitionCount >= config.repetitions)
-        {
-            LOG_D("updateContinuousAlert leyó que llegamos al límite de repeticiones del tono y ejecuta stopContinousAlert");
-            stopContinuousAlert();
-            return;
-        }
-
-        LOG_D("updateContinuousAlert reproduce el tono llamando playToneAsync, con freq:%d dur:%d vol: %d", config.frequency, config.duration, config.volume);
-        // Reproducir tono
-        playToneAsync(config.frequency, config.duration, config.volume);
-        lastAlertTime = currentTime;
-        alertRepetitionCount++;
+        toneTimeMs += millis() - toneSince;
+        sounding = false;
     }
 }
 
-void BuzzerManager::initializeAlertConfigs()
+uint32_t BuzzerManager::volumeToDutyCycle(uint8_t volume)
 {
-    alertConfigs[static_cast<uint8_t>(AlertLevel::SAFE)] = AlertConfig(0, 0, 0);
-    alertConfigs[static_cast<uint8_t>(AlertLevel::CAUTION)] = AlertConfig(FREQ_CAUTION, TONE_DURATION_SHORT, VOLUME_LOW);
-    alertConfigs[static_cast<uint8_t>(AlertLevel::WARNING)] = AlertConfig(FREQ_WARNING, TONE_DURATION_MEDIUM, VOLUME_MEDIUM);
-
-    // Configurar intervalos específicos para cada nivel
-    alertConfigs[static_cast<uint8_t>(AlertLevel::CAUTION)].interval = 1000; // Cada 1s
-    alertConfigs[static_cast<uint8_t>(AlertLevel::WARNING)].interval = 1000; // Cada 1s
+    // Convertir volumen (0-100%) a duty cycle (0-1023 para 10-bit)
+    return (volume * 1023) / (100 * 2); // Dividir por 2 para 50% duty cycle máximo
 }
 
-void BuzzerManager::playMelody(const Note *melody, size_t noteCount, uint8_t volume)
+void BuzzerManager::loopAlertPattern()
 {
-    for (size_t i = 0; i < noteCount; i++)
+    // El primer tono suena ya; un nivel nuevo corta la cadencia anterior
+    const TonePatterns::Pattern *pattern = TonePatterns::find(alertPatterns[static_cast<uint8_t>(currentAlertLevel)]);
+    if (!pattern || !sequencer.loop(*pattern))
     {
-        if (melody[i].frequency > 0)
-        {
-            playTone(melody[i].frequency, melody[i].duration, volume);
-        }
-        else
-        {
-            delay(melody[i].duration); // Pausa
-        }
-        delay(50); // Pequeña pausa entre notas
+        sequencer.stopLoop();
     }
 }
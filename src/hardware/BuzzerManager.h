@@ -1,21 +1,27 @@
 #pragma once
 #include <Arduino.h>
+#include <esp_timer.h>
+#include <esp_pm.h>
+#include <atomic>
 #include "../config/pins.h"
 #include "../config/constants.h"
 #include "../core/Types.h"
+#include "../system/Rtos.h"
+#include "../system/ToneSequencer.h"
 #include "musical_notes.h" // Notas musicales
 
 /*
  * ============================================================================
  * BUZZER MANAGER - GESTIÓN DE AUDIO Y ALERTAS
  * ============================================================================
+ * Nada bloquea: tonos y melodías se encolan en un ToneSequencer y la alerta
+ * continua queda como su patrón de fondo. Melodías y cadencias son las
+ * tablas en flash de TonePatterns y se eligen por PatternId. Un esp_timer de una sola vez se
+ * programa en el próximo borde de nota y su callback cambia el PWM. Mientras
+ * haya algo sonando se retiene un candado contra el light sleep, que
+ * detendría el LEDC.
  */
 
-// Definiciones de volumen
-#define VOLUME_LOW 64
-#define VOLUME_MEDIUM 128
-#define VOLUME_HIGH 255
-
 class BuzzerManager
 {
 public:
@@ -25,11 +31,15 @@ public:
     Result init();
     bool isInitialized() const;
 
-    // Control básico de tonos
+    // Control básico de tonos (se encolan detrás de lo que esté sonando)
     void playTone(uint16_t frequency, uint16_t duration, uint8_t volume = VOLUME_MEDIUM);
-    void playToneAsync(uint16_t frequency, uint16_t duration, uint8_t volume = VOLUME_MEDIUM);
-    void stopTone();
+    void playToneAsync(uint16_t frequency, uint16_t duration, uint8_t volume = VOLUME_MEDIUM) { playTone(frequency, duration, volume); }
+    void stopTone(); // Calla todo: cola y alerta continua
     bool isPlaying() const;
+    uint32_t getToneTimeMs() const; // Sonando desde el arranque (registro de energía)
+
+    // Patrón de TonePatterns por id (también desde downlink)
+    bool playPattern(uint8_t id);
 
     // Melodías predefinidas
     void playStartupMelody();
@@ -41,15 +51,16 @@ public:
     // Sistema de alertas progresivas
     void playAlertLevel(AlertLevel level);
     void playAlertTone(AlertLevel level) { playAlertLevel(level); } // Alias para compatibilidad
-    // Sistema de alertas continuas
+    // Sistema de alertas continuas: startContinuousAlert con otro nivel
+    // reemplaza la cadencia en el acto (escalada)
     void startContinuousAlert(AlertLevel level);
     void stopContinuousAlert();
-    void updateContinuousAlert();
-    bool isContinousAlertActive();
+    bool isContinousAlertActive() const;
 
-    // Configuración de alertas personalizadas
-    void setAlertConfig(AlertLevel level, const AlertConfig &config);
-    AlertConfig getAlertConfig(AlertLevel level) const;
+    // Cadencia de cada nivel (PATTERN_NONE = nivel mudo). Si el nivel está
+    // sonando, la nueva cadencia reemplaza a la anterior
+    bool setAlertPattern(AlertLevel level, uint8_t id);
+    uint8_t getAlertPattern(AlertLevel level) const;
 
     // Control de volumen y configuración
     void setVolume(uint8_t volume); // 0-100%
@@ -57,26 +68,27 @@ public:
     void setEnabled(bool enabled);
     bool isEnabled() const;
 
-    // Update loop (llamar desde loop principal)
-    void update();
-
 private:
     uint8_t buzzerPin;
-    bool initialized;
+    std::atomic<bool> initialized; // init() llega desde la tarea UI y la de geocerca
     bool enabled;
     uint8_t currentVolume;
 
-    // Estado de reproducción asíncrona
-    bool playing;
-    uint32_t playStartTime;
-    uint16_t playDuration;
+    // Reproducción: el secuenciador se usa desde las tareas y desde el timer
+    ToneSequencer sequencer;
+    mutable RtosMutex sequencerMutex;
+    esp_timer_handle_t timer;
+    esp_pm_lock_handle_t awakeLock;
+    bool awake;
+
+    // Tiempo con el PWM activo (con el mutex tomado)
+    bool sounding;
+    uint32_t toneSince;
+    uint32_t toneTimeMs; // Tonos ya terminados
 
     // Sistema de alertas continuas
-    bool continuousAlertActive;
     AlertLevel currentAlertLevel;
-    AlertConfig alertConfigs[3]; // Para cada AlertLevel: Safe, Caution y Warning
-    uint32_t lastAlertTime;
-    uint8_t alertRepetitionCount;
+    uint8_t alertPatterns[3]; // PatternId para cada AlertLevel: Safe, Caution y Warning
 
     // Métodos privados
     void setupPWM();
@@ -84,27 +96,11 @@ private:
     void stopToneInternal();
     uint32_t volumeToDutyCycle(uint8_t volume);
 
-    // Manejo de alertas continuas
-    void initializeAlertConfigs();
-
-    // Melodías (definidas como arrays de frecuencias y duraciones)
-    struct Note
-    {
-        uint16_t frequency;
-        uint16_t duration;
-    };
+    // Secuenciador: aplica lo que toca ahora y reprograma el timer (con el mutex tomado)
+    void service();
+    static void onTimer(void *arg);
+    static void onOutput(uint16_t frequency, uint8_t volume, void *context);
 
-    void playMelody(const Note *melody, size_t noteCount, uint8_t volume = VOLUME_MEDIUM);
-
-    // Melodías predefinidas
-    static const Note STARTUP_MELODY[];
-    static const Note SHUTDOWN_MELODY[];
-    static const Note SUCCESS_MELODY[];
-    static const Note ERROR_MELODY[];
-    static const Note WARNING_MELODY[];
-    static const size_t STARTUP_MELODY_SIZE;
-    static const size_t SHUTDOWN_MELODY_SIZE;
-    static const size_t SUCCESS_MELODY_SIZE;
-    static const size_t ERROR_MELODY_SIZE;
-    static const size_t WARNING_MELODY_SIZE;
+    // Reinicia la cadencia de fondo del nivel actual (con el mutex tomado)
+    void loopAlertPattern();
 };
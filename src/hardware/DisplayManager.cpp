@@ -1,7 +1,23 @@
 // DisplayManager.cpp - Sistema de pantallas mejorado con navegación y mejor UI
 #include "DisplayManager.h"
 #include "../core/Logger.h"
+#include "../system/Profiler.h"
+#include "../utils/IconAtlas.h"
 #include <Arduino.h>
+#include <Wire.h>
+#include <math.h>
+
+// Comandos del SSD1306 para direccionar un rectángulo (modo horizontal)
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR 0x22
+#define SSD1306_CONTROL_COMMAND 0x00
+#define SSD1306_CONTROL_DATA 0x40
+#define SSD1306_CHARGEPUMP 0x8D
+#define SSD1306_CHARGEPUMP_ON 0x14
+#define SSD1306_CHARGEPUMP_OFF 0x10
+
+// Alto de una línea de ArialMT_Plain_10 en la pantalla principal
+#define MAIN_LINE_HEIGHT 12
 
 // Variables para navegación entre pantallas
 enum ScreenType
@@ -10,6 +26,7 @@ enum ScreenType
     SCREEN_GPS_DETAIL,
     SCREEN_GEOFENCE_INFO,
     SCREEN_SYSTEM_STATS,
+    SCREEN_ENERGY,
     SCREEN_COUNT
 };
 
@@ -26,10 +43,11 @@ struct DisplayState
     uint32_t uptimeMinutes = 0;
     uint16_t txCounter = 0;
     uint16_t rxCounter = 0;
+    bool countersChanged = false;
 
     // Info de geocerca
-    String geofenceName = "Sin configurar";
-    String geofenceType = "N/A";
+    char geofenceName[32] = "Sin configurar";
+    const char *geofenceType = "N/A";
     float geofenceRadius = 0;
     float distanceToCenter = 0;
     bool insideGeofence = true;
@@ -37,15 +55,23 @@ struct DisplayState
 
 // Constructor
 DisplayManager::DisplayManager(uint8_t address, uint8_t sda, uint8_t scl, uint8_t rst) : oledDisplay(address, sda, scl),
+                                                                                         i2cAddress(address),
                                                                                          rstPin(rst),
                                                                                          initialized(false),
                                                                                          displayOn(true),
-                                                                                         currentBrightness(128)
+                                                                                         onSince(0),
+                                                                                         onTimeMs(0),
+                                                                                         currentBrightness(128),
+                                                                                         lastActivity(0),
+                                                                                         autoSleepEnabled(false),
+                                                                                         autoSleepTimeout(OLED_TIMEOUT_SLEEP),
+                                                                                         lastAnimationFrame(0),
+                                                                                         mainLayoutValid(false)
 {
 }
 
 // Inicialización mejorada con pantalla de carga
-Result DisplayManager::init()
+Result DisplayManager::init(bool bootScreen)
 {
     if (initialized)
         return Result::SUCCESS;
@@ -72,11 +98,19 @@ Result DisplayManager::init()
     oledDisplay.flipScreenVertically();
     oledDisplay.setContrast(255);
 
+    // Tras el reset el contenido del panel es desconocido: el primer cuadro va completo
+    frameDiff.invalidate();
+    mainLayoutValid = false;
+
     // Mostrar pantalla de carga mejorada
-    showBootScreen();
+    if (bootScreen)
+    {
+        showBootScreen();
+    }
 
     initialized = true;
     displayOn = true;
+    onSince = millis();
 
     LOG_I("✅ Display Manager inicializado");
     return Result::SUCCESS;
@@ -144,100 +178,145 @@ void DisplayManager::showBootScreen()
 }
 
 // Pantalla principal mejorada sin superposición
+// Con la pantalla ya dibujada solo se redibujan las líneas cuyos datos
+// cambiaron respecto de las caches last*; display() manda solo los bytes
+// modificados y si no cambió nada no se llama
 void DisplayManager::showMainScreen(const SystemStatus &status, const Position &position,
                                     const BatteryStatus &battery, AlertLevel alertLevel)
 {
-    if (!initialized)
+    if (!initialized || !displayOn)
         return;
 
-    clear();
+    bool full = !mainLayoutValid;
+    bool changed = full;
+    bool valid = isValidPosition(position);
+    uint8_t frame = (millis() / 500) % 4; // Animación de búsqueda y parpadeo de alertas
+    uint32_t uptimeMinutes = status.uptime / 60; // uptime en segundos
 
-    // Línea 1: Estado y batería
+    if (full)
+    {
+        clear();
+    }
     oledDisplay.setFont(ArialMT_Plain_10);
-    oledDisplay.setTextAlignment(TEXT_ALIGN_LEFT);
-
-    // Estado del sistema con icono
-    const char *statusIcon = status.radioInitialized ? "📡" : "⚠";
-    oledDisplay.drawString(0, 0, statusIcon);
-
-    // Batería en la derecha
-    oledDisplay.setTextAlignment(TEXT_ALIGN_RIGHT);
-    char batteryStr[16];
-    snprintf(batteryStr, sizeof(batteryStr), "%d%% %.1fV", battery.percentage, battery.voltage);
-    oledDisplay.drawString(128, 0, batteryStr);
 
-    // Línea 2-3: Posición GPS (formato decimal simplificado)
-    oledDisplay.setTextAlignment(TEXT_ALIGN_LEFT);
-    if (isValidPosition(position))
+    // Línea 1: Estado (iconos de radio y GPS) y batería
+    if (full || status.radioInitialized != lastSystemStatus.radioInitialized || valid != isValidPosition(lastPosition) ||
+        battery.percentage != lastBattery.percentage || lroundf(battery.voltage * 10) != lroundf(lastBattery.voltage * 10))
     {
-        char latStr[20], lngStr[20];
-        // Formato simplificado sin grados
-        snprintf(latStr, sizeof(latStr), "LAT: %.5f", position.latitude);
-        snprintf(lngStr, sizeof(lngStr), "LNG: %.5f", position.longitude);
+        clearArea(0, 0, DISPLAY_WIDTH, MAIN_LINE_HEIGHT);
 
-        oledDisplay.drawString(0, 12, latStr);
-        oledDisplay.drawString(0, 24, lngStr);
+        // Iconos del atlas: una copia de 8 bytes cada uno
+        IconAtlas::blit(oledDisplay.buffer, 0, 0, IconAtlas::radio(status.radioInitialized));
+        IconAtlas::blit(oledDisplay.buffer, 10, 0, IconAtlas::gps(valid));
+        IconAtlas::blit(oledDisplay.buffer, DISPLAY_WIDTH - IconAtlas::BATTERY_WIDTH, 0,
+                        IconAtlas::battery(battery.percentage));
 
-        // Indicador de satelites
-        char satStr[10];
-        snprintf(satStr, sizeof(satStr), "SAT:%d", position.satellites);
+        // Porcentaje y voltaje a la izquierda del icono de batería
         oledDisplay.setTextAlignment(TEXT_ALIGN_RIGHT);
-        oledDisplay.drawString(128, 12, satStr);
+        char batteryStr[16];
+        snprintf(batteryStr, sizeof(batteryStr), "%d%% %.1fV", battery.percentage, battery.voltage);
+        oledDisplay.drawString(DISPLAY_WIDTH - IconAtlas::BATTERY_WIDTH - 3, 0, batteryStr);
+        changed = true;
     }
-    else
+
+    // Línea 2-3: Posición GPS (formato decimal simplificado, se compara con la precisión mostrada)
+    if (full || valid != isValidPosition(lastPosition) || position.satellites != lastPosition.satellites ||
+        (valid && (lround(position.latitude * 1e5) != lround(lastPosition.latitude * 1e5) ||
+                   lround(position.longitude * 1e5) != lround(lastPosition.longitude * 1e5))) ||
+        (!valid && frame != lastAnimationFrame))
     {
-        oledDisplay.drawString(0, 12, "GPS: Buscando...");
+        clearArea(0, MAIN_LINE_HEIGHT, DISPLAY_WIDTH, 2 * MAIN_LINE_HEIGHT);
+        oledDisplay.setTextAlignment(TEXT_ALIGN_LEFT);
+        if (valid)
+        {
+            char latStr[20], lngStr[20];
+            // Formato simplificado sin grados
+            snprintf(latStr, sizeof(latStr), "LAT: %.5f", position.latitude);
+            snprintf(lngStr, sizeof(lngStr), "LNG: %.5f", position.longitude);
+
+            oledDisplay.drawString(0, 12, latStr);
+            oledDisplay.drawString(0, 24, lngStr);
+
+            // Indicador de satelites
+            char satStr[10];
+            snprintf(satStr, sizeof(satStr), "SAT:%d", position.satellites);
+            oledDisplay.setTextAlignment(TEXT_ALIGN_RIGHT);
+            oledDisplay.drawString(128, 12, satStr);
+        }
+        else
+        {
+            oledDisplay.drawString(0, 12, "GPS: Buscando...");
 
-        // Mostrar número de satélites aunque no haya fix
-        char satInfo[20];
-        snprintf(satInfo, sizeof(satInfo), "Satélites: %d", position.satellites);
-        oledDisplay.drawString(0, 24, satInfo);
+            // Mostrar número de satélites aunque no haya fix
+            char satInfo[20];
+            snprintf(satInfo, sizeof(satInfo), "Satélites: %d", position.satellites);
+            oledDisplay.drawString(0, 24, satInfo);
 
-        // Indicador animado de búsqueda
-        int frame = (millis() / 500) % 4;
-        const char *animation[] = {"◐", "◓", "◑", "◒"};
-        oledDisplay.setTextAlignment(TEXT_ALIGN_RIGHT);
-        oledDisplay.drawString(128, 24, animation[frame]);
-        oledDisplay.setTextAlignment(TEXT_ALIGN_LEFT);
+            // Indicador animado de búsqueda
+            const char *animation[] = {"◐", "◓", "◑", "◒"};
+            oledDisplay.setTextAlignment(TEXT_ALIGN_RIGHT);
+            oledDisplay.drawString(128, 24, animation[frame]);
+        }
+        changed = true;
     }
 
-    // Línea 4: Estado de alerta/geocerca
-    oledDisplay.setTextAlignment(TEXT_ALIGN_LEFT);
-    if (alertLevel != AlertLevel::SAFE)
+    // Línea 4: Estado de alerta/geocerca (parpadea desde WARNING)
+    bool blinking = alertLevel >= AlertLevel::WARNING;
+    if (full || alertLevel != lastAlertLevel || (blinking && frame % 2 != lastAnimationFrame % 2))
     {
-        // Parpadeo para alertas
-        if ((millis() / 500) % 2 == 0 || alertLevel < AlertLevel::WARNING)
+        clearArea(0, 3 * MAIN_LINE_HEIGHT, DISPLAY_WIDTH, MAIN_LINE_HEIGHT);
+        oledDisplay.setTextAlignment(TEXT_ALIGN_LEFT);
+        if (alertLevel != AlertLevel::SAFE)
         {
-            const char *alertText = alertLevelToString(alertLevel);
-            oledDisplay.drawString(0, 36, "ALERTA:");
-            oledDisplay.drawString(45, 36, alertText);
+            if (frame % 2 == 0 || !blinking)
+            {
+                const char *alertText = alertLevelToString(alertLevel);
+                oledDisplay.drawString(0, 36, "ALERTA:");
+                oledDisplay.drawString(45, 36, alertText);
+            }
         }
-    }
-    else
-    {
-        oledDisplay.drawString(0, 36, "Estado: SEGURO");
+        else
+        {
+            oledDisplay.drawString(0, 36, "Estado: SEGURO");
+        }
+        changed = true;
     }
 
-    // Línea 5: Contadores actualizados correctamente
-    char statsStr[32];
-    displayState.uptimeMinutes = status.uptime / 60000; // Convertir ms a minutos
-    snprintf(statsStr, sizeof(statsStr), "UP:%02lu TX:%d RX:%d",
-             displayState.uptimeMinutes, displayState.txCounter, displayState.rxCounter);
-    oledDisplay.setFont(ArialMT_Plain_10);
-    oledDisplay.drawString(0, 48, statsStr);
+    // Línea 5: Contadores e indicador de pantalla actual (pequeño en esquina)
+    if (full || displayState.countersChanged || uptimeMinutes != displayState.uptimeMinutes)
+    {
+        clearArea(0, 4 * MAIN_LINE_HEIGHT, DISPLAY_WIDTH, DISPLAY_HEIGHT - 4 * MAIN_LINE_HEIGHT);
+        char statsStr[32];
+        displayState.uptimeMinutes = uptimeMinutes;
+        displayState.countersChanged = false;
+        snprintf(statsStr, sizeof(statsStr), "UP:%02lu TX:%d RX:%d",
+                 displayState.uptimeMinutes, displayState.txCounter, displayState.rxCounter);
+        oledDisplay.setTextAlignment(TEXT_ALIGN_LEFT);
+        oledDisplay.drawString(0, 48, statsStr);
 
-    // Indicador de pantalla actual (pequeño en esquina)
-    oledDisplay.setTextAlignment(TEXT_ALIGN_RIGHT);
-    oledDisplay.drawString(128, 48, "1/4");
+        oledDisplay.setTextAlignment(TEXT_ALIGN_RIGHT);
+        oledDisplay.drawString(128, 48, "1/5");
+        changed = true;
+    }
 
-    display();
+    lastSystemStatus = status;
+    lastPosition = position;
+    lastBattery = battery;
+    lastAlertLevel = alertLevel;
+    lastAnimationFrame = frame;
+    mainLayoutValid = true;
     currentScreen = SCREEN_MAIN;
+
+    if (changed)
+    {
+        display();
+    }
 }
 
 // Nueva pantalla: Detalles GPS
 void DisplayManager::showGPSDetailScreen(const Position &position)
 {
-    if (!initialized)
+    if (!initialized || !displayOn)
         return;
 
     clear();
@@ -280,7 +359,7 @@ void DisplayManager::showGPSDetailScreen(const Position &position)
 
     // Indicador de pantalla
     oledDisplay.setTextAlignment(TEXT_ALIGN_RIGHT);
-    oledDisplay.drawString(128, 52, "2/4");
+    oledDisplay.drawString(128, 52, "2/5");
 
     display();
 }
@@ -288,7 +367,7 @@ void DisplayManager::showGPSDetailScreen(const Position &position)
 // Nueva pantalla: Información de Geocerca
 void DisplayManager::showGeofenceInfoScreen(const Geofence &geofence, float distance, bool inside)
 {
-    if (!initialized)
+    if (!initialized || !displayOn)
         return;
 
     clear();
@@ -336,7 +415,7 @@ void DisplayManager::showGeofenceInfoScreen(const Geofence &geofence, float dist
 
     // Indicador de pantalla
     oledDisplay.setTextAlignment(TEXT_ALIGN_RIGHT);
-    oledDisplay.drawString(128, 52, "3/4");
+    oledDisplay.drawString(128, 52, "3/5");
 
     display();
 }
@@ -344,7 +423,7 @@ void DisplayManager::showGeofenceInfoScreen(const Geofence &geofence, float dist
 // Nueva pantalla: Estadísticas del sistema
 void DisplayManager::showSystemStatsScreen(const SystemStats &stats)
 {
-    if (!initialized)
+    if (!initialized || !displayOn)
         return;
 
     clear();
@@ -362,7 +441,15 @@ void DisplayManager::showSystemStatsScreen(const SystemStats &stats)
     snprintf(line, sizeof(line), "TX Total: %lu", stats.totalPacketsSent);
     oledDisplay.drawString(0, 12, line);
 
-    snprintf(line, sizeof(line), "RX Total: %lu", stats.totalPacketsReceived);
+    // Señal del último downlink (sin downlinks aún no hay medición)
+    if (stats.totalPacketsReceived > 0)
+    {
+        snprintf(line, sizeof(line), "RX %lu %ddBm %.1fdB", stats.totalPacketsReceived, stats.lastRSSI, stats.lastSNR);
+    }
+    else
+    {
+        snprintf(line, sizeof(line), "RX Total: 0");
+    }
     oledDisplay.drawString(0, 22, line);
 
     // Tasa de éxito
@@ -382,7 +469,42 @@ void DisplayManager::showSystemStatsScreen(const SystemStats &stats)
 
     // Indicador de pantalla
     oledDisplay.setTextAlignment(TEXT_ALIGN_RIGHT);
-    oledDisplay.drawString(128, 52, "4/4");
+    oledDisplay.drawString(128, 52, "4/5");
+
+    display();
+}
+
+void DisplayManager::showEnergyScreen(const EnergyLedger::Report &report)
+{
+    if (!initialized || !displayOn)
+        return;
+
+    clear();
+
+    // Título
+    oledDisplay.setFont(ArialMT_Plain_10);
+    oledDisplay.setTextAlignment(TEXT_ALIGN_CENTER);
+    oledDisplay.drawString(64, 0, "=== mAh/DÍA ===");
+
+    oledDisplay.setTextAlignment(TEXT_ALIGN_LEFT);
+
+    char line[32];
+
+    // Dos subsistemas por renglón, proyectados a 24 h
+    for (uint8_t i = 0; i < EnergyLedger::CHANNELS; i++)
+    {
+        float perDay = report.perDay(i);
+        snprintf(line, sizeof(line), perDay < 100.0f ? "%s %.1f" : "%s %.0f", EnergyLedger::getName(i), perDay);
+        oledDisplay.drawString((i % 2) * 64, 12 + (i / 2) * 10, line);
+    }
+
+    // Total y horas medidas
+    snprintf(line, sizeof(line), "Total %.0f (%luh)", report.totalPerDay(), report.periodMs / 3600000UL);
+    oledDisplay.drawString(0, 52, line);
+
+    // Indicador de pantalla
+    oledDisplay.setTextAlignment(TEXT_ALIGN_RIGHT);
+    oledDisplay.drawString(128, 52, "5/5");
 
     display();
 }
@@ -402,7 +524,8 @@ void DisplayManager::nextScreen()
         "Principal",
         "GPS Detalle",
         "Geocerca",
-        "Estadísticas"};
+        "Estadísticas",
+        "Energía"};
 
     oledDisplay.drawString(64, 25, "Cambiando a:");
     oledDisplay.drawString(64, 35, screenNames[displayState.currentScreen]);
@@ -435,6 +558,7 @@ void DisplayManager::update()
 // Actualizar contadores
 void DisplayManager::updateCounters(uint16_t txCount, uint16_t rxCount)
 {
+    displayState.countersChanged |= txCount != displayState.txCounter || rxCount != displayState.rxCounter;
     displayState.txCounter = txCount;
     displayState.rxCounter = rxCount;
 }
@@ -443,7 +567,7 @@ void DisplayManager::updateCounters(uint16_t txCount, uint16_t rxCount)
 void DisplayManager::updateGeofenceInfo(const char *name, GeofenceType type,
                                         float radius, float distance, bool inside)
 {
-    displayState.geofenceName = String(name);
+    snprintf(displayState.geofenceName, sizeof(displayState.geofenceName), "%s", name);
     displayState.geofenceType = (type == GeofenceType::CIRCLE) ? "Círculo" : "Polígono";
     displayState.geofenceRadius = radius;
     displayState.distanceToCenter = distance;
@@ -470,17 +594,7 @@ void DisplayManager::drawProgressBar(int16_t x, int16_t y, int16_t width,
 // Funciones auxiliares mejoradas
 void DisplayManager::drawBatteryIcon(int16_t x, int16_t y, uint8_t percentage)
 {
-    // Cuerpo de la batería
-    oledDisplay.drawRect(x, y, 20, 10);
-    // Terminal positivo
-    oledDisplay.drawRect(x + 20, y + 3, 2, 4);
-
-    // Relleno según porcentaje
-    int16_t fillWidth = 18 * percentage / 100;
-    if (fillWidth > 0)
-    {
-        oledDisplay.fillRect(x + 1, y + 1, fillWidth, 8);
-    }
+    IconAtlas::blit(oledDisplay.buffer, x, y, IconAtlas::battery(percentage));
 
     // Indicador de carga baja
     if (percentage < 20)
@@ -488,7 +602,7 @@ void DisplayManager::drawBatteryIcon(int16_t x, int16_t y, uint8_t percentage)
         // Parpadeo si está muy baja
         if ((millis() / 500) % 2 == 0)
         {
-            oledDisplay.drawString(x + 25, y, "!");
+            oledDisplay.drawString(x + IconAtlas::BATTERY_WIDTH + 3, y, "!");
         }
     }
 }
@@ -583,15 +697,60 @@ void DisplayManager::clear()
     if (initialized)
     {
         oledDisplay.clear();
+        mainLayoutValid = false; // Otra pantalla pisa la principal
     }
 }
 
+void DisplayManager::clearArea(int16_t x, int16_t y, int16_t width, int16_t height)
+{
+    oledDisplay.setColor(BLACK);
+    oledDisplay.fillRect(x, y, width, height);
+    oledDisplay.setColor(WHITE);
+}
+
 void DisplayManager::display()
 {
     if (initialized && displayOn)
     {
-        oledDisplay.display();
-        updateLastActivity();
+        PROFILE_SCOPE("oled_flush");
+
+        // Solo las páginas/columnas que cambiaron desde el último envío
+        FrameDiff::Region regions[DISPLAY_MAX_REGIONS];
+        uint8_t count = frameDiff.update(oledDisplay.buffer, regions, DISPLAY_MAX_REGIONS);
+        pushRegions(regions, count);
+    }
+}
+
+// Reemplaza a SSD1306Wire::display(): el panel ya está en direccionamiento
+// horizontal (lo deja así init()), así que cada rectángulo es un
+// COLUMNADDR/PAGEADDR seguido de sus bytes. El doble buffer de la librería
+// no se usa: FrameDiff guarda lo que muestra el panel
+void DisplayManager::pushRegions(const FrameDiff::Region *regions, uint8_t count)
+{
+    uint8_t chunk[DISPLAY_I2C_CHUNK];
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const FrameDiff::Region &region = regions[i];
+        Wire.beginTransmission(i2cAddress);
+        Wire.write(SSD1306_CONTROL_COMMAND);
+        Wire.write(SSD1306_COLUMNADDR);
+        Wire.write(region.firstColumn);
+        Wire.write(region.lastColumn);
+        Wire.write(SSD1306_PAGEADDR);
+        Wire.write(region.firstPage);
+        Wire.write(region.lastPage);
+        Wire.endTransmission();
+
+        size_t offset = 0;
+        size_t length;
+        while ((length = FrameDiff::copyRegion(oledDisplay.buffer, region, offset, chunk, sizeof(chunk))) > 0)
+        {
+            Wire.beginTransmission(i2cAddress);
+            Wire.write(SSD1306_CONTROL_DATA);
+            Wire.write(chunk, length);
+            Wire.endTransmission();
+            offset += length;
+        }
     }
 }
 
@@ -608,8 +767,11 @@ void DisplayManager::turnOn()
 {
     if (initialized && !displayOn)
     {
+        // La GDDRAM se conserva apagada: frameDiff sigue siendo válido
+        sendCommand(SSD1306_CHARGEPUMP, SSD1306_CHARGEPUMP_ON);
         oledDisplay.displayOn();
         displayOn = true;
+        onSince = millis();
         updateLastActivity();
         LOG_D("📺 Display encendido");
     }
@@ -619,8 +781,11 @@ void DisplayManager::turnOff()
 {
     if (initialized && displayOn)
     {
+        // Sleep del SSD1306 y bomba de carga apagada: pocos µA
         oledDisplay.displayOff();
+        sendCommand(SSD1306_CHARGEPUMP, SSD1306_CHARGEPUMP_OFF);
         displayOn = false;
+        onTimeMs += millis() - onSince;
         currentScreen = SCREEN_OFF;
         LOG_D("📺 Display apagado");
     }
@@ -631,6 +796,15 @@ bool DisplayManager::isOn() const
     return displayOn;
 }
 
+uint32_t DisplayManager::getOnTimeMs() const
+{
+    if (initialized && displayOn)
+    {
+        return onTimeMs + (millis() - onSince);
+    }
+    return onTimeMs;
+}
+
 bool DisplayManager::isInitialized() const
 {
     return initialized;
@@ -641,6 +815,31 @@ void DisplayManager::updateLastActivity()
     lastActivity = millis();
 }
 
+bool DisplayManager::wake()
+{
+    updateLastActivity();
+    if (!displayOn)
+    {
+        turnOn();
+        return true;
+    }
+    return false;
+}
+
+bool DisplayManager::isAutoSleepEnabled() const
+{
+    return autoSleepEnabled;
+}
+
+void DisplayManager::sendCommand(uint8_t command, uint8_t argument)
+{
+    Wire.beginTransmission(i2cAddress);
+    Wire.write(SSD1306_CONTROL_COMMAND);
+    Wire.write(command);
+    Wire.write(argument);
+    Wire.endTransmission();
+}
+
 void DisplayManager::setAutoSleep(bool enabled, uint32_t timeoutMs)
 {
     autoSleepEnabled = enabled;
@@ -654,7 +853,7 @@ void DisplayManager::showSplashScreen()
 
 void DisplayManager::showAlertScreen(AlertLevel level, float distance)
 {
-    if (!initialized)
+    if (!initialized || !displayOn)
         return;
 
     // Guardar tiempo de inicio de la alerta
@@ -712,7 +911,7 @@ void DisplayManager::showAlertScreen(AlertLevel level, float distance)
 
 void DisplayManager::showBatteryScreen(const BatteryStatus &battery)
 {
-    if (!initialized)
+    if (!initialized || !displayOn)
         return;
 
     clear();
@@ -739,7 +938,7 @@ void DisplayManager::showBatteryScreen(const BatteryStatus &battery)
 
 void DisplayManager::showErrorScreen(const char *error)
 {
-    if (!initialized)
+    if (!initialized || !displayOn)
         return;
 
     clear();
@@ -776,41 +975,24 @@ void DisplayManager::showErrorScreen(const char *error)
     currentScreen = SCREEN_ERROR;
 }
 
+// Iconos del atlas (IconAtlas.h): se copian al framebuffer sin dibujar primitivas
 void DisplayManager::drawGPSIcon(int16_t x, int16_t y, bool connected)
 {
-    if (connected)
-    {
-        // Satélite con señal
-        oledDisplay.drawCircle(x + 4, y + 4, 3);
-        oledDisplay.drawLine(x + 7, y + 7, x + 10, y + 10);
-        oledDisplay.drawLine(x + 1, y + 7, x - 2, y + 10);
-        // Ondas de señal
-        oledDisplay.drawCircle(x + 4, y + 4, 6);
-    }
-    else
-    {
-        // Satélite sin señal (parpadeante)
-        if ((millis() / 500) % 2)
-        {
-            oledDisplay.drawCircle(x + 4, y + 4, 3);
-            oledDisplay.drawLine(x, y, x + 8, y + 8);
-        }
-    }
+    IconAtlas::blit(oledDisplay.buffer, x, y, IconAtlas::gps(connected));
 }
 
 void DisplayManager::drawSignalIcon(int16_t x, int16_t y, uint8_t strength)
 {
     // Barras de señal (0-5)
-    for (int i = 0; i < 5; i++)
-    {
-        int barHeight = (i + 1) * 3;
-        if (i < strength)
-        {
-            oledDisplay.fillRect(x + i * 3, y + 15 - barHeight, 2, barHeight);
-        }
-        else
-        {
-            oledDisplay.drawRect(x + i * 3, y + 15 - barHeight, 2, barHeight);
-        }
-    }
-}
\ No newline at end of file
+    IconAtlas::blit(oledDisplay.buffer, x, y, IconAtlas::signal(strength));
+}
+
+void DisplayManager::drawAlertIcon(int16_t x, int16_t y, AlertLevel level)
+{
+    IconAtlas::blit(oledDisplay.buffer, x, y, IconAtlas::alert(level));
+}
+
+void DisplayManager::drawGeofenceIcon(int16_t x, int16_t y, GeofenceType type)
+{
+    IconAtlas::blit(oledDisplay.buffer, x, y, IconAtlas::geofence(type));
+}
@@ -7,6 +7,8 @@
 #include "config/pins.h"
 #include "config/constants.h"
 #include "core/Types.h" 
+#include "system/FrameDiff.h"
+#include "system/EnergyLedger.h"
 #include <SSD1306Wire.h>
 
 
@@ -31,7 +33,8 @@ public:
                    uint8_t scl = OLED_SCL, uint8_t rst = OLED_RST);
     
     // === INICIALIZACIÓN ===
-    Result init();
+    // bootScreen = false omite la animación de carga (~3 s, arranque rápido)
+    Result init(bool bootScreen = true);
     bool isInitialized() const;
     
     // === CONTROL BÁSICO DEL DISPLAY ===
@@ -41,6 +44,7 @@ public:
     void turnOn();
     void turnOff();
     bool isOn() const;
+    uint32_t getOnTimeMs() const; // Encendida desde el arranque (modelo de energía)
     
     // === PANTALLAS PRINCIPALES ===
     
@@ -60,6 +64,9 @@ public:
     
     // Pantalla de estadísticas del sistema
     void showSystemStatsScreen(const SystemStats& stats);
+
+    // Pantalla de consumo por subsistema (EnergyLedger)
+    void showEnergyScreen(const EnergyLedger::Report& report);
     
     // Pantallas de alerta y error
     void showAlertScreen(AlertLevel level, float distance);
@@ -108,9 +115,13 @@ public:
     
     // === GESTIÓN DE PANTALLA ===
     
-    // Auto-apagado y gestión de energía
+    // Auto-apagado y gestión de energía. Apagada no se dibuja ni se usa
+    // el I2C: las pantallas vuelven sin hacer nada
     void setAutoSleep(bool enabled, uint32_t timeoutMs = OLED_TIMEOUT_SLEEP);
     void updateLastActivity();
+    // Botón: enciende (si estaba apagada) y reinicia la cuenta del auto-apagado
+    // @return true si estaba apagada
+    bool wake();
     bool isAutoSleepEnabled() const;
     
     // Rotación automática de pantallas
@@ -148,9 +159,12 @@ public:
 private:
     // === VARIABLES PRIVADAS ===
     SSD1306Wire oledDisplay;
+    uint8_t i2cAddress;
     uint8_t rstPin;
     bool initialized;
     bool displayOn;
+    uint32_t onSince;
+    uint32_t onTimeMs; // Periodos encendida ya terminados
     uint8_t currentBrightness;
     bool nightMode;
     
@@ -182,6 +196,11 @@ private:
     BatteryStatus lastBattery;
     AlertLevel lastAlertLevel;
     float lastDistance;
+    uint8_t lastAnimationFrame;
+    bool mainLayoutValid; // La pantalla principal está dibujada: solo se redibuja lo que cambió
+    
+    // Lo que muestra el panel: display() manda solo las zonas modificadas
+    FrameDiff frameDiff;
     
     // === MÉTODOS PRIVADOS ===
     
@@ -189,6 +208,11 @@ private:
     void drawStatusBar();
     void drawNavigationHints();
     void drawFrame(int16_t x, int16_t y, int16_t width, int16_t height);
+    void clearArea(int16_t x, int16_t y, int16_t width, int16_t height);
+    
+    // Envío por I2C de los rectángulos modificados
+    void pushRegions(const FrameDiff::Region* regions, uint8_t count);
+    void sendCommand(uint8_t command, uint8_t argument);
     
     // Formateo de texto
     void formatCoordinate(char* buffer, double coord, bool isLatitude);
@@ -212,11 +236,6 @@ private:
 // geofenceTypeToString ya está definida en core/Types.h
 const char* screenModeToString(uint8_t mode);
 
-// Formateo de unidades
-String formatBatteryVoltage(float voltage);
-String formatGPSCoordinate(double coord, bool isLatitude);
-String formatUptime(uint32_t milliseconds);
-
 // ============================================================================
 // MACROS DE CONFIGURACIÓN
 // ============================================================================
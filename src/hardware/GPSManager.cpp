@@ -5,6 +5,7 @@
 
 #include "GPSManager.h"
 #include "../core/Logger.h"
+#include "../system/Profiler.h"
 #include <HardwareSerial.h>
 
 // ============================================================================
@@ -35,7 +36,7 @@ GPSManager::GPSManager(uint8_t rxPin, uint8_t txPin, uint32_t baudRate) : gpsSer
     memset(&nmeaData, 0, sizeof(nmeaData));
 }
 
-Result GPSManager::init()
+Result GPSManager::init(bool probe)
 {
     if (initialized)
     {
@@ -49,6 +50,13 @@ Result GPSManager::init()
     // Configurar UART para GPS
     gpsSerial->begin(baudRate, SERIAL_8N1, rxPin, txPin);
 
+    if (!probe)
+    {
+        currentState = GPS_SEARCHING;
+        initialized = true;
+        return Result::SUCCESS;
+    }
+
     // Esperar un momento para estabilización
     delay(100);
 
@@ -99,6 +107,8 @@ void GPSManager::update()
     if (!initialized)
         return;
 
+    PROFILE_SCOPE("gps_parse");
+
     readSerialData();
 
     // Actualizar estado cada segundo
@@ -661,8 +671,5 @@ void GPSManager::logGPSInfo() const
 
 void GPSManager::logNMEASentence(const char *sentence) const
 {
-    if (LOG_LEVEL >= LOG_LEVEL_DEBUG)
-    {
-        LOG_D("🛰️ NMEA: %s", sentence);
-    }
+    LOG_D("🛰️ NMEA: %s", sentence);
 }
\ No newline at end of file
@@ -20,7 +20,8 @@ class GPSManager {
 public:
     // Constructor corregido para usar los nombres de config.h
     GPSManager(uint8_t rxPin = GPS_RX, uint8_t txPin = GPS_TX, uint32_t baudRate = GPS_BAUD);
-    Result init();
+    // probe = false omite la espera de hasta 3 s por datos (despertar de deep sleep)
+    Result init(bool probe = true);
     bool isInitialized() const;
     
     // Lectura de datos GPS
@@ -3,6 +3,9 @@
 #include <esp_task_wdt.h>
 #include <esp_sleep.h>
 #include <soc/rtc.h>
+#include <esp_pm.h>
+#include <driver/gpio.h>
+#include <driver/uart.h>
 
 // ============================================================================
 // CONSTRUCTOR E INICIALIZACIÓN
@@ -11,6 +14,8 @@
 PowerManager::PowerManager(uint8_t batteryPin) : vbatPin(batteryPin),
                                                  initialized(false),
                                                  lowPowerModeEnabled(false),
+                                                 lightSleepEnabled(false),
+                                                 awakeLock(nullptr),
                                                  startTime(0),
                                                  lowBatteryCallback(nullptr),
                                                  criticalBatteryCallback(nullptr),
@@ -56,8 +61,10 @@ Result PowerManager::init()
     samplesReady = true;
 
     initialized = true;
-    // Leer estado inicial (necesitamos que initialized sea true)
-    readBattery();
+    // Leer estado inicial (necesitamos que initialized sea true). Al arrancar
+    // la radio todavía no transmitió: la primera lectura es en reposo. Con el
+    // estado retenido del modo ciclo no: el GPS ya está adquiriendo
+    readBattery(!estimator.isReady());
 
     LOG_INIT("Power Manager", true);
     LOG_BATTERY(batteryStatus.voltage, batteryStatus.percentage);
@@ -74,7 +81,7 @@ bool PowerManager::isInitialized() const
 // LECTURA DE BATERÍA
 // ============================================================================
 
-void PowerManager::readBattery()
+void PowerManager::readBattery(bool atRest)
 {
     if (!initialized)
     {
@@ -85,12 +92,20 @@ void PowerManager::readBattery()
     batterySamples[currentSample] = readVoltageRaw();
     currentSample = (currentSample + 1) % BATTERY_SAMPLES;
 
-    // Calcular promedio
+    // Calcular promedio (incluye las muestras tomadas durante un TX: solo
+    // para los umbrales de batería baja)
     float voltage = calculateAverageVoltage();
 
+    // El porcentaje sale del conteo de carga, corregido con las lecturas en reposo
+    if (atRest)
+    {
+        estimator.addRestVoltage(readRestVoltage());
+    }
+
     // Actualizar estado de batería
     batteryStatus.voltage = voltage;
-    batteryStatus.percentage = calculateBatteryPercentage(voltage);
+    batteryStatus.percentage = (uint8_t)(estimator.getSoc() + 0.5f);
+    batteryStatus.remainingHours = estimator.getRemainingHours();
     batteryStatus.lastReading = millis();
 
     // Determinar estados críticos
@@ -111,8 +126,8 @@ void PowerManager::readBattery()
         triggerBatteryCallbacks();
     };
 
-    LOG_D("🔋 Batería: %.2fV (%d%%) %s%s",
-          voltage, batteryStatus.percentage,
+    LOG_D("🔋 Batería: %.2fV (%d%% ±%.0f, %uh) %s%s",
+          voltage, batteryStatus.percentage, estimator.getUncertainty(), batteryStatus.remainingHours,
           batteryStatus.low ? "LOW " : "",
           batteryStatus.critical ? "CRITICAL " : "");
 }
@@ -142,6 +157,21 @@ bool PowerManager::isCritical() const
     return batteryStatus.critical;
 }
 
+void PowerManager::addConsumption(float mAh, uint32_t elapsedMs)
+{
+    estimator.addConsumption(mAh, elapsedMs);
+}
+
+const BatteryEstimator &PowerManager::getEstimator() const
+{
+    return estimator;
+}
+
+void PowerManager::restoreEstimator(const BatteryEstimator::State &state)
+{
+    estimator.restore(state);
+}
+
 // ============================================================================
 // GESTIÓN DE ENERGÍA
 // ============================================================================
@@ -153,8 +183,46 @@ void PowerManager::enableLowPowerMode()
 
     LOG_I("🔋 Activando modo bajo consumo");
 
-    // Reducir frecuencia CPU
-    setCpuFrequencyMhz(80);
+    // Candado para las secciones que no pueden dormir (se crea una sola vez)
+    if (!awakeLock)
+    {
+        esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "awake", &awakeLock);
+    }
+
+    // Escalado dinámico de frecuencia y, si ENABLE_LIGHT_SLEEP, light sleep
+    // automático: cuando todas las tareas están bloqueadas la tarea idle
+    // duerme hasta el próximo timeout de FreeRTOS (el deadline del scheduler)
+    // o hasta que una fuente de despertar lo interrumpa
+    esp_pm_config_esp32s3_t pmConfig = {};
+    pmConfig.max_freq_mhz = LOW_POWER_CPU_MHZ;
+    pmConfig.min_freq_mhz = LOW_POWER_MIN_CPU_MHZ;
+    pmConfig.light_sleep_enable = ENABLE_LIGHT_SLEEP;
+
+    esp_err_t err = esp_pm_configure(&pmConfig);
+    if (err == ESP_ERR_NOT_SUPPORTED && pmConfig.light_sleep_enable)
+    {
+        // SDK compilado sin tickless idle: quedarse solo con DFS
+        LOG_W("⚠️ Light sleep automático no soportado, solo escalado de frecuencia");
+        pmConfig.light_sleep_enable = false;
+        err = esp_pm_configure(&pmConfig);
+    }
+
+    if (err == ESP_OK)
+    {
+        lightSleepEnabled = pmConfig.light_sleep_enable;
+        if (lightSleepEnabled)
+        {
+            configureWakeSources();
+        }
+        LOG_I("💤 DFS %d-%d MHz, light sleep %s", pmConfig.min_freq_mhz, pmConfig.max_freq_mhz,
+              lightSleepEnabled ? "automático" : "desactivado");
+    }
+    else
+    {
+        // Sin gestión de energía en el SDK: frecuencia fija reducida
+        LOG_W("⚠️ esp_pm no disponible (%d), CPU fija a %d MHz", err, LOW_POWER_CPU_MHZ);
+        setCpuFrequencyMhz(LOW_POWER_CPU_MHZ);
+    }
 
     // Configurar GPIO para bajo consumo
     configurePinsForSleep();
@@ -169,8 +237,21 @@ void PowerManager::disableLowPowerMode()
 
     LOG_I("⚡ Desactivando modo bajo consumo");
 
-    // Restaurar frecuencia CPU
-    setCpuFrequencyMhz(240);
+    // Volver a frecuencia fija sin light sleep
+    esp_pm_config_esp32s3_t pmConfig = {};
+    pmConfig.max_freq_mhz = 240;
+    pmConfig.min_freq_mhz = 240;
+    pmConfig.light_sleep_enable = false;
+    if (esp_pm_configure(&pmConfig) != ESP_OK)
+    {
+        setCpuFrequencyMhz(240);
+    }
+
+    if (lightSleepEnabled)
+    {
+        clearWakeSources();
+        lightSleepEnabled = false;
+    }
 
     // Restaurar configuración de pines
     restorePinsAfterSleep();
@@ -178,6 +259,27 @@ void PowerManager::disableLowPowerMode()
     lowPowerModeEnabled = false;
 }
 
+bool PowerManager::isLightSleepEnabled() const
+{
+    return lightSleepEnabled;
+}
+
+void PowerManager::holdAwake()
+{
+    if (awakeLock)
+    {
+        esp_pm_lock_acquire(awakeLock);
+    }
+}
+
+void PowerManager::releaseAwake()
+{
+    if (awakeLock)
+    {
+        esp_pm_lock_release(awakeLock);
+    }
+}
+
 void PowerManager::prepareForDeepSleep(uint64_t sleepTimeUs)
 {
     LOG_I("😴 Preparando para deep sleep");
@@ -185,6 +287,9 @@ void PowerManager::prepareForDeepSleep(uint64_t sleepTimeUs)
     // Configurar pines para deep sleep
     configurePinsForSleep();
 
+    // Las fuentes del light sleep (UART, GPIO) no aplican en deep sleep
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+
     // Configurar timer si se especifica tiempo
     if (sleepTimeUs > 0)
     {
@@ -192,11 +297,14 @@ void PowerManager::prepareForDeepSleep(uint64_t sleepTimeUs)
         LOG_I("⏰ Deep sleep por %llu segundos", sleepTimeUs / 1000000ULL);
     }
 
-    // Habilitar hold de GPIO durante sleep
+    // El botón PRG siempre despierta (GPIO0 es RTC IO)
+    esp_sleep_enable_ext0_wakeup((gpio_num_t)PRG_BUTTON, 0);
+
+    // Habilitar hold de GPIO durante sleep (VEXT queda como esté)
     gpio_deep_sleep_hold_en();
 
     LOG_I("💤 Entrando en deep sleep...");
-    delay(100); // Asegurar que el mensaje se imprima
+    Logger::flush(); // Asegurar que los mensajes pendientes se impriman
 
     esp_deep_sleep_start();
 }
@@ -361,23 +469,38 @@ void PowerManager::restorePinsAfterSleep()
     pinMode(EXP_PIN_4, OUTPUT);
 }
 
-float PowerManager::calculateBatteryPercentage(float voltage)
+void PowerManager::configureWakeSources()
 {
-    // Curva no lineal más precisa para Li-ion bajo carga
-    if (voltage <= 3.2)
-        return 0;
-    if (voltage >= 4.0)
-        return 100;
+    // GPS: la UART despierta tras unos flancos de RX; esos primeros bytes se
+    // pierden, pero llegan en el '$' inicial de la ráfaga NMEA
+    uart_set_wakeup_threshold(GPS_UART_NUM, GPS_UART_WAKE_THRESHOLD);
+    esp_sleep_enable_uart_wakeup(GPS_UART_NUM);
+
+    // DIO1 del SX1262 (RX/TX done) por EXT1, para no tocar la interrupción
+    // por flanco que usa RadioLib
+    esp_sleep_enable_ext1_wakeup(1ULL << LORA_DIO1, ESP_EXT1_WAKEUP_ANY_HIGH);
+
+    // Botón PRG (activo en bajo). Deja la interrupción del pin por nivel:
+    // la ISR la deshabilita y la tarea del botón la rehabilita al soltar
+    gpio_wakeup_enable((gpio_num_t)PRG_BUTTON, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+}
 
-    // Mapeo con puntos de inflexión típicos
-    if (voltage >= 3.7)
-    {
-        // 3.7V-4.0V = 50%-100% (subida rápida)
-        return 50 + ((voltage - 3.7) / 0.3) * 50;
-    }
-    else
+void PowerManager::clearWakeSources()
+{
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_UART);
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_EXT1);
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+    gpio_wakeup_disable((gpio_num_t)PRG_BUTTON);
+}
+
+float PowerManager::readRestVoltage()
+{
+    // Muestras seguidas, sin las del promedio móvil que pueden ser de un TX
+    float sum = 0.0f;
+    for (uint8_t i = 0; i < BATTERY_REST_SAMPLES; i++)
     {
-        // 3.2V-3.7V = 0%-50% (caída gradual)
-        return ((voltage - 3.2) / 0.5) * 50;
+        sum += readVoltageRaw();
     }
+    return sum / BATTERY_REST_SAMPLES;
 }
@@ -1,8 +1,10 @@
 #pragma once
 #include <Arduino.h>
+#include <esp_pm.h>
 #include "../config/pins.h"
 #include "../config/constants.h"
 #include "../core/Types.h"
+#include "../system/BatteryEstimator.h"
 
 // Definición de WATCHDOG_TIMEOUT si no existe
 #ifndef WATCHDOG_TIMEOUT
@@ -51,17 +53,30 @@ public:
     Result init();
     bool isInitialized() const;
 
-    // Lectura de batería
-    void readBattery();
+    // Lectura de batería. atRest: la radio y el GPS están callados, la
+    // lectura corrige el estado de carga (BatteryEstimator)
+    void readBattery(bool atRest = false);
     BatteryStatus getBatteryStatus() const;
     float getVoltage() const;
     uint8_t getPercentage() const;
     bool isLow() const;
     bool isCritical() const;
 
+    // Conteo de carga: mAh consumidos en elapsedMs según EnergyModel
+    void addConsumption(float mAh, uint32_t elapsedMs);
+    const BatteryEstimator &getEstimator() const;
+    // Estado retenido en deep sleep (modo ciclo): init() ya no lo re-ancla
+    void restoreEstimator(const BatteryEstimator::State &state);
+
     // Gestión de energía
     void enableLowPowerMode();
     void disableLowPowerMode();
+    bool isLightSleepEnabled() const;
+
+    // Mantiene la CPU despierta mientras haya trabajo que no tolera el light
+    // sleep (ráfaga del GPS, uplink en curso, alerta sonando). Anidable
+    void holdAwake();
+    void releaseAwake();
     void prepareForDeepSleep(uint64_t sleepTimeUs = 0);
     void wakeFromDeepSleep();
 
@@ -85,6 +100,8 @@ private:
     BatteryStatus batteryStatus;
     bool initialized;
     bool lowPowerModeEnabled;
+    bool lightSleepEnabled;
+    esp_pm_lock_handle_t awakeLock;
     uint32_t startTime;
 
     // Callbacks
@@ -97,14 +114,18 @@ private:
     uint8_t currentSample;
     bool samplesReady;
 
+    BatteryEstimator estimator;
+
     // Métodos privados
     float readVoltageRaw();
     float calculateAverageVoltage();
-    float calculateBatteryPercentage(float voltage);
+    float readRestVoltage();
     void updateBatteryStatus();
     void triggerBatteryCallbacks();
 
     // Configuración de pines para low power
     void configurePinsForSleep();
     void restorePinsAfterSleep();
+    void configureWakeSources();
+    void clearWakeSources();
 };
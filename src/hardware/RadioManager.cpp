@@ -1,5 +1,8 @@
 #include "RadioManager.h"
 #include "../core/Logger.h"
+#include "../system/Profiler.h"
+#include "../utils/PolygonCodec.h"
+#include "../utils/GeofenceDelta.h"
 #include <Preferences.h> // Para guardar configuración persistente
 // ============================================================================
 // DEFINICIONES DE COMPATIBILIDAD PARA RADIOLIB 6.6.0
@@ -48,6 +51,15 @@
 #define PREFS_NAMESPACE_SESSION "lw_session"
 #define PREFS_KEY_NONCES_BUFFER "nonces_buf"
 #define PREFS_KEY_SESSION_BUFFER "session_buf"
+#define PREFS_NAMESPACE_STORE "lw_store"
+
+// El FCnt y la firma solo se pueden reescribir si RadioLib expone su posición.
+// Sin eso el store no declara regiones volátiles y guarda en cada uplink.
+#if defined(RADIOLIB_LORAWAN_SESSION_FCNT_UP) && defined(RADIOLIB_LORAWAN_SESSION_SIGNATURE)
+#define SESSION_FCNT_PATCHABLE 1
+#else
+#define SESSION_FCNT_PATCHABLE 0
+#endif
 
 // ============================================================================
 // VARIABLE ESTÁTICA PARA INTERRUPT CALLBACK
@@ -58,6 +70,7 @@ RadioManager *RadioManager::instance = nullptr;
 // VARIABLE PARA CALLBACK DE GEOCERCA
 // ============================================================================
 GeofenceUpdateCallback RadioManager::geofenceUpdateCallback = nullptr;
+GeofenceDeltaCallback RadioManager::geofenceDeltaCallback = nullptr;
 
 // ============================================================================
 // CONSTRUCTOR E INICIALIZACIÓN
@@ -68,16 +81,28 @@ RadioManager::RadioManager(uint8_t nss, uint8_t dio1, uint8_t rst, uint8_t busy)
                                                                                    nssPin(nss), dio1Pin(dio1), rstPin(rst), busyPin(busy),
                                                                                    initialized(false), joined(false), sleeping(false),
                                                                                    currentState(STATE_IDLE),
-                                                                                   packetsSent(0), packetsReceived(0), packetsLost(0),
+                                                                                   packetsSent(0), packetsReceived(0), packetsLost(0), txAirtimeMs(0.0f),
                                                                                    lastRSSI(0), lastSNR(0),
                                                                                    uplinkFrameCounter(0), downlinkFrameCounter(0), lastDownlinkTime(0),
                                                                                    currentDataRate(0), currentTxPower(20),
                                                                                    adrEnabled(true), confirmedUplinks(false),
                                                                                    downlinkCallback(nullptr), joinCallback(nullptr), txCallback(nullptr),
                                                                                    pendingDownlink(false), downlinkLength(0), downlinkPort(0),
-                                                                                   sessionRestored(false)
+                                                                                   sessionBackend(PREFS_NAMESPACE_STORE),
+                                                                                   sessionStore(sessionBackend, SESSION_FCNT_LOG_INTERVAL,
+                                                                                                SESSION_FCNT_PATCHABLE ? SESSION_FLUSH_INTERVAL : 1),
+                                                                                   sessionRestored(false),
+                                                                                   geofenceFragments(GEOFENCE_FRAGMENT_TIMEOUT),
+                                                                                   pendingFenceId(0),
+                                                                                   pendingFenceVersion(0)
 {
     instance = this;
+
+#if SESSION_FCNT_PATCHABLE
+    // FCnt y firma cambian en cada uplink: los cubre el log de contadores
+    sessionStore.addVolatileRegion(SessionStore::BLOB_SESSION, RADIOLIB_LORAWAN_SESSION_FCNT_UP, 4);
+    sessionStore.addVolatileRegion(SessionStore::BLOB_SESSION, RADIOLIB_LORAWAN_SESSION_SIGNATURE, 2);
+#endif
 }
 
 Result RadioManager::init()
@@ -170,7 +195,8 @@ Result RadioManager::setupLoRaWAN()
 // IMPLEMENTACIÓN CORRECTA DE OTAA CON PERSISTENCIA
 // ============================================================================
 
-Result RadioManager::joinOTAA(const uint8_t *devEUI, const uint8_t *appEUI, const uint8_t *appKey)
+Result RadioManager::joinOTAA(const uint8_t *devEUI, const uint8_t *appEUI, const uint8_t *appKey,
+                              const uint8_t *retainedNonces, const uint8_t *retainedSession)
 {
     if (!initialized)
     {
@@ -197,7 +223,12 @@ Result RadioManager::joinOTAA(const uint8_t *devEUI, const uint8_t *appEUI, cons
 
     // PASO 2: Intentar restaurar sesión persistente ANTES de activar
     bool sessionLoaded = false;
-    if (loadPersistentSession())
+    if (retainedNonces && retainedSession && loadRetainedSession(retainedNonces, retainedSession))
+    {
+        LOG_I("📡 Buffers de sesión retenidos en RTC");
+        sessionLoaded = true;
+    }
+    else if (loadPersistentSession())
     {
         LOG_I("📡 Buffers de sesión cargados desde NVS");
         sessionLoaded = true;
@@ -222,7 +253,7 @@ Result RadioManager::joinOTAA(const uint8_t *devEUI, const uint8_t *appEUI, cons
         sessionRestored = false;
 
         // Guardar nueva sesión inmediatamente
-        if (!savePersistentSession())
+        if (!savePersistentSession(SAVE_NEW_SESSION))
         {
             LOG_W("⚠️ Error guardando nueva sesión");
         }
@@ -267,10 +298,10 @@ Result RadioManager::joinOTAA(const uint8_t *devEUI, const uint8_t *appEUI, cons
 }
 
 // ============================================================================
-// PERSISTENCIA CORRECTA DE SESIÓN LORAWAN
+// PERSISTENCIA INCREMENTAL DE SESIÓN LORAWAN
 // ============================================================================
 
-bool RadioManager::savePersistentSession()
+bool RadioManager::savePersistentSession(SaveMode mode)
 {
     if (!lorawan.isActivated())
     {
@@ -278,8 +309,6 @@ bool RadioManager::savePersistentSession()
         return false;
     }
 
-    LOG_D("💾 Guardando sesión LoRaWAN en NVS...");
-
     // PASO 1: Obtener buffers de RadioLib
     uint8_t *noncesBuffer = lorawan.getBufferNonces();
     uint8_t *sessionBuffer = lorawan.getBufferSession();
@@ -290,49 +319,79 @@ bool RadioManager::savePersistentSession()
         return false;
     }
 
-    // PASO 2: Guardar buffer de Nonces
-    Preferences prefsNonces;
-    if (!prefsNonces.begin(PREFS_NAMESPACE_NONCES, false))
+    // PASO 2: Marcar solo los bloques que cambiaron respecto a lo persistido
+    sessionStore.stage(SessionStore::BLOB_NONCES, noncesBuffer, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+    sessionStore.stage(SessionStore::BLOB_SESSION, sessionBuffer, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+
+    uint32_t fcntUp = readSessionFrameCounter(sessionBuffer);
+    uint32_t writesBefore = sessionStore.getStats().writes;
+    bool ok = true;
+
+    // PASO 3: Escribir según el motivo (la mayoría de uplinks no tocan la flash)
+    switch (mode)
     {
-        LOG_E("❌ Error abriendo namespace nonces");
+    case SAVE_UPLINK:
+        ok = sessionStore.commitUplink(fcntUp);
+        break;
+    case SAVE_FORCE:
+        ok = sessionStore.flush(fcntUp);
+        break;
+    case SAVE_NEW_SESSION:
+        ok = sessionStore.startSession(fcntUp);
+        break;
+    }
+
+    if (!ok)
+    {
+        LOG_E("❌ Error guardando sesión LoRaWAN en NVS");
         return false;
     }
 
-    size_t noncesSize = prefsNonces.putBytes(PREFS_KEY_NONCES_BUFFER,
-                                             noncesBuffer,
-                                             RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
-    prefsNonces.end();
+    uint32_t writes = sessionStore.getStats().writes - writesBefore;
+    if (writes > 0)
+    {
+        LOG_D("💾 Sesión LoRaWAN persistida: %lu escrituras NVS (FCnt %lu)", writes, fcntUp);
+    }
+
+    return true;
+}
+
+// Sesión retenida en RTC durante el deep sleep: FCnt exacto, sin leer NVS
+bool RadioManager::loadRetainedSession(const uint8_t *nonces, const uint8_t *session)
+{
+    // La copia sombra del store debe reflejar la flash para las escrituras siguientes
+    sessionStore.begin();
 
-    if (noncesSize != RADIOLIB_LORAWAN_NONCES_BUF_SIZE)
+    uint8_t noncesBuffer[RADIOLIB_LORAWAN_NONCES_BUF_SIZE];
+    uint8_t sessionBuffer[RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
+    memcpy(noncesBuffer, nonces, sizeof(noncesBuffer));
+    memcpy(sessionBuffer, session, sizeof(sessionBuffer));
+
+    if (lorawan.setBufferNonces(noncesBuffer) != RADIOLIB_ERR_NONE ||
+        lorawan.setBufferSession(sessionBuffer) != RADIOLIB_ERR_NONE)
     {
-        LOG_E("❌ Error guardando buffer nonces: %d/%d bytes",
-              noncesSize, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+        LOG_W("⚠️ Sesión retenida en RTC descartada, se usa la de NVS");
         return false;
     }
+    return true;
+}
 
-    // PASO 3: Guardar buffer de Session
-    Preferences prefsSession;
-    if (!prefsSession.begin(PREFS_NAMESPACE_SESSION, false))
+bool RadioManager::exportSession(uint8_t *nonces, uint8_t *session)
+{
+    if (!lorawan.isActivated())
     {
-        LOG_E("❌ Error abriendo namespace session");
         return false;
     }
 
-    size_t sessionSize = prefsSession.putBytes(PREFS_KEY_SESSION_BUFFER,
-                                               sessionBuffer,
-                                               RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
-    prefsSession.end();
-
-    if (sessionSize != RADIOLIB_LORAWAN_SESSION_BUF_SIZE)
+    uint8_t *noncesBuffer = lorawan.getBufferNonces();
+    uint8_t *sessionBuffer = lorawan.getBufferSession();
+    if (!noncesBuffer || !sessionBuffer)
     {
-        LOG_E("❌ Error guardando buffer session: %d/%d bytes",
-              sessionSize, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
         return false;
     }
 
-    LOG_I("✅ Sesión LoRaWAN guardada exitosamente");
-    LOG_D("   Nonces: %d bytes, Session: %d bytes", noncesSize, sessionSize);
-
+    memcpy(nonces, noncesBuffer, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+    memcpy(session, sessionBuffer, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
     return true;
 }
 
@@ -340,7 +399,9 @@ void RadioManager::clearPersistentSession()
 {
     LOG_I("🗑️ Limpiando sesión persistente...");
 
-    // Limpiar namespace de nonces
+    sessionStore.clear();
+
+    // Limpiar también los namespaces del formato anterior
     Preferences prefsNonces;
     if (prefsNonces.begin(PREFS_NAMESPACE_NONCES, false))
     {
@@ -348,7 +409,6 @@ void RadioManager::clearPersistentSession()
         prefsNonces.end();
     }
 
-    // Limpiar namespace de session
     Preferences prefsSession;
     if (prefsSession.begin(PREFS_NAMESPACE_SESSION, false))
     {
@@ -371,43 +431,31 @@ bool RadioManager::loadPersistentSession()
     uint8_t noncesBuffer[RADIOLIB_LORAWAN_NONCES_BUF_SIZE];
     uint8_t sessionBuffer[RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
 
-    // PASO 1: Cargar buffer de Nonces
-    Preferences prefsNonces;
-    if (!prefsNonces.begin(PREFS_NAMESPACE_NONCES, true))
+    // PASO 1: Cargar el store (o migrar desde el formato anterior)
+    if (!sessionStore.begin() && !migrateLegacySession())
     {
-        LOG_D("📁 No existe namespace nonces");
+        LOG_D("📁 No existe sesión persistida");
         return false;
     }
 
-    size_t noncesSize = prefsNonces.getBytes(PREFS_KEY_NONCES_BUFFER,
-                                             noncesBuffer,
-                                             RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
-    prefsNonces.end();
-
-    if (noncesSize != RADIOLIB_LORAWAN_NONCES_BUF_SIZE)
+    if (!sessionStore.load(SessionStore::BLOB_NONCES, noncesBuffer, RADIOLIB_LORAWAN_NONCES_BUF_SIZE) ||
+        !sessionStore.load(SessionStore::BLOB_SESSION, sessionBuffer, RADIOLIB_LORAWAN_SESSION_BUF_SIZE))
     {
-        LOG_D("📁 Buffer nonces inválido: %d bytes", noncesSize);
+        LOG_D("📁 Buffers persistidos con tamaño inválido");
         return false;
     }
 
-    // PASO 2: Cargar buffer de Session
-    Preferences prefsSession;
-    if (!prefsSession.begin(PREFS_NAMESPACE_SESSION, true))
+    // PASO 2: Gap-jump del FCnt. El buffer puede ser más viejo que el último
+    // uplink enviado; el log garantiza un valor que el servidor no ha visto.
+#if SESSION_FCNT_PATCHABLE
+    uint32_t storedFcnt = readSessionFrameCounter(sessionBuffer);
+    uint32_t restoredFcnt = sessionStore.restoredFrameCounter();
+    if (restoredFcnt > storedFcnt)
     {
-        LOG_D("📁 No existe namespace session");
-        return false;
-    }
-
-    size_t sessionSize = prefsSession.getBytes(PREFS_KEY_SESSION_BUFFER,
-                                               sessionBuffer,
-                                               RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
-    prefsSession.end();
-
-    if (sessionSize != RADIOLIB_LORAWAN_SESSION_BUF_SIZE)
-    {
-        LOG_D("📁 Buffer session inválido: %d bytes", sessionSize);
-        return false;
+        patchSessionFrameCounter(sessionBuffer, restoredFcnt);
+        LOG_I("📦 FCnt restaurado con salto: %lu -> %lu", storedFcnt, restoredFcnt);
     }
+#endif
 
     // PASO 3: Restaurar buffers en RadioLib
     int16_t noncesResult = lorawan.setBufferNonces(noncesBuffer);
@@ -442,6 +490,97 @@ bool RadioManager::loadPersistentSession()
     return true;
 }
 
+bool RadioManager::migrateLegacySession()
+{
+    uint8_t noncesBuffer[RADIOLIB_LORAWAN_NONCES_BUF_SIZE];
+    uint8_t sessionBuffer[RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
+
+    // Formato anterior: un namespace por buffer, reescritos completos
+    Preferences prefsNonces;
+    if (!prefsNonces.begin(PREFS_NAMESPACE_NONCES, true))
+    {
+        return false;
+    }
+    size_t noncesSize = prefsNonces.getBytes(PREFS_KEY_NONCES_BUFFER, noncesBuffer,
+                                             RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+    prefsNonces.end();
+
+    Preferences prefsSession;
+    if (!prefsSession.begin(PREFS_NAMESPACE_SESSION, true))
+    {
+        return false;
+    }
+    size_t sessionSize = prefsSession.getBytes(PREFS_KEY_SESSION_BUFFER, sessionBuffer,
+                                               RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+    prefsSession.end();
+
+    if (noncesSize != RADIOLIB_LORAWAN_NONCES_BUF_SIZE || sessionSize != RADIOLIB_LORAWAN_SESSION_BUF_SIZE)
+    {
+        return false;
+    }
+
+    LOG_I("📦 Migrando sesión LoRaWAN al formato incremental");
+
+    // El formato anterior guardaba cada 2 uplinks: saltar al menos eso
+    sessionStore.stage(SessionStore::BLOB_NONCES, noncesBuffer, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+    sessionStore.stage(SessionStore::BLOB_SESSION, sessionBuffer, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+    if (!sessionStore.startSession(readSessionFrameCounter(sessionBuffer) + 2))
+    {
+        return false;
+    }
+
+    Preferences prefs;
+    if (prefs.begin(PREFS_NAMESPACE_NONCES, false))
+    {
+        prefs.clear();
+        prefs.end();
+    }
+    if (prefs.begin(PREFS_NAMESPACE_SESSION, false))
+    {
+        prefs.clear();
+        prefs.end();
+    }
+
+    return sessionStore.begin();
+}
+
+// ============================================================================
+// FCNT DENTRO DEL BUFFER DE SESIÓN DE RADIOLIB
+// ============================================================================
+
+uint32_t RadioManager::readSessionFrameCounter(const uint8_t *session)
+{
+#if SESSION_FCNT_PATCHABLE
+    const uint8_t *p = &session[RADIOLIB_LORAWAN_SESSION_FCNT_UP];
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+#else
+    return instance ? instance->uplinkFrameCounter : 0;
+#endif
+}
+
+void RadioManager::patchSessionFrameCounter(uint8_t *session, uint32_t frameCounter)
+{
+#if SESSION_FCNT_PATCHABLE
+    uint8_t *p = &session[RADIOLIB_LORAWAN_SESSION_FCNT_UP];
+    p[0] = frameCounter & 0xFF;
+    p[1] = (frameCounter >> 8) & 0xFF;
+    p[2] = (frameCounter >> 16) & 0xFF;
+    p[3] = (frameCounter >> 24) & 0xFF;
+
+    // Recalcular la firma igual que RadioLib (XOR de palabras de 16 bits)
+    uint16_t signature = 0;
+    for (size_t i = 0; i + 1 < RADIOLIB_LORAWAN_SESSION_SIGNATURE; i += 2)
+    {
+        signature ^= ((uint16_t)session[i] << 8) | session[i + 1];
+    }
+    session[RADIOLIB_LORAWAN_SESSION_SIGNATURE] = signature & 0xFF;
+    session[RADIOLIB_LORAWAN_SESSION_SIGNATURE + 1] = (signature >> 8) & 0xFF;
+#else
+    (void)session;
+    (void)frameCounter;
+#endif
+}
+
 Result RadioManager::joinABP(const uint8_t *devAddr, const uint8_t *nwkSKey, const uint8_t *appSKey)
 {
     if (!initialized)
@@ -518,12 +657,26 @@ void RadioManager::setGeofenceUpdateCallback(GeofenceUpdateCallback callback)
     geofenceUpdateCallback = callback;
 }
 
+void RadioManager::setGeofenceDeltaCallback(GeofenceDeltaCallback callback)
+{
+    geofenceDeltaCallback = callback;
+}
+
+// Entrega una geocerca completa con la identidad del GEOFENCE_CMD_IDENTIFIED en curso
+void RadioManager::dispatchGeofenceUpdate(GeofenceUpdate &update)
+{
+    update.fenceId = pendingFenceId;
+    update.version = pendingFenceVersion;
+    geofenceUpdateCallback(update);
+}
+
 // ============================================================================
 // TRANSMISIÓN DE DATOS - CORREGIDO PARA RADIOLIB 6.6.0
 // ============================================================================
 
 Result RadioManager::sendPacket(const uint8_t *data, size_t length, uint8_t port)
 {
+    PROFILE_SCOPE("radio_tx"); // TX y ventanas RX1/RX2
     if (!initialized || !joined)
     {
         LOG_E("❌ Error: Radio no inicializado o no unido a la red");
@@ -549,7 +702,20 @@ Result RadioManager::sendPacket(const uint8_t *data, size_t length, uint8_t port
 
     // El puerto se pasa como tercer parámetro a uplink()
     // El cuarto parámetro indica si es confirmado (true) o no confirmado (false)
+    // Cada intento cuenta como transmisión en el registro de energía (13 bytes de cabecera LoRaWAN)
+    float attemptAirtimeMs = EnergyModel::loraAirtimeMs(LORAWAN_SF, 125, length + 13);
     int16_t state = lorawan.uplink(txBuffer, length, port, confirmedUplinks);
+    txAirtimeMs += attemptAirtimeMs;
+
+    // Canal ocupado: reintentar antes de dar el uplink por perdido
+    uint8_t retries = 0;
+    while (state == RADIOLIB_ERR_TX_TIMEOUT && retries < LORAWAN_UPLINK_RETRIES)
+    {
+        retries++;
+        LOG_W("⏱️ Timeout de transmisión, reintento %d/%d", retries, LORAWAN_UPLINK_RETRIES);
+        state = lorawan.uplink(txBuffer, length, port, confirmedUplinks);
+        txAirtimeMs += attemptAirtimeMs;
+    }
 
     // Verificar resultado del uplink
     if (state == RADIOLIB_ERR_NONE || state == RADIOLIB_LORAWAN_NO_DOWNLINK)
@@ -558,22 +724,19 @@ Result RadioManager::sendPacket(const uint8_t *data, size_t length, uint8_t port
         packetsSent++;
         currentState = STATE_IDLE;
         uplinkFrameCounter++;
+        {
+            RtosLock lock(linkMutex);
+            linkQuality.recordUplink(currentDataRate, true, retries);
+        }
 
-        // Obtener métricas de calidad del último paquete
-        lastRSSI = radio.getRSSI();
-        lastSNR = radio.getSNR();
-
-        LOG_I("✅ Packet #%d enviado exitosamente", packetsSent);
-        LOG_I("   RSSI: %.1f dBm, SNR: %.1f dB", lastRSSI, lastSNR);
+        LOG_I("✅ Packet #%d enviado exitosamente (DR%d)", packetsSent, currentDataRate);
         LOG_I("   Frame Counter: %lu", uplinkFrameCounter);
 
-        // PERSISTENCIA AUTOMÁTICA: Guardar sesión cada N paquetes
-        if (packetsSent % 2 == 0)
-        { // Cada 2 paquetes
-            if (!savePersistentSession())
-            {
-                LOG_W("⚠️ Error guardando sesión después del uplink");
-            }
+        // PERSISTENCIA AUTOMÁTICA: el store solo escribe bloques modificados
+        // y registra el FCnt cada SESSION_FCNT_LOG_INTERVAL uplinks
+        if (!savePersistentSession(SAVE_UPLINK))
+        {
+            LOG_W("⚠️ Error guardando sesión después del uplink");
         }
 
         // Verificar downlink si está disponible
@@ -594,6 +757,10 @@ Result RadioManager::sendPacket(const uint8_t *data, size_t length, uint8_t port
         // Error en el envío
         packetsLost++;
         currentState = STATE_ERROR;
+        {
+            RtosLock lock(linkMutex);
+            linkQuality.recordUplink(currentDataRate, false, retries);
+        }
 
         // Diagnóstico detallado del error
         LOG_E("❌ Error enviando packet: %d (%s)", state, getErrorString(state));
@@ -612,11 +779,11 @@ Result RadioManager::sendPacket(const uint8_t *data, size_t length, uint8_t port
             break;
 
         case RADIOLIB_ERR_INVALID_PORT:
-            Serial.printf("🔢 Error: Puerto inválido (%d) - Use puertos 1-223\n", port);
+            LOG_E("🔢 Error: Puerto inválido (%d) - Use puertos 1-223", port);
             break;
 
         case RADIOLIB_ERR_PACKET_TOO_LONG:
-            Serial.printf("📏 Error: Paquete muy largo (%d bytes) para el DR actual\n", length);
+            LOG_E("📏 Error: Paquete muy largo (%d bytes) para el DR actual", length);
             break;
 
         case RADIOLIB_ERR_INVALID_FREQUENCY:
@@ -633,7 +800,7 @@ Result RadioManager::sendPacket(const uint8_t *data, size_t length, uint8_t port
             break;
 
         case RADIOLIB_LORAWAN_INVALID_FPORT:
-            Serial.printf("🔢 Error: Puerto F (%d) fuera de rango válido\n", port);
+            LOG_E("🔢 Error: Puerto F (%d) fuera de rango válido", port);
             break;
 
         case RADIOLIB_LORAWAN_INVALID_BUFFER_SIZE:
@@ -641,15 +808,11 @@ Result RadioManager::sendPacket(const uint8_t *data, size_t length, uint8_t port
             break;
 
         default:
-            Serial.printf("❓ Error desconocido: %d - %s\n", state, getErrorString(state));
+            LOG_E("❓ Error desconocido: %d - %s", state, getErrorString(state));
             // Imprimir información adicional para debugging
-            Serial.println("\n🔍 Información de diagnóstico:");
-            Serial.printf("   - Estado del manager: %s\n", getStateString());
-            Serial.printf("   - Join status: %s\n", joined ? "JOINED" : "NOT JOINED");
-            Serial.printf("   - Initialized: %s\n", initialized ? "YES" : "NO");
-            Serial.printf("   - Frame Counter Up: %lu\n", uplinkFrameCounter);
-            Serial.printf("   - Puerto usado: %d\n", port);
-            Serial.printf("   - Tamaño del payload: %d bytes\n", length);
+            LOG_E("🔍 Diagnóstico: estado %s, %s, %s, FCnt up %u, puerto %d, payload %d bytes",
+                  getStateString(), joined ? "JOINED" : "NOT JOINED", initialized ? "inicializado" : "sin inicializar",
+                  uplinkFrameCounter, port, length);
             break;
         }
 
@@ -672,6 +835,25 @@ void RadioManager::handleDownlink()
 
     int16_t dlState = lorawan.downlink(downlinkPayload, &dlLen);
 
+    // Geocerca fragmentada que dejó de llegar: liberar la parcial
+    if (geofenceFragments.expire(millis()))
+    {
+        LOG_W("⚠️ Geocerca fragmentada incompleta descartada por timeout");
+    }
+
+    // Cualquier recepción (también ACK o comandos MAC sin payload) mide el enlace
+    if (dlState == RADIOLIB_ERR_NONE)
+    {
+        lastRSSI = radio.getRSSI();
+        lastSNR = radio.getSNR();
+        {
+            RtosLock lock(linkMutex);
+            linkQuality.recordDownlink(lastRSSI, lastSNR, millis());
+        }
+        lastDownlinkTime = millis();
+        LOG_I("📶 Downlink RSSI: %.1f dBm, SNR: %.1f dB", lastRSSI, lastSNR);
+    }
+
     if (dlState == RADIOLIB_ERR_NONE && dlLen > 0)
     {
         packetsReceived++;
@@ -692,13 +874,13 @@ void RadioManager::handleDownlink()
         processDownlink(downlinkPayload, dlLen, dlPort);
 
         // Guardar sesión después de downlink (pueden haber comandos MAC)
-        savePersistentSession();
+        savePersistentSession(SAVE_FORCE);
     }
 }
 
-Result RadioManager::sendString(const String &message, uint8_t port)
+Result RadioManager::sendString(const char *message, uint8_t port)
 {
-    return sendPacket((const uint8_t *)message.c_str(), message.length(), port);
+    return sendPacket((const uint8_t *)message, strlen(message), port);
 }
 
 Result RadioManager::sendPosition(const Position &position, AlertLevel alertLevel)
@@ -712,6 +894,23 @@ Result RadioManager::sendPosition(const Position &position, AlertLevel alertLeve
     return sendPacket(txBuffer, payloadSize, 1);
 }
 
+Result RadioManager::sendLinkStatus()
+{
+    uint8_t payload[LinkQuality::SUMMARY_MAX_SIZE];
+    size_t payloadSize = getLinkQuality().buildSummary(payload, sizeof(payload), millis());
+    if (payloadSize == 0)
+    {
+        return Result::ERROR_INVALID_PARAM;
+    }
+    return sendPacket(payload, payloadSize, LORAWAN_PORT_STATUS);
+}
+
+LinkQuality RadioManager::getLinkQuality() const
+{
+    RtosLock lock(linkMutex);
+    return linkQuality;
+}
+
 Result RadioManager::sendBatteryStatus(const BatteryStatus &battery)
 {
     size_t payloadSize = createBatteryPayload(txBuffer, battery);
@@ -805,6 +1004,11 @@ uint16_t RadioManager::getPacketsLost() const
     return packetsLost;
 }
 
+float RadioManager::getTxAirtimeMs() const
+{
+    return txAirtimeMs;
+}
+
 float RadioManager::getRSSI() const
 {
     return lastRSSI;
@@ -1074,10 +1278,12 @@ size_t RadioManager::createDeviceStatusPayload(uint8_t *buffer, const Position &
 
 size_t RadioManager::createBatteryPayload(uint8_t *buffer, const BatteryStatus &battery)
 {
-    // Formato simple de batería (4 bytes):
-    // Voltage: 2 bytes (uint16, mV)
+    // Formato simple de batería (6 bytes):
+    // Voltage: 2 bytes (uint16 big-endian, mV)
     // Percentage: 1 byte
     // Flags: 1 byte (charging, low, critical)
+    // Autonomía: 2 bytes (uint16 big-endian, horas, 0xFFFF = sin estimación),
+    // igual que en la trama de posición
 
     size_t index = 0;
 
@@ -1096,6 +1302,9 @@ size_t RadioManager::createBatteryPayload(uint8_t *buffer, const BatteryStatus &
         flags |= 0x04;
     buffer[index++] = flags;
 
+    buffer[index++] = (battery.remainingHours >> 8) & 0xFF;
+    buffer[index++] = battery.remainingHours & 0xFF;
+
     return index;
 }
 
@@ -1145,6 +1354,7 @@ void RadioManager::parseSystemCommand(const uint8_t *data, size_t length)
     {
     case 0x01: // Reset del dispositivo
         LOG_W("📡 Comando reset recibido");
+        Logger::flush();
         delay(1000);
         ESP.restart();
         break;
@@ -1156,6 +1366,9 @@ void RadioManager::parseSystemCommand(const uint8_t *data, size_t length)
         LOG_I("📡 Comando estado solicitado");
         // Enviar estado actual
         break;
+    case 0x04: // Subir la bitácora (la atiende el callback de downlink)
+        LOG_I("📡 Bitácora solicitada (%d eventos)", length > 1 ? data[1] : 0);
+        break;
     default:
         LOG_W("📡 Comando sistema desconocido: 0x%02X", command);
         break;
@@ -1185,6 +1398,30 @@ void RadioManager::parseAlertCommand(const uint8_t *data, size_t length)
             LOG_I("📡 Comando cambiar alerta a nivel %d", level);
         }
         break;
+    case 0x04: // Reproducir un patrón del buzzer (lo atiende el callback de downlink)
+        if (length >= 2)
+        {
+            LOG_I("📡 Patrón de buzzer solicitado: %d", data[1]);
+        }
+        break;
+    case 0x05: // Cadencia de un nivel de alerta (lo atiende el callback de downlink)
+        if (length >= 3)
+        {
+            LOG_I("📡 Cadencia del nivel %d: patrón %d", data[1], data[2]);
+        }
+        break;
+    case 0x06: // Histéresis y permanencia de los niveles (lo atiende el callback de downlink)
+        if (length >= 4)
+        {
+            LOG_I("📡 Filtro de alertas: %dm, %ds, %ds", data[1], data[2], data[3]);
+        }
+        break;
+    case 0x07: // Política de estímulos (lo atiende el callback de downlink)
+        if (length >= 4)
+        {
+            LOG_I("📡 Política de estímulos %d: escalada %ds, tope %d", data[1], data[2], data[3]);
+        }
+        break;
     default:
         LOG_W("📡 Comando alerta desconocido: 0x%02X", command);
         break;
@@ -1230,20 +1467,40 @@ void RadioManager::parseGeofenceCommand(const uint8_t *data, size_t length)
 
     LOG_I("🌐 GEOCERCA RECIBIDA vía LoRaWAN - Tipo: %d", geofenceType);
 
-    if (geofenceType == 0)
+    if (geofenceType == GEOFENCE_CMD_CIRCLE)
     {
         // Círculo
         parseCircleGeofence(data, length);
     }
-    else if (geofenceType == 1)
+    else if (geofenceType == GEOFENCE_CMD_POLYGON)
     {
         // Polígono
         parsePolygonGeofence(data, length);
     }
-    else if (geofenceType == 2)
+    else if (geofenceType == GEOFENCE_CMD_POLYGON_COMPRESSED)
     {
         parseCompressedPolygonGeofence(data, length);
     }
+    else if (geofenceType == GEOFENCE_CMD_POLYGON_LARGE)
+    {
+        parseLargePolygonGeofence(data, length);
+    }
+    else if (geofenceType == GEOFENCE_CMD_POLYGON_VARINT)
+    {
+        parseVarintPolygonGeofence(data, length);
+    }
+    else if (geofenceType == GEOFENCE_CMD_IDENTIFIED)
+    {
+        parseIdentifiedGeofence(data, length);
+    }
+    else if (geofenceType == GEOFENCE_CMD_FRAGMENT)
+    {
+        parseGeofenceFragment(data, length);
+    }
+    else if (geofenceType == GEOFENCE_CMD_DELTA)
+    {
+        parseGeofenceDelta(data, length);
+    }
     else
     {
         LOG_W("⚠️ Tipo de geocerca desconocido: %d", geofenceType);
@@ -1290,12 +1547,13 @@ void RadioManager::parseCircleGeofence(const uint8_t *data, size_t length)
         update.centerLng = lng;
         update.radius = (float)radius;
         update.pointCount = 0;
+        update.points = nullptr;
         strncpy(update.name, "Circle", sizeof(update.name) - 1);
         strncpy(update.groupId, groupId, sizeof(update.groupId) - 1);
         update.name[sizeof(update.name) - 1] = '\0';
         update.groupId[sizeof(update.groupId) - 1] = '\0';
 
-        geofenceUpdateCallback(update);
+        dispatchGeofenceUpdate(update);
         LOG_I("✅ Geocerca circular actualizada");
     }
     else
@@ -1332,7 +1590,7 @@ void RadioManager::parsePolygonGeofence(const uint8_t *data, size_t length)
     LOG_I("🔷 GEOCERCA POLÍGONO: %d puntos", numPoints);
 
     // Extraer puntos del polígono
-    GeoPoint points[10];
+    GeoPoint *points = decodedVertices;
     size_t dataIndex = 2;
 
     for (uint8_t i = 0; i < numPoints; i++)
@@ -1362,18 +1620,17 @@ void RadioManager::parsePolygonGeofence(const uint8_t *data, size_t length)
     if (geofenceUpdateCallback)
     {
         GeofenceUpdate update;
-        update.type = 1; // Polígono
+        update.type = GEOFENCE_CMD_POLYGON;
         update.pointCount = numPoints;
+        update.points = points;
         update.centerLat = 0.0;
         update.centerLng = 0.0;
         update.radius = 0.0f;
 
-        // Copiar puntos y calcular centro aproximado
+        // Calcular centro aproximado
         double sumLat = 0.0, sumLng = 0.0;
         for (uint8_t i = 0; i < numPoints; i++)
         {
-            update.points[i].lat = points[i].lat;
-            update.points[i].lng = points[i].lng;
             sumLat += points[i].lat;
             sumLng += points[i].lng;
         }
@@ -1385,7 +1642,7 @@ void RadioManager::parsePolygonGeofence(const uint8_t *data, size_t length)
         update.name[sizeof(update.name) - 1] = '\0';
         update.groupId[sizeof(update.groupId) - 1] = '\0';
 
-        geofenceUpdateCallback(update);
+        dispatchGeofenceUpdate(update);
         LOG_I("✅ Geocerca poligonal actualizada");
     }
     else
@@ -1436,7 +1693,7 @@ void RadioManager::parseCompressedPolygonGeofence(const uint8_t *data, size_t le
     const float LNG_SCALE_FACTOR = 93000.0f;  // metros por grado de longitud (Chile)
 
     // Extraer y descomprimir puntos del polígono
-    GeoPoint points[10];
+    GeoPoint *points = decodedVertices;
     size_t dataIndex = 10; // Comenzar después del header
 
     for (uint8_t i = 0; i < numPoints; i++)
@@ -1475,16 +1732,15 @@ void RadioManager::parseCompressedPolygonGeofence(const uint8_t *data, size_t le
     if (geofenceUpdateCallback)
     {
         GeofenceUpdate update;
-        update.type = 2; // Polígono comprimido (puedes usar 1 si quieres tratarlo igual que polígono normal)
+        update.type = GEOFENCE_CMD_POLYGON_COMPRESSED;
         update.pointCount = numPoints;
+        update.points = points;
         update.radius = 0.0f;
 
-        // Copiar puntos y calcular centro
+        // Calcular centro
         double sumLat = 0.0, sumLng = 0.0;
         for (uint8_t i = 0; i < numPoints; i++)
         {
-            update.points[i].lat = points[i].lat;
-            update.points[i].lng = points[i].lng;
             sumLat += points[i].lat;
             sumLng += points[i].lng;
         }
@@ -1498,7 +1754,7 @@ void RadioManager::parseCompressedPolygonGeofence(const uint8_t *data, size_t le
         update.name[sizeof(update.name) - 1] = '\0';
         update.groupId[sizeof(update.groupId) - 1] = '\0';
 
-        geofenceUpdateCallback(update);
+        dispatchGeofenceUpdate(update);
         LOG_I("✅ Geocerca poligonal comprimida actualizada");
 
         // Log de verificación de la descompresión
@@ -1513,6 +1769,222 @@ void RadioManager::parseCompressedPolygonGeofence(const uint8_t *data, size_t le
         LOG_W("⚠️ Callback de geocerca no configurado");
     }
 }
+// Polígono grande, normalmente reensamblado desde fragmentos
+void RadioManager::parseLargePolygonGeofence(const uint8_t *data, size_t length)
+{
+    // Formato: [tipo(1)][numPuntos(2)][lat1(4)][lng1(4)]...[groupId(N)]
+    if (length < 3)
+    {
+        LOG_W("📡 Comando de polígono grande muy corto: %d bytes", length);
+        return;
+    }
+
+    uint16_t numPoints = data[1] | (data[2] << 8);
+
+    if (numPoints < 3 || numPoints > GEOFENCE_MAX_VERTICES)
+    {
+        LOG_W("⚠️ Número de puntos inválido en polígono grande: %d", numPoints);
+        return;
+    }
+
+    size_t expectedLength = 3 + (numPoints * 8);
+    if (length < expectedLength)
+    {
+        LOG_W("📡 Polígono grande incompleto: %d bytes, esperado %d", length, expectedLength);
+        return;
+    }
+
+    LOG_I("🔷 GEOCERCA POLÍGONO GRANDE: %d puntos", numPoints);
+
+    double sumLat = 0.0, sumLng = 0.0;
+    size_t dataIndex = 3;
+    for (uint16_t i = 0; i < numPoints; i++)
+    {
+        float lat, lng;
+        memcpy(&lat, &data[dataIndex], 4);
+        memcpy(&lng, &data[dataIndex + 4], 4);
+        decodedVertices[i] = GeoPoint(lat, lng);
+        sumLat += lat;
+        sumLng += lng;
+        dataIndex += 8;
+    }
+
+    char groupId[16] = "backend";
+    if (length > expectedLength)
+    {
+        size_t groupIdLen = min((size_t)15, length - expectedLength);
+        memcpy(groupId, &data[expectedLength], groupIdLen);
+        groupId[groupIdLen] = '\0';
+    }
+
+    LOG_I("  Grupo: %s", groupId);
+
+    if (geofenceUpdateCallback)
+    {
+        GeofenceUpdate update;
+        update.type = GEOFENCE_CMD_POLYGON_LARGE;
+        update.pointCount = numPoints;
+        update.points = decodedVertices;
+        update.centerLat = sumLat / numPoints;
+        update.centerLng = sumLng / numPoints;
+        update.radius = 0.0f;
+
+        strncpy(update.name, "LargePolygon", sizeof(update.name) - 1);
+        strncpy(update.groupId, groupId, sizeof(update.groupId) - 1);
+        update.name[sizeof(update.name) - 1] = '\0';
+        update.groupId[sizeof(update.groupId) - 1] = '\0';
+
+        dispatchGeofenceUpdate(update);
+        LOG_I("✅ Geocerca poligonal grande actualizada");
+    }
+    else
+    {
+        LOG_W("⚠️ Callback de geocerca no configurado");
+    }
+}
+
+// Polígono compacto: referencia int32 y deltas varint en metros
+void RadioManager::parseVarintPolygonGeofence(const uint8_t *data, size_t length)
+{
+    uint16_t numPoints = 0;
+    size_t consumed = 0;
+
+    if (!PolygonCodec::decode(data, length, decodedVertices, GEOFENCE_MAX_VERTICES, &numPoints, &consumed))
+    {
+        LOG_W("📡 Polígono compacto inválido o truncado: %d bytes", length);
+        return;
+    }
+
+    LOG_I("🔷 GEOCERCA POLÍGONO COMPACTO: %d puntos, resolución %d cm (%d bytes)",
+          numPoints, data[9], consumed);
+
+    double sumLat = 0.0, sumLng = 0.0;
+    for (uint16_t i = 0; i < numPoints; i++)
+    {
+        sumLat += decodedVertices[i].lat;
+        sumLng += decodedVertices[i].lng;
+    }
+
+    char groupId[16] = "backend";
+    if (length > consumed)
+    {
+        size_t groupIdLen = min((size_t)15, length - consumed);
+        memcpy(groupId, &data[consumed], groupIdLen);
+        groupId[groupIdLen] = '\0';
+    }
+
+    LOG_I("  Grupo: %s", groupId);
+
+    if (geofenceUpdateCallback)
+    {
+        GeofenceUpdate update;
+        update.type = GEOFENCE_CMD_POLYGON_VARINT;
+        update.pointCount = numPoints;
+        update.points = decodedVertices;
+        update.centerLat = sumLat / numPoints;
+        update.centerLng = sumLng / numPoints;
+        update.radius = 0.0f;
+
+        strncpy(update.name, "Polygon", sizeof(update.name) - 1);
+        strncpy(update.groupId, groupId, sizeof(update.groupId) - 1);
+        update.name[sizeof(update.name) - 1] = '\0';
+        update.groupId[sizeof(update.groupId) - 1] = '\0';
+
+        dispatchGeofenceUpdate(update);
+        LOG_I("✅ Geocerca poligonal compacta actualizada");
+    }
+    else
+    {
+        LOG_W("⚠️ Callback de geocerca no configurado");
+    }
+}
+
+// Fragmento de un comando de geocerca que no cabe en un solo downlink
+void RadioManager::parseGeofenceFragment(const uint8_t *data, size_t length)
+{
+    FragmentAssembler::Status status = geofenceFragments.accept(data, length, millis());
+
+    switch (status)
+    {
+    case FragmentAssembler::FRAGMENT_ACCEPTED:
+        LOG_I("🧩 Fragmento de geocerca %d/%d (v%d)",
+              geofenceFragments.getReceivedCount(), geofenceFragments.getExpectedCount(),
+              geofenceFragments.getVersion());
+        break;
+    case FragmentAssembler::FRAGMENT_DUPLICATE:
+        LOG_D("🧩 Fragmento duplicado ignorado");
+        break;
+    case FragmentAssembler::FRAGMENT_INVALID:
+        LOG_W("⚠️ Fragmento de geocerca inválido: %d bytes", length);
+        break;
+    case FragmentAssembler::FRAGMENT_CRC_ERROR:
+        LOG_W("⚠️ Geocerca fragmentada descartada: CRC incorrecto");
+        break;
+    case FragmentAssembler::FRAGMENT_COMPLETE:
+    {
+        const uint8_t *payload = geofenceFragments.getPayload();
+        size_t payloadLength = geofenceFragments.getPayloadLength();
+        LOG_I("🧩 Geocerca reensamblada: %d bytes (v%d)", payloadLength, geofenceFragments.getVersion());
+
+        // Un fragmento no puede contener otro fragmento
+        if (payload[0] == GEOFENCE_CMD_FRAGMENT)
+        {
+            LOG_W("⚠️ Payload reensamblado inválido");
+            break;
+        }
+        parseGeofenceCommand(payload, payloadLength);
+        break;
+    }
+    }
+}
+
+// Geocerca completa con identidad: [0x05][fenceId(2)][versión(1)][comando completo]
+void RadioManager::parseIdentifiedGeofence(const uint8_t *data, size_t length)
+{
+    if (length < 5)
+    {
+        LOG_W("📡 Geocerca identificada muy corta: %d bytes", length);
+        return;
+    }
+
+    // Solo envuelve geocercas completas (sin anidar identidades, fragmentos ni deltas)
+    if (data[4] > GEOFENCE_CMD_POLYGON_VARINT)
+    {
+        LOG_W("⚠️ Comando identificado inválido: 0x%02X", data[4]);
+        return;
+    }
+
+    pendingFenceId = data[1] | (data[2] << 8);
+    pendingFenceVersion = data[3];
+    LOG_I("🆔 Geocerca #%d v%d", pendingFenceId, pendingFenceVersion);
+
+    parseGeofenceCommand(&data[4], length - 4);
+
+    pendingFenceId = 0;
+    pendingFenceVersion = 0;
+}
+
+// Edición incremental: la valida y aplica GeofenceManager contra la geocerca activa
+void RadioManager::parseGeofenceDelta(const uint8_t *data, size_t length)
+{
+    if (length < GeofenceDelta::HEADER_SIZE)
+    {
+        LOG_W("📡 Delta de geocerca muy corto: %d bytes", length);
+        return;
+    }
+
+    LOG_I("✏️ Delta de geocerca #%d v%d -> v%d (%d bytes)",
+          data[1] | (data[2] << 8), data[3], data[4], length);
+
+    if (geofenceDeltaCallback)
+    {
+        geofenceDeltaCallback(data, length);
+    }
+    else
+    {
+        LOG_W("⚠️ Callback de delta de geocerca no configurado");
+    }
+}
 // ============================================================================
 // GESTIÓN DE ERRORES
 // ============================================================================
@@ -4,6 +4,11 @@
 #include "../config/constants.h"
 #include "../config/lorawan_config.h"
 #include "../core/Types.h"
+#include "../system/SessionStore.h"
+#include "../system/FragmentAssembler.h"
+#include "../system/LinkQuality.h"
+#include "../system/EnergyModel.h"
+#include "../system/Rtos.h"
 #include <RadioLib.h>
 #ifdef USE_PREFERENCES
 #include <Preferences.h> // Para persistencia de DevNonce y Frame Counters
@@ -11,6 +16,8 @@
 
 // La estructura GeofenceUpdate ya está definida en lorawan_config.h
 typedef void (*GeofenceUpdateCallback)(const GeofenceUpdate &update);
+// Payload GEOFENCE_CMD_DELTA completo; lo aplica GeofenceManager::applyDelta
+typedef void (*GeofenceDeltaCallback)(const uint8_t *data, size_t length);
 
 // Constantes adicionales
 #ifndef SPI_FREQUENCY
@@ -65,18 +72,24 @@ public:
 
     // LoRaWAN (ABP/OTAA)
     Result setupLoRaWAN();
-    Result joinOTAA(const uint8_t *devEUI, const uint8_t *appEUI, const uint8_t *appKey);
+    // retainedNonces/retainedSession: buffers retenidos en RTC (despertar de
+    // deep sleep); tienen prioridad sobre la sesión de NVS
+    Result joinOTAA(const uint8_t *devEUI, const uint8_t *appEUI, const uint8_t *appKey,
+                    const uint8_t *retainedNonces = nullptr, const uint8_t *retainedSession = nullptr);
     Result joinABP(const uint8_t *devAddr, const uint8_t *nwkSKey, const uint8_t *appSKey);
     bool isJoined() const;
     bool isSessionRestored() const;
+    // Copia los buffers de sesión de RadioLib (para retenerlos en RTC)
+    bool exportSession(uint8_t *nonces, uint8_t *session);
     Result forceRejoin();
 
     // Transmisión de datos
     Result sendPacket(const uint8_t *data, size_t length, uint8_t port = 1);
     void handleDownlink();
-    Result sendString(const String &message, uint8_t port = 1);
+    Result sendString(const char *message, uint8_t port = 1);
     Result sendPosition(const Position &position, AlertLevel alertLevel = AlertLevel::SAFE);
     Result sendBatteryStatus(const BatteryStatus &battery);
+    Result sendLinkStatus(); // Resumen de LinkQuality en LORAWAN_PORT_STATUS
 
     // Recepción de datos (downlinks)
     Result receivePacket(uint8_t *buffer, size_t *length, uint8_t *port = nullptr);
@@ -87,8 +100,10 @@ public:
     uint16_t getPacketsSent() const;
     uint16_t getPacketsReceived() const;
     uint16_t getPacketsLost() const;
-    float getRSSI() const;
+    float getTxAirtimeMs() const; // Acumulado de todos los intentos de uplink, reintentos incluidos
+    float getRSSI() const; // Del último downlink recibido
     float getSNR() const;
+    LinkQuality getLinkQuality() const; // Copia: la tarea de radio la sigue actualizando
 
     // Configuración avanzada
     void setDataRate(uint8_t dataRate);
@@ -107,6 +122,7 @@ public:
 
     // 🔥 NUEVO: Callback para actualizaciones de geocerca
     void setGeofenceUpdateCallback(GeofenceUpdateCallback callback);
+    void setGeofenceDeltaCallback(GeofenceDeltaCallback callback);
 
     // Estados del radio
     enum RadioState
@@ -143,8 +159,11 @@ private:
     uint16_t packetsSent;
     uint16_t packetsReceived;
     uint16_t packetsLost;
+    float txAirtimeMs;
     float lastRSSI;
     float lastSNR;
+    LinkQuality linkQuality;
+    mutable RtosMutex linkMutex; // linkQuality: se escribe en la tarea de radio y se lee desde la UI
 
     // NUEVO: Contadores de frame para verificación
     uint16_t uplinkFrameCounter;
@@ -169,6 +188,7 @@ private:
 
     // 🔥 NUEVO: Callback estático para actualizaciones de geocerca
     static GeofenceUpdateCallback geofenceUpdateCallback;
+    static GeofenceDeltaCallback geofenceDeltaCallback;
 
     // Variables para manejo de downlinks
     bool pendingDownlink;
@@ -208,18 +228,47 @@ private:
     void parseCircleGeofence(const uint8_t *data, size_t length);
     void parsePolygonGeofence(const uint8_t *data, size_t length);
     void parseCompressedPolygonGeofence(const uint8_t *data, size_t length);
+    void parseLargePolygonGeofence(const uint8_t *data, size_t length);
+    void parseVarintPolygonGeofence(const uint8_t *data, size_t length);
+    void parseGeofenceFragment(const uint8_t *data, size_t length);
+    void parseIdentifiedGeofence(const uint8_t *data, size_t length);
+    void parseGeofenceDelta(const uint8_t *data, size_t length);
+    void dispatchGeofenceUpdate(GeofenceUpdate &update);
 
     // Gestión de errores
     void handleRadioError(int16_t errorCode);
     const char *getErrorString(int16_t errorCode);
 
-    // Nuevos métodos para persistencia de sesión
-    bool savePersistentSession();
+    // Persistencia de sesión (escrituras incrementales vía SessionStore)
+    enum SaveMode
+    {
+        SAVE_UPLINK,     // Tras cada uplink: el store decide si escribe
+        SAVE_FORCE,      // Downlinks (comandos MAC): escribir lo pendiente ya
+        SAVE_NEW_SESSION // JOIN: escribir todo y reiniciar el log de FCnt
+    };
+    bool savePersistentSession(SaveMode mode = SAVE_FORCE);
     bool loadPersistentSession();
+    bool loadRetainedSession(const uint8_t *nonces, const uint8_t *session);
     void clearPersistentSession();
+    bool migrateLegacySession();
+
+    // Acceso al FCnt dentro del buffer de sesión de RadioLib
+    static uint32_t readSessionFrameCounter(const uint8_t *session);
+    static void patchSessionFrameCounter(uint8_t *session, uint32_t frameCounter);
+
+    NvsSessionBackend sessionBackend;
+    SessionStore sessionStore;
 
     // Variables para tracking de sesión
     bool sessionRestored;
+
+    // Reensamblado de geocercas fragmentadas y vértices decodificados
+    FragmentAssembler geofenceFragments;
+    GeoPoint decodedVertices[GEOFENCE_MAX_VERTICES];
+
+    // Identidad del GEOFENCE_CMD_IDENTIFIED que se está decodificando
+    uint16_t pendingFenceId;
+    uint8_t pendingFenceVersion;
 };
 
 // ============================================================================
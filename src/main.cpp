@@ -13,6 +13,9 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <Preferences.h>
+#include <atomic>
+#include <driver/gpio.h>
+#include <esp_sleep.h>
 
 // ============================================================================
 // CONFIGURACIÓN DE PINES (HELTEC V3) - TEMPORAL HASTA QUE CARGUEN LOS HEADERS
@@ -61,6 +64,14 @@
 // System managers
 #include "system/GeofenceManager.h"
 #include "system/AlertManager.h"
+#include "system/ApproachPredictor.h"
+#include "system/Scheduler.h"
+#include "system/Runtime.h"
+#include "system/SleepCycle.h"
+#include "system/BootProfiler.h"
+#include "system/Profiler.h"
+#include "system/TraceLog.h"
+#include "system/EnergyLedger.h"
 
 // ============================================================================
 // INSTANCIAS GLOBALES
@@ -72,6 +83,39 @@ GPSManager gpsManager;
 RadioManager radioManager;
 GeofenceManager geofenceManager;
 AlertManager alertManager(buzzerManager, displayManager);
+AdaptiveStimulusPolicy adaptivePolicy; // Aprende los tiempos de respuesta de este animal
+ApproachPredictor approachPredictor;   // Solo en la tarea de geocerca
+
+static uint32_t schedulerClock()
+{
+    return millis();
+}
+Scheduler scheduler(schedulerClock); // Solo la usa la tarea UI
+
+static uint32_t bootClock()
+{
+    return micros();
+}
+BootProfiler bootProfiler(bootClock);
+
+static uint32_t traceClock()
+{
+    return millis();
+}
+
+// Etapas del Runtime implementadas sobre los managers (definidas más abajo)
+class CollarHandlers : public Runtime::Handlers
+{
+public:
+    bool pollGps(Position &position) override;
+    AlertLevel evaluate(const Position &position, float &distance) override;
+    void handleRadio(const Runtime::RadioRequest &request) override;
+    uint32_t runUi() override;
+    void onUiEvent(const Runtime::UiEvent &event) override;
+};
+
+CollarHandlers collarHandlers;
+Runtime runtime(collarHandlers);
 
 // ============================================================================
 // VARIABLES DE ESTADO
@@ -84,27 +128,77 @@ enum SystemState
     STATE_ERROR
 };
 
-SystemState systemState = SystemState::STATE_INIT;
+volatile SystemState systemState = SystemState::STATE_INIT;
 
-// Estructuras de datos
+// Estructuras de datos. currentPosition y la geocerca se comparten entre
+// tareas (GPS, geocerca, radio y UI): acceder con stateMutex tomado
+RtosMutex stateMutex;
 Position currentPosition;
 BatteryStatus batteryStatus;
 SystemStatus systemStatus;
 
-// Timers
-uint32_t lastGPSUpdate = 0;
-uint32_t lastBatteryCheck = 0;
-uint32_t lastDisplayUpdate = 0;
-uint32_t lastLoRaTransmit = 0;
-uint32_t lastHeartbeat = 0;
-uint32_t lastSerialStatus = 0;
-
-// Estados
-bool loraJoined = false;
-bool gpsHasFix = false;
-uint16_t packetCounter = 0;
+// Avisos de las demás tareas a la UI (LED y buzzer de confirmación)
+enum NotifyCode : uint8_t
+{
+    NOTIFY_GPS_FIX,
+    NOTIFY_UPLINK_SENT,
+    NOTIFY_GEOFENCE_UPDATED,
+    NOTIFY_GEOFENCE_EDITED,
+    NOTIFY_JOINED,
+    NOTIFY_RESTART,
+    NOTIFY_PLAY_PATTERN // requestedPattern
+};
+
+// Tareas del scheduler (IDs asignados en initScheduler)
+uint8_t taskJoin = Scheduler::INVALID_TASK;
+uint8_t taskLed = Scheduler::INVALID_TASK;
+uint8_t taskButton = Scheduler::INVALID_TASK;
+uint8_t taskRestart = Scheduler::INVALID_TASK;
+uint8_t taskDisplay = Scheduler::INVALID_TASK;
+
+// Parpadeo del LED sin bloquear: cambios de estado pendientes y su duración
+uint8_t ledTogglesLeft = 0;
+uint16_t ledToggleMs = 0;
+
+// Estados (escritos por la tarea de radio o GPS, leídos por la UI)
+volatile bool loraJoined = false;
+volatile bool gpsHasFix = false;
+volatile uint16_t packetCounter = 0;
 uint8_t currentScreen = 0;
-const uint8_t TOTAL_SCREENS = 4;
+const uint8_t TOTAL_SCREENS = 5;
+
+// Light sleep: cada ráfaga NMEA mantiene la CPU despierta hasta que el GPS
+// calla GPS_BURST_IDLE_MS (la UART no recibe mientras duerme)
+volatile uint32_t lastGpsByteTime = 0;
+std::atomic<bool> gpsBurstAwake(false);
+
+// Registro de energía: tiempo activo de cada subsistema, anotado desde todas
+// las tareas; su total alimenta también el conteo de carga de la batería
+EnergyLedger energyLedger;
+std::atomic<bool> radioActive(false);
+
+// Patrón del buzzer pedido por downlink (lo reproduce la tarea UI)
+std::atomic<uint8_t> requestedPattern(TonePatterns::PATTERN_NONE);
+bool buttonHeld = false; // Solo la tarea UI
+
+// Modo ciclo: estado retenido en RTC slow memory entre deep sleeps. Solo es
+// válido al despertar por timer o botón; cualquier otro reset lo descarta
+RTC_DATA_ATTR SleepCycle::Snapshot rtcSnapshot;
+SleepCycle sleepCycle(rtcSnapshot);
+bool retainedStateValid = false;
+bool retainedStateRestored = false; // resumeSleepCycle ya lo cargó
+uint8_t retainedNonces[RADIOLIB_LORAWAN_NONCES_BUF_SIZE];
+uint8_t retainedSession[RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
+bool retainedSessionValid = false; // Se consume en el primer JOIN
+
+// Bitácora de eventos: RTC slow memory sin inicializar, se conserva en
+// watchdog, pánico y brownout (ver TraceLog.h)
+RTC_NOINIT_ATTR TraceLog::Storage traceStorage;
+TraceLog traceLog(traceStorage, traceClock);
+
+// Arranque rápido (reinicio en caliente): display y buzzer se inicializan
+// la primera vez que hacen falta, sin splash ni melodía
+bool fastBoot = false;
 
 // Configuración de tiempos (ms) - ya definidos en constants.h
 
@@ -112,46 +206,143 @@ const uint8_t TOTAL_SCREENS = 4;
 // FUNCIONES DE UTILIDAD
 // ============================================================================
 
+void setSystemState(SystemState state)
+{
+    if (state != systemState)
+    {
+        traceLog.record(TraceLog::TRACE_STATE, state);
+    }
+    systemState = state;
+}
+
+// El parpadeo lo avanza la tarea "led"; un nuevo pedido reemplaza al anterior
 void blinkLED(uint8_t times, uint16_t delayMs = 100)
 {
-    for (uint8_t i = 0; i < times; i++)
+    if (times == 0)
+    {
+        return;
+    }
+    digitalWrite(LED_PIN, HIGH);
+    ledTogglesLeft = times * 2 - 1;
+    ledToggleMs = delayMs;
+    scheduler.schedule(taskLed, delayMs);
+}
+
+void ledTask(void *context)
+{
+    if (ledTogglesLeft == 0)
+    {
+        return;
+    }
+    ledTogglesLeft--;
+    digitalWrite(LED_PIN, (ledTogglesLeft % 2) ? HIGH : LOW);
+    if (ledTogglesLeft > 0)
     {
-        digitalWrite(LED_PIN, HIGH);
-        delay(delayMs);
-        digitalWrite(LED_PIN, LOW);
-        delay(delayMs);
+        scheduler.schedule(taskLed, ledToggleMs);
     }
 }
 
-void handleButton()
+// Inicialización bajo demanda tras un arranque rápido (init es idempotente)
+bool ensureBuzzer()
+{
+    return buzzerManager.init() == Result::SUCCESS;
+}
+
+bool ensureDisplay()
 {
-    static bool lastButtonState = HIGH;
-    static uint32_t lastDebounceTime = 0;
-    const uint32_t debounceDelay = 50;
+    return displayManager.isInitialized() || displayManager.init(false) == Result::SUCCESS;
+}
 
-    bool reading = digitalRead(PRG_BUTTON);
+// Pantalla bajo demanda: se apaga sola OLED_TIMEOUT_SLEEP después del
+// arranque o de la última pulsación
+void configureDisplaySleep()
+{
+#if DISPLAY_ON_DEMAND
+    displayManager.setAutoSleep(true, OLED_TIMEOUT_SLEEP);
+    displayManager.updateLastActivity();
+#endif
+}
 
-    if (reading != lastButtonState)
+// El antirrebote lo hace la tarea UI al recibir el evento. Con light sleep
+// la interrupción del pin queda por nivel (fuente de despertar), así que se
+// deshabilita hasta que la tarea del botón vea que se soltó
+void IRAM_ATTR onButtonInterrupt()
+{
+    if (runtime.postUiEventFromIsr(Runtime::UI_BUTTON))
     {
-        lastDebounceTime = millis();
+        gpio_intr_disable((gpio_num_t)PRG_BUTTON);
     }
+}
 
-    if ((millis() - lastDebounceTime) > debounceDelay)
+// Se ejecuta BUTTON_DEBOUNCE_MS después del flanco: si sigue presionado, es
+// válido. Mientras siga presionado se vuelve a revisar; al soltar rearma la ISR
+void buttonTask(void *context)
+{
+    if (digitalRead(PRG_BUTTON) == LOW)
     {
-        if (reading == LOW)
+        if (!buttonHeld)
         {
-            currentScreen = (currentScreen + 1) % TOTAL_SCREENS;
+            buttonHeld = true;
+            // Con la pantalla apagada (bajo demanda o tras un arranque rápido)
+            // la pulsación solo la enciende
+            bool wasInitialized = displayManager.isInitialized();
+            if (ensureDisplay())
+            {
+                if (!wasInitialized)
+                {
+                    configureDisplaySleep();
+                }
+                if (!displayManager.wake() && wasInitialized)
+                {
+                    currentScreen = (currentScreen + 1) % TOTAL_SCREENS;
+                }
+                scheduler.schedule(taskDisplay, 0);
+            }
             Serial.print(F("📺 Pantalla cambiada a: "));
             Serial.println(currentScreen);
-            buzzerManager.playTone(1200, 50, 60);
+            if (ensureBuzzer())
+            {
+                buzzerManager.playPattern(TonePatterns::PATTERN_BUTTON);
+            }
         }
+        scheduler.schedule(taskButton, BUTTON_DEBOUNCE_MS);
+        return;
+    }
+
+    buttonHeld = false;
+    gpio_intr_enable((gpio_num_t)PRG_BUTTON);
+}
+
+// Llega por la tarea de eventos de la UART del GPS, no desde una ISR
+void onGpsReceive()
+{
+    lastGpsByteTime = millis();
+    if (!gpsBurstAwake.exchange(true))
+    {
+        powerManager.holdAwake();
+        energyLedger.begin(EnergyLedger::CPU_AWAKE, lastGpsByteTime);
+    }
+}
+
+// Fin de la ráfaga NMEA: se puede volver a dormir
+void releaseGpsBurst()
+{
+    if (gpsBurstAwake && millis() - lastGpsByteTime > GPS_BURST_IDLE_MS && gpsBurstAwake.exchange(false))
+    {
+        energyLedger.end(EnergyLedger::CPU_AWAKE, millis());
+        powerManager.releaseAwake();
     }
+}
 
-    lastButtonState = reading;
+void restartTask(void *context)
+{
+    traceLog.record(TraceLog::TRACE_RESTART);
+    Logger::flush();
+    ESP.restart();
 }
 
 // ============================================================================
-// CALLBACK PARA GEOCERCA
+// CALLBACK PARA GEOCERCA (tarea de radio)
 // ============================================================================
 void onGeofenceUpdate(const GeofenceUpdate &update)
 {
@@ -167,7 +358,7 @@ void onGeofenceUpdate(const GeofenceUpdate &update)
     Serial.println(update.name);
 
     // GEOCERCA CIRCULAR
-    if (update.type == 0)
+    if (update.type == GEOFENCE_CMD_CIRCLE)
     {
         Serial.print(F("   • Tipo: CÍRCULO"));
         Serial.print(F("   • Centro: "));
@@ -178,50 +369,100 @@ void onGeofenceUpdate(const GeofenceUpdate &update)
         Serial.print(update.radius);
         Serial.println(F(" metros"));
 
+        RtosLock lock(stateMutex);
         geofenceManager.setGeofence(update.centerLat, update.centerLng,
-                                    update.radius, update.name);
+                                    update.radius, update.name, update.groupId,
+                                    update.fenceId, update.version);
     }
-    // GEOCERCA POLIGONAL SIN COMPRIMIR
-    else if (update.type == 1)
+    // GEOCERCA POLIGONAL (sin comprimir, comprimida o reensamblada desde fragmentos)
+    else if (update.points && update.pointCount >= 3)
     {
         Serial.print(F("   • Tipo: POLÍGONO"));
         Serial.print(F("   • Puntos: "));
         Serial.println(update.pointCount);
 
-        // Convertir estructura GeofenceUpdate a GeoPoint[]
-        GeoPoint points[10];
-        for (uint8_t i = 0; i < update.pointCount; i++)
+        for (uint16_t i = 0; i < update.pointCount && i < Geofence::MAX_POLYGON_POINTS; i++)
         {
-            points[i].lat = update.points[i].lat;
-            points[i].lng = update.points[i].lng;
             Serial.print(F("     P"));
             Serial.print(i);
             Serial.print(F(": "));
-            Serial.print(points[i].lat, 6);
+            Serial.print(update.points[i].lat, 6);
             Serial.print(F(", "));
-            Serial.println(points[i].lng, 6);
+            Serial.println(update.points[i].lng, 6);
         }
 
-        geofenceManager.setPolygonGeofence(points, update.pointCount,
-                                           update.name, update.groupId);
+        // GeofenceManager copia los vértices y hace el swap solo si son válidos
+        RtosLock lock(stateMutex);
+        geofenceManager.setPolygonGeofence(update.points, update.pointCount,
+                                           update.name, update.groupId,
+                                           update.fenceId, update.version);
+    }
+
+    traceLog.record(TraceLog::TRACE_GEOFENCE, update.version,
+                    update.type == GEOFENCE_CMD_CIRCLE ? 0 : update.pointCount);
+
+    // Feedback visual y sonoro
+    runtime.postNotify(NOTIFY_GEOFENCE_UPDATED);
+}
+
+void onGeofenceDelta(const uint8_t *data, size_t length)
+{
+    // Se aplica sobre la geocerca activa sin reiniciar estadísticas ni estado
+    Result result;
+    uint8_t version;
+    {
+        RtosLock lock(stateMutex);
+        result = geofenceManager.applyDelta(data, length);
+        version = geofenceManager.getFenceVersion();
+    }
+
+    if (result == Result::SUCCESS)
+    {
+        Serial.print(F("✏️ Geocerca editada: v"));
+        Serial.println(version);
+        runtime.postNotify(NOTIFY_GEOFENCE_EDITED);
+    }
+}
+
+// Todo downlink queda en la bitácora; el comando de sistema 0x04 [n] pide
+// subir los últimos n eventos (sin n, todo lo guardado). Los comandos de
+// alerta 0x04 [id] y 0x05 [nivel] [id] reproducen un patrón del buzzer y
+// cambian la cadencia de un nivel; 0x06 [m] [s] [s] fija la histéresis y
+// la permanencia para subir y bajar de nivel, y 0x07 [política] [s] [tope]
+// elige la política de estímulos (0 fija, 1 adaptativa), la escalada sin
+// respuesta en s (0 = deja la actual; si no, desde STIMULUS_MIN_ESCALATE_MS)
+// y el tope diario (0 = sin tope). El resto de la configuración se mantiene
+void onDownlink(const uint8_t *data, size_t length, uint8_t port)
+{
+    traceLog.record(TraceLog::TRACE_DOWNLINK, port, length);
+    if (port == 1 && length >= 1 && data[0] == 0x04)
+    {
+        traceLog.requestUpload(length > 1 ? data[1] : 0);
+    }
+    else if (port == 2 && length >= 2 && data[0] == 0x04)
+    {
+        requestedPattern = data[1];
+        runtime.postNotify(NOTIFY_PLAY_PATTERN);
     }
-    // POLÍGONO COMPRIMIDO - tratar igual que polígono normal
-    else if (update.type == 2)
+    else if (port == 2 && length >= 3 && data[0] == 0x05)
     {
-        GeoPoint points[10];
-        for (uint8_t i = 0; i < update.pointCount; i++)
+        buzzerManager.setAlertPattern(static_cast<AlertLevel>(data[1]), data[2]);
+    }
+    else if (port == 2 && length >= 4 && data[0] == 0x06)
+    {
+        alertManager.setFilterConfig(data[1], data[2] * 1000UL, data[3] * 1000UL);
+    }
+    else if (port == 2 && length >= 4 && data[0] == 0x07)
+    {
+        StimulusPolicy::Config config = alertManager.getStimulusConfig();
+        alertManager.setStimulusPolicy(data[1] ? &adaptivePolicy : nullptr);
+        if (data[2] > 0)
         {
-            points[i].lat = update.points[i].lat;
-            points[i].lng = update.points[i].lng;
+            config.escalateAfterMs = data[2] * 1000UL;
         }
-        geofenceManager.setPolygonGeofence(points, update.pointCount, update.name, update.groupId);
+        config.dailyCap = data[3];
+        alertManager.setStimulusConfig(config);
     }
-
-    // Feedback visual y sonoro
-    blinkLED(3, 200);
-    buzzerManager.playTone(1500, 100, 100);
-    delay(100);
-    buzzerManager.playTone(2000, 100, 100);
 }
 
 // ============================================================================
@@ -236,13 +477,20 @@ bool initHardware()
     pinMode(LED_PIN, OUTPUT);
     pinMode(PRG_BUTTON, INPUT_PULLUP);
     pinMode(VEXT_ENABLE, OUTPUT);
+    attachInterrupt(digitalPinToInterrupt(PRG_BUTTON), onButtonInterrupt, FALLING);
 
     // IMPORTANTE: Activar alimentación de periféricos (LOW = ON en Heltec V3)
     digitalWrite(VEXT_ENABLE, LOW); // LOW activa VEXT
+    energyLedger.begin(EnergyLedger::GPS, millis()); // El GPS queda encendido desde aquí
     digitalWrite(LED_PIN, LOW);
 
-    // Esperar a que se estabilice la alimentación
-    delay(500); // Aumentado para dar tiempo al display y GPS
+    // Esperar a que se estabilice la alimentación. En el arranque rápido
+    // nadie la necesita todavía: el GPS no se sondea y el display se
+    // inicializa recién cuando haga falta
+    if (!fastBoot)
+    {
+        delay(500); // Aumentado para dar tiempo al display y GPS
+    }
 
     LOG_I("   ✓ Pines configurados y VEXT activado");
 
@@ -251,7 +499,10 @@ bool initHardware()
     Wire.setClock(400000); // 400kHz para mejor velocidad
     LOG_I("   ✓ I2C inicializado");
 
-    delay(100); // Dar tiempo adicional
+    if (!fastBoot)
+    {
+        delay(100); // Dar tiempo adicional
+    }
     return true;
 }
 
@@ -271,32 +522,41 @@ bool initManagers()
         allOk = false;
     }
 
-    // Buzzer Manager
-    if (buzzerManager.init() == Result::SUCCESS)
+    // Buzzer y display: en el arranque rápido se inicializan bajo demanda
+    if (fastBoot)
     {
-        LOG_I("   ✓ Buzzer Manager OK");
-        buzzerManager.playTone(1000, 50, 50); // Beep de confirmación
+        LOG_I("   ⚡ Buzzer y display diferidos (arranque rápido)");
     }
     else
     {
-        LOG_E("   ✗ Buzzer Manager FALLÓ");
-        allOk = false;
-    }
+        // Buzzer Manager
+        if (buzzerManager.init() == Result::SUCCESS)
+        {
+            LOG_I("   ✓ Buzzer Manager OK");
+            buzzerManager.playPattern(TonePatterns::PATTERN_BOOT_CONFIRM);
+        }
+        else
+        {
+            LOG_E("   ✗ Buzzer Manager FALLÓ");
+            allOk = false;
+        }
 
-    // Display Manager
-    if (displayManager.init() == Result::SUCCESS)
-    {
-        LOG_I("   ✓ Display Manager OK");
-        displayManager.showSplashScreen();
-    }
-    else
-    {
-        LOG_E("   ✗ Display Manager FALLÓ");
-        allOk = false;
+        // Display Manager
+        if (displayManager.init() == Result::SUCCESS)
+        {
+            LOG_I("   ✓ Display Manager OK");
+            displayManager.showSplashScreen();
+            configureDisplaySleep();
+        }
+        else
+        {
+            LOG_E("   ✗ Display Manager FALLÓ");
+            allOk = false;
+        }
     }
 
-    // GPS Manager
-    if (gpsManager.init() == Result::SUCCESS)
+    // GPS Manager (ya respondía antes del reinicio: sin sondeo)
+    if (gpsManager.init(!fastBoot) == Result::SUCCESS)
     {
         LOG_I("   ✓ GPS Manager OK");
     }
@@ -313,8 +573,7 @@ bool initManagers()
         Geofence gf = geofenceManager.getGeofence();
         if (gf.isConfigured)
         {
-            LOG_I("     → Geocerca cargada: ");
-            LOG_I(gf.name);
+            LOG_I("     → Geocerca cargada: %s", gf.name);
         }
         else
         {
@@ -330,6 +589,13 @@ bool initManagers()
     // Alert Manager
     if (alertManager.init() == Result::SUCCESS)
     {
+#if STIMULUS_ADAPTIVE
+        // Tras un deep sleep la política ya vino del snapshot
+        if (!retainedStateRestored)
+        {
+            alertManager.setStimulusPolicy(&adaptivePolicy);
+        }
+#endif
         LOG_I("   ✓ Alert Manager OK");
     }
     else
@@ -348,6 +614,8 @@ bool initManagers()
         {
             LOG_I("   ✓ LoRaWAN configurado");
             radioManager.setGeofenceUpdateCallback(onGeofenceUpdate);
+            radioManager.setGeofenceDeltaCallback(onGeofenceDelta);
+            radioManager.setDownlinkCallback(onDownlink);
         }
         else
         {
@@ -368,94 +636,77 @@ bool initManagers()
 // FUNCIONES DE OPERACIÓN
 // ============================================================================
 
-void updateGPS()
-{
-    gpsManager.update();
-
-    if (gpsManager.hasValidFix())
-    {
-        if (!gpsHasFix)
-        {
-            LOG_I("🛰️ GPS FIX OBTENIDO!");
-            blinkLED(2, 100);
-        }
-        gpsHasFix = true;
-        currentPosition = gpsManager.getPosition();
-
-        // Log ocasional de posición
-        static uint32_t lastGPSLog = 0;
-        if (millis() - lastGPSLog > 30000)
-        {
-            LOG_I("📍 Posición: %.6f, %.6f | Sats: %d",
-                  currentPosition.latitude,
-                  currentPosition.longitude,
-                  gpsManager.getSatelliteCount());
-            lastGPSLog = millis();
-        }
-    }
-    else
-    {
-        if (gpsHasFix)
-        {
-            LOG_W("⚠️ GPS FIX PERDIDO");
-        }
-        gpsHasFix = false;
-
-        // Mostrar satélites visibles aunque no haya fix
-        static uint32_t lastSatLog = 0;
-        if (millis() - lastSatLog > 10000)
-        { // Log cada 10 segundos
-            uint8_t sats = gpsManager.getSatelliteCount();
-            if (sats > 0)
-            {
-                LOG_I("🛰️ Satélites visibles: ");
-                LOG_I("%d", sats);
-            }
-            lastSatLog = millis();
-        }
-    }
-}
-
-void sendLoRaPacket()
+// Uplink de posición (también lo arma el despertar del modo ciclo)
+void buildPositionPayload(Runtime::RadioRequest &request, const Position &position, bool insideGeofence)
 {
-    if (!loraJoined || !gpsHasFix)
-        return;
-
-    // Preparar payload
-    uint8_t payload[32];
-    size_t payloadLength = 0;
+    request.type = Runtime::RADIO_UPLINK;
+    request.port = LORAWAN_PORT_GPS;
 
     // Crear payload simplificado
+    uint8_t *payload = request.payload;
+
     // [0] = Tipo de mensaje (0x01 = posición)
     payload[0] = 0x01;
 
     // [1-4] = Latitud (float)
-    memcpy(&payload[1], &currentPosition.latitude, 4);
+    memcpy(&payload[1], &position.latitude, 4);
 
     // [5-8] = Longitud (float)
-    memcpy(&payload[5], &currentPosition.longitude, 4);
+    memcpy(&payload[5], &position.longitude, 4);
 
     // [9] = Batería (%)
     payload[9] = (uint8_t)batteryStatus.percentage;
 
     // [10] = Estado de alerta
-    Geofence gf = geofenceManager.getGeofence();
-    bool insideGeofence = geofenceManager.isInsideGeofence(currentPosition);
     payload[10] = insideGeofence ? 0x00 : 0x01;
 
     // [11] = Número de satélites
-    payload[11] = gpsManager.getSatelliteCount();
+    payload[11] = position.satellites;
+
+    // [12-13] = Autonomía estimada en horas (uint16 big-endian, como en la
+    // trama de batería; 0xFFFF = sin estimación)
+    payload[12] = (batteryStatus.remainingHours >> 8) & 0xFF;
+    payload[13] = batteryStatus.remainingHours & 0xFF;
+
+    request.length = 14;
+}
+
+// Tarea UI: arma el uplink de posición y lo encola para la tarea de radio
+void sendLoRaPacket()
+{
+    if (!loraJoined || !gpsHasFix)
+        return;
+
+    Position position;
+    bool insideGeofence;
+    {
+        RtosLock lock(stateMutex);
+        position = currentPosition;
+        insideGeofence = geofenceManager.isInsideGeofence(position);
+    }
 
-    payloadLength = 12;
+    Runtime::RadioRequest request = {};
+    buildPositionPayload(request, position, insideGeofence);
 
-    // Enviar
-    if (radioManager.sendPacket(payload, payloadLength, LORAWAN_PORT_GPS) == Result::SUCCESS)
+    // Si la radio sigue ocupada con peticiones anteriores, este uplink se pierde
+    if (!runtime.postRadio(request))
+    {
+        Serial.println(F("⚠️ Cola de radio llena, uplink descartado"));
+    }
+}
+
+// Tarea de radio: envío bloqueante (TX + ventanas RX1/RX2)
+void transmitUplink(const Runtime::RadioRequest &request)
+{
+    Result result = radioManager.sendPacket(request.payload, request.length, request.port);
+    traceLog.record(TraceLog::TRACE_UPLINK, request.port, (uint16_t)result);
+    if (result == Result::SUCCESS)
     {
         packetCounter++;
         Serial.print(F("📡 Uplink #"));
         Serial.print(packetCounter);
         Serial.println(F(" enviado"));
-        blinkLED(1, 50);
+        runtime.postNotify(NOTIFY_UPLINK_SENT);
     }
     else
     {
@@ -463,8 +714,24 @@ void sendLoRaPacket()
     }
 }
 
+// OLED y buzzer llevan su propio contador: se pasa al registro lo nuevo
+void accountEnergy()
+{
+    static uint32_t lastDisplay = 0, lastTone = 0;
+
+    uint32_t now = millis();
+    uint32_t display = displayManager.getOnTimeMs();
+    uint32_t tone = buzzerManager.getToneTimeMs();
+    energyLedger.add(EnergyLedger::DISPLAY, display - lastDisplay, now);
+    energyLedger.add(EnergyLedger::BUZZER, tone - lastTone, now);
+    lastDisplay = display;
+    lastTone = tone;
+}
+
 void updateDisplay()
 {
+    PROFILE_SCOPE("display");
+
     // Actualizar información del sistema
     systemStatus.buzzerInitialized = buzzerManager.isInitialized();
     systemStatus.displayInitialized = displayManager.isInitialized();
@@ -478,37 +745,90 @@ void updateDisplay()
     powerManager.readBattery();
     batteryStatus = powerManager.getBatteryStatus();
 
+    Position position;
+    {
+        RtosLock lock(stateMutex);
+        position = currentPosition;
+    }
+
     // Mostrar pantalla según selección
     switch (currentScreen)
     {
     case 0:
-        displayManager.showMainScreen(systemStatus, currentPosition, batteryStatus, alertManager.getCurrentLevel());
+        displayManager.showMainScreen(systemStatus, position, batteryStatus, alertManager.getCurrentLevel());
         break;
     case 1:
-        displayManager.showGPSDetailScreen(currentPosition);
+        displayManager.showGPSDetailScreen(position);
         break;
     case 2:
     {
+        // Se dibuja con el mutex tomado: la geocerca puede apuntar a vértices del manager
+        RtosLock lock(stateMutex);
         Geofence gf = geofenceManager.getGeofence();
-        float dist = geofenceManager.getDistance(currentPosition);
-        bool inside = geofenceManager.isInsideGeofence(currentPosition);
+        float dist = geofenceManager.getDistance(position);
+        bool inside = geofenceManager.isInsideGeofence(position);
         displayManager.showGeofenceInfoScreen(gf, dist, inside);
     }
     break;
     case 3:
     {
-        SystemStats stats;
-        stats.totalPacketsSent = packetCounter;
-        stats.successfulPackets = packetCounter; // Por ahora asumimos todos exitosos
-        stats.failedPackets = 0;
-        stats.lastRSSI = -80; // Placeholder
-        stats.lastSNR = 5.0;  // Placeholder
+        LinkQuality link = radioManager.getLinkQuality(); // Copia coherente: la radio sigue contando
+        SystemStats stats = {};
+        stats.totalPacketsSent = link.getUplinks();
+        stats.successfulPackets = link.getUplinks() - link.getFailures();
+        stats.failedPackets = link.getFailures();
+        stats.packetsLost = link.getFailures();
+        stats.geofenceViolations = geofenceManager.getViolationsCount();
+        stats.totalUptime = millis();
+        stats.totalPacketsReceived = link.getDownlinks();
+        stats.lastRSSI = link.hasDownlink() ? (int16_t)link.getLastRssi() : 0;
+        stats.lastSNR = link.hasDownlink() ? link.getLastSnr() : 0.0f;
         displayManager.showSystemStatsScreen(stats);
     }
     break;
+    case 4:
+        accountEnergy();
+        displayManager.showEnergyScreen(energyLedger.today(millis()));
+        break;
     }
 }
 
+void printSleepCycleStatus()
+{
+    const SleepCycle::Stats &stats = sleepCycle.getStats();
+    if (stats.cycles == 0)
+    {
+        return;
+    }
+    Serial.print(F("   • Modo ciclo: "));
+    Serial.print(stats.cycles);
+    Serial.print(F(" despertares, "));
+    Serial.print(stats.fixTimeouts);
+    Serial.println(F(" sin fix"));
+    Serial.print(F("     → Arranque→fix: "));
+    Serial.print(stats.fixes ? stats.totalBootToFixMs / stats.fixes : 0);
+    Serial.print(F(" ms medio, "));
+    Serial.print(stats.maxBootToFixMs);
+    Serial.println(F(" ms máx"));
+    Serial.print(F("     → Consumo medido: "));
+    Serial.print(sleepCycle.averageMahPerDay(), 1);
+    Serial.println(F(" mAh/día"));
+}
+
+#if ENABLE_PROFILER
+void printProfile()
+{
+    Serial.println(F("   • Perfil (desde el último uplink de depuración):"));
+    char line[112];
+    for (Profiler::Site *site = Profiler::first(); site; site = site->next)
+    {
+        Profiler::format(*site, line, sizeof(line));
+        Serial.print(F("     → "));
+        Serial.println(line);
+    }
+}
+#endif
+
 void printSerialStatus()
 {
     Serial.println(F("\n📊 ESTADO DEL SISTEMA:"));
@@ -542,19 +862,44 @@ void printSerialStatus()
     Serial.print(F("   • Uptime: "));
     Serial.print(millis() / 1000);
     Serial.println(F(" segundos"));
+    Serial.print(F("   • Arranque: "));
+    Serial.print(bootProfiler.totalUs() / 1000.0f, 1);
+    Serial.println(bootProfiler.isFastBoot() ? F(" ms (rápido)") : F(" ms (completo)"));
     Serial.print(F("   • Memoria libre: "));
     Serial.print(ESP.getFreeHeap());
     Serial.println(F(" bytes"));
-
-    Geofence gf = geofenceManager.getGeofence();
+#if ENABLE_ASYNC_LOG
+    Serial.print(F("   • Log: pico "));
+    Serial.print(Logger::getHighWater());
+    Serial.print(F("/"));
+    Serial.print(LOG_BUFFER_SLOTS);
+    Serial.print(F(" pendientes, "));
+    Serial.print(Logger::getDropped());
+    Serial.println(F(" descartados"));
+#endif
+    Serial.print(F("   • Bitácora: "));
+    Serial.print(traceLog.size());
+    Serial.print(F(" eventos (arranque #"));
+    Serial.print(traceLog.getBoot());
+    Serial.print(F("), "));
+    Serial.print(traceLog.pendingUpload());
+    Serial.println(F(" por subir"));
+
+    Geofence gf;
+    float dist;
+    bool inside;
+    {
+        RtosLock lock(stateMutex);
+        gf = geofenceManager.getGeofence();
+        dist = geofenceManager.getDistance(currentPosition);
+        inside = geofenceManager.isInsideGeofence(currentPosition);
+    }
     if (gf.isConfigured)
     {
         Serial.print(F("   • Geocerca: "));
         Serial.println(gf.name);
         if (gpsHasFix)
         {
-            float dist = geofenceManager.getDistance(currentPosition);
-            bool inside = geofenceManager.isInsideGeofence(currentPosition);
             Serial.print(F("     → Distancia: "));
             Serial.print(dist);
             Serial.println(F(" m"));
@@ -566,6 +911,10 @@ void printSerialStatus()
     {
         Serial.println(F("   • Geocerca: NO CONFIGURADA"));
     }
+    printSleepCycleStatus();
+#if ENABLE_PROFILER
+    printProfile();
+#endif
 }
 
 // ============================================================================
@@ -579,203 +928,906 @@ const uint8_t LORAWAN_APP_KEY[16] = {
     0xCD, 0x33, 0xC2, 0x37, 0x06, 0x27, 0x2E, 0x75};
 
 // ============================================================================
-// SETUP
+// MODO CICLO (DEEP SLEEP CON ESTADO EN RTC)
 // ============================================================================
-void setup()
-{
-    // Inicializar Serial primero. Lo mantenemos por LEGACY
-    Serial.begin(SERIAL_BAUD);
-
-    // Inicializar logger.
-    Logger::init(SERIAL_BAUD);
-
-    // Mostrar información del sistema
-    Logger::printSystemInfo();
 
-    // Inicializar hardware básico
-    if (!initHardware())
+// JOIN con los buffers retenidos en RTC si los hay: conserva el FCnt exacto
+Result joinLoRaWAN()
+{
+    Result result;
+    if (retainedSessionValid)
     {
-        Serial.println(F("❌ ERROR CRÍTICO: Hardware básico falló"));
-        systemState = STATE_ERROR;
-        return;
+        result = radioManager.joinOTAA(LORAWAN_DEV_EUI, LORAWAN_APP_EUI, LORAWAN_APP_KEY,
+                                       retainedNonces, retainedSession);
+        retainedSessionValid = false; // Un reintento ya no debe volver a un FCnt viejo
     }
-
-    // Inicializar managers
-    if (!initManagers())
+    else
     {
-        Serial.println(F("⚠️ ADVERTENCIA: Algunos managers fallaron"));
-        // Continuar de todos modos, algunos componentes pueden funcionar
+        result = radioManager.joinOTAA(LORAWAN_DEV_EUI, LORAWAN_APP_EUI, LORAWAN_APP_KEY);
     }
+    return result;
+}
 
-    // Melodía de inicio
-    if (buzzerManager.isInitialized())
+// Geocerca, sesión, estado de carga y política de estímulos del ciclo
+// anterior (la geocerca no se persiste en flash)
+void restoreRetainedState()
+{
+    static GeoPoint vertices[GEOFENCE_MAX_VERTICES];
+    Geofence fence;
+    if (sleepCycle.loadGeofence(fence, vertices, GEOFENCE_MAX_VERTICES))
     {
-        buzzerManager.playStartupMelody();
+        RtosLock lock(stateMutex);
+        if (fence.type == GeofenceType::POLYGON)
+        {
+            geofenceManager.setPolygonGeofence(vertices, fence.pointCount, fence.name, fence.groupId,
+                                               fence.fenceId, fence.version);
+        }
+        else
+        {
+            geofenceManager.setGeofence(fence.centerLat, fence.centerLng, fence.radius, fence.name,
+                                        fence.groupId, fence.fenceId, fence.version);
+        }
+        geofenceManager.activate(fence.active);
     }
 
-    // LED indica inicio exitoso
-    blinkLED(3, 200);
-
-    Serial.println(F("\n✅ SISTEMA INICIADO - ENTRANDO EN MODO OPERACIONAL\n"));
-    LOG_I("EL LOGGER ROBUSTO FUNCIONA!!!");
-    systemState = STATE_WAITING_JOIN;
-
-    // NUEVO  para persistir sesion: Verificar si ya tenemos sesión LoRaWAN válida
-    if (radioManager.isJoined())
+    retainedSessionValid = sleepCycle.loadSession(retainedNonces, sizeof(retainedNonces),
+                                                  retainedSession, sizeof(retainedSession));
+    BatteryEstimator::State battery;
+    if (sleepCycle.loadBattery(battery))
     {
-        Serial.println(F("🔄 Sesión LoRaWAN restaurada desde memoria"));
-        loraJoined = true;
-        systemState = STATE_OPERATIONAL;
-        blinkLED(2, 300); // LED diferente para sesión restaurada
+        powerManager.restoreEstimator(battery);
     }
-
-    // Inicializar timers
-    lastGPSUpdate = millis();
-    lastBatteryCheck = millis();
-    lastDisplayUpdate = millis();
-    lastLoRaTransmit = millis();
-    lastHeartbeat = millis();
-    lastSerialStatus = millis();
+    // Guardada para el despertar: el día sigue corriendo desde millis() = 0
+    bool adaptive;
+    StimulusPolicy::Config stimulusConfig;
+    StimulusPolicy::State stimulus;
+    if (sleepCycle.loadStimulus(adaptive, stimulusConfig, stimulus))
+    {
+        alertManager.setStimulusPolicy(adaptive ? &adaptivePolicy : nullptr);
+        alertManager.setStimulusConfig(stimulusConfig);
+        alertManager.restoreStimulusState(stimulus, 0);
+    }
+    retainedStateRestored = true;
+    LOG_I("🌙 Estado del modo ciclo restaurado (geocerca: %s, sesión: %s)",
+          fence.isConfigured ? "sí" : "no", retainedSessionValid ? "sí" : "no");
 }
 
-// ============================================================================
-// LOOP
-// ============================================================================
-void loop()
+/**
+ * Guarda geocerca, posición, sesión LoRaWAN y estado de carga en RTC y entra
+ * en deep sleep.
+ * No vuelve si todo va bien: el próximo arranque retoma en resumeSleepCycle()
+ */
+void enterSleepCycle(uint32_t sleepMs)
 {
-    uint32_t now = millis();
-
-    // Manejo de estado de error
-    if (systemState == STATE_ERROR)
     {
-        static uint32_t lastErrorBlink = 0;
-        if (now - lastErrorBlink > 1000)
-        {
-            digitalWrite(LED_PIN, !digitalRead(LED_PIN));
-            lastErrorBlink = now;
-        }
-        delay(10);
-        return;
+        RtosLock lock(stateMutex);
+        sleepCycle.storeGeofence(geofenceManager.getGeofence());
+        sleepCycle.storePosition(currentPosition);
     }
 
-    // Heartbeat LED
-    if (now - lastHeartbeat > HEARTBEAT_INTERVAL)
+    // Sin sesión no se puede transmitir al despertar sin un JOIN completo. En
+    // un despertar sin uplink la radio no se inicializó: la sesión retenida
+    // sigue siendo la última (mismo FCnt) y se conserva tal cual
+    bool sessionRetained = radioManager.isJoined()
+                               ? radioManager.exportSession(retainedNonces, retainedSession) &&
+                                     sleepCycle.storeSession(retainedNonces, sizeof(retainedNonces),
+                                                             retainedSession, sizeof(retainedSession))
+                               : sleepCycle.hasSession();
+    if (!sessionRetained)
     {
-        blinkLED(1, 50);
-        lastHeartbeat = now;
+        LOG_W("⚠️ Sin sesión LoRaWAN para retener, se sigue en modo normal");
+        return;
     }
 
-    // Join LoRaWAN si no está conectado
-    if (systemState == STATE_WAITING_JOIN && !loraJoined)
-    {
-        static uint32_t lastJoinAttempt = 0;
-        static uint8_t joinAttempts = 0;
-        const uint8_t MAX_JOIN_ATTEMPTS = 5;
-
-        if (now - lastJoinAttempt > 30000)
-        { // Intentar cada 30 segundos
-            joinAttempts++;
-            Serial.print(F("\n📡 Intento JOIN #"));
-            Serial.print(joinAttempts);
-            Serial.println(F(" LoRaWAN..."));
+    sleepCycle.recordSleep(sleepMs);
+    // El deep sleep se cuenta por adelantado: al despertar no hay lectura en
+    // reposo que corrija el estado de carga (el GPS ya está adquiriendo)
+    powerManager.addConsumption(sleepCycle.sleepMah(sleepMs), sleepMs);
+    sleepCycle.storeBattery(powerManager.getEstimator().getState());
+    // Lo aprendido del animal y el tope diario, tal como estarán al despertar
+    sleepCycle.storeStimulus(alertManager.getStimulusPolicy() == &adaptivePolicy, alertManager.getStimulusConfig(),
+                             alertManager.getStimulusState(millis() + sleepMs));
+    sleepCycle.seal();
+    traceLog.record(TraceLog::TRACE_SLEEP, 0, sleepMs / 1000);
+    LOG_I("🌙 Modo ciclo: deep sleep de %lu s (medido: %.1f mAh/día)",
+          sleepMs / 1000, sleepCycle.averageMahPerDay());
+
+    radioManager.sleep();
+    digitalWrite(VEXT_ENABLE, sleepCycle.getPolicy().gpsPoweredInSleep ? VEXT_ON_VALUE : !VEXT_ON_VALUE);
+    powerManager.prepareForDeepSleep((uint64_t)sleepMs * 1000ULL);
+}
 
-            if (radioManager.joinOTAA(LORAWAN_DEV_EUI, LORAWAN_APP_EUI, LORAWAN_APP_KEY) == Result::SUCCESS)
-            {
-                Serial.println(F("✅ JOIN EXITOSO!"));
-                loraJoined = true;
-                systemState = STATE_OPERATIONAL;
-                joinAttempts = 0; // Reset contador
-                blinkLED(5, 100);
-                if (buzzerManager.isInitialized())
-                {
-                    buzzerManager.playTone(2000, 200, 200);
-                }
-            }
-            else
-            {
-                Serial.print(F("❌ JOIN FALLÓ - Intento "));
-                Serial.print(joinAttempts);
-                Serial.print(F("/"));
-                Serial.println(MAX_JOIN_ATTEMPTS);
+/**
+ * Despertar por timer del modo ciclo: sin splash, melodía, esperas de VEXT
+ * ni JOIN. Toma una posición, envía el uplink si toca y, si el animal sigue
+ * bien dentro de la geocerca, vuelve a dormir sin crear las tareas.
+ * @return false para seguir con el arranque completo (sin fix, cerca del
+ *         borde, sin sesión o geocerca cambiada por downlink)
+ */
+bool resumeSleepCycle()
+{
+    const SleepCycle::Policy &policy = sleepCycle.getPolicy();
 
-                // Si hemos fallado muchas veces, limpiar todo y reiniciar
-                if (joinAttempts >= MAX_JOIN_ATTEMPTS)
-                {
-                    Serial.println(F("🔄 Demasiados fallos de JOIN, limpiando sesión y reiniciando..."));
-                    radioManager.forceRejoin();
-                    delay(2000);
-                    ESP.restart();
-                }
-            }
-            lastJoinAttempt = now;
+    Logger::init(SERIAL_BAUD);
+    powerManager.wakeFromDeepSleep();
+    pinMode(LED_PIN, OUTPUT);
+    pinMode(PRG_BUTTON, INPUT_PULLUP);
+    pinMode(VEXT_ENABLE, OUTPUT);
+    digitalWrite(VEXT_ENABLE, VEXT_ON_VALUE);
+
+    geofenceManager.init();
+    restoreRetainedState();
+    if (!geofenceManager.getGeofence().isConfigured || !retainedSessionValid)
+    {
+        return false;
+    }
+
+    // El GPS ya se configuró en el arranque en frío: sin sondeo
+    gpsManager.init(false);
+    Serial1.onReceive(onGpsReceive);
+    powerManager.enableLowPowerMode();
+
+    uint32_t fixAt = 0;
+    while (millis() < policy.fixTimeoutMs)
+    {
+        gpsManager.update();
+        releaseGpsBurst();
+        if (gpsManager.hasValidFix())
+        {
+            fixAt = millis();
+            break;
         }
+        delay(GPS_POLL_INTERVAL);
+    }
+    if (fixAt == 0)
+    {
+        sleepCycle.recordWake(0, millis(), 0, 0.0f);
+        LOG_W("⚠️ Modo ciclo: sin fix en %lu s, arranque completo", policy.fixTimeoutMs / 1000);
+        return false;
+    }
+
+    Position position = gpsManager.getPosition();
+    float distance = geofenceManager.getDistance(position);
+    AlertLevel level = geofenceManager.calculateAlertLevel(distance);
+    {
+        RtosLock lock(stateMutex);
+        currentPosition = position;
+        gpsHasFix = true;
     }
 
-    // Actualizar GPS
-    if (now - lastGPSUpdate > GPS_UPDATE_INTERVAL)
+    uint32_t sleepMs = sleepCycle.onFix(distance, level);
+    if (sleepMs == 0)
     {
-        updateGPS();
-        lastGPSUpdate = now;
+        sleepCycle.recordWake(fixAt, millis(), 0, 0.0f);
+        LOG_I("🌙 Modo ciclo: a %.1f m del borde, arranque completo", distance);
+        return false;
     }
 
-    // Verificar batería
-    if (now - lastBatteryCheck > BATTERY_CHECK_INTERVAL)
+    uint32_t radioMs = 0;
+    float airtimeMs = 0.0f;
+    if (sleepCycle.uplinkDue())
     {
+        uint32_t radioStart = millis();
+        uint16_t fenceId = geofenceManager.getFenceId();
+        uint8_t fenceVersion = geofenceManager.getFenceVersion();
+
+        if (radioManager.init() != Result::SUCCESS || radioManager.setupLoRaWAN() != Result::SUCCESS)
+        {
+            return false;
+        }
+        radioManager.setGeofenceUpdateCallback(onGeofenceUpdate);
+        radioManager.setGeofenceDeltaCallback(onGeofenceDelta);
+        radioManager.setDownlinkCallback(onDownlink);
+        if (joinLoRaWAN() != Result::SUCCESS)
+        {
+            return false;
+        }
+        loraJoined = true;
+
+        powerManager.init();
         powerManager.readBattery();
         batteryStatus = powerManager.getBatteryStatus();
 
-        if (batteryStatus.percentage < 20)
+        Runtime::RadioRequest request = {};
+        buildPositionPayload(request, position, distance <= 0.0f);
+        if (radioManager.sendPacket(request.payload, request.length, request.port) == Result::SUCCESS)
         {
-            Serial.println(F("⚠️ BATERÍA BAJA!"));
-            if (buzzerManager.isInitialized())
-            {
-                buzzerManager.playTone(500, 100, 100);
-            }
+            packetCounter++;
+            sleepCycle.uplinkSent();
+        }
+        airtimeMs = radioManager.getTxAirtimeMs(); // Primer uplink desde el arranque, reintentos incluidos
+        radioMs = millis() - radioStart;
+
+        // Un downlink cambió la geocerca: la decisión de dormir ya no vale
+        if (geofenceManager.getFenceId() != fenceId || geofenceManager.getFenceVersion() != fenceVersion)
+        {
+            sleepCycle.recordWake(fixAt, millis(), radioMs, airtimeMs);
+            return false;
+        }
+    }
+
+    sleepCycle.recordWake(fixAt, millis(), radioMs, airtimeMs);
+    const SleepCycle::Stats &stats = sleepCycle.getStats();
+    LOG_I("⏱️ Ciclo #%lu: arranque→fix %lu ms, despierto %lu ms, %.3f mAh",
+          stats.cycles, stats.lastBootToFixMs, stats.lastAwakeMs, stats.lastWakeMah);
+    powerManager.addConsumption(stats.lastWakeMah, stats.lastAwakeMs);
+
+    enterSleepCycle(sleepMs);
+    return false; // Solo si no se pudo retener la sesión
+}
+
+// ============================================================================
+// TAREAS DEL SCHEDULER (tarea UI)
+// ============================================================================
+
+void heartbeatTask(void *context)
+{
+    blinkLED(1, 50);
+}
+
+// Pide un intento de JOIN a la tarea de radio mientras no haya sesión
+void joinTask(void *context)
+{
+    if (systemState != STATE_WAITING_JOIN || loraJoined)
+    {
+        scheduler.setEnabled(taskJoin, false);
+        return;
+    }
+
+    Runtime::RadioRequest request = {};
+    request.type = Runtime::RADIO_JOIN;
+    runtime.postRadio(request);
+}
+
+// Carga consumida desde la lectura anterior según el registro de energía
+void countBatteryCharge()
+{
+    static uint32_t lastAt = 0;
+    static float lastMah = 0.0f;
+
+    accountEnergy();
+    uint32_t now = millis();
+    float total = energyLedger.totalMah(now);
+    powerManager.addConsumption(total - lastMah, now - lastAt);
+    lastAt = now;
+    lastMah = total;
+}
+
+void batteryTask(void *context)
+{
+    countBatteryCharge();
+
+    // En reposo (sin TX/RX, ráfaga NMEA ni buzzer) la lectura corrige el estado de carga
+    bool atRest = !radioActive && !gpsBurstAwake && !(buzzerManager.isInitialized() && buzzerManager.isPlaying());
+    powerManager.readBattery(atRest);
+    batteryStatus = powerManager.getBatteryStatus();
+
+    // En la bitácora solo la entrada a batería baja, no cada lectura
+    static bool lowRecorded = false;
+    if (batteryStatus.percentage < 20 && !lowRecorded)
+    {
+        traceLog.record(TraceLog::TRACE_BATTERY, batteryStatus.percentage, batteryStatus.voltage * 1000);
+    }
+    lowRecorded = batteryStatus.percentage < 20;
+
+    if (batteryStatus.percentage < 20)
+    {
+        Serial.println(F("⚠️ BATERÍA BAJA!"));
+        if (ensureBuzzer())
+        {
+            buzzerManager.playPattern(TonePatterns::PATTERN_BATTERY_LOW);
         }
-        lastBatteryCheck = now;
     }
+}
 
-    // Enviar datos por LoRa
-    if (systemState == STATE_OPERATIONAL && (now - lastLoRaTransmit > LORA_TX_INTERVAL))
+void loraTask(void *context)
+{
+    if (systemState == STATE_OPERATIONAL)
     {
         sendLoRaPacket();
-        lastLoRaTransmit = now;
     }
+}
 
-    // Actualizar display
-    if (now - lastDisplayUpdate > DISPLAY_UPDATE_INTERVAL)
+// Resumen de calidad del enlace para ubicar gateways y ajustar el DR
+void linkStatusTask(void *context)
+{
+    if (systemState == STATE_OPERATIONAL && loraJoined)
     {
-        updateDisplay();
-        lastDisplayUpdate = now;
+        Runtime::RadioRequest request = {};
+        request.type = Runtime::RADIO_LINK_STATUS;
+        runtime.postRadio(request);
     }
+}
 
-    // Imprimir estado en Serial
-    if (now - lastSerialStatus > SERIAL_STATUS_INTERVAL)
+// Mientras haya una subida de la bitácora pendiente, un trozo por vez
+void traceTask(void *context)
+{
+    if (systemState == STATE_OPERATIONAL && loraJoined && traceLog.isUploading())
     {
-        printSerialStatus();
-        lastSerialStatus = now;
+        Runtime::RadioRequest request = {};
+        request.type = Runtime::RADIO_TRACE;
+        runtime.postRadio(request);
     }
+}
 
-    // Manejar botón
-    handleButton();
+// Consumo por subsistema: el último día completo (o lo que va del primero)
+void energyTask(void *context)
+{
+    if (systemState == STATE_OPERATIONAL && loraJoined)
+    {
+        accountEnergy();
+        Runtime::RadioRequest request = {};
+        request.type = Runtime::RADIO_ENERGY;
+        runtime.postRadio(request);
+    }
+}
 
-    // Verificar distancia a geocerca si está configurada.
-    if (geofenceManager.getGeofence().isConfigured && gpsHasFix)
+#if ENABLE_PROFILER
+void profileTask(void *context)
+{
+    if (systemState == STATE_OPERATIONAL && loraJoined)
     {
-        // Inicializamos lastGeofenceCheck así, en vez de en 0, para asegurar la primera ejecución
-        static uint32_t lastGeofenceCheck = millis() - 10000;
+        Runtime::RadioRequest request = {};
+        request.type = Runtime::RADIO_PROFILE;
+        runtime.postRadio(request);
+    }
+}
+#endif
+
+void displayTask(void *context)
+{
+    // Apagada (o sin inicializar tras un arranque rápido): la tarea se
+    // deshabilita hasta la próxima pulsación, sin I2C ni dibujo
+    displayManager.update();
+    if (!displayManager.isInitialized() || !displayManager.isOn())
+    {
+        scheduler.setEnabled(taskDisplay, false);
+        return;
+    }
+    updateDisplay();
+}
+
+void serialStatusTask(void *context)
+{
+    printSerialStatus();
+}
+
+/**
+ * Registra los trabajos periódicos de la tarea UI. El jitter deja que los
+ * poco urgentes se adelanten y compartan el despertar de otro. GPS y
+ * geocerca tienen sus propias tareas en el Runtime.
+ */
+void initScheduler()
+{
+    scheduler.addTask("lora", loraTask, nullptr, LORA_TX_INTERVAL, 5000, Scheduler::PRIORITY_NORMAL);
+    scheduler.addTask("battery", batteryTask, nullptr, BATTERY_CHECK_INTERVAL, 10000, Scheduler::PRIORITY_LOW);
+    taskDisplay = scheduler.addTask("display", displayTask, nullptr, DISPLAY_UPDATE_INTERVAL, 1000, Scheduler::PRIORITY_LOW);
+    scheduler.addTask("serial", serialStatusTask, nullptr, SERIAL_STATUS_INTERVAL, 5000, Scheduler::PRIORITY_LOW);
+    scheduler.addTask("heartbeat", heartbeatTask, nullptr, HEARTBEAT_INTERVAL, 2000, Scheduler::PRIORITY_LOW);
+    scheduler.addTask("link", linkStatusTask, nullptr, LINK_STATUS_INTERVAL, 60000, Scheduler::PRIORITY_LOW);
+    scheduler.addTask("trace", traceTask, nullptr, TRACE_UPLOAD_INTERVAL, 60000, Scheduler::PRIORITY_LOW);
+    scheduler.addTask("energy", energyTask, nullptr, ENERGY_UPLINK_INTERVAL, 60000, Scheduler::PRIORITY_LOW);
+#if ENABLE_PROFILER
+    scheduler.addTask("profile", profileTask, nullptr, PROFILER_UPLINK_INTERVAL, 60000, Scheduler::PRIORITY_LOW);
+#endif
+    taskJoin = scheduler.addTask("join", joinTask, nullptr, JOIN_RETRY_INTERVAL, 0, Scheduler::PRIORITY_NORMAL);
+
+    // Tareas de un disparo, programadas bajo demanda
+    taskLed = scheduler.addTask("led", ledTask, nullptr, 0, 0, Scheduler::PRIORITY_HIGH);
+    taskButton = scheduler.addTask("button", buttonTask, nullptr, 0, 0, Scheduler::PRIORITY_HIGH);
+    taskRestart = scheduler.addTask("restart", restartTask, nullptr, 0, 0, Scheduler::PRIORITY_CRITICAL);
+}
+
+// ============================================================================
+// ETAPAS DEL RUNTIME
+// ============================================================================
+
+// Tarea GPS: una posición por GPS_UPDATE_INTERVAL y un aviso al perder el fix
+bool CollarHandlers::pollGps(Position &position)
+{
+    static uint32_t lastPublish = 0;
+    gpsManager.update();
+    releaseGpsBurst();
 
-        // Si han pasado más de 10 segundos desde el último check, volver a chequear distancia
-        if (now - lastGeofenceCheck > 10000)
+    if (gpsManager.hasValidFix())
+    {
+        bool firstFix = !gpsHasFix;
+        if (!firstFix && millis() - lastPublish < GPS_UPDATE_INTERVAL)
         {
-            LOG_D("⏰ Han pasado 10s. Ejecutando el update de la alerta con la distancia actual");
-            // Actualizamos el nivel de alerta en base a la distancia a la geocerca
-            float distance = geofenceManager.getDistance(currentPosition);
-            alertManager.update(distance);
-            lastGeofenceCheck = now;
+            return false;
         }
+        if (firstFix)
+        {
+            LOG_I("🛰️ GPS FIX OBTENIDO!");
+            traceLog.record(TraceLog::TRACE_GPS, 1, gpsManager.getSatelliteCount());
+            runtime.postNotify(NOTIFY_GPS_FIX);
+        }
+
+        position = gpsManager.getPosition();
+        {
+            RtosLock lock(stateMutex);
+            currentPosition = position;
+            gpsHasFix = true;
+        }
+        lastPublish = millis();
+
+        // Log ocasional de posición
+        static uint32_t lastGPSLog = 0;
+        if (millis() - lastGPSLog > 30000)
+        {
+            LOG_I("📍 Posición: %.6f, %.6f | Sats: %d",
+                  position.latitude,
+                  position.longitude,
+                  position.satellites);
+            lastGPSLog = millis();
+        }
+        return true;
     }
 
-    // Pequeño delay para no saturar el CPU
-    delay(10);
-}
\ No newline at end of file
+    // Mostrar satélites visibles aunque no haya fix
+    static uint32_t lastSatLog = 0;
+    if (millis() - lastSatLog > 10000)
+    { // Log cada 10 segundos
+        uint8_t sats = gpsManager.getSatelliteCount();
+        if (sats > 0)
+        {
+            LOG_I("🛰️ Satélites visibles: ");
+            LOG_I("%d", sats);
+        }
+        lastSatLog = millis();
+    }
+
+    if (!gpsHasFix)
+    {
+        return false;
+    }
+
+    LOG_W("⚠️ GPS FIX PERDIDO");
+    traceLog.record(TraceLog::TRACE_GPS, 0, gpsManager.getSatelliteCount());
+    {
+        RtosLock lock(stateMutex);
+        gpsHasFix = false;
+    }
+    position = Position(); // valid = false: la geocerca deja de reevaluar
+    return true;
+}
+
+// Tarea geocerca: prioridad más alta, nunca espera a la radio
+AlertLevel CollarHandlers::evaluate(const Position &position, float &distance)
+{
+    // Velocidad con las posiciones sucesivas (las reevaluaciones no cuentan)
+    approachPredictor.update(position.latitude, position.longitude, position.timestamp);
+
+    float outwardEast, outwardNorth;
+    {
+        RtosLock lock(stateMutex);
+        PROFILE_SCOPE("geofence");
+        if (!geofenceManager.getGeofence().isConfigured)
+        {
+            distance = 0.0f;
+            return alertManager.getCurrentLevel();
+        }
+        distance = geofenceManager.getDistance(position, outwardEast, outwardNorth);
+    }
+
+    // Actualizamos el nivel de alerta en base a la distancia a la geocerca y,
+    // si va derecho hacia el borde, al tiempo que le falta para cruzarlo
+    AlertLevel previousLevel = alertManager.getCurrentLevel();
+    alertManager.update(distance, approachPredictor.timeToCrossing(distance, outwardEast, outwardNorth));
+    if (alertManager.getCurrentLevel() != previousLevel)
+    {
+        float meters = distance > 32767.0f ? 32767.0f : (distance < -32768.0f ? -32768.0f : distance);
+        traceLog.record(TraceLog::TRACE_ALERT, (uint8_t)alertManager.getCurrentLevel(), (uint16_t)(int16_t)meters);
+    }
+
+#if ENABLE_DEEP_SLEEP_CYCLE
+    // Solo cuentan las posiciones nuevas, no las reevaluaciones de la última
+    static uint32_t lastFixTime = 0;
+    static bool sleepRequested = false;
+    if (loraJoined && !sleepRequested && position.timestamp != lastFixTime)
+    {
+        lastFixTime = position.timestamp;
+        uint32_t sleepMs = sleepCycle.onFix(distance, alertManager.getCurrentLevel());
+        if (sleepMs > 0)
+        {
+            Runtime::RadioRequest request = {};
+            request.type = Runtime::RADIO_DEEP_SLEEP;
+            memcpy(request.payload, &sleepMs, sizeof(sleepMs));
+            request.length = sizeof(sleepMs);
+            sleepRequested = runtime.postRadio(request);
+        }
+    }
+#endif
+    return alertManager.getCurrentLevel();
+}
+
+// Tarea de radio: próximo trozo de la bitácora; si el uplink falla se reintenta el mismo
+void sendTraceChunk()
+{
+    uint8_t payload[TRACE_CHUNK_SIZE];
+    uint8_t entries;
+    size_t length = traceLog.buildChunk(payload, sizeof(payload), entries);
+    if (length > 0 && radioManager.sendPacket(payload, length, LORAWAN_PORT_STATUS) == Result::SUCCESS)
+    {
+        traceLog.commitChunk(entries);
+        LOG_D("🧾 Bitácora: %d eventos enviados, %d pendientes", entries, traceLog.pendingUpload());
+    }
+}
+
+// Tarea de radio: uplink de consumo por subsistema
+void sendEnergy()
+{
+    uint8_t payload[EnergyLedger::SUMMARY_SIZE];
+    size_t length = energyLedger.buildSummary(payload, sizeof(payload), millis());
+    if (length > 0 && radioManager.sendPacket(payload, length, LORAWAN_PORT_STATUS) == Result::SUCCESS)
+    {
+        LOG_D("🔋 Consumo por subsistema enviado");
+    }
+}
+
+#if ENABLE_PROFILER
+// Tarea de radio: uplink de depuración; cada uplink cubre el intervalo desde el anterior
+void sendProfile()
+{
+    // En trozos que entran en DR0; solo se reinician los sitios enviados
+    uint8_t payload[PROFILER_CHUNK_SIZE];
+    Profiler::Site *cursor = Profiler::first();
+    while (cursor)
+    {
+        Profiler::Site *chunk = cursor;
+        size_t length = Profiler::buildSummary(payload, sizeof(payload), cursor);
+        if (cursor == chunk || radioManager.sendPacket(payload, length, LORAWAN_PORT_STATUS) != Result::SUCCESS)
+        {
+            break;
+        }
+        Profiler::reset(chunk, cursor);
+    }
+}
+#endif
+
+// Tarea de radio: intento de JOIN; tras MAX_JOIN_ATTEMPTS limpia la sesión y reinicia
+void joinNetwork()
+{
+    static uint8_t joinAttempts = 0;
+    const uint8_t MAX_JOIN_ATTEMPTS = 5;
+
+    if (loraJoined)
+    {
+        return;
+    }
+
+    joinAttempts++;
+    Serial.print(F("\n📡 Intento JOIN #"));
+    Serial.print(joinAttempts);
+    Serial.println(F(" LoRaWAN..."));
+
+    Result result = joinLoRaWAN();
+    traceLog.record(TraceLog::TRACE_JOIN, result == Result::SUCCESS, joinAttempts);
+    if (result == Result::SUCCESS)
+    {
+        Serial.println(F("✅ JOIN EXITOSO!"));
+        loraJoined = true;
+        setSystemState(STATE_OPERATIONAL);
+        joinAttempts = 0; // Reset contador
+        runtime.postNotify(NOTIFY_JOINED);
+        return;
+    }
+
+    Serial.print(F("❌ JOIN FALLÓ - Intento "));
+    Serial.print(joinAttempts);
+    Serial.print(F("/"));
+    Serial.println(MAX_JOIN_ATTEMPTS);
+
+    // Si hemos fallado muchas veces, limpiar todo y reiniciar (tras vaciar el Serial)
+    if (joinAttempts >= MAX_JOIN_ATTEMPTS)
+    {
+        Serial.println(F("🔄 Demasiados fallos de JOIN, limpiando sesión y reiniciando..."));
+        radioManager.forceRejoin();
+        runtime.postNotify(NOTIFY_RESTART);
+    }
+}
+
+void CollarHandlers::handleRadio(const Runtime::RadioRequest &request)
+{
+    // Sin light sleep durante el uplink: las ventanas RX1/RX2 se esperan con
+    // precisión de ms y el SX1262 ya está consumiendo más que la CPU
+    powerManager.holdAwake();
+    radioActive = true;
+    uint32_t start = millis();
+    energyLedger.begin(EnergyLedger::CPU_AWAKE, start);
+    // TX: lo que RadioManager transmitió en este pedido (trozos y reintentos
+    // incluidos). El resto cuenta como RX (cota: incluye la espera hasta RX1/RX2)
+    float txBefore = radioManager.getTxAirtimeMs();
+    uint32_t airtimeMs = 0;
+    switch (request.type)
+    {
+    case Runtime::RADIO_JOIN:
+        joinNetwork();
+        airtimeMs = EnergyModel::loraAirtimeMs(LORAWAN_SF, 125, 23); // Join-request
+        break;
+    case Runtime::RADIO_UPLINK:
+        transmitUplink(request);
+        break;
+    case Runtime::RADIO_LINK_STATUS:
+        radioManager.sendLinkStatus();
+        break;
+    case Runtime::RADIO_TRACE:
+        sendTraceChunk();
+        break;
+    case Runtime::RADIO_ENERGY:
+        sendEnergy();
+        break;
+#if ENABLE_PROFILER
+    case Runtime::RADIO_PROFILE:
+        sendProfile();
+        break;
+#endif
+    case Runtime::RADIO_DEEP_SLEEP:
+    {
+        uint32_t sleepMs;
+        memcpy(&sleepMs, request.payload, sizeof(sleepMs));
+        enterSleepCycle(sleepMs);
+    }
+    break;
+    }
+
+    airtimeMs += (uint32_t)(radioManager.getTxAirtimeMs() - txBefore);
+    uint32_t now = millis();
+    uint32_t elapsed = now - start;
+    airtimeMs = airtimeMs < elapsed ? airtimeMs : elapsed;
+    energyLedger.add(EnergyLedger::RADIO_TX, airtimeMs, now);
+    energyLedger.add(EnergyLedger::RADIO_RX, elapsed - airtimeMs, now);
+    energyLedger.end(EnergyLedger::CPU_AWAKE, now);
+    radioActive = false;
+    powerManager.releaseAwake();
+}
+
+// Tarea UI: trabajos periódicos del Scheduler
+uint32_t CollarHandlers::runUi()
+{
+    energyLedger.begin(EnergyLedger::CPU_AWAKE, millis());
+    scheduler.runDue();
+    energyLedger.end(EnergyLedger::CPU_AWAKE, millis());
+    return scheduler.timeUntilNext();
+}
+
+void CollarHandlers::onUiEvent(const Runtime::UiEvent &event)
+{
+    if (event.type == Runtime::UI_BUTTON)
+    {
+        // Confirmar el flanco tras el antirrebote
+        scheduler.schedule(taskButton, BUTTON_DEBOUNCE_MS);
+        return;
+    }
+    if (event.type != Runtime::UI_NOTIFY)
+    {
+        return; // UI_ALERT: la pantalla principal ya lee el nivel de AlertManager
+    }
+
+    // Feedback visual y sonoro de lo que hicieron las otras tareas
+    switch (event.code)
+    {
+    case NOTIFY_GPS_FIX:
+        blinkLED(2, 100);
+        break;
+    case NOTIFY_UPLINK_SENT:
+        blinkLED(1, 50);
+        break;
+    case NOTIFY_GEOFENCE_UPDATED:
+        blinkLED(3, 200);
+        if (ensureBuzzer())
+        {
+            buzzerManager.playPattern(TonePatterns::PATTERN_GEOFENCE_UPDATED);
+        }
+        break;
+    case NOTIFY_GEOFENCE_EDITED:
+        blinkLED(1, 200);
+        if (ensureBuzzer())
+        {
+            buzzerManager.playPattern(TonePatterns::PATTERN_GEOFENCE_EDITED);
+        }
+        break;
+    case NOTIFY_JOINED:
+        scheduler.setEnabled(taskJoin, false);
+        blinkLED(5, 100);
+        if (buzzerManager.isInitialized())
+        {
+            buzzerManager.playPattern(TonePatterns::PATTERN_JOINED);
+        }
+        break;
+    case NOTIFY_RESTART:
+        scheduler.setEnabled(taskJoin, false);
+        scheduler.schedule(taskRestart, 2000);
+        break;
+    case NOTIFY_PLAY_PATTERN:
+        if (ensureBuzzer())
+        {
+            buzzerManager.playPattern(requestedPattern);
+        }
+        break;
+    }
+}
+
+// ============================================================================
+// SETUP
+// ============================================================================
+
+// Reinicios en caliente: los periféricos ya estaban configurados y alimentados
+// (o el GPS sigue con su configuración), nadie está mirando la pantalla
+bool isWarmReset(esp_reset_reason_t reason)
+{
+    switch (reason)
+    {
+    case ESP_RST_DEEPSLEEP:
+    case ESP_RST_SW:
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+        return true;
+    default:
+        return false; // Encendido, botón RST o brownout: arranque completo
+    }
+}
+
+// Resets que dejan algo que investigar: la bitácora se sube sola
+bool isCrashReset(esp_reset_reason_t reason)
+{
+    switch (reason)
+    {
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+    case ESP_RST_BROWNOUT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void printBootProfile()
+{
+    char summary[160];
+    bootProfiler.format(summary, sizeof(summary));
+    LOG_I("⏱️ Arranque %s: %s (antes de setup: %.1f ms)", bootProfiler.isFastBoot() ? "rápido" : "completo",
+          summary, bootProfiler.startUs() / 1000.0f);
+}
+
+void setup()
+{
+    fastBoot = ENABLE_FAST_BOOT && isWarmReset(esp_reset_reason());
+    bootProfiler.begin(fastBoot);
+
+    // Inicializar Serial primero. Lo mantenemos por LEGACY
+    Serial.begin(SERIAL_BAUD);
+
+    // Bitácora: cada arranque con su causa, salvo los despertares del modo ciclo
+    esp_sleep_wakeup_cause_t wakeCause = esp_sleep_get_wakeup_cause();
+    esp_reset_reason_t resetReason = esp_reset_reason();
+    bool traceRetained = traceLog.begin();
+    if (wakeCause != ESP_SLEEP_WAKEUP_TIMER)
+    {
+        traceLog.record(TraceLog::TRACE_BOOT, resetReason);
+    }
+    if (traceRetained && isCrashReset(resetReason))
+    {
+        traceLog.requestUpload(TRACE_CRASH_EVENTS);
+    }
+
+    // El estado del modo ciclo solo sobrevive a un deep sleep (timer o botón)
+    retainedStateValid = (wakeCause == ESP_SLEEP_WAKEUP_TIMER || wakeCause == ESP_SLEEP_WAKEUP_EXT0) &&
+                         sleepCycle.resume();
+    if (!retainedStateValid)
+    {
+        sleepCycle.reset();
+    }
+    else if (wakeCause == ESP_SLEEP_WAKEUP_TIMER && resumeSleepCycle())
+    {
+        return;
+    }
+
+    // Inicializar logger.
+    Logger::init(SERIAL_BAUD);
+
+    // Mostrar información del sistema
+    if (!fastBoot)
+    {
+        Logger::printSystemInfo();
+    }
+    bootProfiler.mark("logger");
+
+    // Inicializar hardware básico
+    if (!initHardware())
+    {
+        Serial.println(F("❌ ERROR CRÍTICO: Hardware básico falló"));
+        setSystemState(STATE_ERROR);
+        return;
+    }
+    bootProfiler.mark("hardware");
+
+    // Inicializar managers
+    if (!initManagers())
+    {
+        Serial.println(F("⚠️ ADVERTENCIA: Algunos managers fallaron"));
+        // Continuar de todos modos, algunos componentes pueden funcionar
+    }
+
+    // Geocerca y sesión del último ciclo (despertar con el botón o vuelta al
+    // modo normal). Si resumeSleepCycle ya los cargó no se vuelve al
+    // snapshot: un downlink pudo cambiar la geocerca y el JOIN consumir la sesión
+    if (retainedStateValid && !retainedStateRestored)
+    {
+        restoreRetainedState();
+    }
+    bootProfiler.mark("managers");
+
+    // Melodía de inicio (suena de fondo mientras sigue el arranque)
+    if (buzzerManager.isInitialized())
+    {
+        buzzerManager.playStartupMelody();
+    }
+
+    // Los periodos cuentan desde aquí, con los managers ya inicializados
+    initScheduler();
+
+    // DFS y light sleep automático: la CPU duerme cuando todas las tareas
+    // esperan (hasta el próximo deadline) o hasta UART del GPS, DIO1 o botón.
+    // El monitor USB-CDC se corta mientras duerme
+    Serial1.onReceive(onGpsReceive);
+    powerManager.enableLowPowerMode();
+    EnergyLedger::Config energy;
+    energy.lightSleep = powerManager.isLightSleepEnabled();
+    energy.cpuMhz = energy.lightSleep ? LOW_POWER_CPU_MHZ : 240;
+    energyLedger.setConfig(energy);
+#if ENABLE_PROFILER
+    Profiler::setTicksPerUs(getCpuFrequencyMhz()); // Frecuencia con trabajo (DFS al máximo)
+#endif
+    bootProfiler.mark("scheduler");
+
+    // LED indica inicio exitoso
+    blinkLED(3, 200);
+
+    Serial.println(F("\n✅ SISTEMA INICIADO - ENTRANDO EN MODO OPERACIONAL\n"));
+    LOG_I("EL LOGGER ROBUSTO FUNCIONA!!!");
+    setSystemState(STATE_WAITING_JOIN);
+
+    // NUEVO  para persistir sesion: Verificar si ya tenemos sesión LoRaWAN válida
+    if (radioManager.isJoined())
+    {
+        Serial.println(F("🔄 Sesión LoRaWAN restaurada desde memoria"));
+        loraJoined = true;
+        setSystemState(STATE_OPERATIONAL);
+        scheduler.setEnabled(taskJoin, false);
+        blinkLED(2, 300); // LED diferente para sesión restaurada
+    }
+
+    // A partir de aquí el Scheduler, el display y la radio pertenecen a sus tareas
+    if (!runtime.start())
+    {
+        Serial.println(F("❌ ERROR CRÍTICO: No se pudieron crear las tareas"));
+        setSystemState(STATE_ERROR);
+    }
+    bootProfiler.mark("runtime");
+    printBootProfile();
+
+    // Con las tareas ya creadas, los LOG_x dejan de esperar al UART
+    Logger::startAsync();
+}
+
+// ============================================================================
+// LOOP
+// ============================================================================
+void loop()
+{
+    // Manejo de estado de error
+    if (systemState == STATE_ERROR)
+    {
+        digitalWrite(LED_PIN, !digitalRead(LED_PIN));
+        delay(1000);
+        return;
+    }
+
+    // Todo corre en las tareas del Runtime: liberar la tarea del loop y su stack
+    vTaskDelete(nullptr);
+}
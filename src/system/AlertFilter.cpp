@@ -0,0 +1,140 @@
+#include "AlertFilter.h"
+
+AlertFilter::AlertFilter(const Config &config)
+    : config(config),
+      stats(),
+      level(AlertLevel::SAFE),
+      pending(AlertLevel::SAFE),
+      pendingSince(0)
+{
+}
+
+// ============================================================================
+// LECTURAS
+// ============================================================================
+
+AlertLevel AlertFilter::update(float distance, uint32_t now, float secondsToCrossing)
+{
+    stats.readings++;
+
+    bool approaching = secondsToCrossing >= 0.0f && secondsToCrossing <= config.anticipateSeconds;
+    if (approaching && classify(distance) == AlertLevel::SAFE)
+    {
+        stats.anticipated++;
+    }
+
+    AlertLevel wanted = target(distance, approaching);
+    if (wanted == level)
+    {
+        if (pending != level)
+        {
+            stats.rejected++; // Volvió antes de cumplir la permanencia
+            pending = level;
+        }
+        return level;
+    }
+
+    // Un cambio en la misma dirección conserva el tiempo ya esperado
+    bool rising = wanted > level;
+    bool pendingRising = pending > level;
+    if (pending == level || rising != pendingRising)
+    {
+        if (pending != level)
+        {
+            stats.rejected++;
+        }
+        pendingSince = now;
+    }
+    pending = wanted;
+
+    uint32_t dwell = rising ? config.escalateDwellMs : config.releaseDwellMs;
+    if (now - pendingSince >= dwell)
+    {
+        level = pending;
+        stats.transitions++;
+    }
+    return level;
+}
+
+void AlertFilter::force(AlertLevel level, uint32_t now)
+{
+    this->level = level;
+    pending = level;
+    pendingSince = now;
+}
+
+void AlertFilter::reset()
+{
+    level = AlertLevel::SAFE;
+    pending = AlertLevel::SAFE;
+    pendingSince = 0;
+    stats = Stats();
+}
+
+// ============================================================================
+// NIVELES
+// ============================================================================
+
+AlertLevel AlertFilter::classify(float distance) const
+{
+    if (distance >= config.warningMeters)
+    {
+        return AlertLevel::WARNING;
+    }
+    if (distance >= config.cautionMeters)
+    {
+        return AlertLevel::CAUTION;
+    }
+    return AlertLevel::SAFE;
+}
+
+AlertLevel AlertFilter::target(float distance, bool approaching) const
+{
+    // Subir: umbral de entrada. Bajar: umbral menos la histéresis.
+    // Acercándose rápido al borde no baja de CAUTION
+    AlertLevel floor = approaching ? AlertLevel::CAUTION : AlertLevel::SAFE;
+    AlertLevel entered = classify(distance);
+    if (entered < floor)
+    {
+        entered = floor;
+    }
+    if (entered > level)
+    {
+        return entered;
+    }
+    AlertLevel held = classify(distance + config.hysteresisMeters);
+    if (held < floor)
+    {
+        held = floor;
+    }
+    return held < level ? held : level;
+}
+
+// ============================================================================
+// ESTADO
+// ============================================================================
+
+AlertLevel AlertFilter::getLevel() const
+{
+    return level;
+}
+
+AlertLevel AlertFilter::getPendingLevel() const
+{
+    return pending;
+}
+
+void AlertFilter::setConfig(const Config &config)
+{
+    this->config = config;
+}
+
+const AlertFilter::Config &AlertFilter::getConfig() const
+{
+    return config;
+}
+
+const AlertFilter::Stats &AlertFilter::getStats() const
+{
+    return stats;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <stdint.h>
+#include "../config/constants.h"
+#include "../core/Types.h"
+
+/*
+ * ============================================================================
+ * ALERT FILTER - HISTÉRESIS Y PERMANENCIA EN LOS CAMBIOS DE NIVEL
+ * ============================================================================
+ * Convierte la distancia al borde de cada posición en el nivel de alerta,
+ * sin que el ruido del GPS alrededor de un umbral haga sonar y callar el
+ * buzzer una y otra vez:
+ *
+ * - Histéresis: se entra a un nivel al cruzar su umbral, pero solo se sale
+ *   cuando la distancia queda hysteresisMeters por debajo
+ * - Permanencia: un nivel nuevo se aplica solo si se mantiene escalateDwellMs
+ *   (subir) o releaseDwellMs (bajar) desde la primera lectura que lo pide.
+ *   Un salto aislado que vuelve antes de ese tiempo se descarta
+ *
+ * Subir y bajar tienen tiempos distintos: el animal que sale tiene que oír
+ * la alerta pronto, y la alerta no se corta hasta que está bien adentro.
+ * Con histéresis y tiempos en 0 el nivel es el de la lectura, como antes.
+ *
+ * Anticipación: si la lectura trae el tiempo hasta cruzar el borde
+ * (ApproachPredictor) y es menor que anticipateSeconds, pide CAUTION aunque
+ * la distancia todavía no llegue al umbral. Pasa por la misma permanencia.
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+class AlertFilter
+{
+public:
+    struct Config
+    {
+        float cautionMeters;      // Umbral de entrada a CAUTION (distancia al borde, negativa = dentro)
+        float warningMeters;      // Umbral de entrada a WARNING
+        float hysteresisMeters;   // Margen bajo el umbral para salir del nivel
+        uint32_t escalateDwellMs; // Permanencia para subir de nivel
+        uint32_t releaseDwellMs;  // Permanencia para bajar de nivel
+        float anticipateSeconds;  // Cruce previsto antes de esto: CAUTION (0 = sin anticipación)
+
+        Config(float caution, float warning)
+            : cautionMeters(caution), warningMeters(warning), hysteresisMeters(ALERT_HYSTERESIS_M),
+              escalateDwellMs(ALERT_ESCALATE_DWELL_MS), releaseDwellMs(ALERT_RELEASE_DWELL_MS),
+              anticipateSeconds(APPROACH_HORIZON_S) {}
+    };
+
+    struct Stats
+    {
+        uint32_t readings;
+        uint32_t transitions; // Cambios de nivel aplicados
+        uint32_t rejected;    // Cambios pedidos que no duraron lo suficiente
+        uint32_t anticipated; // Lecturas en CAUTION solo por el cruce previsto
+    };
+
+    explicit AlertFilter(const Config &config);
+
+    /**
+     * Aplica una lectura
+     * @param distance Distancia al borde (negativa = dentro)
+     * @param now Tiempo de la lectura (ms)
+     * @param secondsToCrossing Tiempo previsto hasta cruzar el borde (negativo = no se acerca)
+     * @return Nivel filtrado
+     */
+    AlertLevel update(float distance, uint32_t now, float secondsToCrossing = -1.0f);
+
+    // Fija el nivel sin esperar (escalada por tiempo, alertas manuales)
+    void force(AlertLevel level, uint32_t now);
+    void reset();
+
+    AlertLevel getLevel() const;
+    AlertLevel getPendingLevel() const; // = getLevel() si no hay cambio esperando
+    AlertLevel classify(float distance) const; // Nivel de la lectura, sin filtrar
+
+    void setConfig(const Config &config);
+    const Config &getConfig() const;
+    const Stats &getStats() const;
+
+private:
+    Config config;
+    Stats stats;
+
+    AlertLevel level;
+    AlertLevel pending;
+    uint32_t pendingSince;
+
+    AlertLevel target(float distance, bool approaching) const;
+};
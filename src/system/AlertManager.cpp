@@ -1,5 +1,6 @@
 #include "AlertManager.h"
 #include "../core/Logger.h"
+#include "Profiler.h"
 
 // ============================================================================
 // CONSTRUCTOR E INICIALIZACIÓN
@@ -17,15 +18,15 @@ AlertManager::AlertManager(BuzzerManager &buzzer, DisplayManager &display) : buz
                                                                              lastAlertTime(0),
                                                                              totalAlertsTriggered(0),
                                                                              maxLevelReached(AlertLevel::SAFE),
-                                                                             escalationEnabled(true),
                                                                              autoStopEnabled(true),
                                                                              displayAlertsEnabled(false), // 🔥 DESHABILITADO - No mostrar pantallas emergentes
                                                                              audioAlertsEnabled(true),
-                                                                             levelStartTime(0),
-                                                                             escalationPending(false),
-                                                                             currentAlertType(ALERT_GEOFENCE),
+                                                                             filter(AlertFilter::Config(CAUTION_DISTANCE, WARNING_DISTANCE)),
+                                                                             policy(&fixedPolicy),
+                                                                             stimulusAudible(true),
                                                                              alertCallback(nullptr),
-                                                                             escalationCallback(nullptr)
+                                                                             escalationCallback(nullptr),
+                                                                             currentAlertType(ALERT_GEOFENCE)
 {
     strcpy(currentReason, "Sistema OK");
     initializeThresholds();
@@ -40,17 +41,11 @@ Result AlertManager::init()
 
     LOG_I("🚨 Inicializando Alert Manager...");
 
-    // Verificar que los managers requeridos estén inicializados
+    // En el arranque rápido buzzer y display se inicializan bajo demanda:
+    // el buzzer al empezar la primera alerta
     if (!buzzerManager.isInitialized())
     {
-        LOG_E("❌ BuzzerManager no inicializado");
-        return Result::ERROR_INIT;
-    }
-
-    if (!displayManager.isInitialized())
-    {
-        LOG_E("❌ DisplayManager no inicializado");
-        return Result::ERROR_INIT;
+        LOG_W("⚠️ BuzzerManager se inicializará con la primera alerta");
     }
 
     initialized = true;
@@ -68,14 +63,41 @@ bool AlertManager::isInitialized() const
 // CONTROL PRINCIPAL DE ALERTAS
 // ============================================================================
 
-void AlertManager::update(float distanceToGeofence)
+void AlertManager::update(float distanceToGeofence, float secondsToCrossing)
 {
     if (!initialized || !enabled)
         return;
 
-    AlertLevel newLevel = calculateGeofenceLevel(distanceToGeofence);
-    setAlertLevel(newLevel, distanceToGeofence);
+    PROFILE_SCOPE("alert");
+
+    // El nivel cambia solo si la lectura cruza el umbral con histéresis (o
+    // el cruce previsto está cerca) y se mantiene el tiempo de permanencia;
+    // la política decide la escalada sin respuesta y si todavía puede sonar hoy
+    StimulusPolicy::Decision decision;
+    uint16_t dailyCap;
+    {
+        RtosLock lock(filterMutex);
+        uint32_t now = millis();
+        AlertLevel fenceLevel = filter.update(distanceToGeofence, now, secondsToCrossing);
+        decision = policy->update(fenceLevel, distanceToGeofence, now);
+        dailyCap = policy->getConfig().dailyCap;
+    }
+
+    AlertLevel previous = currentLevel;
+    bool wasAudible = stimulusAudible;
+    stimulusAudible = decision.audible;
     currentAlertType = ALERT_GEOFENCE;
+    setAlertLevel(decision.level, distanceToGeofence);
+
+    // Tope diario alcanzado (o nuevo día) sin cambio de nivel
+    if (alertActive && decision.level == previous && stimulusAudible != wasAudible)
+    {
+        updateBuzzer();
+    }
+    if (alertActive && wasAudible && !stimulusAudible)
+    {
+        LOG_W("🚨 Tope diario de estímulos alcanzado (%u)", dailyCap);
+    }
 }
 
 void AlertManager::setAlertLevel(AlertLevel level, float distance)
@@ -104,13 +126,11 @@ void AlertManager::setAlertLevel(AlertLevel level, float distance)
         alertStartTime = millis();
         lastAlertTime = alertStartTime;
         totalAlertsTriggered++;
-        levelStartTime = alertStartTime;
-        escalationPending = false;
 
         LOG_I("🚨 Alerta iniciada - Nivel: %s, Distancia: %.1fm",
               alertLevelToString(level), distance);
 
-        buzzerManager.startContinuousAlert(level);
+        buzzerManager.init();
     }
     // Finalizar si ahora no hay que alertar y previamente estábamos alertando
     else if (!alertActive && wasAlerting)
@@ -127,8 +147,12 @@ void AlertManager::setAlertLevel(AlertLevel level, float distance)
     if (level != previousLevel)
     {
         onLevelChange(previousLevel, level);
-        levelStartTime = millis();
-        escalationPending = false;
+
+        // Inicio o escalada: la cadencia del nivel nuevo reemplaza a la anterior
+        if (alertActive)
+        {
+            updateBuzzer();
+        }
     }
 
     // Ejecutar alerta
@@ -170,9 +194,13 @@ void AlertManager::stopAlert()
 
 void AlertManager::stopAllAlerts()
 {
+    {
+        RtosLock lock(filterMutex);
+        filter.force(AlertLevel::SAFE, millis());
+        policy->stop();
+    }
     stopAlert();
     buzzerManager.stopContinuousAlert();
-    escalationPending = false;
 }
 
 // ============================================================================
@@ -233,19 +261,102 @@ void AlertManager::setBatteryThresholds(float lowVoltage, float criticalVoltage)
     LOG_I("🚨 Umbrales batería actualizados: %.2f/%.2fV", lowVoltage, criticalVoltage);
 }
 
-// ============================================================================
-// CONFIGURACIÓN DE COMPORTAMIENTO
-// ============================================================================
+void AlertManager::setFilterConfig(float hysteresisMeters, uint32_t escalateDwellMs, uint32_t releaseDwellMs)
+{
+    {
+        RtosLock lock(filterMutex);
+        AlertFilter::Config config = filter.getConfig();
+        config.hysteresisMeters = hysteresisMeters;
+        config.escalateDwellMs = escalateDwellMs;
+        config.releaseDwellMs = releaseDwellMs;
+        filter.setConfig(config);
+    }
 
-void AlertManager::setEscalationEnabled(bool enabled)
+    LOG_I("🚨 Filtro de alertas: histéresis %.1fm, subir %lus, bajar %lus",
+          hysteresisMeters, escalateDwellMs / 1000, releaseDwellMs / 1000);
+}
+
+AlertFilter::Config AlertManager::getFilterConfig() const
+{
+    RtosLock lock(filterMutex);
+    return filter.getConfig();
+}
+
+AlertFilter::Stats AlertManager::getFilterStats() const
+{
+    RtosLock lock(filterMutex);
+    return filter.getStats();
+}
+
+void AlertManager::setStimulusPolicy(StimulusPolicy *policy)
+{
+    StimulusPolicy *selected = policy ? policy : &fixedPolicy;
+    {
+        RtosLock lock(filterMutex);
+        // La misma política sigue con su episodio: reiniciarlo cobraría otro
+        // estímulo del tope diario y bajaría un WARNING ya escalado
+        if (selected == this->policy)
+        {
+            return;
+        }
+        this->policy->stop();
+        this->policy = selected;
+    }
+
+    LOG_I("🚨 Política de estímulos: %s", getStimulusPolicyName());
+}
+
+void AlertManager::setStimulusConfig(const StimulusPolicy::Config &config)
 {
-    escalationEnabled = enabled;
-    if (!enabled)
     {
-        escalationPending = false;
+        RtosLock lock(filterMutex);
+        policy->setConfig(config);
     }
+
+    LOG_I("🚨 Estímulos: escalada a %lus sin respuesta, tope %u por día",
+          config.escalateAfterMs / 1000, config.dailyCap);
+}
+
+StimulusPolicy::Config AlertManager::getStimulusConfig() const
+{
+    RtosLock lock(filterMutex);
+    return policy->getConfig();
 }
 
+StimulusPolicy::Stats AlertManager::getStimulusStats() const
+{
+    RtosLock lock(filterMutex);
+    return policy->getStats();
+}
+
+const char *AlertManager::getStimulusPolicyName() const
+{
+    RtosLock lock(filterMutex);
+    return policy->getName();
+}
+
+const StimulusPolicy *AlertManager::getStimulusPolicy() const
+{
+    RtosLock lock(filterMutex);
+    return policy;
+}
+
+StimulusPolicy::State AlertManager::getStimulusState(uint32_t now) const
+{
+    RtosLock lock(filterMutex);
+    return policy->getState(now);
+}
+
+void AlertManager::restoreStimulusState(const StimulusPolicy::State &state, uint32_t now)
+{
+    RtosLock lock(filterMutex);
+    policy->restore(state, now);
+}
+
+// ============================================================================
+// CONFIGURACIÓN DE COMPORTAMIENTO
+// ============================================================================
+
 void AlertManager::setAutoStopEnabled(bool enabled)
 {
     autoStopEnabled = enabled;
@@ -307,35 +418,6 @@ void AlertManager::setEscalationCallback(EscalationCallback callback)
     escalationCallback = callback;
 }
 
-void AlertManager::setEscalationConfig(const EscalationConfig &config)
-{
-    escalationConfig = config;
-}
-
-AlertManager::EscalationConfig AlertManager::getEscalationConfig() const
-{
-    return escalationConfig;
-}
-
-// ============================================================================
-// UPDATE LOOP
-// ============================================================================
-
-void AlertManager::update()
-{
-    if (!initialized)
-        return;
-
-    // Actualizar escalada automática
-    if (escalationEnabled && alertActive)
-    {
-        updateEscalation();
-    }
-
-    // Actualizar managers de hardware
-    buzzerManager.update();
-}
-
 // ============================================================================
 // MÉTODOS PRIVADOS
 // ============================================================================
@@ -384,67 +466,6 @@ AlertLevel AlertManager::calculateBatteryLevel(const BatteryStatus &battery) con
     }
 }
 
-// ============================================================================
-// GESTIÓN DE ESCALADA
-// ============================================================================
-
-void AlertManager::updateEscalation()
-{
-    if (!escalationConfig.enabled || !alertActive)
-    {
-        LOG_D("No se actualizó la escalación de alerta");
-        return;
-    }
-
-    uint32_t timeInLevel = millis() - levelStartTime;
-
-    if (shouldEscalate() && timeInLevel >= escalationConfig.timeToEscalate)
-    {
-        LOG_D("Se actualizó la escalación de alerta");
-        escalateAlert();
-    }
-}
-
-void AlertManager::escalateAlert()
-{
-    AlertLevel nextLevel = getNextLevel(currentLevel);
-
-    if (nextLevel != currentLevel)
-    {
-        LOG_W("🚨 Escalando alerta: %s -> %s",
-              alertLevelToString(currentLevel), alertLevelToString(nextLevel));
-
-        AlertLevel oldLevel = currentLevel;
-        setAlertLevel(nextLevel, currentDistance);
-
-        if (escalationCallback)
-        {
-            escalationCallback(oldLevel, nextLevel);
-        }
-    }
-}
-
-bool AlertManager::shouldEscalate() const
-{
-    return currentLevel < AlertLevel::WARNING && // No escalar más allá de warning
-           (millis() - levelStartTime) >= escalationConfig.timeToEscalate;
-}
-
-AlertLevel AlertManager::getNextLevel(AlertLevel current) const
-{
-    switch (current)
-    {
-    case AlertLevel::SAFE:
-        return AlertLevel::CAUTION;
-    case AlertLevel::CAUTION:
-        return AlertLevel::WARNING;
-    case AlertLevel::WARNING:
-        return AlertLevel::WARNING; // MÁXIMO
-    default:
-        return current;
-    }
-}
-
 // ============================================================================
 // EJECUCIÓN DE ALERTAS
 // ============================================================================
@@ -454,12 +475,8 @@ void AlertManager::executeAlert()
     if (!alertActive)
         return;
 
-    // Actualizar buzzer solamente - sin interrumpir pantallas
-    if (audioAlertsEnabled)
-    {
-        LOG_D("Ejecutamos updateBuzzer() dentro de executeAlert");
-        updateBuzzer();
-    }
+    // El buzzer ya repite la cadencia del nivel por su cuenta; acá no hay
+    // nada que tocar
 
     // 🔥 ELIMINADO: updateDisplay() - Ya no interrumpe las pantallas predefinidas
 
@@ -481,12 +498,18 @@ void AlertManager::updateDisplay()
 
 void AlertManager::updateBuzzer()
 {
-    // Ejecutar el update cuando la alerta continua está activa
-    if (buzzerManager.isContinousAlertActive())
+    if (!audioAlertsEnabled)
     {
-        LOG_D("Ejecutamos updateContinuousAlert");
-        buzzerManager.updateContinuousAlert();
+        return;
+    }
+
+    // La geocerca no suena pasado el tope diario de estímulos
+    if (currentAlertType == ALERT_GEOFENCE && !stimulusAudible)
+    {
+        buzzerManager.stopContinuousAlert();
+        return;
     }
+    buzzerManager.startContinuousAlert(currentLevel);
 }
 
 // ============================================================================
@@ -5,6 +5,9 @@
 #include "../core/Types.h"
 #include "hardware/BuzzerManager.h"
 #include "hardware/DisplayManager.h"
+#include "AlertFilter.h"
+#include "StimulusPolicy.h"
+#include "Rtos.h"
 
 /*
  * ============================================================================
@@ -27,8 +30,9 @@ public:
     Result init();
     bool isInitialized() const;
 
-    // Control principal de alertas
-    void update(float distanceToGeofence);
+    // Control principal de alertas. secondsToCrossing: ApproachPredictor
+    // (negativo = no se acerca al borde)
+    void update(float distanceToGeofence, float secondsToCrossing = -1.0f);
     void setAlertLevel(AlertLevel level, float distance = 0.0f);
     AlertLevel getCurrentLevel() const;
     bool isAlerting() const;
@@ -48,8 +52,25 @@ public:
     bool isEnabled() const;
     void setBatteryThresholds(float lowVoltage, float criticalVoltage);
 
+    // Histéresis y permanencia de los niveles de la geocerca (también por downlink)
+    void setFilterConfig(float hysteresisMeters, uint32_t escalateDwellMs, uint32_t releaseDwellMs);
+    AlertFilter::Config getFilterConfig() const;
+    AlertFilter::Stats getFilterStats() const;
+
+    // Política de estímulos: escalada sin respuesta y tope diario. nullptr =
+    // la fija interna. La política tiene que vivir mientras esté en uso
+    void setStimulusPolicy(StimulusPolicy *policy);
+    void setStimulusConfig(const StimulusPolicy::Config &config);
+    StimulusPolicy::Config getStimulusConfig() const;
+    StimulusPolicy::Stats getStimulusStats() const;
+    const char *getStimulusPolicyName() const;
+    const StimulusPolicy *getStimulusPolicy() const;
+
+    // Lo aprendido y el conteo del día de la política en uso (modo ciclo)
+    StimulusPolicy::State getStimulusState(uint32_t now) const;
+    void restoreStimulusState(const StimulusPolicy::State &state, uint32_t now);
+
     // Configuración de comportamiento
-    void setEscalationEnabled(bool enabled);
     void setAutoStopEnabled(bool enabled);
     void setDisplayAlertsEnabled(bool enabled);
     void setAudioAlertsEnabled(bool enabled);
@@ -67,22 +88,6 @@ public:
     void setAlertCallback(AlertCallback callback);
     void setEscalationCallback(EscalationCallback callback);
 
-    // Update loop (llamar desde loop principal)
-    void update();
-
-    // Configuración de escalada automática
-    struct EscalationConfig
-    {
-        bool enabled;
-        uint32_t timeToEscalate; // Tiempo en ms para escalar al siguiente nivel
-        bool resetOnImprovement; // Si mejorar resetea el tiempo de escalada
-
-        EscalationConfig() : enabled(true), timeToEscalate(30000), resetOnImprovement(true) {}
-    };
-
-    void setEscalationConfig(const EscalationConfig &config);
-    EscalationConfig getEscalationConfig() const;
-
 private:
     // Referencias a managers de hardware
     BuzzerManager &buzzerManager;
@@ -114,15 +119,17 @@ private:
     } thresholds;
 
     // Configuración de comportamiento
-    bool escalationEnabled;
     bool autoStopEnabled;
     bool displayAlertsEnabled;
     bool audioAlertsEnabled;
 
-    // Sistema de escalada
-    EscalationConfig escalationConfig;
-    uint32_t levelStartTime;
-    bool escalationPending;
+    // Filtro de niveles y política de estímulos de la geocerca. update(distance)
+    // corre en la tarea de geocerca y la configuración llega desde la de radio
+    AlertFilter filter;
+    FixedStimulusPolicy fixedPolicy;
+    StimulusPolicy *policy;
+    bool stimulusAudible; // false: tope diario alcanzado, la geocerca no suena
+    mutable RtosMutex filterMutex;
 
     // Callbacks
     AlertCallback alertCallback;
@@ -144,12 +151,6 @@ private:
     AlertLevel calculateGeofenceLevel(float distance) const;
     AlertLevel calculateBatteryLevel(const BatteryStatus &battery) const;
 
-    // Gestión de escalada
-    void updateEscalation();
-    void escalateAlert();
-    bool shouldEscalate() const;
-    AlertLevel getNextLevel(AlertLevel current) const;
-
     // Ejecución de alertas
     void executeAlert();
     void updateDisplay();
@@ -0,0 +1,121 @@
+#include "ApproachPredictor.h"
+#include <math.h>
+
+// Misma proyección plana local que GeofenceManager::distanceToLineSegment
+static const double METERS_PER_DEG_LAT = 110540.0;
+static const double METERS_PER_DEG_LNG = 111320.0;
+static const double DEG_TO_RAD_D = 3.14159265358979323846 / 180.0;
+
+ApproachPredictor::ApproachPredictor(const Config &config)
+    : config(config)
+{
+    reset();
+}
+
+// ============================================================================
+// VELOCIDAD
+// ============================================================================
+
+void ApproachPredictor::update(double latitude, double longitude, uint32_t timestamp)
+{
+    if (havePosition && timestamp == lastTimestamp)
+    {
+        return; // Reevaluación de la misma posición
+    }
+
+    uint32_t elapsed = timestamp - lastTimestamp;
+    if (!havePosition || elapsed > config.maxGapMs)
+    {
+        havePosition = true;
+        haveVelocity = false;
+        lastLatitude = latitude;
+        lastLongitude = longitude;
+        lastTimestamp = timestamp;
+        return;
+    }
+
+    float seconds = elapsed / 1000.0f;
+    float east = (float)((longitude - lastLongitude) * cos(lastLatitude * DEG_TO_RAD_D) * METERS_PER_DEG_LNG) / seconds;
+    float north = (float)((latitude - lastLatitude) * METERS_PER_DEG_LAT) / seconds;
+    if (east * east + north * north > config.maxSpeed * config.maxSpeed)
+    {
+        rejected++; // Se mide la próxima contra la última posición buena
+        return;
+    }
+
+    if (haveVelocity)
+    {
+        velocityEast += config.smoothing * (east - velocityEast);
+        velocityNorth += config.smoothing * (north - velocityNorth);
+    }
+    else
+    {
+        velocityEast = east;
+        velocityNorth = north;
+        haveVelocity = true;
+    }
+
+    lastLatitude = latitude;
+    lastLongitude = longitude;
+    lastTimestamp = timestamp;
+}
+
+void ApproachPredictor::reset()
+{
+    havePosition = false;
+    haveVelocity = false;
+    lastLatitude = 0.0;
+    lastLongitude = 0.0;
+    lastTimestamp = 0;
+    velocityEast = 0.0f;
+    velocityNorth = 0.0f;
+    rejected = 0;
+}
+
+// ============================================================================
+// PREDICCIÓN
+// ============================================================================
+
+float ApproachPredictor::timeToCrossing(float distance, float outwardEast, float outwardNorth) const
+{
+    if (distance >= 0.0f)
+    {
+        return 0.0f;
+    }
+    if (!haveVelocity)
+    {
+        return NOT_APPROACHING;
+    }
+
+    float closing = velocityEast * outwardEast + velocityNorth * outwardNorth;
+    if (closing < config.minClosingSpeed)
+    {
+        return NOT_APPROACHING;
+    }
+    return -distance / closing;
+}
+
+bool ApproachPredictor::hasVelocity() const
+{
+    return haveVelocity;
+}
+
+float ApproachPredictor::getVelocityEast() const
+{
+    return velocityEast;
+}
+
+float ApproachPredictor::getVelocityNorth() const
+{
+    return velocityNorth;
+}
+
+float ApproachPredictor::getSpeed() const
+{
+    return sqrtf(velocityEast * velocityEast + velocityNorth * velocityNorth);
+}
+
+uint32_t ApproachPredictor::getRejected() const
+{
+    return rejected;
+}
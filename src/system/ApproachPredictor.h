@@ -0,0 +1,73 @@
+#pragma once
+#include <stdint.h>
+#include "../config/constants.h"
+
+/*
+ * ============================================================================
+ * APPROACH PREDICTOR - TIEMPO HASTA CRUZAR EL BORDE
+ * ============================================================================
+ * Estima la velocidad del animal con las posiciones sucesivas (media móvil
+ * exponencial sobre el desplazamiento en metros locales) y la proyecta
+ * sobre la normal hacia afuera del borde más cercano que da
+ * GeofenceManager. Con la velocidad de acercamiento y la distancia sale el
+ * tiempo hasta cruzar: AlertFilter adelanta CAUTION si es menor que su
+ * horizonte.
+ *
+ * Caminar en paralelo al borde no acerca (velocidad sobre la normal ~0) y
+ * el pastoreo lento queda por debajo de minClosingSpeed, así que solo
+ * anticipa la alerta un animal que va derecho hacia el borde. Los saltos
+ * del GPS más rápidos que maxSpeed se descartan.
+ *
+ * O(1) por posición; las reevaluaciones de la misma posición no cambian la
+ * velocidad. Independiente de Arduino para poder ejecutarse en los tests
+ * nativos.
+ */
+
+class ApproachPredictor
+{
+public:
+    static constexpr float NOT_APPROACHING = -1.0f;
+
+    struct Config
+    {
+        float smoothing;       // Peso de la última velocidad medida (0-1)
+        float minClosingSpeed; // m/s hacia el borde por debajo de esto no predice
+        float maxSpeed;        // m/s; más rápido es un error del GPS
+        uint32_t maxGapMs;     // Sin posiciones en este tiempo se reinicia la velocidad
+
+        Config() : smoothing(APPROACH_SMOOTHING), minClosingSpeed(APPROACH_MIN_CLOSING),
+                   maxSpeed(APPROACH_MAX_SPEED), maxGapMs(APPROACH_MAX_GAP_MS) {}
+    };
+
+    explicit ApproachPredictor(const Config &config = Config());
+
+    // Posición nueva (timestamp en ms); la misma posición otra vez se ignora
+    void update(double latitude, double longitude, uint32_t timestamp);
+    void reset();
+
+    /**
+     * Segundos hasta cruzar el borde con la velocidad actual
+     * @param distance Distancia al borde (negativa = dentro)
+     * @param outwardEast, outwardNorth Normal unitaria hacia afuera del borde más cercano
+     * @return NOT_APPROACHING si no se acerca (o no hay velocidad); 0 si ya está afuera
+     */
+    float timeToCrossing(float distance, float outwardEast, float outwardNorth) const;
+
+    bool hasVelocity() const;
+    float getVelocityEast() const; // m/s
+    float getVelocityNorth() const;
+    float getSpeed() const;
+    uint32_t getRejected() const; // Saltos descartados
+
+private:
+    Config config;
+
+    bool havePosition;
+    bool haveVelocity;
+    double lastLatitude;
+    double lastLongitude;
+    uint32_t lastTimestamp;
+    float velocityEast;
+    float velocityNorth;
+    uint32_t rejected;
+};
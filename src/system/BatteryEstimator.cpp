@@ -0,0 +1,190 @@
+#include "BatteryEstimator.h"
+#include <math.h>
+
+// Voltaje en reposo de una celda LiPo cada 10 % (0 % a 100 %)
+static const float REST_CURVE[] = {3.30f, 3.60f, 3.69f, 3.74f, 3.77f, 3.80f,
+                                   3.84f, 3.89f, 3.95f, 4.03f, 4.15f};
+static const uint8_t REST_POINTS = sizeof(REST_CURVE) / sizeof(REST_CURVE[0]);
+static const float REST_STEP = 100.0f / (REST_POINTS - 1);
+
+static const float MIN_DEVIATION = 0.5f;   // Puntos de %: ni la curva es tan precisa
+static const float REANCHOR_SIGMAS = 3.0f; // Diferencia que el modelo no puede explicar
+static const float REANCHOR_MIN = 5.0f;
+
+BatteryEstimator::BatteryEstimator(const Config &config)
+    : config(config)
+{
+    reset();
+}
+
+// ============================================================================
+// CURVA EN REPOSO
+// ============================================================================
+
+static uint8_t restSegment(float volts)
+{
+    uint8_t i = 0;
+    while (i < REST_POINTS - 2 && volts >= REST_CURVE[i + 1])
+    {
+        i++;
+    }
+    return i;
+}
+
+float BatteryEstimator::socFromRestVoltage(float volts)
+{
+    if (volts <= REST_CURVE[0])
+    {
+        return 0.0f;
+    }
+    if (volts >= REST_CURVE[REST_POINTS - 1])
+    {
+        return 100.0f;
+    }
+    uint8_t i = restSegment(volts);
+    return (i + (volts - REST_CURVE[i]) / (REST_CURVE[i + 1] - REST_CURVE[i])) * REST_STEP;
+}
+
+float BatteryEstimator::restCurveSlope(float volts)
+{
+    uint8_t i = restSegment(volts);
+    return REST_STEP / (REST_CURVE[i + 1] - REST_CURVE[i]);
+}
+
+// ============================================================================
+// LECTURAS
+// ============================================================================
+
+void BatteryEstimator::addRestVoltage(float volts)
+{
+    float measured = socFromRestVoltage(volts);
+    float noise = fmaxf(config.restNoiseVolts * restCurveSlope(volts), MIN_DEVIATION);
+    stats.restReadings++;
+
+    if (!ready)
+    {
+        ready = true;
+        soc = measured;
+        deviation = noise;
+        return;
+    }
+
+    float correction = measured - soc;
+    float combined = sqrtf(deviation * deviation + noise * noise);
+    if (fabsf(correction) > fmaxf(REANCHOR_SIGMAS * combined, REANCHOR_MIN))
+    {
+        // Cargador conectado o batería cambiada: el conteo ya no vale
+        stats.reanchors++;
+        stats.lastCorrection = correction;
+        soc = measured;
+        deviation = noise;
+        return;
+    }
+
+    float variance = deviation * deviation;
+    float gain = variance / (variance + noise * noise);
+    soc += gain * correction;
+    deviation = fmaxf(sqrtf(variance * (1.0f - gain)), MIN_DEVIATION);
+    stats.lastCorrection = gain * correction;
+
+    soc = fminf(fmaxf(soc, 0.0f), 100.0f);
+}
+
+void BatteryEstimator::addConsumption(float mAh, uint32_t elapsedMs)
+{
+    if (mAh <= 0.0f || elapsedMs == 0)
+    {
+        return;
+    }
+    stats.consumedMah += mAh;
+
+    float current = mAh * 3600000.0f / elapsedMs;
+    if (averageCurrentMa > 0.0f)
+    {
+        averageCurrentMa += config.currentSmoothing * (current - averageCurrentMa);
+    }
+    else
+    {
+        averageCurrentMa = current;
+    }
+
+    if (!ready)
+    {
+        return;
+    }
+    float used = mAh * 100.0f / config.capacityMah;
+    soc = fmaxf(soc - used, 0.0f);
+    deviation += config.modelError * used;
+}
+
+void BatteryEstimator::reset()
+{
+    stats = Stats();
+    ready = false;
+    soc = 0.0f;
+    deviation = 0.0f;
+    averageCurrentMa = 0.0f;
+}
+
+BatteryEstimator::State BatteryEstimator::getState() const
+{
+    State state = {ready, soc, deviation, averageCurrentMa};
+    return state;
+}
+
+void BatteryEstimator::restore(const State &state)
+{
+    ready = state.ready;
+    soc = fminf(fmaxf(state.soc, 0.0f), 100.0f);
+    deviation = state.deviation;
+    averageCurrentMa = state.averageCurrentMa;
+}
+
+// ============================================================================
+// ESTADO
+// ============================================================================
+
+bool BatteryEstimator::isReady() const
+{
+    return ready;
+}
+
+float BatteryEstimator::getSoc() const
+{
+    return soc;
+}
+
+float BatteryEstimator::getUncertainty() const
+{
+    return deviation;
+}
+
+float BatteryEstimator::getRemainingMah() const
+{
+    return soc * config.capacityMah / 100.0f;
+}
+
+float BatteryEstimator::getAverageCurrentMa() const
+{
+    return averageCurrentMa;
+}
+
+uint16_t BatteryEstimator::getRemainingHours() const
+{
+    if (!ready || averageCurrentMa <= 0.0f)
+    {
+        return RUNTIME_UNKNOWN;
+    }
+    float hours = getRemainingMah() / averageCurrentMa;
+    return hours >= RUNTIME_UNKNOWN - 1 ? RUNTIME_UNKNOWN - 1 : (uint16_t)hours;
+}
+
+const BatteryEstimator::Config &BatteryEstimator::getConfig() const
+{
+    return config;
+}
+
+const BatteryEstimator::Stats &BatteryEstimator::getStats() const
+{
+    return stats;
+}
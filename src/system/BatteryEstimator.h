@@ -0,0 +1,99 @@
+#pragma once
+#include <stdint.h>
+#include "../config/constants.h"
+
+/*
+ * ============================================================================
+ * BATTERY ESTIMATOR - ESTADO DE CARGA Y AUTONOMÍA
+ * ============================================================================
+ * El voltaje bajo carga no sirve para el porcentaje: cae 100-200 mV durante
+ * cada TX y la curva de una LiPo es casi plana entre 20 y 80 %. Se combinan
+ * dos fuentes:
+ *
+ * - Conteo de carga: cada intervalo descuenta los mAh que EnergyModel
+ *   estima con el tiempo activo de cada subsistema. No deriva con el ruido
+ *   del ADC, pero acumula el error del modelo (modelError por mAh)
+ * - Curva en reposo: con la radio y el GPS callados el voltaje se acerca al
+ *   de circuito abierto y la tabla REST_CURVE lo convierte en porcentaje. Su
+ *   incertidumbre es restNoiseVolts por la pendiente de la curva en ese
+ *   punto: mucha en la zona plana, poca en los extremos
+ *
+ * Cada lectura en reposo corrige el conteo en proporción a las dos
+ * incertidumbres (filtro de Kalman de un estado). Si la diferencia es
+ * imposible para el modelo (cargador conectado, batería cambiada) se toma
+ * la de la curva. La autonomía es la carga restante sobre la corriente
+ * media de los últimos intervalos.
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+class BatteryEstimator
+{
+public:
+    static const uint16_t RUNTIME_UNKNOWN = 0xFFFF;
+
+    struct Config
+    {
+        float capacityMah;
+        float restNoiseVolts;   // Incertidumbre de una lectura en reposo
+        float modelError;       // Error relativo del consumo estimado
+        float currentSmoothing; // Peso del último intervalo en la corriente media
+
+        Config() : capacityMah(BATTERY_CAPACITY_MAH), restNoiseVolts(BATTERY_REST_NOISE_V),
+                   modelError(BATTERY_MODEL_ERROR), currentSmoothing(BATTERY_CURRENT_SMOOTHING) {}
+    };
+
+    struct Stats
+    {
+        uint32_t restReadings;
+        uint32_t reanchors;   // Correcciones fuera de lo que explica el modelo
+        float consumedMah;    // Contado desde el arranque
+        float lastCorrection; // Puntos de % de la última lectura en reposo
+    };
+
+    // Lo que hay que retener en deep sleep (SleepCycle) para no volver a
+    // anclar el porcentaje al despertar, con el GPS adquiriendo
+    struct State
+    {
+        bool ready;
+        float soc;
+        float deviation;
+        float averageCurrentMa;
+    };
+
+    explicit BatteryEstimator(const Config &config = Config());
+
+    // Voltaje medido en reposo (radio y GPS callados)
+    void addRestVoltage(float volts);
+
+    // Carga consumida en elapsedMs según el modelo de energía
+    void addConsumption(float mAh, uint32_t elapsedMs);
+
+    void reset();
+
+    State getState() const;
+    void restore(const State &state);
+
+    bool isReady() const; // Hubo al menos una lectura en reposo
+    float getSoc() const; // 0-100 %
+    float getUncertainty() const; // Desvío estimado, puntos de %
+    float getRemainingMah() const;
+    float getAverageCurrentMa() const; // 0 sin consumo contado
+    uint16_t getRemainingHours() const; // RUNTIME_UNKNOWN sin estimación
+
+    const Config &getConfig() const;
+    const Stats &getStats() const;
+
+    // Curva de una celda LiPo en reposo
+    static float socFromRestVoltage(float volts);
+    static float restCurveSlope(float volts); // % por voltio
+
+private:
+    Config config;
+    Stats stats;
+
+    bool ready;
+    float soc;
+    float deviation;
+    float averageCurrentMa;
+};
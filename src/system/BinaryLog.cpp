@@ -0,0 +1,210 @@
+#include "BinaryLog.h"
+#include <string.h>
+
+// ============================================================================
+// ESCRITURA DE TRAMAS
+// ============================================================================
+
+BinaryLog::Writer::Writer(uint8_t *buffer, size_t capacity)
+    : buffer(buffer),
+      capacity(capacity),
+      length(0),
+      levelIndex(0),
+      truncated(false)
+{
+}
+
+void BinaryLog::Writer::begin(uint32_t formatId, uint8_t level, uint32_t timestamp)
+{
+    length = 0;
+    truncated = false;
+
+    // Encabezado, id, nivel y el varint más largo de millis(), más el checksum
+    if (!buffer || capacity < HEADER_SIZE + 4 + 1 + 5 + 1)
+    {
+        truncated = true;
+        return;
+    }
+
+    buffer[length++] = SYNC;
+    buffer[length++] = 0; // Largo: se completa en finish()
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        buffer[length++] = (formatId >> (8 * i)) & 0xFF;
+    }
+    levelIndex = length;
+    buffer[length++] = level;
+    putVarint(timestamp);
+}
+
+bool BinaryLog::Writer::reserve(size_t bytes)
+{
+    // Una vez que algo no entró, lo que sigue tampoco va: el decodificador
+    // empareja argumentos por posición
+    if (truncated || length + bytes + 1 > capacity || length + bytes - HEADER_SIZE > 0xFF)
+    {
+        truncated = true;
+        return false;
+    }
+    return true;
+}
+
+void BinaryLog::Writer::putVarint(uint64_t value)
+{
+    do
+    {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buffer[length++] = value ? (byte | 0x80) : byte;
+    } while (value);
+}
+
+static uint8_t varintSize(uint64_t value)
+{
+    uint8_t bytes = 1;
+    while (value >>= 7)
+    {
+        bytes++;
+    }
+    return bytes;
+}
+
+void BinaryLog::Writer::putSigned(int64_t value)
+{
+    uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+    if (reserve(1 + varintSize(zigzag)))
+    {
+        buffer[length++] = TAG_INT;
+        putVarint(zigzag);
+    }
+}
+
+void BinaryLog::Writer::putUnsigned(uint64_t value)
+{
+    if (reserve(1 + varintSize(value)))
+    {
+        buffer[length++] = TAG_UINT;
+        putVarint(value);
+    }
+}
+
+void BinaryLog::Writer::putFloat(float value)
+{
+    if (reserve(1 + sizeof(value)))
+    {
+        buffer[length++] = TAG_FLOAT;
+        memcpy(&buffer[length], &value, sizeof(value)); // Little endian en ESP32 y x86
+        length += sizeof(value);
+    }
+}
+
+void BinaryLog::Writer::putDouble(double value)
+{
+    if (reserve(1 + sizeof(value)))
+    {
+        buffer[length++] = TAG_DOUBLE;
+        memcpy(&buffer[length], &value, sizeof(value));
+        length += sizeof(value);
+    }
+}
+
+void BinaryLog::Writer::putString(const char *text)
+{
+    if (!text)
+    {
+        text = "(null)";
+    }
+    if (!reserve(2))
+    {
+        return;
+    }
+
+    size_t textLength = strlen(text);
+    size_t room = capacity - 1 - (length + 2);
+    if (textLength > room)
+    {
+        textLength = room;
+        truncated = true; // El texto va cortado; lo que sigue se omite
+    }
+    if (length + 2 + textLength - HEADER_SIZE > 0xFF)
+    {
+        textLength = 0xFF - (length + 2 - HEADER_SIZE);
+        truncated = true;
+    }
+
+    buffer[length++] = TAG_STRING;
+    buffer[length++] = (uint8_t)textLength;
+    memcpy(&buffer[length], text, textLength);
+    length += textLength;
+}
+
+void BinaryLog::Writer::putPointer(const void *pointer)
+{
+    uint64_t value = (uintptr_t)pointer;
+    if (reserve(1 + varintSize(value)))
+    {
+        buffer[length++] = TAG_POINTER;
+        putVarint(value);
+    }
+}
+
+size_t BinaryLog::Writer::finish()
+{
+    if (length < HEADER_SIZE)
+    {
+        return 0;
+    }
+
+    if (truncated)
+    {
+        buffer[levelIndex] |= TRUNCATED;
+    }
+
+    uint8_t checksum = 0;
+    for (size_t i = HEADER_SIZE; i < length; i++)
+    {
+        checksum ^= buffer[i];
+    }
+    buffer[1] = (uint8_t)(length - HEADER_SIZE);
+    buffer[length++] = checksum;
+    return length;
+}
+
+bool BinaryLog::Writer::isTruncated() const
+{
+    return truncated;
+}
+
+size_t BinaryLog::encode(uint8_t *frame, size_t capacity, uint8_t level, uint32_t timestamp,
+                         uint32_t formatId, const Arg *args, size_t count)
+{
+    Writer writer(frame, capacity);
+    writer.begin(formatId, level, timestamp);
+    for (size_t i = 0; i < count; i++)
+    {
+        switch (args[i].tag)
+        {
+        case TAG_INT:
+            writer.putSigned(args[i].i);
+            break;
+        case TAG_UINT:
+            writer.putUnsigned(args[i].u);
+            break;
+        case TAG_FLOAT:
+            writer.putFloat(args[i].f);
+            break;
+        case TAG_DOUBLE:
+            writer.putDouble(args[i].d);
+            break;
+        case TAG_STRING:
+            writer.putString(args[i].s);
+            break;
+        case TAG_POINTER:
+            writer.putPointer(args[i].p);
+            break;
+        default:
+            break;
+        }
+    }
+    return writer.finish();
+}
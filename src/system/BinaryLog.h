@@ -0,0 +1,142 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+
+/*
+ * ============================================================================
+ * BINARY LOG - MENSAJES COMO ID DE FORMATO MÁS ARGUMENTOS
+ * ============================================================================
+ * Con ENABLE_BINARY_LOG los LOG_x no llevan el texto del formato al
+ * firmware: el formato se reemplaza en compilación por su hash FNV-1a de
+ * 32 bits y por serial sale una trama corta con el hash y los argumentos.
+ * scripts/log_decoder.py arma el diccionario hash → formato leyendo los
+ * LOG_x del código fuente y reconstruye las líneas en el PC.
+ *
+ * Trama:
+ *   [0xFE][largo][id u32][nivel][millis varint][argumentos...][checksum]
+ *
+ * 0xFE no aparece nunca en UTF-8, así que las tramas se separan sin
+ * ambigüedad del texto que se siga imprimiendo por serial (banner, estado).
+ * El largo cuenta desde el id hasta el último argumento; el checksum es el
+ * XOR de esos bytes. Cada argumento lleva un byte de tipo: los enteros van
+ * en varint (con zigzag si tienen signo), los float en 4 bytes, los double
+ * en 8 y los textos con su largo delante. Lo que no entra se omite y el
+ * nivel lleva el bit TRUNCATED.
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+class BinaryLog
+{
+public:
+    static const uint8_t SYNC = 0xFE;
+    static const size_t MAX_FRAME = 64;
+    static const size_t HEADER_SIZE = 2; // Sincronismo y largo
+    static const uint8_t TRUNCATED = 0x80; // En el byte de nivel
+
+    enum Tag : uint8_t
+    {
+        TAG_NONE = 0,
+        TAG_INT = 1,
+        TAG_UINT = 2,
+        TAG_FLOAT = 3,
+        TAG_DOUBLE = 4,
+        TAG_STRING = 5,
+        TAG_POINTER = 6
+    };
+
+    // FNV-1a de 32 bits de los bytes del formato (igual en log_decoder.py)
+    static constexpr uint32_t formatId(const char *format)
+    {
+        uint32_t hash = 2166136261u;
+        for (; *format; format++)
+        {
+            hash ^= (uint8_t)*format;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    class Writer
+    {
+    public:
+        Writer(uint8_t *buffer, size_t capacity);
+
+        void begin(uint32_t formatId, uint8_t level, uint32_t timestamp);
+        void putSigned(int64_t value);
+        void putUnsigned(uint64_t value);
+        void putFloat(float value);
+        void putDouble(double value);
+        void putString(const char *text); // Se corta si no entra entero
+        void putPointer(const void *pointer);
+
+        // Completa largo y checksum. @return Bytes de la trama (0 si no entra ni el encabezado)
+        size_t finish();
+
+        bool isTruncated() const;
+
+    private:
+        uint8_t *buffer;
+        size_t capacity;
+        size_t length;
+        size_t levelIndex;
+        bool truncated;
+
+        bool reserve(size_t bytes); // Deja lugar para el checksum
+        void putVarint(uint64_t value);
+    };
+
+    // ========================================================================
+    // ARGUMENTOS SEGÚN SU TIPO EN C++
+    // ========================================================================
+    // Cada LOG_x arma un arreglo de Arg en el stack y llama a una sola
+    // función: el código por llamada es el mismo para cualquier formato
+
+    struct Arg
+    {
+        Tag tag;
+        union
+        {
+            int64_t i;
+            uint64_t u;
+            float f;
+            double d;
+            const char *s;
+            const void *p;
+        };
+
+        Arg() : tag(TAG_NONE), u(0) {}
+
+        template <typename T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, int>::type = 0>
+        Arg(T value) : tag(TAG_INT), i(value) {}
+
+        template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, int>::type = 0>
+        Arg(T value) : tag(TAG_UINT), u(value) {}
+
+        template <typename T, typename std::enable_if<std::is_enum<T>::value, int>::type = 0>
+        Arg(T value) : tag(TAG_INT), i((int64_t)value) {}
+
+        Arg(float value) : tag(TAG_FLOAT), f(value) {}
+        Arg(double value) : tag(TAG_DOUBLE), d(value) {}
+        Arg(const char *text) : tag(TAG_STRING), s(text) {}
+
+        template <typename T>
+        Arg(const T *pointer) : tag(TAG_POINTER), p(pointer) {}
+    };
+
+    /**
+     * Arma una trama completa
+     * @return Bytes escritos en frame (0 si no entra ni el encabezado)
+     */
+    static size_t encode(uint8_t *frame, size_t capacity, uint8_t level, uint32_t timestamp,
+                         uint32_t formatId, const Arg *args, size_t count);
+
+    template <typename... Args>
+    static size_t encode(uint8_t *frame, size_t capacity, uint8_t level, uint32_t timestamp,
+                         uint32_t formatId, const Args &...args)
+    {
+        const Arg list[] = {Arg(args)..., Arg()};
+        return encode(frame, capacity, level, timestamp, formatId, list, sizeof...(Args));
+    }
+};
@@ -0,0 +1,123 @@
+#include "BootProfiler.h"
+#include <stdio.h>
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+BootProfiler::BootProfiler(ClockFunction clock)
+    : clock(clock),
+      stageCount(0),
+      droppedStages(0),
+      beginUs(0),
+      lastMarkUs(0),
+      fastBoot(false)
+{
+}
+
+// ============================================================================
+// MEDICIÓN
+// ============================================================================
+
+void BootProfiler::begin(bool fastBoot)
+{
+    this->fastBoot = fastBoot;
+    stageCount = 0;
+    droppedStages = 0;
+    beginUs = clock();
+    lastMarkUs = beginUs;
+}
+
+void BootProfiler::mark(const char *name)
+{
+    uint32_t now = clock();
+    if (stageCount >= MAX_STAGES)
+    {
+        droppedStages++;
+        lastMarkUs = now;
+        return;
+    }
+
+    Stage &stage = stages[stageCount++];
+    stage.name = name;
+    stage.startUs = lastMarkUs - beginUs;
+    stage.durationUs = now - lastMarkUs;
+    lastMarkUs = now;
+}
+
+// ============================================================================
+// CONSULTAS
+// ============================================================================
+
+uint8_t BootProfiler::getStageCount() const
+{
+    return stageCount;
+}
+
+const BootProfiler::Stage &BootProfiler::getStage(uint8_t index) const
+{
+    return stages[index < stageCount ? index : 0];
+}
+
+uint8_t BootProfiler::getDroppedStages() const
+{
+    return droppedStages;
+}
+
+uint32_t BootProfiler::totalUs() const
+{
+    return lastMarkUs - beginUs;
+}
+
+uint32_t BootProfiler::startUs() const
+{
+    return beginUs;
+}
+
+bool BootProfiler::isFastBoot() const
+{
+    return fastBoot;
+}
+
+int8_t BootProfiler::slowestStage() const
+{
+    int8_t slowest = -1;
+    for (uint8_t i = 0; i < stageCount; i++)
+    {
+        if (slowest < 0 || stages[i].durationUs > stages[slowest].durationUs)
+        {
+            slowest = i;
+        }
+    }
+    return slowest;
+}
+
+size_t BootProfiler::format(char *buffer, size_t size) const
+{
+    if (!buffer || size == 0)
+    {
+        return 0;
+    }
+
+    size_t used = 0;
+    buffer[0] = '\0';
+    for (uint8_t i = 0; i < stageCount && used < size; i++)
+    {
+        int written = snprintf(buffer + used, size - used, "%s%s %.1f", i ? " | " : "",
+                               stages[i].name, stages[i].durationUs / 1000.0f);
+        if (written < 0)
+        {
+            break;
+        }
+        used += (size_t)written;
+    }
+    if (used < size)
+    {
+        int written = snprintf(buffer + used, size - used, " = %.1f ms", totalUs() / 1000.0f);
+        if (written > 0)
+        {
+            used += (size_t)written;
+        }
+    }
+    return used < size ? used : size - 1;
+}
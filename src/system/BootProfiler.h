@@ -0,0 +1,67 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * ============================================================================
+ * BOOT PROFILER - TIEMPO DE ARRANQUE POR ETAPA
+ * ============================================================================
+ * Mide cuánto tarda cada etapa de setup(): begin() al entrar y mark() al
+ * terminar cada etapa. Cada etapa va desde la marca anterior hasta la
+ * suya, así que la suma de las etapas es el total.
+ *
+ * startUs() es el reloj al llamar a begin(): en el dispositivo (micros())
+ * es lo que pasó desde que arrancó el reloj del sistema hasta setup().
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+class BootProfiler
+{
+public:
+    typedef uint32_t (*ClockFunction)(); // micros() en el dispositivo, reloj simulado en el host
+
+    static const uint8_t MAX_STAGES = 12;
+
+    struct Stage
+    {
+        const char *name; // Literal: no se copia
+        uint32_t startUs; // Desde begin()
+        uint32_t durationUs;
+    };
+
+    explicit BootProfiler(ClockFunction clock);
+
+    // Empieza una medición nueva. fastBoot solo se guarda para el reporte
+    void begin(bool fastBoot);
+
+    // Cierra la etapa en curso; la siguiente empieza ahora. Sin espacio se descarta
+    void mark(const char *name);
+
+    uint8_t getStageCount() const;
+    const Stage &getStage(uint8_t index) const;
+    uint8_t getDroppedStages() const;
+
+    // Suma de las etapas marcadas y reloj al llamar a begin()
+    uint32_t totalUs() const;
+    uint32_t startUs() const;
+    bool isFastBoot() const;
+
+    // Índice de la etapa más larga, o -1 si no hay ninguna
+    int8_t slowestStage() const;
+
+    /**
+     * Resumen en una línea: "hardware 600.3 | managers 3105.0 | ... = 3705.3 ms"
+     * @return Caracteres escritos (sin el terminador)
+     */
+    size_t format(char *buffer, size_t size) const;
+
+private:
+    ClockFunction clock;
+    Stage stages[MAX_STAGES];
+    uint8_t stageCount;
+    uint8_t droppedStages;
+    uint32_t beginUs;
+    uint32_t lastMarkUs;
+    bool fastBoot;
+};
@@ -0,0 +1,250 @@
+#include "EnergyLedger.h"
+#include <string.h>
+
+static const char *CHANNEL_NAMES[EnergyLedger::CHANNELS] = {"GPS", "TX", "RX", "OLED", "Buzzer", "CPU", "Sleep", "Placa"};
+
+EnergyLedger::EnergyLedger(const Config &config)
+    : config(config)
+{
+    start(0);
+}
+
+void EnergyLedger::start(uint32_t now)
+{
+    RtosLock lock(mutex);
+    dayStart = now;
+    memset(activeMs, 0, sizeof(activeMs));
+    memset(nesting, 0, sizeof(nesting));
+    memset(since, 0, sizeof(since));
+    haveLastDay = false;
+    memset(&previous, 0, sizeof(previous));
+    closedMah = 0.0f;
+}
+
+const char *EnergyLedger::getName(uint8_t channel)
+{
+    return channel < CHANNELS ? CHANNEL_NAMES[channel] : "?";
+}
+
+// ============================================================================
+// REGISTRO
+// ============================================================================
+
+void EnergyLedger::begin(Channel channel, uint32_t now)
+{
+    if (channel >= MEASURED)
+    {
+        return;
+    }
+    RtosLock lock(mutex);
+    roll(now);
+    if (nesting[channel] == 0)
+    {
+        since[channel] = now;
+    }
+    if (nesting[channel] < UINT8_MAX)
+    {
+        nesting[channel]++;
+    }
+}
+
+void EnergyLedger::end(Channel channel, uint32_t now)
+{
+    if (channel >= MEASURED)
+    {
+        return;
+    }
+    RtosLock lock(mutex);
+    roll(now);
+    if (nesting[channel] == 0)
+    {
+        return;
+    }
+    if (--nesting[channel] == 0)
+    {
+        activeMs[channel] += now - since[channel];
+    }
+}
+
+void EnergyLedger::add(Channel channel, uint32_t ms, uint32_t now)
+{
+    if (channel >= MEASURED)
+    {
+        return;
+    }
+    RtosLock lock(mutex);
+    roll(now);
+    activeMs[channel] += ms;
+}
+
+void EnergyLedger::roll(uint32_t now)
+{
+    // Cierra los días completos; lo abierto se parte en el borde
+    while (now - dayStart >= DAY_MS)
+    {
+        uint32_t boundary = dayStart + DAY_MS;
+        for (uint8_t i = 0; i < MEASURED; i++)
+        {
+            if (nesting[i] > 0)
+            {
+                activeMs[i] += boundary - since[i];
+                since[i] = boundary;
+            }
+        }
+        previous = build(activeMs, DAY_MS);
+        haveLastDay = true;
+        closedMah += previous.totalMah;
+        memset(activeMs, 0, sizeof(activeMs));
+        dayStart = boundary;
+    }
+}
+
+// ============================================================================
+// REPORTES
+// ============================================================================
+
+float EnergyLedger::awakeMa() const
+{
+    return config.cpuMhz >= 240 ? config.currents.cpuActive240 : config.currents.cpuActive80;
+}
+
+float EnergyLedger::sleepMa() const
+{
+    // Sin light sleep la CPU espera despierta en la tarea idle (DFS a XTAL)
+    return config.lightSleep ? config.currents.lightSleep : config.currents.cpuIdleXtal;
+}
+
+EnergyLedger::Report EnergyLedger::build(const uint32_t active[], uint32_t periodMs) const
+{
+    Report report;
+    memset(&report, 0, sizeof(report));
+    report.periodMs = periodMs;
+    for (uint8_t i = 0; i < MEASURED; i++)
+    {
+        report.activeMs[i] = active[i] < periodMs ? active[i] : periodMs;
+    }
+
+    uint32_t radioOn = report.activeMs[RADIO_TX] + report.activeMs[RADIO_RX];
+    radioOn = radioOn < periodMs ? radioOn : periodMs;
+    report.activeMs[CPU_SLEEP] = periodMs - report.activeMs[CPU_AWAKE];
+    report.activeMs[BOARD] = periodMs;
+
+    const EnergyModel::Currents &currents = config.currents;
+    float current[CHANNELS];
+    current[GPS] = currents.gps;
+    current[RADIO_TX] = currents.radioTx;
+    current[RADIO_RX] = currents.radioRx;
+    current[DISPLAY] = currents.display;
+    current[BUZZER] = currents.buzzer;
+    current[CPU_AWAKE] = awakeMa();
+    current[CPU_SLEEP] = sleepMa();
+    current[BOARD] = currents.board;
+
+    for (uint8_t i = 0; i < CHANNELS; i++)
+    {
+        report.mAh[i] = report.activeMs[i] / 1000.0f * current[i] / 3600.0f;
+    }
+
+    // Lo que consumen apagados la radio y la OLED se cuenta en su canal
+    report.mAh[RADIO_RX] += (periodMs - radioOn) / 1000.0f * currents.radioSleep / 3600.0f;
+    report.mAh[DISPLAY] += (periodMs - report.activeMs[DISPLAY]) / 1000.0f * currents.displaySleep / 3600.0f;
+
+    for (uint8_t i = 0; i < CHANNELS; i++)
+    {
+        report.totalMah += report.mAh[i];
+    }
+    return report;
+}
+
+EnergyLedger::Report EnergyLedger::current(uint32_t now) const
+{
+    uint32_t active[MEASURED];
+    for (uint8_t i = 0; i < MEASURED; i++)
+    {
+        active[i] = activeMs[i] + (nesting[i] > 0 ? now - since[i] : 0);
+    }
+    return build(active, now - dayStart);
+}
+
+EnergyLedger::Report EnergyLedger::today(uint32_t now)
+{
+    RtosLock lock(mutex);
+    roll(now);
+    return current(now);
+}
+
+bool EnergyLedger::hasLastDay() const
+{
+    RtosLock lock(mutex);
+    return haveLastDay;
+}
+
+EnergyLedger::Report EnergyLedger::lastDay() const
+{
+    RtosLock lock(mutex);
+    return previous;
+}
+
+float EnergyLedger::totalMah(uint32_t now)
+{
+    RtosLock lock(mutex);
+    roll(now);
+    return closedMah + current(now).totalMah;
+}
+
+float EnergyLedger::Report::perDay(uint8_t channel) const
+{
+    if (channel >= CHANNELS || periodMs == 0)
+    {
+        return 0.0f;
+    }
+    return mAh[channel] * ((float)DAY_MS / periodMs);
+}
+
+float EnergyLedger::Report::totalPerDay() const
+{
+    return periodMs > 0 ? totalMah * ((float)DAY_MS / periodMs) : 0.0f;
+}
+
+// ============================================================================
+// CONFIGURACIÓN Y UPLINK
+// ============================================================================
+
+void EnergyLedger::setConfig(const Config &newConfig)
+{
+    RtosLock lock(mutex);
+    config = newConfig;
+}
+
+EnergyLedger::Config EnergyLedger::getConfig() const
+{
+    RtosLock lock(mutex);
+    return config;
+}
+
+size_t EnergyLedger::buildSummary(uint8_t *buffer, size_t capacity, uint32_t now)
+{
+    if (buffer == nullptr || capacity < SUMMARY_SIZE)
+    {
+        return 0;
+    }
+
+    Report report;
+    {
+        RtosLock lock(mutex);
+        roll(now);
+        report = haveLastDay ? previous : current(now);
+    }
+
+    uint32_t hours = report.periodMs / 3600000UL;
+    buffer[0] = SUMMARY_TYPE;
+    buffer[1] = hours > UINT8_MAX ? UINT8_MAX : (uint8_t)hours;
+    for (uint8_t i = 0; i < CHANNELS; i++)
+    {
+        float tenths = report.perDay(i) * 10.0f + 0.5f;
+        uint16_t value = tenths >= 65535.0f ? 65535 : (uint16_t)tenths;
+        buffer[2 + 2 * i] = value & 0xFF;
+        buffer[3 + 2 * i] = value >> 8;
+    }
+    return SUMMARY_SIZE;
+}
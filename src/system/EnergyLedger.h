@@ -0,0 +1,118 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "../config/constants.h"
+#include "EnergyModel.h"
+#include "Rtos.h"
+
+/*
+ * ============================================================================
+ * ENERGY LEDGER - CONSUMO MEDIDO POR SUBSISTEMA (mAh/día)
+ * ============================================================================
+ * Lo que EnergyModel estima a partir de un perfil, medido en el collar:
+ * cada subsistema avisa cuándo empieza y termina de consumir (begin/end,
+ * anidables desde varias tareas: cuenta la unión de los intervalos) o suma
+ * una duración ya medida (add). El ledger multiplica los tiempos por las
+ * corrientes de EnergyModel::Currents y reparte el día en:
+ *
+ *   GPS, RADIO_TX, RADIO_RX, DISPLAY, BUZZER, CPU_AWAKE  (medidos)
+ *   CPU_SLEEP = resto del tiempo con la CPU en light sleep (o idle sin él)
+ *   BOARD     = reguladores y fugas, todo el tiempo
+ *
+ * Los días son ventanas de 24 h desde el arranque; al cerrar una se guarda
+ * como lastDay() y la siguiente empieza en cero. today() devuelve lo que va
+ * del día; perDay() lo proyecta a 24 h para comparar.
+ *
+ * Thread-safe. Independiente de Arduino para poder ejecutarse en los tests
+ * nativos.
+ */
+
+class EnergyLedger
+{
+public:
+    static const uint32_t DAY_MS = 86400000UL;
+
+    enum Channel : uint8_t
+    {
+        GPS = 0,
+        RADIO_TX,
+        RADIO_RX,
+        DISPLAY,
+        BUZZER,
+        CPU_AWAKE,
+        CPU_SLEEP, // Derivado: no admite begin/end/add
+        BOARD,     // Derivado
+        CHANNELS
+    };
+    static const uint8_t MEASURED = CPU_SLEEP; // Canales con begin/end/add
+
+    struct Config
+    {
+        EnergyModel::Currents currents;
+        uint16_t cpuMhz;  // Frecuencia con trabajo: corriente de CPU_AWAKE
+        bool lightSleep;  // false: fuera de CPU_AWAKE la CPU espera despierta
+
+        Config() : cpuMhz(LOW_POWER_CPU_MHZ), lightSleep(ENABLE_LIGHT_SLEEP) {}
+    };
+
+    struct Report
+    {
+        uint32_t periodMs;
+        uint32_t activeMs[CHANNELS];
+        float mAh[CHANNELS];
+        float totalMah;
+
+        float perDay(uint8_t channel) const; // mAh proyectados a 24 h
+        float totalPerDay() const;
+    };
+
+    explicit EnergyLedger(const Config &config = Config());
+
+    // Empieza a contar desde now (arranque)
+    void start(uint32_t now);
+
+    void begin(Channel channel, uint32_t now);
+    void end(Channel channel, uint32_t now);
+    void add(Channel channel, uint32_t ms, uint32_t now);
+
+    Report today(uint32_t now);
+    bool hasLastDay() const;
+    Report lastDay() const;
+
+    // mAh desde start() (para el conteo de carga de BatteryEstimator)
+    float totalMah(uint32_t now);
+
+    void setConfig(const Config &config);
+    Config getConfig() const;
+
+    static const char *getName(uint8_t channel);
+
+    /**
+     * Uplink de consumo (LORAWAN_PORT_STATUS, little-endian):
+     *   [0x06][horas medidas(1)][mAh/día x10 (2) por canal, en orden de Channel]
+     * Del último día completo si lo hay; si no, lo que va del día proyectado.
+     * @return Bytes escritos, 0 si no cabe
+     */
+    static const uint8_t SUMMARY_TYPE = 0x06;
+    static const size_t SUMMARY_SIZE = 2 + 2 * CHANNELS;
+    size_t buildSummary(uint8_t *buffer, size_t capacity, uint32_t now);
+
+private:
+    Config config;
+    mutable RtosMutex mutex;
+
+    uint32_t dayStart;
+    uint32_t activeMs[MEASURED];
+    uint8_t nesting[MEASURED];
+    uint32_t since[MEASURED];
+
+    bool haveLastDay;
+    Report previous;
+    float closedMah; // Días ya cerrados
+
+    void roll(uint32_t now);
+    Report current(uint32_t now) const; // Día en curso con lo abierto hasta now
+    Report build(const uint32_t active[], uint32_t periodMs) const;
+    float awakeMa() const;
+    float sleepMa() const;
+};
@@ -0,0 +1,103 @@
+#include "EnergyModel.h"
+#include <math.h>
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+EnergyModel::EnergyModel(const Currents &currents)
+    : currents(currents)
+{
+}
+
+const EnergyModel::Currents &EnergyModel::getCurrents() const
+{
+    return currents;
+}
+
+// ============================================================================
+// ESTIMACIÓN
+// ============================================================================
+
+EnergyModel::Breakdown EnergyModel::estimate(const Profile &profile) const
+{
+    return estimate(profile, SECONDS_PER_DAY);
+}
+
+EnergyModel::Breakdown EnergyModel::estimate(const Profile &profile, float periodSeconds) const
+{
+    Breakdown result = {};
+    const float period = periodSeconds > 0.0f ? periodSeconds : 0.0f;
+    bool fast = profile.cpuMhz >= 240;
+
+    float activeCurrent = fast ? currents.cpuActive240 : currents.cpuActive80;
+    float idleCurrent = profile.dynamicFrequency ? currents.cpuIdleXtal
+                                                 : (fast ? currents.cpuIdle240 : currents.cpuIdle80);
+
+    // Cada despertar cuesta unos ms de CPU (restaurar relojes, arrancar el scheduler)
+    float active = profile.cpuActiveSeconds;
+    if (profile.lightSleep)
+    {
+        active += profile.wakeups * currents.wakeupMs / 1000.0f;
+    }
+    active = fminf(active, period);
+
+    // Sin light sleep el resto del periodo la CPU queda despierta en la tarea idle
+    float idle = profile.lightSleep ? fminf(profile.awakeIdleSeconds, period - active) : period - active;
+    float sleep = period - active - idle;
+
+    result.cpuActiveSeconds = active;
+    result.cpuIdleSeconds = idle;
+    result.cpuSleepSeconds = sleep;
+    result.cpu = (active * activeCurrent + idle * idleCurrent + sleep * currents.lightSleep) / 3600.0f;
+
+    float radioOn = fminf(profile.radioTxSeconds + profile.radioRxSeconds, period);
+    result.radio = (profile.radioTxSeconds * currents.radioTx + profile.radioRxSeconds * currents.radioRx +
+                    (period - radioOn) * currents.radioSleep) /
+                   3600.0f;
+
+    result.gps = fminf(profile.gpsOnSeconds, period) * currents.gps / 3600.0f;
+    float displayOn = fminf(profile.displayOnSeconds, period);
+    result.display = (displayOn * currents.display + (period - displayOn) * currents.displaySleep) / 3600.0f;
+    result.board = period * currents.board / 3600.0f;
+    result.total = result.cpu + result.radio + result.gps + result.display + result.board;
+    return result;
+}
+
+float EnergyModel::runtimeDays(const Breakdown &breakdown, float capacityMah)
+{
+    return breakdown.total > 0.0f ? capacityMah / breakdown.total : 0.0f;
+}
+
+// ============================================================================
+// AIRTIME LORA Y UART
+// ============================================================================
+
+float EnergyModel::loraSymbolMs(uint8_t spreadingFactor, uint16_t bandwidthKhz)
+{
+    return (float)(1UL << spreadingFactor) / (float)bandwidthKhz;
+}
+
+float EnergyModel::loraAirtimeMs(uint8_t spreadingFactor, uint16_t bandwidthKhz, uint8_t payloadBytes,
+                                 uint8_t codingRate, uint8_t preambleSymbols)
+{
+    float symbol = loraSymbolMs(spreadingFactor, bandwidthKhz);
+
+    // Cabecera explícita y CRC activados (uplinks LoRaWAN); LDRO obligatorio con símbolos > 16 ms
+    int lowDataRate = symbol > 16.0f ? 1 : 0;
+    float numerator = 8.0f * payloadBytes - 4.0f * spreadingFactor + 28.0f + 16.0f;
+    float denominator = 4.0f * (spreadingFactor - 2 * lowDataRate);
+    float payloadSymbols = 8.0f + fmaxf(ceilf(numerator / denominator) * (codingRate + 4), 0.0f);
+
+    return (preambleSymbols + 4.25f + payloadSymbols) * symbol;
+}
+
+float EnergyModel::uartBusyFraction(uint32_t bytesPerSecond, uint32_t baudRate)
+{
+    if (baudRate == 0)
+    {
+        return 0.0f;
+    }
+    float fraction = bytesPerSecond * 10.0f / baudRate;
+    return fraction > 1.0f ? 1.0f : fraction;
+}
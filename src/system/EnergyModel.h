@@ -0,0 +1,116 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * ============================================================================
+ * ENERGY MODEL - ESTIMACIÓN DE CONSUMO DIARIO (mAh/día)
+ * ============================================================================
+ * Modelo de corrientes por estado para el collar (Heltec V3 + GPS externo):
+ * se le da un perfil de uso de un día (tiempo de CPU, despertares, airtime
+ * LoRa, GPS y display encendidos) y devuelve el consumo por subsistema.
+ *
+ * Las corrientes por defecto son valores típicos de hoja de datos medidos a
+ * 3,7 V; se pueden reemplazar por mediciones propias.
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+class EnergyModel
+{
+public:
+    static constexpr float SECONDS_PER_DAY = 86400.0f;
+
+    // Corrientes por estado (mA)
+    struct Currents
+    {
+        float cpuActive240;  // Ejecutando a 240 MHz
+        float cpuActive80;   // Ejecutando a 80 MHz
+        float cpuIdle240;    // Despierto sin trabajo (tarea idle) a 240 MHz
+        float cpuIdle80;
+        float cpuIdleXtal;   // Despierto sin trabajo con DFS (XTAL, 40 MHz)
+        float lightSleep;    // ESP32-S3 en light sleep
+        float deepSleep;     // ESP32-S3 en deep sleep con RTC slow memory retenida
+        float wakeupMs;      // Costo de cada despertar, en ms a frecuencia de trabajo
+        float gps;           // Módulo GPS en seguimiento continuo
+        float radioTx;       // SX1262 transmitiendo a +20 dBm
+        float radioRx;
+        float radioSleep;
+        float display;       // OLED encendida (contenido típico)
+        float displaySleep;  // SSD1306 en sleep con la bomba de carga apagada
+        float buzzer;        // Buzzer pasivo sonando (PWM al 50 %)
+        float board;         // Reguladores, divisor de batería, fugas
+
+        Currents() : cpuActive240(40.0f), cpuActive80(22.0f),
+                     cpuIdle240(28.0f), cpuIdle80(15.0f), cpuIdleXtal(12.0f),
+                     lightSleep(0.25f), deepSleep(0.01f), wakeupMs(1.0f),
+                     gps(25.0f), radioTx(118.0f), radioRx(5.3f), radioSleep(0.0016f),
+                     display(10.0f), displaySleep(0.005f), buzzer(30.0f), board(0.5f) {}
+    };
+
+    // Lo que hace el collar en un día
+    struct Profile
+    {
+        uint16_t cpuMhz;          // Frecuencia con trabajo (80 o 240)
+        bool dynamicFrequency;    // DFS: en reposo baja a XTAL
+        bool lightSleep;          // Light sleep automático cuando todo está bloqueado
+        float cpuActiveSeconds;   // Ejecutando tareas
+        float awakeIdleSeconds;   // Despierto sin ejecutar: ráfagas NMEA, RX LoRa, buzzer (solo con light sleep)
+        uint32_t wakeups;         // Despertares desde light sleep
+        float radioTxSeconds;
+        float radioRxSeconds;
+        float gpsOnSeconds;
+        float displayOnSeconds;
+
+        Profile() : cpuMhz(240), dynamicFrequency(false), lightSleep(false),
+                    cpuActiveSeconds(0.0f), awakeIdleSeconds(0.0f), wakeups(0),
+                    radioTxSeconds(0.0f), radioRxSeconds(0.0f),
+                    gpsOnSeconds(SECONDS_PER_DAY), displayOnSeconds(SECONDS_PER_DAY) {}
+    };
+
+    // Consumo por subsistema (mAh/día) y tiempos de CPU resultantes (s/día)
+    struct Breakdown
+    {
+        float cpu;
+        float gps;
+        float radio;
+        float display;
+        float board;
+        float total;
+
+        float cpuActiveSeconds;
+        float cpuIdleSeconds;
+        float cpuSleepSeconds;
+    };
+
+    explicit EnergyModel(const Currents &currents = Currents());
+
+    Breakdown estimate(const Profile &profile) const;
+
+    // Lo mismo para un intervalo de periodSeconds (los tiempos del perfil son
+    // de ese intervalo): consumo en mAh del intervalo, para contar la carga
+    Breakdown estimate(const Profile &profile, float periodSeconds) const;
+
+    // Días de autonomía con una batería de capacityMah
+    static float runtimeDays(const Breakdown &breakdown, float capacityMah);
+
+    /**
+     * Airtime de un paquete LoRa (fórmula de Semtech AN1200.13)
+     * @param payloadBytes PHYPayload completo (en LoRaWAN: FRMPayload + 13)
+     * @param codingRate 1..4 para 4/5..4/8
+     * @return Duración en ms
+     */
+    static float loraAirtimeMs(uint8_t spreadingFactor, uint16_t bandwidthKhz, uint8_t payloadBytes,
+                               uint8_t codingRate = 1, uint8_t preambleSymbols = 8);
+
+    // Duración de un símbolo LoRa en ms
+    static float loraSymbolMs(uint8_t spreadingFactor, uint16_t bandwidthKhz);
+
+    // Fracción del tiempo que la UART está recibiendo (8N1: 10 bits por byte)
+    static float uartBusyFraction(uint32_t bytesPerSecond, uint32_t baudRate);
+
+    const Currents &getCurrents() const;
+
+private:
+    Currents currents;
+};
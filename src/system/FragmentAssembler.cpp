@@ -0,0 +1,196 @@
+#include "FragmentAssembler.h"
+#include <string.h>
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+FragmentAssembler::FragmentAssembler(uint32_t timeoutMs)
+    : payloadLength(0),
+      receivedMask(0),
+      receivedCount(0),
+      expectedCount(0),
+      version(0),
+      expectedCrc(0),
+      startTime(0),
+      timeoutMs(timeoutMs),
+      active(false),
+      hasCompleted(false),
+      completedVersion(0),
+      completedCrc(0)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+// ============================================================================
+// PROCESAMIENTO DE FRAGMENTOS
+// ============================================================================
+
+FragmentAssembler::Status FragmentAssembler::accept(const uint8_t *data, size_t length, uint32_t nowMs)
+{
+    if (data == nullptr || length <= HEADER_SIZE)
+    {
+        stats.invalid++;
+        return FRAGMENT_INVALID;
+    }
+
+    uint8_t fragVersion = data[1];
+    uint8_t index = data[2];
+    uint8_t count = data[3];
+    uint16_t offset = data[4] | (data[5] << 8);
+    uint16_t crc = data[6] | (data[7] << 8);
+    size_t chunk = length - HEADER_SIZE;
+
+    if (count == 0 || count > MAX_FRAGMENTS || index >= count || offset + chunk > MAX_PAYLOAD)
+    {
+        stats.invalid++;
+        return FRAGMENT_INVALID;
+    }
+
+    stats.fragments++;
+
+    // Reenvío de una transferencia que ya se aplicó
+    if (!active && hasCompleted && fragVersion == completedVersion && crc == completedCrc)
+    {
+        stats.duplicates++;
+        return FRAGMENT_DUPLICATE;
+    }
+
+    // Transferencia nueva (o el backend cambió el contenido de la versión)
+    if (!active || fragVersion != version || crc != expectedCrc || count != expectedCount)
+    {
+        if (active)
+        {
+            stats.restarts++;
+        }
+        begin(fragVersion, count, crc, nowMs);
+    }
+
+    uint64_t bit = (uint64_t)1 << index;
+    if (receivedMask & bit)
+    {
+        stats.duplicates++;
+        return FRAGMENT_DUPLICATE;
+    }
+
+    memcpy(&buffer[offset], &data[HEADER_SIZE], chunk);
+    receivedMask |= bit;
+    receivedCount++;
+    if (offset + chunk > payloadLength)
+    {
+        payloadLength = offset + chunk;
+    }
+
+    if (receivedCount < expectedCount)
+    {
+        return FRAGMENT_ACCEPTED;
+    }
+
+    // Todos los fragmentos presentes: verificar el payload completo
+    active = false;
+    if (crc16(buffer, payloadLength) != expectedCrc)
+    {
+        stats.crcErrors++;
+        payloadLength = 0;
+        return FRAGMENT_CRC_ERROR;
+    }
+
+    hasCompleted = true;
+    completedVersion = version;
+    completedCrc = expectedCrc;
+    stats.completed++;
+    return FRAGMENT_COMPLETE;
+}
+
+bool FragmentAssembler::expire(uint32_t nowMs)
+{
+    if (!active || nowMs - startTime < timeoutMs)
+    {
+        return false;
+    }
+    stats.expired++;
+    reset();
+    return true;
+}
+
+void FragmentAssembler::reset()
+{
+    active = false;
+    payloadLength = 0;
+    receivedMask = 0;
+    receivedCount = 0;
+    expectedCount = 0;
+}
+
+// ============================================================================
+// CONSULTAS
+// ============================================================================
+
+const uint8_t *FragmentAssembler::getPayload() const
+{
+    return buffer;
+}
+
+size_t FragmentAssembler::getPayloadLength() const
+{
+    return payloadLength;
+}
+
+bool FragmentAssembler::isActive() const
+{
+    return active;
+}
+
+uint8_t FragmentAssembler::getVersion() const
+{
+    return version;
+}
+
+uint8_t FragmentAssembler::getReceivedCount() const
+{
+    return receivedCount;
+}
+
+uint8_t FragmentAssembler::getExpectedCount() const
+{
+    return expectedCount;
+}
+
+uint64_t FragmentAssembler::getReceivedMask() const
+{
+    return receivedMask;
+}
+
+const FragmentAssembler::Stats &FragmentAssembler::getStats() const
+{
+    return stats;
+}
+
+uint16_t FragmentAssembler::crc16(const uint8_t *data, size_t length)
+{
+    // CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) - igual que binascii.crc_hqx
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// ============================================================================
+// MÉTODOS PRIVADOS
+// ============================================================================
+
+void FragmentAssembler::begin(uint8_t newVersion, uint8_t count, uint16_t crc, uint32_t nowMs)
+{
+    reset();
+    active = true;
+    version = newVersion;
+    expectedCount = count;
+    expectedCrc = crc;
+    startTime = nowMs;
+}
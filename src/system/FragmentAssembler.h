@@ -0,0 +1,100 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * ============================================================================
+ * FRAGMENT ASSEMBLER - REENSAMBLADO DE DOWNLINKS FRAGMENTADOS
+ * ============================================================================
+ * Un downlink LoRaWAN no supera los 51 bytes en DR0, lo que limita una
+ * geocerca a ~10 vértices. El backend divide el comando completo en
+ * fragmentos y este módulo los reensambla en un buffer parcial, tolerando
+ * pérdidas (reenvío de los que faltan), duplicados y desorden.
+ *
+ * Formato de cada fragmento (little-endian):
+ *   [cmd(1)][versión(1)][índice(1)][total(1)][offset(2)][crc16(2)][datos(N)]
+ *
+ * - versión: identifica la transferencia; una versión distinta descarta la
+ *   parcial en curso y empieza de nuevo
+ * - offset: posición de los datos en el payload reensamblado
+ * - crc16: CRC-16/CCITT-FALSE del payload completo, se verifica al final
+ *
+ * El payload solo se entrega (FRAGMENT_COMPLETE) cuando están todos los
+ * fragmentos y el CRC coincide, de modo que el consumidor puede reemplazar
+ * la geocerca activa de forma atómica.
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+class FragmentAssembler
+{
+public:
+    enum Status : uint8_t
+    {
+        FRAGMENT_ACCEPTED = 0, // Guardado, faltan fragmentos
+        FRAGMENT_COMPLETE,     // Payload completo y CRC correcto
+        FRAGMENT_DUPLICATE,    // Ya recibido (o transferencia ya aplicada)
+        FRAGMENT_INVALID,      // Cabecera o tamaño inválidos
+        FRAGMENT_CRC_ERROR     // Todos recibidos pero el CRC no coincide
+    };
+
+    struct Stats
+    {
+        uint32_t fragments;
+        uint32_t duplicates;
+        uint32_t invalid;
+        uint32_t completed;
+        uint32_t crcErrors;
+        uint32_t restarts; // Parciales descartadas por una versión nueva
+        uint32_t expired;  // Parciales descartadas por timeout
+    };
+
+    static const size_t HEADER_SIZE = 8;
+    static const size_t MAX_PAYLOAD = 2304;
+    static const uint8_t MAX_FRAGMENTS = 64;
+
+    explicit FragmentAssembler(uint32_t timeoutMs = 7200000);
+
+    // Procesa un fragmento completo (incluida la cabecera)
+    Status accept(const uint8_t *data, size_t length, uint32_t nowMs);
+
+    // Descarta la parcial si lleva más de timeoutMs sin completarse
+    bool expire(uint32_t nowMs);
+    void reset();
+
+    // Payload reensamblado (válido tras FRAGMENT_COMPLETE hasta el próximo fragmento)
+    const uint8_t *getPayload() const;
+    size_t getPayloadLength() const;
+
+    // Estado de la transferencia en curso
+    bool isActive() const;
+    uint8_t getVersion() const;
+    uint8_t getReceivedCount() const;
+    uint8_t getExpectedCount() const;
+    uint64_t getReceivedMask() const;
+
+    const Stats &getStats() const;
+
+    static uint16_t crc16(const uint8_t *data, size_t length);
+
+private:
+    uint8_t buffer[MAX_PAYLOAD];
+    size_t payloadLength;
+    uint64_t receivedMask;
+    uint8_t receivedCount;
+    uint8_t expectedCount;
+    uint8_t version;
+    uint16_t expectedCrc;
+    uint32_t startTime;
+    uint32_t timeoutMs;
+    bool active;
+
+    // Última transferencia aplicada: sus reenvíos no se vuelven a entregar
+    bool hasCompleted;
+    uint8_t completedVersion;
+    uint16_t completedCrc;
+
+    Stats stats;
+
+    void begin(uint8_t version, uint8_t count, uint16_t crc, uint32_t nowMs);
+};
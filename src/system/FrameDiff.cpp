@@ -0,0 +1,179 @@
+#include "FrameDiff.h"
+#include <string.h>
+
+FrameDiff::FrameDiff()
+    : valid(false),
+      frames(0),
+      skippedFrames(0),
+      bytesSent(0)
+{
+    memset(shadow, 0, sizeof(shadow));
+}
+
+void FrameDiff::invalidate()
+{
+    valid = false;
+}
+
+bool FrameDiff::isValid() const
+{
+    return valid;
+}
+
+// ============================================================================
+// COMPARACIÓN
+// ============================================================================
+
+uint8_t FrameDiff::update(const uint8_t *frame, Region *regions, uint8_t capacity)
+{
+    if (!frame || !regions || capacity == 0)
+    {
+        return 0;
+    }
+
+    uint8_t count = 0;
+    for (uint8_t page = 0; page < PAGES; page++)
+    {
+        const uint8_t *now = frame + page * WIDTH;
+        const uint8_t *shown = shadow + page * WIDTH;
+
+        uint16_t column = 0;
+        while (column < WIDTH)
+        {
+            if (valid && now[column] == shown[column])
+            {
+                column++;
+                continue;
+            }
+
+            // Tramo modificado: se extiende mientras los huecos sean cortos
+            uint8_t first = column;
+            uint8_t last = column;
+            uint8_t gap = 0;
+            for (column++; column < WIDTH; column++)
+            {
+                if (!valid || now[column] != shown[column])
+                {
+                    last = column;
+                    gap = 0;
+                }
+                else if (++gap > MERGE_GAP)
+                {
+                    break;
+                }
+            }
+
+            // Mismas columnas que el tramo de la página anterior (texto de
+            // más de 8 píxeles de alto): un solo rectángulo si sale más barato
+            if (count > 0)
+            {
+                Region &previous = regions[count - 1];
+                if (previous.lastPage + 1 == page)
+                {
+                    Region merged = previous;
+                    merged.lastPage = page;
+                    merged.firstColumn = first < previous.firstColumn ? first : previous.firstColumn;
+                    merged.lastColumn = last > previous.lastColumn ? last : previous.lastColumn;
+                    if (merged.size() <= previous.size() + (size_t)(last - first + 1) + REGION_COMMAND_BYTES)
+                    {
+                        previous = merged;
+                        continue;
+                    }
+                }
+            }
+
+            if (count < capacity)
+            {
+                regions[count++] = {page, page, first, last};
+            }
+            else
+            {
+                // Lista llena: el último rectángulo cubre el resto
+                Region &tail = regions[capacity - 1];
+                tail.lastPage = page;
+                tail.firstColumn = first < tail.firstColumn ? first : tail.firstColumn;
+                tail.lastColumn = last > tail.lastColumn ? last : tail.lastColumn;
+            }
+        }
+    }
+
+    memcpy(shadow, frame, FRAME_SIZE);
+    valid = true;
+
+    frames++;
+    if (count == 0)
+    {
+        skippedFrames++;
+    }
+    bytesSent += i2cBytes(regions, count);
+    return count;
+}
+
+size_t FrameDiff::copyRegion(const uint8_t *frame, const Region &region, size_t offset,
+                             uint8_t *buffer, size_t size)
+{
+    size_t width = region.lastColumn - region.firstColumn + 1;
+    size_t total = region.size();
+    size_t copied = 0;
+
+    while (copied < size && offset < total)
+    {
+        size_t row = offset / width;
+        size_t column = offset % width;
+        size_t length = width - column;
+        if (length > size - copied)
+        {
+            length = size - copied;
+        }
+        memcpy(buffer + copied, frame + (region.firstPage + row) * WIDTH + region.firstColumn + column, length);
+        copied += length;
+        offset += length;
+    }
+    return copied;
+}
+
+// ============================================================================
+// COSTO EN EL BUS
+// ============================================================================
+
+size_t FrameDiff::i2cBytes(const Region *regions, uint8_t count)
+{
+    size_t bytes = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        size_t data = regions[i].size();
+        size_t chunks = (data + DISPLAY_I2C_CHUNK - 1) / DISPLAY_I2C_CHUNK;
+        bytes += REGION_COMMAND_BYTES + data + chunks * CHUNK_OVERHEAD_BYTES;
+    }
+    return bytes;
+}
+
+size_t FrameDiff::fullFrameBytes()
+{
+    Region full = {0, PAGES - 1, 0, WIDTH - 1};
+    return i2cBytes(&full, 1);
+}
+
+uint32_t FrameDiff::transferMicros(size_t bytes, uint32_t clockHz)
+{
+    if (clockHz == 0)
+    {
+        return 0;
+    }
+    return (uint32_t)((uint64_t)bytes * 9 * 1000000 / clockHz);
+}
+
+uint32_t FrameDiff::getFrames() const
+{
+    return frames;
+}
+
+uint32_t FrameDiff::getSkippedFrames() const
+{
+    return skippedFrames;
+}
+
+uint32_t FrameDiff::getBytesSent() const
+{
+    return bytesSent;
+}
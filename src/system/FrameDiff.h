@@ -0,0 +1,99 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "../config/constants.h"
+
+/*
+ * ============================================================================
+ * FRAME DIFF - ZONAS MODIFICADAS DEL FRAMEBUFFER DEL OLED
+ * ============================================================================
+ * El SSD1306 organiza sus 128x64 píxeles en 8 páginas de 128 columnas
+ * (1 byte = 8 píxeles verticales). Mandar el cuadro completo por I2C son
+ * 1024 bytes de datos más el encabezado de cada transacción; casi siempre
+ * cambian unos pocos dígitos.
+ *
+ * FrameDiff guarda una copia de lo que muestra el panel y, por cada cuadro
+ * nuevo, arma la lista de rectángulos (rango de páginas y de columnas) que
+ * cambiaron. Dentro de una página, dos tramos modificados separados por
+ * menos de MERGE_GAP columnas iguales se mandan juntos: direccionar un
+ * tramo nuevo cuesta más que esos bytes. Si los tramos no entran en la
+ * lista, el último se agranda hasta cubrir el resto.
+ *
+ * Cada rectángulo se manda con COLUMNADDR/PAGEADDR en una transacción de
+ * comandos y sus datos, en modo de direccionamiento horizontal, en
+ * transacciones de hasta DISPLAY_I2C_CHUNK bytes. i2cBytes() cuenta los
+ * bytes de ese intercambio (dirección, byte de control y datos) para
+ * comparar con el cuadro completo.
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+class FrameDiff
+{
+public:
+    static const uint8_t WIDTH = DISPLAY_WIDTH;
+    static const uint8_t PAGES = DISPLAY_HEIGHT / 8;
+    static const size_t FRAME_SIZE = (size_t)WIDTH * PAGES;
+
+    // Dirección + control + COLUMNADDR x0 x1 + PAGEADDR p0 p1
+    static const size_t REGION_COMMAND_BYTES = 8;
+    // Dirección + control al comienzo de cada transacción de datos
+    static const size_t CHUNK_OVERHEAD_BYTES = 2;
+    // Columnas iguales que se mandan antes que abrir otro tramo
+    static const uint8_t MERGE_GAP = REGION_COMMAND_BYTES + CHUNK_OVERHEAD_BYTES;
+
+    struct Region
+    {
+        uint8_t firstPage;
+        uint8_t lastPage;
+        uint8_t firstColumn;
+        uint8_t lastColumn;
+
+        size_t size() const
+        {
+            return (size_t)(lastPage - firstPage + 1) * (lastColumn - firstColumn + 1);
+        }
+    };
+
+    FrameDiff();
+
+    // No se sabe qué muestra el panel (inicio, reset): el próximo cuadro va completo
+    void invalidate();
+    bool isValid() const;
+
+    /**
+     * Compara el cuadro con lo que muestra el panel y lo toma como mostrado
+     * @param frame    FRAME_SIZE bytes, página por página
+     * @param regions  Lista de salida
+     * @param capacity Rectángulos que entran en la lista (al menos 1)
+     * @return Rectángulos a mandar (0 = nada cambió)
+     */
+    uint8_t update(const uint8_t *frame, Region *regions, uint8_t capacity);
+
+    /**
+     * Copia los datos de un rectángulo en el orden en que los espera el
+     * panel (fila de páginas por fila), desde el byte offset
+     * @return Bytes copiados (0 al terminar el rectángulo)
+     */
+    static size_t copyRegion(const uint8_t *frame, const Region &region, size_t offset,
+                             uint8_t *buffer, size_t size);
+
+    // Bytes en el bus para mandar los rectángulos
+    static size_t i2cBytes(const Region *regions, uint8_t count);
+    // Bytes en el bus para el cuadro completo
+    static size_t fullFrameBytes();
+    // Tiempo en el bus: 9 bits por byte (8 + ACK)
+    static uint32_t transferMicros(size_t bytes, uint32_t clockHz);
+
+    // Estadísticas desde el arranque
+    uint32_t getFrames() const;
+    uint32_t getSkippedFrames() const; // Cuadros sin cambios: no se mandó nada
+    uint32_t getBytesSent() const;
+
+private:
+    uint8_t shadow[FRAME_SIZE]; // Lo que muestra el panel
+    bool valid;
+    uint32_t frames;
+    uint32_t skippedFrames;
+    uint32_t bytesSent;
+};
@@ -1,5 +1,6 @@
 #include "GeofenceManager.h"
 #include "../core/Logger.h"
+#include "../utils/GeofenceDelta.h"
 
 // ============================================================================
 // CONSTRUCTOR E INICIALIZACIÓN
@@ -7,6 +8,7 @@
 
 GeofenceManager::GeofenceManager() : initialized(false),
                                      active(false),
+                                     activePool(0),
                                      geofenceCount(0),
                                      violationsCount(0),
                                      lastViolationTime(0),
@@ -60,9 +62,12 @@ bool GeofenceManager::isInitialized() const
 // GESTIÓN DE GEOCERCA PRINCIPAL
 // ============================================================================
 
-void GeofenceManager::setGeofence(double centerLat, double centerLng, float radius, const char *name, const char *groupId)
+void GeofenceManager::setGeofence(double centerLat, double centerLng, float radius, const char *name, const char *groupId,
+                                  uint16_t fenceId, uint8_t version)
 {
     Geofence newGeofence(centerLat, centerLng, radius, name, groupId);
+    newGeofence.fenceId = fenceId;
+    newGeofence.version = version;
     setGeofence(newGeofence);
 }
 
@@ -98,16 +103,29 @@ void GeofenceManager::setGeofence(const Geofence &geofence)
     LOG_I("🛡️ Geocerca configurada solo en memoria (no persistente por seguridad)");
 }
 
-void GeofenceManager::setPolygonGeofence(const GeoPoint *points, uint8_t numPoints, const char *name, const char *groupId)
+void GeofenceManager::setPolygonGeofence(const GeoPoint *points, uint16_t numPoints, const char *name, const char *groupId,
+                                         uint16_t fenceId, uint8_t version)
 {
-    if (!isValidPolygonGeofence(points, numPoints))
+    if (!points || !isValidPolygonGeofence(points, numPoints))
     {
         LOG_E("📍 Polígono inválido: %d puntos", numPoints);
         return;
     }
 
-    Geofence polygonGeofence(points, numPoints, name, groupId);
+    // Escribir en el buffer inactivo; el activo sigue en uso hasta el swap
+    uint8_t backPool = activePool ^ 1;
+    memcpy(vertexPool[backPool], points, numPoints * sizeof(GeoPoint));
+
+    Geofence polygonGeofence(vertexPool[backPool], numPoints, name, groupId);
+    polygonGeofence.fenceId = fenceId;
+    polygonGeofence.version = version;
     setGeofence(polygonGeofence);
+
+    // Intercambiar solo si el buffer activo ya no está referenciado
+    if (primaryGeofence.vertices != vertexPool[activePool])
+    {
+        activePool = backPool;
+    }
 }
 
 Geofence GeofenceManager::getGeofence() const
@@ -115,6 +133,88 @@ Geofence GeofenceManager::getGeofence() const
     return primaryGeofence;
 }
 
+// ============================================================================
+// EDICIÓN INCREMENTAL (DELTAS)
+// ============================================================================
+
+Result GeofenceManager::applyDelta(const uint8_t *data, size_t length)
+{
+    GeofenceDelta::Header header;
+    if (!GeofenceDelta::parseHeader(data, length, &header))
+    {
+        LOG_W("✏️ Delta de geocerca mal formado");
+        return Result::ERROR_INVALID_PARAM;
+    }
+
+    // Reintento de un delta ya aplicado (el backend no vio la confirmación)
+    if (primaryGeofence.isConfigured && primaryGeofence.fenceId == header.fenceId &&
+        primaryGeofence.version == header.newVersion)
+    {
+        LOG_D("✏️ Delta v%d ya aplicado", header.newVersion);
+        return Result::SUCCESS;
+    }
+
+    // Sin la versión base exacta el backend debe reenviar la geocerca completa
+    if (!primaryGeofence.isConfigured || header.fenceId == 0 || primaryGeofence.fenceId != header.fenceId ||
+        primaryGeofence.version != header.baseVersion)
+    {
+        LOG_W("✏️ Delta #%d v%d no aplica a geocerca #%d v%d", header.fenceId, header.baseVersion,
+              primaryGeofence.fenceId, primaryGeofence.version);
+        return Result::ERROR_INVALID_PARAM;
+    }
+
+    // Trabajar sobre el buffer inactivo: la geocerca activa sigue intacta si falla
+    Geofence edited = primaryGeofence;
+    uint8_t backPool = activePool ^ 1;
+    if (edited.type == GeofenceType::POLYGON)
+    {
+        memcpy(vertexPool[backPool], primaryGeofence.getPoints(), primaryGeofence.pointCount * sizeof(GeoPoint));
+    }
+
+    if (!GeofenceDelta::apply(data, length, edited, vertexPool[backPool], GEOFENCE_MAX_VERTICES))
+    {
+        LOG_W("✏️ Delta de geocerca inválido, se mantiene v%d", primaryGeofence.version);
+        return Result::ERROR_INVALID_PARAM;
+    }
+
+    if (edited.type == GeofenceType::POLYGON)
+    {
+        // Reconstruir el polígono (puntos internos o externos y centroide)
+        Geofence polygon(vertexPool[backPool], edited.pointCount, edited.name, edited.groupId);
+        polygon.active = edited.active;
+        polygon.fenceId = edited.fenceId;
+        edited = polygon;
+    }
+    edited.version = header.newVersion;
+
+    if (!isValidGeofence(edited))
+    {
+        LOG_W("✏️ Delta produce una geocerca inválida, se mantiene v%d", primaryGeofence.version);
+        return Result::ERROR_INVALID_PARAM;
+    }
+
+    // Solo cambia la geometría: estadísticas, estado dentro/fuera y activación se conservan
+    primaryGeofence = edited;
+    if (primaryGeofence.vertices == vertexPool[backPool])
+    {
+        activePool = backPool;
+    }
+
+    LOG_I("✏️ Geocerca #%d actualizada a v%d (%d puntos)", primaryGeofence.fenceId,
+          primaryGeofence.version, primaryGeofence.pointCount);
+    return Result::SUCCESS;
+}
+
+uint16_t GeofenceManager::getFenceId() const
+{
+    return primaryGeofence.fenceId;
+}
+
+uint8_t GeofenceManager::getFenceVersion() const
+{
+    return primaryGeofence.version;
+}
+
 // ============================================================================
 // CONTROL DE ACTIVACIÓN
 // ============================================================================
@@ -171,6 +271,32 @@ float GeofenceManager::getDistance(const Position &position) const
     return getDistance(position.latitude, position.longitude);
 }
 
+float GeofenceManager::getDistance(const Position &position, float &outwardEast, float &outwardNorth) const
+{
+    outwardEast = 0.0f;
+    outwardNorth = 0.0f;
+    if (!isValidPosition(position))
+        return 999999.0f;
+    if (!isActive())
+        return 0.0f;
+
+    double lat = position.latitude;
+    double lng = position.longitude;
+    if (primaryGeofence.type == GeofenceType::CIRCLE)
+    {
+        circleOutwardNormal(primaryGeofence, lat, lng, outwardEast, outwardNorth);
+        return distanceToCircleBoundary(primaryGeofence, lat, lng);
+    }
+    if (primaryGeofence.pointCount < 3)
+    {
+        return 999999.0f;
+    }
+
+    // Distancia y normal en la misma pasada por los segmentos
+    return distanceToPolygonBoundary(lat, lng, primaryGeofence.getPoints(), primaryGeofence.pointCount,
+                                     &outwardEast, &outwardNorth);
+}
+
 float GeofenceManager::getDistance(double lat, double lng) const
 {
     if (!isActive())
@@ -224,16 +350,16 @@ GeofenceType GeofenceManager::getType() const
 // INFORMACIÓN ESPECÍFICA PARA POLÍGONOS
 // ============================================================================
 
-uint8_t GeofenceManager::getPolygonPointCount() const
+uint16_t GeofenceManager::getPolygonPointCount() const
 {
     return (primaryGeofence.type == GeofenceType::POLYGON) ? primaryGeofence.pointCount : 0;
 }
 
-GeoPoint GeofenceManager::getPolygonPoint(uint8_t index) const
+GeoPoint GeofenceManager::getPolygonPoint(uint16_t index) const
 {
     if (primaryGeofence.type == GeofenceType::POLYGON && index < primaryGeofence.pointCount)
     {
-        return primaryGeofence.points[index];
+        return primaryGeofence.getPoints()[index];
     }
     return GeoPoint();
 }
@@ -275,7 +401,8 @@ Result GeofenceManager::addGeofence(const Geofence &geofence, uint8_t *index)
         return Result::ERROR_NO_MEMORY;
     }
 
-    if (!isValidGeofence(geofence))
+    // Los polígonos grandes solo se soportan como geocerca principal
+    if (!isValidGeofence(geofence) || geofence.vertices)
     {
         return Result::ERROR_INVALID_PARAM;
     }
@@ -320,7 +447,7 @@ Result GeofenceManager::updateGeofence(uint8_t index, const Geofence &geofence)
         return Result::ERROR_INVALID_PARAM;
     }
 
-    if (!isValidGeofence(geofence))
+    if (!isValidGeofence(geofence) || geofence.vertices)
     {
         return Result::ERROR_INVALID_PARAM;
     }
@@ -544,7 +671,7 @@ bool GeofenceManager::isValidCoordinate(double lat, double lng)
 // ALGORITMOS PARA POLÍGONOS - IMPLEMENTACIÓN RAY-CASTING
 // ============================================================================
 
-bool GeofenceManager::isPointInPolygon(double lat, double lng, const GeoPoint *points, uint8_t numPoints)
+bool GeofenceManager::isPointInPolygon(double lat, double lng, const GeoPoint *points, uint16_t numPoints)
 {
     if (numPoints < 3)
         return false;
@@ -552,7 +679,7 @@ bool GeofenceManager::isPointInPolygon(double lat, double lng, const GeoPoint *p
     bool inside = false;
 
     // Algoritmo Ray-casting
-    for (uint8_t i = 0, j = numPoints - 1; i < numPoints; j = i++)
+    for (uint16_t i = 0, j = numPoints - 1; i < numPoints; j = i++)
     {
         if (((points[i].lat > lat) != (points[j].lat > lat)) &&
             (lng < (points[j].lng - points[i].lng) * (lat - points[i].lat) / (points[j].lat - points[i].lat) + points[i].lng))
@@ -564,35 +691,57 @@ bool GeofenceManager::isPointInPolygon(double lat, double lng, const GeoPoint *p
     return inside;
 }
 
-float GeofenceManager::distanceToPolygonBoundary(double lat, double lng, const GeoPoint *points, uint8_t numPoints)
+float GeofenceManager::distanceToPolygonBoundary(double lat, double lng, const GeoPoint *points, uint16_t numPoints,
+                                                 float *outwardEast, float *outwardNorth)
 {
     if (numPoints < 3)
         return 999999.0f;
 
     float minDistance = 999999.0f;
+    float nearestEast = 0.0f;
+    float nearestNorth = 0.0f;
 
     // Calcular distancia a cada segmento del polígono
-    for (uint8_t i = 0; i < numPoints; i++)
+    for (uint16_t i = 0; i < numPoints; i++)
     {
-        uint8_t j = (i + 1) % numPoints;
-        float segmentDistance = distanceToLineSegment(lat, lng, points[i], points[j]);
+        uint16_t j = (i + 1) % numPoints;
+        float offsetEast, offsetNorth;
+        float segmentDistance = distanceToLineSegment(lat, lng, points[i], points[j], &offsetEast, &offsetNorth);
 
         if (segmentDistance < minDistance)
         {
             minDistance = segmentDistance;
+            nearestEast = offsetEast;
+            nearestNorth = offsetNorth;
         }
     }
 
     // Si está dentro del polígono, la distancia es negativa
-    if (isPointInPolygon(lat, lng, points, numPoints))
+    bool inside = isPointInPolygon(lat, lng, points, numPoints);
+    if (inside)
     {
         minDistance = -minDistance;
     }
 
+    // Normal hacia afuera: del borde hacia la posición si está fuera, al revés si está dentro
+    if (outwardEast && outwardNorth)
+    {
+        *outwardEast = 0.0f;
+        *outwardNorth = 0.0f;
+        float length = sqrtf(nearestEast * nearestEast + nearestNorth * nearestNorth);
+        if (length > 0.01f)
+        {
+            float sign = inside ? -1.0f : 1.0f;
+            *outwardEast = sign * nearestEast / length;
+            *outwardNorth = sign * nearestNorth / length;
+        }
+    }
+
     return minDistance;
 }
 
-float GeofenceManager::distanceToLineSegment(double lat, double lng, const GeoPoint &p1, const GeoPoint &p2)
+float GeofenceManager::distanceToLineSegment(double lat, double lng, const GeoPoint &p1, const GeoPoint &p2,
+                                             float *offsetEast, float *offsetNorth)
 {
     // Convertir a metros usando proyección plana local (válida para distancias cortas)
     double lat0 = (p1.lat + p2.lat) / 2.0;
@@ -614,6 +763,11 @@ float GeofenceManager::distanceToLineSegment(double lat, double lng, const GeoPo
     if (lenSq < 1e-6)
     {
         // Segmento degenerado
+        if (offsetEast && offsetNorth)
+        {
+            *offsetEast = (float)A;
+            *offsetNorth = (float)B;
+        }
         return sqrt(A * A + B * B);
     }
 
@@ -639,6 +793,11 @@ float GeofenceManager::distanceToLineSegment(double lat, double lng, const GeoPo
 
     double dx = x - xx;
     double dy = y - yy;
+    if (offsetEast && offsetNorth)
+    {
+        *offsetEast = (float)dx;
+        *offsetNorth = (float)dy;
+    }
 
     return sqrt(dx * dx + dy * dy);
 }
@@ -704,19 +863,19 @@ bool GeofenceManager::isValidGeofence(const Geofence &geofence) const
     }
     else
     {
-        return isValidPolygonGeofence(geofence.points, geofence.pointCount);
+        return isValidPolygonGeofence(geofence.getPoints(), geofence.pointCount);
     }
 }
 
-bool GeofenceManager::isValidPolygonGeofence(const GeoPoint *points, uint8_t numPoints) const
+bool GeofenceManager::isValidPolygonGeofence(const GeoPoint *points, uint16_t numPoints) const
 {
-    if (numPoints < 3 || numPoints > 10)
-    { // MAX_POLYGON_POINTS = 10
+    if (numPoints < 3 || numPoints > GEOFENCE_MAX_VERTICES)
+    {
         return false;
     }
 
     // Verificar que todos los puntos sean coordenadas válidas
-    for (uint8_t i = 0; i < numPoints; i++)
+    for (uint16_t i = 0; i < numPoints; i++)
     {
         if (!isValidCoordinate(points[i].lat, points[i].lng))
         {
@@ -727,9 +886,9 @@ bool GeofenceManager::isValidPolygonGeofence(const GeoPoint *points, uint8_t num
     // Verificar que el polígono no sea degenerado (área > 0)
     // Cálculo simplificado del área usando fórmula del zapato
     double area = 0.0;
-    for (uint8_t i = 0; i < numPoints; i++)
+    for (uint16_t i = 0; i < numPoints; i++)
     {
-        uint8_t j = (i + 1) % numPoints;
+        uint16_t j = (i + 1) % numPoints;
         area += (points[j].lng - points[i].lng) * (points[j].lat + points[i].lat);
     }
     area = abs(area) / 2.0;
@@ -753,6 +912,22 @@ float GeofenceManager::distanceToCircleBoundary(const Geofence &geofence, double
     return distanceToCenter - geofence.radius;
 }
 
+void GeofenceManager::circleOutwardNormal(const Geofence &geofence, double lat, double lng, float &east, float &north) const
+{
+    // Radial desde el centro (proyección plana local, como los segmentos)
+    double x = (lng - geofence.centerLng) * cos(geofence.centerLat * DEG_TO_RAD) * 111320.0;
+    double y = (lat - geofence.centerLat) * 110540.0;
+    double length = sqrt(x * x + y * y);
+
+    east = 0.0f;
+    north = 0.0f;
+    if (length > 0.01)
+    {
+        east = (float)(x / length);
+        north = (float)(y / length);
+    }
+}
+
 bool GeofenceManager::isPositionInsideCircle(const Geofence &geofence, double lat, double lng) const
 {
     if (!geofence.active)
@@ -773,7 +948,7 @@ float GeofenceManager::distanceToPolygonBoundaryInternal(const Geofence &geofenc
         return 999999.0f;
     }
 
-    return distanceToPolygonBoundary(lat, lng, geofence.points, geofence.pointCount);
+    return distanceToPolygonBoundary(lat, lng, geofence.getPoints(), geofence.pointCount);
 }
 
 bool GeofenceManager::isPositionInsidePolygon(const Geofence &geofence, double lat, double lng) const
@@ -783,5 +958,5 @@ bool GeofenceManager::isPositionInsidePolygon(const Geofence &geofence, double l
         return true;
     }
 
-    return isPointInPolygon(lat, lng, geofence.points, geofence.pointCount);
+    return isPointInPolygon(lat, lng, geofence.getPoints(), geofence.pointCount);
 }
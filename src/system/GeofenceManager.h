@@ -20,11 +20,20 @@ public:
     bool isInitialized() const;
 
     // Gestión de geocerca principal
-    void setGeofence(double centerLat, double centerLng, float radius, const char *name = "Principal", const char *groupId = "none");
+    void setGeofence(double centerLat, double centerLng, float radius, const char *name = "Principal", const char *groupId = "none",
+                     uint16_t fenceId = 0, uint8_t version = 0);
     void setGeofence(const Geofence &geofence);
-    void setPolygonGeofence(const GeoPoint *points, uint8_t numPoints, const char *name = "Polygon", const char *groupId = "none");
+    // Copia los vértices al buffer inactivo y lo intercambia solo si el polígono es válido
+    void setPolygonGeofence(const GeoPoint *points, uint16_t numPoints, const char *name = "Polygon", const char *groupId = "none",
+                            uint16_t fenceId = 0, uint8_t version = 0);
     Geofence getGeofence() const;
 
+    // Edición incremental (GEOFENCE_CMD_DELTA) sobre la geocerca activa.
+    // Exige mismo fenceId y versión base; no reinicia estadísticas ni estado.
+    Result applyDelta(const uint8_t *data, size_t length);
+    uint16_t getFenceId() const;
+    uint8_t getFenceVersion() const;
+
     // Control de activación
     void activate(bool enabled);
     bool isActive() const;
@@ -34,6 +43,9 @@ public:
     bool isInsideGeofence(double lat, double lng) const;
     float getDistance(const Position &position) const;
     float getDistance(double lat, double lng) const;
+    // Además la normal unitaria hacia afuera en el punto más cercano del borde
+    // (este, norte), para ApproachPredictor. (0, 0) si no está definida
+    float getDistance(const Position &position, float &outwardEast, float &outwardNorth) const;
 
     // Información de la geocerca
     double getCenterLat() const;
@@ -44,8 +56,8 @@ public:
     GeofenceType getType() const;
 
     // Para polígonos
-    uint8_t getPolygonPointCount() const;
-    GeoPoint getPolygonPoint(uint8_t index) const;
+    uint16_t getPolygonPointCount() const;
+    GeoPoint getPolygonPoint(uint16_t index) const;
     bool hasValidPolygon() const;
 
     // Análisis y estadísticas
@@ -89,9 +101,12 @@ public:
     static bool isValidCoordinate(double lat, double lng);
 
     // NUEVO: Algoritmos para polígonos
-    static bool isPointInPolygon(double lat, double lng, const GeoPoint *points, uint8_t numPoints);
-    static float distanceToPolygonBoundary(double lat, double lng, const GeoPoint *points, uint8_t numPoints);
-    static float distanceToLineSegment(double lat, double lng, const GeoPoint &p1, const GeoPoint &p2);
+    static bool isPointInPolygon(double lat, double lng, const GeoPoint *points, uint16_t numPoints);
+    static float distanceToPolygonBoundary(double lat, double lng, const GeoPoint *points, uint16_t numPoints,
+                                           float *outwardEast = nullptr, float *outwardNorth = nullptr);
+    // offsetEast/offsetNorth: vector en metros del punto más cercano del segmento a la posición
+    static float distanceToLineSegment(double lat, double lng, const GeoPoint &p1, const GeoPoint &p2,
+                                       float *offsetEast = nullptr, float *offsetNorth = nullptr);
 
 private:
     bool initialized;
@@ -100,6 +115,11 @@ private:
     Geofence primaryGeofence;
     bool active;
 
+    // Doble buffer de vértices para polígonos grandes: se escribe el inactivo
+    // y se intercambia al final, la geocerca activa nunca queda a medias
+    GeoPoint vertexPool[2][GEOFENCE_MAX_VERTICES];
+    uint8_t activePool;
+
     // Array de geocercas múltiples (para expansión futura)
     Geofence geofences[MAX_GEOFENCES];
     bool geofenceActive[MAX_GEOFENCES];
@@ -130,10 +150,11 @@ private:
 
     // Validación
     bool isValidGeofence(const Geofence &geofence) const;
-    bool isValidPolygonGeofence(const GeoPoint *points, uint8_t numPoints) const;
+    bool isValidPolygonGeofence(const GeoPoint *points, uint16_t numPoints) const;
 
     // Utilidades internas - círculos
     float distanceToCircleBoundary(const Geofence &geofence, double lat, double lng) const;
+    void circleOutwardNormal(const Geofence &geofence, double lat, double lng, float &east, float &north) const;
     bool isPositionInsideCircle(const Geofence &geofence, double lat, double lng) const;
 
     // Utilidades internas - polígonos
@@ -0,0 +1,297 @@
+#include "LinkQuality.h"
+#include <string.h>
+
+// Peso de cada muestra nueva en la media móvil
+static const float EWMA_ALPHA = 0.125f;
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+LinkQuality::LinkQuality()
+{
+    reset();
+}
+
+void LinkQuality::reset()
+{
+    memset(rssiBins, 0, sizeof(rssiBins));
+    memset(snrBins, 0, sizeof(snrBins));
+    memset(dataRates, 0, sizeof(dataRates));
+    histogramSamples = 0;
+    uplinks = 0;
+    failures = 0;
+    retransmissions = 0;
+    downlinks = 0;
+    lastRssi = 0.0f;
+    lastSnr = 0.0f;
+    averageRssi = 0.0f;
+    averageSnr = 0.0f;
+    lastDownlinkTime = 0;
+}
+
+// ============================================================================
+// REGISTRO DE MUESTRAS
+// ============================================================================
+
+void LinkQuality::recordUplink(uint8_t dataRate, bool success, uint8_t retries)
+{
+    uplinks++;
+    retransmissions += retries;
+    if (!success)
+    {
+        failures++;
+    }
+
+    if (dataRate >= MAX_DATA_RATES)
+    {
+        return;
+    }
+
+    DataRateStats &stats = dataRates[dataRate];
+    if (stats.attempts >= WINDOW)
+    {
+        ageDataRate(stats);
+    }
+    stats.attempts++;
+    stats.retransmissions += retries;
+    if (success)
+    {
+        stats.successes++;
+    }
+}
+
+void LinkQuality::recordDownlink(float rssi, float snr, uint32_t nowMs)
+{
+    if (histogramSamples >= WINDOW)
+    {
+        ageHistograms();
+    }
+
+    // Bins de 10 dBm desde -120 y de 5 dB desde -15; extremos abiertos
+    int16_t rssiBin = rssi < -120.0f ? 0 : (int16_t)((rssi + 120.0f) / 10.0f) + 1;
+    int16_t snrBin = snr < -15.0f ? 0 : (int16_t)((snr + 15.0f) / 5.0f) + 1;
+    rssiBins[rssiBin >= RSSI_BINS ? RSSI_BINS - 1 : rssiBin]++;
+    snrBins[snrBin >= SNR_BINS ? SNR_BINS - 1 : snrBin]++;
+    histogramSamples++;
+
+    if (downlinks == 0)
+    {
+        averageRssi = rssi;
+        averageSnr = snr;
+    }
+    else
+    {
+        averageRssi += EWMA_ALPHA * (rssi - averageRssi);
+        averageSnr += EWMA_ALPHA * (snr - averageSnr);
+    }
+
+    downlinks++;
+    lastRssi = rssi;
+    lastSnr = snr;
+    lastDownlinkTime = nowMs;
+}
+
+void LinkQuality::ageHistograms()
+{
+    histogramSamples = 0;
+    for (uint8_t i = 0; i < RSSI_BINS; i++)
+    {
+        rssiBins[i] /= 2;
+        histogramSamples += rssiBins[i];
+    }
+    for (uint8_t i = 0; i < SNR_BINS; i++)
+    {
+        snrBins[i] /= 2;
+    }
+}
+
+void LinkQuality::ageDataRate(DataRateStats &stats)
+{
+    stats.attempts /= 2;
+    stats.successes /= 2;
+    stats.retransmissions /= 2;
+}
+
+// ============================================================================
+// CONSULTAS
+// ============================================================================
+
+uint16_t LinkQuality::getRssiBin(uint8_t bin) const
+{
+    return bin < RSSI_BINS ? rssiBins[bin] : 0;
+}
+
+uint16_t LinkQuality::getSnrBin(uint8_t bin) const
+{
+    return bin < SNR_BINS ? snrBins[bin] : 0;
+}
+
+int16_t LinkQuality::rssiBinFloor(uint8_t bin)
+{
+    return bin == 0 ? -32768 : -120 + (bin - 1) * 10;
+}
+
+int8_t LinkQuality::snrBinFloor(uint8_t bin)
+{
+    return bin == 0 ? -128 : -15 + (bin - 1) * 5;
+}
+
+const LinkQuality::DataRateStats &LinkQuality::getDataRateStats(uint8_t dataRate) const
+{
+    return dataRates[dataRate < MAX_DATA_RATES ? dataRate : 0];
+}
+
+uint8_t LinkQuality::getSuccessPercent(uint8_t dataRate) const
+{
+    if (dataRate >= MAX_DATA_RATES || dataRates[dataRate].attempts == 0)
+    {
+        return 0xFF;
+    }
+    return (uint8_t)((dataRates[dataRate].successes * 100U) / dataRates[dataRate].attempts);
+}
+
+uint32_t LinkQuality::getUplinks() const
+{
+    return uplinks;
+}
+
+uint32_t LinkQuality::getFailures() const
+{
+    return failures;
+}
+
+uint32_t LinkQuality::getRetransmissions() const
+{
+    return retransmissions;
+}
+
+uint32_t LinkQuality::getDownlinks() const
+{
+    return downlinks;
+}
+
+bool LinkQuality::hasDownlink() const
+{
+    return downlinks > 0;
+}
+
+float LinkQuality::getLastRssi() const
+{
+    return lastRssi;
+}
+
+float LinkQuality::getLastSnr() const
+{
+    return lastSnr;
+}
+
+float LinkQuality::getAverageRssi() const
+{
+    return averageRssi;
+}
+
+float LinkQuality::getAverageSnr() const
+{
+    return averageSnr;
+}
+
+uint32_t LinkQuality::getTimeSinceDownlink(uint32_t nowMs) const
+{
+    if (downlinks == 0)
+    {
+        return UINT32_MAX;
+    }
+    return nowMs - lastDownlinkTime;
+}
+
+// ============================================================================
+// UPLINK DE ESTADO
+// ============================================================================
+
+int8_t LinkQuality::clampInt8(float value)
+{
+    if (value > 127.0f)
+    {
+        return 127;
+    }
+    if (value < -128.0f)
+    {
+        return -128;
+    }
+    return (int8_t)(value < 0 ? value - 0.5f : value + 0.5f);
+}
+
+void LinkQuality::packHistogram(uint8_t *out, const uint16_t *bins, uint8_t count)
+{
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        total += bins[i];
+    }
+
+    // Dos bins por byte (nibble bajo = bin par); proporción redondeada a 0-15
+    for (uint8_t i = 0; i < count; i += 2)
+    {
+        uint8_t lo = total ? (uint8_t)((bins[i] * 15U + total / 2) / total) : 0;
+        uint8_t hi = total ? (uint8_t)((bins[i + 1] * 15U + total / 2) / total) : 0;
+        out[i / 2] = lo | (hi << 4);
+    }
+}
+
+size_t LinkQuality::buildSummary(uint8_t *buffer, size_t capacity, uint32_t nowMs) const
+{
+    uint16_t dataRateMask = 0;
+    uint8_t dataRateCount = 0;
+    for (uint8_t dr = 0; dr < MAX_DATA_RATES; dr++)
+    {
+        if (dataRates[dr].attempts > 0)
+        {
+            dataRateMask |= 1 << dr;
+            dataRateCount++;
+        }
+    }
+
+    if (capacity < SUMMARY_FIXED_SIZE + dataRateCount)
+    {
+        return 0;
+    }
+
+    size_t index = 0;
+    buffer[index++] = SUMMARY_TYPE;
+    buffer[index++] = (uint8_t)clampInt8(hasDownlink() ? averageRssi : -128.0f);
+    buffer[index++] = (uint8_t)clampInt8(averageSnr * 4.0f);
+
+    packHistogram(&buffer[index], rssiBins, RSSI_BINS);
+    index += RSSI_BINS / 2;
+    packHistogram(&buffer[index], snrBins, SNR_BINS);
+    index += SNR_BINS / 2;
+
+    uint16_t fields[4] = {
+        (uint16_t)(uplinks > 0xFFFF ? 0xFFFF : uplinks),
+        (uint16_t)(failures > 0xFFFF ? 0xFFFF : failures),
+        (uint16_t)(retransmissions > 0xFFFF ? 0xFFFF : retransmissions),
+        0xFFFF};
+    uint32_t sinceDownlink = getTimeSinceDownlink(nowMs);
+    if (sinceDownlink != UINT32_MAX && sinceDownlink / 60000 < 0xFFFF)
+    {
+        fields[3] = (uint16_t)(sinceDownlink / 60000);
+    }
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        buffer[index++] = fields[i] & 0xFF;
+        buffer[index++] = fields[i] >> 8;
+    }
+
+    buffer[index++] = dataRateMask & 0xFF;
+    buffer[index++] = dataRateMask >> 8;
+    for (uint8_t dr = 0; dr < MAX_DATA_RATES; dr++)
+    {
+        if (dataRateMask & (1 << dr))
+        {
+            buffer[index++] = getSuccessPercent(dr);
+        }
+    }
+
+    return index;
+}
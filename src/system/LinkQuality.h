@@ -0,0 +1,112 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * ============================================================================
+ * LINK QUALITY - ESTADÍSTICAS DEL ENLACE LORAWAN
+ * ============================================================================
+ * Acumula, con ventana deslizante, la calidad del enlace del collar:
+ *
+ * - Histogramas de RSSI y SNR de los downlinks recibidos (el collar solo
+ *   puede medir la señal del gateway; la del uplink la ve el servidor)
+ * - Intentos, éxitos y retransmisiones por data rate
+ * - Tiempo desde el último downlink
+ *
+ * La ventana es por envejecimiento: al llegar a WINDOW muestras se dividen
+ * todos los contadores por dos, así el estado refleja las últimas horas sin
+ * guardar cada muestra.
+ *
+ * buildSummary() genera el uplink de estado (LORAWAN_PORT_STATUS) usado para
+ * decidir la ubicación de gateways y el data rate de cada piño.
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+class LinkQuality
+{
+public:
+    static const uint8_t RSSI_BINS = 8;      // <-120, -120..-110, ... , >=-60 dBm
+    static const uint8_t SNR_BINS = 8;       // <-15, -15..-10, ... , >=15 dB
+    static const uint8_t MAX_DATA_RATES = 16; // AU915 DR0..DR13
+    static const uint16_t WINDOW = 128;      // Muestras antes de envejecer
+
+    static const uint8_t SUMMARY_TYPE = 0x03;
+    static const size_t SUMMARY_FIXED_SIZE = 21;
+    static const size_t SUMMARY_MAX_SIZE = SUMMARY_FIXED_SIZE + MAX_DATA_RATES;
+
+    struct DataRateStats
+    {
+        uint16_t attempts;        // Uplinks (sin contar retransmisiones)
+        uint16_t successes;
+        uint16_t retransmissions;
+    };
+
+    LinkQuality();
+
+    // Resultado de cada uplink: data rate usado, si salió y cuántas veces se reintentó
+    void recordUplink(uint8_t dataRate, bool success, uint8_t retransmissions);
+
+    // Downlink recibido (incluye ACK/MAC sin payload de aplicación)
+    void recordDownlink(float rssi, float snr, uint32_t nowMs);
+
+    // Histogramas (valores envejecidos)
+    uint16_t getRssiBin(uint8_t bin) const;
+    uint16_t getSnrBin(uint8_t bin) const;
+    static int16_t rssiBinFloor(uint8_t bin);
+    static int8_t snrBinFloor(uint8_t bin);
+
+    // Por data rate. Porcentaje de éxito 0-100, 0xFF si no hay intentos
+    const DataRateStats &getDataRateStats(uint8_t dataRate) const;
+    uint8_t getSuccessPercent(uint8_t dataRate) const;
+
+    // Totales desde el arranque (sin envejecer)
+    uint32_t getUplinks() const;
+    uint32_t getFailures() const;
+    uint32_t getRetransmissions() const;
+    uint32_t getDownlinks() const;
+
+    // Última muestra y media móvil (EWMA) de los downlinks
+    bool hasDownlink() const;
+    float getLastRssi() const;
+    float getLastSnr() const;
+    float getAverageRssi() const;
+    float getAverageSnr() const;
+
+    // UINT32_MAX si aún no llega ningún downlink
+    uint32_t getTimeSinceDownlink(uint32_t nowMs) const;
+
+    /**
+     * Uplink de estado del enlace (little-endian):
+     *   [0x03][RSSI medio(1)][SNR medio x4(1)][hist RSSI 8x4 bits(4)][hist SNR 8x4 bits(4)]
+     *   [uplinks(2)][fallas(2)][retransmisiones(2)][min desde downlink(2)]
+     *   [máscara DR(2)][% éxito por cada DR de la máscara(1)...]
+     * Histogramas como proporción 0-15 del total; 0xFFFF minutos = nunca.
+     * @return Bytes escritos, 0 si no cabe
+     */
+    size_t buildSummary(uint8_t *buffer, size_t capacity, uint32_t nowMs) const;
+
+    void reset();
+
+private:
+    uint16_t rssiBins[RSSI_BINS];
+    uint16_t snrBins[SNR_BINS];
+    uint16_t histogramSamples;
+    DataRateStats dataRates[MAX_DATA_RATES];
+
+    uint32_t uplinks;
+    uint32_t failures;
+    uint32_t retransmissions;
+    uint32_t downlinks;
+
+    float lastRssi;
+    float lastSnr;
+    float averageRssi;
+    float averageSnr;
+    uint32_t lastDownlinkTime;
+
+    void ageHistograms();
+    static void ageDataRate(DataRateStats &stats);
+    static void packHistogram(uint8_t *out, const uint16_t *bins, uint8_t count);
+    static int8_t clampInt8(float value);
+};
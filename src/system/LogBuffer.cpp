@@ -0,0 +1,537 @@
+#include "LogBuffer.h"
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// ESPECIFICADORES DE FORMATO
+// ============================================================================
+
+namespace
+{
+    enum ArgType : uint8_t
+    {
+        ARG_INVALID, // No soportado: se corta el mensaje
+        ARG_PERCENT, // %%: sin argumento
+        ARG_INT,
+        ARG_LONG,
+        ARG_LONG_LONG,
+        ARG_SIZE,
+        ARG_INTMAX,
+        ARG_PTRDIFF,
+        ARG_DOUBLE,
+        ARG_LONG_DOUBLE,
+        ARG_POINTER,
+        ARG_STRING,
+        ARG_COUNT // %n: se consume y no se escribe
+    };
+
+    struct Spec
+    {
+        const char *start; // En el '%'
+        size_t length;
+        uint8_t stars; // Ancho y/o precisión pasados como argumento
+        ArgType type;
+    };
+
+    bool isDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    // Interpreta el especificador que empieza en '%' y devuelve el resto del formato
+    const char *parseSpec(const char *p, Spec &spec)
+    {
+        spec.start = p;
+        spec.stars = 0;
+        spec.type = ARG_INVALID;
+        p++;
+
+        while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+        {
+            p++;
+        }
+        if (*p == '*')
+        {
+            spec.stars++;
+            p++;
+        }
+        while (isDigit(*p))
+        {
+            p++;
+        }
+        if (*p == '.')
+        {
+            p++;
+            if (*p == '*')
+            {
+                spec.stars++;
+                p++;
+            }
+            while (isDigit(*p))
+            {
+                p++;
+            }
+        }
+
+        ArgType integer = ARG_INT;
+        ArgType floating = ARG_DOUBLE;
+        bool wide = false;
+        switch (*p)
+        {
+        case 'h':
+            p += (p[1] == 'h') ? 2 : 1; // Promocionado a int
+            break;
+        case 'l':
+            if (p[1] == 'l')
+            {
+                integer = ARG_LONG_LONG;
+                p += 2;
+            }
+            else
+            {
+                integer = ARG_LONG;
+                wide = true;
+                p++;
+            }
+            break;
+        case 'z':
+            integer = ARG_SIZE;
+            p++;
+            break;
+        case 'j':
+            integer = ARG_INTMAX;
+            p++;
+            break;
+        case 't':
+            integer = ARG_PTRDIFF;
+            p++;
+            break;
+        case 'L':
+            floating = ARG_LONG_DOUBLE;
+            p++;
+            break;
+        }
+
+        switch (*p)
+        {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            spec.type = integer;
+            break;
+        case 'c':
+            spec.type = ARG_INT;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            spec.type = floating;
+            break;
+        case 's':
+            spec.type = wide ? ARG_INVALID : ARG_STRING;
+            break;
+        case 'p':
+            spec.type = ARG_POINTER;
+            break;
+        case 'n':
+            spec.type = ARG_COUNT;
+            break;
+        case '%':
+            spec.type = (p == spec.start + 1) ? ARG_PERCENT : ARG_INVALID;
+            break;
+        default:
+            spec.length = p - spec.start;
+            return *p ? p + 1 : p;
+        }
+
+        p++;
+        spec.length = p - spec.start;
+        return p;
+    }
+
+    // ========================================================================
+    // EMPAQUETADO DE ARGUMENTOS
+    // ========================================================================
+
+    template <typename T>
+    bool put(LogBuffer::Record &record, const T &value)
+    {
+        if (record.argsLength + sizeof(T) > LogBuffer::ARGS_SIZE)
+        {
+            return false;
+        }
+        memcpy(&record.args[record.argsLength], &value, sizeof(T));
+        record.argsLength += sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    bool get(const LogBuffer::Record &record, size_t &offset, T &value)
+    {
+        if (offset + sizeof(T) > record.argsLength)
+        {
+            return false;
+        }
+        memcpy(&value, &record.args[offset], sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool putString(LogBuffer::Record &record, const char *text)
+    {
+        if (!text)
+        {
+            text = "(null)";
+        }
+        size_t room = LogBuffer::ARGS_SIZE - record.argsLength;
+        if (room == 0)
+        {
+            return false;
+        }
+
+        size_t length = strlen(text);
+        bool fits = length < room;
+        if (!fits)
+        {
+            length = room - 1;
+        }
+        memcpy(&record.args[record.argsLength], text, length);
+        record.args[record.argsLength + length] = '\0';
+        record.argsLength += length + 1;
+        return fits;
+    }
+
+    bool captureValue(LogBuffer::Record &record, ArgType type, va_list &args)
+    {
+        switch (type)
+        {
+        case ARG_INT:
+            return put(record, va_arg(args, int));
+        case ARG_LONG:
+            return put(record, va_arg(args, long));
+        case ARG_LONG_LONG:
+            return put(record, va_arg(args, long long));
+        case ARG_SIZE:
+            return put(record, va_arg(args, size_t));
+        case ARG_INTMAX:
+            return put(record, va_arg(args, intmax_t));
+        case ARG_PTRDIFF:
+            return put(record, va_arg(args, ptrdiff_t));
+        case ARG_DOUBLE:
+            return put(record, va_arg(args, double));
+        case ARG_LONG_DOUBLE:
+            return put(record, va_arg(args, long double));
+        case ARG_POINTER:
+            return put(record, va_arg(args, void *));
+        case ARG_STRING:
+            return putString(record, va_arg(args, const char *));
+        case ARG_COUNT:
+            va_arg(args, int *);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // ========================================================================
+    // FORMATEO
+    // ========================================================================
+
+    template <typename T>
+    int emit(char *buffer, size_t size, const char *spec, uint8_t stars, const int *star, T value)
+    {
+        switch (stars)
+        {
+        case 0:
+            return snprintf(buffer, size, spec, value);
+        case 1:
+            return snprintf(buffer, size, spec, star[0], value);
+        default:
+            return snprintf(buffer, size, spec, star[0], star[1], value);
+        }
+    }
+
+    template <typename T>
+    int emitStored(const LogBuffer::Record &record, size_t &offset, char *buffer, size_t size,
+                   const char *spec, uint8_t stars, const int *star)
+    {
+        T value;
+        if (!get(record, offset, value))
+        {
+            return -1;
+        }
+        return emit(buffer, size, spec, stars, star, value);
+    }
+
+    // Escribe un argumento guardado. -1 si no está (mensaje cortado al capturar)
+    int emitValue(const LogBuffer::Record &record, size_t &offset, const Spec &spec, const char *specText,
+                  char *buffer, size_t size)
+    {
+        int star[2] = {0, 0};
+        for (uint8_t i = 0; i < spec.stars; i++)
+        {
+            if (!get(record, offset, star[i]))
+            {
+                return -1;
+            }
+        }
+
+        switch (spec.type)
+        {
+        case ARG_INT:
+            return emitStored<int>(record, offset, buffer, size, specText, spec.stars, star);
+        case ARG_LONG:
+            return emitStored<long>(record, offset, buffer, size, specText, spec.stars, star);
+        case ARG_LONG_LONG:
+            return emitStored<long long>(record, offset, buffer, size, specText, spec.stars, star);
+        case ARG_SIZE:
+            return emitStored<size_t>(record, offset, buffer, size, specText, spec.stars, star);
+        case ARG_INTMAX:
+            return emitStored<intmax_t>(record, offset, buffer, size, specText, spec.stars, star);
+        case ARG_PTRDIFF:
+            return emitStored<ptrdiff_t>(record, offset, buffer, size, specText, spec.stars, star);
+        case ARG_DOUBLE:
+            return emitStored<double>(record, offset, buffer, size, specText, spec.stars, star);
+        case ARG_LONG_DOUBLE:
+            return emitStored<long double>(record, offset, buffer, size, specText, spec.stars, star);
+        case ARG_POINTER:
+            return emitStored<void *>(record, offset, buffer, size, specText, spec.stars, star);
+        case ARG_STRING:
+        {
+            if (offset >= record.argsLength)
+            {
+                return -1;
+            }
+            const char *text = (const char *)&record.args[offset];
+            offset += strlen(text) + 1;
+            return emit(buffer, size, specText, spec.stars, star, text);
+        }
+        case ARG_COUNT:
+            return 0;
+        default:
+            return -1;
+        }
+    }
+}
+
+// ============================================================================
+// COLA
+// ============================================================================
+
+LogBuffer::LogBuffer()
+    : enqueuePos(0),
+      dequeuePos(0),
+      pushed(0),
+      dropped(0),
+      highWater(0)
+{
+    for (uint32_t i = 0; i < SLOTS; i++)
+    {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool LogBuffer::push(uint8_t level, uint32_t timestamp, const char *format, va_list args)
+{
+    // Reservar una celda: su secuencia es igual a la posición cuando está libre
+    uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;)
+    {
+        cell = &cells[pos & (SLOTS - 1)];
+        uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - pos);
+        if (diff == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->record.level = level;
+    cell->record.timestamp = timestamp;
+    capture(cell->record, format, args);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+
+    pushed.fetch_add(1, std::memory_order_relaxed);
+    uint32_t pending = pos + 1 - dequeuePos.load(std::memory_order_relaxed);
+    uint32_t peak = highWater.load(std::memory_order_relaxed);
+    while (pending > peak && pending <= SLOTS &&
+           !highWater.compare_exchange_weak(peak, pending, std::memory_order_relaxed))
+    {
+    }
+    return true;
+}
+
+bool LogBuffer::pop(Record &record)
+{
+    uint32_t pos = dequeuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;)
+    {
+        cell = &cells[pos & (SLOTS - 1)];
+        uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - (pos + 1));
+        if (diff == 0)
+        {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false; // Vacía (o el siguiente todavía se está escribiendo)
+        }
+        else
+        {
+            pos = dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    record = cell->record;
+    cell->sequence.store(pos + SLOTS, std::memory_order_release);
+    return true;
+}
+
+bool LogBuffer::isEmpty() const
+{
+    return enqueuePos.load(std::memory_order_relaxed) == dequeuePos.load(std::memory_order_relaxed);
+}
+
+uint32_t LogBuffer::getPushed() const
+{
+    return pushed.load(std::memory_order_relaxed);
+}
+
+uint32_t LogBuffer::getDropped() const
+{
+    return dropped.load(std::memory_order_relaxed);
+}
+
+uint32_t LogBuffer::getHighWater() const
+{
+    return highWater.load(std::memory_order_relaxed);
+}
+
+// ============================================================================
+// CAPTURA Y FORMATO
+// ============================================================================
+
+bool LogBuffer::capture(Record &record, const char *format, va_list args)
+{
+    record.format = format;
+    record.argsLength = 0;
+    record.truncated = false;
+    if (!format)
+    {
+        return true;
+    }
+
+    // Copia propia: en algunas arquitecturas va_list es un arreglo y
+    // va_arg() sobre el parámetro no se puede pasar por referencia
+    va_list cursor;
+    va_copy(cursor, args);
+
+    const char *p = format;
+    while (*p)
+    {
+        if (*p != '%')
+        {
+            p++;
+            continue;
+        }
+
+        Spec spec;
+        p = parseSpec(p, spec);
+        if (spec.type == ARG_PERCENT)
+        {
+            continue;
+        }
+
+        bool stored = spec.type != ARG_INVALID;
+        for (uint8_t i = 0; stored && i < spec.stars; i++)
+        {
+            stored = put(record, va_arg(cursor, int));
+        }
+        if (!stored || !captureValue(record, spec.type, cursor))
+        {
+            record.truncated = true;
+            break;
+        }
+    }
+
+    va_end(cursor);
+    return !record.truncated;
+}
+
+size_t LogBuffer::format(const Record &record, char *buffer, size_t size)
+{
+    if (!buffer || size == 0)
+    {
+        return 0;
+    }
+
+    size_t written = 0;
+    size_t offset = 0;
+    const char *p = record.format ? record.format : "";
+    while (*p && written < size - 1)
+    {
+        if (*p != '%')
+        {
+            buffer[written++] = *p++;
+            continue;
+        }
+
+        Spec spec;
+        const char *next = parseSpec(p, spec);
+        if (spec.type == ARG_PERCENT)
+        {
+            buffer[written++] = '%';
+            p = next;
+            continue;
+        }
+
+        char specText[24];
+        if (spec.type == ARG_INVALID || spec.length >= sizeof(specText))
+        {
+            break;
+        }
+        memcpy(specText, spec.start, spec.length);
+        specText[spec.length] = '\0';
+
+        int length = emitValue(record, offset, spec, specText, &buffer[written], size - written);
+        if (length < 0)
+        {
+            break;
+        }
+        written += ((size_t)length < size - written) ? (size_t)length : size - written - 1;
+        p = next;
+    }
+
+    if (record.truncated && written < size - 1)
+    {
+        buffer[written++] = '~';
+    }
+    buffer[written] = '\0';
+    return written;
+}
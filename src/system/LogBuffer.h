@@ -0,0 +1,85 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <atomic>
+#include "../config/constants.h"
+
+/*
+ * ============================================================================
+ * LOG BUFFER - COLA DE MENSAJES CON FORMATO DIFERIDO
+ * ============================================================================
+ * Quien registra un mensaje no formatea ni espera al UART: push() guarda el
+ * puntero al formato, la marca de tiempo y los argumentos crudos en una
+ * celda fija, y la tarea de log los formatea más tarde con format().
+ *
+ * Los argumentos se copian según los especificadores del formato (%d, %lu,
+ * %f, %p, %*d...). Los %s se copian en línea porque el texto apuntado
+ * puede no existir cuando se formatea; si no entran se truncan y el
+ * mensaje termina en "~". El formato en sí no se copia: tiene que ser un
+ * literal.
+ *
+ * Cola acotada sin locks (celdas con número de secuencia): varias tareas
+ * pueden escribir y leer a la vez sin bloquearse entre sí. Llena, push()
+ * descarta el mensaje y lo cuenta.
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+class LogBuffer
+{
+public:
+    static const uint32_t SLOTS = LOG_BUFFER_SLOTS; // Potencia de dos
+    static const size_t ARGS_SIZE = LOG_RECORD_ARGS;
+
+    struct Record
+    {
+        const char *format; // Literal: no se copia
+        uint32_t timestamp; // millis() al registrarlo
+        uint8_t level;
+        uint8_t argsLength;
+        bool truncated; // Faltan argumentos o algún %s se cortó
+        uint8_t args[ARGS_SIZE];
+    };
+
+    LogBuffer();
+
+    // Copia formato y argumentos en una celda. false si la cola está llena
+    bool push(uint8_t level, uint32_t timestamp, const char *format, va_list args);
+
+    // Saca el mensaje más antiguo. false si no hay ninguno
+    bool pop(Record &record);
+
+    /**
+     * Empaqueta los argumentos según el formato, sin encolar
+     * @return false si algún argumento no entró
+     */
+    static bool capture(Record &record, const char *format, va_list args);
+
+    /**
+     * Formatea un mensaje capturado (equivale a vsnprintf con los argumentos originales)
+     * @return Caracteres escritos (sin el terminador)
+     */
+    static size_t format(const Record &record, char *buffer, size_t size);
+
+    bool isEmpty() const;
+    uint32_t getPushed() const;
+    uint32_t getDropped() const;
+    uint32_t getHighWater() const; // Máximo de mensajes pendientes a la vez
+
+private:
+    struct Cell
+    {
+        std::atomic<uint32_t> sequence;
+        Record record;
+    };
+
+    Cell cells[SLOTS];
+    std::atomic<uint32_t> enqueuePos;
+    std::atomic<uint32_t> dequeuePos;
+    std::atomic<uint32_t> pushed;
+    std::atomic<uint32_t> dropped;
+    std::atomic<uint32_t> highWater;
+
+    static_assert((SLOTS & (SLOTS - 1)) == 0, "LOG_BUFFER_SLOTS debe ser potencia de dos");
+};
@@ -0,0 +1,167 @@
+#include "Profiler.h"
+
+#if ENABLE_PROFILER
+
+#include <stdio.h>
+
+std::atomic<Profiler::Site *> Profiler::head(nullptr);
+#if defined(ARDUINO)
+uint32_t Profiler::ticksPerUs = 240;
+#else
+uint32_t Profiler::ticksPerUs = 1000;
+#endif
+
+// ============================================================================
+// SITIOS
+// ============================================================================
+
+Profiler::Site::Site(const char *name)
+    : name(name),
+      count(0),
+      totalTicks(0),
+      minTicks(UINT32_MAX),
+      maxTicks(0),
+      next(nullptr)
+{
+    // Dos tareas pueden registrar su primer sitio a la vez
+    Site *expected = head.load();
+    do
+    {
+        next = expected;
+    } while (!head.compare_exchange_weak(expected, this));
+}
+
+void Profiler::Site::reset()
+{
+    count = 0;
+    totalTicks = 0;
+    minTicks = UINT32_MAX;
+    maxTicks = 0;
+}
+
+Profiler::Site *Profiler::first()
+{
+    return head.load();
+}
+
+uint8_t Profiler::siteCount()
+{
+    uint8_t count = 0;
+    for (Site *site = first(); site; site = site->next)
+    {
+        count++;
+    }
+    return count;
+}
+
+void Profiler::resetAll()
+{
+    reset(first(), nullptr);
+}
+
+void Profiler::reset(Site *from, Site *to)
+{
+    for (Site *site = from; site && site != to; site = site->next)
+    {
+        site->reset();
+    }
+}
+
+// ============================================================================
+// CONVERSIÓN
+// ============================================================================
+
+void Profiler::setTicksPerUs(uint32_t value)
+{
+    if (value > 0)
+    {
+        ticksPerUs = value;
+    }
+}
+
+uint32_t Profiler::getTicksPerUs()
+{
+    return ticksPerUs;
+}
+
+float Profiler::toMicros(uint64_t ticks)
+{
+    return (float)ticks / ticksPerUs;
+}
+
+// ============================================================================
+// REPORTE
+// ============================================================================
+
+uint16_t Profiler::nameHash(const char *name)
+{
+    uint32_t hash = 2166136261u;
+    for (; *name; name++)
+    {
+        hash ^= (uint8_t)*name;
+        hash *= 16777619u;
+    }
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+
+static size_t putLittleEndian(uint8_t *buffer, uint32_t value, uint8_t bytes)
+{
+    for (uint8_t i = 0; i < bytes; i++)
+    {
+        buffer[i] = (value >> (8 * i)) & 0xFF;
+    }
+    return bytes;
+}
+
+size_t Profiler::buildSummary(uint8_t *buffer, size_t capacity)
+{
+    Site *cursor = first();
+    return buildSummary(buffer, capacity, cursor);
+}
+
+size_t Profiler::buildSummary(uint8_t *buffer, size_t capacity, Site *&cursor)
+{
+    if (!buffer || capacity < SUMMARY_HEADER_SIZE)
+    {
+        return 0;
+    }
+
+    size_t index = SUMMARY_HEADER_SIZE;
+    uint8_t sites = 0;
+    for (; cursor && index + SUMMARY_SITE_SIZE <= capacity && sites < 0xFF; cursor = cursor->next)
+    {
+        const Site *site = cursor;
+        float mean = site->count ? toMicros(site->totalTicks) / site->count : 0.0f;
+        float max = toMicros(site->maxTicks);
+
+        index += putLittleEndian(&buffer[index], nameHash(site->name), 2);
+        index += putLittleEndian(&buffer[index], site->count > 0xFFFF ? 0xFFFF : site->count, 2);
+        index += putLittleEndian(&buffer[index], mean >= 4294967295.0f ? UINT32_MAX : (uint32_t)mean, 4);
+        index += putLittleEndian(&buffer[index], max >= 4294967295.0f ? UINT32_MAX : (uint32_t)max, 4);
+        sites++;
+    }
+
+    buffer[0] = SUMMARY_TYPE;
+    buffer[1] = sites;
+    return index;
+}
+
+size_t Profiler::format(const Site &site, char *buffer, size_t size)
+{
+    if (!buffer || size == 0)
+    {
+        return 0;
+    }
+    if (site.count == 0)
+    {
+        int written = snprintf(buffer, size, "%s: sin muestras", site.name);
+        return written < 0 ? 0 : ((size_t)written < size ? (size_t)written : size - 1);
+    }
+
+    int written = snprintf(buffer, size, "%s: n=%lu media %.1f us (min %.1f, max %.1f) total %.1f ms",
+                           site.name, (unsigned long)site.count, toMicros(site.totalTicks) / site.count,
+                           toMicros(site.minTicks), toMicros(site.maxTicks), toMicros(site.totalTicks) / 1000.0f);
+    return written < 0 ? 0 : ((size_t)written < size ? (size_t)written : size - 1);
+}
+
+#endif // ENABLE_PROFILER
@@ -0,0 +1,153 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "../config/constants.h"
+
+/*
+ * ============================================================================
+ * PROFILER - TEMPORIZADORES DE SECCIONES CALIENTES
+ * ============================================================================
+ * Mide en qué se va el tiempo despierto. Cada sitio instrumentado es un
+ * acumulador estático (cuenta, total, mínimo y máximo) y PROFILE_SCOPE()
+ * mide desde ese punto hasta el final del bloque:
+ *
+ *     void GPSManager::update()
+ *     {
+ *         PROFILE_SCOPE("gps_parse");
+ *         ...
+ *     }
+ *
+ * En el dispositivo se cuentan ciclos con el registro CCOUNT del núcleo
+ * (una instrucción, sin llamadas). Las tareas están fijas a un núcleo, así
+ * que inicio y fin leen el mismo contador. Con DFS el trabajo corre a la
+ * frecuencia máxima y los ciclos se convierten a µs con setTicksPerUs().
+ * CCOUNT no avanza en light sleep: lo medido es tiempo despierto. Desborda
+ * cada 2^32 ciclos (53 s a 80 MHz), más que cualquier sección medida.
+ * En el host el reloj es clock_gettime() en ns.
+ *
+ * Cada sitio lo actualiza una sola tarea; el registro de sitios nuevos es
+ * atómico. Con ENABLE_PROFILER = 0 no queda nada: PROFILE_SCOPE() no genera
+ * código y la clase no existe.
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+#if ENABLE_PROFILER
+
+#include <atomic>
+#if defined(ARDUINO)
+#include <xtensa/hal.h>
+#else
+#include <time.h>
+#endif
+
+class Profiler
+{
+public:
+    // Uplink de depuración en LORAWAN_PORT_STATUS
+    static const uint8_t SUMMARY_TYPE = 0x04;
+    static const size_t SUMMARY_HEADER_SIZE = 2; // Tipo y cantidad de sitios
+    static const size_t SUMMARY_SITE_SIZE = 12;  // Hash del nombre, cuenta, media y máximo
+
+    struct Site
+    {
+        const char *name; // Literal: no se copia
+        uint32_t count;
+        uint64_t totalTicks;
+        uint32_t minTicks;
+        uint32_t maxTicks;
+        Site *next;
+
+        // Se registra en la lista global al construirse (primera ejecución
+        // del sitio) y nunca se quita: solo con duración estática
+        explicit Site(const char *name);
+
+        void record(uint32_t ticks)
+        {
+            count++;
+            totalTicks += ticks;
+            if (ticks < minTicks)
+            {
+                minTicks = ticks;
+            }
+            if (ticks > maxTicks)
+            {
+                maxTicks = ticks;
+            }
+        }
+
+        void reset();
+    };
+
+    class Scope
+    {
+    public:
+        explicit Scope(Site &site) : site(site), start(ticks()) {}
+        ~Scope() { site.record(ticks() - start); }
+
+    private:
+        Site &site;
+        uint32_t start;
+    };
+
+    static inline uint32_t ticks()
+    {
+#if defined(ARDUINO)
+        return xthal_get_ccount();
+#else
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (uint32_t)((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+#endif
+    }
+
+    // Ciclos por µs: MHz de la CPU en el dispositivo, 1000 (ns) en el host
+    static void setTicksPerUs(uint32_t ticksPerUs);
+    static uint32_t getTicksPerUs();
+    static float toMicros(uint64_t ticks);
+
+    // Sitios registrados, del más reciente al más antiguo
+    static Site *first();
+    static uint8_t siteCount();
+    static void resetAll();
+
+    // Identifica el sitio en el uplink (FNV-1a plegado a 16 bits)
+    static uint16_t nameHash(const char *name);
+
+    /**
+     * Uplink de depuración: [tipo][n] y por sitio hash u16, cuenta u16,
+     * media µs u32 y máximo µs u32 (little endian, saturados)
+     * @return Bytes escritos; los sitios que no entran se omiten
+     */
+    static size_t buildSummary(uint8_t *buffer, size_t capacity);
+
+    // Lo mismo en trozos: desde cursor y lo deja en el primer sitio que no
+    // entró (nullptr al terminar). Los sitios nuevos se agregan al principio
+    // de la lista, así que el cursor sigue valiendo entre trozos
+    static size_t buildSummary(uint8_t *buffer, size_t capacity, Site *&cursor);
+
+    // Reinicia los sitios de from hasta to (sin incluirlo): los ya enviados
+    static void reset(Site *from, Site *to);
+
+    // "gps_parse: n=120 media 85.2 us (min 40.1, max 310.7) total 10.2 ms"
+    static size_t format(const Site &site, char *buffer, size_t size);
+
+private:
+    static std::atomic<Site *> head;
+    static uint32_t ticksPerUs;
+};
+
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+#define PROFILE_SCOPE(name)                                                   \
+    static Profiler::Site PROFILER_CONCAT(profileSite_, __LINE__)(name);      \
+    Profiler::Scope PROFILER_CONCAT(profileScope_, __LINE__)(PROFILER_CONCAT(profileSite_, __LINE__))
+
+#else
+
+#define PROFILE_SCOPE(name) \
+    do                      \
+    {                       \
+    } while (0)
+
+#endif // ENABLE_PROFILER
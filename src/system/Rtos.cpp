@@ -0,0 +1,131 @@
+#include "Rtos.h"
+
+// ============================================================================
+// TIEMPO
+// ============================================================================
+
+uint32_t Rtos::millis()
+{
+#ifdef ARDUINO
+    return ::millis();
+#else
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+#endif
+}
+
+void Rtos::delayMs(uint32_t ms)
+{
+#ifdef ARDUINO
+    vTaskDelay(pdMS_TO_TICKS(ms));
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+#endif
+}
+
+// ============================================================================
+// MUTEX
+// ============================================================================
+
+RtosMutex::RtosMutex()
+{
+#ifdef ARDUINO
+    handle = xSemaphoreCreateMutexStatic(&mutexBuffer);
+#endif
+}
+
+void RtosMutex::lock()
+{
+#ifdef ARDUINO
+    xSemaphoreTake(handle, portMAX_DELAY);
+#else
+    mutex.lock();
+#endif
+}
+
+void RtosMutex::unlock()
+{
+#ifdef ARDUINO
+    xSemaphoreGive(handle);
+#else
+    mutex.unlock();
+#endif
+}
+
+// ============================================================================
+// TAREA
+// ============================================================================
+
+RtosTask::RtosTask()
+    : function(nullptr),
+      context(nullptr),
+      started(false)
+#ifdef ARDUINO
+      ,
+      handle(nullptr)
+#endif
+{
+}
+
+bool RtosTask::start(const char *name, TaskFunction function, void *context,
+                     uint32_t stackBytes, uint8_t priority, int8_t core)
+{
+    if (started || function == nullptr)
+    {
+        return false;
+    }
+
+    this->function = function;
+    this->context = context;
+
+#ifdef ARDUINO
+    // En ESP-IDF el tamaño del stack se indica en bytes
+    BaseType_t affinity = core < 0 ? tskNO_AFFINITY : core;
+    started = xTaskCreatePinnedToCore(trampoline, name, stackBytes, this, priority, &handle, affinity) == pdPASS;
+#else
+    (void)name;
+    (void)stackBytes;
+    (void)priority;
+    (void)core;
+    thread = std::thread(function, context);
+    started = true;
+#endif
+    return started;
+}
+
+#ifdef ARDUINO
+// Una tarea de FreeRTOS no puede retornar: se borra al terminar la función
+void RtosTask::trampoline(void *task)
+{
+    RtosTask *self = (RtosTask *)task;
+    self->function(self->context);
+    self->handle = nullptr;
+    vTaskDelete(nullptr);
+}
+#endif
+
+void RtosTask::join()
+{
+#ifndef ARDUINO
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+#endif
+}
+
+bool RtosTask::isStarted() const
+{
+    return started;
+}
+
+uint32_t RtosTask::getStackHighWater() const
+{
+#ifdef ARDUINO
+    return handle ? uxTaskGetStackHighWaterMark(handle) : 0;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,289 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <type_traits>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+/*
+ * ============================================================================
+ * RTOS - COLAS, TAREAS Y MUTEX CON DOS IMPLEMENTACIONES
+ * ============================================================================
+ * En el dispositivo son objetos de FreeRTOS creados estáticamente (sin heap):
+ * colas de tamaño fijo, tareas fijadas a un núcleo y mutex con herencia de
+ * prioridad. En el host se implementan con std::thread, std::mutex y
+ * std::condition_variable, con la misma semántica de timeout, para poder
+ * probar y estresar la concurrencia en Linux.
+ *
+ * Los mensajes se copian por valor, así que deben ser trivialmente copiables.
+ */
+
+// Timeout infinito para send()/receive()
+#define RTOS_WAIT_FOREVER 0xFFFFFFFFUL
+
+class Rtos
+{
+public:
+    static uint32_t millis();
+    static void delayMs(uint32_t ms);
+};
+
+// ============================================================================
+// MUTEX
+// ============================================================================
+
+class RtosMutex
+{
+public:
+    RtosMutex();
+
+    void lock();
+    void unlock();
+
+private:
+#ifdef ARDUINO
+    StaticSemaphore_t mutexBuffer;
+    SemaphoreHandle_t handle;
+#else
+    std::mutex mutex;
+#endif
+
+    RtosMutex(const RtosMutex &) = delete;
+    RtosMutex &operator=(const RtosMutex &) = delete;
+};
+
+// Toma el mutex en el constructor y lo libera al salir del bloque
+class RtosLock
+{
+public:
+    explicit RtosLock(RtosMutex &mutex) : mutex(mutex) { mutex.lock(); }
+    ~RtosLock() { mutex.unlock(); }
+
+private:
+    RtosMutex &mutex;
+};
+
+// ============================================================================
+// TAREA
+// ============================================================================
+
+class RtosTask
+{
+public:
+    typedef void (*TaskFunction)(void *context);
+
+    RtosTask();
+
+    /**
+     * Crea la tarea. En el host se ignoran la prioridad y el núcleo
+     * @param core Núcleo (0 o 1); -1 = sin afinidad
+     */
+    bool start(const char *name, TaskFunction function, void *context,
+               uint32_t stackBytes, uint8_t priority, int8_t core);
+
+    // Espera a que la función termine (solo tiene efecto en el host)
+    void join();
+
+    bool isStarted() const;
+    uint32_t getStackHighWater() const; // Bytes de stack nunca usados (0 en el host)
+
+private:
+    TaskFunction function;
+    void *context;
+    bool started;
+
+#ifdef ARDUINO
+    TaskHandle_t handle;
+    static void trampoline(void *task);
+#else
+    std::thread thread;
+#endif
+};
+
+// ============================================================================
+// COLA DE TAMAÑO FIJO
+// ============================================================================
+
+template <typename T, size_t N>
+class RtosQueue
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Los mensajes se copian por valor");
+    static_assert(N > 0, "La cola necesita al menos un elemento");
+
+public:
+    RtosQueue() : sent(0), dropped(0), highWater(0)
+    {
+#ifdef ARDUINO
+        handle = xQueueCreateStatic(N, sizeof(T), storage, &queueBuffer);
+#else
+        head = 0;
+        count = 0;
+#endif
+    }
+
+    /**
+     * Encola una copia del mensaje
+     * @param timeoutMs Espera máxima si está llena (0 = no esperar)
+     * @return false si no hubo lugar (se cuenta como descartado)
+     */
+    bool send(const T &item, uint32_t timeoutMs = 0)
+    {
+        size_t depth = 0;
+        bool ok = push(item, timeoutMs, depth);
+        account(ok, depth);
+        return ok;
+    }
+
+    // Versión para interrupciones: nunca espera
+    bool sendFromIsr(const T &item)
+    {
+#ifdef ARDUINO
+        BaseType_t woken = pdFALSE;
+        bool ok = xQueueSendFromISR(handle, &item, &woken) == pdTRUE;
+        portYIELD_FROM_ISR(woken);
+        account(ok, 0);
+        return ok;
+#else
+        return send(item, 0);
+#endif
+    }
+
+    /**
+     * Encola sin esperar; si está llena descarta el mensaje más antiguo.
+     * Pensado para un único productor de datos donde importa el más reciente
+     */
+    bool sendLatest(const T &item)
+    {
+        size_t depth = 0;
+        if (!push(item, 0, depth))
+        {
+            // El consumidor pudo vaciarla entre medio: solo cuenta si se descartó algo
+            T oldest;
+            if (receive(oldest, 0))
+            {
+                dropped++;
+            }
+            if (!push(item, 0, depth))
+            {
+                dropped++;
+                return false;
+            }
+        }
+        account(true, depth);
+        return true;
+    }
+
+    bool receive(T &item, uint32_t timeoutMs = RTOS_WAIT_FOREVER)
+    {
+#ifdef ARDUINO
+        return xQueueReceive(handle, &item, toTicks(timeoutMs)) == pdTRUE;
+#else
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!waitFor(lock, notEmpty, timeoutMs, [this] { return count > 0; }))
+        {
+            return false;
+        }
+        item = items[head];
+        head = (head + 1) % N;
+        count--;
+        notFull.notify_one();
+        return true;
+#endif
+    }
+
+    size_t size() const
+    {
+#ifdef ARDUINO
+        return uxQueueMessagesWaiting(handle);
+#else
+        std::lock_guard<std::mutex> lock(mutex);
+        return count;
+#endif
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+    // Estadísticas (el máximo de ocupación es aproximado bajo concurrencia)
+    uint32_t getSent() const { return sent.load(); }
+    uint32_t getDropped() const { return dropped.load(); }
+    uint32_t getHighWater() const { return highWater.load(); }
+
+private:
+    std::atomic<uint32_t> sent;
+    std::atomic<uint32_t> dropped;
+    std::atomic<uint32_t> highWater;
+
+    bool push(const T &item, uint32_t timeoutMs, size_t &depth)
+    {
+#ifdef ARDUINO
+        bool ok = xQueueSend(handle, &item, toTicks(timeoutMs)) == pdTRUE;
+        depth = ok ? uxQueueMessagesWaiting(handle) : 0;
+        return ok;
+#else
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!waitFor(lock, notFull, timeoutMs, [this] { return count < N; }))
+        {
+            return false;
+        }
+        items[(head + count) % N] = item;
+        depth = ++count;
+        notEmpty.notify_one();
+        return true;
+#endif
+    }
+
+    void account(bool ok, size_t depth)
+    {
+        if (!ok)
+        {
+            dropped++;
+            return;
+        }
+        sent++;
+        if (depth > highWater.load())
+        {
+            highWater.store((uint32_t)depth);
+        }
+    }
+
+#ifdef ARDUINO
+    StaticQueue_t queueBuffer;
+    uint8_t storage[N * sizeof(T)];
+    QueueHandle_t handle;
+
+    static TickType_t toTicks(uint32_t timeoutMs)
+    {
+        return timeoutMs == RTOS_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+    }
+#else
+    T items[N];
+    size_t head;
+    size_t count;
+    mutable std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+
+    template <typename Predicate>
+    static bool waitFor(std::unique_lock<std::mutex> &lock, std::condition_variable &condition,
+                        uint32_t timeoutMs, Predicate ready)
+    {
+        if (timeoutMs == RTOS_WAIT_FOREVER)
+        {
+            condition.wait(lock, ready);
+            return true;
+        }
+        return condition.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready);
+    }
+#endif
+
+    RtosQueue(const RtosQueue &) = delete;
+    RtosQueue &operator=(const RtosQueue &) = delete;
+};
@@ -0,0 +1,277 @@
+#include "Runtime.h"
+#include <string.h>
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+Runtime::Runtime(Handlers &handlers, const Config &config)
+    : handlers(handlers),
+      config(config),
+      running(false),
+      fixesPublished(0),
+      fixesEvaluated(0),
+      idleEvaluations(0),
+      outOfOrder(0),
+      maxFixLatency(0),
+      totalFixLatency(0),
+      radioRequests(0),
+      radioHandled(0),
+      uiEvents(0)
+{
+}
+
+// ============================================================================
+// ARRANQUE Y PARADA
+// ============================================================================
+
+bool Runtime::start()
+{
+    if (running)
+    {
+        return false;
+    }
+    running = true;
+
+    // Primero los consumidores, para que ninguna cola se llene al arrancar
+    bool ok = radioTask.start("radio", radioEntry, this, TASK_RADIO_STACK, TASK_RADIO_PRIORITY, TASK_RADIO_CORE) &&
+              uiTask.start("ui", uiEntry, this, TASK_UI_STACK, TASK_UI_PRIORITY, TASK_UI_CORE) &&
+              geofenceTask.start("geofence", geofenceEntry, this, TASK_GEOFENCE_STACK, TASK_GEOFENCE_PRIORITY,
+                                 TASK_GEOFENCE_CORE) &&
+              gpsTask.start("gps", gpsEntry, this, TASK_GPS_STACK, TASK_GPS_PRIORITY, TASK_GPS_CORE);
+    return ok;
+}
+
+void Runtime::stop()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    // El GPS termina solo; los consumidores procesan lo encolado y salen al
+    // recibir el mensaje de parada, en orden de la cadena
+    running = false;
+    gpsTask.join();
+
+    FixMessage fixStop = {};
+    fixStop.stop = true;
+    fixQueue.send(fixStop, RTOS_WAIT_FOREVER);
+    geofenceTask.join();
+
+    UiEvent uiStop = {};
+    uiStop.stop = true;
+    uiQueue.send(uiStop, RTOS_WAIT_FOREVER);
+    uiTask.join();
+
+    RadioRequest radioStop = {};
+    radioStop.stop = true;
+    radioQueue.send(radioStop, RTOS_WAIT_FOREVER);
+    radioTask.join();
+}
+
+bool Runtime::isRunning() const
+{
+    return running;
+}
+
+// ============================================================================
+// PUNTOS DE ENTRADA
+// ============================================================================
+
+bool Runtime::postRadio(const RadioRequest &request)
+{
+    if (!radioQueue.send(request, 0))
+    {
+        return false;
+    }
+    radioRequests++;
+    return true;
+}
+
+bool Runtime::postUiEvent(const UiEvent &event)
+{
+    if (!uiQueue.send(event, 0))
+    {
+        return false;
+    }
+    uiEvents++;
+    return true;
+}
+
+bool Runtime::postNotify(uint8_t code)
+{
+    UiEvent event = {};
+    event.type = UI_NOTIFY;
+    event.code = code;
+    return postUiEvent(event);
+}
+
+bool Runtime::postUiEventFromIsr(uint8_t type)
+{
+    UiEvent event = {};
+    event.type = type;
+    if (!uiQueue.sendFromIsr(event))
+    {
+        return false;
+    }
+    uiEvents++;
+    return true;
+}
+
+// ============================================================================
+// TAREAS
+// ============================================================================
+
+void Runtime::gpsEntry(void *runtime)
+{
+    ((Runtime *)runtime)->gpsLoop();
+}
+
+void Runtime::geofenceEntry(void *runtime)
+{
+    ((Runtime *)runtime)->geofenceLoop();
+}
+
+void Runtime::radioEntry(void *runtime)
+{
+    ((Runtime *)runtime)->radioLoop();
+}
+
+void Runtime::uiEntry(void *runtime)
+{
+    ((Runtime *)runtime)->uiLoop();
+}
+
+void Runtime::gpsLoop()
+{
+    uint32_t sequence = 0;
+    while (running)
+    {
+        FixMessage fix = {};
+        if (handlers.pollGps(fix.position))
+        {
+            fix.sequence = ++sequence;
+            fix.publishedAt = Rtos::millis();
+            fixQueue.sendLatest(fix);
+            fixesPublished++;
+        }
+        Rtos::delayMs(config.gpsPollMs);
+    }
+}
+
+void Runtime::geofenceLoop()
+{
+    FixMessage last = {};
+    bool haveLast = false;
+
+    while (true)
+    {
+        FixMessage fix;
+        if (!fixQueue.receive(fix, config.geofenceIdleMs))
+        {
+            // Sin posición nueva: reevaluar la última para que escalen las alertas
+            if (haveLast && last.position.valid)
+            {
+                idleEvaluations++;
+                evaluateFix(last, false);
+            }
+            continue;
+        }
+
+        if (fix.stop)
+        {
+            break;
+        }
+        if (haveLast && fix.sequence <= last.sequence)
+        {
+            outOfOrder++;
+        }
+        last = fix;
+        haveLast = true;
+
+        if (fix.position.valid)
+        {
+            evaluateFix(fix, true);
+        }
+    }
+}
+
+void Runtime::evaluateFix(const FixMessage &fix, bool fresh)
+{
+    if (fresh)
+    {
+        uint32_t latency = Rtos::millis() - fix.publishedAt;
+        totalFixLatency += latency;
+        if (latency > maxFixLatency)
+        {
+            maxFixLatency = latency;
+        }
+    }
+
+    UiEvent event = {};
+    event.type = UI_ALERT;
+    event.level = handlers.evaluate(fix.position, event.distance);
+    event.sequence = fix.sequence;
+    fixesEvaluated++;
+
+    postUiEvent(event);
+}
+
+void Runtime::radioLoop()
+{
+    while (true)
+    {
+        RadioRequest request;
+        if (!radioQueue.receive(request, RTOS_WAIT_FOREVER))
+        {
+            continue;
+        }
+        if (request.stop)
+        {
+            break;
+        }
+        handlers.handleRadio(request);
+        radioHandled++;
+    }
+}
+
+void Runtime::uiLoop()
+{
+    while (true)
+    {
+        uint32_t wait = handlers.runUi();
+        UiEvent event;
+        if (!uiQueue.receive(event, wait < config.uiMaxIdleMs ? wait : config.uiMaxIdleMs))
+        {
+            continue;
+        }
+        if (event.stop)
+        {
+            break;
+        }
+        handlers.onUiEvent(event);
+    }
+}
+
+// ============================================================================
+// ESTADÍSTICAS
+// ============================================================================
+
+Runtime::Stats Runtime::getStats() const
+{
+    Stats stats;
+    stats.fixesPublished = fixesPublished;
+    stats.fixesDropped = fixQueue.getDropped();
+    stats.fixesEvaluated = fixesEvaluated;
+    stats.idleEvaluations = idleEvaluations;
+    stats.outOfOrder = outOfOrder;
+    stats.maxFixLatency = maxFixLatency;
+    stats.totalFixLatency = totalFixLatency;
+    stats.radioRequests = radioRequests;
+    stats.radioRejected = radioQueue.getDropped();
+    stats.radioHandled = radioHandled;
+    stats.uiEvents = uiEvents;
+    stats.uiDropped = uiQueue.getDropped();
+    return stats;
+}
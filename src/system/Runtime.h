@@ -0,0 +1,187 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "../config/constants.h"
+#include "../core/Types.h"
+#include "Rtos.h"
+
+/*
+ * ============================================================================
+ * RUNTIME - TAREAS DEL COLLAR Y COLAS ENTRE ELLAS
+ * ============================================================================
+ * Cuatro tareas con colas de tamaño fijo, para que un uplink bloqueante no
+ * retrase la geocerca ni las alertas:
+ *
+ *   GPS (núcleo 0) --fixQueue--> GEOCERCA/ALERTAS (núcleo 1) --uiQueue--> UI
+ *   UI / cualquiera --radioQueue--> RADIO (núcleo 0)
+ *
+ * - GPS: drena el UART cada GPS_POLL_INTERVAL y publica cada posición nueva.
+ *   Si la cola está llena se descarta la más antigua: importa la última.
+ * - Geocerca: evalúa cada posición apenas llega (prioridad más alta) y, si
+ *   no llegan posiciones, reevalúa la última cada GEOFENCE_CHECK_INTERVAL
+ *   para que las alertas sigan escalando.
+ * - Radio: ejecuta en orden las peticiones (join, uplink, estado del enlace).
+ * - UI: corre los trabajos periódicos (display, serial, LED...) y atiende
+ *   los eventos de alerta, del botón y los avisos de las demás tareas. Es
+ *   la única que toca el display, el LED y el Scheduler.
+ *
+ * Lo que cada tarea hace con el hardware lo implementa Handlers; así el
+ * mismo diseño corre en el dispositivo y en los tests nativos (std::thread).
+ */
+
+class Runtime
+{
+public:
+    static const size_t RADIO_PAYLOAD_MAX = 32;
+
+    enum RadioRequestType : uint8_t
+    {
+        RADIO_JOIN = 0,
+        RADIO_UPLINK,
+        RADIO_LINK_STATUS,
+        RADIO_DEEP_SLEEP, // Tras lo encolado: guardar estado y dormir (payload = ms)
+        RADIO_PROFILE,    // Uplink de depuración del Profiler
+        RADIO_TRACE,      // Próximo trozo de la bitácora
+        RADIO_ENERGY      // Consumo por subsistema (EnergyLedger)
+    };
+
+    enum UiEventType : uint8_t
+    {
+        UI_ALERT = 0,
+        UI_BUTTON,
+        UI_NOTIFY // Aviso de otra tarea (LED, buzzer...); el código lo define la aplicación
+    };
+
+    struct FixMessage
+    {
+        Position position;
+        uint32_t sequence;
+        uint32_t publishedAt; // Rtos::millis() al publicarse
+        bool stop;
+    };
+
+    struct RadioRequest
+    {
+        uint8_t type;
+        uint8_t port;
+        uint8_t length;
+        uint8_t payload[RADIO_PAYLOAD_MAX];
+        bool stop;
+    };
+
+    struct UiEvent
+    {
+        uint8_t type;
+        uint8_t code;      // UI_NOTIFY
+        AlertLevel level;
+        float distance;
+        uint32_t sequence; // Secuencia de la posición evaluada
+        bool stop;
+    };
+
+    // Implementación de cada etapa (managers en el dispositivo, simulación en los tests)
+    class Handlers
+    {
+    public:
+        virtual ~Handlers() {}
+
+        // Tarea GPS: procesa el UART; true si hay una posición nueva o se perdió el fix
+        virtual bool pollGps(Position &position) = 0;
+
+        // Tarea geocerca: evalúa la posición y actualiza las alertas
+        virtual AlertLevel evaluate(const Position &position, float &distance) = 0;
+
+        // Tarea radio: ejecuta la petición (puede bloquear varios segundos)
+        virtual void handleRadio(const RadioRequest &request) = 0;
+
+        // Tarea UI: ejecuta los trabajos vencidos y devuelve ms hasta el próximo
+        virtual uint32_t runUi() = 0;
+        virtual void onUiEvent(const UiEvent &event) = 0;
+    };
+
+    struct Config
+    {
+        uint32_t gpsPollMs;
+        uint32_t geofenceIdleMs;
+        uint32_t uiMaxIdleMs;
+
+        Config() : gpsPollMs(GPS_POLL_INTERVAL),
+                   geofenceIdleMs(GEOFENCE_CHECK_INTERVAL),
+                   uiMaxIdleMs(SCHEDULER_MAX_IDLE_MS) {}
+    };
+
+    struct Stats
+    {
+        uint32_t fixesPublished;
+        uint32_t fixesDropped;      // Reemplazadas por una más nueva con la cola llena
+        uint32_t fixesEvaluated;
+        uint32_t idleEvaluations;   // Reevaluaciones sin posición nueva
+        uint32_t outOfOrder;        // Posiciones evaluadas fuera de orden (debe ser 0)
+        uint32_t maxFixLatency;     // Peor espera entre publicar y evaluar (ms)
+        uint32_t totalFixLatency;
+        uint32_t radioRequests;
+        uint32_t radioRejected;     // Cola de radio llena
+        uint32_t radioHandled;
+        uint32_t uiEvents;
+        uint32_t uiDropped;
+    };
+
+    explicit Runtime(Handlers &handlers, const Config &config = Config());
+
+    // Crea las cuatro tareas fijadas a su núcleo
+    bool start();
+
+    // Detiene las tareas y espera a que terminen (en el dispositivo no se usa)
+    void stop();
+    bool isRunning() const;
+
+    // Encola una petición para la tarea de radio sin esperar
+    bool postRadio(const RadioRequest &request);
+
+    // Encola un evento para la tarea UI sin esperar (desde cualquier tarea)
+    bool postUiEvent(const UiEvent &event);
+    bool postNotify(uint8_t code);
+
+    // Desde un ISR (botón): despierta a la tarea UI
+    bool postUiEventFromIsr(uint8_t type);
+
+    Stats getStats() const;
+
+private:
+    Handlers &handlers;
+    Config config;
+    std::atomic<bool> running;
+
+    RtosQueue<FixMessage, FIX_QUEUE_DEPTH> fixQueue;
+    RtosQueue<RadioRequest, RADIO_QUEUE_DEPTH> radioQueue;
+    RtosQueue<UiEvent, UI_QUEUE_DEPTH> uiQueue;
+
+    RtosTask gpsTask;
+    RtosTask geofenceTask;
+    RtosTask radioTask;
+    RtosTask uiTask;
+
+    // Estadísticas: se leen desde otra tarea mientras se escriben
+    std::atomic<uint32_t> fixesPublished;
+    std::atomic<uint32_t> fixesEvaluated;
+    std::atomic<uint32_t> idleEvaluations;
+    std::atomic<uint32_t> outOfOrder;
+    std::atomic<uint32_t> maxFixLatency;
+    std::atomic<uint32_t> totalFixLatency;
+    std::atomic<uint32_t> radioRequests;
+    std::atomic<uint32_t> radioHandled;
+    std::atomic<uint32_t> uiEvents;
+
+    static void gpsEntry(void *runtime);
+    static void geofenceEntry(void *runtime);
+    static void radioEntry(void *runtime);
+    static void uiEntry(void *runtime);
+
+    void gpsLoop();
+    void geofenceLoop();
+    void radioLoop();
+    void uiLoop();
+
+    void evaluateFix(const FixMessage &fix, bool fresh);
+};
@@ -0,0 +1,402 @@
+#include "Scheduler.h"
+#include <string.h>
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+Scheduler::Scheduler(ClockFunction clock)
+    : taskCount(0),
+      heapSize(0),
+      clock(clock),
+      passes(0),
+      runningTask(INVALID_TASK),
+      runningTaskTouched(false)
+{
+    memset(tasks, 0, sizeof(tasks));
+    memset(heapIndex, INVALID_TASK, sizeof(heapIndex));
+}
+
+// ============================================================================
+// REGISTRO Y CONTROL DE TAREAS
+// ============================================================================
+
+uint8_t Scheduler::addTask(const char *name, TaskFunction function, void *context, uint32_t periodMs,
+                           uint32_t jitterMs, uint8_t priority, uint32_t firstDelayMs)
+{
+    if (taskCount >= MAX_TASKS || function == nullptr)
+    {
+        return INVALID_TASK;
+    }
+
+    uint8_t id = taskCount++;
+    Task &task = tasks[id];
+    task.name = name;
+    task.function = function;
+    task.context = context;
+    task.periodMs = periodMs;
+    task.jitterMs = jitterMs;
+    task.priority = priority;
+    task.deadline = clock() + periodMs + firstDelayMs;
+
+    // Una tarea de un disparo queda esperando a schedule()
+    task.enabled = periodMs > 0;
+    if (task.enabled)
+    {
+        heapInsert(id);
+    }
+    return id;
+}
+
+void Scheduler::setEnabled(uint8_t id, bool enabled)
+{
+    if (id >= taskCount || tasks[id].enabled == enabled)
+    {
+        return;
+    }
+
+    touch(id);
+    tasks[id].enabled = enabled;
+    if (enabled)
+    {
+        tasks[id].deadline = clock() + tasks[id].periodMs;
+        heapInsert(id);
+    }
+    else
+    {
+        heapRemove(id);
+    }
+}
+
+bool Scheduler::isEnabled(uint8_t id) const
+{
+    return id < taskCount && tasks[id].enabled;
+}
+
+void Scheduler::setPeriod(uint8_t id, uint32_t periodMs)
+{
+    if (id >= taskCount || tasks[id].periodMs == periodMs)
+    {
+        return;
+    }
+
+    tasks[id].periodMs = periodMs;
+    if (tasks[id].enabled)
+    {
+        touch(id);
+        tasks[id].deadline = clock() + periodMs;
+        heapUpdate(id);
+    }
+}
+
+uint32_t Scheduler::getPeriod(uint8_t id) const
+{
+    return id < taskCount ? tasks[id].periodMs : 0;
+}
+
+void Scheduler::schedule(uint8_t id, uint32_t delayMs)
+{
+    if (id >= taskCount)
+    {
+        return;
+    }
+
+    touch(id);
+    tasks[id].deadline = clock() + delayMs;
+    if (tasks[id].enabled)
+    {
+        heapUpdate(id);
+    }
+    else
+    {
+        tasks[id].enabled = true;
+        heapInsert(id);
+    }
+}
+
+void Scheduler::touch(uint8_t id)
+{
+    if (id == runningTask)
+    {
+        runningTaskTouched = true;
+    }
+}
+
+// ============================================================================
+// EJECUCIÓN
+// ============================================================================
+
+uint8_t Scheduler::runDue()
+{
+    uint32_t now = clock();
+    if (heapSize == 0 || before(now, tasks[heap[0]].deadline))
+    {
+        return 0;
+    }
+
+    // Candidatas: vencidas o dentro de su ventana de jitter
+    uint8_t due[MAX_TASKS];
+    uint8_t dueCount = 0;
+    for (uint8_t i = 0; i < heapSize; i++)
+    {
+        const Task &task = tasks[heap[i]];
+        if (!before(now, task.deadline - task.jitterMs))
+        {
+            due[dueCount++] = heap[i];
+        }
+    }
+
+    // Orden: prioridad descendente, deadline más próximo y orden de registro
+    for (uint8_t i = 1; i < dueCount; i++)
+    {
+        uint8_t id = due[i];
+        uint8_t j = i;
+        while (j > 0 && runsBefore(id, due[j - 1]))
+        {
+            due[j] = due[j - 1];
+            j--;
+        }
+        due[j] = id;
+    }
+
+    uint8_t executed = 0;
+    for (uint8_t i = 0; i < dueCount; i++)
+    {
+        // Una tarea anterior pudo deshabilitarla o reprogramarla
+        const Task &task = tasks[due[i]];
+        if (!task.enabled || before(clock(), task.deadline - task.jitterMs))
+        {
+            continue;
+        }
+        runTask(due[i]);
+        executed++;
+    }
+
+    if (executed > 0)
+    {
+        passes++;
+    }
+    return executed;
+}
+
+bool Scheduler::runsBefore(uint8_t a, uint8_t b) const
+{
+    if (tasks[a].priority != tasks[b].priority)
+    {
+        return tasks[a].priority > tasks[b].priority;
+    }
+    if (tasks[a].deadline != tasks[b].deadline)
+    {
+        return before(tasks[a].deadline, tasks[b].deadline);
+    }
+    return a < b;
+}
+
+void Scheduler::runTask(uint8_t id)
+{
+    Task &task = tasks[id];
+    uint32_t start = clock();
+
+    if (before(start, task.deadline))
+    {
+        task.stats.earlyRuns++;
+    }
+    else
+    {
+        uint32_t latency = start - task.deadline;
+        task.stats.totalLatency += latency;
+        if (latency > task.stats.maxLatency)
+        {
+            task.stats.maxLatency = latency;
+        }
+    }
+    task.stats.runs++;
+
+    runningTask = id;
+    runningTaskTouched = false;
+    task.function(task.context);
+    runningTask = INVALID_TASK;
+
+    // La tarea se reprogramó o deshabilitó sola
+    if (runningTaskTouched || !task.enabled)
+    {
+        return;
+    }
+
+    if (task.periodMs == 0)
+    {
+        task.enabled = false;
+        heapRemove(id);
+        return;
+    }
+
+    // Mantener la fase; si se perdieron periodos, saltar al siguiente futuro
+    task.deadline += task.periodMs;
+    uint32_t now = clock();
+    if (!before(now, task.deadline))
+    {
+        uint32_t missed = (now - task.deadline) / task.periodMs + 1;
+        task.stats.overruns += missed;
+        task.deadline += missed * task.periodMs;
+    }
+    heapUpdate(id);
+}
+
+uint32_t Scheduler::timeUntilNext() const
+{
+    if (heapSize == 0)
+    {
+        return UINT32_MAX;
+    }
+
+    uint32_t now = clock();
+    uint32_t deadline = tasks[heap[0]].deadline;
+    return before(now, deadline) ? deadline - now : 0;
+}
+
+// ============================================================================
+// CONSULTAS
+// ============================================================================
+
+const Scheduler::TaskStats &Scheduler::getStats(uint8_t id) const
+{
+    return tasks[id < taskCount ? id : 0].stats;
+}
+
+const char *Scheduler::getName(uint8_t id) const
+{
+    return id < taskCount ? tasks[id].name : "";
+}
+
+uint8_t Scheduler::getTaskCount() const
+{
+    return taskCount;
+}
+
+uint32_t Scheduler::getPasses() const
+{
+    return passes;
+}
+
+void Scheduler::resetStats()
+{
+    passes = 0;
+    for (uint8_t i = 0; i < taskCount; i++)
+    {
+        memset(&tasks[i].stats, 0, sizeof(TaskStats));
+    }
+}
+
+// ============================================================================
+// MIN-HEAP POR DEADLINE
+// ============================================================================
+
+// a < b con tolerancia al desborde de millis()
+bool Scheduler::before(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+bool Scheduler::heapLess(uint8_t a, uint8_t b) const
+{
+    const Task &ta = tasks[heap[a]];
+    const Task &tb = tasks[heap[b]];
+    if (ta.deadline != tb.deadline)
+    {
+        return before(ta.deadline, tb.deadline);
+    }
+    return ta.priority > tb.priority;
+}
+
+void Scheduler::heapSwap(uint8_t i, uint8_t j)
+{
+    uint8_t tmp = heap[i];
+    heap[i] = heap[j];
+    heap[j] = tmp;
+    heapIndex[heap[i]] = i;
+    heapIndex[heap[j]] = j;
+}
+
+void Scheduler::siftUp(uint8_t i)
+{
+    while (i > 0)
+    {
+        uint8_t parent = (i - 1) / 2;
+        if (!heapLess(i, parent))
+        {
+            break;
+        }
+        heapSwap(i, parent);
+        i = parent;
+    }
+}
+
+void Scheduler::siftDown(uint8_t i)
+{
+    while (true)
+    {
+        uint8_t smallest = i;
+        uint8_t left = 2 * i + 1;
+        uint8_t right = left + 1;
+        if (left < heapSize && heapLess(left, smallest))
+        {
+            smallest = left;
+        }
+        if (right < heapSize && heapLess(right, smallest))
+        {
+            smallest = right;
+        }
+        if (smallest == i)
+        {
+            break;
+        }
+        heapSwap(i, smallest);
+        i = smallest;
+    }
+}
+
+void Scheduler::heapInsert(uint8_t id)
+{
+    if (heapIndex[id] != INVALID_TASK)
+    {
+        heapUpdate(id);
+        return;
+    }
+    heap[heapSize] = id;
+    heapIndex[id] = heapSize;
+    heapSize++;
+    siftUp(heapSize - 1);
+}
+
+void Scheduler::heapRemove(uint8_t id)
+{
+    uint8_t i = heapIndex[id];
+    if (i == INVALID_TASK)
+    {
+        return;
+    }
+
+    heapSize--;
+    if (i != heapSize)
+    {
+        heapSwap(i, heapSize);
+        heapIndex[id] = INVALID_TASK;
+        siftUp(i);
+        siftDown(i);
+    }
+    else
+    {
+        heapIndex[id] = INVALID_TASK;
+    }
+}
+
+void Scheduler::heapUpdate(uint8_t id)
+{
+    uint8_t i = heapIndex[id];
+    if (i == INVALID_TASK)
+    {
+        return;
+    }
+    siftUp(i);
+    siftDown(heapIndex[id]);
+}
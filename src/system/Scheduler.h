@@ -0,0 +1,131 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * ============================================================================
+ * SCHEDULER - PLANIFICADOR COOPERATIVO POR DEADLINE
+ * ============================================================================
+ * Reemplaza los temporizadores lastXxx del loop. Cada tarea periódica tiene:
+ *
+ * - periodo: distancia entre deadlines (0 = tarea de un disparo)
+ * - jitter: cuánto antes del deadline puede ejecutarse. Si el CPU ya está
+ *   despierto por otra tarea, las que están dentro de su ventana se
+ *   ejecutan en la misma pasada y se ahorra un despertar
+ * - prioridad: orden entre tareas vencidas en la misma pasada
+ *
+ * Las tareas están en un min-heap por deadline: el próximo despertar es la
+ * raíz (O(1)) y reprogramar cuesta O(log n). Entre pasadas el loop duerme
+ * timeUntilNext() milisegundos. La latencia de cada tarea se mide con el
+ * reloj al empezar a ejecutarla, así incluye lo que bloquearon las demás.
+ *
+ * Los tiempos son millis() de 32 bits; las comparaciones toleran el desborde.
+ * Independiente de Arduino para poder simularse en los tests nativos.
+ */
+
+class Scheduler
+{
+public:
+    typedef void (*TaskFunction)(void *context);
+    typedef uint32_t (*ClockFunction)(); // millis() en el dispositivo, reloj simulado en el host
+
+    static const uint8_t MAX_TASKS = 16;
+    static const uint8_t INVALID_TASK = 0xFF;
+
+    enum Priority : uint8_t
+    {
+        PRIORITY_LOW = 0,
+        PRIORITY_NORMAL = 1,
+        PRIORITY_HIGH = 2,
+        PRIORITY_CRITICAL = 3
+    };
+
+    struct TaskStats
+    {
+        uint32_t runs;
+        uint32_t earlyRuns;    // Adelantadas dentro de su jitter
+        uint32_t overruns;     // Periodos perdidos por llegar tarde
+        uint32_t maxLatency;   // Peor retraso respecto al deadline (ms)
+        uint32_t totalLatency;
+    };
+
+    explicit Scheduler(ClockFunction clock);
+
+    /**
+     * Registra una tarea
+     * @param firstDelayMs Desfase del primer deadline (ahora + periodo + desfase)
+     * @return ID de la tarea o INVALID_TASK si no hay espacio
+     */
+    uint8_t addTask(const char *name, TaskFunction function, void *context, uint32_t periodMs,
+                    uint32_t jitterMs = 0, uint8_t priority = PRIORITY_NORMAL, uint32_t firstDelayMs = 0);
+
+    // Habilitar/deshabilitar. Al habilitar, el siguiente deadline es ahora + periodo
+    void setEnabled(uint8_t id, bool enabled);
+    bool isEnabled(uint8_t id) const;
+
+    // Cambia el periodo; el siguiente deadline se recalcula desde ahora
+    void setPeriod(uint8_t id, uint32_t periodMs);
+    uint32_t getPeriod(uint8_t id) const;
+
+    // Programa (y habilita) la próxima ejecución dentro de delayMs
+    void schedule(uint8_t id, uint32_t delayMs);
+
+    /**
+     * Ejecuta las tareas vencidas y, si alguna lo estaba, también las que
+     * están dentro de su ventana de jitter
+     * @return Tareas ejecutadas en esta pasada
+     */
+    uint8_t runDue();
+
+    // Milisegundos hasta el próximo deadline: 0 si hay alguno vencido,
+    // UINT32_MAX si no hay tareas habilitadas
+    uint32_t timeUntilNext() const;
+
+    const TaskStats &getStats(uint8_t id) const;
+    const char *getName(uint8_t id) const;
+    uint8_t getTaskCount() const;
+    uint32_t getPasses() const; // Pasadas de runDue que ejecutaron algo (despertares útiles)
+    void resetStats();
+
+private:
+    struct Task
+    {
+        const char *name;
+        TaskFunction function;
+        void *context;
+        uint32_t periodMs;
+        uint32_t jitterMs;
+        uint32_t deadline;
+        uint8_t priority;
+        bool enabled;
+        TaskStats stats;
+    };
+
+    Task tasks[MAX_TASKS];
+    uint8_t taskCount;
+
+    // Min-heap de IDs habilitados ordenado por deadline
+    uint8_t heap[MAX_TASKS];
+    uint8_t heapSize;
+    uint8_t heapIndex[MAX_TASKS]; // Posición de cada tarea en el heap (INVALID_TASK si no está)
+
+    ClockFunction clock;
+    uint32_t passes;
+
+    // Tarea en ejecución: si se reprograma a sí misma no se toca su deadline
+    uint8_t runningTask;
+    bool runningTaskTouched;
+
+    static bool before(uint32_t a, uint32_t b);
+    bool heapLess(uint8_t a, uint8_t b) const;
+    void heapSwap(uint8_t i, uint8_t j);
+    void siftUp(uint8_t i);
+    void siftDown(uint8_t i);
+    void heapInsert(uint8_t id);
+    void heapRemove(uint8_t id);
+    void heapUpdate(uint8_t id);
+
+    void touch(uint8_t id);
+    bool runsBefore(uint8_t a, uint8_t b) const;
+    void runTask(uint8_t id);
+};
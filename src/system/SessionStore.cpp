@@ -0,0 +1,430 @@
+#include "SessionStore.h"
+#include <string.h>
+
+// ============================================================================
+// FORMATO EN FLASH
+// ============================================================================
+// "hdr"      -> magic(4) + longitud nonces(2) + longitud session(2)
+// "n0".."nF" -> bloques de 32 bytes del buffer de nonces
+// "s0".."sF" -> bloques de 32 bytes del buffer de session
+// "c0".."c7" -> log rotativo de FCnt: valor(4) + valor invertido(4)
+static const uint32_t STORE_MAGIC = 0x3153574C; // "LWS1"
+static const char *HEADER_KEY = "hdr";
+static const size_t HEADER_SIZE = 8;
+
+// ============================================================================
+// CONSTRUCTOR E INICIALIZACIÓN
+// ============================================================================
+
+SessionStore::SessionStore(Backend &backend, uint16_t counterInterval, uint16_t flushInterval)
+    : backend(backend),
+      counterInterval(counterInterval > 0 ? counterInterval : 1),
+      flushInterval(flushInterval > 0 ? flushInterval : 1),
+      headerValid(false),
+      loggedCounter(0),
+      nextCounterSlot(0),
+      uplinksSinceFlush(0)
+{
+    memset(blobs, 0, sizeof(blobs));
+    resetStats();
+}
+
+bool SessionStore::begin()
+{
+    for (uint8_t b = 0; b < BLOB_COUNT; b++)
+    {
+        blobs[b].valid = false;
+        blobs[b].length = 0;
+        blobs[b].dirtyMask = 0;
+    }
+    headerValid = false;
+    loggedCounter = 0;
+    nextCounterSlot = 0;
+    uplinksSinceFlush = 0;
+
+    if (!backend.begin(true))
+    {
+        return false;
+    }
+
+    uint8_t header[HEADER_SIZE];
+    if (backend.read(HEADER_KEY, header, HEADER_SIZE) == HEADER_SIZE)
+    {
+        uint32_t magic;
+        uint16_t lengths[BLOB_COUNT];
+        memcpy(&magic, header, 4);
+        memcpy(lengths, header + 4, 4);
+
+        if (magic == STORE_MAGIC &&
+            lengths[BLOB_NONCES] <= MAX_BLOB_SIZE && lengths[BLOB_SESSION] <= MAX_BLOB_SIZE)
+        {
+            headerValid = true;
+            for (uint8_t b = 0; b < BLOB_COUNT; b++)
+            {
+                BlobState &state = blobs[b];
+                state.length = lengths[b];
+                state.valid = state.length > 0;
+
+                for (uint8_t block = 0; block < blockCount(state.length) && state.valid; block++)
+                {
+                    char key[4];
+                    blockKey(key, (Blob)b, block);
+                    size_t offset = block * BLOCK_SIZE;
+                    size_t chunk = state.length - offset < BLOCK_SIZE ? state.length - offset : BLOCK_SIZE;
+                    if (backend.read(key, state.persisted + offset, chunk) != chunk)
+                    {
+                        state.valid = false;
+                    }
+                }
+                memcpy(state.staged, state.persisted, state.length);
+            }
+        }
+    }
+
+    // Buscar la entrada más alta del log de contadores
+    for (uint8_t slot = 0; slot < COUNTER_SLOTS; slot++)
+    {
+        char key[3];
+        counterKey(key, slot);
+        uint32_t entry[2];
+        if (backend.read(key, (uint8_t *)entry, sizeof(entry)) == sizeof(entry) &&
+            entry[0] == ~entry[1] && entry[0] >= loggedCounter)
+        {
+            loggedCounter = entry[0];
+            nextCounterSlot = (slot + 1) % COUNTER_SLOTS;
+        }
+    }
+
+    backend.end();
+    return hasSession();
+}
+
+bool SessionStore::hasSession() const
+{
+    return headerValid && blobs[BLOB_NONCES].valid && blobs[BLOB_SESSION].valid;
+}
+
+bool SessionStore::addVolatileRegion(Blob blob, size_t offset, size_t length)
+{
+    if (blob >= BLOB_COUNT || blobs[blob].volatileCount >= MAX_VOLATILE_REGIONS ||
+        offset + length > MAX_BLOB_SIZE)
+    {
+        return false;
+    }
+    BlobState &state = blobs[blob];
+    state.volatileRegions[state.volatileCount].offset = (uint16_t)offset;
+    state.volatileRegions[state.volatileCount].length = (uint16_t)length;
+    state.volatileCount++;
+    return true;
+}
+
+bool SessionStore::load(Blob blob, uint8_t *buffer, size_t length) const
+{
+    if (blob >= BLOB_COUNT || !blobs[blob].valid || blobs[blob].length != length)
+    {
+        return false;
+    }
+    memcpy(buffer, blobs[blob].persisted, length);
+    return true;
+}
+
+uint32_t SessionStore::restoredFrameCounter() const
+{
+    return loggedCounter + counterInterval;
+}
+
+// ============================================================================
+// DETECCIÓN DE CAMBIOS Y ESCRITURA
+// ============================================================================
+
+void SessionStore::stage(Blob blob, const uint8_t *data, size_t length)
+{
+    if (blob >= BLOB_COUNT || data == nullptr || length == 0 || length > MAX_BLOB_SIZE)
+        return;
+
+    BlobState &state = blobs[blob];
+    if (state.length != length)
+    {
+        // Cambio de formato: todo el blob es nuevo
+        state.length = length;
+        state.valid = false;
+        headerValid = false;
+    }
+    memcpy(state.staged, data, length);
+
+    for (uint8_t block = 0; block < blockCount(length); block++)
+    {
+        if (!state.valid || blockDiffers(state, block))
+        {
+            state.dirtyMask |= (1u << block);
+        }
+    }
+}
+
+bool SessionStore::commitUplink(uint32_t frameCounter)
+{
+    uplinksSinceFlush++;
+
+    bool counterDue = frameCounter >= loggedCounter + counterInterval;
+    bool flushDue = hasPendingChanges() && uplinksSinceFlush >= flushInterval;
+
+    if (!counterDue && !flushDue)
+    {
+        return true;
+    }
+
+    // Ambas escrituras comparten una sola apertura del namespace
+    return flush(frameCounter);
+}
+
+bool SessionStore::flush(uint32_t frameCounter)
+{
+    return writeAll(frameCounter, false);
+}
+
+bool SessionStore::startSession(uint32_t frameCounter)
+{
+    // Las entradas de la sesión anterior tienen FCnt altos: hay que pisarlas
+    // todas o el gap-jump saltaría miles de frames tras el próximo reinicio
+    return writeAll(frameCounter, true);
+}
+
+bool SessionStore::hasPendingChanges() const
+{
+    return !headerValid || blobs[BLOB_NONCES].dirtyMask != 0 || blobs[BLOB_SESSION].dirtyMask != 0;
+}
+
+void SessionStore::clear()
+{
+    if (backend.begin(false))
+    {
+        backend.clear();
+        backend.end();
+    }
+    for (uint8_t b = 0; b < BLOB_COUNT; b++)
+    {
+        blobs[b].valid = false;
+        blobs[b].length = 0;
+        blobs[b].dirtyMask = 0;
+    }
+    headerValid = false;
+    loggedCounter = 0;
+    nextCounterSlot = 0;
+    uplinksSinceFlush = 0;
+}
+
+const SessionStore::Stats &SessionStore::getStats() const
+{
+    return stats;
+}
+
+void SessionStore::resetStats()
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+// ============================================================================
+// MÉTODOS PRIVADOS
+// ============================================================================
+
+bool SessionStore::writeAll(uint32_t frameCounter, bool resetCounterLog)
+{
+    if (!backend.begin(false))
+    {
+        return false;
+    }
+    stats.transactions++;
+
+    bool ok = true;
+    if (!headerValid)
+    {
+        ok = writeHeader() && ok;
+    }
+    ok = writeDirty() && ok;
+
+    if (resetCounterLog)
+    {
+        loggedCounter = 0;
+        for (uint8_t slot = 0; slot < COUNTER_SLOTS; slot++)
+        {
+            ok = writeCounter(frameCounter) && ok;
+        }
+    }
+    else if (frameCounter > loggedCounter)
+    {
+        ok = writeCounter(frameCounter) && ok;
+    }
+
+    backend.end();
+    uplinksSinceFlush = 0;
+    return ok;
+}
+
+bool SessionStore::writeDirty()
+{
+    bool ok = true;
+    for (uint8_t b = 0; b < BLOB_COUNT; b++)
+    {
+        BlobState &state = blobs[b];
+        for (uint8_t block = 0; block < blockCount(state.length); block++)
+        {
+            if (!(state.dirtyMask & (1u << block)))
+                continue;
+
+            char key[4];
+            blockKey(key, (Blob)b, block);
+            size_t offset = block * BLOCK_SIZE;
+            size_t chunk = state.length - offset < BLOCK_SIZE ? state.length - offset : BLOCK_SIZE;
+
+            if (backendWrite(key, state.staged + offset, chunk) == chunk)
+            {
+                memcpy(state.persisted + offset, state.staged + offset, chunk);
+                state.dirtyMask &= ~(1u << block);
+                stats.blockWrites++;
+            }
+            else
+            {
+                ok = false;
+            }
+        }
+        if (state.dirtyMask == 0 && state.length > 0)
+        {
+            state.valid = true;
+        }
+    }
+    return ok;
+}
+
+bool SessionStore::writeHeader()
+{
+    uint8_t header[HEADER_SIZE];
+    uint16_t lengths[BLOB_COUNT] = {(uint16_t)blobs[BLOB_NONCES].length,
+                                    (uint16_t)blobs[BLOB_SESSION].length};
+    memcpy(header, &STORE_MAGIC, 4);
+    memcpy(header + 4, lengths, 4);
+
+    headerValid = backendWrite(HEADER_KEY, header, HEADER_SIZE) == HEADER_SIZE;
+    return headerValid;
+}
+
+bool SessionStore::writeCounter(uint32_t frameCounter)
+{
+    char key[3];
+    counterKey(key, nextCounterSlot);
+    uint32_t entry[2] = {frameCounter, ~frameCounter};
+
+    if (backendWrite(key, (const uint8_t *)entry, sizeof(entry)) != sizeof(entry))
+    {
+        return false;
+    }
+
+    loggedCounter = frameCounter;
+    nextCounterSlot = (nextCounterSlot + 1) % COUNTER_SLOTS;
+    stats.counterWrites++;
+    return true;
+}
+
+size_t SessionStore::backendWrite(const char *key, const uint8_t *data, size_t length)
+{
+    size_t written = backend.write(key, data, length);
+    stats.writes++;
+    stats.bytesWritten += written;
+    return written;
+}
+
+void SessionStore::blockKey(char *key, Blob blob, uint8_t block)
+{
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    key[0] = (blob == BLOB_NONCES) ? 'n' : 's';
+    key[1] = HEX_DIGITS[block & 0x0F];
+    key[2] = '\0';
+}
+
+void SessionStore::counterKey(char *key, uint8_t slot)
+{
+    key[0] = 'c';
+    key[1] = (char)('0' + slot);
+    key[2] = '\0';
+}
+
+uint8_t SessionStore::blockCount(size_t length)
+{
+    return (uint8_t)((length + BLOCK_SIZE - 1) / BLOCK_SIZE);
+}
+
+bool SessionStore::blockDiffers(const BlobState &state, uint8_t block) const
+{
+    size_t start = block * BLOCK_SIZE;
+    size_t end = start + BLOCK_SIZE < state.length ? start + BLOCK_SIZE : state.length;
+
+    for (size_t i = start; i < end; i++)
+    {
+        if (state.staged[i] != state.persisted[i] && !isVolatile(state, i))
+            return true;
+    }
+    return false;
+}
+
+bool SessionStore::isVolatile(const BlobState &state, size_t index)
+{
+    // FCnt y firma: cubiertos por el log de contadores
+    for (uint8_t r = 0; r < state.volatileCount; r++)
+    {
+        size_t start = state.volatileRegions[r].offset;
+        if (index >= start && index < start + state.volatileRegions[r].length)
+            return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// BACKEND NVS (SOLO DISPOSITIVO)
+// ============================================================================
+#ifdef ARDUINO
+
+NvsSessionBackend::NvsSessionBackend(const char *ns) : ns(ns), open(false)
+{
+}
+
+bool NvsSessionBackend::begin(bool readOnly)
+{
+    if (open)
+    {
+        prefs.end();
+    }
+    open = prefs.begin(ns, readOnly);
+    return open;
+}
+
+void NvsSessionBackend::end()
+{
+    if (open)
+    {
+        prefs.end();
+        open = false;
+    }
+}
+
+size_t NvsSessionBackend::read(const char *key, uint8_t *buffer, size_t length)
+{
+    if (!open || !prefs.isKey(key))
+        return 0;
+    return prefs.getBytes(key, buffer, length);
+}
+
+size_t NvsSessionBackend::write(const char *key, const uint8_t *data, size_t length)
+{
+    if (!open)
+        return 0;
+    return prefs.putBytes(key, data, length);
+}
+
+void NvsSessionBackend::clear()
+{
+    if (open)
+    {
+        prefs.clear();
+    }
+}
+
+#endif
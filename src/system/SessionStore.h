@@ -0,0 +1,155 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+#include <Preferences.h>
+#endif
+
+/*
+ * ============================================================================
+ * SESSION STORE - PERSISTENCIA INCREMENTAL DE LA SESIÓN LORAWAN
+ * ============================================================================
+ * Guarda los buffers de RadioLib (nonces y session) en bloques de 32 bytes y
+ * solo reescribe los bloques cuyo contenido cambió. Los bytes que cambian en
+ * cada uplink (frame counter y firma) se declaran como región volátil: no
+ * provocan escrituras por sí solos y el contador se guarda aparte en un log
+ * rotativo cada N uplinks. Al restaurar se salta N frames hacia adelante
+ * (gap-jump) para que el servidor nunca vea un FCnt repetido.
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+class SessionStore
+{
+public:
+    // Backend clave/valor (NVS en el dispositivo, RAM en los tests)
+    class Backend
+    {
+    public:
+        virtual ~Backend() {}
+
+        // Agrupa varias operaciones en una sola apertura del namespace
+        virtual bool begin(bool readOnly) = 0;
+        virtual void end() = 0;
+
+        virtual size_t read(const char *key, uint8_t *buffer, size_t length) = 0;
+        virtual size_t write(const char *key, const uint8_t *data, size_t length) = 0;
+        virtual void clear() = 0;
+    };
+
+    enum Blob : uint8_t
+    {
+        BLOB_NONCES = 0,
+        BLOB_SESSION,
+        BLOB_COUNT
+    };
+
+    struct Stats
+    {
+        uint32_t writes;       // Llamadas a Backend::write
+        uint32_t bytesWritten; // Bytes de payload escritos
+        uint32_t transactions; // Aperturas del namespace
+        uint32_t counterWrites;
+        uint32_t blockWrites;
+    };
+
+    static const size_t BLOCK_SIZE = 32;
+    static const size_t MAX_BLOB_SIZE = 512;
+    static const uint8_t COUNTER_SLOTS = 8;
+    static const uint8_t MAX_VOLATILE_REGIONS = 2;
+
+    // counterInterval: uplinks entre escrituras del log de FCnt (= salto al restaurar)
+    // flushInterval: uplinks máximos que un cambio de contenido espera en RAM
+    SessionStore(Backend &backend, uint16_t counterInterval = 16, uint16_t flushInterval = 16);
+
+    // Carga el estado persistido en la copia sombra. false si no hay sesión válida.
+    bool begin();
+    bool hasSession() const;
+
+    // Región que cambia en cada uplink y no debe disparar escrituras
+    bool addVolatileRegion(Blob blob, size_t offset, size_t length);
+
+    // Copia el blob persistido (tal como quedó en flash)
+    bool load(Blob blob, uint8_t *buffer, size_t length) const;
+
+    // FCnt seguro para reanudar: último valor registrado + intervalo del log
+    uint32_t restoredFrameCounter() const;
+
+    // Compara con lo persistido y marca los bloques modificados
+    void stage(Blob blob, const uint8_t *data, size_t length);
+
+    // Llamar tras cada uplink. Escribe el log de FCnt y los bloques pendientes
+    // solo cuando corresponde. Devuelve false solo si falló una escritura.
+    bool commitUplink(uint32_t frameCounter);
+
+    // Fuerza la escritura de todo lo pendiente (downlinks con comandos MAC)
+    bool flush(uint32_t frameCounter);
+
+    // Nueva sesión (JOIN): escribe lo pendiente y reinicia todo el log de FCnt
+    bool startSession(uint32_t frameCounter = 0);
+
+    bool hasPendingChanges() const;
+    void clear();
+
+    const Stats &getStats() const;
+    void resetStats();
+
+private:
+    Backend &backend;
+    uint16_t counterInterval;
+    uint16_t flushInterval;
+
+    struct BlobState
+    {
+        uint8_t persisted[MAX_BLOB_SIZE]; // Copia de lo que hay en flash
+        uint8_t staged[MAX_BLOB_SIZE];    // Última versión recibida
+        size_t length;
+        struct
+        {
+            uint16_t offset;
+            uint16_t length;
+        } volatileRegions[MAX_VOLATILE_REGIONS];
+        uint8_t volatileCount;
+        uint16_t dirtyMask; // Un bit por bloque (MAX_BLOB_SIZE / BLOCK_SIZE = 16)
+        bool valid;
+    } blobs[BLOB_COUNT];
+
+    bool headerValid;
+    uint32_t loggedCounter;
+    uint8_t nextCounterSlot;
+    uint16_t uplinksSinceFlush;
+    Stats stats;
+
+    bool writeAll(uint32_t frameCounter, bool resetCounterLog);
+    bool writeDirty();
+    bool writeHeader();
+    bool writeCounter(uint32_t frameCounter);
+    size_t backendWrite(const char *key, const uint8_t *data, size_t length);
+
+    static void blockKey(char *key, Blob blob, uint8_t block);
+    static void counterKey(char *key, uint8_t slot);
+    static uint8_t blockCount(size_t length);
+    bool blockDiffers(const BlobState &state, uint8_t block) const;
+    static bool isVolatile(const BlobState &state, size_t index);
+};
+
+#ifdef ARDUINO
+// Backend NVS sobre Preferences, con un único namespace
+class NvsSessionBackend : public SessionStore::Backend
+{
+public:
+    explicit NvsSessionBackend(const char *ns);
+
+    bool begin(bool readOnly) override;
+    void end() override;
+    size_t read(const char *key, uint8_t *buffer, size_t length) override;
+    size_t write(const char *key, const uint8_t *data, size_t length) override;
+    void clear() override;
+
+private:
+    Preferences prefs;
+    const char *ns;
+    bool open;
+};
+#endif
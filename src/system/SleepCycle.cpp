@@ -0,0 +1,346 @@
+#include "SleepCycle.h"
+#include "FragmentAssembler.h"
+#include <math.h>
+#include <string.h>
+
+// ============================================================================
+// CONSTRUCTOR Y VALIDEZ
+// ============================================================================
+
+SleepCycle::SleepCycle(Snapshot &snapshot, const Policy &policy, const EnergyModel::Currents &currents)
+    : snapshot(snapshot),
+      policy(policy),
+      currents(currents)
+{
+}
+
+bool SleepCycle::resume() const
+{
+    return snapshot.magic == MAGIC && snapshot.version == VERSION && snapshot.crc == computeCrc();
+}
+
+void SleepCycle::reset()
+{
+    memset(&snapshot, 0, sizeof(snapshot));
+}
+
+void SleepCycle::seal()
+{
+    snapshot.magic = MAGIC;
+    snapshot.version = VERSION;
+    snapshot.crc = computeCrc();
+}
+
+uint16_t SleepCycle::computeCrc() const
+{
+    // El padding no cambia mientras el snapshot está en RTC memory
+    return FragmentAssembler::crc16((const uint8_t *)&snapshot, offsetof(Snapshot, crc));
+}
+
+// ============================================================================
+// FILTRO DE ENTRADA Y SALIDA
+// ============================================================================
+
+uint32_t SleepCycle::onFix(float distance, AlertLevel level)
+{
+    snapshot.lastDistance = distance;
+
+    // Cualquier alerta o acercarse al borde corta la racha (y el ciclo)
+    if (level != AlertLevel::SAFE || -distance < policy.minInsideMeters)
+    {
+        snapshot.safeStreak = 0;
+        return 0;
+    }
+
+    if (snapshot.safeStreak < 255)
+    {
+        snapshot.safeStreak++;
+    }
+    if (snapshot.safeStreak < policy.safeFixes)
+    {
+        return 0;
+    }
+    return sleepDuration(distance);
+}
+
+uint32_t SleepCycle::sleepDuration(float distance) const
+{
+    float margin = -distance - policy.cautionMeters;
+    if (margin <= 0.0f || policy.animalSpeed <= 0.0f)
+    {
+        return 0;
+    }
+
+    float ms = margin / policy.animalSpeed * 1000.0f;
+    if (ms < policy.minSleepMs)
+    {
+        return 0;
+    }
+    return ms > policy.maxSleepMs ? policy.maxSleepMs : (uint32_t)ms;
+}
+
+// ============================================================================
+// SESIÓN LORAWAN
+// ============================================================================
+
+bool SleepCycle::storeSession(const uint8_t *nonces, size_t noncesLength, const uint8_t *session, size_t sessionLength)
+{
+    if (!nonces || !session || noncesLength > MAX_NONCES || sessionLength > MAX_SESSION)
+    {
+        snapshot.noncesLength = 0;
+        snapshot.sessionLength = 0;
+        return false;
+    }
+
+    memcpy(snapshot.nonces, nonces, noncesLength);
+    memcpy(snapshot.session, session, sessionLength);
+    snapshot.noncesLength = noncesLength;
+    snapshot.sessionLength = sessionLength;
+    return true;
+}
+
+bool SleepCycle::loadSession(uint8_t *nonces, size_t noncesLength, uint8_t *session, size_t sessionLength) const
+{
+    // Otro tamaño de buffer = otra versión de RadioLib: no se reutiliza
+    if (!hasSession() || noncesLength != snapshot.noncesLength || sessionLength != snapshot.sessionLength)
+    {
+        return false;
+    }
+
+    memcpy(nonces, snapshot.nonces, noncesLength);
+    memcpy(session, snapshot.session, sessionLength);
+    return true;
+}
+
+bool SleepCycle::hasSession() const
+{
+    return snapshot.noncesLength > 0 && snapshot.sessionLength > 0;
+}
+
+// ============================================================================
+// GEOCERCA Y POSICIÓN
+// ============================================================================
+
+bool SleepCycle::storeGeofence(const Geofence &fence)
+{
+    snapshot.fenceConfigured = false;
+    if (!fence.isConfigured || fence.pointCount > GEOFENCE_MAX_VERTICES)
+    {
+        return false;
+    }
+
+    snapshot.fenceActive = fence.active;
+    snapshot.fenceType = (uint8_t)fence.type;
+    snapshot.fenceId = fence.fenceId;
+    snapshot.fenceVersion = fence.version;
+    memcpy(snapshot.fenceName, fence.name, sizeof(snapshot.fenceName));
+    memcpy(snapshot.fenceGroup, fence.groupId, sizeof(snapshot.fenceGroup));
+    snapshot.fenceCenter[0] = toFixed(fence.centerLat);
+    snapshot.fenceCenter[1] = toFixed(fence.centerLng);
+    snapshot.fenceRadius = fence.radius;
+
+    snapshot.vertexCount = fence.type == GeofenceType::POLYGON ? fence.pointCount : 0;
+    const GeoPoint *points = fence.getPoints();
+    for (uint16_t i = 0; i < snapshot.vertexCount; i++)
+    {
+        snapshot.vertices[i][0] = toFixed(points[i].lat);
+        snapshot.vertices[i][1] = toFixed(points[i].lng);
+    }
+
+    snapshot.fenceConfigured = true;
+    return true;
+}
+
+bool SleepCycle::loadGeofence(Geofence &fence, GeoPoint *vertices, uint16_t maxVertices) const
+{
+    if (!snapshot.fenceConfigured || snapshot.vertexCount > maxVertices)
+    {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < snapshot.vertexCount; i++)
+    {
+        vertices[i] = GeoPoint(fromFixed(snapshot.vertices[i][0]), fromFixed(snapshot.vertices[i][1]));
+    }
+
+    char name[sizeof(snapshot.fenceName) + 1];
+    char group[sizeof(snapshot.fenceGroup) + 1];
+    memcpy(name, snapshot.fenceName, sizeof(snapshot.fenceName));
+    memcpy(group, snapshot.fenceGroup, sizeof(snapshot.fenceGroup));
+    name[sizeof(snapshot.fenceName)] = '\0';
+    group[sizeof(snapshot.fenceGroup)] = '\0';
+
+    if ((GeofenceType)snapshot.fenceType == GeofenceType::POLYGON)
+    {
+        fence = Geofence(vertices, snapshot.vertexCount, name, group);
+    }
+    else
+    {
+        fence = Geofence(fromFixed(snapshot.fenceCenter[0]), fromFixed(snapshot.fenceCenter[1]),
+                         snapshot.fenceRadius, name, group);
+    }
+    fence.active = snapshot.fenceActive;
+    fence.fenceId = snapshot.fenceId;
+    fence.version = snapshot.fenceVersion;
+    return true;
+}
+
+void SleepCycle::storePosition(const Position &position)
+{
+    snapshot.positionValid = position.valid;
+    snapshot.satellites = position.satellites;
+    snapshot.latitude = toFixed(position.latitude);
+    snapshot.longitude = toFixed(position.longitude);
+}
+
+Position SleepCycle::lastPosition() const
+{
+    Position position;
+    position.latitude = fromFixed(snapshot.latitude);
+    position.longitude = fromFixed(snapshot.longitude);
+    position.satellites = snapshot.satellites;
+    position.valid = snapshot.positionValid;
+    return position;
+}
+
+void SleepCycle::storeBattery(const BatteryEstimator::State &state)
+{
+    snapshot.battery = state;
+}
+
+bool SleepCycle::loadBattery(BatteryEstimator::State &state) const
+{
+    if (!snapshot.battery.ready)
+    {
+        return false;
+    }
+    state = snapshot.battery;
+    return true;
+}
+
+void SleepCycle::storeStimulus(bool adaptive, const StimulusPolicy::Config &config,
+                               const StimulusPolicy::State &state)
+{
+    snapshot.stimulusStored = true;
+    snapshot.stimulusAdaptive = adaptive;
+    snapshot.stimulusEscalateMs = config.escalateAfterMs;
+    snapshot.stimulusDailyCap = config.dailyCap;
+    snapshot.stimulusTurnBackMeters = config.turnBackMeters;
+    snapshot.stimulus = state;
+}
+
+bool SleepCycle::loadStimulus(bool &adaptive, StimulusPolicy::Config &config, StimulusPolicy::State &state) const
+{
+    if (!snapshot.stimulusStored)
+    {
+        return false;
+    }
+    adaptive = snapshot.stimulusAdaptive;
+    config.escalateAfterMs = snapshot.stimulusEscalateMs;
+    config.dailyCap = snapshot.stimulusDailyCap;
+    config.turnBackMeters = snapshot.stimulusTurnBackMeters;
+    state = snapshot.stimulus;
+    return true;
+}
+
+// ============================================================================
+// MÉTRICAS
+// ============================================================================
+
+void SleepCycle::recordWake(uint32_t bootToFixMs, uint32_t awakeMs, uint32_t radioMs, float airtimeMs)
+{
+    Stats &stats = snapshot.stats;
+    stats.cycles++;
+
+    if (bootToFixMs > 0)
+    {
+        stats.fixes++;
+        stats.lastBootToFixMs = bootToFixMs;
+        stats.totalBootToFixMs += bootToFixMs;
+        if (bootToFixMs > stats.maxBootToFixMs)
+        {
+            stats.maxBootToFixMs = bootToFixMs;
+        }
+    }
+    else
+    {
+        stats.fixTimeouts++;
+    }
+
+    // Despierto a 80 MHz sin descontar el light sleep (cota superior), GPS
+    // en adquisición y la radio en RX salvo el tiempo en el aire
+    float awakeCurrent = currents.cpuActive80 + currents.gps + currents.board;
+    float mah = (awakeMs * awakeCurrent + radioMs * currents.radioRx +
+                 airtimeMs * (currents.radioTx - currents.radioRx)) /
+                3600000.0f;
+
+    stats.lastAwakeMs = awakeMs;
+    stats.totalAwakeMs += awakeMs;
+    stats.lastWakeMah = mah;
+    stats.totalWakeMah += mah;
+    snapshot.sinceUplinkMs += awakeMs;
+}
+
+void SleepCycle::recordSleep(uint32_t sleepMs)
+{
+    snapshot.sleepMs = sleepMs;
+    snapshot.stats.totalSleepMs += sleepMs;
+    snapshot.sinceUplinkMs += sleepMs;
+}
+
+bool SleepCycle::uplinkDue() const
+{
+    return snapshot.sinceUplinkMs >= policy.uplinkIntervalMs;
+}
+
+void SleepCycle::uplinkSent()
+{
+    snapshot.sinceUplinkMs = 0;
+    snapshot.stats.uplinks++;
+}
+
+float SleepCycle::sleepMah(uint32_t sleepMs) const
+{
+    float current = currents.deepSleep + currents.board + currents.radioSleep;
+    if (policy.gpsPoweredInSleep)
+    {
+        current += currents.gps;
+    }
+    return sleepMs * current / 3600000.0f;
+}
+
+float SleepCycle::averageMahPerDay() const
+{
+    const Stats &stats = snapshot.stats;
+    float elapsedMs = (float)stats.totalAwakeMs + (float)stats.totalSleepMs;
+    if (elapsedMs <= 0.0f)
+    {
+        return 0.0f;
+    }
+    float mah = stats.totalWakeMah + sleepMah(stats.totalSleepMs);
+    return mah * EnergyModel::SECONDS_PER_DAY * 1000.0f / elapsedMs;
+}
+
+const SleepCycle::Stats &SleepCycle::getStats() const
+{
+    return snapshot.stats;
+}
+
+const SleepCycle::Policy &SleepCycle::getPolicy() const
+{
+    return policy;
+}
+
+// ============================================================================
+// UTILIDADES
+// ============================================================================
+
+int32_t SleepCycle::toFixed(double degrees)
+{
+    return (int32_t)lround(degrees * 1e7);
+}
+
+double SleepCycle::fromFixed(int32_t value)
+{
+    return value / 1e7;
+}
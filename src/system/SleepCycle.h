@@ -0,0 +1,192 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "../config/constants.h"
+#include "../core/Types.h"
+#include "EnergyModel.h"
+#include "BatteryEstimator.h"
+#include "StimulusPolicy.h"
+
+/*
+ * ============================================================================
+ * SLEEP CYCLE - MODO CICLO CON DEEP SLEEP ENTRE POSICIONES
+ * ============================================================================
+ * Para animales en potreros seguros: mientras el collar esté bien dentro de
+ * la geocerca duerme en deep sleep entre posiciones y al despertar retoma
+ * desde el estado retenido en la memoria RTC, sin pasar por el arranque
+ * completo (splash, melodía, esperas de VEXT, JOIN).
+ *
+ * El Snapshot vive en RTC slow memory (RTC_DATA_ATTR en main.cpp) y guarda:
+ * - los buffers de sesión de RadioLib (el FCnt exacto, sin salto)
+ * - la geocerca activa, con vértices en 1e-7° como en los uplinks
+ * - el filtro de entrada/salida del modo y la última posición
+ * - métricas de cada despertar: arranque→fix, tiempo despierto y energía
+ * - el estado de carga y la corriente media (BatteryEstimator)
+ * - la política de estímulos: cuál, su configuración, lo aprendido del
+ *   animal y los estímulos del día (StimulusPolicy)
+ *
+ * La RTC memory se pierde al quitar la batería, igual que la geocerca en RAM:
+ * no cambia la política de no persistir geocercas en flash.
+ *
+ * El tiempo de sueño se elige para que el animal no alcance la zona de
+ * precaución antes de volver a medir: (distancia al borde - precaución) /
+ * velocidad máxima del animal, hasta maxSleepMs. Si no alcanza minSleepMs
+ * no vale la pena dormir.
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+class SleepCycle
+{
+public:
+    static const uint32_t MAGIC = 0x31435943; // "CYC1"
+    static const uint16_t VERSION = 3;
+    static const size_t MAX_NONCES = 64;
+    static const size_t MAX_SESSION = 512;
+
+    struct Policy
+    {
+        float minInsideMeters;     // Distancia mínima al borde para dormir
+        float cautionMeters;       // Zona de precaución que no puede alcanzar dormido
+        uint8_t safeFixes;         // Posiciones seguidas cumpliéndola antes de entrar
+        float animalSpeed;         // m/s que puede recorrer mientras duerme
+        uint32_t minSleepMs;
+        uint32_t maxSleepMs;
+        uint32_t fixTimeoutMs;     // Sin fix en este tiempo se vuelve al modo normal
+        uint32_t uplinkIntervalMs; // Uplink de posición en los despertares que toque
+        bool gpsPoweredInSleep;    // VEXT retenido: hot start a costa de la corriente del GPS
+
+        Policy() : minInsideMeters(DEEP_SLEEP_MIN_INSIDE_M), cautionMeters(DEEP_SLEEP_CAUTION_M),
+                   safeFixes(DEEP_SLEEP_SAFE_FIXES), animalSpeed(DEEP_SLEEP_ANIMAL_SPEED), minSleepMs(DEEP_SLEEP_MIN_MS),
+                   maxSleepMs(DEEP_SLEEP_MAX_MS), fixTimeoutMs(DEEP_SLEEP_FIX_TIMEOUT),
+                   uplinkIntervalMs(LORA_TX_INTERVAL), gpsPoweredInSleep(DEEP_SLEEP_GPS_POWERED) {}
+    };
+
+    // Métricas acumuladas de los despertares (retenidas con el resto)
+    struct Stats
+    {
+        uint32_t cycles;           // Despertares del modo ciclo
+        uint32_t fixes;
+        uint32_t fixTimeouts;
+        uint32_t uplinks;
+        uint32_t lastBootToFixMs;  // Desde el arranque de la aplicación hasta el fix
+        uint32_t maxBootToFixMs;
+        uint32_t totalBootToFixMs;
+        uint32_t lastAwakeMs;
+        uint32_t totalAwakeMs;
+        uint32_t totalSleepMs;
+        float lastWakeMah;         // Energía estimada del último despertar
+        float totalWakeMah;
+    };
+
+    // Estado retenido en RTC. POD: se valida con magic, versión y CRC-16
+    struct Snapshot
+    {
+        uint32_t magic;
+        uint16_t version;
+
+        // Sesión LoRaWAN (buffers de RadioLib)
+        uint16_t noncesLength;
+        uint16_t sessionLength;
+        uint8_t nonces[MAX_NONCES];
+        uint8_t session[MAX_SESSION];
+
+        // Geocerca activa
+        bool fenceConfigured;
+        bool fenceActive;
+        uint8_t fenceType;
+        uint8_t fenceVersion;
+        uint16_t fenceId;
+        uint16_t vertexCount;
+        char fenceName[32];
+        char fenceGroup[16];
+        int32_t fenceCenter[2];
+        float fenceRadius;
+        int32_t vertices[GEOFENCE_MAX_VERTICES][2];
+
+        // Filtro del modo y última posición
+        uint8_t safeStreak;
+        bool positionValid;
+        uint8_t satellites;
+        int32_t latitude;
+        int32_t longitude;
+        float lastDistance;
+        uint32_t sleepMs;      // Duración del último deep sleep pedido
+        uint32_t sinceUplinkMs;
+
+        Stats stats;
+        BatteryEstimator::State battery;
+
+        // Política de estímulos (Config tiene constructor: campo por campo)
+        bool stimulusStored;
+        bool stimulusAdaptive;
+        uint32_t stimulusEscalateMs;
+        uint16_t stimulusDailyCap;
+        float stimulusTurnBackMeters;
+        StimulusPolicy::State stimulus;
+
+        uint16_t crc; // De todo lo anterior
+    };
+
+    explicit SleepCycle(Snapshot &snapshot, const Policy &policy = Policy(),
+                        const EnergyModel::Currents &currents = EnergyModel::Currents());
+
+    // true si el snapshot es válido: se puede retomar el ciclo
+    bool resume() const;
+
+    // Arranque en frío: el snapshot deja de ser válido y se borran las métricas
+    void reset();
+
+    // Calcula el CRC; llamar justo antes de dormir
+    void seal();
+
+    /**
+     * Filtro de entrada/salida. Llamar con cada evaluación de la geocerca
+     * @param distance Distancia al borde (negativa = dentro)
+     * @return ms a dormir, o 0 si hay que seguir (o volver) en modo normal
+     */
+    uint32_t onFix(float distance, AlertLevel level);
+    uint32_t sleepDuration(float distance) const;
+
+    // Sesión LoRaWAN
+    bool storeSession(const uint8_t *nonces, size_t noncesLength, const uint8_t *session, size_t sessionLength);
+    bool loadSession(uint8_t *nonces, size_t noncesLength, uint8_t *session, size_t sessionLength) const;
+    bool hasSession() const;
+
+    // Geocerca. loadGeofence deja fence.vertices apuntando a vertices si es un polígono grande
+    bool storeGeofence(const Geofence &fence);
+    bool loadGeofence(Geofence &fence, GeoPoint *vertices, uint16_t maxVertices) const;
+
+    void storePosition(const Position &position);
+    Position lastPosition() const;
+
+    // Estado de carga: false si no se guardó uno válido
+    void storeBattery(const BatteryEstimator::State &state);
+    bool loadBattery(BatteryEstimator::State &state) const;
+
+    // Política de estímulos: false si no se guardó
+    void storeStimulus(bool adaptive, const StimulusPolicy::Config &config, const StimulusPolicy::State &state);
+    bool loadStimulus(bool &adaptive, StimulusPolicy::Config &config, StimulusPolicy::State &state) const;
+
+    // Métricas. bootToFixMs = 0 si no hubo fix
+    void recordWake(uint32_t bootToFixMs, uint32_t awakeMs, uint32_t radioMs, float airtimeMs);
+    void recordSleep(uint32_t sleepMs);
+    bool uplinkDue() const;
+    void uplinkSent();
+
+    // Consumo medio del modo con las métricas medidas (mAh/día)
+    float averageMahPerDay() const;
+    float sleepMah(uint32_t sleepMs) const;
+
+    const Stats &getStats() const;
+    const Policy &getPolicy() const;
+
+private:
+    Snapshot &snapshot;
+    Policy policy;
+    EnergyModel::Currents currents;
+
+    uint16_t computeCrc() const;
+    static int32_t toFixed(double degrees);
+    static double fromFixed(int32_t value);
+};
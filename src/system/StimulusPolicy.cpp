@@ -0,0 +1,284 @@
+#include "StimulusPolicy.h"
+#include <string.h>
+
+StimulusPolicy::StimulusPolicy(const Config &config)
+    : config(config),
+      stats(),
+      inEpisode(false),
+      sounding(AlertLevel::SAFE),
+      audible(false),
+      turnedBack(false),
+      levelSince(0),
+      extreme(0.0f),
+      dayStart(0)
+{
+}
+
+// ============================================================================
+// EPISODIO
+// ============================================================================
+
+StimulusPolicy::Decision StimulusPolicy::update(AlertLevel fenceLevel, float distance, uint32_t now)
+{
+    rollDay(now);
+
+    if (fenceLevel == AlertLevel::SAFE)
+    {
+        stop();
+        return {AlertLevel::SAFE, false};
+    }
+
+    if (!inEpisode)
+    {
+        inEpisode = true;
+        stats.episodes++;
+        turnedBack = false;
+        extreme = distance;
+    }
+
+    // Respuesta: extreme es el punto más externo mientras sale y el más
+    // interno después de volver (si sale de nuevo, corre otro plazo)
+    if (!turnedBack)
+    {
+        if (distance > extreme)
+        {
+            extreme = distance;
+        }
+        else if (sounding > AlertLevel::SAFE && extreme - distance >= config.turnBackMeters)
+        {
+            uint32_t elapsed = now - levelSince;
+            uint8_t index = static_cast<uint8_t>(sounding);
+            stats.responses[index]++;
+            stats.responseMs[index] += elapsed;
+            onResponse(sounding, elapsed);
+            turnedBack = true;
+            extreme = distance;
+        }
+    }
+    else if (distance < extreme)
+    {
+        extreme = distance;
+    }
+    else if (distance - extreme >= config.turnBackMeters)
+    {
+        turnedBack = false;
+        extreme = distance;
+        levelSince = now;
+    }
+
+    if (fenceLevel > sounding)
+    {
+        raise(fenceLevel, now);
+    }
+    else if (fenceLevel < sounding && turnedBack)
+    {
+        // Baja con la geocerca solo si ya volvió: la escalada por tiempo se mantiene
+        sounding = fenceLevel;
+        levelSince = now;
+    }
+    else if (!turnedBack && sounding < AlertLevel::WARNING && now - levelSince >= escalationDelay(sounding))
+    {
+        stats.escalations++;
+        raise(AlertLevel::WARNING, now);
+    }
+
+    return {sounding, audible};
+}
+
+void StimulusPolicy::stop()
+{
+    inEpisode = false;
+    sounding = AlertLevel::SAFE;
+    audible = false;
+    turnedBack = false;
+}
+
+void StimulusPolicy::raise(AlertLevel level, uint32_t now)
+{
+    sounding = level;
+    levelSince = now;
+
+    if (config.dailyCap == 0 || stats.stimuliToday < config.dailyCap)
+    {
+        audible = true;
+        stats.stimuliToday++;
+        stats.stimuli++;
+    }
+    else
+    {
+        audible = false;
+        stats.suppressed++;
+    }
+}
+
+// Días de 24 h contados desde el arranque (el collar no tiene hora local)
+void StimulusPolicy::rollDay(uint32_t now)
+{
+    uint32_t elapsed = now - dayStart;
+    if (elapsed >= DAY_MS)
+    {
+        dayStart += (elapsed / DAY_MS) * DAY_MS;
+        stats.stimuliToday = 0;
+    }
+}
+
+void StimulusPolicy::onResponse(AlertLevel level, uint32_t elapsedMs)
+{
+    (void)level;
+    (void)elapsedMs;
+}
+
+// ============================================================================
+// CONFIGURACIÓN Y ESTADO
+// ============================================================================
+
+void StimulusPolicy::setConfig(const Config &config)
+{
+    this->config = config;
+    // Un downlink con 0 s escalaría a WARNING en cuanto entra en CAUTION
+    if (this->config.escalateAfterMs < STIMULUS_MIN_ESCALATE_MS)
+    {
+        this->config.escalateAfterMs = STIMULUS_MIN_ESCALATE_MS;
+    }
+}
+
+const StimulusPolicy::Config &StimulusPolicy::getConfig() const
+{
+    return config;
+}
+
+const StimulusPolicy::Stats &StimulusPolicy::getStats() const
+{
+    return stats;
+}
+
+uint32_t StimulusPolicy::averageResponseMs(AlertLevel level) const
+{
+    uint8_t index = static_cast<uint8_t>(level);
+    if (index >= 3 || stats.responses[index] == 0)
+    {
+        return 0;
+    }
+    return stats.responseMs[index] / stats.responses[index];
+}
+
+StimulusPolicy::State StimulusPolicy::getState(uint32_t now) const
+{
+    State state;
+    memset(&state, 0, sizeof(state));
+    uint32_t elapsed = now - dayStart;
+    state.dayElapsedMs = elapsed % DAY_MS;
+    state.stimuliToday = elapsed < DAY_MS ? stats.stimuliToday : 0;
+    return state;
+}
+
+void StimulusPolicy::restore(const State &state, uint32_t now)
+{
+    dayStart = now - state.dayElapsedMs % DAY_MS;
+    stats.stimuliToday = state.stimuliToday;
+}
+
+// ============================================================================
+// POLÍTICA FIJA
+// ============================================================================
+
+FixedStimulusPolicy::FixedStimulusPolicy(const Config &config)
+    : StimulusPolicy(config)
+{
+}
+
+const char *FixedStimulusPolicy::getName() const
+{
+    return "fija";
+}
+
+uint32_t FixedStimulusPolicy::escalationDelay(AlertLevel level) const
+{
+    (void)level;
+    return config.escalateAfterMs;
+}
+
+// ============================================================================
+// POLÍTICA ADAPTATIVA
+// ============================================================================
+
+AdaptiveStimulusPolicy::AdaptiveStimulusPolicy(const Config &config)
+    : StimulusPolicy(config)
+{
+    forget();
+}
+
+const char *AdaptiveStimulusPolicy::getName() const
+{
+    return "adaptativa";
+}
+
+uint32_t AdaptiveStimulusPolicy::escalationDelay(AlertLevel level) const
+{
+    uint32_t learned = learnedResponseMs(level);
+    if (learned == 0)
+    {
+        return config.escalateAfterMs;
+    }
+
+    uint32_t delay = learned * STIMULUS_RESPONSE_FACTOR;
+    if (delay < STIMULUS_MIN_ESCALATE_MS)
+    {
+        return STIMULUS_MIN_ESCALATE_MS;
+    }
+    if (delay > STIMULUS_MAX_ESCALATE_MS)
+    {
+        return STIMULUS_MAX_ESCALATE_MS;
+    }
+    return delay;
+}
+
+uint32_t AdaptiveStimulusPolicy::learnedResponseMs(AlertLevel level) const
+{
+    uint8_t index = static_cast<uint8_t>(level);
+    if (index >= 3 || samples[index] < STIMULUS_MIN_SAMPLES)
+    {
+        return 0;
+    }
+    return typicalMs[index];
+}
+
+void AdaptiveStimulusPolicy::forget()
+{
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        typicalMs[i] = 0;
+        samples[i] = 0;
+    }
+}
+
+StimulusPolicy::State AdaptiveStimulusPolicy::getState(uint32_t now) const
+{
+    State state = StimulusPolicy::getState(now);
+    memcpy(state.typicalMs, typicalMs, sizeof(typicalMs));
+    memcpy(state.samples, samples, sizeof(samples));
+    return state;
+}
+
+void AdaptiveStimulusPolicy::restore(const State &state, uint32_t now)
+{
+    StimulusPolicy::restore(state, now);
+    memcpy(typicalMs, state.typicalMs, sizeof(typicalMs));
+    memcpy(samples, state.samples, sizeof(samples));
+}
+
+void AdaptiveStimulusPolicy::onResponse(AlertLevel level, uint32_t elapsedMs)
+{
+    uint8_t index = static_cast<uint8_t>(level);
+    if (index >= 3)
+    {
+        return;
+    }
+
+    // Media móvil exponencial: 3/4 lo aprendido, 1/4 la última respuesta
+    typicalMs[index] = samples[index] == 0 ? elapsedMs : (3 * typicalMs[index] + elapsedMs) / 4;
+    if (samples[index] < 255)
+    {
+        samples[index]++;
+    }
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include <stdint.h>
+#include "../config/constants.h"
+#include "../core/Types.h"
+
+/*
+ * ============================================================================
+ * STIMULUS POLICY - ESCALADA DE LOS ESTÍMULOS SONOROS DE LA CERCA VIRTUAL
+ * ============================================================================
+ * Entre el nivel de la geocerca (AlertFilter) y el buzzer: decide qué nivel
+ * suena y si todavía se puede sonar hoy.
+ *
+ * Episodio: desde que la geocerca pide alerta hasta que vuelve a SAFE.
+ * Dentro de un episodio:
+ * - El nivel sonando sigue al de la geocerca cuando sube
+ * - Si el animal no responde en escalationDelay(CAUTION), sube a WARNING
+ *   aunque la geocerca siga en CAUTION (la escalada por tiempo de antes)
+ * - Respuesta: alejarse turnBackMeters del punto más externo alcanzado. Se
+ *   mide cuánto tardó desde que empezó el nivel que sonaba y ya no se escala
+ * - Cada subida de nivel es un estímulo. Con dailyCap estímulos en el día
+ *   los siguientes no suenan (el nivel se sigue informando)
+ *
+ * Las subclases eligen el tiempo de escalada y aprenden de las respuestas:
+ * FixedStimulusPolicy usa siempre el configurado; AdaptiveStimulusPolicy lo
+ * ajusta al tiempo de respuesta de este animal. AlertManager usa la que se
+ * le pase con setStimulusPolicy().
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+class StimulusPolicy
+{
+public:
+    static const uint32_t DAY_MS = 86400000UL;
+
+    struct Config
+    {
+        uint32_t escalateAfterMs; // En CAUTION sin respuesta: sube a WARNING
+        uint16_t dailyCap;        // Estímulos sonoros por día (0 = sin tope)
+        float turnBackMeters;     // Cuánto alejarse del punto más externo para contar como respuesta
+
+        Config() : escalateAfterMs(STIMULUS_ESCALATE_MS), dailyCap(STIMULUS_DAILY_CAP),
+                   turnBackMeters(STIMULUS_TURN_BACK_M) {}
+    };
+
+    struct Decision
+    {
+        AlertLevel level; // Nivel de la alerta (pantalla, bitácora, uplinks)
+        bool audible;     // false: tope diario alcanzado, el buzzer no suena
+    };
+
+    struct Stats
+    {
+        uint16_t stimuliToday;
+        uint32_t stimuli;       // Desde el arranque
+        uint32_t suppressed;    // Estímulos que no sonaron por el tope
+        uint32_t episodes;
+        uint32_t escalations;   // Subidas por falta de respuesta
+        uint32_t responses[3];  // Por nivel que sonaba al volver
+        uint32_t responseMs[3]; // Suma de los tiempos de respuesta
+    };
+
+    // Lo que hay que retener en deep sleep (SleepCycle): cada despertar es
+    // un arranque en frío y millis() vuelve a cero. POD para la memoria RTC
+    struct State
+    {
+        uint32_t dayElapsedMs;  // Transcurrido del día en curso
+        uint16_t stimuliToday;
+        uint32_t typicalMs[3];  // Lo aprendido (AdaptiveStimulusPolicy)
+        uint8_t samples[3];
+    };
+
+    explicit StimulusPolicy(const Config &config);
+    virtual ~StimulusPolicy() {}
+
+    virtual const char *getName() const = 0;
+
+    /**
+     * Aplica una lectura
+     * @param fenceLevel Nivel de la geocerca ya filtrado
+     * @param distance Distancia al borde (negativa = dentro)
+     */
+    Decision update(AlertLevel fenceLevel, float distance, uint32_t now);
+
+    // Sin esperar la próxima lectura: termina el episodio y calla
+    void stop();
+
+    // Tiempo sin respuesta antes de subir desde level
+    virtual uint32_t escalationDelay(AlertLevel level) const = 0;
+
+    void setConfig(const Config &config);
+    const Config &getConfig() const;
+    const Stats &getStats() const;
+    uint32_t averageResponseMs(AlertLevel level) const; // 0 sin respuestas
+
+    // Estado a now; restore() lo retoma con el día corrido desde now
+    virtual State getState(uint32_t now) const;
+    virtual void restore(const State &state, uint32_t now);
+
+protected:
+    Config config;
+
+    // Aprendizaje: respuesta medida desde el inicio del nivel que sonaba
+    virtual void onResponse(AlertLevel level, uint32_t elapsedMs);
+
+private:
+    Stats stats;
+
+    bool inEpisode;
+    AlertLevel sounding;
+    bool audible;
+    bool turnedBack;
+    uint32_t levelSince;
+    float extreme; // Más externa antes de responder, más interna después
+    uint32_t dayStart;
+
+    void raise(AlertLevel level, uint32_t now);
+    void rollDay(uint32_t now);
+};
+
+// ============================================================================
+// POLÍTICAS
+// ============================================================================
+
+// Escalada siempre a escalateAfterMs, como el EscalationConfig anterior
+class FixedStimulusPolicy : public StimulusPolicy
+{
+public:
+    explicit FixedStimulusPolicy(const Config &config = Config());
+
+    const char *getName() const override;
+    uint32_t escalationDelay(AlertLevel level) const override;
+};
+
+/*
+ * Aprende cuánto tarda este animal en volver después de cada nivel (media
+ * móvil exponencial, peso 1/4 a la última respuesta). Con
+ * STIMULUS_MIN_SAMPLES respuestas a CAUTION escala a los
+ * STIMULUS_RESPONSE_FACTOR veces su tiempo habitual, entre
+ * STIMULUS_MIN_ESCALATE_MS y STIMULUS_MAX_ESCALATE_MS: el que suele volver
+ * rápido y esta vez no lo hace recibe WARNING antes, y el que tarda más no
+ * recibe WARNING mientras todavía está respondiendo.
+ */
+class AdaptiveStimulusPolicy : public StimulusPolicy
+{
+public:
+    explicit AdaptiveStimulusPolicy(const Config &config = Config());
+
+    const char *getName() const override;
+    uint32_t escalationDelay(AlertLevel level) const override;
+
+    uint32_t learnedResponseMs(AlertLevel level) const; // 0 sin suficientes respuestas
+    void forget();
+
+    State getState(uint32_t now) const override;
+    void restore(const State &state, uint32_t now) override;
+
+protected:
+    void onResponse(AlertLevel level, uint32_t elapsedMs) override;
+
+private:
+    uint32_t typicalMs[3];
+    uint8_t samples[3];
+};
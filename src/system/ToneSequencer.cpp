@@ -0,0 +1,280 @@
+#include "ToneSequencer.h"
+
+ToneSequencer::ToneSequencer()
+    : output(nullptr),
+      outputContext(nullptr),
+      head(0),
+      queued(0),
+      looping(false),
+      restartLoop(false),
+      backgroundRepetition(0),
+      current(nullptr),
+      element(0),
+      repetition(0),
+      deadline(0),
+      outputFrequency(0),
+      outputVolume(0),
+      notesPlayed(0),
+      dropped(0)
+{
+}
+
+void ToneSequencer::setOutput(Output output, void *context)
+{
+    this->output = output;
+    outputContext = context;
+}
+
+// ============================================================================
+// COLA Y FONDO
+// ============================================================================
+
+bool ToneSequencer::enqueue(const Pattern &pattern)
+{
+    if (patternDuration(pattern) == 0)
+    {
+        return false;
+    }
+    if (queued >= QUEUE_DEPTH)
+    {
+        dropped++;
+        return false;
+    }
+
+    Slot &slot = queue[(head + queued) % QUEUE_DEPTH];
+    slot.pattern = pattern;
+    if (slot.pattern.repetitions == 0)
+    {
+        slot.pattern.repetitions = 1; // En la cola no hay repetición indefinida
+    }
+    queued++;
+    return true;
+}
+
+bool ToneSequencer::enqueueTone(uint16_t frequency, uint16_t duration, uint8_t volume)
+{
+    if (duration == 0)
+    {
+        return false;
+    }
+    if (queued >= QUEUE_DEPTH)
+    {
+        dropped++;
+        return false;
+    }
+
+    Slot &slot = queue[(head + queued) % QUEUE_DEPTH];
+    slot.tone = {TonePatterns::nearestTone(frequency), TonePatterns::ticksFor(duration)};
+    slot.pattern = {&slot.tone, 1, volume, 0, 1};
+    queued++;
+    return true;
+}
+
+bool ToneSequencer::loop(const Pattern &pattern)
+{
+    if (patternDuration(pattern) == 0)
+    {
+        return false;
+    }
+
+    background.pattern = pattern;
+    looping = true;
+    restartLoop = true;
+    backgroundRepetition = 0;
+    return true;
+}
+
+void ToneSequencer::stopLoop()
+{
+    looping = false;
+    restartLoop = false;
+    if (current == &background)
+    {
+        current = nullptr;
+    }
+}
+
+void ToneSequencer::stop()
+{
+    head = 0;
+    queued = 0;
+    looping = false;
+    restartLoop = false;
+    current = nullptr;
+}
+
+// ============================================================================
+// REPRODUCCIÓN
+// ============================================================================
+
+uint32_t ToneSequencer::step(uint32_t now)
+{
+    // El fondo nuevo reemplaza al que suena, pero no interrumpe la cola
+    if (restartLoop)
+    {
+        restartLoop = false;
+        if (current == &background)
+        {
+            current = nullptr;
+        }
+    }
+
+    if (!current)
+    {
+        begin(now);
+    }
+
+    // Bordes vencidos: cada elemento empieza donde terminó el anterior
+    while (current && (int32_t)(now - deadline) >= 0)
+    {
+        element++;
+        beginElement(deadline);
+    }
+
+    emit();
+    return current ? deadline - now : 0;
+}
+
+bool ToneSequencer::begin(uint32_t at)
+{
+    if (queued > 0)
+    {
+        current = &queue[head];
+        repetition = 0;
+    }
+    else if (looping)
+    {
+        current = &background;
+        repetition = backgroundRepetition;
+    }
+    else
+    {
+        current = nullptr;
+        return false;
+    }
+
+    element = 0;
+    return beginElement(at);
+}
+
+bool ToneSequencer::beginElement(uint32_t at)
+{
+    const Pattern &pattern = current->pattern;
+    for (;;)
+    {
+        if (element >= 2 * pattern.count)
+        {
+            // Fin de una repetición
+            element = 0;
+            repetition++;
+            if (pattern.repetitions > 0 && repetition >= pattern.repetitions)
+            {
+                finish();
+                return begin(at);
+            }
+            if (current == &background && queued > 0)
+            {
+                backgroundRepetition = repetition;
+                return begin(at);
+            }
+        }
+
+        uint32_t duration = elementDuration(pattern, element);
+        if (duration > 0)
+        {
+            deadline = at + duration;
+            if ((element & 1) == 0 && pattern.steps[element / 2].tone != TonePatterns::SILENCE)
+            {
+                notesPlayed++;
+            }
+            return true;
+        }
+        element++;
+    }
+}
+
+void ToneSequencer::finish()
+{
+    if (current == &background)
+    {
+        looping = false;
+        backgroundRepetition = 0;
+    }
+    else
+    {
+        head = (head + 1) % QUEUE_DEPTH;
+        queued--;
+    }
+    current = nullptr;
+}
+
+void ToneSequencer::emit()
+{
+    uint16_t frequency = 0;
+    uint8_t volume = 0;
+    if (current && (element & 1) == 0)
+    {
+        frequency = TonePatterns::frequency(current->pattern.steps[element / 2].tone);
+        volume = frequency ? current->pattern.volume : 0;
+    }
+
+    if (frequency == outputFrequency && volume == outputVolume)
+    {
+        return;
+    }
+    outputFrequency = frequency;
+    outputVolume = volume;
+    if (output)
+    {
+        output(frequency, volume, outputContext);
+    }
+}
+
+uint32_t ToneSequencer::elementDuration(const Pattern &pattern, uint16_t element)
+{
+    uint8_t ticks = (element & 1) ? pattern.gap : pattern.steps[element / 2].ticks;
+    return (uint32_t)ticks * TonePatterns::TICK_MS;
+}
+
+uint32_t ToneSequencer::patternDuration(const Pattern &pattern)
+{
+    if (!pattern.steps)
+    {
+        return 0;
+    }
+    uint32_t total = 0;
+    for (uint16_t element = 0; element < 2 * pattern.count; element++)
+    {
+        total += elementDuration(pattern, element);
+    }
+    return total;
+}
+
+// ============================================================================
+// ESTADO
+// ============================================================================
+
+bool ToneSequencer::isPlaying() const
+{
+    return current != nullptr || queued > 0 || looping;
+}
+
+bool ToneSequencer::isLooping() const
+{
+    return looping;
+}
+
+uint8_t ToneSequencer::getQueued() const
+{
+    return queued;
+}
+
+uint32_t ToneSequencer::getNotesPlayed() const
+{
+    return notesPlayed;
+}
+
+uint32_t ToneSequencer::getDropped() const
+{
+    return dropped;
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "../config/constants.h"
+#include "../utils/TonePatterns.h"
+
+/*
+ * ============================================================================
+ * TONE SEQUENCER - MELODÍAS Y CADENCIAS DE ALERTA SIN BLOQUEAR
+ * ============================================================================
+ * Reproduce los patrones de TonePatterns tal como quedan en flash: pasos de
+ * índice de tono y ticks, con un silencio opcional después de cada paso
+ * (gap), repetidos un número de veces o indefinidamente. Las melodías y
+ * tonos sueltos van a una cola y suenan una tras otra; el patrón de fondo
+ * (la alerta continua) se repite mientras la cola está vacía.
+ *
+ * No lleva un tick fijo: step(now) aplica lo que corresponde a ese instante
+ * y devuelve cuánto falta para el próximo cambio, así que el timer que lo
+ * maneja solo despierta en los bordes de las notas. Los tiempos se encadenan
+ * desde el borde anterior, no desde la llamada: un timer que llega tarde no
+ * acumula atraso, y si llega muy tarde se saltan las notas ya vencidas.
+ *
+ * Prioridades:
+ *   - Lo encolado espera el fin de la repetición en curso del fondo
+ *   - loop() reemplaza el fondo de inmediato (escalada de la alerta)
+ *   - stop() calla todo al instante
+ *
+ * No es thread-safe: quien lo usa desde varias tareas lo protege con un
+ * mutex. Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+class ToneSequencer
+{
+public:
+    static const uint8_t QUEUE_DEPTH = TONE_QUEUE_DEPTH;
+
+    typedef TonePatterns::Step Step;
+    typedef TonePatterns::Pattern Pattern; // repetitions 0 = hasta stopLoop()/stop()
+
+    // Cambio de la salida: frecuencia 0 = buzzer callado
+    typedef void (*Output)(uint16_t frequency, uint8_t volume, void *context);
+
+    ToneSequencer();
+
+    void setOutput(Output output, void *context);
+
+    /**
+     * Encola un patrón para sonar después de lo ya encolado (una vez si no
+     * indica repeticiones). Los pasos deben seguir existiendo hasta que
+     * termine (tablas de TonePatterns)
+     * @return false si la cola está llena o el patrón no dura nada
+     */
+    bool enqueue(const Pattern &pattern);
+    // Tono suelto: se aproxima a la nota más cercana y se guarda en la cola
+    bool enqueueTone(uint16_t frequency, uint16_t duration, uint8_t volume);
+
+    // Reemplaza el patrón de fondo; empieza en el próximo step()
+    bool loop(const Pattern &pattern);
+    void stopLoop();
+
+    // Vacía la cola y quita el fondo; el próximo step() calla la salida
+    void stop();
+
+    /**
+     * Avanza hasta now y actualiza la salida si cambió
+     * @return ms hasta el próximo cambio (0 = nada más que tocar)
+     */
+    uint32_t step(uint32_t now);
+
+    bool isPlaying() const; // Cola o fondo pendientes
+    bool isLooping() const;
+    uint8_t getQueued() const;
+
+    // Estadísticas desde el arranque
+    uint32_t getNotesPlayed() const;
+    uint32_t getDropped() const; // Patrones rechazados por cola llena
+
+private:
+    struct Slot
+    {
+        Pattern pattern;
+        Step tone; // Paso propio de enqueueTone()
+    };
+
+    Output output;
+    void *outputContext;
+
+    Slot queue[QUEUE_DEPTH];
+    uint8_t head;
+    uint8_t queued;
+
+    Slot background;
+    bool looping;
+    bool restartLoop;
+    uint8_t backgroundRepetition; // Para retomar el fondo después de la cola
+
+    // Reproducción en curso: elemento 2i = paso i, 2i+1 = gap tras el paso i
+    Slot *current;
+    uint16_t element;
+    uint8_t repetition;
+    uint32_t deadline; // Fin del elemento actual
+
+    uint16_t outputFrequency;
+    uint8_t outputVolume;
+
+    uint32_t notesPlayed;
+    uint32_t dropped;
+
+    static uint32_t elementDuration(const Pattern &pattern, uint16_t element);
+    static uint32_t patternDuration(const Pattern &pattern);
+
+    bool begin(uint32_t at);
+    bool beginElement(uint32_t at);
+    void finish();
+    void emit();
+};
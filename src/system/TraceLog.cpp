@@ -0,0 +1,270 @@
+#include "TraceLog.h"
+#include "FragmentAssembler.h"
+#include <stdio.h>
+#include <string.h>
+
+// Sin relleno en el encabezado: el CRC cubre solo campos
+static_assert(offsetof(TraceLog::Storage, crc) == 24, "Encabezado de TraceLog::Storage con relleno");
+
+TraceLog::TraceLog(Storage &storage, ClockFunction clock)
+    : storage(storage),
+      clock(clock),
+      bootMs(0)
+{
+}
+
+// ============================================================================
+// VALIDACIÓN
+// ============================================================================
+
+uint16_t TraceLog::computeCrc() const
+{
+    return FragmentAssembler::crc16((const uint8_t *)&storage, offsetof(Storage, crc));
+}
+
+bool TraceLog::isValid() const
+{
+    return storage.magic == MAGIC && storage.version == VERSION && storage.crc == computeCrc() &&
+           storage.head < CAPACITY && storage.count <= CAPACITY;
+}
+
+void TraceLog::seal()
+{
+    storage.crc = computeCrc();
+}
+
+bool TraceLog::begin()
+{
+    RtosLock lock(mutex);
+    bootMs = clock();
+
+    // Encendido en frío: la RTC memory sin inicializar tiene basura
+    bool retained = isValid();
+    if (!retained)
+    {
+        memset(&storage, 0, sizeof(storage));
+        storage.magic = MAGIC;
+        storage.version = VERSION;
+    }
+    storage.boot++;
+    seal();
+    return retained && storage.count > 0;
+}
+
+void TraceLog::clear()
+{
+    RtosLock lock(mutex);
+    uint8_t boot = storage.boot;
+    memset(&storage, 0, sizeof(storage));
+    storage.magic = MAGIC;
+    storage.version = VERSION;
+    storage.boot = boot;
+    seal();
+}
+
+// ============================================================================
+// REGISTRO
+// ============================================================================
+
+void TraceLog::record(Event event, uint8_t arg, uint16_t value)
+{
+    uint32_t seconds = (clock() - bootMs) / 1000;
+    if (seconds > 0xFFFFFF)
+    {
+        seconds = 0xFFFFFF; // 194 días sin reiniciar
+    }
+
+    RtosLock lock(mutex);
+    Entry &entry = storage.entries[storage.head];
+    entry.stamp = ((uint32_t)storage.boot << 24) | seconds;
+    entry.event = event;
+    entry.arg = arg;
+    entry.value = value;
+
+    // El encabezado se actualiza después del evento: un reset entre medio
+    // solo pierde este evento
+    storage.head = (storage.head + 1) % CAPACITY;
+    if (storage.count < CAPACITY)
+    {
+        storage.count++;
+    }
+    storage.sequence++;
+    seal();
+}
+
+uint16_t TraceLog::size() const
+{
+    return storage.count;
+}
+
+uint8_t TraceLog::getBoot() const
+{
+    return storage.boot;
+}
+
+uint32_t TraceLog::getSequence() const
+{
+    return storage.sequence;
+}
+
+bool TraceLog::get(uint16_t index, Entry &entry) const
+{
+    RtosLock lock(mutex);
+    if (index >= storage.count)
+    {
+        return false;
+    }
+    entry = storage.entries[(storage.head + CAPACITY - storage.count + index) % CAPACITY];
+    return true;
+}
+
+uint32_t TraceLog::oldestSequence() const
+{
+    return storage.sequence - storage.count;
+}
+
+// ============================================================================
+// SUBIDA POR LORAWAN
+// ============================================================================
+
+void TraceLog::requestUpload(uint16_t latest)
+{
+    RtosLock lock(mutex);
+    if (latest == 0 || latest > storage.count)
+    {
+        latest = storage.count;
+    }
+    storage.uploaded = storage.sequence - latest;
+    storage.uploadEnd = storage.sequence;
+    seal();
+}
+
+uint32_t TraceLog::uploadStart() const
+{
+    // Lo que se sobrescribió antes de subirse ya no está
+    uint32_t from = storage.uploaded;
+    if ((int32_t)(from - oldestSequence()) < 0)
+    {
+        from = oldestSequence();
+    }
+    return from;
+}
+
+bool TraceLog::isUploading() const
+{
+    return pendingUpload() > 0;
+}
+
+uint16_t TraceLog::pendingUpload() const
+{
+    int32_t pending = (int32_t)(storage.uploadEnd - uploadStart());
+    return pending > 0 ? pending : 0;
+}
+
+static size_t putLittleEndian(uint8_t *buffer, uint32_t value, uint8_t bytes)
+{
+    for (uint8_t i = 0; i < bytes; i++)
+    {
+        buffer[i] = (value >> (8 * i)) & 0xFF;
+    }
+    return bytes;
+}
+
+size_t TraceLog::buildChunk(uint8_t *buffer, size_t capacity, uint8_t &entries)
+{
+    entries = 0;
+    if (!buffer || capacity < CHUNK_HEADER_SIZE + ENTRY_SIZE)
+    {
+        return 0;
+    }
+
+    RtosLock lock(mutex);
+    uint16_t pending = pendingUpload();
+    if (pending == 0)
+    {
+        return 0;
+    }
+
+    size_t fits = (capacity - CHUNK_HEADER_SIZE) / ENTRY_SIZE;
+    uint8_t count = pending < fits ? pending : fits;
+    uint32_t first = uploadStart();
+    uint16_t position = (storage.head + CAPACITY - (storage.sequence - first)) % CAPACITY;
+
+    uint32_t uptime = (clock() - bootMs) / 1000;
+    size_t index = 0;
+    buffer[index++] = CHUNK_TYPE;
+    index += putLittleEndian(&buffer[index], first & 0xFFFF, 2);
+    index += putLittleEndian(&buffer[index], pending - count, 2);
+    buffer[index++] = storage.boot;
+    index += putLittleEndian(&buffer[index], uptime > 0xFFFFFF ? 0xFFFFFF : uptime, 3);
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const Entry &entry = storage.entries[(position + i) % CAPACITY];
+        index += putLittleEndian(&buffer[index], entry.stamp, 4);
+        buffer[index++] = entry.event;
+        buffer[index++] = entry.arg;
+        index += putLittleEndian(&buffer[index], entry.value, 2);
+    }
+
+    entries = count;
+    return index;
+}
+
+void TraceLog::commitChunk(uint8_t entries)
+{
+    RtosLock lock(mutex);
+    uint16_t pending = pendingUpload();
+    if (entries > pending)
+    {
+        entries = pending;
+    }
+    storage.uploaded = uploadStart() + entries;
+    seal();
+}
+
+// ============================================================================
+// REPORTE
+// ============================================================================
+
+const char *TraceLog::eventName(uint8_t event)
+{
+    switch (event)
+    {
+    case TRACE_BOOT:
+        return "BOOT";
+    case TRACE_STATE:
+        return "STATE";
+    case TRACE_JOIN:
+        return "JOIN";
+    case TRACE_UPLINK:
+        return "UPLINK";
+    case TRACE_DOWNLINK:
+        return "DOWNLINK";
+    case TRACE_ALERT:
+        return "ALERT";
+    case TRACE_GPS:
+        return "GPS";
+    case TRACE_GEOFENCE:
+        return "GEOFENCE";
+    case TRACE_BATTERY:
+        return "BATTERY";
+    case TRACE_SLEEP:
+        return "SLEEP";
+    case TRACE_RESTART:
+        return "RESTART";
+    default:
+        return "?";
+    }
+}
+
+size_t TraceLog::format(const Entry &entry, char *buffer, size_t size)
+{
+    if (!buffer || size == 0)
+    {
+        return 0;
+    }
+    int written = snprintf(buffer, size, "#%u +%lus %s %u %u", entry.boot(), (unsigned long)entry.seconds(),
+                           eventName(entry.event), entry.arg, entry.value);
+    return written < 0 ? 0 : ((size_t)written < size ? (size_t)written : size - 1);
+}
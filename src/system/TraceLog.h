@@ -0,0 +1,147 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "../config/constants.h"
+#include "Rtos.h"
+
+/*
+ * ============================================================================
+ * TRACE LOG - BITÁCORA DE EVENTOS QUE SOBREVIVE A LOS RESETS
+ * ============================================================================
+ * Anillo de los últimos TRACE_CAPACITY eventos (arranques con su causa,
+ * cambios de estado, JOIN, uplinks, transiciones de alerta, fix del GPS,
+ * geocercas recibidas, batería, deep sleep) para diagnosticar collares que
+ * están en el campo sin tener que recuperarlos.
+ *
+ * El Storage vive en RTC slow memory sin inicializar (RTC_NOINIT_ATTR en
+ * main.cpp): se conserva en reinicios por watchdog, pánico, brownout,
+ * software y deep sleep, y solo se pierde al quitar la batería. Al arrancar
+ * se valida con magic, versión y CRC-16 del encabezado; si no pasa, se
+ * empieza de cero. Cada evento se escribe antes de actualizar el
+ * encabezado, así que un reset a mitad de camino pierde solo ese evento.
+ *
+ * Cada evento ocupa 8 bytes: arranque (8 bits) y segundos desde ese
+ * arranque (24 bits), tipo, argumento y valor. El número de arranque
+ * ordena los eventos entre resets.
+ *
+ * La subida por LoRaWAN se hace en trozos que entran en un uplink:
+ *   [0x05][secuencia u16][pendientes u16][arranque][uptime s u24][evento 8 B]...
+ * "secuencia" es el número del primer evento del trozo (los 16 bits bajos)
+ * y sirve para detectar trozos perdidos. Solo se sube cuando se pide
+ * (downlink o reset anormal) y hasta el último evento registrado al pedirlo:
+ * los uplinks de la propia subida no la alargan.
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
+ */
+
+class TraceLog
+{
+public:
+    static const uint32_t MAGIC = 0x31435254; // "TRC1"
+    static const uint16_t VERSION = 1;
+    static const uint16_t CAPACITY = TRACE_CAPACITY;
+
+    // Uplink de trazas en LORAWAN_PORT_STATUS
+    static const uint8_t CHUNK_TYPE = 0x05;
+    static const size_t CHUNK_HEADER_SIZE = 9;
+    static const size_t ENTRY_SIZE = 8;
+
+    enum Event : uint8_t
+    {
+        TRACE_BOOT = 1,     // arg = causa de reset (esp_reset_reason_t)
+        TRACE_STATE,        // arg = estado del sistema
+        TRACE_JOIN,         // arg = 1 si fue exitoso, valor = intento
+        TRACE_UPLINK,       // arg = puerto, valor = Result
+        TRACE_DOWNLINK,     // arg = puerto, valor = largo
+        TRACE_ALERT,        // arg = nivel de alerta, valor = distancia al borde (m, con signo)
+        TRACE_GPS,          // arg = 1 fix obtenido / 0 perdido, valor = satélites
+        TRACE_GEOFENCE,     // arg = versión, valor = vértices (0 = círculo)
+        TRACE_BATTERY,      // arg = porcentaje, valor = mV
+        TRACE_SLEEP,        // valor = segundos de deep sleep
+        TRACE_RESTART       // Reinicio pedido por el firmware
+    };
+
+    struct Entry
+    {
+        uint32_t stamp; // Arranque en los 8 bits altos, segundos en los 24 bajos
+        uint8_t event;
+        uint8_t arg;
+        uint16_t value;
+
+        uint8_t boot() const { return stamp >> 24; }
+        uint32_t seconds() const { return stamp & 0xFFFFFF; }
+    };
+
+    // Estado retenido en RTC. POD: el encabezado se valida con CRC-16
+    struct Storage
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t head;     // Próxima posición a escribir
+        uint16_t count;    // Eventos guardados (hasta CAPACITY)
+        uint8_t boot;       // Arranque actual
+        uint8_t reserved;
+        uint32_t sequence;  // Eventos registrados desde que se limpió
+        uint32_t uploaded;  // Secuencia del próximo evento a subir
+        uint32_t uploadEnd; // Fin (exclusivo) de la subida pedida
+        uint16_t crc;       // Del encabezado hasta aquí
+        Entry entries[CAPACITY];
+    };
+
+    typedef uint32_t (*ClockFunction)(); // millis() en el dispositivo, reloj simulado en el host
+
+    TraceLog(Storage &storage, ClockFunction clock);
+
+    /**
+     * Al arrancar: conserva lo retenido si es válido (si no, lo limpia) y
+     * cuenta un arranque nuevo. No registra nada por sí mismo
+     * @return true si se conservaron eventos de antes del reset
+     */
+    bool begin();
+    void clear();
+
+    void record(Event event, uint8_t arg = 0, uint16_t value = 0);
+
+    uint16_t size() const;
+    uint8_t getBoot() const;
+    uint32_t getSequence() const;
+
+    // 0 = más antiguo
+    bool get(uint16_t index, Entry &entry) const;
+
+    // ========================================================================
+    // SUBIDA POR LORAWAN
+    // ========================================================================
+
+    // Subir los últimos "latest" eventos (0 = todo lo guardado)
+    void requestUpload(uint16_t latest);
+    bool isUploading() const;
+    uint16_t pendingUpload() const;
+
+    /**
+     * Arma el próximo trozo sin marcarlo como subido
+     * @param entries Eventos incluidos (para commitChunk)
+     * @return Bytes escritos (0 si no hay nada pendiente o no entra ninguno)
+     */
+    size_t buildChunk(uint8_t *buffer, size_t capacity, uint8_t &entries);
+
+    // El uplink salió: avanzar el cursor
+    void commitChunk(uint8_t entries);
+
+    static const char *eventName(uint8_t event);
+
+    // "#3 +125s UPLINK 2 0"
+    static size_t format(const Entry &entry, char *buffer, size_t size);
+
+private:
+    Storage &storage;
+    ClockFunction clock;
+    uint32_t bootMs;
+    mutable RtosMutex mutex; // Registran las tareas GPS, geocerca, radio y UI
+
+    bool isValid() const;
+    void seal();
+    uint16_t computeCrc() const;
+    uint32_t oldestSequence() const;
+    uint32_t uploadStart() const;
+};
@@ -0,0 +1,196 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "../core/Types.h"
+#include "PolygonCodec.h"
+
+/*
+ * ============================================================================
+ * ACTUALIZACIONES INCREMENTALES DE GEOCERCA - COLLAR GEOFENCING
+ * ============================================================================
+ * Formato GEOFENCE_CMD_DELTA (little-endian):
+ *
+ *   [tipo(1)][fenceId(2)][versión base(1)][versión nueva(1)][resolución cm(1)][ops...]
+ *
+ * Se aplica solo si la geocerca activa tiene ese fenceId y la versión base;
+ * en otro caso el backend debe reenviar la geocerca completa. Operaciones:
+ *
+ *   MOVE   [0x01][índice varint][dN zz][dE zz]  desplaza un vértice
+ *   INSERT [0x02][índice varint][dN zz][dE zz]  inserta antes de índice, con
+ *                                               offset desde el vértice previo
+ *   DELETE [0x03][índice varint]
+ *   RADIUS [0x04][radio varint, metros]         solo círculos
+ *   NAME   [0x05][largo(1)][nombre(N)]
+ *   CENTER [0x06][dN zz][dE zz]                 solo círculos
+ *
+ * Los offsets van en unidades de la resolución de la cabecera y se
+ * convierten a grados con la latitud del punto que se desplaza. Mover un
+ * vértice unos metros cuesta ~10 bytes en lugar de reenviar el polígono.
+ */
+
+namespace GeofenceDelta {
+
+    constexpr size_t HEADER_SIZE = 6;
+
+    enum Op : uint8_t {
+        OP_MOVE = 0x01,
+        OP_INSERT = 0x02,
+        OP_DELETE = 0x03,
+        OP_RADIUS = 0x04,
+        OP_NAME = 0x05,
+        OP_CENTER = 0x06
+    };
+
+    struct Header {
+        uint16_t fenceId;
+        uint8_t baseVersion;
+        uint8_t newVersion;
+        uint8_t resolutionCm;
+    };
+
+    inline bool parseHeader(const uint8_t *data, size_t length, Header *header) {
+        if (length < HEADER_SIZE || data[5] == 0) {
+            return false;
+        }
+        header->fenceId = data[1] | (data[2] << 8);
+        header->baseVersion = data[3];
+        header->newVersion = data[4];
+        header->resolutionCm = data[5];
+        return true;
+    }
+
+    /**
+     * Desplaza un punto en metros (unidades * resolución) usando su propia latitud
+     */
+    inline GeoPoint offsetPoint(const GeoPoint &p, int32_t north, int32_t east, uint8_t resolutionCm) {
+        double resolution = resolutionCm / 100.0;
+        return GeoPoint(p.lat + north * resolution / PolygonCodec::metersPerDegreeLat(p.lat),
+                        p.lng + east * resolution / PolygonCodec::metersPerDegreeLng(p.lat));
+    }
+
+    inline bool readOffset(const uint8_t *data, size_t length, size_t *index, int32_t *north, int32_t *east) {
+        uint32_t raw;
+        size_t used = PolygonCodec::readVarint(&data[*index], length - *index, &raw);
+        if (used == 0) {
+            return false;
+        }
+        *index += used;
+        *north = PolygonCodec::zigZagDecode(raw);
+
+        used = PolygonCodec::readVarint(&data[*index], length - *index, &raw);
+        if (used == 0) {
+            return false;
+        }
+        *index += used;
+        *east = PolygonCodec::zigZagDecode(raw);
+        return true;
+    }
+
+    /**
+     * Aplica las operaciones de un delta sobre una copia de trabajo
+     * @param data Payload completo (incluida la cabecera)
+     * @param fence Copia de la geocerca: se modifican tipo/radio/centro/nombre/pointCount
+     * @param vertices Vértices de trabajo (ya con los actuales), capacidad capacity
+     * @return false ante cualquier operación inválida; la copia debe descartarse
+     */
+    inline bool apply(const uint8_t *data, size_t length, Geofence &fence, GeoPoint *vertices, uint16_t capacity) {
+        Header header;
+        if (!parseHeader(data, length, &header)) {
+            return false;
+        }
+
+        bool polygon = fence.type == GeofenceType::POLYGON;
+        size_t index = HEADER_SIZE;
+
+        while (index < length) {
+            uint8_t op = data[index++];
+            uint32_t value = 0;
+            int32_t north = 0, east = 0;
+            size_t used;
+
+            switch (op) {
+            case OP_MOVE:
+            case OP_INSERT:
+            case OP_DELETE: {
+                if (!polygon) {
+                    return false;
+                }
+                used = PolygonCodec::readVarint(&data[index], length - index, &value);
+                if (used == 0) {
+                    return false;
+                }
+                index += used;
+
+                if (op == OP_DELETE) {
+                    if (value >= fence.pointCount || fence.pointCount <= 3) {
+                        return false;
+                    }
+                    memmove(&vertices[value], &vertices[value + 1], (fence.pointCount - value - 1) * sizeof(GeoPoint));
+                    fence.pointCount--;
+                    break;
+                }
+
+                if (!readOffset(data, length, &index, &north, &east)) {
+                    return false;
+                }
+
+                if (op == OP_MOVE) {
+                    if (value >= fence.pointCount) {
+                        return false;
+                    }
+                    vertices[value] = offsetPoint(vertices[value], north, east, header.resolutionCm);
+                } else {
+                    if (value > fence.pointCount || fence.pointCount >= capacity) {
+                        return false;
+                    }
+                    uint16_t prev = value > 0 ? value - 1 : fence.pointCount - 1;
+                    GeoPoint inserted = offsetPoint(vertices[prev], north, east, header.resolutionCm);
+                    memmove(&vertices[value + 1], &vertices[value], (fence.pointCount - value) * sizeof(GeoPoint));
+                    vertices[value] = inserted;
+                    fence.pointCount++;
+                }
+                break;
+            }
+
+            case OP_RADIUS:
+                used = PolygonCodec::readVarint(&data[index], length - index, &value);
+                if (used == 0 || polygon) {
+                    return false;
+                }
+                index += used;
+                fence.radius = (float)value;
+                break;
+
+            case OP_CENTER: {
+                if (polygon || !readOffset(data, length, &index, &north, &east)) {
+                    return false;
+                }
+                GeoPoint center = offsetPoint(GeoPoint(fence.centerLat, fence.centerLng), north, east, header.resolutionCm);
+                fence.centerLat = center.lat;
+                fence.centerLng = center.lng;
+                break;
+            }
+
+            case OP_NAME: {
+                if (index >= length) {
+                    return false;
+                }
+                uint8_t nameLen = data[index++];
+                if (index + nameLen > length) {
+                    return false;
+                }
+                size_t copyLen = nameLen < sizeof(fence.name) - 1 ? nameLen : sizeof(fence.name) - 1;
+                memcpy(fence.name, &data[index], copyLen);
+                fence.name[copyLen] = '\0';
+                index += nameLen;
+                break;
+            }
+
+            default:
+                return false;
+            }
+        }
+        return true;
+    }
+}
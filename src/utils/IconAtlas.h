@@ -0,0 +1,320 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "../config/constants.h"
+#include "../core/Types.h"
+
+/*
+ * ============================================================================
+ * ATLAS DE ICONOS - COLLAR GEOFENCING
+ * ============================================================================
+ * Los iconos de la barra de estado (batería, señal, GPS, radio, geocerca) y
+ * de la pantalla de alerta se generan en compilación, ya en el formato del
+ * framebuffer de SSD1306Wire: columnas de 8 píxeles verticales, página por
+ * página (bit 0 = fila de arriba). Dibujar uno es copiar sus bytes.
+ *
+ * Los dibujos fijos se escriben como arte ASCII ('#' = encendido, una fila
+ * tras otra) y fromArt() los convierte; los que dependen de un valor
+ * (relleno de la batería, barras de señal) los arma una función constexpr
+ * con todas sus variantes. Nada se calcula en tiempo de ejecución.
+ *
+ * blit() reemplaza los píxeles del rectángulo del icono. Con y múltiplo de
+ * 8 y el icono entero en pantalla es un memcpy por página; si no, cada
+ * columna se desplaza y se combina con máscaras. Recorta en los bordes.
+ */
+
+// En el ESP32 las constantes ya quedan en flash; PROGMEM se mantiene por
+// compatibilidad con placas AVR/ESP8266
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+namespace IconAtlas {
+
+    constexpr uint8_t FRAME_WIDTH = DISPLAY_WIDTH;
+    constexpr uint8_t FRAME_PAGES = DISPLAY_HEIGHT / 8;
+
+    template <uint8_t W, uint8_t H>
+    struct Icon {
+        static constexpr uint8_t WIDTH = W;
+        static constexpr uint8_t HEIGHT = H;
+        static constexpr uint8_t PAGES = (H + 7) / 8;
+        uint8_t data[W * PAGES];
+    };
+
+    // Vista sin tamaño en el tipo para blit() y las variantes
+    struct IconRef {
+        const uint8_t *data;
+        uint8_t width;
+        uint8_t pages;
+    };
+
+    template <uint8_t W, uint8_t H>
+    constexpr IconRef ref(const Icon<W, H> &icon) {
+        return {icon.data, W, Icon<W, H>::PAGES};
+    }
+
+    template <uint8_t W, uint8_t H>
+    constexpr void setPixel(Icon<W, H> &icon, uint8_t x, uint8_t y) {
+        icon.data[(y / 8) * W + x] |= (uint8_t)(1 << (y & 7));
+    }
+
+    template <uint8_t W, uint8_t H, size_t N>
+    constexpr Icon<W, H> fromArt(const char (&art)[N]) {
+        static_assert(N == (size_t)W * H + 1, "El arte ASCII debe tener W x H caracteres");
+        Icon<W, H> icon = {};
+        for (uint8_t y = 0; y < H; y++) {
+            for (uint8_t x = 0; x < W; x++) {
+                if (art[y * W + x] == '#') {
+                    setPixel(icon, x, y);
+                }
+            }
+        }
+        return icon;
+    }
+
+    // ========================================================================
+    // ICONOS GENERADOS
+    // ========================================================================
+
+    // Batería de 22x8: cuerpo de 20 columnas y borne; fill = columnas llenas (0..18)
+    constexpr uint8_t BATTERY_WIDTH = 22;
+    constexpr uint8_t BATTERY_LEVELS = 19;
+
+    constexpr Icon<BATTERY_WIDTH, 8> makeBattery(uint8_t fill) {
+        Icon<BATTERY_WIDTH, 8> icon = {};
+        icon.data[0] = 0xFF;
+        icon.data[19] = 0xFF;
+        for (uint8_t x = 1; x < 19; x++) {
+            icon.data[x] = (x <= fill) ? 0xFF : 0x81;
+        }
+        icon.data[20] = 0x3C; // Borne: filas 2..5
+        icon.data[21] = 0x3C;
+        return icon;
+    }
+
+    // Señal de 14x8: 5 barras de 2 columnas, llenas hasta strength y huecas después
+    constexpr uint8_t SIGNAL_WIDTH = 14;
+    constexpr uint8_t SIGNAL_BARS = 5;
+
+    constexpr Icon<SIGNAL_WIDTH, 8> makeSignal(uint8_t strength) {
+        Icon<SIGNAL_WIDTH, 8> icon = {};
+        for (uint8_t bar = 0; bar < SIGNAL_BARS; bar++) {
+            uint8_t height = 2 + bar * 6 / 4; // 2, 3, 5, 6, 8 filas
+            uint8_t bits = (uint8_t)(0xFF << (8 - height));
+            if (bar >= strength) {
+                bits &= 0x80 | (uint8_t)(1 << (8 - height)); // Solo arriba y abajo
+            }
+            icon.data[bar * 3] = bits;
+            icon.data[bar * 3 + 1] = bits;
+        }
+        return icon;
+    }
+
+    // Alerta de 16x16: triángulo con '!' (hueco en precaución, lleno en advertencia) o visto
+    constexpr Icon<16, 16> makeAlert(AlertLevel level) {
+        Icon<16, 16> icon = {};
+        if (level == AlertLevel::SAFE) {
+            for (uint8_t i = 0; i < 5; i++) {
+                setPixel(icon, 2 + i, 8 + i);
+                setPixel(icon, 2 + i, 9 + i);
+            }
+            for (uint8_t i = 0; i < 8; i++) {
+                setPixel(icon, 6 + i, 12 - i);
+                setPixel(icon, 6 + i, 13 - i);
+            }
+            return icon;
+        }
+
+        bool filled = level >= AlertLevel::WARNING;
+        for (uint8_t y = 1; y < 16; y++) {
+            uint8_t half = (y - 1) / 2;
+            uint8_t left = 7 - half;
+            uint8_t right = 8 + half;
+            for (uint8_t x = left; x <= right; x++) {
+                bool edge = x == left || x == right || y == 15;
+                bool mark = (x == 7 || x == 8) && ((y >= 5 && y <= 10) || y == 12 || y == 13);
+                if (filled ? !mark : (edge || mark)) {
+                    setPixel(icon, x, y);
+                }
+            }
+        }
+        return icon;
+    }
+
+    template <typename T, size_t N>
+    struct Set {
+        T icons[N];
+        constexpr IconRef operator[](size_t index) const {
+            return ref(icons[index < N ? index : N - 1]);
+        }
+    };
+
+    constexpr Set<Icon<BATTERY_WIDTH, 8>, BATTERY_LEVELS> makeBatterySet() {
+        Set<Icon<BATTERY_WIDTH, 8>, BATTERY_LEVELS> set = {};
+        for (uint8_t fill = 0; fill < BATTERY_LEVELS; fill++) {
+            set.icons[fill] = makeBattery(fill);
+        }
+        return set;
+    }
+
+    constexpr Set<Icon<SIGNAL_WIDTH, 8>, SIGNAL_BARS + 1> makeSignalSet() {
+        Set<Icon<SIGNAL_WIDTH, 8>, SIGNAL_BARS + 1> set = {};
+        for (uint8_t strength = 0; strength <= SIGNAL_BARS; strength++) {
+            set.icons[strength] = makeSignal(strength);
+        }
+        return set;
+    }
+
+    // ========================================================================
+    // ATLAS (flash)
+    // ========================================================================
+
+    constexpr Set<Icon<BATTERY_WIDTH, 8>, BATTERY_LEVELS> BATTERY PROGMEM = makeBatterySet();
+    constexpr Set<Icon<SIGNAL_WIDTH, 8>, SIGNAL_BARS + 1> SIGNAL PROGMEM = makeSignalSet();
+
+    constexpr Icon<16, 16> ALERT_SAFE PROGMEM = makeAlert(AlertLevel::SAFE);
+    constexpr Icon<16, 16> ALERT_CAUTION PROGMEM = makeAlert(AlertLevel::CAUTION);
+    constexpr Icon<16, 16> ALERT_WARNING PROGMEM = makeAlert(AlertLevel::WARNING);
+
+    constexpr Icon<8, 8> GPS_FIX PROGMEM = fromArt<8, 8>(
+        "...#...."
+        ".#####.."
+        ".#...#.."
+        "##.#.##."
+        ".#...#.."
+        ".#####.."
+        "...#...."
+        "........");
+
+    constexpr Icon<8, 8> GPS_SEARCHING PROGMEM = fromArt<8, 8>(
+        "...#...."
+        ".#...#.."
+        "........"
+        "#..#..#."
+        "........"
+        ".#...#.."
+        "...#...."
+        "........");
+
+    constexpr Icon<8, 8> RADIO_OK PROGMEM = fromArt<8, 8>(
+        "#.....#."
+        "#..#..#."
+        ".#.#.#.."
+        "..###..."
+        "...#...."
+        "...#...."
+        "...#...."
+        "...#....");
+
+    constexpr Icon<8, 8> RADIO_ERROR PROGMEM = fromArt<8, 8>(
+        "#.....#."
+        ".#...#.."
+        "..#.#..."
+        "...#...."
+        "..#.#..."
+        ".#...#.."
+        "#.....#."
+        "........");
+
+    constexpr Icon<8, 8> GEOFENCE_CIRCLE PROGMEM = fromArt<8, 8>(
+        "..###..."
+        ".#...#.."
+        "#.....#."
+        "#..#..#."
+        "#.....#."
+        ".#...#.."
+        "..###..."
+        "........");
+
+    constexpr Icon<8, 8> GEOFENCE_POLYGON PROGMEM = fromArt<8, 8>(
+        "...#...."
+        "..#.#..."
+        ".#...#.."
+        "#.....#."
+        ".#...#.."
+        ".#...#.."
+        ".#####.."
+        "........");
+
+    // ========================================================================
+    // SELECCIÓN
+    // ========================================================================
+
+    inline IconRef battery(uint8_t percentage) {
+        uint8_t fill = (percentage > 100 ? 100 : percentage) * (BATTERY_LEVELS - 1) / 100;
+        return BATTERY[fill];
+    }
+
+    inline IconRef signal(uint8_t strength) {
+        return SIGNAL[strength];
+    }
+
+    inline IconRef alert(AlertLevel level) {
+        switch (level) {
+        case AlertLevel::SAFE:
+            return ref(ALERT_SAFE);
+        case AlertLevel::CAUTION:
+            return ref(ALERT_CAUTION);
+        default:
+            return ref(ALERT_WARNING);
+        }
+    }
+
+    inline IconRef gps(bool fix) {
+        return fix ? ref(GPS_FIX) : ref(GPS_SEARCHING);
+    }
+
+    inline IconRef radio(bool ok) {
+        return ok ? ref(RADIO_OK) : ref(RADIO_ERROR);
+    }
+
+    inline IconRef geofence(GeofenceType type) {
+        return type == GeofenceType::CIRCLE ? ref(GEOFENCE_CIRCLE) : ref(GEOFENCE_POLYGON);
+    }
+
+    // ========================================================================
+    // COPIA AL FRAMEBUFFER
+    // ========================================================================
+
+    /**
+     * Copia el icono con su esquina superior izquierda en (x, y)
+     * @param frame Framebuffer de páginas (SSD1306Wire::buffer)
+     */
+    inline void blit(uint8_t *frame, int16_t x, int16_t y, const IconRef &icon) {
+        int16_t page = y >> 3; // División hacia abajo también con y negativo
+        uint8_t shift = y & 7;
+
+        // Caso común: alineado y dentro de la pantalla
+        if (shift == 0 && x >= 0 && x + icon.width <= FRAME_WIDTH && page >= 0 &&
+            page + icon.pages <= FRAME_PAGES) {
+            for (uint8_t p = 0; p < icon.pages; p++) {
+                memcpy(frame + (page + p) * FRAME_WIDTH + x, icon.data + p * icon.width, icon.width);
+            }
+            return;
+        }
+
+        uint8_t lowMask = (uint8_t)(0xFF << shift);             // Filas del icono en la página de arriba
+        uint8_t highMask = shift ? (uint8_t)(0xFF >> (8 - shift)) : 0; // Y en la de abajo
+        for (uint8_t p = 0; p < icon.pages; p++) {
+            int16_t upper = page + p;
+            for (uint8_t c = 0; c < icon.width; c++) {
+                int16_t column = x + c;
+                if (column < 0 || column >= FRAME_WIDTH) {
+                    continue;
+                }
+                uint8_t bits = icon.data[p * icon.width + c];
+                if (upper >= 0 && upper < FRAME_PAGES) {
+                    uint8_t &cell = frame[upper * FRAME_WIDTH + column];
+                    cell = (cell & ~lowMask) | (uint8_t)(bits << shift);
+                }
+                if (shift && upper + 1 >= 0 && upper + 1 < FRAME_PAGES) {
+                    uint8_t &cell = frame[(upper + 1) * FRAME_WIDTH + column];
+                    cell = (cell & ~highMask) | (uint8_t)(bits >> (8 - shift));
+                }
+            }
+        }
+    }
+
+} // namespace IconAtlas
@@ -0,0 +1,228 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include "../core/Types.h"
+
+/*
+ * ============================================================================
+ * CODEC DE POLÍGONOS COMPACTOS - COLLAR GEOFENCING
+ * ============================================================================
+ * Formato GEOFENCE_CMD_POLYGON_VARINT (little-endian):
+ *
+ *   [tipo(1)][latRef(4)][lngRef(4)][resolución cm(1)][n varint]
+ *   [dNorte varint zig-zag][dEste varint zig-zag] x n [groupId(N)]
+ *
+ * - latRef/lngRef: int32 en 1e-7 grados (sin el error de ~1 m de un float)
+ * - cada vértice es un offset en metros desde la referencia, cuantizado a la
+ *   resolución y enviado como delta respecto al vértice anterior
+ * - los metros se convierten a grados con la latitud de referencia (serie
+ *   WGS84), así la geometría es la misma en todo Chile y no solo cerca de 33°S
+ *
+ * El encoder (también en scripts/geofence_downlink.py) cuantiza posiciones
+ * absolutas antes de tomar deltas, por lo que el error no se acumula.
+ */
+
+namespace PolygonCodec {
+
+    constexpr double COORD_SCALE = 1e7;
+    constexpr double DEG_TO_RAD_D = 3.14159265358979323846 / 180.0;
+    constexpr size_t HEADER_SIZE = 10;
+
+    // ========================================================================
+    // ESCALA MÉTRICA DEPENDIENTE DE LA LATITUD
+    // ========================================================================
+
+    /**
+     * Metros por grado de latitud en la latitud dada (elipsoide WGS84)
+     */
+    inline double metersPerDegreeLat(double latDeg) {
+        double phi = latDeg * DEG_TO_RAD_D;
+        return 111132.92 - 559.82 * cos(2 * phi) + 1.175 * cos(4 * phi) - 0.0023 * cos(6 * phi);
+    }
+
+    /**
+     * Metros por grado de longitud en la latitud dada (elipsoide WGS84)
+     */
+    inline double metersPerDegreeLng(double latDeg) {
+        double phi = latDeg * DEG_TO_RAD_D;
+        return 111412.84 * cos(phi) - 93.5 * cos(3 * phi) + 0.118 * cos(5 * phi);
+    }
+
+    // ========================================================================
+    // VARINTS ZIG-ZAG
+    // ========================================================================
+
+    inline uint32_t zigZagEncode(int32_t value) {
+        return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    }
+
+    inline int32_t zigZagDecode(uint32_t value) {
+        return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+    }
+
+    /**
+     * Lee un varint LEB128 de hasta 32 bits
+     * @return Bytes consumidos, 0 si el buffer se acaba o el varint es inválido
+     */
+    inline size_t readVarint(const uint8_t *data, size_t length, uint32_t *value) {
+        uint32_t result = 0;
+        for (size_t i = 0; i < length && i < 5; i++) {
+            result |= (uint32_t)(data[i] & 0x7F) << (7 * i);
+            if (!(data[i] & 0x80)) {
+                *value = result;
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * Escribe un varint LEB128
+     * @return Bytes escritos, 0 si no cabe
+     */
+    inline size_t writeVarint(uint8_t *data, size_t capacity, uint32_t value) {
+        size_t i = 0;
+        do {
+            if (i >= capacity) {
+                return 0;
+            }
+            uint8_t byte = value & 0x7F;
+            value >>= 7;
+            data[i++] = byte | (value ? 0x80 : 0);
+        } while (value);
+        return i;
+    }
+
+    inline int32_t readInt32LE(const uint8_t *data) {
+        return (int32_t)((uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+                         ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24));
+    }
+
+    inline void writeInt32LE(uint8_t *data, int32_t value) {
+        for (uint8_t i = 0; i < 4; i++) {
+            data[i] = ((uint32_t)value >> (8 * i)) & 0xFF;
+        }
+    }
+
+    // ========================================================================
+    // DECODIFICACIÓN
+    // ========================================================================
+
+    /**
+     * Decodifica un polígono GEOFENCE_CMD_POLYGON_VARINT
+     * @param data Payload completo (incluido el byte de tipo)
+     * @param points Destino de los vértices
+     * @param capacity Vértices máximos que caben en points
+     * @param count Vértices decodificados
+     * @param consumed Bytes usados por el polígono (lo que sigue es el groupId)
+     * @return false si el payload está truncado o el número de vértices es inválido
+     */
+    inline bool decode(const uint8_t *data, size_t length, GeoPoint *points, uint16_t capacity,
+                       uint16_t *count, size_t *consumed) {
+        if (length < HEADER_SIZE + 1) {
+            return false;
+        }
+
+        double refLat = readInt32LE(&data[1]) / COORD_SCALE;
+        double refLng = readInt32LE(&data[5]) / COORD_SCALE;
+        uint8_t resolutionCm = data[9];
+        if (resolutionCm == 0 || refLat < -90.0 || refLat > 90.0 || refLng < -180.0 || refLng > 180.0) {
+            return false;
+        }
+
+        size_t index = HEADER_SIZE;
+        uint32_t numPoints;
+        size_t used = readVarint(&data[index], length - index, &numPoints);
+        if (used == 0 || numPoints < 3 || numPoints > capacity) {
+            return false;
+        }
+        index += used;
+
+        // Escala fija para todo el polígono: la de la latitud de referencia
+        double resolution = resolutionCm / 100.0;
+        double latPerUnit = resolution / metersPerDegreeLat(refLat);
+        double lngPerUnit = resolution / metersPerDegreeLng(refLat);
+
+        int32_t north = 0, east = 0;
+        for (uint32_t i = 0; i < numPoints; i++) {
+            uint32_t dNorth, dEast;
+            used = readVarint(&data[index], length - index, &dNorth);
+            if (used == 0) {
+                return false;
+            }
+            index += used;
+            used = readVarint(&data[index], length - index, &dEast);
+            if (used == 0) {
+                return false;
+            }
+            index += used;
+
+            north += zigZagDecode(dNorth);
+            east += zigZagDecode(dEast);
+            points[i] = GeoPoint(refLat + north * latPerUnit, refLng + east * lngPerUnit);
+        }
+
+        *count = (uint16_t)numPoints;
+        *consumed = index;
+        return true;
+    }
+
+    // ========================================================================
+    // CODIFICACIÓN (tests y herramientas; el backend usa la versión Python)
+    // ========================================================================
+
+    /**
+     * Codifica un polígono en formato GEOFENCE_CMD_POLYGON_VARINT (sin groupId)
+     * @param type Byte de tipo a escribir en la cabecera
+     * @return Bytes escritos, 0 si no cabe en el buffer
+     */
+    inline size_t encode(uint8_t type, const GeoPoint *points, uint16_t numPoints, double refLat, double refLng,
+                         uint8_t resolutionCm, uint8_t *out, size_t capacity) {
+        if (capacity < HEADER_SIZE || resolutionCm == 0) {
+            return 0;
+        }
+
+        int32_t refLatE7 = (int32_t)lround(refLat * COORD_SCALE);
+        int32_t refLngE7 = (int32_t)lround(refLng * COORD_SCALE);
+        out[0] = type;
+        writeInt32LE(&out[1], refLatE7);
+        writeInt32LE(&out[5], refLngE7);
+        out[9] = resolutionCm;
+
+        // El decoder usa la referencia ya redondeada: hay que cuantizar contra ella
+        double lat0 = refLatE7 / COORD_SCALE;
+        double lng0 = refLngE7 / COORD_SCALE;
+        double resolution = resolutionCm / 100.0;
+        double unitsPerDegLat = metersPerDegreeLat(lat0) / resolution;
+        double unitsPerDegLng = metersPerDegreeLng(lat0) / resolution;
+
+        size_t index = HEADER_SIZE;
+        size_t used = writeVarint(&out[index], capacity - index, numPoints);
+        if (used == 0) {
+            return 0;
+        }
+        index += used;
+
+        int32_t prevNorth = 0, prevEast = 0;
+        for (uint16_t i = 0; i < numPoints; i++) {
+            int32_t north = (int32_t)lround((points[i].lat - lat0) * unitsPerDegLat);
+            int32_t east = (int32_t)lround((points[i].lng - lng0) * unitsPerDegLng);
+
+            used = writeVarint(&out[index], capacity - index, zigZagEncode(north - prevNorth));
+            if (used == 0) {
+                return 0;
+            }
+            index += used;
+            used = writeVarint(&out[index], capacity - index, zigZagEncode(east - prevEast));
+            if (used == 0) {
+                return 0;
+            }
+            index += used;
+
+            prevNorth = north;
+            prevEast = east;
+        }
+        return index;
+    }
+}
@@ -1,392 +1,453 @@
 #pragma once
-#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
 
 /*
  * ============================================================================
  * UTILIDADES DE CADENAS - COLLAR GEOFENCING
  * ============================================================================
+ * Sin memoria dinámica: todo se escribe en un buffer del llamador (en el
+ * stack o en un arena estático), al estilo snprintf. Las funciones devuelven
+ * el largo escrito, cortan lo que no entra y siempre terminan en '\0'. Los
+ * String de Arduino reservan y liberan heap en cada concatenación y, tras
+ * semanas encendido, lo fragmentan.
+ *
+ * Independiente de Arduino para poder ejecutarse en los tests nativos.
  */
 
 namespace StringUtils {
-    
+
+    // ========================================================================
+    // ESCRITOR SOBRE UN BUFFER FIJO
+    // ========================================================================
+
+    /**
+     * Arma un texto por partes sobre un buffer ajeno
+     *   char line[32];
+     *   StringUtils::Writer(line, sizeof(line)).print("Sats: ").printf("%d", sats);
+     */
+    class Writer {
+    public:
+        Writer(char* buffer, size_t size) : buffer(buffer), size(size), used(0), overflow(false) {
+            if (buffer && size > 0) {
+                buffer[0] = '\0';
+            }
+        }
+
+        Writer& print(const char* text) {
+            if (!text) {
+                return *this;
+            }
+            size_t length = strlen(text);
+            size_t room = remaining();
+            if (length > room) {
+                length = room;
+                overflow = true;
+            }
+            memcpy(buffer + used, text, length);
+            used += length;
+            terminate();
+            return *this;
+        }
+
+        Writer& print(char c) {
+            return repeat(c, 1);
+        }
+
+        Writer& repeat(char c, size_t count) {
+            size_t room = remaining();
+            if (count > room) {
+                count = room;
+                overflow = true;
+            }
+            memset(buffer + used, c, count);
+            used += count;
+            terminate();
+            return *this;
+        }
+
+        __attribute__((format(printf, 2, 3))) Writer& printf(const char* format, ...) {
+            if (!buffer || size == 0) {
+                overflow = true;
+                return *this;
+            }
+            va_list args;
+            va_start(args, format);
+            int written = vsnprintf(buffer + used, size - used, format, args);
+            va_end(args);
+            if (written < 0) {
+                terminate();
+            } else if ((size_t)written > remaining()) {
+                used = size - 1;
+                overflow = true;
+            } else {
+                used += written;
+            }
+            return *this;
+        }
+
+        const char* c_str() const { return buffer; }
+        size_t length() const { return used; }
+        bool truncated() const { return overflow; }
+
+    private:
+        char* buffer;
+        size_t size;
+        size_t used;
+        bool overflow;
+
+        size_t remaining() const {
+            return (buffer && size > 0) ? size - 1 - used : 0;
+        }
+
+        void terminate() {
+            if (buffer && size > 0) {
+                buffer[used] = '\0';
+            }
+        }
+    };
+
     // ========================================================================
     // FORMATEO DE COORDENADAS GPS
     // ========================================================================
-    
+
+    inline char cardinal(double coordinate, bool isLatitude) {
+        if (isLatitude) {
+            return (coordinate >= 0) ? 'N' : 'S';
+        }
+        return (coordinate >= 0) ? 'E' : 'W';
+    }
+
     /**
      * Formatea una coordenada GPS con dirección cardinal
      * @param coordinate Coordenada en grados decimales
      * @param isLatitude true si es latitud, false si es longitud
      * @param decimals Número de decimales a mostrar
-     * @return String formateado (ej: "12.3456°N")
+     * @return Largo escrito (ej: "12.3456°N")
      */
-    inline String formatCoordinate(double coordinate, bool isLatitude, int decimals = 4) {
-        char direction;
-        double absCoord = abs(coordinate);
-        
-        if (isLatitude) {
-            direction = (coordinate >= 0) ? 'N' : 'S';
-        } else {
-            direction = (coordinate >= 0) ? 'E' : 'W';
-        }
-        
-        return String(absCoord, decimals) + "°" + direction;
+    inline size_t formatCoordinate(char* buffer, size_t size, double coordinate, bool isLatitude, int decimals = 4) {
+        return Writer(buffer, size).printf("%.*f°%c", decimals, fabs(coordinate), cardinal(coordinate, isLatitude)).length();
     }
-    
+
     /**
      * Formatea coordenadas GPS en formato DMS (Grados, Minutos, Segundos)
      */
-    inline String formatCoordinateDMS(double coordinate, bool isLatitude) {
-        char direction;
-        double absCoord = abs(coordinate);
-        
-        if (isLatitude) {
-            direction = (coordinate >= 0) ? 'N' : 'S';
-        } else {
-            direction = (coordinate >= 0) ? 'E' : 'W';
-        }
-        
+    inline size_t formatCoordinateDMS(char* buffer, size_t size, double coordinate, bool isLatitude) {
+        double absCoord = fabs(coordinate);
         int degrees = (int)absCoord;
         double minutesFloat = (absCoord - degrees) * 60.0;
         int minutes = (int)minutesFloat;
         double seconds = (minutesFloat - minutes) * 60.0;
-        
-        return String(degrees) + "°" + String(minutes) + "'" + 
-               String(seconds, 2) + "\"" + direction;
+
+        return Writer(buffer, size).printf("%d°%d'%.2f\"%c", degrees, minutes, seconds,
+                                           cardinal(coordinate, isLatitude)).length();
     }
-    
+
     // ========================================================================
     // FORMATEO DE TIEMPO Y DURACIÓN
     // ========================================================================
-    
+
     /**
-     * Formatea tiempo en milisegundos a formato legible
-     * @param ms Tiempo en milisegundos
-     * @return String formateado (ej: "1h 23m 45s")
+     * Formatea uptime del sistema
+     * @return Largo escrito (ej: "2d 1h 23m 45s")
      */
-    inline String formatDuration(uint32_t ms) {
-        uint32_t seconds = ms / 1000;
-        uint32_t minutes = seconds / 60;
-        uint32_t hours = minutes / 60;
-        uint32_t days = hours / 24;
-        
-        String result = "";
-        
-        if (days > 0) {
-            result += String(days) + "d ";
-            hours %= 24;
-        }
-        
-        if (hours > 0) {
-            result += String(hours) + "h ";
-            minutes %= 60;
-        }
-        
-        if (minutes > 0) {
-            result += String(minutes) + "m ";
-            seconds %= 60;
-        }
-        
-        if (seconds > 0 || result.length() == 0) {
-            result += String(seconds) + "s";
+    inline size_t formatUptime(char* buffer, size_t size, uint32_t uptimeSeconds) {
+        unsigned long seconds = uptimeSeconds;
+        unsigned long parts[] = {seconds / 86400, (seconds / 3600) % 24, (seconds / 60) % 60, seconds % 60};
+        const char units[] = {'d', 'h', 'm', 's'};
+
+        Writer out(buffer, size);
+        for (uint8_t i = 0; i < 4; i++) {
+            // Sin partes en cero, salvo "0s" si no hay ninguna otra
+            if (parts[i] > 0 || (i == 3 && out.length() == 0)) {
+                out.printf(out.length() ? " %lu%c" : "%lu%c", parts[i], units[i]);
+            }
         }
-        
-        result.trim();
-        return result;
+        return out.length();
     }
-    
+
     /**
-     * Formatea uptime del sistema
+     * Formatea tiempo en milisegundos a formato legible
+     * @param ms Tiempo en milisegundos
+     * @return Largo escrito (ej: "1h 23m 45s")
      */
-    inline String formatUptime(uint32_t uptimeSeconds) {
-        return formatDuration(uptimeSeconds * 1000);
+    inline size_t formatDuration(char* buffer, size_t size, uint32_t ms) {
+        return formatUptime(buffer, size, ms / 1000);
     }
-    
+
     /**
      * Formatea timestamp a formato HH:MM:SS
      */
-    inline String formatTime(uint32_t timestamp) {
-        uint32_t totalSeconds = timestamp / 1000;
-        uint32_t hours = (totalSeconds / 3600) % 24;
-        uint32_t minutes = (totalSeconds / 60) % 60;
-        uint32_t seconds = totalSeconds % 60;
-        
-        char buffer[9];
-        snprintf(buffer, sizeof(buffer), "%02lu:%02lu:%02lu", hours, minutes, seconds);
-        return String(buffer);
+    inline size_t formatTime(char* buffer, size_t size, uint32_t timestamp) {
+        unsigned long totalSeconds = timestamp / 1000;
+        return Writer(buffer, size).printf("%02lu:%02lu:%02lu", (totalSeconds / 3600) % 24,
+                                           (totalSeconds / 60) % 60, totalSeconds % 60).length();
     }
-    
+
     // ========================================================================
     // FORMATEO DE VALORES NUMÉRICOS
     // ========================================================================
-    
+
     /**
      * Formatea voltaje con unidades
      */
-    inline String formatVoltage(float voltage, int decimals = 2) {
-        return String(voltage, decimals) + "V";
+    inline size_t formatVoltage(char* buffer, size_t size, float voltage, int decimals = 2) {
+        return Writer(buffer, size).printf("%.*fV", decimals, voltage).length();
     }
-    
+
     /**
      * Formatea porcentaje
      */
-    inline String formatPercentage(uint8_t percentage) {
-        return String(percentage) + "%";
+    inline size_t formatPercentage(char* buffer, size_t size, uint8_t percentage) {
+        return Writer(buffer, size).printf("%u%%", percentage).length();
     }
-    
+
     /**
      * Formatea distancia con unidades apropiadas
      */
-    inline String formatDistance(float meters) {
+    inline size_t formatDistance(char* buffer, size_t size, float meters) {
         if (meters < 1000) {
-            return String(meters, 1) + "m";
-        } else {
-            return String(meters / 1000.0, 2) + "km";
+            return Writer(buffer, size).printf("%.1fm", meters).length();
         }
+        return Writer(buffer, size).printf("%.2fkm", meters / 1000.0).length();
     }
-    
+
     /**
      * Formatea frecuencia con unidades
      */
-    inline String formatFrequency(float freq) {
+    inline size_t formatFrequency(char* buffer, size_t size, float freq) {
         if (freq < 1000) {
-            return String(freq, 1) + "Hz";
+            return Writer(buffer, size).printf("%.1fHz", freq).length();
         } else if (freq < 1000000) {
-            return String(freq / 1000.0, 1) + "kHz";
-        } else {
-            return String(freq / 1000000.0, 1) + "MHz";
+            return Writer(buffer, size).printf("%.1fkHz", freq / 1000.0).length();
         }
+        return Writer(buffer, size).printf("%.1fMHz", freq / 1000000.0).length();
     }
-    
+
     /**
      * Formatea tamaño de memoria
      */
-    inline String formatMemorySize(uint32_t bytes) {
+    inline size_t formatMemorySize(char* buffer, size_t size, uint32_t bytes) {
         if (bytes < 1024) {
-            return String(bytes) + "B";
+            return Writer(buffer, size).printf("%luB", (unsigned long)bytes).length();
         } else if (bytes < 1024 * 1024) {
-            return String(bytes / 1024.0, 1) + "KB";
-        } else {
-            return String(bytes / (1024.0 * 1024.0), 1) + "MB";
+            return Writer(buffer, size).printf("%.1fKB", bytes / 1024.0).length();
         }
+        return Writer(buffer, size).printf("%.1fMB", bytes / (1024.0 * 1024.0)).length();
     }
-    
+
     // ========================================================================
     // FORMATEO DE ARRAYS DE BYTES
     // ========================================================================
-    
+
     /**
-     * Convierte array de bytes a string hexadecimal
+     * Convierte array de bytes a texto hexadecimal
      */
-    inline String bytesToHex(const uint8_t* data, size_t length, bool uppercase = true, const char* separator = "") {
-        String result = "";
-        const char* format = uppercase ? "%02X" : "%02x";
-        
-        for (size_t i = 0; i < length; i++) {
-            char buffer[3];
-            snprintf(buffer, sizeof(buffer), format, data[i]);
-            result += buffer;
-            
-            if (i < length - 1 && strlen(separator) > 0) {
-                result += separator;
+    inline size_t bytesToHex(char* buffer, size_t size, const uint8_t* data, size_t length,
+                             bool uppercase = true, const char* separator = "") {
+        const char* digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+        Writer out(buffer, size);
+
+        for (size_t i = 0; i < length && !out.truncated(); i++) {
+            if (i > 0) {
+                out.print(separator);
             }
+            out.print(digits[data[i] >> 4]).print(digits[data[i] & 0x0F]);
         }
-        
-        return result;
+
+        return out.length();
     }
-    
+
+    inline int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
     /**
-     * Convierte string hexadecimal a array de bytes
+     * Convierte texto hexadecimal a array de bytes (ignora ':', ' ' y '-')
      */
-    inline size_t hexToBytes(const String& hexString, uint8_t* buffer, size_t maxLength) {
-        String cleanHex = hexString;
-        cleanHex.replace(":", "");
-        cleanHex.replace(" ", "");
-        cleanHex.replace("-", "");
-        
-        size_t length = min((size_t)(cleanHex.length() / 2), maxLength);
-        
-        for (size_t i = 0; i < length; i++) {
-            String byteString = cleanHex.substring(i * 2, i * 2 + 2);
-            buffer[i] = (uint8_t)strtol(byteString.c_str(), NULL, 16);
+    inline size_t hexToBytes(const char* hexString, uint8_t* buffer, size_t maxLength) {
+        size_t length = 0;
+        int high = -1;
+
+        for (const char* c = hexString; c && *c && length < maxLength; c++) {
+            if (*c == ':' || *c == ' ' || *c == '-') {
+                continue;
+            }
+            int value = hexDigit(*c);
+            if (value < 0) {
+                break;
+            }
+            if (high < 0) {
+                high = value;
+            } else {
+                buffer[length++] = (uint8_t)((high << 4) | value);
+                high = -1;
+            }
         }
-        
+
         return length;
     }
-    
+
     // ========================================================================
     // VALIDACIÓN DE STRINGS
     // ========================================================================
-    
+
     /**
      * Verifica si una string es un número válido
      */
-    inline bool isNumeric(const String& str) {
-        if (str.length() == 0) return false;
-        
+    inline bool isNumeric(const char* str) {
+        if (!str || str[0] == '\0') return false;
+
         bool hasDecimal = false;
-        int startIndex = 0;
-        
+        size_t startIndex = 0;
+
         // Permitir signo negativo al inicio
-        if (str.charAt(0) == '-' || str.charAt(0) == '+') {
+        if (str[0] == '-' || str[0] == '+') {
             startIndex = 1;
-            if (str.length() == 1) return false;
+            if (str[1] == '\0') return false;
         }
-        
-        for (int i = startIndex; i < str.length(); i++) {
-            char c = str.charAt(i);
-            
+
+        for (size_t i = startIndex; str[i]; i++) {
+            char c = str[i];
+
             if (c == '.') {
                 if (hasDecimal) return false; // Más de un punto decimal
                 hasDecimal = true;
-            } else if (!isdigit(c)) {
+            } else if (!isdigit((unsigned char)c)) {
                 return false;
             }
         }
-        
+
         return true;
     }
-    
+
     /**
      * Verifica si una string contiene solo caracteres alfanuméricos
      */
-    inline bool isAlphanumeric(const String& str) {
-        for (int i = 0; i < str.length(); i++) {
-            if (!isalnum(str.charAt(i))) {
+    inline bool isAlphanumeric(const char* str) {
+        for (size_t i = 0; str && str[i]; i++) {
+            if (!isalnum((unsigned char)str[i])) {
                 return false;
             }
         }
         return true;
     }
-    
+
     // ========================================================================
     // MANIPULACIÓN DE STRINGS
     // ========================================================================
-    
+
     /**
-     * Capitaliza la primera letra de cada palabra
+     * Capitaliza la primera letra de cada palabra (en el mismo buffer)
      */
-    inline String toTitleCase(String str) {
+    inline char* toTitleCase(char* str) {
         bool capitalize = true;
-        
-        for (int i = 0; i < str.length(); i++) {
-            if (str.charAt(i) == ' ') {
+
+        for (size_t i = 0; str && str[i]; i++) {
+            unsigned char c = str[i];
+            if (c == ' ') {
                 capitalize = true;
-            } else if (capitalize && isalpha(str.charAt(i))) {
-                str.setCharAt(i, toupper(str.charAt(i)));
+            } else if (capitalize && isalpha(c)) {
+                str[i] = toupper(c);
                 capitalize = false;
             } else {
-                str.setCharAt(i, tolower(str.charAt(i)));
+                str[i] = tolower(c);
             }
         }
-        
+
         return str;
     }
-    
+
     /**
-     * Trunca una string a una longitud máxima y añade "..."
+     * Trunca un texto a una longitud máxima y añade "..."
      */
-    inline String truncate(const String& str, int maxLength, const String& suffix = "...") {
-        if (str.length() <= maxLength) {
-            return str;
+    inline size_t truncate(char* buffer, size_t size, const char* str, size_t maxLength, const char* suffix = "...") {
+        size_t length = strlen(str);
+        size_t suffixLength = strlen(suffix);
+        Writer out(buffer, size < maxLength + 1 ? size : maxLength + 1); // Nunca más de maxLength
+
+        if (length <= maxLength) {
+            return out.print(str).length();
         }
-        
-        int truncateLength = maxLength - suffix.length();
-        if (truncateLength <= 0) {
-            return suffix.substring(0, maxLength);
+        if (maxLength <= suffixLength) {
+            return out.print(suffix).length();
         }
-        
-        return str.substring(0, truncateLength) + suffix;
+        return out.printf("%.*s", (int)(maxLength - suffixLength), str).print(suffix).length();
     }
-    
+
     /**
      * Centra un texto en un ancho específico
      */
-    inline String center(const String& str, int width, char fillChar = ' ') {
-        if (str.length() >= width) {
-            return str;
-        }
-        
-        int totalPadding = width - str.length();
-        int leftPadding = totalPadding / 2;
-        int rightPadding = totalPadding - leftPadding;
-        
-        String result = "";
-        for (int i = 0; i < leftPadding; i++) {
-            result += fillChar;
-        }
-        result += str;
-        for (int i = 0; i < rightPadding; i++) {
-            result += fillChar;
-        }
-        
-        return result;
+    inline size_t center(char* buffer, size_t size, const char* str, size_t width, char fillChar = ' ') {
+        size_t length = strlen(str);
+        size_t totalPadding = length < width ? width - length : 0;
+
+        return Writer(buffer, size)
+            .repeat(fillChar, totalPadding / 2)
+            .print(str)
+            .repeat(fillChar, totalPadding - totalPadding / 2)
+            .length();
     }
-    
+
     /**
-     * Pads un string a la izquierda
+     * Rellena un texto a la izquierda
      */
-    inline String padLeft(const String& str, int width, char fillChar = ' ') {
-        if (str.length() >= width) {
-            return str;
-        }
-        
-        String result = "";
-        for (int i = 0; i < width - str.length(); i++) {
-            result += fillChar;
-        }
-        result += str;
-        
-        return result;
+    inline size_t padLeft(char* buffer, size_t size, const char* str, size_t width, char fillChar = ' ') {
+        size_t length = strlen(str);
+        return Writer(buffer, size).repeat(fillChar, length < width ? width - length : 0).print(str).length();
     }
-    
+
     /**
-     * Pads un string a la derecha
+     * Rellena un texto a la derecha
      */
-    inline String padRight(const String& str, int width, char fillChar = ' ') {
-        if (str.length() >= width) {
-            return str;
-        }
-        
-        String result = str;
-        for (int i = 0; i < width - str.length(); i++) {
-            result += fillChar;
-        }
-        
-        return result;
+    inline size_t padRight(char* buffer, size_t size, const char* str, size_t width, char fillChar = ' ') {
+        size_t length = strlen(str);
+        return Writer(buffer, size).print(str).repeat(fillChar, length < width ? width - length : 0).length();
     }
-    
+
     // ========================================================================
     // FUNCIONES ESPECIALIZADAS PARA EL COLLAR
     // ========================================================================
-    
+
     /**
-     * Genera un ID único para el dispositivo basado en MAC
+     * ID del dispositivo a partir de la MAC (ESP.getEfuseMac())
      */
-    inline String generateDeviceId() {
-        uint64_t mac = ESP.getEfuseMac();
-        char deviceId[13];
-        snprintf(deviceId, sizeof(deviceId), "%012llX", mac);
-        return String(deviceId);
+    inline size_t formatDeviceId(char* buffer, size_t size, uint64_t mac) {
+        return Writer(buffer, size).printf("%012llX", (unsigned long long)mac).length();
     }
-    
+
     /**
      * Formatea información de posición para transmisión
      */
-    inline String formatPositionPayload(double lat, double lng, float alt, uint8_t sats) {
-        return String(lat, 6) + "," + String(lng, 6) + "," + 
-               String(alt, 1) + "," + String(sats);
+    inline size_t formatPositionPayload(char* buffer, size_t size, double lat, double lng, float alt, uint8_t sats) {
+        return Writer(buffer, size).printf("%.6f,%.6f,%.1f,%u", lat, lng, alt, sats).length();
     }
-    
+
     /**
      * Crea un mensaje de status del sistema
      */
-    inline String createStatusMessage(uint32_t uptime, float batteryV, uint8_t batteryP, 
-                                    float distance, const String& alertLevel) {
-        return "UP:" + formatUptime(uptime) + 
-               " BAT:" + formatVoltage(batteryV) + "(" + formatPercentage(batteryP) + ")" +
-               " DIST:" + formatDistance(distance) +
-               " ALERT:" + alertLevel;
+    inline size_t createStatusMessage(char* buffer, size_t size, uint32_t uptime, float batteryV, uint8_t batteryP,
+                                      float distance, const char* alertLevel) {
+        char part[24];
+        Writer out(buffer, size);
+
+        formatUptime(part, sizeof(part), uptime);
+        out.print("UP:").print(part);
+        formatVoltage(part, sizeof(part), batteryV);
+        out.print(" BAT:").print(part);
+        formatPercentage(part, sizeof(part), batteryP);
+        out.print("(").print(part).print(")");
+        formatDistance(part, sizeof(part), distance);
+        out.print(" DIST:").print(part);
+        return out.print(" ALERT:").print(alertLevel).length();
     }
-    
+
 } // namespace StringUtils
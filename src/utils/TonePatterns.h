@@ -0,0 +1,280 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "../config/constants.h"
+
+/*
+ * ============================================================================
+ * PATRONES DE TONOS - MELODÍAS Y CADENCIAS DE ALERTA EN FLASH
+ * ============================================================================
+ * Cada melodía o cadencia se escribe como texto y se compila a una tabla de
+ * pasos de 2 bytes: índice de tono (nota MIDI, 0 = silencio) y duración en
+ * ticks de TONE_TICK_MS. El texto son pasos separados por espacios:
+ *
+ *     "C4:200 E4:200 G4:200 C5:400"   nota (A-G, # o b, octava) : ms
+ *     "D6:200 -:800"                  '-' = silencio
+ *
+ * Las duraciones deben ser múltiplos de TONE_TICK_MS (hasta 255 ticks) y las
+ * notas estar entre C0 y G9; si no, la tabla no compila. El silencio al
+ * final de una cadencia fija el intervalo entre repeticiones.
+ *
+ * LIBRARY reúne los patrones por PatternId, el número que usa el backend
+ * para elegirlos por downlink. Volumen, silencio entre notas y repeticiones
+ * van en la entrada de LIBRARY, no en los pasos.
+ */
+
+// En el ESP32 las constantes ya quedan en flash; PROGMEM se mantiene por
+// compatibilidad con placas AVR/ESP8266
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+namespace TonePatterns {
+
+    constexpr uint16_t TICK_MS = TONE_TICK_MS;
+    constexpr uint8_t SILENCE = 0;
+
+    struct Step {
+        uint8_t tone;  // Nota MIDI (69 = La4 = 440 Hz); 0 = silencio
+        uint8_t ticks; // Duración en ticks de TICK_MS
+    };
+
+    struct Pattern {
+        const Step *steps;
+        uint8_t count;
+        uint8_t volume;
+        uint8_t gap;         // Silencio después de cada paso (ticks)
+        uint8_t repetitions; // 0 = hasta detenerlo (cadencias de alerta)
+    };
+
+    // ========================================================================
+    // TABLA DE FRECUENCIAS
+    // ========================================================================
+
+    constexpr uint8_t TONE_COUNT = 128;
+
+    struct ToneTable {
+        uint16_t hz[TONE_COUNT];
+    };
+
+    // Temperamento igual desde La4 = 440 Hz, redondeado a Hz como musical_notes.h
+    constexpr ToneTable makeToneTable() {
+        ToneTable table = {};
+        const double SEMITONE = 1.0594630943592953;
+        double up = 440.0;
+        for (int note = 69; note < TONE_COUNT; note++) {
+            table.hz[note] = (uint16_t)(up + 0.5);
+            up *= SEMITONE;
+        }
+        double down = 440.0;
+        for (int note = 68; note > SILENCE; note--) {
+            down /= SEMITONE;
+            table.hz[note] = (uint16_t)(down + 0.5);
+        }
+        return table;
+    }
+
+    constexpr ToneTable TONES PROGMEM = makeToneTable();
+
+    inline uint16_t frequency(uint8_t tone) {
+        return tone < TONE_COUNT ? TONES.hz[tone] : 0;
+    }
+
+    // Nota más cercana a una frecuencia cualquiera (tonos sueltos de playTone)
+    inline uint8_t nearestTone(uint16_t hz) {
+        if (hz == 0) {
+            return SILENCE;
+        }
+        uint8_t low = 1;
+        uint8_t high = TONE_COUNT - 1;
+        while (low < high) {
+            uint8_t middle = (low + high) / 2;
+            if (TONES.hz[middle] < hz) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        if (low > 1 && hz - TONES.hz[low - 1] < TONES.hz[low] - hz) {
+            return low - 1;
+        }
+        return low;
+    }
+
+    // Duración en ticks, redondeada hacia arriba y entre 1 y 255
+    inline uint8_t ticksFor(uint32_t ms) {
+        uint32_t ticks = (ms + TICK_MS - 1) / TICK_MS;
+        return ticks == 0 ? 1 : (ticks > 255 ? 255 : (uint8_t)ticks);
+    }
+
+    // ========================================================================
+    // COMPILADOR DEL TEXTO
+    // ========================================================================
+
+    // No es constexpr: llamarla al evaluar una tabla la vuelve un error de compilación
+    inline void invalidPattern(const char *reason) {
+        (void)reason;
+    }
+
+    constexpr bool isSeparator(char c) {
+        return c == ' ' || c == '\0';
+    }
+
+    constexpr size_t countSteps(const char *text) {
+        size_t count = 0;
+        for (size_t i = 0; text[i] != '\0'; i++) {
+            if (!isSeparator(text[i]) && isSeparator(text[i + 1])) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    constexpr uint8_t semitone(char letter) {
+        switch (letter) {
+        case 'C': return 0;
+        case 'D': return 2;
+        case 'E': return 4;
+        case 'F': return 5;
+        case 'G': return 7;
+        case 'A': return 9;
+        case 'B': return 11;
+        default:
+            invalidPattern("Nota desconocida");
+            return 0;
+        }
+    }
+
+    template <size_t N>
+    struct Steps {
+        static constexpr uint8_t COUNT = N;
+        Step steps[N];
+    };
+
+    template <size_t N>
+    constexpr Steps<N> compile(const char *text) {
+        static_assert(N > 0 && N <= 255, "Un patrón tiene de 1 a 255 pasos");
+        Steps<N> result = {};
+        size_t i = 0;
+        for (size_t n = 0; n < N; n++) {
+            while (text[i] == ' ') {
+                i++;
+            }
+
+            Step step = {};
+            if (text[i] == '-') {
+                step.tone = SILENCE;
+                i++;
+            } else {
+                int note = semitone(text[i++]);
+                if (text[i] == '#') {
+                    note++;
+                    i++;
+                } else if (text[i] == 'b') {
+                    note--;
+                    i++;
+                }
+                if (text[i] < '0' || text[i] > '9') {
+                    invalidPattern("Falta la octava");
+                }
+                note += (text[i++] - '0' + 1) * 12;
+                if (note <= SILENCE || note >= TONE_COUNT) {
+                    invalidPattern("Nota fuera de rango");
+                }
+                step.tone = (uint8_t)note;
+            }
+
+            if (text[i++] != ':') {
+                invalidPattern("Falta ':' antes de la duración");
+            }
+            uint32_t ms = 0;
+            while (!isSeparator(text[i])) {
+                if (text[i] < '0' || text[i] > '9') {
+                    invalidPattern("Duración no numérica");
+                }
+                ms = ms * 10 + (text[i++] - '0');
+            }
+            if (ms == 0 || ms % TICK_MS != 0 || ms / TICK_MS > 255) {
+                invalidPattern("Duración fuera de la grilla de ticks");
+            }
+            step.ticks = (uint8_t)(ms / TICK_MS);
+            result.steps[n] = step;
+        }
+        return result;
+    }
+
+    template <size_t N>
+    constexpr Pattern pattern(const Steps<N> &steps, uint8_t volume, uint16_t gapMs, uint8_t repetitions) {
+        return {steps.steps, Steps<N>::COUNT, volume, (uint8_t)(gapMs / TICK_MS), repetitions};
+    }
+
+// Tabla de pasos desde el texto (la cantidad de pasos se cuenta en compilación)
+#define TONE_STEPS(text) TonePatterns::compile<TonePatterns::countSteps(text)>(text)
+
+    // ========================================================================
+    // PATRONES
+    // ========================================================================
+
+    enum PatternId : uint8_t {
+        PATTERN_STARTUP,
+        PATTERN_SHUTDOWN,
+        PATTERN_SUCCESS,
+        PATTERN_ERROR,
+        PATTERN_WARNING,
+        PATTERN_ALERT_CAUTION,      // Tono corto y grave cada 1 s
+        PATTERN_ALERT_WARNING,      // Tono largo y agudo cada 1 s
+        PATTERN_ALERT_GRADIENT,     // 3 tonos cada vez más agudos
+        PATTERN_ALERT_INTERMITTENT, // Ráfaga de 3 tonos
+        PATTERN_BUTTON,
+        PATTERN_GEOFENCE_UPDATED,
+        PATTERN_GEOFENCE_EDITED,
+        PATTERN_JOINED,
+        PATTERN_BATTERY_LOW,
+        PATTERN_BOOT_CONFIRM,
+        PATTERN_LOCATE, // Para encontrar al animal en el potrero
+        PATTERN_COUNT,
+        PATTERN_NONE = 0xFF
+    };
+
+    constexpr auto STARTUP_STEPS PROGMEM = TONE_STEPS("C4:200 E4:200 G4:200 C5:400");
+    constexpr auto SHUTDOWN_STEPS PROGMEM = TONE_STEPS("C5:200 G4:200 E4:200 C4:400");
+    constexpr auto SUCCESS_STEPS PROGMEM = TONE_STEPS("G4:150 C5:150 E5:300");
+    constexpr auto ERROR_STEPS PROGMEM = TONE_STEPS("A4:100 -:50 A4:100 -:50 A4:200");
+    constexpr auto WARNING_STEPS PROGMEM = TONE_STEPS("F4:200 A4:200 F4:200");
+    constexpr auto ALERT_CAUTION_STEPS PROGMEM = TONE_STEPS("G5:100 -:900");
+    constexpr auto ALERT_WARNING_STEPS PROGMEM = TONE_STEPS("D6:200 -:800");
+    constexpr auto ALERT_GRADIENT_STEPS PROGMEM = TONE_STEPS("G5:100 -:50 B5:100 -:50 D6:100 -:600");
+    constexpr auto ALERT_INTERMITTENT_STEPS PROGMEM = TONE_STEPS("D6:100 -:100 D6:100 -:100 D6:100 -:500");
+    constexpr auto BUTTON_STEPS PROGMEM = TONE_STEPS("D6:50");
+    constexpr auto GEOFENCE_UPDATED_STEPS PROGMEM = TONE_STEPS("F#6:100 B6:100");
+    constexpr auto GEOFENCE_EDITED_STEPS PROGMEM = TONE_STEPS("B6:80");
+    constexpr auto JOINED_STEPS PROGMEM = TONE_STEPS("B6:200");
+    constexpr auto BATTERY_LOW_STEPS PROGMEM = TONE_STEPS("B4:100");
+    constexpr auto BOOT_CONFIRM_STEPS PROGMEM = TONE_STEPS("B5:50");
+    constexpr auto LOCATE_STEPS PROGMEM = TONE_STEPS("C6:150 E6:150 G6:300 -:400");
+
+    // Por PatternId: volumen, silencio entre pasos (ms) y repeticiones
+    constexpr Pattern LIBRARY[PATTERN_COUNT] PROGMEM = {
+        pattern(STARTUP_STEPS, VOLUME_MEDIUM, TONE_NOTE_GAP_MS, 1),
+        pattern(SHUTDOWN_STEPS, VOLUME_MEDIUM, TONE_NOTE_GAP_MS, 1),
+        pattern(SUCCESS_STEPS, VOLUME_MEDIUM, TONE_NOTE_GAP_MS, 1),
+        pattern(ERROR_STEPS, VOLUME_HIGH, TONE_NOTE_GAP_MS, 1),
+        pattern(WARNING_STEPS, VOLUME_HIGH, TONE_NOTE_GAP_MS, 1),
+        pattern(ALERT_CAUTION_STEPS, VOLUME_LOW, 0, 0),
+        pattern(ALERT_WARNING_STEPS, VOLUME_MEDIUM, 0, 0),
+        pattern(ALERT_GRADIENT_STEPS, VOLUME_LOW, 0, 0),
+        pattern(ALERT_INTERMITTENT_STEPS, VOLUME_HIGH, 0, 0),
+        pattern(BUTTON_STEPS, 60, 0, 1),
+        pattern(GEOFENCE_UPDATED_STEPS, 100, 0, 1),
+        pattern(GEOFENCE_EDITED_STEPS, 100, 0, 1),
+        pattern(JOINED_STEPS, 200, 0, 1),
+        pattern(BATTERY_LOW_STEPS, 100, 0, 1),
+        pattern(BOOT_CONFIRM_STEPS, 50, 0, 1),
+        pattern(LOCATE_STEPS, VOLUME_HIGH, 0, 5),
+    };
+
+    inline const Pattern *find(uint8_t id) {
+        return id < PATTERN_COUNT ? &LIBRARY[id] : nullptr;
+    }
+
+} // namespace TonePatterns
@@ -0,0 +1,245 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - ALERT FILTER (HISTÉRESIS Y PERMANENCIA)
+ * ============================================================================
+ * Pistas de distancia al borde, una posición cada GPS_UPDATE_INTERVAL, se
+ * pasan por el filtro y por el nivel crudo de antes (umbral directo) y se
+ * comparan los arranques del buzzer: animal pastando junto al umbral de
+ * precaución, salida y vuelta a la geocerca, y saltos aislados por
+ * multitrayecto. Además, los tiempos exactos de subida y bajada.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include "config/constants.h"
+#include "system/AlertFilter.h"
+
+// Umbrales de AlertManager.h (CAUTION_DISTANCE, WARNING_DISTANCE)
+static const float CAUTION_M = -15.0f;
+static const float WARNING_M = 0.0f;
+static const uint32_t FIX_MS = GPS_UPDATE_INTERVAL;
+
+// ============================================================================
+// PISTAS (distancia al borde en metros, negativa = dentro)
+// ============================================================================
+
+// Pastando junto al umbral de precaución durante 4 minutos, ruido del GPS ~2,5 m
+static const float GRAZING_TRACK[] = {
+    -15.6, -13.7, -15.6, -15.8, -17.3, -15.5, -12.2, -13.9, -12.4, -14.4, -14.0, -14.5,
+    -19.2, -12.9, -13.7, -13.8, -19.2, -19.4, -17.2, -16.2, -14.2, -15.1, -13.7, -16.6,
+    -14.2, -14.0, -16.7, -10.7, -13.6, -12.0, -16.6, -16.8, -15.9, -15.3, -13.4, -14.4,
+    -16.1, -17.4, -16.3, -11.9, -17.0, -14.4, -13.9, -18.7, -14.9, -11.7, -20.0, -15.8,
+};
+
+// Sale caminando a 0,6 m/s hasta 30 m fuera y vuelve
+static const float CROSSING_TRACK[] = {
+    -40.2, -38.2, -33.3, -31.1, -30.2, -23.8, -21.0, -17.6, -13.8, -12.5, -9.8, -8.9,
+    -3.1, -1.9, 1.3, 3.1, 6.5, 10.2, 15.9, 14.0, 17.8, 23.4, 28.2, 29.9,
+    29.2, 25.2, 26.5, 21.9, 18.3, 18.5, 15.7, 11.2, 8.4, 5.7, 4.4, -0.1,
+    -3.2, -6.2, -12.4, -11.1, -14.6, -18.2, -25.0, -26.0, -26.7, -33.7, -34.3, -35.5,
+    -42.0, -40.6, -45.2, -49.2, -51.5, -54.0,
+};
+
+// Bien adentro, con dos posiciones sueltas por multitrayecto
+static const float MULTIPATH_TRACK[] = {
+    -31.2, -29.8, -30.5, -32.0, 24.7, -30.9, -29.4, -31.7, -30.2, -28.8,
+    -12.3, -30.1, -31.5, -29.9, -30.6, -32.4, -30.0, -29.5, -31.1, -30.8,
+};
+
+#define TRACK_LENGTH(track) (sizeof(track) / sizeof(track[0]))
+
+struct Replay {
+    uint32_t starts;      // SAFE -> alerta: el buzzer empieza a sonar
+    uint32_t changes;     // Cambios de nivel (cada uno reemplaza la cadencia)
+    uint32_t alertingMs;  // Tiempo con el buzzer sonando
+    int32_t firstCaution; // Índice de la posición en que se entra a cada nivel
+    int32_t firstWarning;
+    int32_t lastAlert;    // Última posición en alerta
+};
+
+static AlertFilter::Config rawConfig() {
+    AlertFilter::Config config(CAUTION_M, WARNING_M);
+    config.hysteresisMeters = 0.0f;
+    config.escalateDwellMs = 0;
+    config.releaseDwellMs = 0;
+    return config;
+}
+
+static Replay replay(AlertFilter &filter, const float *track, size_t length) {
+    Replay result = {0, 0, 0, -1, -1, -1};
+    AlertLevel previous = AlertLevel::SAFE;
+    for (size_t i = 0; i < length; i++) {
+        AlertLevel level = filter.update(track[i], i * FIX_MS);
+        if (level != previous) {
+            result.changes++;
+            if (previous == AlertLevel::SAFE) {
+                result.starts++;
+            }
+        }
+        if (level > AlertLevel::SAFE) {
+            result.alertingMs += FIX_MS;
+            result.lastAlert = i;
+        }
+        if (level >= AlertLevel::CAUTION && result.firstCaution < 0) {
+            result.firstCaution = i;
+        }
+        if (level == AlertLevel::WARNING && result.firstWarning < 0) {
+            result.firstWarning = i;
+        }
+        previous = level;
+    }
+    return result;
+}
+
+static void printReplay(const char *name, const Replay &raw, const Replay &filtered) {
+    printf("  [info] %-10s crudo: %2lu arranques, %2lu cambios, %3lu s sonando | filtrado: %lu, %lu, %lu s\n",
+           name, (unsigned long)raw.starts, (unsigned long)raw.changes, (unsigned long)raw.alertingMs / 1000,
+           (unsigned long)filtered.starts, (unsigned long)filtered.changes, (unsigned long)filtered.alertingMs / 1000);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+// PISTAS
+// ============================================================================
+
+void test_grazing_along_threshold(void) {
+    AlertFilter raw(rawConfig());
+    AlertFilter filter(AlertFilter::Config(CAUTION_M, WARNING_M));
+    Replay before = replay(raw, GRAZING_TRACK, TRACK_LENGTH(GRAZING_TRACK));
+    Replay after = replay(filter, GRAZING_TRACK, TRACK_LENGTH(GRAZING_TRACK));
+    printReplay("pastando", before, after);
+
+    // Antes el buzzer arrancaba y paraba en cada cruce del umbral
+    TEST_ASSERT_TRUE(before.starts >= 8);
+
+    // Dos posiciones seguidas en precaución (6 y 7) la activan y ya no se corta:
+    // nunca queda 5 m por debajo del umbral durante 20 s
+    TEST_ASSERT_EQUAL_UINT32(1, after.starts);
+    TEST_ASSERT_EQUAL_UINT32(1, after.changes);
+    TEST_ASSERT_EQUAL_INT32(7, after.firstCaution);
+    TEST_ASSERT_EQUAL_INT32(-1, after.firstWarning);
+    TEST_ASSERT_TRUE(filter.getStats().rejected > 0); // Las posiciones sueltas de antes
+}
+
+void test_crossing_and_return(void) {
+    AlertFilter raw(rawConfig());
+    AlertFilter filter(AlertFilter::Config(CAUTION_M, WARNING_M));
+    Replay before = replay(raw, CROSSING_TRACK, TRACK_LENGTH(CROSSING_TRACK));
+    Replay after = replay(filter, CROSSING_TRACK, TRACK_LENGTH(CROSSING_TRACK));
+    printReplay("salida", before, after);
+
+    // Una salida real alerta una sola vez, una posición después que el umbral crudo
+    TEST_ASSERT_EQUAL_UINT32(1, before.starts);
+    TEST_ASSERT_EQUAL_UINT32(1, after.starts);
+    TEST_ASSERT_EQUAL_INT32(before.firstCaution + 1, after.firstCaution);
+    TEST_ASSERT_EQUAL_INT32(before.firstWarning + 1, after.firstWarning);
+
+    // SAFE -> CAUTION -> WARNING -> CAUTION -> SAFE, sin idas y vueltas
+    TEST_ASSERT_EQUAL_UINT32(4, after.changes);
+
+    // Al volver la alerta sigue hasta estar 20 m adentro durante 20 s
+    TEST_ASSERT_EQUAL_INT32(45, after.lastAlert);
+    TEST_ASSERT_TRUE(CROSSING_TRACK[after.lastAlert + 1] < CAUTION_M - ALERT_HYSTERESIS_M);
+}
+
+void test_multipath_outliers_ignored(void) {
+    AlertFilter raw(rawConfig());
+    AlertFilter filter(AlertFilter::Config(CAUTION_M, WARNING_M));
+    Replay before = replay(raw, MULTIPATH_TRACK, TRACK_LENGTH(MULTIPATH_TRACK));
+    Replay after = replay(filter, MULTIPATH_TRACK, TRACK_LENGTH(MULTIPATH_TRACK));
+    printReplay("multitray.", before, after);
+
+    TEST_ASSERT_EQUAL_UINT32(2, before.starts);
+    TEST_ASSERT_EQUAL_UINT32(0, after.starts);
+    TEST_ASSERT_EQUAL_UINT32(2, filter.getStats().rejected);
+    TEST_ASSERT_EQUAL_UINT32(TRACK_LENGTH(MULTIPATH_TRACK), filter.getStats().readings);
+}
+
+void test_zero_config_matches_raw_levels(void) {
+    const float *tracks[] = {GRAZING_TRACK, CROSSING_TRACK, MULTIPATH_TRACK};
+    const size_t lengths[] = {TRACK_LENGTH(GRAZING_TRACK), TRACK_LENGTH(CROSSING_TRACK), TRACK_LENGTH(MULTIPATH_TRACK)};
+    for (size_t t = 0; t < 3; t++) {
+        AlertFilter filter(rawConfig());
+        for (size_t i = 0; i < lengths[t]; i++) {
+            float distance = tracks[t][i];
+            TEST_ASSERT_EQUAL_UINT8((uint8_t)filter.classify(distance), (uint8_t)filter.update(distance, i * FIX_MS));
+        }
+    }
+}
+
+// ============================================================================
+// TIEMPOS
+// ============================================================================
+
+void test_escalation_dwell_and_direction_change(void) {
+    AlertFilter::Config config(CAUTION_M, WARNING_M);
+    config.escalateDwellMs = 4000;
+    config.releaseDwellMs = 10000;
+    AlertFilter filter(config);
+
+    // CAUTION pedida en 1000 y WARNING en 3000: el tiempo corre desde 1000
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::SAFE, (uint8_t)filter.update(-10.0f, 1000));
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::CAUTION, (uint8_t)filter.getPendingLevel());
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::SAFE, (uint8_t)filter.update(5.0f, 3000));
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::SAFE, (uint8_t)filter.update(5.0f, 4999));
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::WARNING, (uint8_t)filter.update(5.0f, 5000));
+    TEST_ASSERT_EQUAL_UINT32(1, filter.getStats().transitions);
+
+    // Bajada a CAUTION interrumpida por una vuelta a WARNING: empieza de nuevo
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::WARNING, (uint8_t)filter.update(-8.0f, 6000));
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::WARNING, (uint8_t)filter.update(1.0f, 12000));
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::WARNING, (uint8_t)filter.update(-8.0f, 13000));
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::WARNING, (uint8_t)filter.update(-8.0f, 22999));
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::CAUTION, (uint8_t)filter.update(-8.0f, 23000));
+    TEST_ASSERT_EQUAL_UINT32(1, filter.getStats().rejected);
+}
+
+void test_hysteresis_band(void) {
+    AlertFilter::Config config(CAUTION_M, WARNING_M);
+    config.escalateDwellMs = 0;
+    config.releaseDwellMs = 0;
+    AlertFilter filter(config);
+
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::WARNING, (uint8_t)filter.update(0.0f, 0));
+    // Dentro de la banda se mantiene el nivel
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::WARNING, (uint8_t)filter.update(-4.9f, 1));
+    // Por debajo de la banda de WARNING pero dentro de la de CAUTION
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::CAUTION, (uint8_t)filter.update(-19.0f, 2));
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::CAUTION, (uint8_t)filter.update(-16.0f, 3));
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::SAFE, (uint8_t)filter.update(-20.1f, 4));
+    // Para volver a entrar alcanza el umbral, sin banda
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::CAUTION, (uint8_t)filter.update(-15.0f, 5));
+}
+
+void test_force_and_reset(void) {
+    AlertFilter filter(AlertFilter::Config(CAUTION_M, WARNING_M));
+
+    // Escalada por tiempo de AlertManager: la siguiente posición en precaución no la deshace
+    filter.force(AlertLevel::WARNING, 1000);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::WARNING, (uint8_t)filter.update(-10.0f, 6000));
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::CAUTION, (uint8_t)filter.update(-10.0f, 6000 + ALERT_RELEASE_DWELL_MS));
+
+    filter.reset();
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::SAFE, (uint8_t)filter.getLevel());
+    TEST_ASSERT_EQUAL_UINT32(0, filter.getStats().readings);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_grazing_along_threshold);
+    RUN_TEST(test_crossing_and_return);
+    RUN_TEST(test_multipath_outliers_ignored);
+    RUN_TEST(test_zero_config_matches_raw_levels);
+    RUN_TEST(test_escalation_dwell_and_direction_change);
+    RUN_TEST(test_hysteresis_band);
+    RUN_TEST(test_force_and_reset);
+    return UNITY_END();
+}
@@ -0,0 +1,260 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - APPROACH PREDICTOR (ALERTA ANTICIPADA)
+ * ============================================================================
+ * Un animal camina junto al borde norte de un potrero (borde recto: la
+ * distancia es la coordenada norte y la normal hacia afuera es (0, 1)).
+ * Cada GPS_UPDATE_INTERVAL se pasa la posición con ruido por el predictor
+ * y el nivel por AlertFilter, con y sin el tiempo hasta cruzar: el que va
+ * derecho y rápido hacia el borde recibe CAUTION antes; el que camina en
+ * paralelo o está quieto con ruido, no. Además, el costo por posición.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "config/constants.h"
+#include "system/ApproachPredictor.h"
+#include "system/AlertFilter.h"
+
+// Umbrales de AlertManager.h (CAUTION_DISTANCE, WARNING_DISTANCE)
+static const float CAUTION_M = -15.0f;
+static const float WARNING_M = 0.0f;
+static const uint32_t FIX_MS = GPS_UPDATE_INTERVAL;
+
+// Origen del potrero y metros por grado de la proyección local
+static const double LAT0 = -33.448890;
+static const double LNG0 = -70.669265;
+static const double M_PER_DEG_LAT = 110540.0;
+static const double M_PER_DEG_LNG = 111320.0 * cos(LAT0 * M_PI / 180.0);
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Ruido del GPS reproducible, uniforme en ±amplitude metros
+static uint32_t seed = 1;
+static float noise(float amplitude) {
+    seed = seed * 1103515245u + 12345u;
+    return amplitude * (((seed >> 8) & 0xFFFF) / 32767.5f - 1.0f);
+}
+
+static void feed(ApproachPredictor &predictor, float east, float north, uint32_t now) {
+    predictor.update(LAT0 + north / M_PER_DEG_LAT, LNG0 + east / M_PER_DEG_LNG, now);
+}
+
+// ============================================================================
+// RECORRIDOS
+// ============================================================================
+
+struct Walk {
+    float startEast, startNorth; // Metros; norte 0 = borde
+    float speedEast, speedNorth; // m/s
+    float noiseMeters;
+    uint32_t seconds;
+};
+
+struct Outcome {
+    float cautionAt;        // Distancia real al entrar a CAUTION (NAN = nunca)
+    uint32_t cautionMs;     // Tiempo al entrar a CAUTION
+    uint32_t anticipated;
+};
+
+static Outcome run(const Walk &walk, bool predict) {
+    ApproachPredictor predictor;
+    AlertFilter filter(AlertFilter::Config(CAUTION_M, WARNING_M));
+    Outcome outcome = {NAN, 0, 0};
+    seed = 1;
+
+    for (uint32_t now = 0; now <= walk.seconds * 1000; now += FIX_MS) {
+        float east = walk.startEast + walk.speedEast * now / 1000.0f;
+        float north = walk.startNorth + walk.speedNorth * now / 1000.0f;
+        float measuredEast = east + noise(walk.noiseMeters);
+        float measuredNorth = north + noise(walk.noiseMeters);
+
+        feed(predictor, measuredEast, measuredNorth, now);
+        float distance = measuredNorth;
+        float ttc = predict ? predictor.timeToCrossing(distance, 0.0f, 1.0f) : ApproachPredictor::NOT_APPROACHING;
+        AlertLevel level = filter.update(distance, now, ttc);
+        if (level != AlertLevel::SAFE && isnan(outcome.cautionAt)) {
+            outcome.cautionAt = north;
+            outcome.cautionMs = now;
+        }
+    }
+    outcome.anticipated = filter.getStats().anticipated;
+    return outcome;
+}
+
+static void report(const char *name, const Outcome &plain, const Outcome &predicted) {
+    printf("  [info] %-9s solo distancia: %s%6.1f m | con predicción: %s%6.1f m (%lu lecturas anticipadas)\n",
+           name, isnan(plain.cautionAt) ? "nunca " : "", isnan(plain.cautionAt) ? 0.0f : plain.cautionAt,
+           isnan(predicted.cautionAt) ? "nunca " : "", isnan(predicted.cautionAt) ? 0.0f : predicted.cautionAt,
+           (unsigned long)predicted.anticipated);
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_head_on_run_alerts_early(void) {
+    // Corre derecho al borde a 1,5 m/s desde 90 m adentro
+    Walk walk = {0.0f, -90.0f, 0.0f, 1.5f, 2.0f, 90};
+    Outcome plain = run(walk, false);
+    Outcome predicted = run(walk, true);
+    report("carrera", plain, predicted);
+
+    TEST_ASSERT_FALSE(isnan(plain.cautionAt));
+    TEST_ASSERT_FALSE(isnan(predicted.cautionAt));
+    // Solo por distancia entra a CAUTION pasando -15 m (+ permanencia); con
+    // el cruce previsto, unos 20 s antes
+    TEST_ASSERT_TRUE(plain.cautionAt > CAUTION_M - 3.0f);
+    TEST_ASSERT_TRUE(predicted.cautionAt < -25.0f);
+    TEST_ASSERT_TRUE(predicted.cautionMs + 15000 <= plain.cautionMs);
+    TEST_ASSERT_TRUE(predicted.anticipated > 0);
+}
+
+void test_parallel_walk_not_anticipated(void) {
+    // Camina a 1,5 m/s a lo largo del borde, 20 m adentro, 10 minutos
+    Walk walk = {0.0f, -20.0f, 1.5f, 0.0f, 2.0f, 600};
+    Outcome plain = run(walk, false);
+    Outcome predicted = run(walk, true);
+    report("paralelo", plain, predicted);
+
+    TEST_ASSERT_TRUE(isnan(plain.cautionAt));
+    TEST_ASSERT_TRUE(isnan(predicted.cautionAt));
+    TEST_ASSERT_EQUAL_UINT32(0, predicted.anticipated);
+}
+
+void test_slow_grazing_approach_not_anticipated(void) {
+    // Pastando hacia el borde a 0,15 m/s: la alerta llega por distancia
+    Walk walk = {0.0f, -40.0f, 0.1f, 0.15f, 2.0f, 300};
+    Outcome plain = run(walk, false);
+    Outcome predicted = run(walk, true);
+    report("pastoreo", plain, predicted);
+
+    TEST_ASSERT_FALSE(isnan(predicted.cautionAt));
+    TEST_ASSERT_EQUAL_UINT32(plain.cautionMs, predicted.cautionMs);
+}
+
+void test_standing_still_noise_not_anticipated(void) {
+    // Quieto justo fuera de la banda de precaución, ruido de ±3 m
+    Walk walk = {0.0f, -19.0f, 0.0f, 0.0f, 3.0f, 600};
+    Outcome predicted = run(walk, true);
+    report("quieto", run(walk, false), predicted);
+
+    TEST_ASSERT_EQUAL_UINT32(0, predicted.anticipated);
+}
+
+void test_time_to_crossing(void) {
+    ApproachPredictor predictor;
+    TEST_ASSERT_FALSE(predictor.hasVelocity());
+    TEST_ASSERT_EQUAL_FLOAT(ApproachPredictor::NOT_APPROACHING, predictor.timeToCrossing(-20.0f, 0.0f, 1.0f));
+
+    // 1 m/s al norte
+    feed(predictor, 0.0f, -30.0f, 0);
+    feed(predictor, 0.0f, -25.0f, 5000);
+    TEST_ASSERT_TRUE(predictor.hasVelocity());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, predictor.getVelocityNorth());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, predictor.getVelocityEast());
+
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 25.0f, predictor.timeToCrossing(-25.0f, 0.0f, 1.0f));
+    // Borde en diagonal: cierra a cos(60°) = 0,5 m/s
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 50.0f, predictor.timeToCrossing(-25.0f, 0.866f, 0.5f));
+    // Borde al sur (se aleja) y al este (paralelo)
+    TEST_ASSERT_EQUAL_FLOAT(ApproachPredictor::NOT_APPROACHING, predictor.timeToCrossing(-25.0f, 0.0f, -1.0f));
+    TEST_ASSERT_EQUAL_FLOAT(ApproachPredictor::NOT_APPROACHING, predictor.timeToCrossing(-25.0f, 1.0f, 0.0f));
+    // Afuera ya cruzó; sin normal definida no predice
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, predictor.timeToCrossing(2.0f, 0.0f, 1.0f));
+    TEST_ASSERT_EQUAL_FLOAT(ApproachPredictor::NOT_APPROACHING, predictor.timeToCrossing(-25.0f, 0.0f, 0.0f));
+}
+
+void test_reevaluation_jump_and_gap(void) {
+    ApproachPredictor predictor;
+    feed(predictor, 0.0f, -30.0f, 0);
+    feed(predictor, 0.0f, -25.0f, 5000);
+    float north = predictor.getVelocityNorth();
+
+    // La geocerca reevalúa la última posición cada GEOFENCE_CHECK_INTERVAL
+    feed(predictor, 0.0f, -25.0f, 5000);
+    TEST_ASSERT_EQUAL_FLOAT(north, predictor.getVelocityNorth());
+
+    // Salto de 200 m por multitrayecto: se descarta y la siguiente se mide
+    // contra la última buena
+    feed(predictor, 0.0f, 175.0f, 10000);
+    TEST_ASSERT_EQUAL_UINT32(1, predictor.getRejected());
+    TEST_ASSERT_EQUAL_FLOAT(north, predictor.getVelocityNorth());
+    feed(predictor, 0.0f, -15.0f, 15000);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, predictor.getVelocityNorth());
+
+    // Sin posiciones más de APPROACH_MAX_GAP_MS: empieza de nuevo
+    feed(predictor, 0.0f, -40.0f, 15000 + APPROACH_MAX_GAP_MS + FIX_MS);
+    TEST_ASSERT_FALSE(predictor.hasVelocity());
+    feed(predictor, 5.0f, -40.0f, 15000 + APPROACH_MAX_GAP_MS + 2 * FIX_MS);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, predictor.getVelocityEast());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, predictor.getVelocityNorth());
+
+    predictor.reset();
+    TEST_ASSERT_FALSE(predictor.hasVelocity());
+    TEST_ASSERT_EQUAL_UINT32(0, predictor.getRejected());
+}
+
+void test_filter_releases_when_approach_stops(void) {
+    // CAUTION anticipada; se detiene a 30 m y la alerta se libera con la
+    // permanencia de bajada
+    AlertFilter filter(AlertFilter::Config(CAUTION_M, WARNING_M));
+    filter.update(-40.0f, 0, 20.0f);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::SAFE, (uint8_t)filter.getLevel());
+    filter.update(-35.0f, ALERT_ESCALATE_DWELL_MS, 20.0f);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::CAUTION, (uint8_t)filter.getLevel());
+    TEST_ASSERT_EQUAL_UINT32(2, filter.getStats().anticipated);
+
+    uint32_t stop = 2 * ALERT_ESCALATE_DWELL_MS;
+    filter.update(-30.0f, stop, ApproachPredictor::NOT_APPROACHING);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::CAUTION, (uint8_t)filter.getLevel());
+    filter.update(-30.0f, stop + ALERT_RELEASE_DWELL_MS, ApproachPredictor::NOT_APPROACHING);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::SAFE, (uint8_t)filter.getLevel());
+
+    // Más allá del horizonte no anticipa
+    filter.reset();
+    filter.update(-40.0f, 0, APPROACH_HORIZON_S + 1.0f);
+    filter.update(-40.0f, ALERT_ESCALATE_DWELL_MS, APPROACH_HORIZON_S + 1.0f);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::SAFE, (uint8_t)filter.getLevel());
+}
+
+static volatile float sink;
+
+void test_cost_per_fix(void) {
+    // Lo que suma a cada evaluación de la geocerca: update + timeToCrossing
+    const int fixes = 200000;
+    ApproachPredictor predictor;
+    seed = 1;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < fixes; i++) {
+        feed(predictor, noise(2.0f), -30.0f + noise(2.0f), (uint32_t)i * FIX_MS);
+        sink += predictor.timeToCrossing(-30.0f, 0.0f, 1.0f);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    printf("\n  [info] %.0f ns por posición en el host\n", ns / fixes);
+    TEST_ASSERT_TRUE(predictor.hasVelocity());
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_head_on_run_alerts_early);
+    RUN_TEST(test_parallel_walk_not_anticipated);
+    RUN_TEST(test_slow_grazing_approach_not_anticipated);
+    RUN_TEST(test_standing_still_noise_not_anticipated);
+    RUN_TEST(test_time_to_crossing);
+    RUN_TEST(test_reevaluation_jump_and_gap);
+    RUN_TEST(test_filter_releases_when_approach_stops);
+    RUN_TEST(test_cost_per_fix);
+    return UNITY_END();
+}
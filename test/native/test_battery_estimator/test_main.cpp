@@ -0,0 +1,222 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - BATTERY ESTIMATOR (ESTADO DE CARGA Y AUTONOMÍA)
+ * ============================================================================
+ * Descarga simulada de una celda de BATTERY_CAPACITY_MAH con el collar en
+ * operación: GPS y CPU siempre, un uplink por LORA_TX_INTERVAL (caída de
+ * voltaje durante el TX por la resistencia interna) y ruido del ADC. El
+ * modelo de energía subestima el consumo real en un 15 %. Se compara el
+ * porcentaje de antes (curva por tramos sobre el promedio de 10 muestras)
+ * y el del estimador con el real, y la autonomía prevista con la que
+ * quedaba de verdad. Además, la curva en reposo y el cargador conectado.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include "config/constants.h"
+#include "system/BatteryEstimator.h"
+
+static const uint32_t STEP_MS = BATTERY_CHECK_INTERVAL;
+static const float BASE_MA = 33.0f;          // GPS, CPU en light sleep, placa
+static const float TX_MA = 118.0f;           // SX1262 a +20 dBm
+static const float TX_SECONDS = 0.25f;       // Airtime de un uplink (SF9)
+static const float RESISTANCE_OHM = 0.25f;   // Celda + conectores
+static const float MODEL_SHARE = 0.85f;      // El modelo cuenta el 85 % del consumo real
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Ruido del ADC reproducible, uniforme en ±amplitude voltios
+static uint32_t seed = 1;
+static float noise(float amplitude) {
+    seed = seed * 1103515245u + 12345u;
+    return amplitude * (((seed >> 8) & 0xFFFF) / 32767.5f - 1.0f);
+}
+
+// Voltaje en reposo de la celda para un estado de carga (inversa de la curva)
+static float restVoltage(float soc) {
+    float low = 3.0f, high = 4.3f;
+    for (int i = 0; i < 30; i++) {
+        float middle = (low + high) / 2.0f;
+        if (BatteryEstimator::socFromRestVoltage(middle) < soc) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return (low + high) / 2.0f;
+}
+
+// PowerManager::calculateBatteryPercentage anterior
+static float legacyPercentage(float voltage) {
+    if (voltage <= 3.2f)
+        return 0;
+    if (voltage >= 4.0f)
+        return 100;
+    if (voltage >= 3.7f)
+        return 50 + ((voltage - 3.7f) / 0.3f) * 50;
+    return ((voltage - 3.2f) / 0.5f) * 50;
+}
+
+// ============================================================================
+// DESCARGA SIMULADA
+// ============================================================================
+
+struct Discharge {
+    float worstLegacy;    // Peor error del porcentaje anterior (puntos)
+    float worstEstimate;  // Peor error del estimador
+    float runtimeError;   // Error relativo de la autonomía prevista al 50 %
+    uint32_t restReadings;
+};
+
+static Discharge discharge(float startSoc, float hours) {
+    BatteryEstimator estimator;
+    Discharge result = {0.0f, 0.0f, NAN, 0};
+    float samples[10];
+    seed = 1;
+
+    float soc = startSoc;
+    for (int i = 0; i < 10; i++) {
+        samples[i] = restVoltage(soc) - BASE_MA / 1000.0f * RESISTANCE_OHM;
+    }
+    estimator.addRestVoltage(restVoltage(soc) + noise(0.01f));
+
+    uint32_t steps = (uint32_t)(hours * 3600000.0f / STEP_MS);
+    for (uint32_t step = 1; step <= steps; step++) {
+        // Un minuto de consumo real y lo que el modelo cuenta de él
+        float mAh = (BASE_MA * STEP_MS / 1000.0f + TX_MA * TX_SECONDS) / 3600.0f;
+        soc -= mAh * 100.0f / BATTERY_CAPACITY_MAH;
+        estimator.addConsumption(mAh * MODEL_SHARE, STEP_MS);
+
+        // Promedio móvil de 10 lecturas: una de cada diez cae en un TX
+        float loadMa = (step % 10 == 0) ? BASE_MA + TX_MA : BASE_MA;
+        samples[step % 10] = restVoltage(soc) - loadMa / 1000.0f * RESISTANCE_OHM + noise(0.01f);
+        float average = 0.0f;
+        for (int i = 0; i < 10; i++) {
+            average += samples[i] / 10.0f;
+        }
+
+        // La radio está callada la mayor parte de las lecturas
+        if (step % 10 != 0) {
+            estimator.addRestVoltage(restVoltage(soc) - BASE_MA / 1000.0f * RESISTANCE_OHM + noise(0.01f));
+        }
+
+        result.worstLegacy = fmaxf(result.worstLegacy, fabsf(legacyPercentage(average) - soc));
+        result.worstEstimate = fmaxf(result.worstEstimate, fabsf(estimator.getSoc() - soc));
+
+        if (isnan(result.runtimeError) && soc <= 50.0f) {
+            float realHours = soc / 100.0f * BATTERY_CAPACITY_MAH / (mAh * 3600000.0f / STEP_MS);
+            result.runtimeError = (estimator.getRemainingHours() - realHours) / realHours;
+        }
+    }
+    result.restReadings = estimator.getStats().restReadings;
+    return result;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_rest_curve(void) {
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, BatteryEstimator::socFromRestVoltage(3.0f));
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, BatteryEstimator::socFromRestVoltage(4.2f));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, BatteryEstimator::socFromRestVoltage(3.80f));
+
+    // Creciente y continua
+    float previous = -1.0f;
+    for (float volts = 3.2f; volts <= 4.2f; volts += 0.005f) {
+        float soc = BatteryEstimator::socFromRestVoltage(volts);
+        TEST_ASSERT_TRUE(soc >= previous);
+        TEST_ASSERT_TRUE(previous < 0.0f || soc - previous < 2.0f);
+        previous = soc;
+    }
+
+    // En la zona plana un voltio vale muchos más puntos que cerca de vacía
+    TEST_ASSERT_TRUE(BatteryEstimator::restCurveSlope(3.75f) > 5.0f * BatteryEstimator::restCurveSlope(3.45f));
+}
+
+void test_discharge_tracks_real_charge(void) {
+    // Desde 90 % durante 36 horas
+    Discharge result = discharge(90.0f, 36.0f);
+    printf("  [info] peor error: antes %.1f puntos, estimador %.1f puntos | autonomía al 50 %%: %+.0f %%\n",
+           result.worstLegacy, result.worstEstimate, result.runtimeError * 100.0f);
+
+    TEST_ASSERT_TRUE(result.restReadings > 1000);
+    TEST_ASSERT_TRUE(result.worstLegacy > 10.0f);
+    TEST_ASSERT_TRUE(result.worstEstimate < 5.0f);
+    TEST_ASSERT_FALSE(isnan(result.runtimeError));
+    TEST_ASSERT_TRUE(fabsf(result.runtimeError) < 0.25f);
+}
+
+void test_coulomb_count_between_rest_readings(void) {
+    BatteryEstimator estimator;
+    TEST_ASSERT_FALSE(estimator.isReady());
+    TEST_ASSERT_EQUAL_UINT32(BatteryEstimator::RUNTIME_UNKNOWN, estimator.getRemainingHours());
+
+    estimator.addRestVoltage(3.80f);
+    TEST_ASSERT_TRUE(estimator.isReady());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, estimator.getSoc());
+    float startDeviation = estimator.getUncertainty();
+
+    // 10 % de la capacidad en 10 horas, sin lecturas en reposo
+    for (int i = 0; i < 10; i++) {
+        estimator.addConsumption(BATTERY_CAPACITY_MAH / 100.0f, 3600000);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 40.0f, estimator.getSoc());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, startDeviation + BATTERY_MODEL_ERROR * 10.0f, estimator.getUncertainty());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, BATTERY_CAPACITY_MAH / 100.0f, estimator.getAverageCurrentMa());
+    TEST_ASSERT_EQUAL_UINT32(40, estimator.getRemainingHours());
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, BATTERY_CAPACITY_MAH / 10.0f, estimator.getStats().consumedMah);
+}
+
+void test_flat_region_trusts_count(void) {
+    // Con el conteo reciente, una lectura en la zona plana mueve poco;
+    // cerca de vacía la curva es precisa y manda
+    BatteryEstimator flat;
+    flat.addRestVoltage(3.80f);
+    flat.addRestVoltage(3.79f);
+    float flatCorrection = fabsf(flat.getStats().lastCorrection);
+
+    BatteryEstimator steep;
+    steep.addRestVoltage(3.50f);
+    steep.addConsumption(BATTERY_CAPACITY_MAH / 50.0f, 3600000);
+    float counted = steep.getSoc();
+    steep.addRestVoltage(3.48f);
+
+    float measured = BatteryEstimator::socFromRestVoltage(3.48f);
+    TEST_ASSERT_TRUE(flatCorrection < 0.5f * fabsf(BatteryEstimator::socFromRestVoltage(3.79f) - 50.0f));
+    TEST_ASSERT_TRUE(fabsf(steep.getSoc() - measured) < fabsf(counted - measured));
+}
+
+void test_charger_reanchors(void) {
+    BatteryEstimator estimator;
+    estimator.addRestVoltage(3.70f);
+    float before = estimator.getSoc();
+
+    // Cargado fuera de la vista del conteo: la curva dice 95 %
+    estimator.addRestVoltage(4.09f);
+    TEST_ASSERT_EQUAL_UINT32(1, estimator.getStats().reanchors);
+    TEST_ASSERT_TRUE(before < 30.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, BatteryEstimator::socFromRestVoltage(4.09f), estimator.getSoc());
+
+    estimator.reset();
+    TEST_ASSERT_FALSE(estimator.isReady());
+    TEST_ASSERT_EQUAL_UINT32(0, estimator.getStats().restReadings);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_rest_curve);
+    RUN_TEST(test_discharge_tracks_real_charge);
+    RUN_TEST(test_coulomb_count_between_rest_readings);
+    RUN_TEST(test_flat_region_trusts_count);
+    RUN_TEST(test_charger_reanchors);
+    return UNITY_END();
+}
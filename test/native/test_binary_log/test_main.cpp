@@ -0,0 +1,204 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - BINARY LOG
+ * ============================================================================
+ * Id del formato calculado en compilación (el mismo que usa
+ * scripts/log_decoder.py), estructura de la trama, enteros en varint con
+ * zigzag, textos cortados sin pasarse de MAX_FRAME y costo de armar una
+ * trama frente a formatear el texto.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "system/BinaryLog.h"
+
+// El id tiene que poder calcularse en compilación: el formato no llega al firmware
+static_assert(BinaryLog::formatId("") == 0x811C9DC5u, "FNV-1a de 32 bits");
+static_assert(std::integral_constant<uint32_t, BinaryLog::formatId("📍 GPS: %.6f, %.6f")>::value == 0x59DC908Eu,
+              "Mismo id que log_decoder.py");
+
+// ============================================================================
+// LECTURA DE TRAMAS
+// ============================================================================
+
+struct Reader {
+    const uint8_t *frame;
+    size_t index;
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (uint8_t shift = 0;; shift += 7) {
+            uint8_t byte = frame[index++];
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+    }
+
+    int64_t zigzag() {
+        uint64_t value = varint();
+        return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+    }
+};
+
+static uint8_t checksum(const uint8_t *frame, size_t length) {
+    uint8_t value = 0;
+    for (size_t i = BinaryLog::HEADER_SIZE; i < length - 1; i++) {
+        value ^= frame[i];
+    }
+    return value;
+}
+
+static volatile uint32_t sink = 0;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_frame_layout(void) {
+    uint8_t frame[BinaryLog::MAX_FRAME];
+    const uint32_t id = BinaryLog::formatId("%s Batería: %.2fV (%d%%)");
+    size_t length = BinaryLog::encode(frame, sizeof(frame), 3, 300, id, "🔋", 3.87f, 76);
+
+    TEST_ASSERT_EQUAL_HEX8(BinaryLog::SYNC, frame[0]);
+    TEST_ASSERT_EQUAL(length - BinaryLog::HEADER_SIZE - 1, frame[1]);
+    TEST_ASSERT_EQUAL_HEX8(checksum(frame, length), frame[length - 1]);
+
+    uint32_t readId = frame[2] | (frame[3] << 8) | (frame[4] << 16) | ((uint32_t)frame[5] << 24);
+    TEST_ASSERT_EQUAL_HEX32(id, readId);
+    TEST_ASSERT_EQUAL(3, frame[6]);
+
+    Reader reader = {frame, 7};
+    TEST_ASSERT_EQUAL_UINT32(300, reader.varint());
+
+    TEST_ASSERT_EQUAL(BinaryLog::TAG_STRING, frame[reader.index++]);
+    uint8_t textLength = frame[reader.index++];
+    TEST_ASSERT_EQUAL(strlen("🔋"), textLength);
+    TEST_ASSERT_EQUAL(0, memcmp(&frame[reader.index], "🔋", textLength));
+    reader.index += textLength;
+
+    TEST_ASSERT_EQUAL(BinaryLog::TAG_FLOAT, frame[reader.index++]);
+    float voltage;
+    memcpy(&voltage, &frame[reader.index], sizeof(voltage));
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 3.87f, voltage);
+    reader.index += sizeof(voltage);
+
+    TEST_ASSERT_EQUAL(BinaryLog::TAG_INT, frame[reader.index++]);
+    TEST_ASSERT_EQUAL_INT32(76, (int32_t)reader.zigzag());
+    TEST_ASSERT_EQUAL(length - 1, reader.index);
+}
+
+void test_integer_encoding(void) {
+    uint8_t frame[BinaryLog::MAX_FRAME];
+    size_t length = BinaryLog::encode(frame, sizeof(frame), 4, 0xFFFFFFFFu, 1,
+                                      -1, (int16_t)-300, 9876543210ULL, (uint8_t)200, true, (void *)0x1234);
+
+    Reader reader = {frame, 7};
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFu, reader.varint()); // millis() en 5 bytes
+
+    TEST_ASSERT_EQUAL(BinaryLog::TAG_INT, frame[reader.index]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, frame[reader.index + 1]); // -1 ocupa un byte
+    reader.index++;
+    TEST_ASSERT_EQUAL_INT32(-1, (int32_t)reader.zigzag());
+
+    reader.index++;
+    TEST_ASSERT_EQUAL_INT32(-300, (int32_t)reader.zigzag());
+
+    TEST_ASSERT_EQUAL(BinaryLog::TAG_UINT, frame[reader.index++]);
+    TEST_ASSERT_TRUE(reader.varint() == 9876543210ULL); // Unity sin 64 bits
+
+    TEST_ASSERT_EQUAL(BinaryLog::TAG_UINT, frame[reader.index++]);
+    TEST_ASSERT_EQUAL_UINT32(200, (uint32_t)reader.varint());
+
+    TEST_ASSERT_EQUAL(BinaryLog::TAG_UINT, frame[reader.index++]);
+    TEST_ASSERT_EQUAL_UINT32(1, (uint32_t)reader.varint());
+
+    TEST_ASSERT_EQUAL(BinaryLog::TAG_POINTER, frame[reader.index++]);
+    TEST_ASSERT_EQUAL_UINT32(0x1234, (uint32_t)reader.varint());
+    TEST_ASSERT_EQUAL(length - 1, reader.index);
+    TEST_ASSERT_EQUAL(4, frame[6]); // Sin TRUNCATED
+}
+
+void test_long_text_truncated(void) {
+    char text[200];
+    memset(text, 'g', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+
+    uint8_t frame[BinaryLog::MAX_FRAME + 8];
+    memset(frame, 0xAA, sizeof(frame));
+    size_t length = BinaryLog::encode(frame, BinaryLog::MAX_FRAME, 2, 10, 7, text, 42);
+
+    // Llena la trama justo hasta el checksum y omite el entero que sigue
+    TEST_ASSERT_EQUAL(BinaryLog::MAX_FRAME, length);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, frame[BinaryLog::MAX_FRAME]);
+    TEST_ASSERT_EQUAL(2 | BinaryLog::TRUNCATED, frame[6]);
+    TEST_ASSERT_EQUAL(BinaryLog::TAG_STRING, frame[8]);
+    TEST_ASSERT_EQUAL(length - 1 - 10, frame[9]);
+    TEST_ASSERT_EQUAL_HEX8(checksum(frame, length), frame[length - 1]);
+
+    // Sin lugar ni para el encabezado no se escribe nada
+    TEST_ASSERT_EQUAL(0, BinaryLog::encode(frame, 8, 2, 10, 7, 1));
+}
+
+void test_null_string(void) {
+    uint8_t frame[BinaryLog::MAX_FRAME];
+    const char *missing = nullptr;
+    size_t length = BinaryLog::encode(frame, sizeof(frame), 3, 0, 1, missing);
+    TEST_ASSERT_EQUAL(BinaryLog::TAG_STRING, frame[8]);
+    TEST_ASSERT_EQUAL(6, frame[9]);
+    TEST_ASSERT_EQUAL(0, memcmp(&frame[10], "(null)", 6));
+    TEST_ASSERT_EQUAL(17, length);
+}
+
+void test_cost_binary_vs_text(void) {
+    // Lo mismo que LOG_GPS: id + dos double contra el texto formateado
+    const int calls = 200000;
+    uint8_t frame[BinaryLog::MAX_FRAME];
+    char text[256];
+    size_t frameLength = 0;
+    int textLength = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) {
+        frameLength = BinaryLog::encode(frame, sizeof(frame), 3, i, 0x59DC908Eu, -33.448890, -70.669265);
+        sink += frame[frameLength - 1];
+    }
+    double binaryNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) {
+        textLength = snprintf(text, sizeof(text), "[%02lu:%02lu:%02lu] %s [%s] 📍 GPS: %.6f, %.6f\n",
+                              0UL, 0UL, (unsigned long)(i % 60), "ℹ️", "INFO", -33.448890, -70.669265);
+        sink += text[textLength - 1];
+    }
+    double textNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // A 115200 baudios cada byte ocupa 86.8 µs del UART
+    printf("\nBinario: %zu bytes, %.0f ns | texto: %d bytes, %.0f ns | UART %.1f ms → %.1f ms por línea\n",
+           frameLength, binaryNs / calls, textLength, textNs / calls,
+           textLength * 0.0868, frameLength * 0.0868);
+    TEST_ASSERT_TRUE(frameLength < (size_t)textLength);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_frame_layout);
+    RUN_TEST(test_integer_encoding);
+    RUN_TEST(test_long_text_truncated);
+    RUN_TEST(test_null_string);
+    RUN_TEST(test_cost_binary_vs_text);
+    return UNITY_END();
+}
@@ -0,0 +1,196 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - BOOT PROFILER
+ * ============================================================================
+ * Etapas consecutivas que suman el total, descarte sin espacio, formato
+ * del resumen y desborde de micros(). Incluye la comparación del arranque
+ * completo con el rápido usando las esperas fijas que tiene setup().
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "system/BootProfiler.h"
+
+// ============================================================================
+// RELOJ SIMULADO
+// ============================================================================
+
+static uint32_t simNowUs = 0;
+
+static uint32_t simClock() {
+    return simNowUs;
+}
+
+static void advanceMs(uint32_t ms) {
+    simNowUs += ms * 1000;
+}
+
+void setUp(void) {
+    simNowUs = 0;
+}
+
+void tearDown(void) {}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_stages_sum_to_total(void) {
+    BootProfiler profiler(simClock);
+    simNowUs = 250000; // Antes de setup()
+    profiler.begin(false);
+
+    advanceMs(10);
+    profiler.mark("logger");
+    advanceMs(600);
+    profiler.mark("hardware");
+    simNowUs += 1500;
+    profiler.mark("managers");
+
+    TEST_ASSERT_EQUAL(3, profiler.getStageCount());
+    TEST_ASSERT_EQUAL_UINT32(250000, profiler.startUs());
+    TEST_ASSERT_EQUAL_STRING("hardware", profiler.getStage(1).name);
+    TEST_ASSERT_EQUAL_UINT32(10000, profiler.getStage(1).startUs);
+    TEST_ASSERT_EQUAL_UINT32(600000, profiler.getStage(1).durationUs);
+    TEST_ASSERT_EQUAL_UINT32(1500, profiler.getStage(2).durationUs);
+
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < profiler.getStageCount(); i++) {
+        sum += profiler.getStage(i).durationUs;
+    }
+    TEST_ASSERT_EQUAL_UINT32(profiler.totalUs(), sum);
+    TEST_ASSERT_EQUAL(1, profiler.slowestStage());
+    TEST_ASSERT_FALSE(profiler.isFastBoot());
+}
+
+void test_begin_restarts_measurement(void) {
+    BootProfiler profiler(simClock);
+    TEST_ASSERT_EQUAL(-1, profiler.slowestStage());
+
+    profiler.begin(false);
+    advanceMs(5);
+    profiler.mark("a");
+
+    advanceMs(100);
+    profiler.begin(true);
+    TEST_ASSERT_EQUAL(0, profiler.getStageCount());
+    TEST_ASSERT_EQUAL_UINT32(0, profiler.totalUs());
+    TEST_ASSERT_TRUE(profiler.isFastBoot());
+}
+
+void test_full_profiler_drops_stages(void) {
+    BootProfiler profiler(simClock);
+    profiler.begin(false);
+
+    for (uint8_t i = 0; i < BootProfiler::MAX_STAGES + 3; i++) {
+        advanceMs(1);
+        profiler.mark("etapa");
+    }
+
+    TEST_ASSERT_EQUAL(BootProfiler::MAX_STAGES, profiler.getStageCount());
+    TEST_ASSERT_EQUAL(3, profiler.getDroppedStages());
+
+    // El total incluye también lo que no entró como etapa
+    TEST_ASSERT_EQUAL_UINT32((BootProfiler::MAX_STAGES + 3) * 1000, profiler.totalUs());
+}
+
+void test_format_summary(void) {
+    BootProfiler profiler(simClock);
+    profiler.begin(true);
+    advanceMs(2);
+    profiler.mark("logger");
+    simNowUs += 300;
+    profiler.mark("hardware");
+
+    char line[96];
+    size_t length = profiler.format(line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("logger 2.0 | hardware 0.3 = 2.3 ms", line);
+    TEST_ASSERT_EQUAL(strlen(line), length);
+
+    // Buffer corto: trunca sin desbordar
+    char small[12];
+    memset(small, 'x', sizeof(small));
+    length = profiler.format(small, sizeof(small));
+    TEST_ASSERT_EQUAL(sizeof(small) - 1, length);
+    TEST_ASSERT_EQUAL('\0', small[sizeof(small) - 1]);
+    TEST_ASSERT_EQUAL(0, profiler.format(nullptr, 10));
+}
+
+void test_clock_wraparound(void) {
+    BootProfiler profiler(simClock);
+    simNowUs = 0xFFFFFFFF - 499; // micros() desborda cada ~71 minutos
+    profiler.begin(false);
+    advanceMs(1);
+    profiler.mark("wrap");
+
+    TEST_ASSERT_EQUAL_UINT32(1000, profiler.getStage(0).durationUs);
+    TEST_ASSERT_EQUAL_UINT32(1000, profiler.totalUs());
+}
+
+// Esperas fijas de setup() en cada camino (ms). El resto del trabajo real
+// (SPI, UART, NVS) se modela igual en ambos
+static uint32_t simulateBoot(BootProfiler &profiler, bool fastBoot) {
+    profiler.begin(fastBoot);
+
+    advanceMs(fastBoot ? 1 : 20); // Banner e información del sistema
+    profiler.mark("logger");
+
+    advanceMs(fastBoot ? 1 : 1 + 500 + 100); // VEXT e I2C
+    profiler.mark("hardware");
+
+    if (!fastBoot) {
+        advanceMs(50);                         // Beep de confirmación del buzzer
+        advanceMs(100 + 1000 + 5 * 600 + 800); // Reset del OLED y animación de carga
+        advanceMs(100 + 3000);                 // Sondeo del GPS sin datos
+    }
+    advanceMs(40); // Radio, NVS y sesión LoRaWAN
+    profiler.mark("managers");
+
+    if (!fastBoot) {
+        advanceMs(200 + 200 + 200 + 400); // Melodía de inicio
+        profiler.mark("melody");
+    }
+
+    advanceMs(2);
+    profiler.mark("scheduler");
+    advanceMs(1);
+    profiler.mark("runtime");
+    return profiler.totalUs();
+}
+
+void test_fast_boot_vs_full_boot(void) {
+    BootProfiler full(simClock);
+    BootProfiler fast(simClock);
+
+    uint32_t fullUs = simulateBoot(full, false);
+    uint32_t fastUs = simulateBoot(fast, true);
+
+    char line[160];
+    full.format(line, sizeof(line));
+    printf("\nCompleto: %s\n", line);
+    fast.format(line, sizeof(line));
+    printf("Rápido:   %s\n", line);
+
+    TEST_ASSERT_EQUAL_STRING("managers", full.getStage(full.slowestStage()).name);
+    TEST_ASSERT_EQUAL(full.getStageCount() - 1, fast.getStageCount());
+    TEST_ASSERT_LESS_THAN_UINT32(100000, fastUs);
+    TEST_ASSERT_GREATER_THAN_UINT32(100 * fastUs, fullUs);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_stages_sum_to_total);
+    RUN_TEST(test_begin_restarts_measurement);
+    RUN_TEST(test_full_profiler_drops_stages);
+    RUN_TEST(test_format_summary);
+    RUN_TEST(test_clock_wraparound);
+    RUN_TEST(test_fast_boot_vs_full_boot);
+    return UNITY_END();
+}
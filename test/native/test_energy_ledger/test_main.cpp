@@ -0,0 +1,200 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - ENERGY LEDGER (CONSUMO MEDIDO POR SUBSISTEMA)
+ * ============================================================================
+ * Un día simulado del collar con los intervalos de constants.h: GPS siempre
+ * encendido, un uplink por LORA_TX_INTERVAL, ráfagas de CPU y la OLED unos
+ * minutos. El total tiene que coincidir con lo que EnergyModel estima para
+ * el mismo perfil (sin buzzer, que el modelo no tiene). Además, intervalos solapados de
+ * varias tareas, el cierre del día con intervalos abiertos y el uplink.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <thread>
+#include "config/constants.h"
+#include "system/EnergyLedger.h"
+
+static const uint32_t HOUR_MS = 3600000UL;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_overlapping_intervals_count_once(void) {
+    EnergyLedger ledger;
+    ledger.start(1000);
+
+    // Dos tareas despiertan la CPU: 1000-1500 y 1200-1800 -> 800 ms
+    ledger.begin(EnergyLedger::CPU_AWAKE, 1000);
+    ledger.begin(EnergyLedger::CPU_AWAKE, 1200);
+    ledger.end(EnergyLedger::CPU_AWAKE, 1500);
+    ledger.end(EnergyLedger::CPU_AWAKE, 1800);
+    ledger.end(EnergyLedger::CPU_AWAKE, 1900); // Sin begin: se ignora
+
+    // Abierto: cuenta hasta el momento del reporte
+    ledger.begin(EnergyLedger::GPS, 1000);
+    ledger.add(EnergyLedger::RADIO_TX, 250, 1500);
+    ledger.add(EnergyLedger::CPU_SLEEP, 5000, 1500); // Derivado: se ignora
+
+    EnergyLedger::Report report = ledger.today(3000);
+    TEST_ASSERT_EQUAL_UINT32(2000, report.periodMs);
+    TEST_ASSERT_EQUAL_UINT32(800, report.activeMs[EnergyLedger::CPU_AWAKE]);
+    TEST_ASSERT_EQUAL_UINT32(1200, report.activeMs[EnergyLedger::CPU_SLEEP]);
+    TEST_ASSERT_EQUAL_UINT32(2000, report.activeMs[EnergyLedger::GPS]);
+    TEST_ASSERT_EQUAL_UINT32(250, report.activeMs[EnergyLedger::RADIO_TX]);
+    TEST_ASSERT_EQUAL_UINT32(2000, report.activeMs[EnergyLedger::BOARD]);
+}
+
+void test_day_matches_energy_model(void) {
+    EnergyLedger ledger;
+    EnergyModel model(ledger.getConfig().currents);
+    ledger.start(0);
+    ledger.begin(EnergyLedger::GPS, 0);
+
+    // Un uplink por minuto: 10 ms de CPU, 60 ms de TX y 2 s de ventanas RX
+    for (uint32_t t = 0; t < EnergyLedger::DAY_MS; t += LORA_TX_INTERVAL) {
+        ledger.begin(EnergyLedger::CPU_AWAKE, t);
+        ledger.add(EnergyLedger::RADIO_TX, 60, t + 60);
+        ledger.add(EnergyLedger::RADIO_RX, 2000, t + 2060);
+        ledger.end(EnergyLedger::CPU_AWAKE, t + 10);
+    }
+    // La OLED 5 minutos tres veces
+    for (uint32_t t = HOUR_MS; t < 4 * HOUR_MS; t += HOUR_MS) {
+        ledger.add(EnergyLedger::DISPLAY, 300000, t);
+    }
+
+    EnergyLedger::Report report = ledger.today(EnergyLedger::DAY_MS - 1);
+    uint32_t minutes = EnergyLedger::DAY_MS / LORA_TX_INTERVAL;
+
+    EnergyModel::Profile profile;
+    profile.cpuMhz = LOW_POWER_CPU_MHZ;
+    profile.lightSleep = true;
+    profile.cpuActiveSeconds = minutes * 0.01f;
+    profile.radioTxSeconds = minutes * 0.06f;
+    profile.radioRxSeconds = minutes * 2.0f;
+    profile.displayOnSeconds = 900.0f;
+    EnergyModel::Breakdown expected = model.estimate(profile);
+
+    printf("  [info] mAh/día:");
+    for (uint8_t i = 0; i < EnergyLedger::CHANNELS; i++) {
+        printf(" %s %.2f", EnergyLedger::getName(i), report.perDay(i));
+    }
+    printf(" | total %.1f (modelo %.1f)\n", report.totalPerDay(), expected.total);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, expected.gps, report.perDay(EnergyLedger::GPS));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, expected.radio,
+                             report.perDay(EnergyLedger::RADIO_TX) + report.perDay(EnergyLedger::RADIO_RX));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, expected.display, report.perDay(EnergyLedger::DISPLAY));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, expected.cpu,
+                             report.perDay(EnergyLedger::CPU_AWAKE) + report.perDay(EnergyLedger::CPU_SLEEP));
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, expected.total, report.totalPerDay());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, report.mAh[EnergyLedger::BUZZER]);
+
+    // El GPS es lo que más consume: lo que hay que mirar para apagar
+    for (uint8_t i = 0; i < EnergyLedger::CHANNELS; i++) {
+        TEST_ASSERT_TRUE(report.mAh[i] <= report.mAh[EnergyLedger::GPS]);
+    }
+}
+
+void test_day_rollover_splits_open_intervals(void) {
+    EnergyLedger ledger;
+    ledger.start(0);
+    TEST_ASSERT_FALSE(ledger.hasLastDay());
+
+    // El buzzer suena cruzando el fin del día: 1 s antes y 2 s después
+    ledger.begin(EnergyLedger::GPS, 0);
+    ledger.begin(EnergyLedger::BUZZER, EnergyLedger::DAY_MS - 1000);
+    ledger.end(EnergyLedger::BUZZER, EnergyLedger::DAY_MS + 2000);
+
+    TEST_ASSERT_TRUE(ledger.hasLastDay());
+    EnergyLedger::Report day = ledger.lastDay();
+    TEST_ASSERT_EQUAL_UINT32(EnergyLedger::DAY_MS, day.periodMs);
+    TEST_ASSERT_EQUAL_UINT32(1000, day.activeMs[EnergyLedger::BUZZER]);
+    TEST_ASSERT_EQUAL_UINT32(EnergyLedger::DAY_MS, day.activeMs[EnergyLedger::GPS]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 24.0f * EnergyModel::Currents().gps, day.mAh[EnergyLedger::GPS]);
+
+    EnergyLedger::Report today = ledger.today(EnergyLedger::DAY_MS + 4000);
+    TEST_ASSERT_EQUAL_UINT32(4000, today.periodMs);
+    TEST_ASSERT_EQUAL_UINT32(2000, today.activeMs[EnergyLedger::BUZZER]);
+    TEST_ASSERT_EQUAL_UINT32(4000, today.activeMs[EnergyLedger::GPS]);
+
+    // El total desde el arranque sigue sumando a través de los días
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, day.totalMah + today.totalMah, ledger.totalMah(EnergyLedger::DAY_MS + 4000));
+
+    // Con millis() dando la vuelta (49 días) sigue funcionando
+    EnergyLedger wrapped;
+    uint32_t boot = 0xFFFFFFFFUL - 1000;
+    wrapped.start(boot);
+    wrapped.begin(EnergyLedger::DISPLAY, boot);
+    wrapped.end(EnergyLedger::DISPLAY, boot + 3000);
+    TEST_ASSERT_EQUAL_UINT32(3000, wrapped.today(boot + 5000).activeMs[EnergyLedger::DISPLAY]);
+}
+
+void test_concurrent_tasks(void) {
+    EnergyLedger ledger;
+    ledger.start(0);
+
+    // Cuatro tareas abren y cierran la CPU a la vez: nada queda abierto
+    std::thread tasks[4];
+    for (int n = 0; n < 4; n++) {
+        tasks[n] = std::thread([&ledger]() {
+            for (int i = 0; i < 1000; i++) {
+                ledger.begin(EnergyLedger::CPU_AWAKE, 100);
+                ledger.add(EnergyLedger::RADIO_RX, 1, 100);
+                ledger.end(EnergyLedger::CPU_AWAKE, 100);
+            }
+        });
+    }
+    for (int n = 0; n < 4; n++) {
+        tasks[n].join();
+    }
+
+    EnergyLedger::Report report = ledger.today(10000);
+    TEST_ASSERT_EQUAL_UINT32(0, report.activeMs[EnergyLedger::CPU_AWAKE]);
+    TEST_ASSERT_EQUAL_UINT32(4000, report.activeMs[EnergyLedger::RADIO_RX]);
+}
+
+void test_summary_uplink(void) {
+    EnergyLedger ledger;
+    ledger.start(0);
+    ledger.begin(EnergyLedger::GPS, 0);
+
+    uint8_t small[EnergyLedger::SUMMARY_SIZE - 1];
+    TEST_ASSERT_EQUAL_UINT32(0, ledger.buildSummary(small, sizeof(small), HOUR_MS));
+
+    // Sin día completo: lo que va proyectado a 24 h
+    uint8_t buffer[32];
+    TEST_ASSERT_TRUE(EnergyLedger::SUMMARY_SIZE <= sizeof(buffer));
+    TEST_ASSERT_EQUAL_UINT32(EnergyLedger::SUMMARY_SIZE, ledger.buildSummary(buffer, sizeof(buffer), 6 * HOUR_MS));
+    TEST_ASSERT_EQUAL_HEX8(EnergyLedger::SUMMARY_TYPE, buffer[0]);
+    TEST_ASSERT_EQUAL_UINT8(6, buffer[1]);
+    uint16_t gps = buffer[2 + 2 * EnergyLedger::GPS] | (buffer[3 + 2 * EnergyLedger::GPS] << 8);
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)(24.0f * EnergyModel::Currents().gps * 10.0f), gps);
+
+    // Con un día completo se sube ese
+    ledger.end(EnergyLedger::GPS, 12 * HOUR_MS);
+    ledger.buildSummary(buffer, sizeof(buffer), EnergyLedger::DAY_MS + HOUR_MS);
+    TEST_ASSERT_EQUAL_UINT8(24, buffer[1]);
+    gps = buffer[2 + 2 * EnergyLedger::GPS] | (buffer[3 + 2 * EnergyLedger::GPS] << 8);
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)(12.0f * EnergyModel::Currents().gps * 10.0f), gps);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_overlapping_intervals_count_once);
+    RUN_TEST(test_day_matches_energy_model);
+    RUN_TEST(test_day_rollover_splits_open_intervals);
+    RUN_TEST(test_concurrent_tasks);
+    RUN_TEST(test_summary_uplink);
+    return UNITY_END();
+}
@@ -0,0 +1,256 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - MODELO DE ENERGÍA
+ * ============================================================================
+ * Airtime LoRa contra valores de referencia y consumo diario (mAh/día) del
+ * collar en tres configuraciones: CPU fija a 240 MHz sin dormir (anterior),
+ * DFS + light sleep automático, y light sleep con el GPS enviando solo
+ * GGA+RMC; y un día con la pantalla bajo demanda (DISPLAY_ON_DEMAND)
+ * simulando las pulsaciones del botón. Los tiempos salen de los intervalos
+ * de constants.h.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include "config/constants.h"
+#include "system/EnergyModel.h"
+
+#ifndef OLED_TIMEOUT_SLEEP
+#define OLED_TIMEOUT_SLEEP 300000 // Como en DisplayManager.h
+#endif
+
+static const float DAY = EnergyModel::SECONDS_PER_DAY;
+static const float BATTERY_MAH = 3000.0f;
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// ============================================================================
+// AIRTIME Y UART
+// ============================================================================
+
+void test_lora_airtime_reference(void) {
+    // Uplink LoRaWAN vacío (13 bytes de PHYPayload), CR 4/5, BW 125 kHz
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 46.3f, EnergyModel::loraAirtimeMs(7, 125, 13));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 1155.1f, EnergyModel::loraAirtimeMs(12, 125, 13));
+
+    // SF12 activa low data rate optimize (símbolo de 32,8 ms)
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 32.77f, EnergyModel::loraSymbolMs(12, 125));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 1810.4f, EnergyModel::loraAirtimeMs(12, 125, 33));
+
+    // Más payload nunca es más corto
+    TEST_ASSERT_TRUE(EnergyModel::loraAirtimeMs(10, 125, 33) >= EnergyModel::loraAirtimeMs(10, 125, 13));
+}
+
+void test_uart_busy_fraction(void) {
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.5f, EnergyModel::uartBusyFraction(480, 9600));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.0f, EnergyModel::uartBusyFraction(2000, 9600));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, EnergyModel::uartBusyFraction(100, 0));
+}
+
+// ============================================================================
+// ESTIMACIÓN
+// ============================================================================
+
+void test_only_board_and_sleep(void) {
+    EnergyModel model;
+    EnergyModel::Profile profile;
+    profile.lightSleep = true;
+    profile.gpsOnSeconds = 0;
+    profile.displayOnSeconds = 0;
+
+    EnergyModel::Breakdown result = model.estimate(profile);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 12.0f, result.board);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 6.0f, result.cpu);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, DAY, result.cpuSleepSeconds);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.12f, result.display); // SSD1306 en sleep
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, result.cpu + result.radio + result.display + result.board, result.total);
+}
+
+void test_time_is_conserved(void) {
+    EnergyModel model;
+    EnergyModel::Profile profile;
+    profile.lightSleep = true;
+    profile.cpuActiveSeconds = 2000;
+    profile.awakeIdleSeconds = 90000; // Más que el día: se recorta
+    profile.wakeups = 100000;
+
+    EnergyModel::Breakdown result = model.estimate(profile);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 2100.0f, result.cpuActiveSeconds);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, DAY, result.cpuActiveSeconds + result.cpuIdleSeconds + result.cpuSleepSeconds);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, result.cpuSleepSeconds);
+}
+
+void test_period_estimate(void) {
+    // Un minuto (conteo de carga de BatteryEstimator): GPS todo el minuto,
+    // 250 ms de TX y 2 s de RX
+    EnergyModel model;
+    EnergyModel::Profile profile;
+    profile.lightSleep = true;
+    profile.awakeIdleSeconds = 2.25f;
+    profile.radioTxSeconds = 0.25f;
+    profile.radioRxSeconds = 2.0f;
+    profile.gpsOnSeconds = 60.0f;
+    profile.displayOnSeconds = 0.0f;
+
+    EnergyModel::Breakdown minute = model.estimate(profile, 60.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 25.0f * 60.0f / 3600.0f, minute.gps);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.5f * 60.0f / 3600.0f, minute.board);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 60.0f, minute.cpuActiveSeconds + minute.cpuIdleSeconds + minute.cpuSleepSeconds);
+
+    // El día es el mismo cálculo con SECONDS_PER_DAY
+    EnergyModel::Profile day;
+    EnergyModel::Breakdown a = model.estimate(day);
+    EnergyModel::Breakdown b = model.estimate(day, DAY);
+    TEST_ASSERT_EQUAL_FLOAT(a.total, b.total);
+}
+
+// ============================================================================
+// CONFIGURACIONES DEL COLLAR
+// ============================================================================
+
+// Perfil común: uplinks, pantalla y trabajo de CPU según los intervalos
+static EnergyModel::Profile collarProfile(void) {
+    EnergyModel::Profile profile;
+
+    // Uplink de posición (20 bytes + 13 de LoRaWAN) a SF10 más el estado de enlace horario
+    float uplinks = DAY * 1000.0f / LORA_TX_INTERVAL + 24.0f;
+    profile.radioTxSeconds = uplinks * EnergyModel::loraAirtimeMs(10, 125, 33) / 1000.0f;
+    // RX1 y RX2 abiertas lo justo para detectar el preámbulo (8 símbolos)
+    profile.radioRxSeconds = uplinks * 2 * 8 * EnergyModel::loraSymbolMs(10, 125) / 1000.0f;
+
+    // Refresco completo del OLED por I2C (~25 ms) y demás tareas (~2 ms)
+    float displayUpdates = DAY * 1000.0f / DISPLAY_UPDATE_INTERVAL;
+    float otherJobs = DAY * 1000.0f / HEARTBEAT_INTERVAL + DAY * 1000.0f / GPS_UPDATE_INTERVAL +
+                      DAY * 1000.0f / BATTERY_CHECK_INTERVAL + DAY * 1000.0f / SERIAL_STATUS_INTERVAL;
+    profile.cpuActiveSeconds = displayUpdates * 0.025f + otherJobs * 0.002f + uplinks * 0.050f;
+    return profile;
+}
+
+// Light sleep: despierto durante cada ráfaga NMEA (más GPS_BURST_IDLE_MS) y
+// un despertar por ráfaga, por sondeo del GPS en silencio y por tarea
+static EnergyModel::Profile sleepProfile(uint32_t nmeaBytesPerSecond) {
+    EnergyModel::Profile profile = collarProfile();
+    profile.cpuMhz = LOW_POWER_CPU_MHZ;
+    profile.dynamicFrequency = true;
+    profile.lightSleep = true;
+
+    float busy = EnergyModel::uartBusyFraction(nmeaBytesPerSecond, GPS_BAUD_RATE) + GPS_BURST_IDLE_MS / 1000.0f;
+    profile.awakeIdleSeconds = DAY * busy;
+
+    float bursts = DAY;
+    float gpsPolls = DAY * (1.0f - busy) * 1000.0f / GPS_POLL_INTERVAL;
+    float jobs = DAY * 1000.0f / DISPLAY_UPDATE_INTERVAL + DAY * 1000.0f / HEARTBEAT_INTERVAL +
+                 DAY * 1000.0f / GPS_UPDATE_INTERVAL;
+    profile.wakeups = (uint32_t)(bursts + gpsPolls + jobs);
+    return profile;
+}
+
+static void printBreakdown(const char *name, const EnergyModel::Breakdown &result) {
+    printf("%-28s CPU %6.1f | GPS %5.1f | radio %5.1f | display %5.1f | placa %4.1f | total %6.1f mAh/día"
+           " | %4.1f días con %.0f mAh\n",
+           name, result.cpu, result.gps, result.radio, result.display, result.board, result.total,
+           EnergyModel::runtimeDays(result, BATTERY_MAH), BATTERY_MAH);
+}
+
+void test_light_sleep_vs_legacy(void) {
+    EnergyModel model;
+
+    EnergyModel::Profile legacy = collarProfile();
+    EnergyModel::Breakdown legacyResult = model.estimate(legacy);
+
+    // NMEA por defecto (~GGA, GSA, 3xGSV, RMC, VTG ≈ 450 B/s) y solo GGA+RMC (≈ 150 B/s)
+    EnergyModel::Breakdown sleepResult = model.estimate(sleepProfile(450));
+    EnergyModel::Breakdown reducedResult = model.estimate(sleepProfile(150));
+
+    printBreakdown("240 MHz sin dormir", legacyResult);
+    printBreakdown("DFS + light sleep", sleepResult);
+    printBreakdown("light sleep, NMEA reducido", reducedResult);
+    printf("CPU dormida: %.1f%% / %.1f%% del día\n",
+           100.0f * sleepResult.cpuSleepSeconds / DAY, 100.0f * reducedResult.cpuSleepSeconds / DAY);
+
+    // Lo que no depende de la CPU no cambia
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, legacyResult.radio, sleepResult.radio);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, legacyResult.display, sleepResult.display);
+
+    // Dormir entre ráfagas recorta la CPU a menos de un tercio; menos NMEA, aún más
+    TEST_ASSERT_TRUE(sleepResult.cpu < legacyResult.cpu / 3.0f);
+    TEST_ASSERT_TRUE(reducedResult.cpu < sleepResult.cpu);
+    TEST_ASSERT_TRUE(reducedResult.total < sleepResult.total);
+    TEST_ASSERT_TRUE(sleepResult.cpuSleepSeconds > DAY * 0.4f);
+}
+
+// Un día de pantalla bajo demanda, segundo a segundo: la tarea "display"
+// corre cada DISPLAY_UPDATE_INTERVAL solo mientras la OLED está encendida
+// y se apaga OLED_TIMEOUT_SLEEP después del arranque o la última pulsación
+void test_display_on_demand(void) {
+    // Arranque (t = 0) y tres revisiones del pastor con dos pulsaciones
+    // (encender y pasar a la pantalla de GPS)
+    const uint32_t presses[] = {7 * 3600, 7 * 3600 + 20, 12 * 3600, 12 * 3600 + 15, 18 * 3600, 18 * 3600 + 30};
+    const uint8_t pressCount = sizeof(presses) / sizeof(presses[0]);
+    const uint32_t timeout = OLED_TIMEOUT_SLEEP / 1000;
+    const uint32_t period = DISPLAY_UPDATE_INTERVAL / 1000;
+
+    uint32_t lastActivity = 0;
+    uint32_t nextFrame = 0;
+    uint32_t onSeconds = 0;
+    uint32_t frames = 0;
+    uint8_t next = 0;
+    bool on = true;
+    for (uint32_t t = 0; t < (uint32_t)DAY; t++) {
+        if (next < pressCount && presses[next] == t) {
+            lastActivity = t;
+            nextFrame = t; // La pulsación programa un cuadro inmediato
+            on = true;
+            next++;
+        }
+        if (on && t - lastActivity >= timeout) {
+            on = false; // La tarea se deshabilita
+        }
+        if (on && t == nextFrame) {
+            frames++;
+            nextFrame = t + period;
+        }
+        onSeconds += on ? 1 : 0;
+    }
+
+    EnergyModel model;
+    EnergyModel::Profile always = sleepProfile(150);
+    EnergyModel::Profile onDemand = always;
+    float skippedFrames = DAY / period - frames;
+    onDemand.displayOnSeconds = onSeconds;
+    onDemand.cpuActiveSeconds -= skippedFrames * 0.025f;
+    onDemand.wakeups -= (uint32_t)skippedFrames;
+
+    EnergyModel::Breakdown alwaysResult = model.estimate(always);
+    EnergyModel::Breakdown onDemandResult = model.estimate(onDemand);
+    printBreakdown("pantalla siempre encendida", alwaysResult);
+    printBreakdown("pantalla bajo demanda", onDemandResult);
+    printf("Pantalla encendida %u s/día, %u de %.0f cuadros: ahorro %.1f mAh/día (%.1f display, %.1f CPU)\n",
+           onSeconds, frames, DAY / period, alwaysResult.total - onDemandResult.total,
+           alwaysResult.display - onDemandResult.display, alwaysResult.cpu - onDemandResult.cpu);
+
+    // Cuatro sesiones de 5 min (las pulsaciones seguidas las alargan)
+    TEST_ASSERT_EQUAL_UINT32(4 * timeout + 20 + 15 + 30, onSeconds);
+    TEST_ASSERT_TRUE(onDemandResult.display < alwaysResult.display / 50.0f);
+    TEST_ASSERT_TRUE(onDemandResult.cpu < alwaysResult.cpu);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, alwaysResult.radio, onDemandResult.radio);
+    TEST_ASSERT_TRUE(alwaysResult.total - onDemandResult.total > 200.0f);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_lora_airtime_reference);
+    RUN_TEST(test_uart_busy_fraction);
+    RUN_TEST(test_only_board_and_sleep);
+    RUN_TEST(test_time_is_conserved);
+    RUN_TEST(test_period_estimate);
+    RUN_TEST(test_light_sleep_vs_legacy);
+    RUN_TEST(test_display_on_demand);
+    return UNITY_END();
+}
@@ -0,0 +1,234 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - FRAGMENT ASSEMBLER
+ * ============================================================================
+ * Reensamblado de geocercas fragmentadas con pérdidas, desorden, duplicados
+ * y cambios de versión. Los fragmentos se generan igual que en el backend
+ * (scripts/geofence_downlink.py).
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "system/FragmentAssembler.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+static const size_t FRAGMENT_DATA = 43; // 51 bytes en DR0 - cabecera
+
+// ============================================================================
+// UTILIDADES
+// ============================================================================
+
+// Payload de polígono grande: [0x03][n(2)][lat(4)][lng(4)]...
+static Bytes makePolygonPayload(uint16_t numPoints) {
+    Bytes payload = {0x03, (uint8_t)(numPoints & 0xFF), (uint8_t)(numPoints >> 8)};
+    for (uint16_t i = 0; i < numPoints; i++) {
+        float lat = -33.45f + i * 0.0001f;
+        float lng = -70.66f + (i % 7) * 0.0002f;
+        uint8_t raw[8];
+        memcpy(raw, &lat, 4);
+        memcpy(raw + 4, &lng, 4);
+        payload.insert(payload.end(), raw, raw + 8);
+    }
+    return payload;
+}
+
+static std::vector<Bytes> fragment(const Bytes &payload, uint8_t version) {
+    std::vector<Bytes> fragments;
+    uint16_t crc = FragmentAssembler::crc16(payload.data(), payload.size());
+    uint8_t count = (uint8_t)((payload.size() + FRAGMENT_DATA - 1) / FRAGMENT_DATA);
+
+    for (uint8_t i = 0; i < count; i++) {
+        size_t offset = i * FRAGMENT_DATA;
+        size_t chunk = payload.size() - offset < FRAGMENT_DATA ? payload.size() - offset : FRAGMENT_DATA;
+        Bytes frag = {0x10, version, i, count,
+                      (uint8_t)(offset & 0xFF), (uint8_t)(offset >> 8),
+                      (uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8)};
+        frag.insert(frag.end(), payload.begin() + offset, payload.begin() + offset + chunk);
+        fragments.push_back(frag);
+    }
+    return fragments;
+}
+
+static FragmentAssembler::Status send(FragmentAssembler &assembler, const Bytes &frag, uint32_t now = 0) {
+    return assembler.accept(frag.data(), frag.size(), now);
+}
+
+static void assertPayload(const FragmentAssembler &assembler, const Bytes &expected) {
+    TEST_ASSERT_EQUAL_UINT32(expected.size(), assembler.getPayloadLength());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data(), assembler.getPayload(), expected.size());
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_crc16_matches_ccitt_false() {
+    const uint8_t check[] = "123456789";
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, FragmentAssembler::crc16(check, 9));
+}
+
+void test_in_order_reassembly_of_256_vertices() {
+    FragmentAssembler assembler;
+    Bytes payload = makePolygonPayload(256);
+    std::vector<Bytes> frags = fragment(payload, 1);
+    TEST_ASSERT_GREATER_THAN(40, frags.size());
+
+    for (size_t i = 0; i + 1 < frags.size(); i++) {
+        TEST_ASSERT_EQUAL(FragmentAssembler::FRAGMENT_ACCEPTED, send(assembler, frags[i]));
+        TEST_ASSERT_TRUE(assembler.isActive());
+    }
+    TEST_ASSERT_EQUAL(FragmentAssembler::FRAGMENT_COMPLETE, send(assembler, frags.back()));
+    TEST_ASSERT_FALSE(assembler.isActive());
+    assertPayload(assembler, payload);
+}
+
+void test_reordered_fragments() {
+    FragmentAssembler assembler;
+    Bytes payload = makePolygonPayload(120);
+    std::vector<Bytes> frags = fragment(payload, 7);
+
+    // Orden inverso intercalado
+    std::vector<size_t> order;
+    for (size_t i = frags.size(); i-- > 0;)
+        if (i % 2 == 0) order.push_back(i);
+    for (size_t i = 0; i < frags.size(); i++)
+        if (i % 2 == 1) order.push_back(i);
+
+    FragmentAssembler::Status status = FragmentAssembler::FRAGMENT_ACCEPTED;
+    for (size_t i : order) {
+        status = send(assembler, frags[i]);
+    }
+    TEST_ASSERT_EQUAL(FragmentAssembler::FRAGMENT_COMPLETE, status);
+    assertPayload(assembler, payload);
+}
+
+void test_loss_then_retransmission_of_missing() {
+    FragmentAssembler assembler;
+    Bytes payload = makePolygonPayload(200);
+    std::vector<Bytes> frags = fragment(payload, 3);
+
+    // Se pierden los fragmentos 2, 5 y el último
+    for (size_t i = 0; i < frags.size(); i++) {
+        if (i == 2 || i == 5 || i == frags.size() - 1)
+            continue;
+        TEST_ASSERT_EQUAL(FragmentAssembler::FRAGMENT_ACCEPTED, send(assembler, frags[i], i * 60000));
+    }
+    TEST_ASSERT_EQUAL_UINT8(frags.size() - 3, assembler.getReceivedCount());
+    TEST_ASSERT_FALSE(assembler.getReceivedMask() & (1ull << 2));
+
+    // El backend reenvía la secuencia completa: los ya recibidos son duplicados
+    FragmentAssembler::Status last = FragmentAssembler::FRAGMENT_ACCEPTED;
+    for (size_t i = 0; i < frags.size(); i++) {
+        FragmentAssembler::Status status = send(assembler, frags[i], 3600000);
+        if (i != 2 && i != 5 && i != frags.size() - 1)
+            TEST_ASSERT_EQUAL(FragmentAssembler::FRAGMENT_DUPLICATE, status);
+        else
+            last = status;
+    }
+    TEST_ASSERT_EQUAL(FragmentAssembler::FRAGMENT_COMPLETE, last);
+    assertPayload(assembler, payload);
+    TEST_ASSERT_EQUAL_UINT32(1, assembler.getStats().completed);
+}
+
+void test_completed_transfer_is_not_reapplied() {
+    FragmentAssembler assembler;
+    Bytes payload = makePolygonPayload(30);
+    std::vector<Bytes> frags = fragment(payload, 9);
+
+    for (const Bytes &f : frags)
+        send(assembler, f);
+    TEST_ASSERT_EQUAL_UINT32(1, assembler.getStats().completed);
+
+    // Reenvío tardío de la misma versión
+    for (const Bytes &f : frags)
+        TEST_ASSERT_EQUAL(FragmentAssembler::FRAGMENT_DUPLICATE, send(assembler, f));
+    TEST_ASSERT_FALSE(assembler.isActive());
+    TEST_ASSERT_EQUAL_UINT32(1, assembler.getStats().completed);
+}
+
+void test_new_version_discards_partial() {
+    FragmentAssembler assembler;
+    std::vector<Bytes> oldFrags = fragment(makePolygonPayload(100), 4);
+    Bytes newPayload = makePolygonPayload(60);
+    std::vector<Bytes> newFrags = fragment(newPayload, 5);
+
+    send(assembler, oldFrags[0]);
+    send(assembler, oldFrags[1]);
+    TEST_ASSERT_EQUAL_UINT8(4, assembler.getVersion());
+
+    FragmentAssembler::Status status = FragmentAssembler::FRAGMENT_ACCEPTED;
+    for (const Bytes &f : newFrags)
+        status = send(assembler, f);
+    TEST_ASSERT_EQUAL(FragmentAssembler::FRAGMENT_COMPLETE, status);
+    TEST_ASSERT_EQUAL_UINT32(1, assembler.getStats().restarts);
+    assertPayload(assembler, newPayload);
+
+    // Fragmentos rezagados de la versión vieja no tocan el resultado aplicado
+    TEST_ASSERT_EQUAL(FragmentAssembler::FRAGMENT_ACCEPTED, send(assembler, oldFrags[2]));
+    TEST_ASSERT_EQUAL_UINT8(4, assembler.getVersion());
+}
+
+void test_corrupted_payload_fails_crc() {
+    FragmentAssembler assembler;
+    std::vector<Bytes> frags = fragment(makePolygonPayload(50), 2);
+    frags[3][FragmentAssembler::HEADER_SIZE + 5] ^= 0x01;
+
+    FragmentAssembler::Status status = FragmentAssembler::FRAGMENT_ACCEPTED;
+    for (const Bytes &f : frags)
+        status = send(assembler, f);
+    TEST_ASSERT_EQUAL(FragmentAssembler::FRAGMENT_CRC_ERROR, status);
+    TEST_ASSERT_EQUAL_UINT32(0, assembler.getPayloadLength());
+    TEST_ASSERT_FALSE(assembler.isActive());
+}
+
+void test_partial_expires_after_timeout() {
+    FragmentAssembler assembler(1000);
+    std::vector<Bytes> frags = fragment(makePolygonPayload(40), 1);
+
+    send(assembler, frags[0], 5000);
+    TEST_ASSERT_FALSE(assembler.expire(5999));
+    TEST_ASSERT_TRUE(assembler.expire(6000));
+    TEST_ASSERT_FALSE(assembler.isActive());
+    TEST_ASSERT_EQUAL_UINT32(1, assembler.getStats().expired);
+}
+
+void test_invalid_headers_rejected() {
+    FragmentAssembler assembler;
+    Bytes shortFrag = {0x10, 1, 0, 1, 0, 0, 0, 0};
+    Bytes badIndex = {0x10, 1, 3, 3, 0, 0, 0, 0, 0xAA};
+    Bytes tooMany = {0x10, 1, 0, 65, 0, 0, 0, 0, 0xAA};
+    Bytes overflow = {0x10, 1, 0, 2, 0xFF, 0x08, 0, 0, 0xAA, 0xBB};
+
+    TEST_ASSERT_EQUAL(FragmentAssembler::FRAGMENT_INVALID, send(assembler, shortFrag));
+    TEST_ASSERT_EQUAL(FragmentAssembler::FRAGMENT_INVALID, send(assembler, badIndex));
+    TEST_ASSERT_EQUAL(FragmentAssembler::FRAGMENT_INVALID, send(assembler, tooMany));
+    TEST_ASSERT_EQUAL(FragmentAssembler::FRAGMENT_INVALID, send(assembler, overflow));
+    TEST_ASSERT_FALSE(assembler.isActive());
+}
+
+// ============================================================================
+// RUNNER DE TESTS
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_crc16_matches_ccitt_false);
+    RUN_TEST(test_in_order_reassembly_of_256_vertices);
+    RUN_TEST(test_reordered_fragments);
+    RUN_TEST(test_loss_then_retransmission_of_missing);
+    RUN_TEST(test_completed_transfer_is_not_reapplied);
+    RUN_TEST(test_new_version_discards_partial);
+    RUN_TEST(test_corrupted_payload_fails_crc);
+    RUN_TEST(test_partial_expires_after_timeout);
+    RUN_TEST(test_invalid_headers_rejected);
+
+    return UNITY_END();
+}
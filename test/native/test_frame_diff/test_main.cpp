@@ -0,0 +1,281 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - FRAME DIFF (ACTUALIZACIÓN PARCIAL DEL OLED)
+ * ============================================================================
+ * Sobre un framebuffer de páginas igual al de SSD1306Wire y un panel
+ * simulado que recibe los rectángulos como el SSD1306 en direccionamiento
+ * horizontal: el panel siempre termina igual al cuadro, un cuadro sin
+ * cambios no manda nada y un dígito toca solo sus páginas. Mide bytes I2C
+ * y tiempo por cuadro en una hora de la pantalla principal.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "config/constants.h"
+#include "system/FrameDiff.h"
+
+// ============================================================================
+// FRAMEBUFFER Y PANEL SIMULADOS
+// ============================================================================
+
+static uint8_t frame[FrameDiff::FRAME_SIZE];
+static uint8_t panel[FrameDiff::FRAME_SIZE]; // GDDRAM del SSD1306
+
+static void setPixel(int x, int y, bool on) {
+    if (x < 0 || x >= FrameDiff::WIDTH || y < 0 || y >= DISPLAY_HEIGHT) {
+        return;
+    }
+    uint8_t &cell = frame[(y / 8) * FrameDiff::WIDTH + x];
+    cell = on ? (cell | (1 << (y & 7))) : (cell & ~(1 << (y & 7)));
+}
+
+static void fillRect(int x, int y, int width, int height, bool on) {
+    for (int i = x; i < x + width; i++) {
+        for (int j = y; j < y + height; j++) {
+            setPixel(i, j, on);
+        }
+    }
+}
+
+// Glifos de 5x10 derivados del carácter, 6 columnas por letra como ArialMT_Plain_10
+static const int GLYPH_WIDTH = 6;
+
+static void drawText(int x, int y, const char *text) {
+    for (; *text; text++, x += GLYPH_WIDTH) {
+        for (int column = 0; column < GLYPH_WIDTH - 1; column++) {
+            for (int row = 0; row < 10; row++) {
+                setPixel(x + column, y + row + 1, ((*text * 31 + column * 7 + row * 3) % 5) < 2);
+            }
+        }
+    }
+}
+
+static void drawTextRight(int x, int y, const char *text) {
+    drawText(x - (int)strlen(text) * GLYPH_WIDTH, y, text);
+}
+
+// Lo que hace el SSD1306 con COLUMNADDR/PAGEADDR y los bytes de datos
+static void sendToPanel(const FrameDiff::Region *regions, uint8_t count) {
+    uint8_t chunk[DISPLAY_I2C_CHUNK];
+    for (uint8_t i = 0; i < count; i++) {
+        const FrameDiff::Region &region = regions[i];
+        uint8_t page = region.firstPage;
+        uint8_t column = region.firstColumn;
+        size_t offset = 0;
+        size_t length;
+        while ((length = FrameDiff::copyRegion(frame, region, offset, chunk, sizeof(chunk))) > 0) {
+            for (size_t b = 0; b < length; b++) {
+                panel[page * FrameDiff::WIDTH + column] = chunk[b];
+                if (column++ == region.lastColumn) {
+                    column = region.firstColumn;
+                    page = page == region.lastPage ? region.firstPage : page + 1;
+                }
+            }
+            offset += length;
+        }
+    }
+}
+
+static uint8_t push(FrameDiff &diff, FrameDiff::Region *regions, uint8_t capacity = DISPLAY_MAX_REGIONS) {
+    uint8_t count = diff.update(frame, regions, capacity);
+    sendToPanel(regions, count);
+    return count;
+}
+
+// Pantalla principal con la disposición de DisplayManager::showMainScreen
+struct MainScreen {
+    int battery;
+    int latitude;  // Microgrados
+    int longitude;
+    int satellites;
+    bool alert;
+    int minutes;
+    int tx;
+};
+
+static void drawMainScreen(const MainScreen &screen) {
+    char line[32];
+    memset(frame, 0, sizeof(frame));
+    drawText(0, 0, "R");
+    snprintf(line, sizeof(line), "%d%% %.1fV", screen.battery, 3.3 + screen.battery / 100.0);
+    drawTextRight(128, 0, line);
+    snprintf(line, sizeof(line), "LAT: %.5f", screen.latitude / 1e6);
+    drawText(0, 12, line);
+    snprintf(line, sizeof(line), "SAT:%d", screen.satellites);
+    drawTextRight(128, 12, line);
+    snprintf(line, sizeof(line), "LNG: %.5f", screen.longitude / 1e6);
+    drawText(0, 24, line);
+    drawText(0, 36, screen.alert ? "ALERTA: PRECAUCION" : "Estado: SEGURO");
+    snprintf(line, sizeof(line), "UP:%02d TX:%d RX:0", screen.minutes, screen.tx);
+    drawText(0, 48, line);
+    drawTextRight(128, 48, "1/4");
+}
+
+void setUp(void) {
+    memset(frame, 0, sizeof(frame));
+    memset(panel, 0xFF, sizeof(panel)); // Contenido desconocido al encender
+    srand(1234);
+}
+
+void tearDown(void) {}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_first_frame_is_full(void) {
+    FrameDiff diff;
+    FrameDiff::Region regions[DISPLAY_MAX_REGIONS];
+    TEST_ASSERT_FALSE(diff.isValid());
+
+    // Un cuadro negro también se manda: el panel puede tener cualquier cosa
+    uint8_t count = push(diff, regions);
+    TEST_ASSERT_EQUAL(1, count);
+    TEST_ASSERT_EQUAL(0, regions[0].firstPage);
+    TEST_ASSERT_EQUAL(FrameDiff::PAGES - 1, regions[0].lastPage);
+    TEST_ASSERT_EQUAL(FrameDiff::FRAME_SIZE, regions[0].size());
+    TEST_ASSERT_EQUAL(FrameDiff::fullFrameBytes(), FrameDiff::i2cBytes(regions, count));
+    TEST_ASSERT_EQUAL_MEMORY(frame, panel, sizeof(frame));
+    TEST_ASSERT_TRUE(diff.isValid());
+
+    // Tras invalidate() (reset del panel) se vuelve a mandar todo
+    diff.invalidate();
+    TEST_ASSERT_EQUAL(1, push(diff, regions));
+    TEST_ASSERT_EQUAL(FrameDiff::FRAME_SIZE, regions[0].size());
+}
+
+void test_unchanged_frame_sends_nothing(void) {
+    FrameDiff diff;
+    FrameDiff::Region regions[DISPLAY_MAX_REGIONS];
+    drawMainScreen({87, -33456780, -70612340, 7, false, 12, 40});
+    push(diff, regions);
+
+    drawMainScreen({87, -33456780, -70612340, 7, false, 12, 40});
+    TEST_ASSERT_EQUAL(0, push(diff, regions));
+    TEST_ASSERT_EQUAL_UINT32(2, diff.getFrames());
+    TEST_ASSERT_EQUAL_UINT32(1, diff.getSkippedFrames());
+    TEST_ASSERT_EQUAL_UINT32(FrameDiff::fullFrameBytes(), diff.getBytesSent());
+}
+
+void test_digit_touches_only_its_pages(void) {
+    FrameDiff diff;
+    FrameDiff::Region regions[DISPLAY_MAX_REGIONS];
+    drawMainScreen({87, -33456780, -70612340, 7, false, 12, 40});
+    push(diff, regions);
+
+    // Batería 87% -> 86%: arriba a la derecha, filas 1..10 (páginas 0 y 1)
+    drawMainScreen({86, -33456780, -70612340, 7, false, 12, 40});
+    uint8_t count = push(diff, regions);
+    TEST_ASSERT_TRUE(count >= 1);
+    for (uint8_t i = 0; i < count; i++) {
+        TEST_ASSERT_TRUE(regions[i].lastPage <= 1);
+        TEST_ASSERT_TRUE(regions[i].firstColumn >= 64);
+    }
+    TEST_ASSERT_EQUAL_MEMORY(frame, panel, sizeof(frame));
+    size_t bytes = FrameDiff::i2cBytes(regions, count);
+    TEST_ASSERT_TRUE(bytes * 10 < FrameDiff::fullFrameBytes());
+
+    // Dos cambios en la misma página lejos uno del otro: dos tramos
+    memset(frame, 0, sizeof(frame));
+    push(diff, regions);
+    setPixel(2, 20, true);
+    setPixel(120, 20, true);
+    TEST_ASSERT_EQUAL(2, push(diff, regions));
+    TEST_ASSERT_EQUAL(2, regions[0].lastColumn);
+    TEST_ASSERT_EQUAL(120, regions[1].firstColumn);
+
+    // Cerca: uno solo, mandar el hueco es más barato que direccionar otro
+    setPixel(2, 20, false);
+    setPixel(2 + FrameDiff::MERGE_GAP, 20, true);
+    TEST_ASSERT_EQUAL(1, push(diff, regions));
+    TEST_ASSERT_EQUAL(FrameDiff::MERGE_GAP + 1, regions[0].size());
+    TEST_ASSERT_EQUAL_MEMORY(frame, panel, sizeof(frame));
+}
+
+void test_random_changes_keep_panel_in_sync(void) {
+    FrameDiff diff;
+    FrameDiff::Region regions[DISPLAY_MAX_REGIONS];
+
+    for (int round = 0; round < 500; round++) {
+        int changes = rand() % 40;
+        for (int i = 0; i < changes; i++) {
+            if (rand() % 4 == 0) {
+                fillRect(rand() % 128, rand() % 64, rand() % 30, rand() % 20, rand() % 2);
+            } else {
+                setPixel(rand() % 128, rand() % 64, rand() % 2);
+            }
+        }
+        // Listas cortas: el último rectángulo absorbe el resto
+        uint8_t capacity = 1 + rand() % DISPLAY_MAX_REGIONS;
+        uint8_t count = push(diff, regions, capacity);
+        TEST_ASSERT_TRUE(count <= capacity);
+        TEST_ASSERT_EQUAL_MEMORY(frame, panel, sizeof(frame));
+    }
+}
+
+void test_main_screen_hour(void) {
+    FrameDiff diff;
+    FrameDiff::Region regions[DISPLAY_MAX_REGIONS];
+    MainScreen screen = {90, -33456780, -70612340, 7, false, 0, 0};
+
+    // Una hora con DISPLAY_UPDATE_INTERVAL = 4 s: la posición se mueve un
+    // poco en cada cuadro, el uptime cada minuto, la batería cada 20 minutos
+    const int frames = 3600000 / DISPLAY_UPDATE_INTERVAL;
+    size_t fullBytes = 0;
+    size_t dirtyBytes = 0;
+    size_t maxBytes = 0;
+    double diffNs = 0;
+
+    for (int i = 0; i < frames; i++) {
+        screen.latitude += rand() % 21 - 10;
+        screen.longitude += rand() % 21 - 10;
+        screen.minutes = i * DISPLAY_UPDATE_INTERVAL / 60000;
+        screen.tx = i * DISPLAY_UPDATE_INTERVAL / 60000;
+        screen.battery = 90 - i / 300;
+        screen.alert = (i / 100) % 3 == 2;
+        drawMainScreen(screen);
+
+        auto start = std::chrono::steady_clock::now();
+        uint8_t count = diff.update(frame, regions, DISPLAY_MAX_REGIONS);
+        diffNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        sendToPanel(regions, count);
+        TEST_ASSERT_EQUAL_MEMORY(frame, panel, sizeof(frame));
+
+        size_t bytes = FrameDiff::i2cBytes(regions, count);
+        dirtyBytes += bytes;
+        fullBytes += FrameDiff::fullFrameBytes();
+        if (i > 0 && bytes > maxBytes) {
+            maxBytes = bytes;
+        }
+    }
+
+    printf("\nPantalla principal, %d cuadros: %zu -> %zu bytes I2C (%.0f -> %.0f por cuadro, máx %zu), "
+           "bus %lu -> %lu us por cuadro, diff %.1f us\n",
+           frames, fullBytes, dirtyBytes, (double)fullBytes / frames, (double)dirtyBytes / frames, maxBytes,
+           (unsigned long)FrameDiff::transferMicros(FrameDiff::fullFrameBytes(), DISPLAY_I2C_CLOCK),
+           (unsigned long)FrameDiff::transferMicros(dirtyBytes / frames, DISPLAY_I2C_CLOCK), diffNs / frames / 1000);
+
+    TEST_ASSERT_TRUE(dirtyBytes * 4 < fullBytes);
+    TEST_ASSERT_TRUE(maxBytes < FrameDiff::fullFrameBytes());
+    TEST_ASSERT_EQUAL_UINT32(dirtyBytes, diff.getBytesSent());
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_frame_is_full);
+    RUN_TEST(test_unchanged_frame_sends_nothing);
+    RUN_TEST(test_digit_touches_only_its_pages);
+    RUN_TEST(test_random_changes_keep_panel_in_sync);
+    RUN_TEST(test_main_screen_hour);
+    return UNITY_END();
+}
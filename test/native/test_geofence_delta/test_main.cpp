@@ -0,0 +1,202 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - DELTAS DE GEOCERCA
+ * ============================================================================
+ * Ediciones incrementales (mover/insertar/borrar vértices, radio, centro y
+ * nombre): paridad con el encoder del backend (scripts/geofence_downlink.py),
+ * rechazo de deltas inválidos y tamaño frente a reenviar la geocerca.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "config/constants.h"
+#include "config/lorawan_config.h"
+#include "utils/PolygonCodec.h"
+#include "utils/GeofenceDelta.h"
+
+using namespace PolygonCodec;
+
+// ============================================================================
+// UTILIDADES
+// ============================================================================
+
+static std::vector<uint8_t> fromHex(const char *hex) {
+    std::vector<uint8_t> out;
+    for (size_t i = 0; hex[i] && hex[i + 1]; i += 2) {
+        unsigned v;
+        sscanf(&hex[i], "%2x", &v);
+        out.push_back((uint8_t)v);
+    }
+    return out;
+}
+
+static GeoPoint vertices[GEOFENCE_MAX_VERTICES];
+
+// Cuadrado de ~100 m con el vértice 0 en (-33.45, -70.66)
+static Geofence makeSquare() {
+    double dLat = 100 / metersPerDegreeLat(-33.45);
+    double dLng = 100 / metersPerDegreeLng(-33.45);
+    vertices[0] = GeoPoint(-33.45, -70.66);
+    vertices[1] = GeoPoint(-33.45 + dLat, -70.66);
+    vertices[2] = GeoPoint(-33.45 + dLat, -70.66 + dLng);
+    vertices[3] = GeoPoint(-33.45, -70.66 + dLng);
+    vertices[4] = GeoPoint(-33.45 - dLat / 2, -70.66 + dLng / 2);
+    Geofence fence(vertices, 5, "Potrero", "grupo1");
+    fence.fenceId = 0x0107;
+    fence.version = 3;
+    return fence;
+}
+
+static double metersBetween(const GeoPoint &a, const GeoPoint &b) {
+    double north = (b.lat - a.lat) * metersPerDegreeLat(a.lat);
+    double east = (b.lng - a.lng) * metersPerDegreeLng(a.lat);
+    return sqrt(north * north + east * east);
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_header(void) {
+    // GeofenceDelta(0x0107, 3) del backend
+    std::vector<uint8_t> delta = fromHex("20070103040a0102541d");
+    GeofenceDelta::Header header;
+    TEST_ASSERT_TRUE(GeofenceDelta::parseHeader(delta.data(), delta.size(), &header));
+    TEST_ASSERT_EQUAL_HEX16(0x0107, header.fenceId);
+    TEST_ASSERT_EQUAL_UINT8(3, header.baseVersion);
+    TEST_ASSERT_EQUAL_UINT8(4, header.newVersion);
+    TEST_ASSERT_EQUAL_UINT8(10, header.resolutionCm);
+
+    TEST_ASSERT_FALSE(GeofenceDelta::parseHeader(delta.data(), 5, &header));
+    delta[5] = 0; // Resolución 0
+    TEST_ASSERT_FALSE(GeofenceDelta::parseHeader(delta.data(), delta.size(), &header));
+}
+
+void test_python_parity_polygon_ops(void) {
+    // move(2, v0 -> +4.2 m N, -1.5 m E), insert(0, desde v0), delete(4), name("Potrero 2")
+    std::vector<uint8_t> delta = fromHex("20070103040a0102541d0200dd01b90103040509506f747265726f2032");
+    Geofence fence = makeSquare();
+    // El backend tomó (-33.45, -70.66) como origen del move y del insert
+    vertices[2] = GeoPoint(-33.45, -70.66);
+    vertices[4] = GeoPoint(-33.45, -70.66);
+    GeoPoint v0 = vertices[0];
+    GeoPoint v1 = vertices[1];
+
+    TEST_ASSERT_TRUE(GeofenceDelta::apply(delta.data(), delta.size(), fence, vertices, GEOFENCE_MAX_VERTICES));
+    TEST_ASSERT_EQUAL_UINT16(5, fence.pointCount); // +1 insert, -1 delete
+    TEST_ASSERT_EQUAL_STRING("Potrero 2", fence.name);
+
+    // Insertado en 0, offset desde el vértice previo (el último)
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 0.0, metersBetween(GeoPoint(-33.4501, -70.6601), vertices[0]));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, metersBetween(v0, vertices[1]));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, metersBetween(v1, vertices[2]));
+
+    // El vértice movido (antes índice 2, ahora 3) quedó a 4.2 m N y 1.5 m O
+    double north = (vertices[3].lat - v0.lat) * metersPerDegreeLat(v0.lat);
+    double east = (vertices[3].lng - v0.lng) * metersPerDegreeLng(v0.lat);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 4.2, north);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, -1.5, east);
+}
+
+void test_python_parity_circle_ops(void) {
+    // GeofenceDelta(9, 0, 100).radius(350).center(+25 m E)
+    std::vector<uint8_t> delta = fromHex("20090000016404de02060032");
+    Geofence circle(-40.0, -73.0, 200, "Circle", "grupo1");
+    circle.fenceId = 9;
+
+    TEST_ASSERT_TRUE(GeofenceDelta::apply(delta.data(), delta.size(), circle, vertices, GEOFENCE_MAX_VERTICES));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 350.0, circle.radius);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 25.0, metersBetween(GeoPoint(-40.0, -73.0), GeoPoint(circle.centerLat, circle.centerLng)));
+}
+
+void test_rejects_invalid_ops(void) {
+    Geofence fence = makeSquare();
+    Geofence circle(-40.0, -73.0, 200, "Circle", "grupo1");
+
+    // Índice fuera de rango
+    std::vector<uint8_t> move = fromHex("20070103040a01090202");
+    TEST_ASSERT_FALSE(GeofenceDelta::apply(move.data(), move.size(), fence, vertices, GEOFENCE_MAX_VERTICES));
+
+    // Operación de polígono sobre un círculo y viceversa
+    std::vector<uint8_t> moveOk = fromHex("20070103040a01010202");
+    TEST_ASSERT_FALSE(GeofenceDelta::apply(moveOk.data(), moveOk.size(), circle, vertices, GEOFENCE_MAX_VERTICES));
+    std::vector<uint8_t> radius = fromHex("20070103040a04e402");
+    TEST_ASSERT_FALSE(GeofenceDelta::apply(radius.data(), radius.size(), fence, vertices, GEOFENCE_MAX_VERTICES));
+
+    // Truncado a mitad de operación y operación desconocida
+    TEST_ASSERT_FALSE(GeofenceDelta::apply(moveOk.data(), moveOk.size() - 1, fence, vertices, GEOFENCE_MAX_VERTICES));
+    std::vector<uint8_t> unknown = fromHex("20070103040a7f");
+    TEST_ASSERT_FALSE(GeofenceDelta::apply(unknown.data(), unknown.size(), fence, vertices, GEOFENCE_MAX_VERTICES));
+
+    // Nombre más largo que el payload
+    std::vector<uint8_t> name = fromHex("20070103040a0509506f74");
+    TEST_ASSERT_FALSE(GeofenceDelta::apply(name.data(), name.size(), fence, vertices, GEOFENCE_MAX_VERTICES));
+}
+
+void test_delete_keeps_triangle(void) {
+    Geofence fence = makeSquare();
+    std::vector<uint8_t> twoDeletes = fromHex("20070103040a03000300");
+    TEST_ASSERT_TRUE(GeofenceDelta::apply(twoDeletes.data(), twoDeletes.size(), fence, vertices, GEOFENCE_MAX_VERTICES));
+    TEST_ASSERT_EQUAL_UINT16(3, fence.pointCount);
+
+    std::vector<uint8_t> oneMore = fromHex("20070103040a0300");
+    TEST_ASSERT_FALSE(GeofenceDelta::apply(oneMore.data(), oneMore.size(), fence, vertices, GEOFENCE_MAX_VERTICES));
+}
+
+void test_insert_respects_capacity(void) {
+    Geofence fence = makeSquare();
+    std::vector<uint8_t> append = fromHex("20070103040a02050202");
+    TEST_ASSERT_TRUE(GeofenceDelta::apply(append.data(), append.size(), fence, vertices, 6));
+    TEST_ASSERT_EQUAL_UINT16(6, fence.pointCount);
+    TEST_ASSERT_FALSE(GeofenceDelta::apply(append.data(), append.size(), fence, vertices, 6));
+}
+
+void test_small_edit_small_message(void) {
+    // Potrero de 120 vértices: mover uno 5 m frente a reenviar todo
+    std::vector<GeoPoint> pts;
+    for (uint16_t i = 0; i < 120; i++) {
+        double a = 2 * M_PI * i / 120;
+        pts.push_back(GeoPoint(-33.45 + 400 * sin(a) / metersPerDegreeLat(-33.45),
+                               -70.66 + 560 * cos(a) / metersPerDegreeLng(-33.45)));
+    }
+    uint8_t full[1024];
+    size_t fullLen = encode(GEOFENCE_CMD_POLYGON_VARINT, pts.data(), pts.size(), -33.45, -70.66, 10, full, sizeof(full));
+
+    uint8_t delta[32] = {GEOFENCE_CMD_DELTA, 0x07, 0x00, 0x01, 0x02, 10, GeofenceDelta::OP_MOVE};
+    size_t len = 7;
+    len += writeVarint(&delta[len], sizeof(delta) - len, 100);
+    len += writeVarint(&delta[len], sizeof(delta) - len, zigZagEncode(50));
+    len += writeVarint(&delta[len], sizeof(delta) - len, zigZagEncode(0));
+
+    Geofence fence(pts.data(), pts.size(), "Potrero", "grupo1");
+    memcpy(vertices, pts.data(), pts.size() * sizeof(GeoPoint));
+    TEST_ASSERT_TRUE(GeofenceDelta::apply(delta, len, fence, vertices, GEOFENCE_MAX_VERTICES));
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 5.0, metersBetween(pts[100], vertices[100]));
+
+    printf("Mover 1 de 120 vértices: delta %u bytes, geocerca completa %u bytes (%u downlinks)\n",
+           (unsigned)len, (unsigned)fullLen, (unsigned)((fullLen + 42) / 43));
+    TEST_ASSERT_LESS_OR_EQUAL(11, len);
+    TEST_ASSERT_GREATER_THAN(20 * len, fullLen);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_header);
+    RUN_TEST(test_python_parity_polygon_ops);
+    RUN_TEST(test_python_parity_circle_ops);
+    RUN_TEST(test_rejects_invalid_ops);
+    RUN_TEST(test_delete_keeps_triangle);
+    RUN_TEST(test_insert_respects_capacity);
+    RUN_TEST(test_small_edit_small_message);
+    return UNITY_END();
+}
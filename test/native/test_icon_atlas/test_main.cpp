@@ -0,0 +1,308 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - ATLAS DE ICONOS
+ * ============================================================================
+ * Iconos generados en compilación (static_assert sobre el atlas), arte
+ * ASCII convertido al formato de páginas, variantes de batería y señal,
+ * blit() igual a copiar píxel por píxel en cualquier posición (también
+ * recortando en los bordes) y tiempo de la barra de estado y del icono de
+ * alerta frente a componerlos con primitivas como SSD1306Wire.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "config/constants.h"
+#include "utils/IconAtlas.h"
+
+using namespace IconAtlas;
+
+// Generado al compilar: si algo de esto no fuera constexpr no compilaría
+static_assert(BATTERY.icons[18].data[18] == 0xFF, "Batería llena");
+static_assert(BATTERY.icons[0].data[1] == 0x81, "Batería vacía");
+static_assert(GPS_FIX.data[3] == 0x6B, "Columna 3 del GPS: filas 0, 1, 3, 5 y 6");
+static_assert(sizeof(BATTERY) == BATTERY_LEVELS * BATTERY_WIDTH, "Atlas sin relleno");
+
+static const size_t FRAME_SIZE = FRAME_WIDTH * FRAME_PAGES;
+static uint8_t frame[FRAME_SIZE];
+static uint8_t expected[FRAME_SIZE];
+
+static bool iconPixel(const IconRef &icon, int x, int y) {
+    return (icon.data[(y / 8) * icon.width + x] >> (y & 7)) & 1;
+}
+
+static bool framePixel(const uint8_t *buffer, int x, int y) {
+    return (buffer[(y / 8) * FRAME_WIDTH + x] >> (y & 7)) & 1;
+}
+
+static void putPixel(uint8_t *buffer, int x, int y, bool on) {
+    if (x < 0 || x >= FRAME_WIDTH || y < 0 || y >= FRAME_PAGES * 8) {
+        return;
+    }
+    uint8_t &cell = buffer[(y / 8) * FRAME_WIDTH + x];
+    cell = on ? (cell | (1 << (y & 7))) : (cell & ~(1 << (y & 7)));
+}
+
+// Referencia: copiar píxel por píxel
+static void referenceBlit(uint8_t *buffer, int x, int y, const IconRef &icon) {
+    for (int row = 0; row < icon.pages * 8; row++) {
+        for (int column = 0; column < icon.width; column++) {
+            putPixel(buffer, x + column, y + row, iconPixel(icon, column, row));
+        }
+    }
+}
+
+// ============================================================================
+// PRIMITIVAS COMO SSD1306Wire (para el benchmark)
+// ============================================================================
+
+static void drawHorizontalLine(int x, int y, int length) {
+    for (int i = 0; i < length; i++) {
+        putPixel(frame, x + i, y, true);
+    }
+}
+
+static void drawVerticalLine(int x, int y, int length) {
+    if (x < 0 || x >= FRAME_WIDTH) {
+        return;
+    }
+    for (int row = y; row < y + length;) {
+        if (row < 0 || row >= FRAME_PAGES * 8) {
+            row++;
+            continue;
+        }
+        int bits = 8 - (row & 7);
+        if (bits > y + length - row) {
+            bits = y + length - row;
+        }
+        frame[(row / 8) * FRAME_WIDTH + x] |= (uint8_t)(((1 << bits) - 1) << (row & 7));
+        row += bits;
+    }
+}
+
+static void drawRect(int x, int y, int width, int height) {
+    drawHorizontalLine(x, y, width);
+    drawVerticalLine(x, y, height);
+    drawVerticalLine(x + width - 1, y, height);
+    drawHorizontalLine(x, y + height - 1, width);
+}
+
+static void fillRect(int x, int y, int width, int height) {
+    for (int i = x; i < x + width; i++) {
+        drawVerticalLine(i, y, height);
+    }
+}
+
+static void drawLine(int x0, int y0, int x1, int y1) {
+    int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int error = dx + dy;
+    while (true) {
+        putPixel(frame, x0, y0, true);
+        if (x0 == x1 && y0 == y1) {
+            break;
+        }
+        int e2 = 2 * error;
+        if (e2 >= dy) {
+            error += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            error += dx;
+            y0 += sy;
+        }
+    }
+}
+
+static void drawCircle(int x0, int y0, int radius) {
+    int x = 0, y = radius, dp = 1 - radius;
+    do {
+        if (dp < 0) {
+            dp = dp + 2 * (++x) + 3;
+        } else {
+            dp = dp + 2 * (++x) - 2 * (--y) + 5;
+        }
+        putPixel(frame, x0 + x, y0 + y, true);
+        putPixel(frame, x0 - x, y0 + y, true);
+        putPixel(frame, x0 + x, y0 - y, true);
+        putPixel(frame, x0 - x, y0 - y, true);
+        putPixel(frame, x0 + y, y0 + x, true);
+        putPixel(frame, x0 - y, y0 + x, true);
+        putPixel(frame, x0 + y, y0 - x, true);
+        putPixel(frame, x0 - y, y0 - x, true);
+    } while (x < y);
+    putPixel(frame, x0 + radius, y0, true);
+    putPixel(frame, x0, y0 + radius, true);
+    putPixel(frame, x0 - radius, y0, true);
+    putPixel(frame, x0, y0 - radius, true);
+}
+
+// Lo que hacían drawBatteryIcon, drawSignalIcon y drawGPSIcon
+static void primitiveStatusBar(uint8_t percentage, uint8_t strength) {
+    drawRect(106, 0, 20, 10);
+    drawRect(126, 3, 2, 4);
+    fillRect(107, 1, 18 * percentage / 100, 8);
+    for (int i = 0; i < 5; i++) {
+        int height = (i + 1) * 3;
+        if (i < strength) {
+            fillRect(20 + i * 3, 15 - height, 2, height);
+        } else {
+            drawRect(20 + i * 3, 15 - height, 2, height);
+        }
+    }
+    drawCircle(4, 4, 3);
+    drawLine(7, 7, 10, 10);
+    drawLine(1, 7, -2, 10);
+    drawCircle(4, 4, 6);
+}
+
+static void atlasStatusBar(uint8_t percentage, uint8_t strength) {
+    blit(frame, 0, 0, radio(true));
+    blit(frame, 10, 0, gps(true));
+    blit(frame, 20, 0, signal(strength));
+    blit(frame, 106, 0, battery(percentage));
+}
+
+// Triángulo de alerta con '!' a partir de líneas y rectángulos
+static void primitiveAlert(int x, int y) {
+    drawLine(x + 7, y + 1, x, y + 15);
+    drawLine(x + 8, y + 1, x + 15, y + 15);
+    drawHorizontalLine(x, y + 15, 16);
+    fillRect(x + 7, y + 5, 2, 6);
+    fillRect(x + 7, y + 12, 2, 2);
+}
+
+template <typename F>
+static double nanosPerCall(F render, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        memset(frame, 0, sizeof(frame));
+        render(i);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return ns / iterations;
+}
+
+void setUp(void) {
+    srand(42);
+}
+
+void tearDown(void) {}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_art_is_converted_to_pages(void) {
+    const char *art = "...#...."
+                      ".#####.."
+                      ".#...#.."
+                      "##.#.##."
+                      ".#...#.."
+                      ".#####.."
+                      "...#...."
+                      "........";
+    IconRef icon = gps(true);
+    TEST_ASSERT_EQUAL(8, icon.width);
+    TEST_ASSERT_EQUAL(1, icon.pages);
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            TEST_ASSERT_EQUAL(art[y * 8 + x] == '#', iconPixel(icon, x, y));
+        }
+    }
+}
+
+void test_variants(void) {
+    // Batería: columnas llenas proporcionales al porcentaje, borne siempre
+    TEST_ASSERT_TRUE(BATTERY.icons[0].data == battery(0).data);
+    TEST_ASSERT_TRUE(BATTERY.icons[9].data == battery(50).data);
+    TEST_ASSERT_TRUE(BATTERY.icons[18].data == battery(100).data);
+    TEST_ASSERT_TRUE(BATTERY.icons[18].data == battery(250).data);
+    for (uint8_t fill = 0; fill < BATTERY_LEVELS; fill++) {
+        uint8_t full = 0;
+        for (uint8_t x = 1; x < 19; x++) {
+            full += BATTERY.icons[fill].data[x] == 0xFF;
+        }
+        TEST_ASSERT_EQUAL(fill, full);
+        TEST_ASSERT_EQUAL_HEX8(0x3C, BATTERY.icons[fill].data[21]);
+    }
+
+    // Señal: barras crecientes apoyadas abajo, llenas hasta strength
+    IconRef three = signal(3);
+    TEST_ASSERT_EQUAL_HEX8(0xC0, three.data[0]);  // 2 filas
+    TEST_ASSERT_EQUAL_HEX8(0xF8, three.data[6]);  // 5 filas
+    TEST_ASSERT_EQUAL_HEX8(0x84, three.data[9]);  // Hueca: arriba y abajo
+    TEST_ASSERT_EQUAL_HEX8(0x81, three.data[12]); // 8 filas, hueca
+    TEST_ASSERT_TRUE(SIGNAL.icons[SIGNAL_BARS].data == signal(9).data);
+
+    // Alerta: cada nivel distinto, la advertencia es la más llena
+    TEST_ASSERT_EQUAL(2, alert(AlertLevel::WARNING).pages);
+    TEST_ASSERT_TRUE(memcmp(ALERT_CAUTION.data, ALERT_WARNING.data, sizeof(ALERT_WARNING.data)) != 0);
+    int caution = 0, warning = 0;
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 16; x++) {
+            caution += iconPixel(alert(AlertLevel::CAUTION), x, y);
+            warning += iconPixel(alert(AlertLevel::WARNING), x, y);
+        }
+    }
+    TEST_ASSERT_TRUE(warning > caution);
+}
+
+void test_blit_matches_pixel_copy(void) {
+    const IconRef icons[] = {battery(63), signal(2), gps(false), alert(AlertLevel::CAUTION),
+                             geofence(GeofenceType::POLYGON)};
+    for (int round = 0; round < 2000; round++) {
+        for (size_t i = 0; i < FRAME_SIZE; i++) {
+            frame[i] = expected[i] = rand();
+        }
+        const IconRef &icon = icons[rand() % 5];
+        // Alineados, desalineados y fuera de los bordes
+        int x = rand() % (FRAME_WIDTH + 40) - 20;
+        int y = rand() % (FRAME_PAGES * 8 + 40) - 20;
+        blit(frame, x, y, icon);
+        referenceBlit(expected, x, y, icon);
+        TEST_ASSERT_EQUAL_MEMORY(expected, frame, FRAME_SIZE);
+    }
+
+    // El caso alineado solo toca su rectángulo
+    memset(frame, 0, sizeof(frame));
+    blit(frame, 106, 0, battery(100));
+    TEST_ASSERT_EQUAL_HEX8(0, frame[105]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, frame[106]);
+    TEST_ASSERT_EQUAL_HEX8(0x3C, frame[127]);
+    TEST_ASSERT_EQUAL_HEX8(0, frame[FRAME_WIDTH + 106]);
+    TEST_ASSERT_TRUE(framePixel(frame, 110, 4));
+}
+
+void test_render_time_per_screen(void) {
+    const int iterations = 20000;
+    double primitiveBar = nanosPerCall([](int i) { primitiveStatusBar(i % 101, i % 6); }, iterations);
+    double atlasBar = nanosPerCall([](int i) { atlasStatusBar(i % 101, i % 6); }, iterations);
+    double primitiveIcon = nanosPerCall([](int i) { primitiveAlert(56, 47 + i % 3); }, iterations);
+    double atlasIcon = nanosPerCall([](int i) { blit(frame, 56, 47 + i % 3, alert(AlertLevel::CAUTION)); }, iterations);
+    double clearOnly = nanosPerCall([](int i) {}, iterations);
+
+    printf("\nBarra de estado: primitivas %.0f ns, atlas %.0f ns | icono de alerta (y desalineada): %.0f -> %.0f ns"
+           " | memset del cuadro %.0f ns incluido\n",
+           primitiveBar, atlasBar, primitiveIcon, atlasIcon, clearOnly);
+
+    TEST_ASSERT_TRUE(atlasBar < primitiveBar);
+    TEST_ASSERT_TRUE(atlasIcon < primitiveIcon);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_art_is_converted_to_pages);
+    RUN_TEST(test_variants);
+    RUN_TEST(test_blit_matches_pixel_copy);
+    RUN_TEST(test_render_time_per_screen);
+    return UNITY_END();
+}
@@ -0,0 +1,136 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - LINK QUALITY
+ * ============================================================================
+ * Histogramas de RSSI/SNR, éxito por data rate, envejecimiento de la
+ * ventana y formato del uplink de estado.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdint.h>
+#include "system/LinkQuality.h"
+
+static LinkQuality quality;
+
+void setUp(void) {
+    quality.reset();
+}
+
+void tearDown(void) {
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_histogram_bins(void) {
+    quality.recordDownlink(-125.0f, -18.0f, 1000); // Extremo inferior
+    quality.recordDownlink(-115.0f, -12.0f, 2000);
+    quality.recordDownlink(-95.0f, 2.0f, 3000);
+    quality.recordDownlink(-40.0f, 20.0f, 4000);   // Extremo superior
+
+    TEST_ASSERT_EQUAL_UINT16(1, quality.getRssiBin(0));
+    TEST_ASSERT_EQUAL_UINT16(1, quality.getRssiBin(1));
+    TEST_ASSERT_EQUAL_UINT16(1, quality.getRssiBin(3));
+    TEST_ASSERT_EQUAL_UINT16(1, quality.getRssiBin(LinkQuality::RSSI_BINS - 1));
+    TEST_ASSERT_EQUAL_UINT16(1, quality.getSnrBin(0));
+    TEST_ASSERT_EQUAL_UINT16(1, quality.getSnrBin(1));
+    TEST_ASSERT_EQUAL_UINT16(1, quality.getSnrBin(4));
+    TEST_ASSERT_EQUAL_UINT16(1, quality.getSnrBin(LinkQuality::SNR_BINS - 1));
+
+    TEST_ASSERT_EQUAL_INT16(-100, LinkQuality::rssiBinFloor(3));
+    TEST_ASSERT_EQUAL_INT8(0, LinkQuality::snrBinFloor(4));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, -40.0, quality.getLastRssi());
+    TEST_ASSERT_EQUAL_UINT32(4, quality.getDownlinks());
+}
+
+void test_data_rate_success(void) {
+    for (int i = 0; i < 10; i++) {
+        quality.recordUplink(2, i < 9, i == 0 ? 1 : 0);
+    }
+    for (int i = 0; i < 4; i++) {
+        quality.recordUplink(0, i % 2 == 0, 0);
+    }
+
+    TEST_ASSERT_EQUAL_UINT8(90, quality.getSuccessPercent(2));
+    TEST_ASSERT_EQUAL_UINT8(50, quality.getSuccessPercent(0));
+    TEST_ASSERT_EQUAL_UINT8(0xFF, quality.getSuccessPercent(5));
+    TEST_ASSERT_EQUAL_UINT16(1, quality.getDataRateStats(2).retransmissions);
+    TEST_ASSERT_EQUAL_UINT32(14, quality.getUplinks());
+    TEST_ASSERT_EQUAL_UINT32(3, quality.getFailures());
+    TEST_ASSERT_EQUAL_UINT32(1, quality.getRetransmissions());
+}
+
+void test_window_ages_old_samples(void) {
+    // Enlace malo al inicio, bueno después: la ventana debe seguir al presente
+    for (int i = 0; i < LinkQuality::WINDOW; i++) {
+        quality.recordUplink(3, false, 0);
+        quality.recordDownlink(-118.0f, -14.0f, i * 1000);
+    }
+    for (int i = 0; i < 4 * LinkQuality::WINDOW; i++) {
+        quality.recordUplink(3, true, 0);
+        quality.recordDownlink(-75.0f, 8.0f, i * 1000);
+    }
+
+    TEST_ASSERT_GREATER_OR_EQUAL(90, quality.getSuccessPercent(3));
+    TEST_ASSERT_LESS_OR_EQUAL(LinkQuality::WINDOW, quality.getDataRateStats(3).attempts);
+    TEST_ASSERT_LESS_THAN(quality.getRssiBin(5) / 8, quality.getRssiBin(1));
+    TEST_ASSERT_FLOAT_WITHIN(0.5, -75.0, quality.getAverageRssi());
+
+    // Los totales no envejecen
+    TEST_ASSERT_EQUAL_UINT32(5 * LinkQuality::WINDOW, quality.getUplinks());
+}
+
+void test_time_since_downlink(void) {
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, quality.getTimeSinceDownlink(5000));
+    quality.recordDownlink(-90.0f, 5.0f, 0xFFFFF000UL);
+    TEST_ASSERT_EQUAL_UINT32(0x2000, quality.getTimeSinceDownlink(0x1000)); // Desborde de millis()
+}
+
+void test_summary_format(void) {
+    uint8_t buf[LinkQuality::SUMMARY_MAX_SIZE];
+
+    // Sin datos: sin máscara de DR y "nunca" en minutos desde downlink
+    size_t len = quality.buildSummary(buf, sizeof(buf), 0);
+    TEST_ASSERT_EQUAL_UINT32(21, len);
+    TEST_ASSERT_EQUAL_HEX8(LinkQuality::SUMMARY_TYPE, buf[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x80, buf[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, buf[17]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, buf[18]);
+
+    quality.recordDownlink(-95.0f, 2.5f, 60000);
+    quality.recordDownlink(-95.0f, 2.5f, 60000);
+    quality.recordDownlink(-85.0f, 2.5f, 60000);
+    quality.recordUplink(2, true, 1);
+    quality.recordUplink(5, false, 0);
+    len = quality.buildSummary(buf, sizeof(buf), 60000 + 5 * 60000);
+
+    TEST_ASSERT_EQUAL_UINT32(23, len);
+    TEST_ASSERT_EQUAL_INT8(-94, (int8_t)buf[1]);   // EWMA
+    TEST_ASSERT_EQUAL_INT8(10, (int8_t)buf[2]);    // 2.5 dB x4
+    TEST_ASSERT_EQUAL_HEX8(0xA0, buf[4]);          // bins 2/3: bin3 = 10/15
+    TEST_ASSERT_EQUAL_HEX8(0x05, buf[5]);          // bin4 = 5/15
+    TEST_ASSERT_EQUAL_HEX8(0x0F, buf[9]);          // SNR bin4 = 15/15
+    TEST_ASSERT_EQUAL_UINT8(2, buf[11]);           // uplinks
+    TEST_ASSERT_EQUAL_UINT8(1, buf[13]);           // fallas
+    TEST_ASSERT_EQUAL_UINT8(1, buf[15]);           // retransmisiones
+    TEST_ASSERT_EQUAL_UINT8(5, buf[17]);           // minutos
+    TEST_ASSERT_EQUAL_HEX8(0x24, buf[19]);         // DR2 y DR5
+    TEST_ASSERT_EQUAL_UINT8(100, buf[21]);
+    TEST_ASSERT_EQUAL_UINT8(0, buf[22]);
+
+    // Buffer insuficiente
+    TEST_ASSERT_EQUAL_UINT32(0, quality.buildSummary(buf, 22, 0));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_histogram_bins);
+    RUN_TEST(test_data_rate_success);
+    RUN_TEST(test_window_ages_old_samples);
+    RUN_TEST(test_time_since_downlink);
+    RUN_TEST(test_summary_format);
+    return UNITY_END();
+}
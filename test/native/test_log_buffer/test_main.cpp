@@ -0,0 +1,240 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - LOG BUFFER
+ * ============================================================================
+ * El formato diferido da el mismo texto que vsnprintf, los %s se copian al
+ * encolar, la cola llena descarta y cuenta, y varias tareas pueden escribir
+ * a la vez sin perder ni mezclar mensajes. Compara además el costo de
+ * encolar contra el de formatear en la llamada.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "system/LogBuffer.h"
+
+// ============================================================================
+// AYUDAS
+// ============================================================================
+
+static bool pushf(LogBuffer &buffer, uint8_t level, uint32_t timestamp, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    bool ok = buffer.push(level, timestamp, format, args);
+    va_end(args);
+    return ok;
+}
+
+// Captura y formatea en diferido; devuelve también el texto de vsnprintf
+static void deferred(char *output, char *expected, size_t size, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    LogBuffer::Record record;
+    LogBuffer::capture(record, format, args);
+    va_end(args);
+
+    va_start(args, format);
+    vsnprintf(expected, size, format, args);
+    va_end(args);
+
+    LogBuffer::format(record, output, size);
+}
+
+#define TEST_DEFERRED(...)                                   \
+    do {                                                     \
+        char output[128];                                    \
+        char expected[128];                                  \
+        deferred(output, expected, sizeof(output), __VA_ARGS__); \
+        TEST_ASSERT_EQUAL_STRING(expected, output);          \
+    } while (0)
+
+static volatile uint32_t sink = 0;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_format_matches_vsnprintf(void) {
+    TEST_DEFERRED("sin argumentos");
+    TEST_DEFERRED("📍 GPS: %.6f, %.6f", -33.448890, -70.669265);
+    TEST_DEFERRED("%s Batería: %.2fV (%d%%)", "🔋", 3.87f, 76);
+    TEST_DEFERRED("Packet #%d enviado, seq %u, flags 0x%02X", 42, 7u, 0x0A);
+    TEST_DEFERRED("memoria %lu bytes, tiempo %llu us", 123456UL, 9876543210ULL);
+    TEST_DEFERRED("tam %zu, dif %td, char '%c'", (size_t)64, (ptrdiff_t)-5, 'x');
+    TEST_DEFERRED("ancho [%*d] precisión [%.*f] ambos [%*.*s]", 6, 42, 3, 2.5, 8, 3, "abcdef");
+    TEST_DEFERRED("flags [%-8s] [%+d] [%08.3f] [%#x] [%e] [%g]", "izq", 5, 3.14159, 255, 12345.678, 0.0001);
+    TEST_DEFERRED("puntero %p", (void *)0x1234);
+    TEST_DEFERRED("corto %hd, muy corto %hhu", (short)-3, (unsigned char)200);
+}
+
+void test_string_copied_at_push(void) {
+    std::unique_ptr<LogBuffer> buffer(new LogBuffer());
+    char name[16] = "Potrero Norte";
+    TEST_ASSERT_TRUE(pushf(*buffer, 3, 1500, "Geocerca cargada: %s (%d vértices)", name, 12));
+
+    // El texto original cambia antes de que la tarea de log lo formatee
+    strcpy(name, "XXXXXXXXXXXX");
+
+    LogBuffer::Record record;
+    TEST_ASSERT_TRUE(buffer->pop(record));
+    TEST_ASSERT_EQUAL(3, record.level);
+    TEST_ASSERT_EQUAL_UINT32(1500, record.timestamp);
+    TEST_ASSERT_FALSE(record.truncated);
+
+    char text[96];
+    size_t length = LogBuffer::format(record, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("Geocerca cargada: Potrero Norte (12 vértices)", text);
+    TEST_ASSERT_EQUAL(strlen(text), length);
+    TEST_ASSERT_FALSE(buffer->pop(record));
+}
+
+void test_oversized_arguments_truncated(void) {
+    char longText[LogBuffer::ARGS_SIZE * 2];
+    memset(longText, 'a', sizeof(longText) - 1);
+    longText[sizeof(longText) - 1] = '\0';
+
+    // El %s se corta en lo que queda y los argumentos siguientes se pierden
+    char output[160];
+    char expected[160];
+    deferred(output, expected, sizeof(output), "[%s] n=%d", longText, 7);
+    TEST_ASSERT_EQUAL('~', output[strlen(output) - 1]);
+    TEST_ASSERT_EQUAL(0, strncmp(output, "[aaaa", 5));
+    TEST_ASSERT_NULL(strstr(output, "n=7"));
+    TEST_ASSERT_TRUE(strlen(output) < strlen(expected));
+
+    // Buffer de salida corto: trunca sin desbordar
+    char small[10];
+    memset(small, 'x', sizeof(small));
+    deferred(small, expected, sizeof(small), "valor %d y %s", 123456, "texto");
+    TEST_ASSERT_EQUAL_STRING(expected, small);
+}
+
+void test_full_buffer_drops_and_counts(void) {
+    std::unique_ptr<LogBuffer> buffer(new LogBuffer());
+    for (uint32_t i = 0; i < LogBuffer::SLOTS; i++) {
+        TEST_ASSERT_TRUE(pushf(*buffer, 3, i, "mensaje %lu", (unsigned long)i));
+    }
+    TEST_ASSERT_FALSE(pushf(*buffer, 3, 999, "sin lugar"));
+    TEST_ASSERT_FALSE(pushf(*buffer, 3, 999, "sin lugar"));
+    TEST_ASSERT_EQUAL_UINT32(2, buffer->getDropped());
+    TEST_ASSERT_EQUAL_UINT32(LogBuffer::SLOTS, buffer->getPushed());
+    TEST_ASSERT_EQUAL_UINT32(LogBuffer::SLOTS, buffer->getHighWater());
+
+    // Se vacía en orden y vuelve a aceptar mensajes
+    LogBuffer::Record record;
+    char text[32];
+    for (uint32_t i = 0; i < LogBuffer::SLOTS; i++) {
+        TEST_ASSERT_TRUE(buffer->pop(record));
+        TEST_ASSERT_EQUAL_UINT32(i, record.timestamp);
+    }
+    TEST_ASSERT_TRUE(buffer->isEmpty());
+    TEST_ASSERT_TRUE(pushf(*buffer, 1, 5, "otra vez %d", 1));
+    TEST_ASSERT_TRUE(buffer->pop(record));
+    LogBuffer::format(record, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("otra vez 1", text);
+}
+
+void test_concurrent_producers(void) {
+    // Cuatro tareas registran mientras otra vacía: nada se pierde ni se mezcla
+    std::unique_ptr<LogBuffer> buffer(new LogBuffer());
+    const int producers = 4;
+    const int perProducer = 5000;
+    std::atomic<bool> done(false);
+    std::vector<int> next(producers, 0);
+    int received = 0;
+    bool ordered = true;
+
+    std::thread consumer([&]() {
+        LogBuffer::Record record;
+        char text[64];
+        while (!done.load() || !buffer->isEmpty()) {
+            if (!buffer->pop(record)) {
+                std::this_thread::yield();
+                continue;
+            }
+            int producer = -1;
+            int sequence = -1;
+            LogBuffer::format(record, text, sizeof(text));
+            sscanf(text, "tarea %d mensaje %d", &producer, &sequence);
+            if (producer < 0 || producer >= producers || sequence != next[producer]) {
+                ordered = false;
+            } else {
+                next[producer]++;
+            }
+            received++;
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < perProducer; i++) {
+                while (!pushf(*buffer, 4, 0, "tarea %d mensaje %d", p, i)) {
+                    std::this_thread::yield(); // Llena: reintentar para que el test sea exacto
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    done = true;
+    consumer.join();
+
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_EQUAL(producers * perProducer, received);
+    TEST_ASSERT_EQUAL_UINT32(producers * perProducer, buffer->getPushed());
+}
+
+void test_push_cost_vs_format(void) {
+    // Lo que paga la tarea que registra: encolar contra formatear en la llamada
+    std::unique_ptr<LogBuffer> buffer(new LogBuffer());
+    const int calls = 100000;
+    LogBuffer::Record record;
+    char text[256];
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) {
+        pushf(*buffer, 3, i, "📍 GPS: %.6f, %.6f sats %d hdop %.1f", -33.448890, -70.669265, 9, 1.2);
+        buffer->pop(record); // Mantener la cola con lugar
+    }
+    auto pushNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) {
+        snprintf(text, sizeof(text), "📍 GPS: %.6f, %.6f sats %d hdop %.1f", -33.448890, -70.669265, 9, 1.2);
+        sink += text[10];
+    }
+    auto formatNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // A 115200 baudios cada byte ocupa 86.8 µs del UART
+    size_t length = LogBuffer::format(record, text, sizeof(text));
+    printf("\nEncolar: %.0f ns (incluye sacar) | formatear: %.0f ns | UART: %.0f us por línea de %zu bytes\n",
+           pushNs / calls, formatNs / calls, length * 86.8, length);
+    TEST_ASSERT_EQUAL_UINT32(0, buffer->getDropped());
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_format_matches_vsnprintf);
+    RUN_TEST(test_string_copied_at_push);
+    RUN_TEST(test_oversized_arguments_truncated);
+    RUN_TEST(test_full_buffer_drops_and_counts);
+    RUN_TEST(test_concurrent_producers);
+    RUN_TEST(test_push_cost_vs_format);
+    return UNITY_END();
+}
@@ -0,0 +1,180 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - POLYGON CODEC
+ * ============================================================================
+ * Formato compacto de polígonos: precisión a distintas latitudes de Chile,
+ * paridad con el encoder del backend (scripts/geofence_downlink.py) y
+ * tamaño frente a los formatos anteriores.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "config/constants.h"
+#include "config/lorawan_config.h"
+#include "utils/PolygonCodec.h"
+
+using namespace PolygonCodec;
+
+// ============================================================================
+// UTILIDADES
+// ============================================================================
+
+static std::vector<uint8_t> fromHex(const char *hex) {
+    std::vector<uint8_t> out;
+    for (size_t i = 0; hex[i] && hex[i + 1]; i += 2) {
+        unsigned v;
+        sscanf(&hex[i], "%2x", &v);
+        out.push_back((uint8_t)v);
+    }
+    return out;
+}
+
+// Polígono tipo corral: vértices cada ~spacing metros alrededor de un óvalo
+static std::vector<GeoPoint> makeFence(double lat, double lng, uint16_t n, double radiusM) {
+    std::vector<GeoPoint> pts;
+    for (uint16_t i = 0; i < n; i++) {
+        double a = 2 * M_PI * i / n;
+        double north = radiusM * sin(a);
+        double east = 1.4 * radiusM * cos(a);
+        pts.push_back(GeoPoint(lat + north / metersPerDegreeLat(lat), lng + east / metersPerDegreeLng(lat)));
+    }
+    return pts;
+}
+
+static void assertRoundTrip(double lat, double lng, uint8_t resolutionCm) {
+    std::vector<GeoPoint> pts = makeFence(lat, lng, 60, 400);
+    uint8_t buf[1024];
+    size_t len = encode(GEOFENCE_CMD_POLYGON_VARINT, pts.data(), pts.size(), lat, lng, resolutionCm, buf, sizeof(buf));
+    TEST_ASSERT_GREATER_THAN(0, len);
+
+    GeoPoint out[GEOFENCE_MAX_VERTICES];
+    uint16_t count = 0;
+    size_t consumed = 0;
+    TEST_ASSERT_TRUE(decode(buf, len, out, GEOFENCE_MAX_VERTICES, &count, &consumed));
+    TEST_ASSERT_EQUAL_UINT16(pts.size(), count);
+    TEST_ASSERT_EQUAL_UINT32(len, consumed);
+
+    // Error por eje ≤ media resolución (más margen numérico)
+    double maxErr = resolutionCm / 200.0 + 0.001;
+    for (uint16_t i = 0; i < count; i++) {
+        double errNorth = fabs(out[i].lat - pts[i].lat) * metersPerDegreeLat(lat);
+        double errEast = fabs(out[i].lng - pts[i].lng) * metersPerDegreeLng(lat);
+        TEST_ASSERT_TRUE(errNorth <= maxErr);
+        TEST_ASSERT_TRUE(errEast <= maxErr);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_zigzag_and_varint() {
+    const int32_t values[] = {0, 1, -1, 63, -64, 64, 300, -300, 2147483647, (int32_t)-2147483648LL};
+    for (int32_t v : values) {
+        TEST_ASSERT_EQUAL_INT32(v, zigZagDecode(zigZagEncode(v)));
+        uint8_t buf[5];
+        uint32_t back = 0;
+        size_t n = writeVarint(buf, sizeof(buf), zigZagEncode(v));
+        TEST_ASSERT_EQUAL_UINT32(n, readVarint(buf, n, &back));
+        TEST_ASSERT_EQUAL_UINT32(zigZagEncode(v), back);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, zigZagEncode(-1));
+    TEST_ASSERT_EQUAL_UINT32(2, zigZagEncode(1));
+}
+
+void test_round_trip_across_chilean_latitudes() {
+    assertRoundTrip(-18.4783, -70.3126, 10); // Arica
+    assertRoundTrip(-33.4489, -70.6693, 10); // Santiago
+    assertRoundTrip(-41.4693, -72.9424, 5);  // Puerto Montt
+    assertRoundTrip(-53.1638, -70.9171, 1);  // Punta Arenas
+}
+
+void test_decodes_backend_fixture() {
+    // encode_varint_polygon([...4 puntos Santiago...], "g1", 10)
+    std::vector<uint8_t> payload = fromHex("044ef20fece4a6e0d50a04e211c406e514f2128713f91fba1df1126731");
+    const double expected[4][2] = {{-33.4489, -70.6693}, {-33.4501, -70.6680}, {-33.4512, -70.6702}, {-33.4495, -70.6715}};
+
+    GeoPoint out[8];
+    uint16_t count = 0;
+    size_t consumed = 0;
+    TEST_ASSERT_TRUE(decode(payload.data(), payload.size(), out, 8, &count, &consumed));
+    TEST_ASSERT_EQUAL_UINT16(4, count);
+    TEST_ASSERT_EQUAL_UINT32(payload.size() - 2, consumed); // "g1"
+    for (uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(fabs(out[i].lat - expected[i][0]) * metersPerDegreeLat(-33.45) < 0.051);
+        TEST_ASSERT_TRUE(fabs(out[i].lng - expected[i][1]) * metersPerDegreeLng(-33.45) < 0.051);
+    }
+}
+
+void test_encoder_matches_backend_bytes() {
+    // encode_varint_polygon([...3 puntos Punta Arenas...], "", 5)
+    std::vector<uint8_t> expected = fromHex("04c59f4fe063ebbad505038233b101dd29f22bc745cd53");
+    GeoPoint pts[3] = {GeoPoint(-53.1638, -70.9171), GeoPoint(-53.1650, -70.9150), GeoPoint(-53.1670, -70.9190)};
+    double refLat = (-53.1638 - 53.1650 - 53.1670) / 3;
+    double refLng = (-70.9171 - 70.9150 - 70.9190) / 3;
+
+    uint8_t buf[64];
+    size_t len = encode(GEOFENCE_CMD_POLYGON_VARINT, pts, 3, refLat, refLng, 5, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_UINT32(expected.size(), len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data(), buf, len);
+}
+
+void test_smaller_than_previous_formats() {
+    std::vector<GeoPoint> pts = makeFence(-33.4489, -70.6693, 120, 300);
+    uint8_t buf[2048];
+    size_t fine = encode(GEOFENCE_CMD_POLYGON_VARINT, pts.data(), pts.size(), -33.4489, -70.6693, 10, buf, sizeof(buf));
+    size_t coarse = encode(GEOFENCE_CMD_POLYGON_VARINT, pts.data(), pts.size(), -33.4489, -70.6693, 100, buf, sizeof(buf));
+    size_t floatFormat = 3 + pts.size() * 8;      // GEOFENCE_CMD_POLYGON_LARGE
+    size_t metersFormat = 10 + pts.size() * 4;    // GEOFENCE_CMD_POLYGON_COMPRESSED (1 m)
+
+    printf("\n[PolygonCodec] %u vértices: float %u B, int16 m %u B, varint 10 cm %u B, varint 1 m %u B\n",
+           (unsigned)pts.size(), (unsigned)floatFormat, (unsigned)metersFormat, (unsigned)fine, (unsigned)coarse);
+
+    TEST_ASSERT_LESS_THAN(floatFormat / 2, fine);
+    TEST_ASSERT_LESS_OR_EQUAL(metersFormat, fine);
+    TEST_ASSERT_LESS_THAN(metersFormat * 6 / 10, coarse);
+}
+
+void test_rejects_truncated_and_oversized() {
+    std::vector<GeoPoint> pts = makeFence(-33.4489, -70.6693, 20, 200);
+    uint8_t buf[256];
+    size_t len = encode(GEOFENCE_CMD_POLYGON_VARINT, pts.data(), pts.size(), -33.4489, -70.6693, 10, buf, sizeof(buf));
+
+    GeoPoint out[GEOFENCE_MAX_VERTICES];
+    uint16_t count = 0;
+    size_t consumed = 0;
+    for (size_t cut = 0; cut < len; cut++) {
+        TEST_ASSERT_FALSE(decode(buf, cut, out, GEOFENCE_MAX_VERTICES, &count, &consumed));
+    }
+    TEST_ASSERT_FALSE(decode(buf, len, out, 10, &count, &consumed));
+
+    uint8_t zeroRes[32];
+    memcpy(zeroRes, buf, sizeof(zeroRes));
+    zeroRes[9] = 0;
+    TEST_ASSERT_FALSE(decode(zeroRes, sizeof(zeroRes), out, GEOFENCE_MAX_VERTICES, &count, &consumed));
+    TEST_ASSERT_EQUAL_UINT32(0, encode(GEOFENCE_CMD_POLYGON_VARINT, pts.data(), pts.size(), -33.4489, -70.6693, 10, buf, 40));
+}
+
+// ============================================================================
+// RUNNER DE TESTS
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_zigzag_and_varint);
+    RUN_TEST(test_round_trip_across_chilean_latitudes);
+    RUN_TEST(test_decodes_backend_fixture);
+    RUN_TEST(test_encoder_matches_backend_bytes);
+    RUN_TEST(test_smaller_than_previous_formats);
+    RUN_TEST(test_rejects_truncated_and_oversized);
+
+    return UNITY_END();
+}
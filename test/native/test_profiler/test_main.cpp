@@ -0,0 +1,271 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - PROFILER
+ * ============================================================================
+ * Acumuladores por sitio (cuenta, total, mínimo, máximo), registro único
+ * de cada sitio aunque varias tareas arranquen a la vez, formato del
+ * uplink de depuración y costo de un PROFILE_SCOPE vacío en el host.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "system/Profiler.h"
+
+// ============================================================================
+// SITIOS DE PRUEBA
+// ============================================================================
+
+static volatile uint32_t sink = 0;
+
+static void busyWork(uint32_t iterations) {
+    for (uint32_t i = 0; i < iterations; i++) {
+        sink += i;
+    }
+}
+
+static void profiledWork(uint32_t iterations) {
+    PROFILE_SCOPE("work");
+    busyWork(iterations);
+}
+
+static void profiledEmpty() {
+    PROFILE_SCOPE("empty");
+}
+
+static Profiler::Site *findSite(const char *name) {
+    for (Profiler::Site *site = Profiler::first(); site; site = site->next) {
+        if (strcmp(site->name, name) == 0) {
+            return site;
+        }
+    }
+    return nullptr;
+}
+
+static uint8_t countSites(const char *name) {
+    uint8_t count = 0;
+    for (Profiler::Site *site = Profiler::first(); site; site = site->next) {
+        if (strcmp(site->name, name) == 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static uint16_t readU16(const uint8_t *buffer) {
+    return buffer[0] | (buffer[1] << 8);
+}
+
+static uint32_t readU32(const uint8_t *buffer) {
+    return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+void setUp(void) {
+    Profiler::setTicksPerUs(1000);
+    Profiler::resetAll();
+}
+
+void tearDown(void) {}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_scope_accumulates(void) {
+    profiledWork(1000);
+    profiledWork(100000);
+    profiledWork(10);
+
+    Profiler::Site *site = findSite("work");
+    TEST_ASSERT_NOT_NULL(site);
+    TEST_ASSERT_EQUAL_UINT32(3, site->count);
+    TEST_ASSERT_TRUE(site->minTicks <= site->maxTicks);
+    TEST_ASSERT_TRUE(site->totalTicks >= site->maxTicks);
+    TEST_ASSERT_TRUE(site->totalTicks >= (uint64_t)site->minTicks * 3);
+
+    // El bucle largo domina
+    TEST_ASSERT_TRUE(site->maxTicks > site->totalTicks / 2);
+
+    site->reset();
+    TEST_ASSERT_EQUAL_UINT32(0, site->count);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, site->minTicks);
+}
+
+void test_site_registered_once(void) {
+    for (int i = 0; i < 50; i++) {
+        profiledWork(1);
+    }
+    TEST_ASSERT_EQUAL(1, countSites("work"));
+    TEST_ASSERT_EQUAL_UINT32(50, findSite("work")->count);
+}
+
+void test_concurrent_registration(void) {
+    // Cada hilo registra su propio sitio a la vez; ninguno se pierde
+    static Profiler::Site *sites[8];
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([i]() {
+            static const char *names[8] = {"t0", "t1", "t2", "t3", "t4", "t5", "t6", "t7"};
+            switch (i) {
+            case 0: { static Profiler::Site s(names[0]); sites[0] = &s; break; }
+            case 1: { static Profiler::Site s(names[1]); sites[1] = &s; break; }
+            case 2: { static Profiler::Site s(names[2]); sites[2] = &s; break; }
+            case 3: { static Profiler::Site s(names[3]); sites[3] = &s; break; }
+            case 4: { static Profiler::Site s(names[4]); sites[4] = &s; break; }
+            case 5: { static Profiler::Site s(names[5]); sites[5] = &s; break; }
+            case 6: { static Profiler::Site s(names[6]); sites[6] = &s; break; }
+            default: { static Profiler::Site s(names[7]); sites[7] = &s; break; }
+            }
+            for (int n = 0; n < 1000; n++) {
+                Profiler::Scope scope(*sites[i]);
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    char name[3] = "t0";
+    for (int i = 0; i < 8; i++) {
+        name[1] = '0' + i;
+        TEST_ASSERT_EQUAL(1, countSites(name));
+        TEST_ASSERT_EQUAL_UINT32(1000, findSite(name)->count);
+    }
+}
+
+void test_ticks_to_micros(void) {
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 2.5f, Profiler::toMicros(2500));
+
+    // En el dispositivo: ciclos de CCOUNT a 80 MHz
+    Profiler::setTicksPerUs(80);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 100.0f, Profiler::toMicros(8000));
+    Profiler::setTicksPerUs(0); // Ignorado
+    TEST_ASSERT_EQUAL_UINT32(80, Profiler::getTicksPerUs());
+}
+
+void test_summary_uplink(void) {
+    Profiler::Site *site = findSite("work");
+    TEST_ASSERT_NOT_NULL(site);
+    site->reset();
+    site->record(3000);
+    site->record(5000);
+
+    uint8_t sites = Profiler::siteCount();
+    uint8_t buffer[Profiler::SUMMARY_HEADER_SIZE + 16 * Profiler::SUMMARY_SITE_SIZE];
+    size_t length = Profiler::buildSummary(buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL(Profiler::SUMMARY_HEADER_SIZE + sites * Profiler::SUMMARY_SITE_SIZE, length);
+    TEST_ASSERT_EQUAL_HEX8(Profiler::SUMMARY_TYPE, buffer[0]);
+    TEST_ASSERT_EQUAL(sites, buffer[1]);
+
+    bool found = false;
+    for (uint8_t i = 0; i < sites; i++) {
+        const uint8_t *entry = &buffer[Profiler::SUMMARY_HEADER_SIZE + i * Profiler::SUMMARY_SITE_SIZE];
+        if (readU16(entry) == Profiler::nameHash("work")) {
+            TEST_ASSERT_EQUAL_UINT16(2, readU16(entry + 2));
+            TEST_ASSERT_EQUAL_UINT32(4, readU32(entry + 4)); // Media 4000 ns
+            TEST_ASSERT_EQUAL_UINT32(5, readU32(entry + 8)); // Máximo 5000 ns
+            found = true;
+        }
+    }
+    TEST_ASSERT_TRUE(found);
+
+    // Sin espacio se omiten sitios enteros
+    length = Profiler::buildSummary(buffer, Profiler::SUMMARY_HEADER_SIZE + Profiler::SUMMARY_SITE_SIZE + 5);
+    TEST_ASSERT_EQUAL(Profiler::SUMMARY_HEADER_SIZE + Profiler::SUMMARY_SITE_SIZE, length);
+    TEST_ASSERT_EQUAL(1, buffer[1]);
+    TEST_ASSERT_EQUAL(0, Profiler::buildSummary(buffer, 1));
+}
+
+void test_summary_in_chunks(void) {
+    // Más sitios de los que entran en un uplink de DR0
+    uint8_t total = Profiler::siteCount();
+    size_t perChunk = (PROFILER_CHUNK_SIZE - Profiler::SUMMARY_HEADER_SIZE) / Profiler::SUMMARY_SITE_SIZE;
+    TEST_ASSERT_TRUE(total > perChunk);
+
+    for (Profiler::Site *site = Profiler::first(); site; site = site->next) {
+        site->record(1000);
+    }
+
+    // El primer trozo se envía y se reinicia; el segundo falla y queda intacto
+    uint8_t buffer[PROFILER_CHUNK_SIZE];
+    Profiler::Site *cursor = Profiler::first();
+    Profiler::Site *chunk = cursor;
+    size_t length = Profiler::buildSummary(buffer, sizeof(buffer), cursor);
+    TEST_ASSERT_TRUE(length <= PROFILER_CHUNK_SIZE);
+    TEST_ASSERT_EQUAL(perChunk, buffer[1]);
+    TEST_ASSERT_NOT_NULL(cursor);
+    Profiler::reset(chunk, cursor);
+
+    uint8_t reset = 0, kept = 0;
+    for (Profiler::Site *site = Profiler::first(); site; site = site->next) {
+        site->count == 0 ? reset++ : kept++;
+    }
+    TEST_ASSERT_EQUAL(perChunk, reset);
+    TEST_ASSERT_EQUAL(total - perChunk, kept);
+
+    // Recorriendo todos los trozos cada sitio aparece una sola vez
+    uint8_t reported = 0, chunks = 0;
+    cursor = Profiler::first();
+    while (cursor) {
+        length = Profiler::buildSummary(buffer, sizeof(buffer), cursor);
+        TEST_ASSERT_TRUE(length <= PROFILER_CHUNK_SIZE);
+        reported += buffer[1];
+        chunks++;
+    }
+    TEST_ASSERT_EQUAL(total, reported);
+    TEST_ASSERT_EQUAL((total + perChunk - 1) / perChunk, chunks);
+}
+
+void test_format_line(void) {
+    Profiler::Site *site = findSite("work");
+    site->reset();
+
+    char line[112];
+    Profiler::format(*site, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("work: sin muestras", line);
+
+    site->record(40000);
+    site->record(320000);
+    Profiler::format(*site, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("work: n=2 media 180.0 us (min 40.0, max 320.0) total 0.4 ms", line);
+
+    char small[8];
+    TEST_ASSERT_EQUAL(sizeof(small) - 1, Profiler::format(*site, small, sizeof(small)));
+}
+
+void test_scope_overhead(void) {
+    const int calls = 200000;
+    profiledEmpty();
+
+    uint32_t start = Profiler::ticks();
+    for (int i = 0; i < calls; i++) {
+        profiledEmpty();
+    }
+    uint32_t elapsed = Profiler::ticks() - start;
+
+    Profiler::Site *site = findSite("empty");
+    TEST_ASSERT_EQUAL_UINT32(calls + 1, site->count);
+    printf("\nPROFILE_SCOPE vacío: %.1f ns por llamada (medido dentro del sitio: %.1f ns)\n",
+           (float)elapsed / calls, (float)site->totalTicks / site->count);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_scope_accumulates);
+    RUN_TEST(test_site_registered_once);
+    RUN_TEST(test_concurrent_registration);
+    RUN_TEST(test_ticks_to_micros);
+    RUN_TEST(test_summary_uplink);
+    RUN_TEST(test_summary_in_chunks);
+    RUN_TEST(test_format_line);
+    RUN_TEST(test_scope_overhead);
+    return UNITY_END();
+}
@@ -0,0 +1,271 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - RUNTIME (TAREAS Y COLAS)
+ * ============================================================================
+ * Colas de tamaño fijo y las cuatro tareas del collar sobre std::thread.
+ * La prueba de estrés bloquea la radio como un uplink real y verifica que
+ * la geocerca sigue evaluando cada posición a tiempo y en orden.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "system/Rtos.h"
+#include "system/Runtime.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// ============================================================================
+// COLAS
+// ============================================================================
+
+void test_queue_fifo_and_timeout(void) {
+    RtosQueue<int, 4> queue;
+    for (int i = 1; i <= 4; i++) {
+        TEST_ASSERT_TRUE(queue.send(i));
+    }
+    TEST_ASSERT_FALSE(queue.send(5));
+    TEST_ASSERT_EQUAL_UINT32(1, queue.getDropped());
+    TEST_ASSERT_EQUAL_UINT32(4, queue.getHighWater());
+
+    int value = 0;
+    for (int i = 1; i <= 4; i++) {
+        TEST_ASSERT_TRUE(queue.receive(value, 0));
+        TEST_ASSERT_EQUAL_INT(i, value);
+    }
+
+    uint32_t start = Rtos::millis();
+    TEST_ASSERT_FALSE(queue.receive(value, 30));
+    TEST_ASSERT_GREATER_OR_EQUAL(25, Rtos::millis() - start);
+}
+
+void test_send_latest_keeps_newest(void) {
+    RtosQueue<int, 3> queue;
+    for (int i = 1; i <= 5; i++) {
+        TEST_ASSERT_TRUE(queue.sendLatest(i));
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, queue.size());
+
+    int value = 0;
+    for (int i = 3; i <= 5; i++) {
+        queue.receive(value, 0);
+        TEST_ASSERT_EQUAL_INT(i, value);
+    }
+}
+
+void test_blocking_send_wakes_on_receive(void) {
+    RtosQueue<int, 1> queue;
+    queue.send(1);
+
+    std::atomic<bool> sent(false);
+    std::thread producer([&] {
+        queue.send(2, RTOS_WAIT_FOREVER);
+        sent = true;
+    });
+
+    Rtos::delayMs(20);
+    TEST_ASSERT_FALSE(sent.load());
+    int value = 0;
+    queue.receive(value);
+    producer.join();
+    TEST_ASSERT_TRUE(sent.load());
+    queue.receive(value, 0);
+    TEST_ASSERT_EQUAL_INT(2, value);
+}
+
+void test_multi_producer_stress(void) {
+    const uint32_t PRODUCERS = 4;
+    const uint32_t ITEMS = 20000;
+    RtosQueue<uint32_t, 8> queue;
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&queue, p, ITEMS] {
+            for (uint32_t i = 0; i < ITEMS; i++) {
+                queue.send((p << 24) | i, RTOS_WAIT_FOREVER);
+            }
+        });
+    }
+
+    // Cada productor debe llegar en orden y sin pérdidas
+    uint32_t next[PRODUCERS] = {0};
+    uint32_t received = 0;
+    bool ordered = true;
+    uint32_t item = 0;
+    while (received < PRODUCERS * ITEMS && queue.receive(item, 2000)) {
+        uint32_t p = item >> 24;
+        ordered = ordered && (item & 0xFFFFFF) == next[p];
+        next[p]++;
+        received++;
+    }
+    for (std::thread &producer : producers) {
+        producer.join();
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(PRODUCERS * ITEMS, received);
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_EQUAL_UINT32(0, queue.getDropped());
+    TEST_ASSERT_LESS_OR_EQUAL(8, queue.getHighWater());
+}
+
+// ============================================================================
+// RUNTIME CON HANDLERS SIMULADOS
+// ============================================================================
+
+class SimHandlers : public Runtime::Handlers {
+public:
+    Runtime *runtime = nullptr;
+    uint32_t radioBlockMs = 100;   // Duración de un uplink con RX1/RX2
+    uint32_t uiPeriodMs = 5;
+    uint32_t gpsFixLimit = UINT32_MAX;
+
+    std::atomic<uint32_t> gpsFixes{0};
+    std::atomic<uint32_t> evaluations{0};
+    std::atomic<uint32_t> radioHandled{0};
+    std::atomic<uint32_t> radioOutOfOrder{0};
+    std::atomic<uint32_t> alertEvents{0};
+    std::atomic<uint32_t> buttonEvents{0};
+    std::atomic<uint32_t> uiOutOfOrder{0};
+
+    bool pollGps(Position &position) override {
+        if (gpsFixes >= gpsFixLimit) {
+            return false;
+        }
+        uint32_t n = ++gpsFixes;
+        position.latitude = -33.0 + n * 1e-6;
+        position.longitude = -70.0;
+        position.valid = true;
+        return true;
+    }
+
+    AlertLevel evaluate(const Position &position, float &distance) override {
+        evaluations++;
+        distance = (float)((position.latitude + 33.0) * 1e6) - 500.0f;
+        return distance > 0 ? AlertLevel::WARNING : AlertLevel::SAFE;
+    }
+
+    void handleRadio(const Runtime::RadioRequest &request) override {
+        uint32_t id = request.payload[0] | (request.payload[1] << 8);
+        if (id != radioHandled) {
+            radioOutOfOrder++;
+        }
+        radioHandled++;
+        Rtos::delayMs(radioBlockMs);
+    }
+
+    uint32_t runUi() override {
+        // Encola uplinks mucho más rápido de lo que la radio los despacha
+        uint32_t now = Rtos::millis();
+        if (now - lastUplink >= uiPeriodMs) {
+            Runtime::RadioRequest request = {};
+            request.type = Runtime::RADIO_UPLINK;
+            request.payload[0] = nextRadioId & 0xFF;
+            request.payload[1] = nextRadioId >> 8;
+            request.length = 2;
+            if (runtime->postRadio(request)) {
+                nextRadioId++;
+            }
+            lastUplink = now;
+        }
+        return uiPeriodMs;
+    }
+
+    void onUiEvent(const Runtime::UiEvent &event) override {
+        if (event.type == Runtime::UI_BUTTON) {
+            buttonEvents++;
+            return;
+        }
+        if (event.sequence <= lastUiSequence) {
+            uiOutOfOrder++;
+        }
+        lastUiSequence = event.sequence;
+        alertEvents++;
+    }
+
+private:
+    uint32_t lastUplink = 0;
+    uint16_t nextRadioId = 0;
+    uint32_t lastUiSequence = 0;
+};
+
+void test_radio_does_not_delay_geofence(void) {
+    SimHandlers handlers;
+    Runtime::Config config;
+    config.gpsPollMs = 2;
+    config.geofenceIdleMs = 50;
+    config.uiMaxIdleMs = 10;
+    Runtime runtime(handlers, config);
+    handlers.runtime = &runtime;
+
+    TEST_ASSERT_TRUE(runtime.start());
+    for (int i = 0; i < 20; i++) {
+        Rtos::delayMs(50);
+        runtime.postUiEventFromIsr(Runtime::UI_BUTTON);
+    }
+    runtime.stop();
+    TEST_ASSERT_FALSE(runtime.isRunning());
+
+    Runtime::Stats stats = runtime.getStats();
+    printf("Fixes: %u publicadas, %u descartadas, %u evaluadas | latencia máx %u ms, media %.2f ms\n",
+           stats.fixesPublished, stats.fixesDropped, stats.fixesEvaluated, stats.maxFixLatency,
+           stats.fixesEvaluated ? (double)stats.totalFixLatency / stats.fixesEvaluated : 0.0);
+    printf("Radio: %u aceptadas, %u rechazadas, %u despachadas | UI: %u eventos, %u descartados\n",
+           stats.radioRequests, stats.radioRejected, stats.radioHandled, stats.uiEvents, stats.uiDropped);
+
+    // La geocerca no espera a la radio aunque esta bloquee 100 ms por uplink
+    TEST_ASSERT_GREATER_THAN(100, stats.fixesPublished);
+    TEST_ASSERT_LESS_THAN(50, stats.maxFixLatency);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.outOfOrder);
+    TEST_ASSERT_EQUAL_UINT32(stats.fixesPublished - stats.fixesDropped, stats.fixesEvaluated - stats.idleEvaluations);
+
+    // Todo lo aceptado por la radio se despacha en orden; el resto se rechaza sin bloquear a la UI
+    TEST_ASSERT_GREATER_THAN(0, stats.radioRejected);
+    TEST_ASSERT_EQUAL_UINT32(stats.radioRequests, stats.radioHandled);
+    TEST_ASSERT_EQUAL_UINT32(stats.radioHandled, handlers.radioHandled.load());
+    TEST_ASSERT_EQUAL_UINT32(0, handlers.radioOutOfOrder.load());
+
+    // Eventos de UI: todos los entregados llegan, en orden
+    TEST_ASSERT_EQUAL_UINT32(stats.uiEvents, handlers.alertEvents.load() + handlers.buttonEvents.load());
+    TEST_ASSERT_EQUAL_UINT32(0, handlers.uiOutOfOrder.load());
+    TEST_ASSERT_GREATER_THAN(0, handlers.buttonEvents.load());
+}
+
+void test_idle_reevaluation(void) {
+    SimHandlers handlers;
+    handlers.gpsFixLimit = 1;
+    handlers.uiPeriodMs = 1000;
+    Runtime::Config config;
+    config.gpsPollMs = 5;
+    config.geofenceIdleMs = 20;
+    Runtime runtime(handlers, config);
+    handlers.runtime = &runtime;
+
+    runtime.start();
+    Rtos::delayMs(250);
+    runtime.stop();
+
+    // Sin posiciones nuevas la geocerca se reevalúa sola para escalar alertas
+    Runtime::Stats stats = runtime.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.fixesPublished);
+    TEST_ASSERT_GREATER_OR_EQUAL(5, stats.idleEvaluations);
+    TEST_ASSERT_EQUAL_UINT32(stats.fixesEvaluated, handlers.evaluations.load());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_queue_fifo_and_timeout);
+    RUN_TEST(test_send_latest_keeps_newest);
+    RUN_TEST(test_blocking_send_wakes_on_receive);
+    RUN_TEST(test_multi_producer_stress);
+    RUN_TEST(test_radio_does_not_delay_geofence);
+    RUN_TEST(test_idle_reevaluation);
+    return UNITY_END();
+}
@@ -0,0 +1,273 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - SCHEDULER
+ * ============================================================================
+ * Orden por deadline y prioridad, agrupación por jitter, tareas de un
+ * disparo y desborde de millis(). Incluye una simulación de una hora del
+ * collar que compara despertares y latencia de la geocerca con el loop
+ * anterior (temporizadores lastXxx + delay(10)).
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "config/constants.h"
+#include "config/lorawan_config.h"
+#include "system/Scheduler.h"
+
+// ============================================================================
+// RELOJ SIMULADO
+// ============================================================================
+
+static uint32_t simNow = 0;
+
+static uint32_t simClock() {
+    return simNow;
+}
+
+static char trace[64];
+static uint8_t traceLen = 0;
+
+struct TraceTask {
+    char tag;
+    uint32_t durationMs;
+};
+
+static void traceTask(void *context) {
+    TraceTask *task = (TraceTask *)context;
+    if (traceLen < sizeof(trace) - 1) {
+        trace[traceLen++] = task->tag;
+        trace[traceLen] = '\0';
+    }
+    simNow += task->durationMs;
+}
+
+void setUp(void) {
+    simNow = 0;
+    traceLen = 0;
+    trace[0] = '\0';
+}
+
+void tearDown(void) {
+}
+
+// Avanza el reloj al próximo deadline y ejecuta lo vencido
+static uint8_t step(Scheduler &scheduler) {
+    uint32_t wait = scheduler.timeUntilNext();
+    if (wait != UINT32_MAX) {
+        simNow += wait;
+    }
+    return scheduler.runDue();
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_deadline_order(void) {
+    Scheduler scheduler(simClock);
+    TraceTask a = {'a', 0}, b = {'b', 0}, c = {'c', 0};
+    scheduler.addTask("a", traceTask, &a, 300);
+    scheduler.addTask("b", traceTask, &b, 100);
+    scheduler.addTask("c", traceTask, &c, 200);
+
+    TEST_ASSERT_EQUAL_UINT32(100, scheduler.timeUntilNext());
+    for (int i = 0; i < 6; i++) {
+        step(scheduler);
+    }
+    // t=100 b, 200 b c, 300 a b, 400 b c, 500 b, 600 a b c (empates: orden de registro)
+    TEST_ASSERT_EQUAL_STRING("bbcabbcbabc", trace);
+}
+
+void test_priority_within_pass(void) {
+    Scheduler scheduler(simClock);
+    TraceTask low = {'l', 0}, high = {'h', 0}, normal = {'n', 0};
+    scheduler.addTask("low", traceTask, &low, 1000, 0, Scheduler::PRIORITY_LOW);
+    scheduler.addTask("normal", traceTask, &normal, 1000, 0, Scheduler::PRIORITY_NORMAL);
+    scheduler.addTask("high", traceTask, &high, 1000, 0, Scheduler::PRIORITY_CRITICAL);
+
+    TEST_ASSERT_EQUAL_UINT8(3, step(scheduler));
+    TEST_ASSERT_EQUAL_STRING("hnl", trace);
+}
+
+void test_jitter_coalesces_wakeups(void) {
+    Scheduler scheduler(simClock);
+    TraceTask a = {'a', 0}, b = {'b', 0};
+    scheduler.addTask("a", traceTask, &a, 1000);
+    uint8_t idB = scheduler.addTask("b", traceTask, &b, 1000, 300, Scheduler::PRIORITY_NORMAL, 200);
+
+    // b vence en 1200 pero admite adelantarse 300 ms: corre junto con a en 1000
+    TEST_ASSERT_EQUAL_UINT8(2, step(scheduler));
+    TEST_ASSERT_EQUAL_UINT32(1000, simNow);
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.getStats(idB).earlyRuns);
+
+    // Mantiene su fase: el siguiente deadline es 2200, otra vez dentro de la ventana
+    TEST_ASSERT_EQUAL_UINT8(2, step(scheduler));
+    TEST_ASSERT_EQUAL_UINT32(2000, simNow);
+    TEST_ASSERT_EQUAL_UINT32(2, scheduler.getPasses());
+}
+
+void test_one_shot_and_enable(void) {
+    Scheduler scheduler(simClock);
+    TraceTask once = {'o', 0}, periodic = {'p', 0};
+    uint8_t idOnce = scheduler.addTask("once", traceTask, &once, 0);
+    uint8_t idPeriodic = scheduler.addTask("periodic", traceTask, &periodic, 500);
+
+    TEST_ASSERT_FALSE(scheduler.isEnabled(idOnce));
+    scheduler.schedule(idOnce, 50);
+    TEST_ASSERT_EQUAL_UINT32(50, scheduler.timeUntilNext());
+    step(scheduler);
+    TEST_ASSERT_FALSE(scheduler.isEnabled(idOnce));
+
+    scheduler.setEnabled(idPeriodic, false);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, scheduler.timeUntilNext());
+    scheduler.setEnabled(idPeriodic, true);
+    step(scheduler);
+    TEST_ASSERT_EQUAL_UINT32(550, simNow);
+    TEST_ASSERT_EQUAL_STRING("op", trace);
+}
+
+void test_overrun_skips_missed_periods(void) {
+    Scheduler scheduler(simClock);
+    TraceTask slow = {'s', 350}, fast = {'f', 0};
+    scheduler.addTask("slow", traceTask, &slow, 1000, 0, Scheduler::PRIORITY_HIGH);
+    uint8_t idFast = scheduler.addTask("fast", traceTask, &fast, 100);
+
+    step(scheduler); // t=100 f
+    step(scheduler); // t=200 f
+    // ...t=1000: slow (350 ms) bloquea a fast, que llega con 350 ms de retraso
+    while (simNow < 1000) {
+        step(scheduler);
+    }
+    TEST_ASSERT_EQUAL_UINT32(350, scheduler.getStats(idFast).maxLatency);
+    TEST_ASSERT_EQUAL_UINT32(3, scheduler.getStats(idFast).overruns);
+
+    // Sin ráfaga de recuperación: el siguiente fast es en 1400
+    TEST_ASSERT_EQUAL_UINT32(50, scheduler.timeUntilNext());
+}
+
+void test_millis_wraparound(void) {
+    simNow = 0xFFFFFF00UL;
+    Scheduler scheduler(simClock);
+    TraceTask a = {'a', 0};
+    scheduler.addTask("a", traceTask, &a, 0x200);
+
+    TEST_ASSERT_EQUAL_UINT32(0x200, scheduler.timeUntilNext());
+    TEST_ASSERT_EQUAL_UINT8(0, scheduler.runDue());
+    TEST_ASSERT_EQUAL_UINT8(1, step(scheduler));
+    TEST_ASSERT_EQUAL_HEX32(0x100, simNow);
+    TEST_ASSERT_EQUAL_UINT32(0x200, scheduler.timeUntilNext());
+}
+
+static Scheduler *selfScheduler = nullptr;
+static uint8_t selfId = 0;
+
+static void selfRescheduling(void *context) {
+    (void)context;
+    selfScheduler->schedule(selfId, 30);
+}
+
+void test_task_can_reschedule_itself(void) {
+    Scheduler scheduler(simClock);
+    selfScheduler = &scheduler;
+    selfId = scheduler.addTask("self", selfRescheduling, nullptr, 1000);
+
+    step(scheduler);
+    TEST_ASSERT_EQUAL_UINT32(1000, simNow);
+    TEST_ASSERT_EQUAL_UINT32(30, scheduler.timeUntilNext());
+}
+
+// ============================================================================
+// SIMULACIÓN DE UNA HORA DEL COLLAR
+// ============================================================================
+
+// Duraciones aproximadas de cada trabajo en el dispositivo
+struct CollarJob {
+    const char *name;
+    uint32_t periodMs;
+    uint32_t jitterMs;
+    uint8_t priority;
+    uint32_t durationMs;
+};
+
+static const CollarJob COLLAR_JOBS[] = {
+    {"geofence", GEOFENCE_CHECK_INTERVAL, 0, Scheduler::PRIORITY_CRITICAL, 2},
+    {"gps", GPS_UPDATE_INTERVAL, 500, Scheduler::PRIORITY_HIGH, 5},
+    {"lora", LORA_TX_INTERVAL, 5000, Scheduler::PRIORITY_NORMAL, 2000}, // TX + RX1/RX2
+    {"battery", BATTERY_CHECK_INTERVAL, 10000, Scheduler::PRIORITY_LOW, 10},
+    {"display", DISPLAY_UPDATE_INTERVAL, 1000, Scheduler::PRIORITY_LOW, 30},
+    {"serial", SERIAL_STATUS_INTERVAL, 5000, Scheduler::PRIORITY_LOW, 20},
+    {"heartbeat", HEARTBEAT_INTERVAL, 2000, Scheduler::PRIORITY_LOW, 1},
+    {"link", LINK_STATUS_INTERVAL, 60000, Scheduler::PRIORITY_LOW, 2000},
+};
+static const uint8_t COLLAR_JOB_COUNT = sizeof(COLLAR_JOBS) / sizeof(COLLAR_JOBS[0]);
+
+static void collarJob(void *context) {
+    simNow += ((const CollarJob *)context)->durationMs;
+}
+
+void test_simulated_hour(void) {
+    const uint32_t HOUR = 3600000;
+
+    // Loop anterior: cada temporizador se revisa en orden, la geocerca al
+    // final, y delay(10) por vuelta. El heartbeat bloqueaba 100 ms (blinkLED).
+    uint32_t last[COLLAR_JOB_COUNT] = {0};
+    uint32_t legacyWakeups = 0;
+    uint32_t legacyMaxLatency = 0;
+    simNow = 0;
+    while (simNow < HOUR) {
+        for (uint8_t i = 1; i <= COLLAR_JOB_COUNT; i++) {
+            uint8_t job = i % COLLAR_JOB_COUNT; // geocerca (0) al final
+            if (simNow - last[job] > COLLAR_JOBS[job].periodMs) {
+                if (job == 0 && simNow - last[0] - COLLAR_JOBS[0].periodMs > legacyMaxLatency) {
+                    legacyMaxLatency = simNow - last[0] - COLLAR_JOBS[0].periodMs;
+                }
+                simNow += strcmp(COLLAR_JOBS[job].name, "heartbeat") == 0 ? 100 : COLLAR_JOBS[job].durationMs;
+                last[job] = simNow;
+            }
+        }
+        simNow += 10;
+        legacyWakeups++;
+    }
+
+    // Scheduler: dormir hasta el próximo deadline
+    simNow = 0;
+    Scheduler scheduler(simClock);
+    for (uint8_t i = 0; i < COLLAR_JOB_COUNT; i++) {
+        scheduler.addTask(COLLAR_JOBS[i].name, collarJob, (void *)&COLLAR_JOBS[i], COLLAR_JOBS[i].periodMs,
+                          COLLAR_JOBS[i].jitterMs, COLLAR_JOBS[i].priority);
+    }
+    uint32_t wakeups = 0;
+    while (simNow < HOUR) {
+        step(scheduler);
+        wakeups++;
+    }
+
+    const Scheduler::TaskStats &geofence = scheduler.getStats(0);
+    printf("Loop anterior: %u despertares/h, latencia máx geocerca %u ms\n",
+           (unsigned)legacyWakeups, (unsigned)legacyMaxLatency);
+    printf("Scheduler:     %u despertares/h, latencia máx geocerca %u ms (media %u ms, %u ejecuciones)\n",
+           (unsigned)wakeups, (unsigned)geofence.maxLatency,
+           (unsigned)(geofence.totalLatency / geofence.runs), (unsigned)geofence.runs);
+
+    TEST_ASSERT_EQUAL_UINT32(HOUR / GEOFENCE_CHECK_INTERVAL, geofence.runs);
+    TEST_ASSERT_LESS_THAN(legacyWakeups / 100, wakeups);
+    TEST_ASSERT_LESS_OR_EQUAL(legacyMaxLatency, geofence.maxLatency);
+    // Peor caso acotado por el trabajo más largo que no es la geocerca (uplink)
+    TEST_ASSERT_LESS_OR_EQUAL(2000, geofence.maxLatency);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_deadline_order);
+    RUN_TEST(test_priority_within_pass);
+    RUN_TEST(test_jitter_coalesces_wakeups);
+    RUN_TEST(test_one_shot_and_enable);
+    RUN_TEST(test_overrun_skips_missed_periods);
+    RUN_TEST(test_millis_wraparound);
+    RUN_TEST(test_task_can_reschedule_itself);
+    RUN_TEST(test_simulated_hour);
+    return UNITY_END();
+}
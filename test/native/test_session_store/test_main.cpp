@@ -0,0 +1,322 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - SESSION STORE
+ * ============================================================================
+ * Verifica la persistencia incremental de la sesión LoRaWAN y mide las
+ * escrituras NVS cada 10.000 uplinks frente al esquema anterior (buffers
+ * completos cada 2 uplinks, un namespace por buffer).
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "system/SessionStore.h"
+
+// Tamaños representativos de los buffers de RadioLib 6.x
+static const size_t NONCES_SIZE = 16;
+static const size_t SESSION_SIZE = 448;
+static const size_t FCNT_OFFSET = 64;
+static const size_t SIGNATURE_OFFSET = SESSION_SIZE - 2;
+static const uint32_t UPLINKS = 10000;
+
+// ============================================================================
+// BACKEND EN RAM CON CONTADORES
+// ============================================================================
+
+class RamBackend : public SessionStore::Backend
+{
+public:
+    std::map<std::string, std::vector<uint8_t>> data;
+    uint32_t writes = 0;
+    uint32_t bytes = 0;
+    uint32_t opens = 0;
+    bool failWrites = false;
+
+    bool begin(bool readOnly) override
+    {
+        opens++;
+        return true;
+    }
+    void end() override {}
+
+    size_t read(const char *key, uint8_t *buffer, size_t length) override
+    {
+        auto it = data.find(key);
+        if (it == data.end())
+            return 0;
+        size_t n = it->second.size() < length ? it->second.size() : length;
+        memcpy(buffer, it->second.data(), n);
+        return n;
+    }
+
+    size_t write(const char *key, const uint8_t *buf, size_t length) override
+    {
+        if (failWrites)
+            return 0;
+        writes++;
+        bytes += length;
+        data[key].assign(buf, buf + length);
+        return length;
+    }
+
+    void clear() override { data.clear(); }
+};
+
+// ============================================================================
+// SIMULACIÓN DE LA SESIÓN DE RADIOLIB
+// ============================================================================
+
+static uint8_t nonces[NONCES_SIZE];
+static uint8_t session[SESSION_SIZE];
+
+static void setFcnt(uint32_t fcnt);
+
+static void resetBuffers() {
+    for (size_t i = 0; i < NONCES_SIZE; i++)
+        nonces[i] = (uint8_t)(0xA0 + i);
+    for (size_t i = 0; i < SESSION_SIZE; i++)
+        session[i] = (uint8_t)(i * 7);
+    setFcnt(0);
+}
+
+static void setFcnt(uint32_t fcnt) {
+    memcpy(&session[FCNT_OFFSET], &fcnt, 4);
+    session[SIGNATURE_OFFSET] = (uint8_t)(fcnt * 31);
+    session[SIGNATURE_OFFSET + 1] = (uint8_t)(fcnt >> 3);
+}
+
+static uint32_t getFcnt(const uint8_t *buf) {
+    uint32_t fcnt;
+    memcpy(&fcnt, &buf[FCNT_OFFSET], 4);
+    return fcnt;
+}
+
+// Comandos MAC ocasionales (ADR) cambian unos pocos bytes de estado
+static void applyMacCommand(uint32_t fcnt) {
+    session[200] = (uint8_t)fcnt;
+    session[201] = (uint8_t)(fcnt >> 8);
+}
+
+static void configure(SessionStore &store) {
+    store.addVolatileRegion(SessionStore::BLOB_SESSION, FCNT_OFFSET, 4);
+    store.addVolatileRegion(SessionStore::BLOB_SESSION, SIGNATURE_OFFSET, 2);
+}
+
+static void uplink(SessionStore &store, uint32_t fcnt) {
+    setFcnt(fcnt);
+    if (fcnt % 500 == 0)
+        applyMacCommand(fcnt);
+    store.stage(SessionStore::BLOB_NONCES, nonces, NONCES_SIZE);
+    store.stage(SessionStore::BLOB_SESSION, session, SESSION_SIZE);
+    TEST_ASSERT_TRUE(store.commitUplink(fcnt));
+}
+
+void setUp() {
+    resetBuffers();
+}
+
+void tearDown() {}
+
+// ============================================================================
+// BENCHMARK DE ESCRITURAS
+// ============================================================================
+
+void test_benchmark_writes_per_10k_uplinks() {
+    // Esquema anterior: ambos buffers completos cada 2 uplinks
+    RamBackend legacy;
+    for (uint32_t fcnt = 1; fcnt <= UPLINKS; fcnt++) {
+        setFcnt(fcnt);
+        if (fcnt % 2 == 0) {
+            legacy.begin(false);
+            legacy.write("nonces_buf", nonces, NONCES_SIZE);
+            legacy.end();
+            legacy.begin(false);
+            legacy.write("session_buf", session, SESSION_SIZE);
+            legacy.end();
+        }
+    }
+
+    // Esquema nuevo
+    resetBuffers();
+    RamBackend backend;
+    SessionStore store(backend, 16, 16);
+    configure(store);
+    store.stage(SessionStore::BLOB_NONCES, nonces, NONCES_SIZE);
+    store.stage(SessionStore::BLOB_SESSION, session, SESSION_SIZE);
+    TEST_ASSERT_TRUE(store.startSession(0));
+    store.resetStats();
+    backend.writes = backend.bytes = backend.opens = 0;
+
+    for (uint32_t fcnt = 1; fcnt <= UPLINKS; fcnt++) {
+        uplink(store, fcnt);
+    }
+
+    printf("\n[SessionStore] %u uplinks\n", (unsigned)UPLINKS);
+    printf("  antes:   %6u escrituras, %8u bytes, %6u aperturas\n",
+           (unsigned)legacy.writes, (unsigned)legacy.bytes, (unsigned)legacy.opens);
+    printf("  despues: %6u escrituras, %8u bytes, %6u aperturas\n",
+           (unsigned)backend.writes, (unsigned)backend.bytes, (unsigned)backend.opens);
+
+    TEST_ASSERT_EQUAL_UINT32(backend.writes, store.getStats().writes);
+    TEST_ASSERT_EQUAL_UINT32(backend.bytes, store.getStats().bytesWritten);
+    TEST_ASSERT_LESS_THAN_UINT32(legacy.writes / 4, backend.writes);
+    TEST_ASSERT_LESS_THAN_UINT32(legacy.bytes / 20, backend.bytes);
+    TEST_ASSERT_FALSE(store.hasPendingChanges());
+}
+
+// ============================================================================
+// TESTS DE CORRECCIÓN
+// ============================================================================
+
+void test_only_dirty_blocks_written() {
+    RamBackend backend;
+    SessionStore store(backend, 16, 1);
+    configure(store);
+    store.stage(SessionStore::BLOB_NONCES, nonces, NONCES_SIZE);
+    store.stage(SessionStore::BLOB_SESSION, session, SESSION_SIZE);
+    TEST_ASSERT_TRUE(store.startSession(0));
+    store.resetStats();
+
+    // Solo cambia el FCnt: nada que escribir
+    setFcnt(1);
+    store.stage(SessionStore::BLOB_SESSION, session, SESSION_SIZE);
+    TEST_ASSERT_FALSE(store.hasPendingChanges());
+
+    // Un byte fuera de la región volátil: un solo bloque
+    session[300] ^= 0xFF;
+    store.stage(SessionStore::BLOB_SESSION, session, SESSION_SIZE);
+    TEST_ASSERT_TRUE(store.flush(1));
+    TEST_ASSERT_EQUAL_UINT32(1, store.getStats().blockWrites);
+}
+
+void test_restore_jumps_past_last_uplink() {
+    RamBackend backend;
+    {
+        SessionStore store(backend, 16, 16);
+        configure(store);
+        store.stage(SessionStore::BLOB_NONCES, nonces, NONCES_SIZE);
+        store.stage(SessionStore::BLOB_SESSION, session, SESSION_SIZE);
+        TEST_ASSERT_TRUE(store.startSession(0));
+        for (uint32_t fcnt = 1; fcnt <= 1234; fcnt++) {
+            uplink(store, fcnt);
+        }
+    }
+
+    // Reinicio: el FCnt restaurado nunca puede repetir uno ya enviado
+    SessionStore restored(backend, 16, 16);
+    configure(restored);
+    TEST_ASSERT_TRUE(restored.begin());
+    TEST_ASSERT_GREATER_THAN_UINT32(1234, restored.restoredFrameCounter());
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(1234 + 16, restored.restoredFrameCounter());
+
+    uint8_t buf[SESSION_SIZE];
+    TEST_ASSERT_TRUE(restored.load(SessionStore::BLOB_SESSION, buf, SESSION_SIZE));
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(1234, getFcnt(buf));
+    TEST_ASSERT_EQUAL_UINT8(session[200], buf[200]);
+    TEST_ASSERT_FALSE(restored.load(SessionStore::BLOB_SESSION, buf, SESSION_SIZE - 1));
+}
+
+void test_restore_is_monotonic_across_reboots() {
+    RamBackend backend;
+    uint32_t fcnt = 0;
+    uint32_t lastSent = 0;
+
+    SessionStore first(backend, 16, 16);
+    configure(first);
+    first.stage(SessionStore::BLOB_NONCES, nonces, NONCES_SIZE);
+    first.stage(SessionStore::BLOB_SESSION, session, SESSION_SIZE);
+    TEST_ASSERT_TRUE(first.startSession(0));
+
+    // Reinicios en puntos arbitrarios sin guardar nada extra
+    for (uint32_t reboot = 0; reboot < 50; reboot++) {
+        SessionStore store(backend, 16, 16);
+        configure(store);
+        TEST_ASSERT_TRUE(store.begin());
+        fcnt = store.restoredFrameCounter();
+        TEST_ASSERT_GREATER_THAN_UINT32(lastSent, fcnt);
+
+        uint32_t sends = (reboot * 7) % 40;
+        for (uint32_t i = 0; i < sends; i++) {
+            lastSent = fcnt;
+            uplink(store, fcnt++);
+        }
+    }
+}
+
+void test_new_session_resets_counter_log() {
+    RamBackend backend;
+    {
+        SessionStore store(backend, 16, 16);
+        configure(store);
+        store.stage(SessionStore::BLOB_NONCES, nonces, NONCES_SIZE);
+        store.stage(SessionStore::BLOB_SESSION, session, SESSION_SIZE);
+        TEST_ASSERT_TRUE(store.startSession(0));
+        for (uint32_t fcnt = 1; fcnt <= 5000; fcnt++) {
+            uplink(store, fcnt);
+        }
+
+        // Nuevo JOIN: el FCnt vuelve a 0 y las entradas viejas desaparecen
+        nonces[0] ^= 0x55;
+        setFcnt(0);
+        store.stage(SessionStore::BLOB_NONCES, nonces, NONCES_SIZE);
+        store.stage(SessionStore::BLOB_SESSION, session, SESSION_SIZE);
+        TEST_ASSERT_TRUE(store.startSession(0));
+    }
+
+    SessionStore restored(backend, 16, 16);
+    TEST_ASSERT_TRUE(restored.begin());
+    TEST_ASSERT_EQUAL_UINT32(16, restored.restoredFrameCounter());
+
+    uint8_t buf[NONCES_SIZE];
+    TEST_ASSERT_TRUE(restored.load(SessionStore::BLOB_NONCES, buf, NONCES_SIZE));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(nonces, buf, NONCES_SIZE);
+}
+
+void test_failed_write_keeps_changes_pending() {
+    RamBackend backend;
+    SessionStore store(backend, 16, 1);
+    configure(store);
+    store.stage(SessionStore::BLOB_NONCES, nonces, NONCES_SIZE);
+    store.stage(SessionStore::BLOB_SESSION, session, SESSION_SIZE);
+    TEST_ASSERT_TRUE(store.startSession(0));
+
+    session[10] ^= 0xFF;
+    store.stage(SessionStore::BLOB_SESSION, session, SESSION_SIZE);
+    backend.failWrites = true;
+    TEST_ASSERT_FALSE(store.flush(1));
+    TEST_ASSERT_TRUE(store.hasPendingChanges());
+
+    backend.failWrites = false;
+    TEST_ASSERT_TRUE(store.flush(1));
+    TEST_ASSERT_FALSE(store.hasPendingChanges());
+}
+
+void test_empty_store_has_no_session() {
+    RamBackend backend;
+    SessionStore store(backend);
+    TEST_ASSERT_FALSE(store.begin());
+    TEST_ASSERT_FALSE(store.hasSession());
+}
+
+// ============================================================================
+// RUNNER DE TESTS
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_benchmark_writes_per_10k_uplinks);
+    RUN_TEST(test_only_dirty_blocks_written);
+    RUN_TEST(test_restore_jumps_past_last_uplink);
+    RUN_TEST(test_restore_is_monotonic_across_reboots);
+    RUN_TEST(test_new_session_resets_counter_log);
+    RUN_TEST(test_failed_write_keeps_changes_pending);
+    RUN_TEST(test_empty_store_has_no_session);
+
+    return UNITY_END();
+}
@@ -0,0 +1,376 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - SLEEP CYCLE (DEEP SLEEP CON ESTADO EN RTC)
+ * ============================================================================
+ * Validez del snapshot retenido, filtro de entrada/salida del modo ciclo,
+ * sesión, geocerca y estado de carga restaurados tal cual, y contabilidad de
+ * arranque→fix y energía por despertar comparada con el modo continuo.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "config/constants.h"
+#include "system/SleepCycle.h"
+#include "system/EnergyModel.h"
+
+static SleepCycle::Snapshot snapshot;
+
+void setUp(void) {
+    memset(&snapshot, 0xA5, sizeof(snapshot)); // RTC memory sin inicializar
+}
+
+void tearDown(void) {
+}
+
+// ============================================================================
+// VALIDEZ DEL SNAPSHOT
+// ============================================================================
+
+void test_snapshot_seal_and_corruption(void) {
+    SleepCycle cycle(snapshot);
+    TEST_ASSERT_FALSE(cycle.resume());
+
+    cycle.reset();
+    TEST_ASSERT_FALSE(cycle.resume());
+
+    uint8_t nonces[16] = {1, 2, 3};
+    uint8_t session[448] = {9, 8, 7};
+    TEST_ASSERT_TRUE(cycle.storeSession(nonces, sizeof(nonces), session, sizeof(session)));
+    cycle.seal();
+    TEST_ASSERT_TRUE(cycle.resume());
+
+    // Un bit cambiado en la sesión invalida todo
+    snapshot.session[100] ^= 0x01;
+    TEST_ASSERT_FALSE(cycle.resume());
+    snapshot.session[100] ^= 0x01;
+    TEST_ASSERT_TRUE(cycle.resume());
+
+    snapshot.version = SleepCycle::VERSION + 1;
+    TEST_ASSERT_FALSE(cycle.resume());
+}
+
+// ============================================================================
+// FILTRO DE ENTRADA Y SALIDA
+// ============================================================================
+
+void test_filter_needs_consecutive_safe_fixes(void) {
+    SleepCycle cycle(snapshot);
+    cycle.reset();
+
+    TEST_ASSERT_EQUAL_UINT32(0, cycle.onFix(-100.0f, AlertLevel::SAFE));
+    TEST_ASSERT_EQUAL_UINT32(0, cycle.onFix(-100.0f, AlertLevel::SAFE));
+    TEST_ASSERT_EQUAL_UINT32(85000, cycle.onFix(-100.0f, AlertLevel::SAFE));
+
+    // Cerca del borde se corta la racha y hay que volver a juntarla
+    TEST_ASSERT_EQUAL_UINT32(0, cycle.onFix(-40.0f, AlertLevel::SAFE));
+    TEST_ASSERT_EQUAL_UINT32(0, cycle.onFix(-100.0f, AlertLevel::SAFE));
+    TEST_ASSERT_EQUAL_UINT32(0, cycle.onFix(-100.0f, AlertLevel::SAFE));
+    TEST_ASSERT_EQUAL_UINT32(85000, cycle.onFix(-100.0f, AlertLevel::SAFE));
+
+    // Una alerta también, aunque la distancia sea grande
+    TEST_ASSERT_EQUAL_UINT32(0, cycle.onFix(-100.0f, AlertLevel::WARNING));
+    TEST_ASSERT_EQUAL_UINT8(0, snapshot.safeStreak);
+}
+
+void test_sleep_duration_keeps_caution_zone_out_of_reach(void) {
+    SleepCycle cycle(snapshot);
+    const SleepCycle::Policy &policy = cycle.getPolicy();
+
+    // (distancia - precaución) / velocidad, acotado
+    TEST_ASSERT_EQUAL_UINT32(45000, cycle.sleepDuration(-60.0f));
+    TEST_ASSERT_EQUAL_UINT32(policy.maxSleepMs, cycle.sleepDuration(-5000.0f));
+    TEST_ASSERT_EQUAL_UINT32(0, cycle.sleepDuration(-40.0f)); // 25 s < minSleepMs
+    TEST_ASSERT_EQUAL_UINT32(0, cycle.sleepDuration(10.0f));
+
+    // Lo que camina dormido nunca lo deja dentro de la zona de precaución
+    for (float d = -policy.minInsideMeters; d > -2000.0f; d -= 7.3f) {
+        uint32_t ms = cycle.sleepDuration(d);
+        float walked = policy.animalSpeed * ms / 1000.0f;
+        TEST_ASSERT_TRUE(-d - walked >= policy.cautionMeters - 0.01f);
+    }
+}
+
+// ============================================================================
+// SESIÓN Y GEOCERCA
+// ============================================================================
+
+void test_session_round_trip(void) {
+    SleepCycle cycle(snapshot);
+    cycle.reset();
+    TEST_ASSERT_FALSE(cycle.hasSession());
+
+    uint8_t nonces[16];
+    uint8_t session[448];
+    for (size_t i = 0; i < sizeof(session); i++) {
+        session[i] = (uint8_t)(i * 7);
+    }
+    memset(nonces, 0x3C, sizeof(nonces));
+    TEST_ASSERT_TRUE(cycle.storeSession(nonces, sizeof(nonces), session, sizeof(session)));
+
+    uint8_t outNonces[16] = {0};
+    uint8_t outSession[448] = {0};
+    TEST_ASSERT_TRUE(cycle.loadSession(outNonces, sizeof(outNonces), outSession, sizeof(outSession)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(nonces, outNonces, sizeof(nonces));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(session, outSession, sizeof(session));
+
+    // Otra versión de RadioLib (otro tamaño de buffer): no se reutiliza
+    TEST_ASSERT_FALSE(cycle.loadSession(outNonces, sizeof(outNonces), outSession, 400));
+
+    uint8_t tooBig[SleepCycle::MAX_SESSION + 1] = {0};
+    TEST_ASSERT_FALSE(cycle.storeSession(nonces, sizeof(nonces), tooBig, sizeof(tooBig)));
+    TEST_ASSERT_FALSE(cycle.hasSession());
+}
+
+void test_geofence_round_trip(void) {
+    SleepCycle cycle(snapshot);
+    cycle.reset();
+
+    // Potrero de 120 vértices (vértices externos al Geofence)
+    static GeoPoint points[120];
+    for (int i = 0; i < 120; i++) {
+        double angle = 2.0 * M_PI * i / 120;
+        points[i] = GeoPoint(-33.4500 + 0.002 * sin(angle), -70.6600 + 0.003 * cos(angle));
+    }
+    Geofence polygon(points, 120, "Potrero norte", "piño-7");
+    polygon.fenceId = 42;
+    polygon.version = 9;
+    TEST_ASSERT_TRUE(cycle.storeGeofence(polygon));
+
+    static GeoPoint restored[GEOFENCE_MAX_VERTICES];
+    Geofence fence;
+    TEST_ASSERT_TRUE(cycle.loadGeofence(fence, restored, GEOFENCE_MAX_VERTICES));
+    TEST_ASSERT_TRUE(fence.type == GeofenceType::POLYGON);
+    TEST_ASSERT_TRUE(fence.isConfigured);
+    TEST_ASSERT_EQUAL_UINT16(120, fence.pointCount);
+    TEST_ASSERT_EQUAL_UINT16(42, fence.fenceId);
+    TEST_ASSERT_EQUAL_UINT8(9, fence.version);
+    TEST_ASSERT_EQUAL_STRING("Potrero norte", fence.name);
+    TEST_ASSERT_EQUAL_STRING("piño-7", fence.groupId);
+    TEST_ASSERT_TRUE(fence.getPoints() == restored);
+    for (int i = 0; i < 120; i++) {
+        TEST_ASSERT_TRUE(fabs(restored[i].lat - points[i].lat) <= 0.6e-7);
+        TEST_ASSERT_TRUE(fabs(restored[i].lng - points[i].lng) <= 0.6e-7);
+    }
+
+    // Si no cabe en el buffer de destino no se restaura a medias
+    TEST_ASSERT_FALSE(cycle.loadGeofence(fence, restored, 100));
+
+    // Círculo
+    Geofence circle(-33.45, -70.66, 250.0f, "Corral", "none");
+    TEST_ASSERT_TRUE(cycle.storeGeofence(circle));
+    TEST_ASSERT_TRUE(cycle.loadGeofence(fence, restored, GEOFENCE_MAX_VERTICES));
+    TEST_ASSERT_TRUE(fence.type == GeofenceType::CIRCLE);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 250.0f, fence.radius);
+    TEST_ASSERT_TRUE(fabs(fence.centerLat + 33.45) < 1e-7);
+
+    // Sin geocerca configurada no hay nada que restaurar
+    TEST_ASSERT_FALSE(cycle.storeGeofence(Geofence()));
+    TEST_ASSERT_FALSE(cycle.loadGeofence(fence, restored, GEOFENCE_MAX_VERTICES));
+}
+
+// ============================================================================
+// MÉTRICAS Y ENERGÍA
+// ============================================================================
+
+void test_wake_accounting(void) {
+    SleepCycle cycle(snapshot);
+    cycle.reset();
+
+    cycle.recordWake(1800, 2000, 0, 0.0f);
+    cycle.recordSleep(60000);
+    cycle.recordWake(0, DEEP_SLEEP_FIX_TIMEOUT, 0, 0.0f);
+
+    const SleepCycle::Stats &stats = cycle.getStats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.cycles);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.fixes);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.fixTimeouts);
+    TEST_ASSERT_EQUAL_UINT32(1800, stats.maxBootToFixMs);
+    TEST_ASSERT_EQUAL_UINT32(2000 + DEEP_SLEEP_FIX_TIMEOUT, stats.totalAwakeMs);
+
+    // 2 s despierto a 22 + 25 + 0,5 mA
+    EnergyModel::Currents currents;
+    float expected = 2000 * (currents.cpuActive80 + currents.gps + currents.board) / 3600000.0f;
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, expected, stats.totalWakeMah - stats.lastWakeMah);
+
+    // El uplink toca cuando se junta el intervalo entre sueño y vigilia
+    TEST_ASSERT_TRUE(cycle.uplinkDue());
+    cycle.uplinkSent();
+    TEST_ASSERT_FALSE(cycle.uplinkDue());
+    TEST_ASSERT_EQUAL_UINT32(1, stats.uplinks);
+}
+
+void test_wake_without_uplink_keeps_session(void) {
+    SleepCycle cycle(snapshot);
+    cycle.reset();
+
+    // Primer sueño: sesión exportada tras el uplink
+    uint8_t nonces[16];
+    uint8_t session[448];
+    for (size_t i = 0; i < sizeof(session); i++) {
+        session[i] = (uint8_t)(i * 13);
+    }
+    memset(nonces, 0x5A, sizeof(nonces));
+    TEST_ASSERT_TRUE(cycle.storeSession(nonces, sizeof(nonces), session, sizeof(session)));
+    cycle.uplinkSent();
+    cycle.recordSleep(DEEP_SLEEP_MIN_MS);
+    cycle.seal();
+
+    // Despertar corto: no toca uplink, la radio no se inicializa y
+    // enterSleepCycle guarda geocerca y posición pero no exporta la sesión
+    TEST_ASSERT_TRUE(cycle.resume());
+    cycle.recordWake(1500, 2000, 0, 0.0f);
+    TEST_ASSERT_FALSE(cycle.uplinkDue());
+
+    Geofence fence(-33.45, -70.66, 500.0f, "Potrero", "A");
+    TEST_ASSERT_TRUE(cycle.storeGeofence(fence));
+    Position position;
+    position.latitude = -33.45;
+    position.longitude = -70.66;
+    position.valid = true;
+    cycle.storePosition(position);
+    TEST_ASSERT_TRUE(cycle.hasSession());
+    cycle.recordSleep(DEEP_SLEEP_MIN_MS);
+    cycle.seal();
+
+    // El siguiente despertar retoma el ciclo con la misma sesión y ya toca uplink
+    TEST_ASSERT_TRUE(cycle.resume());
+    uint8_t outNonces[16] = {0};
+    uint8_t outSession[448] = {0};
+    TEST_ASSERT_TRUE(cycle.loadSession(outNonces, sizeof(outNonces), outSession, sizeof(outSession)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(nonces, outNonces, sizeof(nonces));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(session, outSession, sizeof(session));
+    TEST_ASSERT_TRUE(cycle.uplinkDue());
+}
+
+void test_battery_state_round_trip(void) {
+    SleepCycle cycle(snapshot);
+    cycle.reset();
+    BatteryEstimator::State state;
+    TEST_ASSERT_FALSE(cycle.loadBattery(state));
+
+    // Antes de dormir: anclado en reposo y con consumo contado
+    BatteryEstimator awake;
+    awake.addRestVoltage(3.9f);
+    awake.addConsumption(0.5f, 60000);
+    cycle.storeBattery(awake.getState());
+    cycle.seal();
+
+    // Al despertar no hay lectura en reposo: la autonomía sale del estado retenido
+    TEST_ASSERT_TRUE(cycle.resume());
+    TEST_ASSERT_TRUE(cycle.loadBattery(state));
+    BatteryEstimator resumed;
+    resumed.restore(state);
+    TEST_ASSERT_TRUE(resumed.isReady());
+    TEST_ASSERT_EQUAL_FLOAT(awake.getSoc(), resumed.getSoc());
+    TEST_ASSERT_EQUAL_FLOAT(awake.getUncertainty(), resumed.getUncertainty());
+    TEST_ASSERT_EQUAL_UINT16(awake.getRemainingHours(), resumed.getRemainingHours());
+    TEST_ASSERT_NOT_EQUAL(BatteryEstimator::RUNTIME_UNKNOWN, resumed.getRemainingHours());
+}
+
+// Un día en un potrero de 500 m de radio: la cabra pasta a 0,05 m/s con
+// rumbo aleatorio y el collar solo despierta para medir y, si toca, enviar
+static uint32_t rngState = 12345;
+static float randomUnit(void) {
+    rngState = rngState * 1103515245 + 12345;
+    return ((rngState >> 8) & 0xFFFF) / 65536.0f;
+}
+
+void test_simulated_day_vs_continuous(void) {
+    SleepCycle cycle(snapshot);
+    cycle.reset();
+
+    const float RADIUS = 500.0f;
+    const uint32_t BOOT_TO_FIX_MS = 1500; // Hot start con el backup del GPS
+    const uint32_t AFTER_FIX_MS = 150;    // Geocerca, snapshot y entrada al sueño
+    const uint32_t UPLINK_MS = 2100;      // TX + ventanas RX1/RX2
+    const float airtime = EnergyModel::loraAirtimeMs(10, 125, 25);
+
+    float x = 0.0f, y = 0.0f;
+    uint64_t elapsedMs = 0;
+    uint32_t uplinksInCycle = 0;
+    uint32_t normalFixes = 0;
+
+    while (elapsedMs < 86400000ULL) {
+        float distance = sqrtf(x * x + y * y) - RADIUS;
+        uint32_t sleepMs = cycle.onFix(distance, AlertLevel::SAFE);
+        uint32_t awake = BOOT_TO_FIX_MS + AFTER_FIX_MS;
+
+        if (sleepMs == 0) {
+            // Fuera del modo ciclo: una posición cada GPS_UPDATE_INTERVAL
+            normalFixes++;
+            sleepMs = GPS_UPDATE_INTERVAL;
+        } else {
+            uint32_t radioMs = 0;
+            float air = 0.0f;
+            if (cycle.uplinkDue()) {
+                radioMs = UPLINK_MS;
+                air = airtime;
+                cycle.uplinkSent();
+                uplinksInCycle++;
+            }
+            cycle.recordWake(BOOT_TO_FIX_MS, awake + radioMs, radioMs, air);
+            cycle.recordSleep(sleepMs);
+        }
+
+        // El animal camina durante todo el intervalo, con rumbo aleatorio
+        float heading = randomUnit() * 2.0f * (float)M_PI;
+        float walked = 0.05f * (sleepMs + awake) / 1000.0f;
+        x += walked * cosf(heading);
+        y += walked * sinf(heading);
+        elapsedMs += sleepMs + awake;
+    }
+
+    const SleepCycle::Stats &stats = cycle.getStats();
+    float cycleMah = cycle.averageMahPerDay();
+
+    // Modo continuo con light sleep y la pantalla apagada, para comparar solo CPU+GPS+radio
+    EnergyModel model;
+    EnergyModel::Profile continuous;
+    continuous.cpuMhz = LOW_POWER_CPU_MHZ;
+    continuous.dynamicFrequency = true;
+    continuous.lightSleep = true;
+    continuous.awakeIdleSeconds = 86400.0f * 0.52f;
+    continuous.wakeups = 86400 * 5;
+    continuous.cpuActiveSeconds = 500.0f;
+    continuous.radioTxSeconds = 1440 * airtime / 1000.0f;
+    continuous.radioRxSeconds = 1440 * 2 * 8 * EnergyModel::loraSymbolMs(10, 125) / 1000.0f;
+    continuous.displayOnSeconds = 0.0f;
+    EnergyModel::Breakdown continuousResult = model.estimate(continuous);
+
+    printf("Ciclos: %u (%u fixes normales) | uplinks %u | sueño medio %.1f s | despierto medio %.0f ms\n",
+           stats.cycles, normalFixes, uplinksInCycle,
+           stats.cycles ? stats.totalSleepMs / 1000.0 / stats.cycles : 0.0,
+           stats.cycles ? (double)stats.totalAwakeMs / stats.cycles : 0.0);
+    printf("Arranque→fix %u ms (máx %u) | energía por despertar %.4f mAh (último)\n",
+           stats.lastBootToFixMs, stats.maxBootToFixMs, stats.lastWakeMah);
+    printf("Modo ciclo %.1f mAh/día vs continuo con light sleep %.1f mAh/día\n", cycleMah, continuousResult.total);
+
+    TEST_ASSERT_GREATER_THAN(100, stats.cycles);
+    TEST_ASSERT_EQUAL_UINT32(stats.cycles, stats.fixes);
+    TEST_ASSERT_TRUE(cycleMah > 0.0f);
+    TEST_ASSERT_TRUE(cycleMah < continuousResult.total / 3.0f);
+
+    // Persistió en el snapshot: sellado, sobrevive a la verificación
+    cycle.seal();
+    SleepCycle resumed(snapshot);
+    TEST_ASSERT_TRUE(resumed.resume());
+    TEST_ASSERT_EQUAL_UINT32(stats.cycles, resumed.getStats().cycles);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_snapshot_seal_and_corruption);
+    RUN_TEST(test_filter_needs_consecutive_safe_fixes);
+    RUN_TEST(test_sleep_duration_keeps_caution_zone_out_of_reach);
+    RUN_TEST(test_session_round_trip);
+    RUN_TEST(test_geofence_round_trip);
+    RUN_TEST(test_wake_accounting);
+    RUN_TEST(test_wake_without_uplink_keeps_session);
+    RUN_TEST(test_battery_state_round_trip);
+    RUN_TEST(test_simulated_day_vs_continuous);
+    return UNITY_END();
+}
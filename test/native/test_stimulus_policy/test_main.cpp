@@ -0,0 +1,333 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - STIMULUS POLICY (ESCALADA Y TOPE DIARIO)
+ * ============================================================================
+ * Reproduce episodios con un animal simulado, una posición cada
+ * GPS_UPDATE_INTERVAL y la misma cadena que AlertManager::update():
+ * AlertFilter -> StimulusPolicy. El animal sale caminando hacia el borde y
+ * vuelve cuando oye un nivel durante su tiempo de respuesta (o nunca).
+ * Se comparan la política fija y la adaptativa con animales rápidos,
+ * lentos y que ignoran CAUTION, el tope diario de estímulos y lo que pasa
+ * por el snapshot de SleepCycle en un deep sleep.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include "config/constants.h"
+#include "system/AlertFilter.h"
+#include "system/StimulusPolicy.h"
+#include "system/SleepCycle.h"
+
+// Umbrales de AlertManager.h (CAUTION_DISTANCE, WARNING_DISTANCE)
+static const float CAUTION_M = -15.0f;
+static const float WARNING_M = 0.0f;
+static const uint32_t FIX_MS = GPS_UPDATE_INTERVAL;
+
+// ============================================================================
+// ANIMAL SIMULADO
+// ============================================================================
+
+struct Animal {
+    float outSpeed;         // m/s hacia el borde
+    float backSpeed;        // m/s al volver
+    uint32_t responseMs[3]; // Tiempo que tarda en volver oyendo cada nivel (0 = no vuelve)
+};
+
+struct Episode {
+    uint32_t stimuli;         // Subidas de nivel audibles
+    uint32_t warnings;        // Veces que sonó WARNING
+    uint32_t cautionToWarnMs; // Desde CAUTION audible hasta WARNING (0 = no escaló)
+    uint32_t durationMs;
+    bool audible;             // Sonó algo
+};
+
+static AlertFilter filter(AlertFilter::Config(CAUTION_M, WARNING_M));
+static uint32_t clockMs;
+
+static Episode replay(StimulusPolicy &policy, const Animal &animal) {
+    Episode episode = {0, 0, 0, 0, false};
+    float distance = -30.0f;
+    bool returning = false;
+    AlertLevel heard = AlertLevel::SAFE;
+    uint32_t heardSince = 0;
+    uint32_t cautionSince = 0;
+    AlertLevel previous = AlertLevel::SAFE;
+    uint32_t start = clockMs;
+
+    for (uint32_t step = 0; step < 240; step++) {
+        AlertLevel fenceLevel = filter.update(distance, clockMs);
+        StimulusPolicy::Decision decision = policy.update(fenceLevel, distance, clockMs);
+
+        if (decision.level > previous && decision.audible) {
+            episode.stimuli++;
+            episode.audible = true;
+            if (decision.level == AlertLevel::CAUTION) {
+                cautionSince = clockMs;
+            } else {
+                episode.warnings++;
+                if (episode.cautionToWarnMs == 0 && previous == AlertLevel::CAUTION) {
+                    episode.cautionToWarnMs = clockMs - cautionSince;
+                }
+            }
+        }
+        previous = decision.level;
+
+        AlertLevel now = decision.audible ? decision.level : AlertLevel::SAFE;
+        if (now != heard) {
+            heard = now;
+            heardSince = clockMs;
+        }
+        uint32_t response = animal.responseMs[(uint8_t)heard];
+        if (heard > AlertLevel::SAFE && response > 0 && clockMs - heardSince >= response) {
+            returning = true;
+        }
+
+        if (returning && distance < -35.0f && decision.level == AlertLevel::SAFE) {
+            break;
+        }
+        distance += (returning ? -animal.backSpeed : animal.outSpeed) * FIX_MS / 1000.0f;
+        if (distance > 40.0f) {
+            distance = 40.0f; // Se queda pastando afuera
+        }
+        clockMs += FIX_MS;
+    }
+
+    // Un rato adentro antes del próximo episodio
+    episode.durationMs = clockMs - start;
+    for (uint8_t i = 0; i < 12; i++) {
+        clockMs += FIX_MS;
+        policy.update(filter.update(-40.0f, clockMs), -40.0f, clockMs);
+    }
+    return episode;
+}
+
+// Caminando a 0,2 m/s la geocerca tarda 75 s en pasar de CAUTION a WARNING:
+// antes llega la escalada por tiempo. Todos vuelven con WARNING en 5 s
+static const Animal QUICK = {0.2f, 1.0f, {0, 5000, 5000}};
+static const Animal STEADY = {0.2f, 1.0f, {0, 20000, 5000}};
+static const Animal DAWDLING = {0.2f, 1.0f, {0, 40000, 5000}};
+static const Animal DEAF_TO_CAUTION = {0.2f, 1.0f, {0, 0, 5000}};
+
+void setUp(void) {
+    filter = AlertFilter(AlertFilter::Config(CAUTION_M, WARNING_M));
+    clockMs = 1000;
+}
+
+void tearDown(void) {}
+
+// ============================================================================
+// POLÍTICA FIJA
+// ============================================================================
+
+void test_fixed_escalates_after_configured_time(void) {
+    FixedStimulusPolicy policy;
+    Episode episode = replay(policy, DEAF_TO_CAUTION);
+
+    // CAUTION y a los 30 s sin respuesta WARNING, que sí la hace volver
+    TEST_ASSERT_EQUAL_UINT32(2, episode.stimuli);
+    TEST_ASSERT_EQUAL_UINT32(STIMULUS_ESCALATE_MS, episode.cautionToWarnMs);
+    TEST_ASSERT_EQUAL_UINT32(1, policy.getStats().escalations);
+    TEST_ASSERT_EQUAL_UINT32(1, policy.getStats().responses[(uint8_t)AlertLevel::WARNING]);
+    TEST_ASSERT_EQUAL_UINT32(0, policy.getStats().responses[(uint8_t)AlertLevel::CAUTION]);
+
+    // Un downlink con 0 s no hace sonar WARNING al entrar en CAUTION
+    StimulusPolicy::Config config;
+    config.escalateAfterMs = 0;
+    policy.setConfig(config);
+    TEST_ASSERT_EQUAL_UINT32(STIMULUS_MIN_ESCALATE_MS, policy.getConfig().escalateAfterMs);
+    episode = replay(policy, DEAF_TO_CAUTION);
+    TEST_ASSERT_EQUAL_UINT32(STIMULUS_MIN_ESCALATE_MS, episode.cautionToWarnMs);
+}
+
+void test_response_stops_escalation(void) {
+    FixedStimulusPolicy policy;
+    Episode episode = replay(policy, QUICK);
+
+    TEST_ASSERT_EQUAL_UINT32(1, episode.stimuli);
+    TEST_ASSERT_EQUAL_UINT32(0, episode.warnings);
+    TEST_ASSERT_EQUAL_UINT32(1, policy.getStats().responses[(uint8_t)AlertLevel::CAUTION]);
+
+    // Vuelve a los 5 s y la posición siguiente ya está turnBackMeters adentro
+    uint32_t measured = policy.averageResponseMs(AlertLevel::CAUTION);
+    TEST_ASSERT_TRUE(measured >= 5000 && measured <= 5000 + 2 * FIX_MS);
+}
+
+void test_heading_out_again_restarts_timer(void) {
+    FixedStimulusPolicy policy;
+    uint32_t t = 0;
+    policy.update(AlertLevel::CAUTION, -10.0f, t);
+    policy.update(AlertLevel::CAUTION, -14.0f, t += 20000); // Vuelve 4 m
+    TEST_ASSERT_EQUAL_UINT32(1, policy.getStats().responses[(uint8_t)AlertLevel::CAUTION]);
+
+    // Sale otra vez: el plazo de 30 s corre desde que se aleja del punto más interno
+    policy.update(AlertLevel::CAUTION, -15.0f, t += 5000);
+    policy.update(AlertLevel::CAUTION, -10.0f, t += 5000);
+    StimulusPolicy::Decision decision = policy.update(AlertLevel::CAUTION, -8.0f, t += 29999);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::CAUTION, (uint8_t)decision.level);
+    decision = policy.update(AlertLevel::CAUTION, -8.0f, t + 1);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::WARNING, (uint8_t)decision.level);
+
+    // Con WARNING por tiempo y la geocerca en CAUTION, baja solo cuando vuelve
+    decision = policy.update(AlertLevel::CAUTION, -9.0f, t += 5000);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::WARNING, (uint8_t)decision.level);
+    decision = policy.update(AlertLevel::CAUTION, -12.0f, t += 5000);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AlertLevel::CAUTION, (uint8_t)decision.level);
+}
+
+// ============================================================================
+// POLÍTICA ADAPTATIVA
+// ============================================================================
+
+void test_adaptive_learns_quick_animal(void) {
+    AdaptiveStimulusPolicy adaptive;
+    FixedStimulusPolicy fixed;
+
+    for (uint8_t i = 0; i < STIMULUS_MIN_SAMPLES; i++) {
+        TEST_ASSERT_EQUAL_UINT32(STIMULUS_ESCALATE_MS, adaptive.escalationDelay(AlertLevel::CAUTION));
+        replay(adaptive, QUICK);
+    }
+    uint32_t learned = adaptive.learnedResponseMs(AlertLevel::CAUTION);
+    TEST_ASSERT_TRUE(learned >= 5000 && learned <= 5000 + 2 * FIX_MS);
+
+    // El que suele volver rápido y esta vez no, recibe WARNING antes que con la fija
+    Episode adaptiveEpisode = replay(adaptive, DEAF_TO_CAUTION);
+    Episode fixedEpisode = replay(fixed, DEAF_TO_CAUTION);
+    printf("  [info] rápido: aprendido %lu ms, WARNING a los %lu s (fija: %lu s)\n", (unsigned long)learned,
+           (unsigned long)adaptiveEpisode.cautionToWarnMs / 1000, (unsigned long)fixedEpisode.cautionToWarnMs / 1000);
+    TEST_ASSERT_TRUE(adaptiveEpisode.cautionToWarnMs < fixedEpisode.cautionToWarnMs);
+    TEST_ASSERT_TRUE(adaptiveEpisode.cautionToWarnMs >= STIMULUS_MIN_ESCALATE_MS);
+}
+
+void test_adaptive_spares_slow_animal(void) {
+    AdaptiveStimulusPolicy adaptive;
+    FixedStimulusPolicy fixed;
+
+    // Suele volver a los ~25 s y uno de cada cuatro episodios tarda 45 s
+    uint32_t adaptiveWarnings = 0;
+    uint32_t fixedWarnings = 0;
+    for (uint8_t i = 0; i < 12; i++) {
+        const Animal &animal = (i % 4 == 3) ? DAWDLING : STEADY;
+        adaptiveWarnings += replay(adaptive, animal).warnings;
+        fixedWarnings += replay(fixed, animal).warnings;
+    }
+
+    // La fija escala a los 30 s los episodios lentos; la adaptativa ya sabe que vuelve
+    printf("  [info] lento: WARNING en 12 episodios, fija %lu, adaptativa %lu (escalada a %lu s)\n",
+           (unsigned long)fixedWarnings, (unsigned long)adaptiveWarnings,
+           (unsigned long)adaptive.escalationDelay(AlertLevel::CAUTION) / 1000);
+    TEST_ASSERT_EQUAL_UINT32(3, fixedWarnings);
+    TEST_ASSERT_EQUAL_UINT32(0, adaptiveWarnings);
+    TEST_ASSERT_TRUE(adaptive.escalationDelay(AlertLevel::CAUTION) > 45000);
+    TEST_ASSERT_TRUE(adaptive.escalationDelay(AlertLevel::CAUTION) <= STIMULUS_MAX_ESCALATE_MS);
+
+    adaptive.forget();
+    TEST_ASSERT_EQUAL_UINT32(STIMULUS_ESCALATE_MS, adaptive.escalationDelay(AlertLevel::CAUTION));
+}
+
+// ============================================================================
+// TOPE DIARIO
+// ============================================================================
+
+void test_daily_cap(void) {
+    StimulusPolicy::Config config;
+    config.dailyCap = 5;
+    FixedStimulusPolicy policy(config);
+
+    uint32_t audibleEpisodes = 0;
+    for (uint8_t i = 0; i < 6; i++) {
+        audibleEpisodes += replay(policy, DEAF_TO_CAUTION).audible ? 1 : 0;
+    }
+
+    // Dos estímulos por episodio: el tercero queda a medias (CAUTION suena, WARNING no)
+    TEST_ASSERT_EQUAL_UINT16(5, policy.getStats().stimuliToday);
+    TEST_ASSERT_EQUAL_UINT32(5, policy.getStats().stimuli);
+    TEST_ASSERT_EQUAL_UINT32(3, audibleEpisodes);
+    TEST_ASSERT_TRUE(policy.getStats().suppressed >= 7);
+
+    // Día siguiente: vuelve a sonar
+    clockMs += StimulusPolicy::DAY_MS;
+    Episode episode = replay(policy, QUICK);
+    TEST_ASSERT_TRUE(episode.audible);
+    TEST_ASSERT_EQUAL_UINT16(1, policy.getStats().stimuliToday);
+
+    // Sin tope
+    config.dailyCap = 0;
+    policy.setConfig(config);
+    for (uint8_t i = 0; i < 10; i++) {
+        TEST_ASSERT_TRUE(replay(policy, DEAF_TO_CAUTION).audible);
+    }
+}
+
+// ============================================================================
+// DEEP SLEEP
+// ============================================================================
+
+// Cada despertar del modo ciclo es un arranque en frío con millis() en cero:
+// lo aprendido y el tope del día pasan por el snapshot
+void test_state_survives_deep_sleep(void) {
+    StimulusPolicy::Config config;
+    config.dailyCap = STIMULUS_MIN_SAMPLES + 1;
+    AdaptiveStimulusPolicy before(config);
+    for (uint8_t i = 0; i < STIMULUS_MIN_SAMPLES; i++) {
+        replay(before, QUICK);
+    }
+    TEST_ASSERT_EQUAL_UINT16(STIMULUS_MIN_SAMPLES, before.getStats().stimuliToday);
+
+    static SleepCycle::Snapshot snapshot;
+    SleepCycle cycle(snapshot);
+    cycle.reset();
+    bool adaptive = false;
+    StimulusPolicy::Config loaded;
+    StimulusPolicy::State state;
+    TEST_ASSERT_FALSE(cycle.loadStimulus(adaptive, loaded, state));
+
+    const uint32_t sleepMs = 600000;
+    uint32_t dayElapsed = clockMs + sleepMs;
+    cycle.storeStimulus(true, before.getConfig(), before.getState(clockMs + sleepMs));
+    cycle.seal();
+
+    // Despertar: política nueva, filtro nuevo y el reloj desde cero
+    TEST_ASSERT_TRUE(cycle.resume());
+    TEST_ASSERT_TRUE(cycle.loadStimulus(adaptive, loaded, state));
+    TEST_ASSERT_TRUE(adaptive);
+    TEST_ASSERT_EQUAL_UINT16(config.dailyCap, loaded.dailyCap);
+    TEST_ASSERT_EQUAL_UINT32(dayElapsed, state.dayElapsedMs);
+    AdaptiveStimulusPolicy after(loaded);
+    after.restore(state, 0);
+    filter = AlertFilter(AlertFilter::Config(CAUTION_M, WARNING_M));
+    clockMs = 1000;
+
+    TEST_ASSERT_EQUAL_UINT32(before.learnedResponseMs(AlertLevel::CAUTION), after.learnedResponseMs(AlertLevel::CAUTION));
+    TEST_ASSERT_EQUAL_UINT32(before.escalationDelay(AlertLevel::CAUTION), after.escalationDelay(AlertLevel::CAUTION));
+    TEST_ASSERT_TRUE(after.escalationDelay(AlertLevel::CAUTION) < STIMULUS_ESCALATE_MS);
+
+    // Queda un estímulo del tope: CAUTION suena y la escalada ya no
+    Episode episode = replay(after, DEAF_TO_CAUTION);
+    TEST_ASSERT_EQUAL_UINT32(1, episode.stimuli);
+    TEST_ASSERT_EQUAL_UINT16(config.dailyCap, after.getStats().stimuliToday);
+    TEST_ASSERT_TRUE(after.getStats().suppressed >= 1);
+
+    // El día termina cuando tocaba, no 24 h después del despertar
+    after.update(AlertLevel::SAFE, -30.0f, StimulusPolicy::DAY_MS - dayElapsed - 1);
+    TEST_ASSERT_EQUAL_UINT16(config.dailyCap, after.getStats().stimuliToday);
+    after.update(AlertLevel::SAFE, -30.0f, StimulusPolicy::DAY_MS - dayElapsed);
+    TEST_ASSERT_EQUAL_UINT16(0, after.getStats().stimuliToday);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fixed_escalates_after_configured_time);
+    RUN_TEST(test_response_stops_escalation);
+    RUN_TEST(test_heading_out_again_restarts_timer);
+    RUN_TEST(test_adaptive_learns_quick_animal);
+    RUN_TEST(test_adaptive_spares_slow_animal);
+    RUN_TEST(test_daily_cap);
+    RUN_TEST(test_state_survives_deep_sleep);
+    return UNITY_END();
+}
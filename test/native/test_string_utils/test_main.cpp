@@ -0,0 +1,301 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - STRING UTILS Y RUNTIME SIN HEAP
+ * ============================================================================
+ * Formateo en buffers del llamador (corte sin desbordar, siempre con '\0')
+ * y un lazo equivalente al estado estable del firmware (log, bitácora,
+ * planificador, calidad del enlace, textos de pantalla y serial) que no
+ * debe reservar memoria dinámica después del primer pasaje.
+ *
+ * Las reservas se cuentan reemplazando operator new/delete; con glibc
+ * además se compara la marca de heap en uso (mallinfo2) antes y después.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <new>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include "config/constants.h"
+#include "utils/StringUtils.h"
+#include "system/LogBuffer.h"
+#include "system/BinaryLog.h"
+#include "system/TraceLog.h"
+#include "system/Scheduler.h"
+#include "system/LinkQuality.h"
+
+// ============================================================================
+// CONTEO DE RESERVAS
+// ============================================================================
+
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+    allocations++;
+    void *pointer = malloc(size ? size : 1);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept {
+    free(pointer);
+}
+
+static size_t heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return 0; // Sin marca de heap: queda solo el conteo de operator new
+#endif
+}
+
+static uint32_t fakeMillis = 0;
+
+static uint32_t fakeClock() {
+    return fakeMillis;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// ============================================================================
+// FORMATEO
+// ============================================================================
+
+void test_writer_truncates_and_terminates(void) {
+    char buffer[8];
+    memset(buffer, 'x', sizeof(buffer));
+    StringUtils::Writer out(buffer, sizeof(buffer));
+    out.print("abc").printf("%d", 12345).print("zz");
+
+    TEST_ASSERT_EQUAL_STRING("abc1234", buffer);
+    TEST_ASSERT_EQUAL(7, out.length());
+    TEST_ASSERT_TRUE(out.truncated());
+
+    // Sin lugar no se escribe nada, ni siquiera el '\0'
+    char none = 'x';
+    StringUtils::Writer empty(&none, 0);
+    empty.print("a").printf("%d", 1).repeat('-', 3);
+    TEST_ASSERT_EQUAL('x', none);
+    TEST_ASSERT_EQUAL(0, empty.length());
+
+    char exact[4];
+    StringUtils::Writer fits(exact, sizeof(exact));
+    fits.repeat('-', 3);
+    TEST_ASSERT_EQUAL_STRING("---", exact);
+    TEST_ASSERT_FALSE(fits.truncated());
+}
+
+void test_format_values(void) {
+    char text[48];
+
+    StringUtils::formatCoordinate(text, sizeof(text), -33.448890, true);
+    TEST_ASSERT_EQUAL_STRING("33.4489°S", text);
+    StringUtils::formatCoordinateDMS(text, sizeof(text), -70.669265, false);
+    TEST_ASSERT_EQUAL_STRING("70°40'9.35\"W", text);
+
+    StringUtils::formatDuration(text, sizeof(text), 0);
+    TEST_ASSERT_EQUAL_STRING("0s", text);
+    StringUtils::formatDuration(text, sizeof(text), 5025000);
+    TEST_ASSERT_EQUAL_STRING("1h 23m 45s", text);
+    StringUtils::formatUptime(text, sizeof(text), 86400 + 60);
+    TEST_ASSERT_EQUAL_STRING("1d 1m", text);
+    StringUtils::formatUptime(text, sizeof(text), 100 * 86400); // Más de 49 días en ms
+    TEST_ASSERT_EQUAL_STRING("100d", text);
+    StringUtils::formatTime(text, sizeof(text), 3723000);
+    TEST_ASSERT_EQUAL_STRING("01:02:03", text);
+
+    StringUtils::formatVoltage(text, sizeof(text), 3.874f);
+    TEST_ASSERT_EQUAL_STRING("3.87V", text);
+    StringUtils::formatPercentage(text, sizeof(text), 76);
+    TEST_ASSERT_EQUAL_STRING("76%", text);
+    StringUtils::formatDistance(text, sizeof(text), 1520.0f);
+    TEST_ASSERT_EQUAL_STRING("1.52km", text);
+    StringUtils::formatFrequency(text, sizeof(text), 915200000.0f);
+    TEST_ASSERT_EQUAL_STRING("915.2MHz", text);
+    StringUtils::formatMemorySize(text, sizeof(text), 2560);
+    TEST_ASSERT_EQUAL_STRING("2.5KB", text);
+    StringUtils::formatDeviceId(text, sizeof(text), 0x48CA433CEC58ULL);
+    TEST_ASSERT_EQUAL_STRING("48CA433CEC58", text);
+
+    StringUtils::createStatusMessage(text, sizeof(text), 3600, 3.9f, 80, 12.5f, "SAFE");
+    TEST_ASSERT_EQUAL_STRING("UP:1h BAT:3.90V(80%) DIST:12.5m ALERT:SAFE", text);
+}
+
+void test_hex_round_trip(void) {
+    const uint8_t eui[] = {0x58, 0xEC, 0x3C, 0x43, 0xCA, 0x48, 0x00, 0x0F};
+    char text[32];
+
+    TEST_ASSERT_EQUAL(23, StringUtils::bytesToHex(text, sizeof(text), eui, sizeof(eui), true, ":"));
+    TEST_ASSERT_EQUAL_STRING("58:EC:3C:43:CA:48:00:0F", text);
+
+    uint8_t bytes[8];
+    TEST_ASSERT_EQUAL(8, StringUtils::hexToBytes(text, bytes, sizeof(bytes)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(eui, bytes, sizeof(eui));
+    TEST_ASSERT_EQUAL(2, StringUtils::hexToBytes("ab-cd-e", bytes, sizeof(bytes)));
+    TEST_ASSERT_EQUAL_HEX8(0xCD, bytes[1]);
+
+    // Corta en un byte entero, sin medio dígito suelto
+    char small[6];
+    StringUtils::bytesToHex(small, sizeof(small), eui, sizeof(eui), false);
+    TEST_ASSERT_EQUAL_STRING("58ec3", small);
+}
+
+void test_text_manipulation(void) {
+    char text[32];
+
+    StringUtils::truncate(text, sizeof(text), "Potrero norte grande", 12);
+    TEST_ASSERT_EQUAL_STRING("Potrero n...", text);
+    StringUtils::truncate(text, sizeof(text), "Corto", 12);
+    TEST_ASSERT_EQUAL_STRING("Corto", text);
+    StringUtils::truncate(text, sizeof(text), "Potrero", 2);
+    TEST_ASSERT_EQUAL_STRING("..", text);
+
+    StringUtils::center(text, sizeof(text), "OK", 7, '*');
+    TEST_ASSERT_EQUAL_STRING("**OK***", text);
+    StringUtils::padLeft(text, sizeof(text), "42", 5, '0');
+    TEST_ASSERT_EQUAL_STRING("00042", text);
+    StringUtils::padRight(text, sizeof(text), "ab", 4);
+    TEST_ASSERT_EQUAL_STRING("ab  ", text);
+
+    char title[] = "cabra DEL potrero";
+    TEST_ASSERT_EQUAL_STRING("Cabra Del Potrero", StringUtils::toTitleCase(title));
+
+    TEST_ASSERT_TRUE(StringUtils::isNumeric("-12.5"));
+    TEST_ASSERT_FALSE(StringUtils::isNumeric("1.2.3"));
+    TEST_ASSERT_FALSE(StringUtils::isNumeric("+"));
+    TEST_ASSERT_TRUE(StringUtils::isAlphanumeric("Cabra42"));
+    TEST_ASSERT_FALSE(StringUtils::isAlphanumeric("Cabra 42"));
+}
+
+// ============================================================================
+// ESTADO ESTABLE SIN RESERVAS
+// ============================================================================
+
+static LogBuffer logBuffer;
+static TraceLog::Storage traceStorage;
+static uint32_t taskRuns = 0;
+
+static void countTask(void *context) {
+    taskRuns++;
+}
+
+static void logMessage(uint8_t level, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    logBuffer.push(level, fakeMillis, format, args);
+    va_end(args);
+}
+
+// Un pasaje del firmware: posición, log, bitácora, uplink, pantalla y serial
+static void steadyStateIteration(Scheduler &scheduler, TraceLog &trace, LinkQuality &link, uint32_t i) {
+    char line[128];
+    char part[32];
+    uint8_t frame[BinaryLog::MAX_FRAME];
+    uint8_t payload[TRACE_CHUNK_SIZE];
+
+    fakeMillis += 1000;
+    scheduler.runDue();
+
+    double lat = -33.448890 + i * 1e-6;
+    double lng = -70.669265 - i * 1e-6;
+    logMessage(3, "📍 Posición: %.6f, %.6f | Sats: %d", lat, lng, 9);
+    logMessage(2, "%s Geocerca %s a %.1f m", "⚠️", "Potrero norte", 12.5);
+    BinaryLog::encode(frame, sizeof(frame), 3, fakeMillis, 0x59DC908Eu, lat, lng);
+
+    LogBuffer::Record record;
+    while (logBuffer.pop(record)) {
+        LogBuffer::format(record, line, sizeof(line));
+    }
+
+    trace.record(TraceLog::TRACE_UPLINK, 2, 0);
+    if (i % 10 == 0) {
+        trace.requestUpload(5);
+        uint8_t entries;
+        trace.buildChunk(payload, sizeof(payload), entries);
+        trace.commitChunk(entries);
+    }
+
+    link.recordUplink(2, true, 0);
+    link.recordDownlink(-110.0f, 4.5f, fakeMillis);
+    link.buildSummary(payload, sizeof(payload), fakeMillis);
+
+    // Textos de la pantalla y del estado por serial
+    StringUtils::formatCoordinate(part, sizeof(part), lat, true, 6);
+    StringUtils::formatDistance(part, sizeof(part), 12.5f + i);
+    StringUtils::formatUptime(part, sizeof(part), fakeMillis / 1000);
+    StringUtils::createStatusMessage(line, sizeof(line), fakeMillis / 1000, 3.9f, 80, 12.5f, "SAFE");
+    TraceLog::Entry entry;
+    trace.get(trace.size() - 1, entry);
+    TraceLog::format(entry, part, sizeof(part));
+}
+
+void test_steady_state_has_no_allocations(void) {
+    Scheduler scheduler(fakeClock);
+    scheduler.addTask("lora", countTask, nullptr, 30000, 5000);
+    scheduler.addTask("display", countTask, nullptr, 1000, 1000);
+    scheduler.addTask("serial", countTask, nullptr, 10000, 5000);
+    TraceLog trace(traceStorage, fakeClock);
+    trace.begin();
+    LinkQuality link;
+
+    // Primer pasaje: inicializaciones perezosas de la libc (locale, stdio)
+    for (uint32_t i = 0; i < 10; i++) {
+        steadyStateIteration(scheduler, trace, link, i);
+    }
+
+    size_t allocationsBefore = allocations;
+    size_t heapBefore = heapInUse();
+    for (uint32_t i = 10; i < 5000; i++) {
+        steadyStateIteration(scheduler, trace, link, i);
+    }
+    size_t newCalls = allocations - allocationsBefore;
+    size_t heapAfter = heapInUse();
+
+    printf("\nEstado estable: 4990 pasajes, %lu tareas, %zu reservas, heap en uso %zu → %zu bytes\n",
+           (unsigned long)taskRuns, newCalls, heapBefore, heapAfter);
+    TEST_ASSERT_TRUE(taskRuns > 0);
+    TEST_ASSERT_EQUAL(0, newCalls);
+    TEST_ASSERT_TRUE(heapAfter <= heapBefore);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_writer_truncates_and_terminates);
+    RUN_TEST(test_format_values);
+    RUN_TEST(test_hex_round_trip);
+    RUN_TEST(test_text_manipulation);
+    RUN_TEST(test_steady_state_has_no_allocations);
+    return UNITY_END();
+}
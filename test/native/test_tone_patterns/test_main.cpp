@@ -0,0 +1,134 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - PATRONES DE TONOS (TABLAS EN COMPILACIÓN)
+ * ============================================================================
+ * La tabla de frecuencias coincide con musical_notes.h y el texto de los
+ * patrones se compila a los pasos esperados, todo con static_assert. En
+ * ejecución: nota más cercana para los tonos sueltos, duración de cada
+ * patrón de LIBRARY frente a las melodías que reemplaza y bytes que ocupan.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include "config/constants.h"
+#include "hardware/musical_notes.h"
+#include "utils/TonePatterns.h"
+
+using namespace TonePatterns;
+
+// ============================================================================
+// COMPROBACIONES EN COMPILACIÓN
+// ============================================================================
+
+static_assert(TONES.hz[SILENCE] == 0, "El índice 0 es silencio");
+static_assert(TONES.hz[69] == NOTE_A4, "La4 = 440 Hz");
+static_assert(TONES.hz[60] == NOTE_C4 && TONES.hz[61] == NOTE_CS4 && TONES.hz[62] == NOTE_D4 &&
+                  TONES.hz[63] == NOTE_DS4 && TONES.hz[64] == NOTE_E4 && TONES.hz[65] == NOTE_F4 &&
+                  TONES.hz[66] == NOTE_FS4 && TONES.hz[67] == NOTE_G4 && TONES.hz[68] == NOTE_GS4 &&
+                  TONES.hz[70] == NOTE_AS4 && TONES.hz[71] == NOTE_B4,
+              "Octava 4 igual a musical_notes.h");
+static_assert(TONES.hz[23] == NOTE_B0 && TONES.hz[48] == NOTE_C3 && TONES.hz[79] == NOTE_G5 &&
+                  TONES.hz[86] == NOTE_D6 && TONES.hz[90] == NOTE_FS6 && TONES.hz[95] == NOTE_B6 &&
+                  TONES.hz[99] == NOTE_DS7 && TONES.hz[111] == NOTE_DS8 && TONES.hz[108] == NOTE_C8,
+              "Notas de las alertas y extremos iguales a musical_notes.h");
+
+static_assert(countSteps("C4:200 E4:200  G4:200 ") == 3, "Espacios de más no cuentan");
+
+constexpr auto SAMPLE = TONE_STEPS("C4:200 -:50 F#5:10 Bb3:2550");
+static_assert(SAMPLE.COUNT == 4, "Cuatro pasos");
+static_assert(SAMPLE.steps[0].tone == 60 && SAMPLE.steps[0].ticks == 20, "C4 de 200 ms");
+static_assert(SAMPLE.steps[1].tone == SILENCE && SAMPLE.steps[1].ticks == 5, "Silencio de 50 ms");
+static_assert(SAMPLE.steps[2].tone == 78 && SAMPLE.steps[2].ticks == 1, "Sostenido");
+static_assert(SAMPLE.steps[3].tone == 58 && SAMPLE.steps[3].ticks == 255, "Bemol y duración máxima");
+static_assert(sizeof(Step) == 2, "Pasos de 2 bytes");
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+static uint32_t durationMs(const Pattern &pattern) {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < pattern.count; i++) {
+        total += (pattern.steps[i].ticks + pattern.gap) * TICK_MS;
+    }
+    return total;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_nearest_tone(void) {
+    TEST_ASSERT_EQUAL_UINT8(SILENCE, nearestTone(0));
+    TEST_ASSERT_EQUAL_UINT8(69, nearestTone(440));
+    TEST_ASSERT_EQUAL_UINT8(79, nearestTone(800));  // FREQ_CAUTION -> Sol5 (784 Hz)
+    TEST_ASSERT_EQUAL_UINT8(86, nearestTone(1200)); // FREQ_WARNING -> Re6 (1175 Hz)
+    TEST_ASSERT_EQUAL_UINT8(1, nearestTone(1));
+    TEST_ASSERT_EQUAL_UINT8(TONE_COUNT - 1, nearestTone(20000));
+
+    // Nunca más lejos que medio semitono (~3 %) dentro del rango del buzzer
+    for (uint16_t hz = 100; hz <= 8000; hz += 7) {
+        uint16_t snapped = frequency(nearestTone(hz));
+        TEST_ASSERT_TRUE(snapped * 1000 >= hz * 970 && snapped * 1000 <= hz * 1030);
+    }
+}
+
+void test_ticks_for(void) {
+    TEST_ASSERT_EQUAL_UINT8(1, ticksFor(0));
+    TEST_ASSERT_EQUAL_UINT8(5, ticksFor(50));
+    TEST_ASSERT_EQUAL_UINT8(6, ticksFor(51));
+    TEST_ASSERT_EQUAL_UINT8(255, ticksFor(60000));
+}
+
+void test_library_matches_old_melodies(void) {
+    // Duraciones de las melodías de BuzzerManager, con 50 ms entre notas
+    TEST_ASSERT_EQUAL_UINT32(1000 + 4 * 50, durationMs(LIBRARY[PATTERN_STARTUP]));
+    TEST_ASSERT_EQUAL_UINT32(1000 + 4 * 50, durationMs(LIBRARY[PATTERN_SHUTDOWN]));
+    TEST_ASSERT_EQUAL_UINT32(600 + 3 * 50, durationMs(LIBRARY[PATTERN_SUCCESS]));
+    TEST_ASSERT_EQUAL_UINT32(500 + 5 * 50, durationMs(LIBRARY[PATTERN_ERROR]));
+    TEST_ASSERT_EQUAL_UINT32(600 + 3 * 50, durationMs(LIBRARY[PATTERN_WARNING]));
+
+    // Cadencias de alerta: un ciclo por segundo, indefinidas
+    TEST_ASSERT_EQUAL_UINT32(1000, durationMs(LIBRARY[PATTERN_ALERT_CAUTION]));
+    TEST_ASSERT_EQUAL_UINT32(1000, durationMs(LIBRARY[PATTERN_ALERT_WARNING]));
+    TEST_ASSERT_EQUAL_UINT8(0, LIBRARY[PATTERN_ALERT_CAUTION].repetitions);
+    TEST_ASSERT_EQUAL_UINT8(0, LIBRARY[PATTERN_ALERT_WARNING].repetitions);
+    TEST_ASSERT_EQUAL_UINT8(VOLUME_LOW, LIBRARY[PATTERN_ALERT_CAUTION].volume);
+    TEST_ASSERT_EQUAL_UINT8(VOLUME_MEDIUM, LIBRARY[PATTERN_ALERT_WARNING].volume);
+}
+
+void test_library_is_valid(void) {
+    uint32_t stepBytes = 0;
+    for (uint8_t id = 0; id < PATTERN_COUNT; id++) {
+        const Pattern *pattern = find(id);
+        TEST_ASSERT_NOT_NULL(pattern);
+        TEST_ASSERT_TRUE(pattern->count > 0);
+        TEST_ASSERT_TRUE(durationMs(*pattern) > 0);
+        for (uint8_t i = 0; i < pattern->count; i++) {
+            uint8_t tone = pattern->steps[i].tone;
+            TEST_ASSERT_TRUE(tone == SILENCE || (frequency(tone) >= 100 && frequency(tone) <= 8000));
+        }
+        stepBytes += pattern->count * sizeof(Step);
+    }
+    TEST_ASSERT_NULL(find(PATTERN_COUNT));
+    TEST_ASSERT_NULL(find(PATTERN_NONE));
+
+    // Las 5 melodías anteriores: 20 notas de 4 bytes más 5 tamaños
+    printf("  [info] %u patrones: %lu bytes de pasos + %u de LIBRARY (antes 5 melodías: %u bytes)\n",
+           (unsigned)PATTERN_COUNT, (unsigned long)stepBytes, (unsigned)sizeof(LIBRARY),
+           (unsigned)(20 * 4 + 5 * sizeof(size_t)));
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_nearest_tone);
+    RUN_TEST(test_ticks_for);
+    RUN_TEST(test_library_matches_old_melodies);
+    RUN_TEST(test_library_is_valid);
+    return UNITY_END();
+}
@@ -0,0 +1,244 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - TONE SEQUENCER (BUZZER SIN BLOQUEAR)
+ * ============================================================================
+ * Un timer simulado llama step() en cada instante que pide el secuenciador,
+ * como el esp_timer de BuzzerManager, y se graba cada cambio de la salida.
+ * La línea de tiempo resultante se compara con la esperada: melodía con sus
+ * silencios, cadencia de la alerta continua, escalada a mitad de un tono,
+ * beep encolado durante una alerta y un timer que llega tarde.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "config/constants.h"
+#include "system/ToneSequencer.h"
+
+using TonePatterns::Pattern;
+
+static constexpr auto ERROR_MELODY = TONE_STEPS("A4:100 -:50 A4:100 -:50 A4:200");
+static constexpr auto STARTUP_MELODY = TONE_STEPS("C4:200 E4:200 G4:200 C5:400");
+static constexpr auto CAUTION_CADENCE = TONE_STEPS("G5:100 -:900"); // 784 Hz cada 1 s
+static constexpr auto WARNING_CADENCE = TONE_STEPS("D6:200 -:800"); // 1175 Hz cada 1 s
+static constexpr auto FAST_CADENCE = TONE_STEPS("C6:100 -:400");    // 1047 Hz cada 500 ms
+
+// ============================================================================
+// SALIDA GRABADA
+// ============================================================================
+
+struct Event {
+    uint32_t time;
+    uint16_t frequency;
+    uint8_t volume;
+};
+
+static Event events[256];
+static size_t eventCount;
+static uint32_t clockMs;
+
+static void record(uint16_t frequency, uint8_t volume, void *context) {
+    if (eventCount < sizeof(events) / sizeof(events[0])) {
+        events[eventCount++] = {clockMs, frequency, volume};
+    }
+}
+
+static ToneSequencer sequencer;
+
+// Avanza el reloj saltando de borde en borde hasta until o hasta que no quede nada
+static void runUntil(uint32_t until) {
+    for (;;) {
+        uint32_t wait = sequencer.step(clockMs);
+        if (wait == 0 || clockMs + wait > until) {
+            clockMs = until;
+            return;
+        }
+        clockMs += wait;
+    }
+}
+
+static void assertTimeline(const Event *expected, size_t count) {
+    for (size_t i = 0; i < count && i < eventCount; i++) {
+        char message[64];
+        snprintf(message, sizeof(message), "evento %u", (unsigned)i);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(expected[i].time, events[i].time, message);
+        TEST_ASSERT_EQUAL_UINT16_MESSAGE(expected[i].frequency, events[i].frequency, message);
+        TEST_ASSERT_EQUAL_UINT8_MESSAGE(expected[i].volume, events[i].volume, message);
+    }
+    TEST_ASSERT_EQUAL_UINT32(count, eventCount);
+}
+
+void setUp(void) {
+    sequencer = ToneSequencer();
+    sequencer.setOutput(record, nullptr);
+    eventCount = 0;
+    clockMs = 1000;
+}
+
+void tearDown(void) {}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_melody_with_gaps_and_rest(void) {
+    // Melodía de error: tres La con silencios
+    TEST_ASSERT_TRUE(sequencer.enqueue(TonePatterns::pattern(ERROR_MELODY, 200, TONE_NOTE_GAP_MS, 1)));
+
+    runUntil(5000);
+
+    // El silencio de la nota 0 y los gaps se funden en un solo cambio de salida
+    const Event expected[] = {
+        {1000, 440, 200}, {1100, 0, 0},
+        {1250, 440, 200}, {1350, 0, 0},
+        {1500, 440, 200}, {1700, 0, 0},
+    };
+    assertTimeline(expected, sizeof(expected) / sizeof(expected[0]));
+    TEST_ASSERT_FALSE(sequencer.isPlaying());
+    TEST_ASSERT_EQUAL_UINT32(3, sequencer.getNotesPlayed());
+}
+
+void test_queued_patterns_play_back_to_back(void) {
+    // Dos tonos sueltos encolados sin esperar al primero (a la nota más cercana)
+    TEST_ASSERT_TRUE(sequencer.enqueueTone(1500, 100, 100));
+    TEST_ASSERT_TRUE(sequencer.enqueueTone(2000, 95, 100));
+    TEST_ASSERT_EQUAL_UINT8(2, sequencer.getQueued());
+
+    uint32_t wait = sequencer.step(clockMs);
+    TEST_ASSERT_EQUAL_UINT32(100, wait); // Quien encola vuelve enseguida
+
+    runUntil(2000);
+    const Event expected[] = {{1000, 1480, 100}, {1100, 1976, 100}, {1200, 0, 0}};
+    assertTimeline(expected, sizeof(expected) / sizeof(expected[0]));
+}
+
+void test_alert_cadence(void) {
+    // Cadencia de WARNING con 3 repeticiones
+    TEST_ASSERT_TRUE(sequencer.loop(TonePatterns::pattern(WARNING_CADENCE, 128, 0, 3)));
+    runUntil(10000);
+
+    const Event expected[] = {
+        {1000, 1175, 128}, {1200, 0, 0},
+        {2000, 1175, 128}, {2200, 0, 0},
+        {3000, 1175, 128}, {3200, 0, 0},
+    };
+    assertTimeline(expected, sizeof(expected) / sizeof(expected[0]));
+    TEST_ASSERT_FALSE(sequencer.isLooping());
+}
+
+void test_escalation_replaces_loop_immediately(void) {
+    // CAUTION indefinida y a mitad del segundo tono escala a WARNING
+    TEST_ASSERT_TRUE(sequencer.loop(TonePatterns::pattern(CAUTION_CADENCE, 64, 0, 0)));
+    runUntil(2050);
+    TEST_ASSERT_TRUE(sequencer.loop(TonePatterns::pattern(WARNING_CADENCE, 128, 0, 0)));
+    runUntil(3500);
+    sequencer.stopLoop();
+    runUntil(3600);
+
+    const Event expected[] = {
+        {1000, 784, 64}, {1100, 0, 0},
+        {2000, 784, 64},
+        {2050, 1175, 128}, {2250, 0, 0},
+        {3050, 1175, 128}, {3250, 0, 0},
+    };
+    assertTimeline(expected, sizeof(expected) / sizeof(expected[0]));
+    TEST_ASSERT_FALSE(sequencer.isPlaying());
+}
+
+void test_queued_tone_waits_for_loop_repetition(void) {
+    TEST_ASSERT_TRUE(sequencer.loop(TonePatterns::pattern(CAUTION_CADENCE, 64, 0, 0)));
+    runUntil(1500);
+
+    // El beep del botón entra al final de la repetición y la alerta sigue después
+    TEST_ASSERT_TRUE(sequencer.enqueueTone(1200, 50, 60));
+    runUntil(3500);
+    sequencer.stop();
+    runUntil(3600);
+
+    const Event expected[] = {
+        {1000, 784, 64}, {1100, 0, 0},
+        {2000, 1175, 60}, {2050, 784, 64}, {2150, 0, 0},
+        {3050, 784, 64}, {3150, 0, 0},
+    };
+    assertTimeline(expected, sizeof(expected) / sizeof(expected[0]));
+}
+
+void test_loop_resumes_repetition_count_after_queue(void) {
+    TEST_ASSERT_TRUE(sequencer.loop(TonePatterns::pattern(CAUTION_CADENCE, 64, 0, 2)));
+    runUntil(1500);
+    TEST_ASSERT_TRUE(sequencer.enqueueTone(1200, 50, 60));
+    runUntil(10000);
+
+    // El beep no le agrega repeticiones a la alerta
+    const Event expected[] = {
+        {1000, 784, 64}, {1100, 0, 0},
+        {2000, 1175, 60}, {2050, 784, 64}, {2150, 0, 0},
+    };
+    assertTimeline(expected, sizeof(expected) / sizeof(expected[0]));
+    TEST_ASSERT_FALSE(sequencer.isPlaying());
+}
+
+void test_stop_silences_at_once(void) {
+    TEST_ASSERT_TRUE(sequencer.enqueue(TonePatterns::pattern(STARTUP_MELODY, 128, TONE_NOTE_GAP_MS, 1)));
+    runUntil(1300);
+    sequencer.stop();
+    runUntil(1301);
+
+    const Event expected[] = {{1000, 262, 128}, {1200, 0, 0}, {1250, 330, 128}, {1300, 0, 0}};
+    assertTimeline(expected, sizeof(expected) / sizeof(expected[0]));
+    TEST_ASSERT_FALSE(sequencer.isPlaying());
+    TEST_ASSERT_EQUAL_UINT32(0, sequencer.step(clockMs));
+}
+
+void test_late_timer_does_not_drift(void) {
+    TEST_ASSERT_TRUE(sequencer.loop(TonePatterns::pattern(FAST_CADENCE, 100, 0, 0)));
+    TEST_ASSERT_EQUAL_UINT32(100, sequencer.step(1000));
+
+    // El timer llega 30 ms tarde: el próximo borde sigue en la grilla
+    TEST_ASSERT_EQUAL_UINT32(370, sequencer.step(1130));
+    TEST_ASSERT_EQUAL_UINT32(100, sequencer.step(1500));
+
+    // Y muy tarde: se saltan las repeticiones vencidas sin sonar
+    eventCount = 0;
+    clockMs = 3720;
+    uint32_t wait = sequencer.step(clockMs);
+    TEST_ASSERT_EQUAL_UINT32(280, wait); // Próximo tono en 4000
+    TEST_ASSERT_EQUAL_UINT32(1, eventCount);
+    TEST_ASSERT_EQUAL_UINT16(0, events[0].frequency);
+}
+
+void test_queue_full_and_empty_patterns(void) {
+    for (uint8_t i = 0; i < ToneSequencer::QUEUE_DEPTH; i++) {
+        TEST_ASSERT_TRUE(sequencer.enqueueTone(1000 + i, 10, 100));
+    }
+    TEST_ASSERT_FALSE(sequencer.enqueueTone(2000, 10, 100));
+    TEST_ASSERT_EQUAL_UINT32(1, sequencer.getDropped());
+
+    Pattern silent = {nullptr, 0, 100, 0, 1};
+    TEST_ASSERT_FALSE(sequencer.loop(silent));
+    TEST_ASSERT_FALSE(sequencer.enqueueTone(1000, 0, 100));
+
+    runUntil(2000);
+    TEST_ASSERT_EQUAL_UINT32(ToneSequencer::QUEUE_DEPTH, sequencer.getNotesPlayed());
+    TEST_ASSERT_EQUAL_UINT32(1000 + ToneSequencer::QUEUE_DEPTH * 10, events[eventCount - 1].time);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_melody_with_gaps_and_rest);
+    RUN_TEST(test_queued_patterns_play_back_to_back);
+    RUN_TEST(test_alert_cadence);
+    RUN_TEST(test_escalation_replaces_loop_immediately);
+    RUN_TEST(test_queued_tone_waits_for_loop_repetition);
+    RUN_TEST(test_loop_resumes_repetition_count_after_queue);
+    RUN_TEST(test_stop_silences_at_once);
+    RUN_TEST(test_late_timer_does_not_drift);
+    RUN_TEST(test_queue_full_and_empty_patterns);
+    return UNITY_END();
+}
@@ -0,0 +1,253 @@
+/**
+ * ============================================================================
+ * TEST NATIVO - TRACE LOG (BITÁCORA EN RTC MEMORY)
+ * ============================================================================
+ * Orden al dar la vuelta al anillo, memoria sin inicializar descartada,
+ * eventos conservados entre "resets" (un begin() nuevo sobre el mismo
+ * Storage), formato de los trozos del uplink, cursor de subida y registro
+ * concurrente desde varias tareas.
+ *
+ * @file test_main.cpp
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include "config/constants.h"
+#include "system/TraceLog.h"
+
+static TraceLog::Storage storage;
+static uint32_t fakeMillis = 0;
+
+static uint32_t fakeClock() {
+    return fakeMillis;
+}
+
+static uint32_t readLittleEndian(const uint8_t *buffer, uint8_t bytes) {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < bytes; i++) {
+        value |= (uint32_t)buffer[i] << (8 * i);
+    }
+    return value;
+}
+
+void setUp(void) {
+    memset(&storage, 0xA5, sizeof(storage)); // RTC memory sin inicializar
+    fakeMillis = 0;
+}
+
+void tearDown(void) {
+}
+
+// ============================================================================
+// ANILLO Y RETENCIÓN
+// ============================================================================
+
+void test_uninitialized_storage_is_cleared(void) {
+    TraceLog trace(storage, fakeClock);
+    TEST_ASSERT_FALSE(trace.begin());
+    TEST_ASSERT_EQUAL(0, trace.size());
+    TEST_ASSERT_EQUAL(1, trace.getBoot());
+    TEST_ASSERT_EQUAL(0, trace.pendingUpload());
+
+    TraceLog::Entry entry;
+    TEST_ASSERT_FALSE(trace.get(0, entry));
+}
+
+void test_wraps_keeping_newest_in_order(void) {
+    TraceLog trace(storage, fakeClock);
+    trace.begin();
+
+    const uint16_t total = TraceLog::CAPACITY + 40;
+    for (uint16_t i = 0; i < total; i++) {
+        fakeMillis = i * 1000;
+        trace.record(TraceLog::TRACE_UPLINK, 2, i);
+    }
+
+    TEST_ASSERT_EQUAL(TraceLog::CAPACITY, trace.size());
+    TEST_ASSERT_EQUAL_UINT32(total, trace.getSequence());
+
+    TraceLog::Entry entry;
+    TEST_ASSERT_TRUE(trace.get(0, entry));
+    TEST_ASSERT_EQUAL(40, entry.value); // Los 40 más antiguos se sobrescribieron
+    TEST_ASSERT_EQUAL_UINT32(40, entry.seconds());
+    TEST_ASSERT_TRUE(trace.get(TraceLog::CAPACITY - 1, entry));
+    TEST_ASSERT_EQUAL(total - 1, entry.value);
+    TEST_ASSERT_EQUAL(1, entry.boot());
+    TEST_ASSERT_FALSE(trace.get(TraceLog::CAPACITY, entry));
+}
+
+void test_survives_reset(void) {
+    {
+        TraceLog trace(storage, fakeClock);
+        trace.begin();
+        trace.record(TraceLog::TRACE_STATE, 2);
+        fakeMillis = 125000;
+        trace.record(TraceLog::TRACE_ALERT, 3, (uint16_t)-12);
+    }
+
+    // Watchdog: la RAM se pierde pero el Storage en RTC no, y millis() vuelve a 0
+    fakeMillis = 0;
+    TraceLog trace(storage, fakeClock);
+    TEST_ASSERT_TRUE(trace.begin());
+    TEST_ASSERT_EQUAL(2, trace.getBoot());
+    fakeMillis = 3000;
+    trace.record(TraceLog::TRACE_BOOT, 7);
+
+    TEST_ASSERT_EQUAL(3, trace.size());
+    TraceLog::Entry entry;
+    trace.get(1, entry);
+    TEST_ASSERT_EQUAL(TraceLog::TRACE_ALERT, entry.event);
+    TEST_ASSERT_EQUAL(1, entry.boot());
+    TEST_ASSERT_EQUAL_UINT32(125, entry.seconds());
+    TEST_ASSERT_EQUAL_INT16(-12, (int16_t)entry.value);
+
+    trace.get(2, entry);
+    TEST_ASSERT_EQUAL(2, entry.boot());
+    TEST_ASSERT_EQUAL_UINT32(3, entry.seconds());
+
+    char line[48];
+    TraceLog::format(entry, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("#2 +3s BOOT 7 0", line);
+
+    // Un encabezado dañado (p. ej. corte a mitad de una escritura) descarta todo
+    storage.head ^= 0x01;
+    TraceLog corrupted(storage, fakeClock);
+    TEST_ASSERT_FALSE(corrupted.begin());
+    TEST_ASSERT_EQUAL(0, corrupted.size());
+}
+
+// ============================================================================
+// SUBIDA POR LORAWAN
+// ============================================================================
+
+void test_chunk_layout_and_cursor(void) {
+    TraceLog trace(storage, fakeClock);
+    trace.begin();
+    for (uint16_t i = 0; i < 12; i++) {
+        fakeMillis = i * 1000;
+        trace.record(TraceLog::TRACE_GPS, i & 1, 1000 + i);
+    }
+
+    uint8_t chunk[TRACE_CHUNK_SIZE];
+    uint8_t entries;
+    TEST_ASSERT_EQUAL(0, trace.buildChunk(chunk, sizeof(chunk), entries)); // Nada pedido
+
+    trace.requestUpload(0);
+    TEST_ASSERT_TRUE(trace.isUploading());
+    TEST_ASSERT_EQUAL(12, trace.pendingUpload());
+
+    // Eventos registrados durante la subida no la alargan
+    fakeMillis = 70000;
+    trace.record(TraceLog::TRACE_UPLINK, 30, 0); // El trozo anterior
+
+    size_t length = trace.buildChunk(chunk, sizeof(chunk), entries);
+    TEST_ASSERT_EQUAL(5, entries); // 9 + 5 x 8 = 49 bytes en 51
+    TEST_ASSERT_EQUAL(TraceLog::CHUNK_HEADER_SIZE + 5 * TraceLog::ENTRY_SIZE, length);
+    TEST_ASSERT_EQUAL_HEX8(TraceLog::CHUNK_TYPE, chunk[0]);
+    TEST_ASSERT_EQUAL(0, readLittleEndian(&chunk[1], 2));  // Primer evento
+    TEST_ASSERT_EQUAL(7, readLittleEndian(&chunk[3], 2));  // Quedan después de este trozo
+    TEST_ASSERT_EQUAL(1, chunk[5]);                        // Arranque
+    TEST_ASSERT_EQUAL(70, readLittleEndian(&chunk[6], 3)); // Uptime
+
+    const uint8_t *first = &chunk[TraceLog::CHUNK_HEADER_SIZE];
+    TEST_ASSERT_EQUAL_HEX32((1u << 24) | 0, readLittleEndian(first, 4));
+    TEST_ASSERT_EQUAL(TraceLog::TRACE_GPS, first[4]);
+    TEST_ASSERT_EQUAL(0, first[5]);
+    TEST_ASSERT_EQUAL(1000, readLittleEndian(&first[6], 2));
+
+    // Si el uplink falla se vuelve a armar el mismo trozo
+    uint8_t again[TRACE_CHUNK_SIZE];
+    TEST_ASSERT_EQUAL(length, trace.buildChunk(again, sizeof(again), entries));
+    TEST_ASSERT_EQUAL(0, memcmp(chunk + TraceLog::CHUNK_HEADER_SIZE, again + TraceLog::CHUNK_HEADER_SIZE,
+                                length - TraceLog::CHUNK_HEADER_SIZE));
+
+    trace.commitChunk(entries);
+    trace.buildChunk(chunk, sizeof(chunk), entries);
+    TEST_ASSERT_EQUAL(5, readLittleEndian(&chunk[1], 2));
+    TEST_ASSERT_EQUAL(2, readLittleEndian(&chunk[3], 2));
+    trace.commitChunk(entries);
+
+    length = trace.buildChunk(chunk, sizeof(chunk), entries);
+    TEST_ASSERT_EQUAL(2, entries);
+    TEST_ASSERT_EQUAL(0, readLittleEndian(&chunk[3], 2));
+    TEST_ASSERT_EQUAL(1011, readLittleEndian(&chunk[length - 2], 2));
+    trace.commitChunk(entries);
+
+    TEST_ASSERT_FALSE(trace.isUploading());
+    TEST_ASSERT_EQUAL(0, trace.buildChunk(chunk, sizeof(chunk), entries));
+}
+
+void test_upload_latest_and_overwritten(void) {
+    TraceLog trace(storage, fakeClock);
+    trace.begin();
+    for (uint16_t i = 0; i < 20; i++) {
+        trace.record(TraceLog::TRACE_STATE, 0, i);
+    }
+
+    // Tras un pánico solo los últimos eventos
+    trace.requestUpload(3);
+    TEST_ASSERT_EQUAL(3, trace.pendingUpload());
+    uint8_t chunk[TRACE_CHUNK_SIZE];
+    uint8_t entries;
+    trace.buildChunk(chunk, sizeof(chunk), entries);
+    TEST_ASSERT_EQUAL(17, readLittleEndian(&chunk[1], 2));
+    TEST_ASSERT_EQUAL(17, readLittleEndian(&chunk[TraceLog::CHUNK_HEADER_SIZE + 6], 2));
+
+    // Todo lo guardado, pero la subida se atrasa y el anillo da la vuelta
+    trace.requestUpload(0);
+    TEST_ASSERT_EQUAL(20, trace.pendingUpload());
+    for (uint16_t i = 0; i < TraceLog::CAPACITY - 10; i++) {
+        trace.record(TraceLog::TRACE_UPLINK, 2, 100 + i);
+    }
+    TEST_ASSERT_EQUAL(10, trace.pendingUpload()); // Solo quedan los 10 últimos pedidos
+    trace.buildChunk(chunk, sizeof(chunk), entries);
+    TEST_ASSERT_EQUAL(10, readLittleEndian(&chunk[1], 2));
+    TEST_ASSERT_EQUAL(10, readLittleEndian(&chunk[TraceLog::CHUNK_HEADER_SIZE + 6], 2));
+
+    // Sin lugar para un evento no se arma nada
+    TEST_ASSERT_EQUAL(0, trace.buildChunk(chunk, TraceLog::CHUNK_HEADER_SIZE + 7, entries));
+    TEST_ASSERT_EQUAL(0, entries);
+}
+
+void test_concurrent_records(void) {
+    TraceLog trace(storage, fakeClock);
+    trace.begin();
+
+    const int perThread = 500;
+    std::thread tasks[4];
+    for (int t = 0; t < 4; t++) {
+        tasks[t] = std::thread([&trace, t]() {
+            for (int i = 0; i < perThread; i++) {
+                trace.record(TraceLog::TRACE_UPLINK, t, i);
+            }
+        });
+    }
+    for (int t = 0; t < 4; t++) {
+        tasks[t].join();
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(4 * perThread, trace.getSequence());
+    TEST_ASSERT_EQUAL(TraceLog::CAPACITY, trace.size());
+
+    // Encabezado consistente: sobrevive a un "reset"
+    TraceLog after(storage, fakeClock);
+    TEST_ASSERT_TRUE(after.begin());
+    TEST_ASSERT_EQUAL(TraceLog::CAPACITY, after.size());
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_uninitialized_storage_is_cleared);
+    RUN_TEST(test_wraps_keeping_newest_in_order);
+    RUN_TEST(test_survives_reset);
+    RUN_TEST(test_chunk_layout_and_cursor);
+    RUN_TEST(test_upload_latest_and_overwritten);
+    RUN_TEST(test_concurrent_records);
+    return UNITY_END();
+}